@@ -0,0 +1,158 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ApiDirectInputTypes.h
+ *   Common header file for the DirectInput data format structures and
+ *   constants used by the portable controller core. On Windows these come
+ *   from the DirectInput API. Elsewhere, equivalent definitions with
+ *   identical layouts and values are supplied here so that the core can
+ *   interpret application data formats without the Windows SDK.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiPlatform.h"
+
+
+#ifdef _WIN32
+
+// -------- DIRECTINPUT API ------------------------------------------------ //
+
+#include "ApiDirectInput.h"
+
+#else
+
+#include <cstddef>
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// Describes a single object within an application data format.
+struct DIOBJECTDATAFORMAT
+{
+    const GUID* pguid;
+    DWORD dwOfs;
+    DWORD dwType;
+    DWORD dwFlags;
+};
+
+typedef DIOBJECTDATAFORMAT*                     LPDIOBJECTDATAFORMAT;
+
+/// Describes an application data format.
+struct DIDATAFORMAT
+{
+    DWORD dwSize;
+    DWORD dwObjSize;
+    DWORD dwFlags;
+    DWORD dwDataSize;
+    DWORD dwNumObjs;
+    LPDIOBJECTDATAFORMAT rgodf;
+};
+
+/// Joystick state structure used by the built-in `c_dfDIJoystick` data format.
+struct DIJOYSTATE
+{
+    LONG lX;
+    LONG lY;
+    LONG lZ;
+    LONG lRx;
+    LONG lRy;
+    LONG lRz;
+    LONG rglSlider[2];
+    DWORD rgdwPOV[4];
+    BYTE rgbButtons[32];
+};
+
+/// Extended joystick state structure used by the built-in `c_dfDIJoystick2` data format.
+struct DIJOYSTATE2
+{
+    LONG lX;
+    LONG lY;
+    LONG lZ;
+    LONG lRx;
+    LONG lRy;
+    LONG lRz;
+    LONG rglSlider[2];
+    DWORD rgdwPOV[4];
+    BYTE rgbButtons[128];
+    LONG lVX;
+    LONG lVY;
+    LONG lVZ;
+    LONG lVRx;
+    LONG lVRy;
+    LONG lVRz;
+    LONG rglVSlider[2];
+    LONG lAX;
+    LONG lAY;
+    LONG lAZ;
+    LONG lARx;
+    LONG lARy;
+    LONG lARz;
+    LONG rglASlider[2];
+    LONG lFX;
+    LONG lFY;
+    LONG lFZ;
+    LONG lFRx;
+    LONG lFRy;
+    LONG lFRz;
+    LONG rglFSlider[2];
+};
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+#define DIDF_ABSAXIS                            0x00000001
+#define DIDF_RELAXIS                            0x00000002
+
+#define DIDFT_ALL                               0x00000000
+#define DIDFT_RELAXIS                           0x00000001
+#define DIDFT_ABSAXIS                           0x00000002
+#define DIDFT_AXIS                              0x00000003
+#define DIDFT_PSHBUTTON                         0x00000004
+#define DIDFT_TGLBUTTON                         0x00000008
+#define DIDFT_BUTTON                            0x0000000C
+#define DIDFT_POV                               0x00000010
+#define DIDFT_ANYINSTANCE                       0x00FFFF00
+#define DIDFT_OPTIONAL                          0x80000000
+
+#define DIDOI_ASPECTPOSITION                    0x00000100
+#define DIDOI_ASPECTVELOCITY                    0x00000200
+#define DIDOI_ASPECTACCEL                       0x00000300
+#define DIDOI_ASPECTFORCE                       0x00000400
+
+#define DIJOFS_X                                offsetof(DIJOYSTATE, lX)
+#define DIJOFS_Y                                offsetof(DIJOYSTATE, lY)
+#define DIJOFS_Z                                offsetof(DIJOYSTATE, lZ)
+#define DIJOFS_RX                               offsetof(DIJOYSTATE, lRx)
+#define DIJOFS_RY                               offsetof(DIJOYSTATE, lRy)
+#define DIJOFS_RZ                               offsetof(DIJOYSTATE, lRz)
+
+/// Predefined object type GUIDs, with the same values as those exported by the DirectInput libraries.
+inline constexpr GUID GUID_XAxis                = {0xa36d02e0, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_YAxis                = {0xa36d02e1, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_ZAxis                = {0xa36d02e2, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_RxAxis               = {0xa36d02f4, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_RyAxis               = {0xa36d02f5, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_RzAxis               = {0xa36d02e3, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_Slider               = {0xa36d02e4, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_Button               = {0xa36d02f0, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_Key                  = {0x55728220, 0xd33c, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_POV                  = {0xa36d02f2, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+inline constexpr GUID GUID_Unknown              = {0xa36d02f3, 0xc9f3, 0x11cf, {0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00}};
+
+
+// -------- MACROS --------------------------------------------------------- //
+
+#define DIDFT_MAKEINSTANCE(n)                   ((WORD)(n) << 8)
+#define DIDFT_GETTYPE(n)                        ((BYTE)(n))
+#define DIDFT_GETINSTANCE(n)                    ((WORD)((n) >> 8))
+
+#define DIJOFS_SLIDER(n)                        (offsetof(DIJOYSTATE, rglSlider) + ((n) * sizeof(LONG)))
+#define DIJOFS_POV(n)                           (offsetof(DIJOYSTATE, rgdwPOV) + ((n) * sizeof(DWORD)))
+#define DIJOFS_BUTTON(n)                        (offsetof(DIJOYSTATE, rgbButtons) + (n))
+
+#endif
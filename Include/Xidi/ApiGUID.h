@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 
 #include <cstddef>
 #include <functional>
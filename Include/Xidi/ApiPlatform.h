@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ApiPlatform.h
+ *   Common header file for the basic types and constants used by the
+ *   portable controller core. On Windows these come from the Windows API.
+ *   Elsewhere, equivalent definitions with identical sizes and values are
+ *   supplied here so that the core can be built without the Windows SDK.
+ *****************************************************************************/
+
+#pragma once
+
+
+#ifdef _WIN32
+
+// -------- WINDOWS API ---------------------------------------------------- //
+
+#include "ApiWindows.h"
+
+#include <sal.h>
+
+#else
+
+#include <cstdint>
+#include <cstring>
+
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+typedef int32_t                                 BOOL;
+typedef uint8_t                                 BYTE;
+typedef uint16_t                                WORD;
+typedef uint32_t                                DWORD;
+typedef int16_t                                 SHORT;
+typedef int32_t                                 LONG;
+typedef int32_t                                 HRESULT;
+
+/// Globally-unique identifier, laid out identically to its Windows API counterpart.
+struct GUID
+{
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+};
+
+typedef const GUID&                             REFGUID;
+
+/// Compares two GUIDs for equality, as the Windows API allows.
+inline bool operator==(REFGUID lhs, REFGUID rhs)
+{
+    return (0 == memcmp(&lhs, &rhs, sizeof(GUID)));
+}
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+#define TRUE                                    1
+#define FALSE                                   0
+
+#define ERROR_SUCCESS                           0L
+#define ERROR_INVALID_ACCESS                    12L
+#define ERROR_NOT_SUPPORTED                     50L
+#define ERROR_BAD_ARGUMENTS                     160L
+#define ERROR_DEVICE_NOT_CONNECTED              1167L
+
+
+// -------- MACROS --------------------------------------------------------- //
+
+#define _countof(array)                         (sizeof(array) / sizeof((array)[0]))
+#define ZeroMemory(destination, length)         memset((destination), 0, (length))
+#define FillMemory(destination, length, fill)   memset((destination), (fill), (length))
+#define _CRT_WIDE_(str)                         L ## str
+#define _CRT_WIDE(str)                          _CRT_WIDE_(str)
+#define __FILEW__                               _CRT_WIDE(__FILE__)
+#define _Printf_format_string_
+
+#endif
@@ -0,0 +1,71 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ApiXInput.h
+ *   Common header file for the XInput gamepad state structures and
+ *   constants. On Windows these come from the XInput API. Elsewhere,
+ *   equivalent definitions with identical layouts and values are supplied
+ *   here so that the controller core can consume XInput-format input.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiPlatform.h"
+
+
+#ifdef _WIN32
+
+// -------- XINPUT API ----------------------------------------------------- //
+
+#include <xinput.h>
+
+#else
+
+// -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+/// State of an XInput gamepad's buttons, triggers, and analog sticks.
+/// Every member defaults to zero, so initializers that name only some members leave the rest neutral, exactly as they would be if value-initialized.
+struct XINPUT_GAMEPAD
+{
+    WORD wButtons = 0;
+    BYTE bLeftTrigger = 0;
+    BYTE bRightTrigger = 0;
+    SHORT sThumbLX = 0;
+    SHORT sThumbLY = 0;
+    SHORT sThumbRX = 0;
+    SHORT sThumbRY = 0;
+};
+
+/// State of an XInput controller, tagged with a packet number that changes whenever the state changes.
+/// Every member defaults to zero, so initializers that name only some members leave the rest neutral, exactly as they would be if value-initialized.
+struct XINPUT_STATE
+{
+    DWORD dwPacketNumber = 0;
+    XINPUT_GAMEPAD Gamepad = {};
+};
+
+
+// -------- CONSTANTS ------------------------------------------------------ //
+
+#define XUSER_MAX_COUNT                         4
+
+#define XINPUT_GAMEPAD_DPAD_UP                  0x0001
+#define XINPUT_GAMEPAD_DPAD_DOWN                0x0002
+#define XINPUT_GAMEPAD_DPAD_LEFT                0x0004
+#define XINPUT_GAMEPAD_DPAD_RIGHT               0x0008
+#define XINPUT_GAMEPAD_START                    0x0010
+#define XINPUT_GAMEPAD_BACK                     0x0020
+#define XINPUT_GAMEPAD_LEFT_THUMB               0x0040
+#define XINPUT_GAMEPAD_RIGHT_THUMB              0x0080
+#define XINPUT_GAMEPAD_LEFT_SHOULDER            0x0100
+#define XINPUT_GAMEPAD_RIGHT_SHOULDER           0x0200
+#define XINPUT_GAMEPAD_A                        0x1000
+#define XINPUT_GAMEPAD_B                        0x2000
+#define XINPUT_GAMEPAD_X                        0x4000
+#define XINPUT_GAMEPAD_Y                        0x8000
+
+#endif
@@ -0,0 +1,146 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BackgroundWorker.h
+ *   Declaration of a background thread that runs until asked to stop.
+ *****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace Xidi
+{
+    /// Owns a background thread that runs until it is asked to stop, along with the stop request and the means of delivering it.
+    /// The thread body sleeps between iterations using #WaitFor, which returns early if a stop is requested or #Notify is invoked. Bodies that instead block on something else check #IsStopRequested once they wake up.
+    /// Stopping is split into #RequestStop and #Stop so that owners can unblock the thread in between, and the thread is always joined without holding the lock it needs to observe the stop request.
+    /// All methods are concurrency-safe, except for #Abandon.
+    class BackgroundWorker
+    {
+    private:
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+#ifdef _WIN32
+        /// Handle of a background thread, or `nullptr` if there is none.
+        /// On Windows the thread is created using `CreateThread` rather than `std::thread`, because it exits using `FreeLibraryAndExitThread` and `std::thread` expects its thread function to return so that it can clean up after it.
+        typedef void* TThread;
+#else
+        /// Background thread.
+        typedef std::thread TThread;
+#endif
+
+
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Serializes access to the state of the background thread.
+        std::mutex workerMutex;
+
+        /// Wakes the background thread when it needs to stop or has been notified.
+        std::condition_variable workerCondition;
+
+        /// Whether the background thread has been asked to stop.
+        bool stopRequested;
+
+        /// Whether the background thread has been notified since it last finished waiting.
+        bool notified;
+
+        /// Whether the background thread has been abandoned, after which this object no longer synchronizes with it.
+        std::atomic<bool> abandoned;
+
+        /// Background thread, if it is running.
+        TThread workerThread;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default constructor.
+        /// The background thread is not started until #Start is invoked.
+        BackgroundWorker(void);
+
+        /// Copy constructor. Should never be invoked.
+        BackgroundWorker(const BackgroundWorker& other) = delete;
+
+        /// Default destructor. Stops the background thread if it is running.
+        ~BackgroundWorker(void);
+
+
+    private:
+        // -------- CLASS METHODS ------------------------------------------ //
+
+        /// Stops tracking the specified background thread without waiting for it to exit.
+        /// @param [in,out] thread Background thread to stop tracking. Has no effect if there is none.
+        static void DetachThread(TThread& thread);
+
+        /// Determines if the specified background thread exists and has not yet been joined or detached.
+        /// @param [in] thread Background thread to check.
+        /// @return `true` if so, `false` otherwise.
+        static bool IsThreadJoinable(const TThread& thread);
+
+        /// Waits for the specified background thread to exit and then stops tracking it.
+        /// @param [in,out] thread Background thread to wait for. Has no effect if there is none.
+        static void JoinThread(TThread& thread);
+
+        /// Creates a background thread that runs the specified function.
+        /// @param [in] threadBody Function to run on the background thread.
+        /// @return Newly-created background thread, which does not exist if it could not be created.
+        static TThread StartThread(std::function<void(void)> threadBody);
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Forgets about the background thread without asking it to stop or waiting for it, after which all other methods that synchronize with the thread have no effect.
+        /// Intended only for use as the process terminates, at which point the operating system has already exited the thread, possibly while it held locks that would otherwise be needed to stop it.
+        /// Not concurrency-safe.
+        void Abandon(void);
+
+        /// Determines if the background thread has been abandoned using #Abandon.
+        /// Owners use this to skip any of their own teardown that would synchronize with the thread.
+        /// @return `true` if so, `false` otherwise.
+        inline bool IsAbandoned(void) const
+        {
+            return abandoned.load(std::memory_order_relaxed);
+        }
+
+        /// Determines if the background thread is running.
+        /// @return `true` if so, `false` otherwise.
+        bool IsRunning(void);
+
+        /// Determines if the background thread has been asked to stop.
+        /// @return `true` if so, `false` otherwise.
+        bool IsStopRequested(void);
+
+        /// Wakes the background thread if it is waiting using #WaitFor, or causes its next wait to return immediately.
+        void Notify(void);
+
+        /// Asks the background thread to stop without waiting for it to exit.
+        void RequestStop(void);
+
+        /// Starts the background thread.
+        /// On Windows the thread holds a reference to the module that contains Xidi for as long as it runs, so the module cannot be unloaded while the thread is using it.
+        /// As a result the module is only ever unloaded before the process terminates if every background thread has been stopped beforehand, and no background thread ever needs to be stopped from within the DLL entry point.
+        /// @param [in] threadBody Function to run on the background thread. It should return once a stop is requested.
+        /// @return `true` if the background thread was started, `false` if it was already running or could not be created.
+        bool Start(std::function<void(void)> threadBody);
+
+        /// Asks the background thread to stop and waits for it to exit. Has no effect if it is not running.
+        /// Must not be invoked from within the DLL entry point, nor while holding any lock that the thread body needs in order to return.
+        void Stop(void);
+
+        /// Waits for up to the specified amount of time. Invoked by the background thread between iterations.
+        /// @param [in] nanoseconds Maximum amount of time to wait, in nanoseconds.
+        /// @return `true` if the background thread should continue running, `false` if it has been asked to stop.
+        bool WaitFor(uint64_t nanoseconds);
+    };
+}
@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BatchMapper.h
+ *   Declaration of the object that maps XInput controller states for many
+ *   virtual controller slots together and applies each slot's axis
+ *   properties to the results.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "VirtualController.h"
+
+#include <cstdint>
+#include <span>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        /// Maps raw XInput controller states for up to #kBatchSlotCountMax virtual controller slots at once, using the same mapper for every slot, and applies each slot's axis deadzone, saturation, and range.
+        /// All data is held as a structure of arrays with one lane per slot, and every step processes one controller element for all slots together using loops whose bodies are free of branches, so that the compiler can vectorize them.
+        /// A scalar reference path that processes one slot at a time using #Mapper::MapXInputState and #VirtualController::TransformAxisValue produces identical results and is kept available for validation.
+        /// Granularity and hysteresis are not applied because they depend on previously-reported values, which remain the responsibility of each virtual controller.
+        /// Not currently used by the DLLs, which refresh each virtual controller individually. Only the tests and the portable core library build it, for validation and benchmarking.
+        /// Not concurrency-safe.
+        class BatchMapper
+        {
+        public:
+            // -------- TYPE DEFINITIONS ----------------------------------- //
+
+            /// Properties of a single axis for every slot in a batch, laid out as a structure of arrays.
+            /// See #VirtualController::SAxisProperties for the meaning of each field.
+            struct SAxisPropertiesBatch
+            {
+                alignas(16) int32_t deadzoneRawCutoffPositive[kBatchSlotCountMax];
+                alignas(16) int32_t deadzoneRawCutoffNegative[kBatchSlotCountMax];
+                alignas(16) int32_t saturationRawCutoffPositive[kBatchSlotCountMax];
+                alignas(16) int32_t saturationRawCutoffNegative[kBatchSlotCountMax];
+                alignas(16) int32_t rangeMin[kBatchSlotCountMax];
+                alignas(16) int32_t rangeMax[kBatchSlotCountMax];
+                alignas(16) int32_t rangeNeutral[kBatchSlotCountMax];
+            };
+
+
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Mapper used for every slot.
+            const Mapper& mapper;
+
+            /// Axis properties of every slot, one batch per axis, used by the vectorized path.
+            SAxisPropertiesBatch axisPropertiesBatch[(int)EAxis::Count];
+
+            /// Axis properties of every slot, one set per slot, used by the scalar reference path.
+            VirtualController::SAxisProperties axisProperties[kBatchSlotCountMax][(int)EAxis::Count];
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// Every slot starts out with default axis properties.
+            /// @param [in] mapper Mapper to use for every slot. Must outlive this object.
+            BatchMapper(const Mapper& mapper);
+
+            /// Copy constructor. Should never be invoked.
+            BatchMapper(const BatchMapper& other) = delete;
+
+
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Transforms the raw values of a single axis for every slot in a batch using the supplied axis properties.
+            /// Result in each slot is identical to the result of #VirtualController::TransformAxisValue.
+            /// @param [in,out] axisValues Raw axis values as obtained from a mapper, one per slot, which are replaced by the transformed values.
+            /// @param [in] axisPropertiesBatch Axis properties to apply, one set per slot.
+            /// @param [in] slotCount Number of slots to process, starting from the first. Must not exceed #kBatchSlotCountMax.
+            static void TransformAxisValueBatch(int32_t* axisValues, const SAxisPropertiesBatch& axisPropertiesBatch, unsigned int slotCount);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Retrieves the mapper used for every slot.
+            /// @return Mapper object.
+            inline const Mapper& GetMapper(void) const
+            {
+                return mapper;
+            }
+
+            /// Maps a batch of XInput controller states and applies each slot's axis properties, processing all slots together.
+            /// @param [in] xinputStates XInput controller state batch from which to read.
+            /// @param [out] controllerStates Controller states to be filled, one per slot. The number of slots processed is the number of controller states, which must not exceed #kBatchSlotCountMax.
+            void MapXInputStates(const Mapper::SXInputBatch& xinputStates, std::span<SState> controllerStates) const;
+
+            /// Maps a batch of XInput controller states and applies each slot's axis properties, processing one slot at a time.
+            /// Scalar reference path, whose results are identical to those of #MapXInputStates.
+            /// @param [in] xinputStates XInput controller state batch from which to read.
+            /// @param [out] controllerStates Controller states to be filled, one per slot. The number of slots processed is the number of controller states, which must not exceed #kBatchSlotCountMax.
+            void MapXInputStatesReference(const Mapper::SXInputBatch& xinputStates, std::span<SState> controllerStates) const;
+
+            /// Sets the axis properties of a single slot.
+            /// Only deadzone, saturation, and range are used.
+            /// @param [in] slot Slot whose axis properties are to be set.
+            /// @param [in] properties Properties from which to take the axis properties, typically those of the virtual controller that occupies the slot.
+            void SetAxisProperties(unsigned int slot, const VirtualController::SProperties& properties);
+        };
+    }
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Clock.h
+ *   Declaration of the interface through which virtual controllers obtain the
+ *   times at which controller states are captured.
+ *****************************************************************************/
+
+#pragma once
+
+#include "Platform.h"
+
+#include <cstdint>
+
+
+namespace Xidi
+{
+    /// Clock interface class.
+    /// Supplies monotonic timestamps with nanosecond units, which virtual controllers use to record when each controller state was captured.
+    /// The purpose of exposing the clock this way is to facilitate easier testing by substituting a clock whose time is fully controlled by the test.
+    class IClock
+    {
+    public:
+        // -------- ABSTRACT INSTANCE METHODS ------------------------------ //
+
+        /// Retrieves the current time.
+        /// Successive values never decrease, but the starting point is arbitrary.
+        /// @return Current time, in nanoseconds.
+        virtual uint64_t GetTimestamp(void) const = 0;
+    };
+
+    /// Default implementation of the clock interface.
+    /// Reads the highest-resolution monotonic counter that the platform offers.
+    class SystemClock : public IClock
+    {
+    public:
+        // -------- CLASS METHODS ------------------------------------------ //
+
+        /// Retrieves the system clock object that is used whenever no other clock is supplied.
+        /// @return Reference to the system clock.
+        static inline const SystemClock& GetInstance(void)
+        {
+            static const SystemClock systemClock;
+            return systemClock;
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        uint64_t GetTimestamp(void) const override
+        {
+            return Platform::GetNanosecondTimestamp();
+        }
+    };
+}
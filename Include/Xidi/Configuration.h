@@ -17,8 +17,11 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
+#include <unordered_set>
+#include <vector>
 
 
 namespace Xidi
@@ -71,9 +74,11 @@ namespace Xidi
         typedef bool TBooleanValue;
 
         /// Underlying type used for storing string-valued types.
-        typedef std::wstring TStringValue;
+        /// Once stored in a configuration data object, refers to a string interned within that object.
+        typedef std::wstring_view TStringValue;
 
         /// Fourth-level object used to represent a single configuration value for a particular configuration setting.
+        /// String-typed values do not own their contents, so values are small and trivially copyable.
         class Value
         {
         private:
@@ -107,93 +112,27 @@ namespace Xidi
             // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
 
             /// Initialization constructor. Creates an integer-typed value.
-            inline Value(const TIntegerValue& value) : type(EValueType::Integer), intValue(value)
+            inline constexpr Value(const TIntegerValue& value) : type(EValueType::Integer), intValue(value)
             {
                 // Nothing to do here.
             }
 
             /// Initialization constructor. Creates a Boolean-typed value.
-            inline Value(const TBooleanValue& value) : type(EValueType::Boolean), boolValue(value)
+            inline constexpr Value(const TBooleanValue& value) : type(EValueType::Boolean), boolValue(value)
             {
                 // Nothing to do here.
             }
 
             /// Initialization constructor. Creates a string-typed value.
-            inline Value(const TStringValue& value) : type(EValueType::String), stringValue(value)
+            inline constexpr Value(const TStringValue& value) : type(EValueType::String), stringValue(value)
             {
                 // Nothing to do here.
             }
 
-            /// Default destructor.
-            inline ~Value(void)
-            {
-                switch (type)
-                {
-                case EValueType::Integer:
-                    intValue.~TIntegerValue();
-                    break;
-
-                case EValueType::Boolean:
-                    boolValue.~TBooleanValue();
-                    break;
-
-                case EValueType::String:
-                    stringValue.~TStringValue();
-                    break;
-
-                default:
-                    break;
-                }
-            }
-
-            /// Copy constructor.
-            inline Value(const Value& other) : type(other.type)
-            {
-                switch (other.type)
-                {
-                case EValueType::Integer:
-                    new (&intValue) TIntegerValue(other.intValue);
-                    break;
-
-                case EValueType::Boolean:
-                    new (&boolValue) TBooleanValue(other.boolValue);
-                    break;
-
-                case EValueType::String:
-                    new (&stringValue) TStringValue(other.stringValue);
-                    break;
-
-                default:
-                    break;
-                }
-            }
-
-            /// Move constructor.
-            inline Value(Value&& other) : type(std::move(other.type))
-            {
-                switch (other.type)
-                {
-                case EValueType::Integer:
-                    new (&intValue) TIntegerValue(std::move(other.intValue));
-                    break;
-
-                case EValueType::Boolean:
-                    new (&boolValue) TBooleanValue(std::move(other.boolValue));
-                    break;
-
-                case EValueType::String:
-                    new (&stringValue) TStringValue(std::move(other.stringValue));
-                    break;
-
-                default:
-                    break;
-                }
-            }
-
 
             // -------- OPERATORS ---------------------------------------------- //
 
-            /// Allows less-than comparison to support many standard containers that use this type of comparison for sorting.
+            /// Allows less-than comparison to support sorting and searching.
             /// @param [in] rhs Right-hand side of the binary operator.
             /// @return `true` if this object (lhs) is less than the other object (rhs), `false` otherwise.
             inline bool operator<(const Value& rhs) const
@@ -231,26 +170,26 @@ namespace Xidi
                 return type;
             }
 
-            /// Retrieves and returns an immutable reference to the stored value as an integer.
+            /// Retrieves and returns a copy of the stored value as an integer.
             /// Does not ensure the type of value is actually integer.
             /// @return Stored value.
-            inline const TIntegerView GetIntegerValue(void) const
+            inline TIntegerView GetIntegerValue(void) const
             {
                 return intValue;
             }
 
-            /// Retrieves and returns an immutable reference to the stored value as a Boolean.
+            /// Retrieves and returns a copy of the stored value as a Boolean.
             /// Does not ensure the type of value is actually Boolean.
             /// @return Stored value.
-            inline const TBooleanView GetBooleanValue(void) const
+            inline TBooleanView GetBooleanValue(void) const
             {
                 return boolValue;
             }
 
-            /// Retrieves and returns an immutable reference to the stored value as a string.
+            /// Retrieves and returns a read-only view of the stored value as a string.
             /// Does not ensure the type of value is actually string.
             /// @return Stored value.
-            inline const TStringView GetStringValue(void) const
+            inline TStringView GetStringValue(void) const
             {
                 return stringValue;
             }
@@ -258,22 +197,35 @@ namespace Xidi
         };
 
         /// Third-level object used to represent a single configuration setting within one section of a configuration file.
+        /// Refers to a contiguous and sorted range of values owned by the enclosing configuration data object.
         class Name
         {
         private:
             // -------- TYPE DEFINITIONS ----------------------------------- //
 
             /// Alias for the underlying data structure used to store per-setting configuration values.
-            typedef std::set<Value> TValues;
+            typedef std::span<const Value> TValues;
 
 
             // -------- INSTANCE VARIABLES --------------------------------- //
 
-            /// Holds all values for each configuration setting, one element per value.
+            /// Name of the configuration setting. Interned by the enclosing configuration data object.
+            std::wstring_view name;
+
+            /// All values for the configuration setting, one element per value, in sorted order.
             TValues values;
 
 
         public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor. Should only be invoked by the enclosing configuration data object.
+            inline constexpr Name(std::wstring_view name, TValues values) : name(name), values(values)
+            {
+                // Nothing to do here.
+            }
+
+
             // -------- INSTANCE METHODS ----------------------------------- //
 
             /// Allows read-only access to the first stored value.
@@ -281,17 +233,14 @@ namespace Xidi
             /// @return First stored value.
             inline const Value& FirstValue(void) const
             {
-                return *(values.begin());
+                return values.front();
             }
 
-            /// Stores a new value for the configuration setting represented by this object.
-            /// Will fail if the value already exists.
-            /// @tparam ValueType Type of value to insert.
-            /// @param [in] value Value to insert.
-            /// @return `true` on success, `false` on failure.
-            template <typename ValueType> bool Insert(const ValueType& value)
+            /// Retrieves the name of the configuration setting represented by this object.
+            /// @return Configuration setting name.
+            inline std::wstring_view GetName(void) const
             {
-                return values.emplace(value).second;
+                return name;
             }
 
             /// Retrieves the number of values present for the configuration setting represented by this object.
@@ -304,29 +253,42 @@ namespace Xidi
             /// Allows read-only access to all values.
             /// Useful for iterating.
             /// @return Container of all values.
-            inline const TValues& Values(void) const
+            inline TValues Values(void) const
             {
                 return values;
             }
         };
 
         /// Second-level object used to represent an entire section of a configuration file.
+        /// Refers to a contiguous range of configuration settings, sorted by name, owned by the enclosing configuration data object.
         class Section
         {
         private:
             // -------- TYPE DEFINITIONS ----------------------------------- //
 
             /// Alias for the underlying data structure used to store per-section configuration settings.
-            typedef std::map<std::wstring, Name, std::less<>> TNames;
+            typedef std::span<const Name> TNames;
 
 
             // -------- INSTANCE VARIABLES --------------------------------- //
 
-            /// Holds configuration data within each section, one element per configuration setting.
+            /// Name of the section. Interned by the enclosing configuration data object.
+            std::wstring_view name;
+
+            /// Holds configuration data within each section, one element per configuration setting, sorted by name.
             TNames names;
 
 
         public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor. Should only be invoked by the enclosing configuration data object.
+            inline constexpr Section(std::wstring_view name, TNames names) : name(name), names(names)
+            {
+                // Nothing to do here.
+            }
+
+
             // -------- OPERATORS ------------------------------------------ //
 
             /// Allows read-only access to individual configuration settings by name, without bounds checking.
@@ -334,29 +296,22 @@ namespace Xidi
             /// @return Reference to the desired configuration setting.
             inline const Name& operator[](std::wstring_view name) const
             {
-                return names.find(name)->second;
+                return *FindName(name);
             }
 
 
             // -------- INSTANCE METHODS ----------------------------------- //
 
-            /// Stores a new value for the specified configuration setting in the section represented by this object.
-            /// Will fail if the value already exists.
-            /// @tparam ValueType Type of value to insert.
-            /// @param [in] name Name of the configuration setting into which to insert the value.
-            /// @param [in] value Value to insert.
-            /// @return `true` on success, `false` on failure.
-            template <typename ValueType> bool Insert(std::wstring_view name, const ValueType& value)
-            {
-                auto nameIterator = names.find(name);
-
-                if (names.end() == nameIterator)
-                {
-                    names.emplace(name, Name());
-                    nameIterator = names.find(name);
-                }
+            /// Searches for the configuration setting of the specified name.
+            /// @param [in] name Name of the configuration setting for which to search.
+            /// @return Pointer to the configuration setting if it exists, `nullptr` otherwise.
+            const Name* FindName(std::wstring_view name) const;
 
-                return nameIterator->second.Insert(value);
+            /// Retrieves the name of the section represented by this object.
+            /// @return Section name.
+            inline std::wstring_view GetName(void) const
+            {
+                return name;
             }
 
             /// Retrieves the number of configuration settings present for the section represented by this object.
@@ -371,33 +326,63 @@ namespace Xidi
             /// @return `true` if the setting exists, `false` otherwise.
             inline bool NameExists(std::wstring_view name) const
             {
-                return (0 != names.count(name));
+                return (nullptr != FindName(name));
             }
 
             /// Allows read-only access to all configuration settings.
             /// Useful for iterating.
             /// @return Container of all configuration settings.
-            inline const TNames& Names(void) const
+            inline TNames Names(void) const
             {
                 return names;
             }
         };
 
         /// Top-level object used to represent all configuration data read from a configuration file.
+        /// Filled in two phases. While it is being built, values are inserted one at a time and all strings are interned into an arena owned by this object.
+        /// Once built, the contents are laid out as flat sorted arrays of sections, configuration settings, and values, and the object is immutable.
+        /// All queries operate on the built representation, so they reflect only the contents present at the time the object was last built.
         class ConfigurationData
         {
         private:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Number of characters in each block of the string arena.
+            /// Strings longer than this are allocated in their own blocks.
+            static constexpr size_t kStringArenaBlockCount = 4096;
+
+
             // -------- TYPE DEFINITIONS ----------------------------------- //
 
             /// Alias for the underlying data structure used to store top-level configuration section data.
-            typedef std::map<std::wstring, Section, std::less<>> TSections;
+            typedef std::span<const Section> TSections;
 
+            /// Holds a single value that was inserted while building, along with the section and configuration setting to which it belongs.
+            struct SPendingValue
+            {
+                std::wstring_view section;                                  ///< Name of the section that holds the value.
+                std::wstring_view name;                                     ///< Name of the configuration setting that holds the value.
+                Value value;                                                ///< Value itself.
+
+                /// Allows less-than comparison so that pending values are ordered by section, then by configuration setting, then by value.
+                /// @param [in] rhs Right-hand side of the binary operator.
+                /// @return `true` if this object (lhs) is less than the other object (rhs), `false` otherwise.
+                inline bool operator<(const SPendingValue& rhs) const
+                {
+                    if (section != rhs.section)
+                        return (section < rhs.section);
+                    else if (name != rhs.name)
+                        return (name < rhs.name);
+                    else
+                        return (value < rhs.value);
+                }
+            };
 
             /// Holds an individual section and name pair.
             /// Used when responding to queries for all settings of a given name across all sections.
             struct SSectionNamePair
             {
-                std::wstring_view section;                                     ///< Name of the section that holds the identified configuration setting.
+                std::wstring_view section;                                  ///< Name of the section that holds the identified configuration setting.
                 const Name& name;                                           ///< Reference to the object that holds all values for the identified configuration setting.
 
                 /// Initialization constructor. Initializes both references.
@@ -413,11 +398,44 @@ namespace Xidi
 
             // -------- INSTANCE VARIABLES --------------------------------- //
 
-            /// Holds configuration data at the level of entire sections, one element per section.
-            TSections sections;
+            /// Blocks of memory that hold the contents of all interned strings.
+            std::vector<std::unique_ptr<wchar_t[]>> stringArenaBlocks;
+
+            /// Number of characters already used in the most recently allocated string arena block.
+            size_t stringArenaBlockUsedCount;
+
+            /// All interned strings, each of which refers to memory in the string arena.
+            std::unordered_set<std::wstring_view> internedStrings;
+
+            /// Values inserted since this object was last built. Ordering makes duplicate detection and building straightforward.
+            std::set<SPendingValue> pendingValues;
+
+            /// All values, grouped by section and configuration setting and sorted.
+            std::vector<Value> values;
+
+            /// All configuration settings, grouped by section and sorted by name.
+            std::vector<Name> names;
+
+            /// All sections, sorted by name.
+            std::vector<Section> sections;
 
 
         public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor.
+            inline ConfigurationData(void) : stringArenaBlocks(), stringArenaBlockUsedCount(kStringArenaBlockCount), internedStrings(), pendingValues(), values(), names(), sections()
+            {
+                // Nothing to do here.
+            }
+
+            /// Copy constructor. Should never be invoked.
+            ConfigurationData(const ConfigurationData& other) = delete;
+
+            /// Move constructor.
+            ConfigurationData(ConfigurationData&& other) = default;
+
+
             // -------- OPERATORS ------------------------------------------ //
 
             /// Allows read-only access to individual sections by name, without bounds checking.
@@ -425,38 +443,42 @@ namespace Xidi
             /// @return Reference to the desired section.
             inline const Section& operator[](std::wstring_view section) const
             {
-                return sections.find(section)->second;
+                return *FindSection(section);
             }
 
 
+        private:
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Places a copy of the specified string into the string arena, unless an identical string is already present.
+            /// @param [in] str String to intern.
+            /// @return View of the interned copy of the string, which remains valid until this object is cleared or destroyed.
+            std::wstring_view InternString(std::wstring_view str);
+
+
+        public:
             // -------- INSTANCE METHODS ----------------------------------- //
 
+            /// Lays out all values inserted since the last build as flat sorted arrays and makes them available for queries.
+            /// Any previously-built contents are replaced, and all references to them (such as via data structures returned by querying this object) are invalid.
+            void Build(void);
+
             /// Clears the contents of this object.
             /// After clearing, all references to its contents (such as via data structures returned by querying it) are invalid.
-            inline void Clear(void)
-            {
-                sections.clear();
-            }
+            void Clear(void);
+
+            /// Searches for the section of the specified name.
+            /// @param [in] section Name of the section for which to search.
+            /// @return Pointer to the section if it exists, `nullptr` otherwise.
+            const Section* FindSection(std::wstring_view section) const;
 
             /// Stores a new value for the specified configuration setting in the specified section.
-            /// Will fail if the value already exists.
-            /// @tparam ValueType Type of value to insert.
+            /// Will fail if the value already exists. The new value is not visible to queries until #Build is invoked.
             /// @param [in] section Section into which to insert the configuration setting.
             /// @param [in] name Name of the configuration setting into which to insert the value.
             /// @param [in] value Value to insert.
             /// @return `true` on success, `false` on failure.
-            template <typename ValueType> bool Insert(std::wstring_view section, std::wstring_view name, const ValueType& value)
-            {
-                auto sectionIterator = sections.find(section);
-
-                if (sections.end() == sectionIterator)
-                {
-                    sections.emplace(section, Section());
-                    sectionIterator = sections.find(section);
-                }
-
-                return sectionIterator->second.Insert(name, value);
-            }
+            bool Insert(std::wstring_view section, std::wstring_view name, const Value& value);
 
             /// Retrieves the number of sections present in the configuration represented by this object.
             /// @return Number of configuration settings present.
@@ -470,7 +492,7 @@ namespace Xidi
             /// @return `true` if the setting exists, `false` otherwise.
             inline bool SectionExists(std::wstring_view section) const
             {
-                return (0 != sections.count(section));
+                return (nullptr != FindSection(section));
             }
 
             /// Determines if a configuration setting of the specified name exists in the specified section.
@@ -479,17 +501,17 @@ namespace Xidi
             /// @return `true` if the setting exists, `false` otherwise.
             inline bool SectionNamePairExists(std::wstring_view section, std::wstring_view name) const
             {
-                auto sectionIterator = sections.find(section);
-                if (sections.end() == sectionIterator)
+                const Section* const kSection = FindSection(section);
+                if (nullptr == kSection)
                     return false;
 
-                return sectionIterator->second.NameExists(name);
+                return kSection->NameExists(name);
             }
 
             /// Allows read-only access to all sections.
             /// Useful for iterating.
             /// @return Container of all sections.
-            inline const TSections& Sections(void) const
+            inline TSections Sections(void) const
             {
                 return sections;
             }
@@ -504,10 +526,11 @@ namespace Xidi
             {
                 std::unique_ptr<TSectionNamePairList> sectionsWithName = std::make_unique<TSectionNamePairList>();
 
-                for (auto& section : sections)
+                for (const auto& section : sections)
                 {
-                    if (section.second.NameExists(name))
-                        sectionsWithName->emplace_back(section.first, section.second[name]);
+                    const Name* const kName = section.FindName(name);
+                    if (nullptr != kName)
+                        sectionsWithName->emplace_back(section.GetName(), *kName);
                 }
 
                 return sectionsWithName;
@@ -543,7 +566,17 @@ namespace Xidi
                 return readErrorMessage;
             }
 
+            /// Parses configuration data that has already been loaded into memory, storing the settings in the supplied configuration object.
+            /// The entire buffer is tokenized in a single pass without copying individual lines.
+            /// Intended to be invoked externally. Subclasses should not override this method.
+            /// @param [in] configSourceName Name of the source of the configuration data, used only for error messages.
+            /// @param [in] configBuffer Contents of the configuration data to parse.
+            /// @param [out] configToFill Configuration object to fill with configuration data (contents are only valid if this method succeeds).
+            /// @return Indicator of the result of the operation.
+            EFileReadResult ReadConfigurationBuffer(std::wstring_view configSourceName, std::wstring_view configBuffer, ConfigurationData& configToFill);
+
             /// Reads and parses a configuration file, storing the settings in the supplied configuration object.
+            /// The whole file is read into memory at once and then parsed using #ReadConfigurationBuffer.
             /// Intended to be invoked externally. Subclasses should not override this method.
             /// @param [in] configFileName Name of the configuration file to read.
             /// @param [out] configToFill Configuration object to fill with configuration data (contents are only valid if this method succeeds).
@@ -596,6 +629,14 @@ namespace Xidi
 
             // -------- CONCRETE INSTANCE METHODS -------------------------- //
 
+            /// Invoked at the end of a configuration file read operation, once every value has been individually checked and the configuration data object has been built.
+            /// Subclasses are given the opportunity to check relationships between configuration settings that cannot be verified one value at a time, such as references from one section to another.
+            /// Overriding this method is optional, as a default implementation exists that accepts all configuration data.
+            /// @param [in] configData Configuration data that was read.
+            /// @param [out] errorDescription Filled with a description of the problem if the configuration data is rejected.
+            /// @return `true` if the configuration data are acceptable, `false` otherwise.
+            virtual bool CheckConfiguration(const ConfigurationData& configData, std::wstring& errorDescription);
+
             /// Invoked at the start of a configuration file read operation.
             /// Subclasses are given the opportunity to initialize or reset any stored state, as needed.
             /// Overriding this method is optional, as a default implementation exists that does nothing.
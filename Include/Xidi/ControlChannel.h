@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControlChannel.h
+ *   Declaration of an interface for local line-oriented connections through
+ *   which external tools control and query a running process.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+
+namespace Xidi
+{
+    /// Control connection interface class.
+    /// Represents a single connected client, which exchanges lines of text with the process.
+    class IControlConnection
+    {
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default destructor.
+        virtual ~IControlConnection(void) = default;
+
+
+        // -------- ABSTRACT INSTANCE METHODS ------------------------------ //
+
+        /// Closes the connection. Any read or write in progress on another thread fails as a result.
+        /// Concurrency-safe, and has no effect if the connection is already closed.
+        virtual void Close(void) = 0;
+
+        /// Reads a single line from the client, blocking until a complete line is available.
+        /// @param [out] line Line that was read, without its line terminator.
+        /// @return `true` if a line was read, `false` if the connection was closed, failed, or sent a line that is too long.
+        virtual bool ReadLine(std::string& line) = 0;
+
+        /// Writes a single line to the client. A line terminator is appended automatically.
+        /// @param [in] line Line to write, without a line terminator.
+        /// @return `true` if the line was written, `false` if the connection was closed or failed.
+        virtual bool WriteLine(std::string_view line) = 0;
+    };
+
+    /// Control listener interface class.
+    /// Accepts connections from clients one at a time.
+    /// The purpose of exposing listener operations this way is to allow a different transport to be substituted, for example during testing.
+    class IControlListener
+    {
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default destructor.
+        virtual ~IControlListener(void) = default;
+
+
+        // -------- ABSTRACT INSTANCE METHODS ------------------------------ //
+
+        /// Releases the endpoint on which clients connect without synchronizing with any other thread, after which destroying the listener does not synchronize with other threads either.
+        /// Intended only for use as the process terminates, at which point the operating system has already exited any thread waiting for a client, possibly while it held a lock.
+        /// Not concurrency-safe.
+        virtual void Abandon(void) = 0;
+
+        /// Waits for a client to connect.
+        /// @return Connection to the client, or `nullptr` if the listener was closed or failed.
+        virtual std::unique_ptr<IControlConnection> Accept(void) = 0;
+
+        /// Closes the listener. Any wait for a client in progress on another thread fails as a result.
+        /// Concurrency-safe, and has no effect if the listener is already closed.
+        virtual void Close(void) = 0;
+    };
+
+    /// Default implementation of the control listener interface.
+    /// Listens on a named pipe on Windows and on a UNIX domain socket elsewhere, either of which is reachable only from the local machine.
+    class LocalControlListener : public IControlListener
+    {
+    public:
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Maximum length of a single line, in bytes. Clients that send longer lines are disconnected.
+        static constexpr size_t kMaxLineLength = 1024;
+
+
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Name of the endpoint on which clients connect.
+        const std::string kEndpointName;
+
+        /// Serializes access to the state of the listener.
+        std::mutex listenerMutex;
+
+        /// Whether the listener has been closed.
+        bool closed;
+
+        /// Whether the listener has been abandoned, in which case its destructor does not synchronize with other threads.
+        bool abandoned;
+
+        /// Platform handle on which the listener waits for clients, or -1 if there is none.
+        /// On Windows this is the pipe instance awaiting a client, and elsewhere it is the listening socket.
+        intptr_t listenHandle;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Creates the endpoint on which clients connect.
+        /// @param [in] processId PID of the current process, which determines the name of the endpoint.
+        LocalControlListener(uint32_t processId);
+
+        /// Copy constructor. Should never be invoked.
+        LocalControlListener(const LocalControlListener& other) = delete;
+
+        /// Default destructor.
+        /// Closes the listener and removes the endpoint.
+        ~LocalControlListener(void) override;
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+
+        /// Generates the name of the endpoint created by the specified process.
+        /// @param [in] processId PID of the process that creates the endpoint.
+        /// @return Pipe name on Windows, or socket path elsewhere.
+        static std::string EndpointName(uint32_t processId);
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void Abandon(void) override;
+        std::unique_ptr<IControlConnection> Accept(void) override;
+        void Close(void) override;
+    };
+}
@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControlEndpoint.h
+ *   Declaration of the endpoint through which external tools query and tune
+ *   running virtual controllers.
+ *****************************************************************************/
+
+#pragma once
+
+#include "BackgroundWorker.h"
+#include "ControlChannel.h"
+#include "VirtualController.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        /// Serves a compact line protocol through which external tools query and tune the virtual controllers presented to applications.
+        /// Each request is a single line of space-separated words, and each response is a single line that begins with `OK` or `ERR`.
+        /// Supported requests are as follows.
+        ///  - `list` reports the identifiers of all registered controllers.
+        ///  - `state <id>` reports the most recent state of a controller without refreshing it.
+        ///  - `properties <id>` reports the mapper, the properties of every axis, and the device-wide properties of a controller.
+        ///  - `counters <id>` reports event buffer and suppression counters of a controller, plus live statistics if they are being recorded.
+        ///  - `set <id|all> [axis=<name>] <property>=<value> ...` changes any of `deadzone`, `saturation`, `granularity`, `hysteresis`, `range=<min>,<max>`, `ffgain`, `buffer`, or `mapper`.
+        /// All changes in a single `set` request are validated together and applied together using #VirtualController::StagePropertyChanges, so they never block a controller that is being refreshed.
+        /// Controllers are identified by the identifiers applications see. Several registered controllers may share an identifier, in which case queries report the first of them and changes apply to all of them.
+        class ControlEndpoint
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Registered controllers. Not owned by this object.
+            std::vector<VirtualController*> controllers;
+
+            /// Serializes access to the registered controllers.
+            std::mutex controllersMutex;
+
+            /// Listener on which clients connect, if the serving thread is running.
+            std::unique_ptr<IControlListener> listener;
+
+            /// Connection to the client currently being served, if any. Owned by the serving thread.
+            IControlConnection* activeConnection;
+
+            /// Serializes access to the listener and the active connection.
+            std::mutex servingMutex;
+
+            /// Background thread that serves clients.
+            BackgroundWorker servingWorker;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor.
+            /// The serving thread is not started until #Start is invoked.
+            ControlEndpoint(void);
+
+            /// Copy constructor. Should never be invoked.
+            ControlEndpoint(const ControlEndpoint& other) = delete;
+
+            /// Default destructor. Stops the serving thread if it is running.
+            ~ControlEndpoint(void);
+
+
+        private:
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Finds all registered controllers that have the specified identifier, or all registered controllers.
+            /// Caller must hold the controllers lock.
+            /// @param [in] controllerIdString Controller identifier, as it appears in a request, or `all`.
+            /// @return Matching controllers, which is empty if the identifier is malformed or no controller matches.
+            std::vector<VirtualController*> FindControllersLocked(std::string_view controllerIdString) const;
+
+            /// Entry point for the serving thread.
+            void ServingThreadMain(void);
+
+
+        public:
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Retrieves the endpoint with which virtual controllers presented to applications are registered.
+            /// It does not serve any clients until it is started, which happens only if enabled in the configuration file.
+            /// @return Reference to the default endpoint.
+            static ControlEndpoint& GetDefault(void);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Abandons the serving thread as the process terminates, without waiting for it or acquiring any locks, and closes the endpoint on which clients connect.
+            /// Afterwards this object no longer synchronizes with the serving thread, even as it is stopped or destroyed.
+            void Abandon(void);
+
+            /// Registers a controller. It must remain valid until it is unregistered using #RemoveController.
+            /// @param [in] controller Controller to register.
+            void AddController(VirtualController* controller);
+
+            /// Handles a single request and generates the response.
+            /// Invoked by the serving thread for each line received, and can be invoked directly.
+            /// @param [in] request Request line, without its line terminator.
+            /// @return Response line, without a line terminator.
+            std::string HandleRequest(std::string_view request);
+
+            /// Determines if the serving thread is running.
+            /// @return `true` if so, `false` otherwise.
+            bool IsRunning(void);
+
+            /// Unregisters a controller. Once this method returns, the endpoint no longer accesses the controller.
+            /// @param [in] controller Controller to unregister.
+            void RemoveController(VirtualController* controller);
+
+            /// Starts the serving thread, which accepts clients from the specified listener one at a time. Has no effect if it is already running.
+            /// @param [in] newListener Listener on which clients connect. Ownership is transferred.
+            void Start(std::unique_ptr<IControlListener>&& newListener);
+
+            /// Stops the serving thread, disconnects any client being served, and waits for the thread to exit.
+            /// Has no effect if the serving thread is not running.
+            void Stop(void);
+        };
+    }
+}
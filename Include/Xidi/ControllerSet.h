@@ -0,0 +1,175 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSet.h
+ *   Declaration of a set of virtual controllers that are refreshed together.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "Clock.h"
+#include "ControllerSourceRegistry.h"
+#include "ControllerTypes.h"
+#include "PrefetchScheduler.h"
+#include "VirtualController.h"
+#include "XInputInterface.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        /// Holds one virtual controller for each virtual controller slot and refreshes all of them together.
+        /// A refresh reads every slot in one pass, maps each result into its virtual controller, and publishes the resulting states as one snapshot.
+        /// Slots found to be disconnected are read again only periodically rather than during every refresh, because reading a disconnected XInput slot is far slower than reading a connected one.
+        /// Per-slot data lives in contiguous arrays sized when the set is created, so the cost of a refresh grows linearly with the number of slots and nothing is allocated while refreshing.
+        /// Consumers that read several controllers therefore observe all of them as of the same instant, and fetching all of their states is a single synchronized operation.
+        /// Learns how often the application reads individual states so that a prefetch scheduler can refresh the whole set ahead of time on the application's behalf.
+        /// All methods are concurrency-safe.
+        class ControllerSet : public IPrefetchTarget
+        {
+        public:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Time, in nanoseconds, that must pass after a slot is found to be disconnected before a refresh reads it again.
+            /// Until then every refresh reuses the disconnected result, so a newly-connected controller is picked up within this amount of time.
+            static constexpr uint64_t kDisconnectedSlotPollInterval = 500000000ull;
+
+
+            // -------- TYPE DEFINITIONS ----------------------------------- //
+
+            /// Holds the states of all virtual controllers in the set as of the same refresh.
+            struct SSnapshot
+            {
+                uint32_t generation;                                        ///< Number of refreshes completed when this snapshot was published. Zero means no refresh has happened yet.
+                std::vector<SState> state;                                  ///< State of each virtual controller, indexed by controller identifier.
+            };
+
+
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Number of virtual controllers the set can hold. Fixed at construction, and never more than #ControllerSourceRegistry::kMaxSlotCount.
+            const VirtualController::TControllerIdentifier kControllerCount;
+
+            /// Virtual controllers in the set, indexed by controller identifier. Slots without a controller report neutral state.
+            /// Once a slot holds a controller, that controller is never replaced or destroyed for the lifetime of the set, which is what allows pointers to it to be used without holding the set lock.
+            std::vector<std::unique_ptr<VirtualController>> controllers;
+
+            /// Serializes refreshes and access to the published snapshot.
+            std::mutex setMutex;
+
+            /// Most recently published snapshot.
+            SSnapshot snapshot;
+
+            /// For each controller, specifies whether its state in the current snapshot has already been retrieved individually using #GetState.
+            /// Retrieving an already-retrieved state triggers a refresh of the whole set, which mirrors how individual virtual controllers decide when to refresh.
+            std::vector<uint8_t> stateRetrieved;
+
+            /// Result of reading each XInput slot during the most recent refresh. Kept between refreshes only to avoid reallocating it each time.
+            std::vector<DWORD> xinputGetStateResults;
+
+            /// State read from each XInput slot during the most recent refresh. Kept between refreshes only to avoid reallocating it each time.
+            std::vector<XINPUT_STATE> xinputStates;
+
+            /// For each XInput slot that was disconnected when it was last read, the time, in nanoseconds, at which a refresh should next read it.
+            /// Zero for slots that were connected when last read, which are read during every refresh.
+            std::vector<uint64_t> disconnectedSlotNextPoll;
+
+            /// Interface through which all XInput slots are read.
+            std::unique_ptr<IXInput> xinput;
+
+            /// Clock used to timestamp each refresh.
+            const IClock& clock;
+
+            /// Cadence at which the application reads states from the set.
+            CadenceTracker readCadence;
+
+            /// Time, in nanoseconds, at which the states in the published snapshot were captured.
+            uint64_t snapshotCaptureTimestamp;
+
+            /// Specifies if the published snapshot was produced by a prefetch.
+            bool snapshotPrefetched;
+
+            /// Specifies if any state in the published snapshot has been retrieved using #GetState.
+            bool snapshotRead;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// @param [in] xinput XInput interface through which all slots are read during a refresh. User indices are the same as controller identifiers.
+            /// @param [in] controllerCount Number of virtual controllers the set can hold. Limited to #ControllerSourceRegistry::kMaxSlotCount.
+            /// @param [in] clock Clock used to timestamp each refresh. The capture time is read once per refresh, after all slots are read, and applies to every virtual controller in the set.
+            ControllerSet(std::unique_ptr<IXInput>&& xinput = ControllerSourceRegistry::CreateDefaultInterface(), VirtualController::TControllerIdentifier controllerCount = XUSER_MAX_COUNT, const IClock& clock = SystemClock::GetInstance());
+
+            /// Copy constructor. Should never be invoked.
+            ControllerSet(const ControllerSet& other) = delete;
+
+
+        private:
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Reads all XInput slots, except disconnected slots that are not yet due to be read again, refreshes every virtual controller in the set, and publishes a new snapshot.
+            /// Caller must hold the set lock.
+            void RefreshLocked(void);
+
+
+        public:
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Places a virtual controller into the set, in the slot identified by its controller identifier.
+            /// A slot that already holds a controller cannot be filled again, so that pointers previously returned for it remain valid.
+            /// @param [in] controller Virtual controller to add. Its identifier must be less than the number of virtual controllers the set can hold.
+            /// @return Pointer to the virtual controller, which remains owned by the set and valid for as long as the set exists, or `nullptr` if the controller is missing, its identifier is out of range, or its slot is already occupied.
+            VirtualController* AddController(std::unique_ptr<VirtualController>&& controller);
+
+            /// Retrieves the number of virtual controllers the set can hold, which is one more than the largest valid controller identifier.
+            /// @return Number of virtual controllers.
+            inline VirtualController::TControllerIdentifier GetControllerCount(void) const
+            {
+                return kControllerCount;
+            }
+
+            /// Retrieves the virtual controller in the specified slot.
+            /// @param [in] controllerId Identifier of the desired virtual controller.
+            /// @return Pointer to the virtual controller, which remains valid for as long as the set exists, or `nullptr` if the slot is empty or the identifier is out of range.
+            VirtualController* GetController(VirtualController::TControllerIdentifier controllerId);
+
+            /// Retrieves the most recently published snapshot without refreshing.
+            /// Copies into storage provided by the caller, so a caller that reuses the same storage allocates nothing after the first time.
+            /// @param [out] snapshotOut Filled with a copy of the most recently published snapshot.
+            void GetSnapshot(SSnapshot& snapshotOut);
+
+            /// Retrieves the state of a single virtual controller.
+            /// If that controller's state in the current snapshot was already retrieved this way, the whole set is refreshed first.
+            /// As a result, reading every controller once per frame triggers one batched refresh per frame, and all controllers read during that frame are mutually consistent.
+            /// @param [in] controllerId Identifier of the desired virtual controller.
+            /// @return State of the virtual controller, or a neutral state if the identifier is out of range.
+            SState GetState(VirtualController::TControllerIdentifier controllerId);
+
+            /// Refreshes all virtual controllers in the set and publishes a new snapshot.
+            /// Copies into storage provided by the caller, so a caller that reuses the same storage allocates nothing after the first time.
+            /// @param [out] snapshotOut Filled with a copy of the newly published snapshot.
+            void Refresh(SSnapshot& snapshotOut);
+
+
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+
+            std::optional<SPrefetchPrediction> GetPrefetchPrediction(void) override;
+            void Prefetch(void) override;
+        };
+    }
+}
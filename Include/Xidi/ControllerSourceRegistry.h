@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSourceRegistry.h
+ *   Declaration of the registry that assigns virtual controller slots to the
+ *   XInput-style backends that supply their controller states.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "XInputInterface.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        /// Assigns virtual controller slots to controller sources, each of which is an implementation of the XInput interface with its own set of user indices.
+        /// Sources are registered one after another, and each receives a contiguous range of slots starting right after those of the previous source.
+        /// The registry itself implements the XInput interface, with virtual controller identifiers as user indices, so it can be used anywhere a single XInput interface is expected.
+        /// Slot information is held in a fixed-size contiguous array and the slot count is published atomically, so reading state never takes a lock and costs the same regardless of how many slots exist.
+        /// All methods are concurrency-safe.
+        class ControllerSourceRegistry : public IXInput
+        {
+        public:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Maximum number of slots, and hence virtual controllers, that a registry can hold.
+            static constexpr DWORD kMaxSlotCount = 64;
+
+
+        private:
+            // -------- TYPE DEFINITIONS ----------------------------------- //
+
+            /// Identifies where the state of a single slot comes from.
+            struct SSlot
+            {
+                IXInput* source;                                            ///< Source that supplies the state. Owned by the registry.
+                DWORD sourceUserIndex;                                      ///< User index to pass to the source.
+            };
+
+
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Slots, indexed by virtual controller identifier. Only the first #slotCount elements are valid.
+            std::array<SSlot, kMaxSlotCount> slots;
+
+            /// Number of valid slots. Published after the slots themselves are filled, so readers that observe a count also observe the slots it covers.
+            std::atomic<DWORD> slotCount;
+
+            /// Owns all registered sources.
+            std::vector<std::unique_ptr<IXInput>> sources;
+
+            /// Serializes registration.
+            std::mutex registrationMutex;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor.
+            ControllerSourceRegistry(void);
+
+            /// Copy constructor. Should never be invoked.
+            ControllerSourceRegistry(const ControllerSourceRegistry& other) = delete;
+
+
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Creates an XInput interface object that reads slots of the default registry.
+            /// Suitable for giving to virtual controllers and controller sets, which take ownership of their XInput interface objects.
+            /// @return Newly-created XInput interface object.
+            static std::unique_ptr<IXInput> CreateDefaultInterface(void);
+
+            /// Retrieves the registry that the rest of Xidi uses to enumerate and read virtual controllers.
+            /// It starts out empty. API wrappers register native XInput with it as they initialize, and other sources may be added afterwards.
+            /// @return Reference to the default registry.
+            static ControllerSourceRegistry& GetDefault(void);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Retrieves the number of slots currently registered, which is also the number of virtual controllers that should be presented to applications.
+            /// @return Number of slots.
+            inline DWORD GetSlotCount(void) const
+            {
+                return slotCount.load(std::memory_order_acquire);
+            }
+
+            /// Registers a controller source and assigns it the next available range of slots.
+            /// User indices 0 through `sourceSlotCount - 1` of the source correspond, in order, to the assigned slots.
+            /// @param [in] source Controller source to register. The registry takes ownership of it.
+            /// @param [in] sourceSlotCount Number of user indices that the source supports.
+            /// @return Identifier of the first slot assigned to the source, or no value if the source would not fit or supports no user indices. In that case the source is destroyed.
+            std::optional<DWORD> RegisterSource(std::unique_ptr<IXInput>&& source, DWORD sourceSlotCount);
+
+
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+
+            DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override;
+        };
+    }
+}
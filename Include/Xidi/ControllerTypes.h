@@ -45,6 +45,10 @@ namespace Xidi
         /// Value taken from XInput documentation.
         inline constexpr int32_t kTriggerValueMin = 0;
 
+        /// Maximum number of virtual controller slots whose states can be processed together in a single batch.
+        /// Larger sets of slots are processed as several consecutive batches.
+        inline constexpr unsigned int kBatchSlotCountMax = 16;
+
 
         // -------- TYPE DEFINITIONS --------------------------------------- //
 
@@ -112,6 +116,7 @@ namespace Xidi
 
         /// Identifier for an element of a virtual controller's state.
         /// Specifies both element type and index. Valid member of the union is based on the indicated type.
+        /// Element types that have no index, such as the POV, set the union to zero via its axis member so that identifiers compare equal.
         struct SElementIdentifier
         {
             EElementType type;
@@ -137,7 +142,7 @@ namespace Xidi
         /// Filled in by looking at a mapper and used during operations like EnumObjects to tell the application about the virtual controller's components.
         struct SCapabilities
         {
-            EAxis axisType[(int)EAxis::Count];                              ///< Type of each axis present. When the controller is presented to the application, all the axes on it are presented with contiguous indices. This array is used to map from DirectInput axis index to internal axis index.
+            EAxis axisType[(int)EAxis::Count] = {};                         ///< Type of each axis present. When the controller is presented to the application, all the axes on it are presented with contiguous indices. This array is used to map from DirectInput axis index to internal axis index.
             struct
             {
                 uint8_t numAxes : 3;                                        ///< Number of axes in the virtual controller, also the number of elements of the axis type array that are valid.
@@ -157,7 +162,7 @@ namespace Xidi
             /// Appends an axis to the list of axis types in this capabilities object.
             /// Performs no bounds-checking or uniqueness-checking, so this is left to the caller to ensure.
             /// @param [in] axis Axis to append to the list of present axes.
-            inline void AppendAxis(EAxis axis)
+            inline constexpr void AppendAxis(EAxis axis)
             {
                 axisType[numAxes] = axis;
                 numAxes += 1;
@@ -208,21 +213,65 @@ namespace Xidi
         /// Native data format for virtual controllers, used internally to represent controller state.
         /// Instances of `XINPUT_GAMEPAD` are passed through a mapper to produce objects of this type.
         /// Validity or invalidity of each element depends on the mapper.
+        /// Every element defaults to neutral, so initializers that name only some elements leave the rest neutral.
         struct SState
         {
-            int32_t axis[(int)EAxis::Count];                                ///< Values for all axes, one element per axis.
-            std::bitset<(int)EButton::Count> button;                        ///< Pressed (`true`) or unpressed (`false`) state for each button, one bit per button. Bitset is used as a size optimization, given the number of buttons.
-            UPovDirection povDirection;                                     ///< POV direction, presented simultaneously as individual components and as an aggregate quantity.
+            int32_t axis[(int)EAxis::Count] = {};                           ///< Values for all axes, one element per axis.
+            std::bitset<(int)EButton::Count> button = {};                   ///< Pressed (`true`) or unpressed (`false`) state for each button, one bit per button. Bitset is used as a size optimization, given the number of buttons.
+            UPovDirection povDirection = {};                                ///< POV direction, presented simultaneously as individual components and as an aggregate quantity.
 
-            /// Simple check for equality by low-level memory comparison.
-            /// Primarily useful during testing.
+            /// Simple check for equality by comparing each element.
+            /// Padding is not compared, so states need not be cleared byte-by-byte before being filled in.
             /// @param [in] other Object with which to compare.
             /// @return `true` if this object is equal to the other object, `false` otherwise.
             inline bool operator==(const SState& other) const
             {
-                return (0 == memcmp(this, &other, sizeof(*this)));
+                return ((0 == memcmp(axis, other.axis, sizeof(axis))) && (button == other.button) && (povDirection.all == other.povDirection.all));
+            }
+        };
+        // Standard libraries other than Microsoft's store even small bitsets in 64-bit words, which together with alignment padding costs 8 more bytes.
+        static_assert(sizeof(SState) <= ((sizeof(std::bitset<(int)EButton::Count>) == sizeof(uint32_t)) ? 32 : 40), L"Data structure size constraint violation.");
+
+        /// Native data format for the states of multiple virtual controllers processed together, laid out as a structure of arrays.
+        /// Each controller element holds one lane per slot, so that an operation on that element can be applied to all slots at once.
+        /// Buttons and POV directions use one byte per slot rather than one bit so that contributions can be combined lane by lane.
+        struct SStateBatch
+        {
+            alignas(16) int32_t axis[(int)EAxis::Count][kBatchSlotCountMax];                      ///< Values for all axes, one lane of slots per axis.
+            alignas(16) uint8_t button[(int)EButton::Count][kBatchSlotCountMax];                  ///< Pressed (1) or unpressed (0) state for each button, one lane of slots per button.
+            alignas(16) uint8_t povDirection[(int)EPovDirection::Count][kBatchSlotCountMax];      ///< Pressed (1) or unpressed (0) state for each POV direction, one lane of slots per direction.
+
+            /// Extracts the state of a single slot.
+            /// @param [in] slot Slot whose state is to be extracted.
+            /// @param [out] controllerState Controller state object to be filled with the state held in the specified slot.
+            inline void GetSlot(unsigned int slot, SState& controllerState) const
+            {
+                controllerState = {};
+
+                for (int i = 0; i < (int)EAxis::Count; ++i)
+                    controllerState.axis[i] = axis[i][slot];
+
+                for (int i = 0; i < (int)EButton::Count; ++i)
+                    controllerState.button[i] = (0 != button[i][slot]);
+
+                for (int i = 0; i < (int)EPovDirection::Count; ++i)
+                    controllerState.povDirection.components[i] = (0 != povDirection[i][slot]);
+            }
+
+            /// Replaces the state of a single slot.
+            /// @param [in] slot Slot whose state is to be replaced.
+            /// @param [in] controllerState Controller state to place into the specified slot.
+            inline void SetSlot(unsigned int slot, const SState& controllerState)
+            {
+                for (int i = 0; i < (int)EAxis::Count; ++i)
+                    axis[i][slot] = controllerState.axis[i];
+
+                for (int i = 0; i < (int)EButton::Count; ++i)
+                    button[i][slot] = (uint8_t)controllerState.button[i];
+
+                for (int i = 0; i < (int)EPovDirection::Count; ++i)
+                    povDirection[i][slot] = (uint8_t)controllerState.povDirection.components[i];
             }
         };
-        static_assert(sizeof(SState) <= 32, L"Data structure size constraint violation.");
     }
 }
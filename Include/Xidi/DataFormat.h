@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include "ApiDirectInput.h"
+#include "ApiDirectInputTypes.h"
 #include "ControllerTypes.h"
 
 #include <limits>
@@ -113,6 +113,9 @@ namespace Xidi
                 case Controller::EElementType::Pov:
                     povOffset = offset;
                     break;
+
+                default:
+                    break;
                 }
 
                 offsetElementMap[offset] = element;
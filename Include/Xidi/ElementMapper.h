@@ -48,8 +48,36 @@ namespace Xidi
             virtual void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const = 0;
 
             /// Specifies the virtual controller element that is the target of any contributions from this element mapper.
+            /// Can be evaluated at compile time, which allows capabilities of mappers built from constant element mappers to be computed at compile time.
             /// @return Identifier of the targert virtual controller element.
-            virtual SElementIdentifier GetTargetElement(void) const = 0;
+            virtual constexpr SElementIdentifier GetTargetElement(void) const = 0;
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Calculates the contributions to the controller states in a batch from one analog reading per slot.
+            /// Result is identical to invoking #ContributeFromAnalogValue separately for each slot, which is what the default implementation does.
+            /// Element mappers override this to process all slots together.
+            /// @param [in,out] controllerStates Controller state batch to be updated.
+            /// @param [in] analogValues Raw analog stick values from the XInput controllers, one per slot.
+            /// @param [in] slotCount Number of slots to process, starting from the first. Must not exceed #kBatchSlotCountMax.
+            virtual void ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const;
+
+            /// Calculates the contributions to the controller states in a batch from one button pressed status reading per slot.
+            /// Result is identical to invoking #ContributeFromButtonValue separately for each slot, which is what the default implementation does.
+            /// Element mappers override this to process all slots together.
+            /// @param [in,out] controllerStates Controller state batch to be updated.
+            /// @param [in] buttonsPressed Button states from the XInput controllers, one per slot, 1 if pressed and 0 otherwise.
+            /// @param [in] slotCount Number of slots to process, starting from the first. Must not exceed #kBatchSlotCountMax.
+            virtual void ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const;
+
+            /// Calculates the contributions to the controller states in a batch from one trigger reading per slot.
+            /// Result is identical to invoking #ContributeFromTriggerValue separately for each slot, which is what the default implementation does.
+            /// Element mappers override this to process all slots together.
+            /// @param [in,out] controllerStates Controller state batch to be updated.
+            /// @param [in] triggerValues Trigger values from the XInput controllers, one per slot.
+            /// @param [in] slotCount Number of slots to process, starting from the first. Must not exceed #kBatchSlotCountMax.
+            virtual void ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const;
         };
 
         /// Maps a single XInput controller element such that it contributes to an axis value on a virtual controller.
@@ -98,7 +126,14 @@ namespace Xidi
             void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override;
             void ContributeFromButtonValue(SState& controllerState, bool buttonPressed) const override;
             void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override;
-            SElementIdentifier GetTargetElement(void) const override;
+            void ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const override;
+            void ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const override;
+            void ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const override;
+
+            inline constexpr SElementIdentifier GetTargetElement(void) const override
+            {
+                return {.type = EElementType::Axis, .axis = axis};
+            }
         };
 
         /// Maps a single XInput controller element such that it contributes to a button reading on a virtual controller.
@@ -130,7 +165,14 @@ namespace Xidi
             void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override;
             void ContributeFromButtonValue(SState& controllerState, bool buttonPressed) const override;
             void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override;
-            SElementIdentifier GetTargetElement(void) const override;
+            void ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const override;
+            void ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const override;
+            void ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const override;
+
+            inline constexpr SElementIdentifier GetTargetElement(void) const override
+            {
+                return {.type = EElementType::Button, .button = button};
+            }
         };
 
         /// Maps a single XInput controller element such that it contributes to an axis value on a virtual controller, but removes analog functionality. Values contributed are either zero or extreme.
@@ -154,6 +196,8 @@ namespace Xidi
 
             void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override;
             void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override;
+            void ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const override;
+            void ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const override;
         };
 
         /// Maps a single XInput controller element such that it contributes to a POV on a virtual controller.
@@ -195,7 +239,14 @@ namespace Xidi
             void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override;
             void ContributeFromButtonValue(SState& controllerState, bool buttonPressed) const override;
             void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override;
-            SElementIdentifier GetTargetElement(void) const override;
+            void ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const override;
+            void ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const override;
+            void ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const override;
+
+            inline constexpr SElementIdentifier GetTargetElement(void) const override
+            {
+                return {.type = EElementType::Pov, .axis = (EAxis)0};
+            }
         };
     }
 }
@@ -0,0 +1,294 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Evdev.h
+ *   Declaration of functionality for translating Linux evdev input event
+ *   streams into XInput controller states. Everything other than access to
+ *   real devices is platform-independent, so captured event streams can be
+ *   replayed on any platform.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Evdev
+    {
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Event types, with the same values as the `EV_*` constants in the Linux input subsystem.
+        inline constexpr uint16_t kEventTypeSyn = 0x00;
+        inline constexpr uint16_t kEventTypeKey = 0x01;
+        inline constexpr uint16_t kEventTypeAbs = 0x03;
+
+        /// Synchronization event codes, with the same values as the `SYN_*` constants in the Linux input subsystem.
+        inline constexpr uint16_t kSynReport = 0x00;
+        inline constexpr uint16_t kSynDropped = 0x03;
+
+        /// Absolute axis codes, with the same values as the `ABS_*` constants in the Linux input subsystem.
+        inline constexpr uint16_t kAbsX = 0x00;
+        inline constexpr uint16_t kAbsY = 0x01;
+        inline constexpr uint16_t kAbsZ = 0x02;
+        inline constexpr uint16_t kAbsRx = 0x03;
+        inline constexpr uint16_t kAbsRy = 0x04;
+        inline constexpr uint16_t kAbsRz = 0x05;
+        inline constexpr uint16_t kAbsGas = 0x09;
+        inline constexpr uint16_t kAbsBrake = 0x0a;
+        inline constexpr uint16_t kAbsHat0X = 0x10;
+        inline constexpr uint16_t kAbsHat0Y = 0x11;
+
+        /// Number of absolute axis codes, with the same value as `ABS_CNT` in the Linux input subsystem.
+        inline constexpr uint16_t kAbsCount = 0x40;
+
+        /// Key codes for gamepad buttons, with the same values as the `BTN_*` constants in the Linux input subsystem.
+        /// Xbox controllers report their X and Y buttons as `BTN_X` and `BTN_Y`, even though the input subsystem aliases those codes to `BTN_NORTH` and `BTN_WEST` respectively.
+        inline constexpr uint16_t kBtnA = 0x130;
+        inline constexpr uint16_t kBtnB = 0x131;
+        inline constexpr uint16_t kBtnX = 0x133;
+        inline constexpr uint16_t kBtnY = 0x134;
+        inline constexpr uint16_t kBtnTL = 0x136;
+        inline constexpr uint16_t kBtnTR = 0x137;
+        inline constexpr uint16_t kBtnSelect = 0x13a;
+        inline constexpr uint16_t kBtnStart = 0x13b;
+        inline constexpr uint16_t kBtnThumbL = 0x13d;
+        inline constexpr uint16_t kBtnThumbR = 0x13e;
+        inline constexpr uint16_t kBtnDpadUp = 0x220;
+        inline constexpr uint16_t kBtnDpadDown = 0x221;
+        inline constexpr uint16_t kBtnDpadLeft = 0x222;
+        inline constexpr uint16_t kBtnDpadRight = 0x223;
+
+        /// Size, in bytes, of a single `struct input_event` as read from an evdev device node on a 64-bit Linux system.
+        /// Captured event streams consist of a sequence of records of this size, which is exactly what reading from the device node produces.
+        inline constexpr size_t kCapturedEventRecordSize = 24;
+
+
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Single evdev input event, without its timestamp.
+        struct SEvent
+        {
+            uint16_t type;                                                  ///< Event type, such as #kEventTypeKey.
+            uint16_t code;                                                  ///< Event code, whose meaning depends on the event type.
+            int32_t value;                                                  ///< Event value, whose meaning depends on the event type and code.
+        };
+
+        /// Range of values reported by an absolute axis.
+        struct SAxisRange
+        {
+            int32_t minimum;                                                ///< Minimum value.
+            int32_t maximum;                                                ///< Maximum value.
+        };
+
+        /// Ranges of all absolute axes reported by a device, indexed by absolute axis code.
+        typedef std::array<SAxisRange, kAbsCount> TAxisRanges;
+
+        /// Source of evdev input events for a single device.
+        /// Sources never block. They report whatever events are available at the time they are asked.
+        class IEventSource
+        {
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default destructor.
+            virtual ~IEventSource(void) = default;
+
+
+            // -------- ABSTRACT INSTANCE METHODS -------------------------- //
+
+            /// Retrieves the ranges of the absolute axes that this source reports.
+            /// @return Absolute axis ranges.
+            virtual const TAxisRanges& GetAxisRanges(void) const = 0;
+
+            /// Retrieves a file descriptor that becomes readable whenever this source has events available, suitable for waiting on using `epoll`.
+            /// @return File descriptor, or -1 if this source cannot be waited on and should instead be read whenever its state is needed.
+            virtual int GetWaitDescriptor(void) const = 0;
+
+            /// Appends to the specified buffer the events that describe the complete current state of the device.
+            /// Used to recover after the device reports that events were dropped. Sources that cannot query current state append nothing.
+            /// @param [in,out] events Buffer to which to append events.
+            virtual void ReadCurrentState(std::vector<SEvent>& events) = 0;
+
+            /// Appends to the specified buffer the events that are available right now, without blocking.
+            /// @param [in,out] events Buffer to which to append events.
+            /// @return `true` if the source is still usable, `false` if it has been permanently disconnected.
+            virtual bool ReadEvents(std::vector<SEvent>& events) = 0;
+        };
+
+        /// Replays a captured evdev event stream.
+        /// Each read delivers the events of the next complete report, up to and including its `SYN_REPORT` event, so every read advances the replay by exactly one controller state.
+        /// Once the stream is exhausted, reads deliver no events and the last state remains in effect.
+        class ReplayEventSource : public IEventSource
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Ranges of the absolute axes of the device on which the stream was captured.
+            const TAxisRanges kAxisRanges;
+
+            /// Events in the captured stream.
+            const std::vector<SEvent> kEvents;
+
+            /// Index of the next event to deliver.
+            size_t nextEventIndex;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// @param [in] events Events in the captured stream.
+            /// @param [in] axisRanges Ranges of the absolute axes of the device on which the stream was captured.
+            ReplayEventSource(std::vector<SEvent>&& events, const TAxisRanges& axisRanges);
+
+
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Loads a captured event stream from a file.
+            /// The file must contain raw 64-bit little-endian `struct input_event` records, such as those produced by copying from an evdev device node.
+            /// @param [in] fileName Name of the file to load.
+            /// @param [in] axisRanges Ranges of the absolute axes of the device on which the stream was captured.
+            /// @return Replay event source, or `nullptr` if the file could not be read or does not contain a whole number of records.
+            static std::unique_ptr<ReplayEventSource> LoadFromFile(const wchar_t* fileName, const TAxisRanges& axisRanges);
+
+
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+
+            const TAxisRanges& GetAxisRanges(void) const override;
+            int GetWaitDescriptor(void) const override;
+            void ReadCurrentState(std::vector<SEvent>& events) override;
+            bool ReadEvents(std::vector<SEvent>& events) override;
+        };
+
+        /// Tracks the state of a gamepad by consuming the evdev events it reports, and presents that state as an XInput controller state.
+        /// Events are accumulated and only become visible when a `SYN_REPORT` event marks the end of a report. The packet number is incremented once for each report that changes the state.
+        class StateTracker
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Ranges of the absolute axes of the device whose events are being consumed.
+            const TAxisRanges kAxisRanges;
+
+            /// State being accumulated from the events of the current report.
+            XINPUT_GAMEPAD pendingState;
+
+            /// State as of the most recent report, along with its packet number.
+            XINPUT_STATE reportedState;
+
+            /// Whether or not events are being discarded because the device reported that some were dropped.
+            bool discardingEvents;
+
+            /// Whether or not the pending state needs to be rebuilt from the current state of the device before it can be trusted.
+            bool needsCurrentState;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// @param [in] axisRanges Ranges of the absolute axes of the device whose events are to be consumed.
+            StateTracker(const TAxisRanges& axisRanges);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Consumes a single event.
+            /// @param [in] event Event to consume.
+            void ApplyEvent(const SEvent& event);
+
+            /// Retrieves the state as of the most recent report.
+            /// @return Controller state.
+            inline const XINPUT_STATE& GetState(void) const
+            {
+                return reportedState;
+            }
+
+            /// Determines if events were dropped and the tracked state must be rebuilt from the current state of the device.
+            /// Becomes set once the events following a `SYN_DROPPED` event have been discarded. The caller should then apply the events produced by #IEventSource::ReadCurrentState followed by a `SYN_REPORT` event, which clears it.
+            /// @return `true` if so, `false` if not.
+            inline bool NeedsCurrentState(void) const
+            {
+                return needsCurrentState;
+            }
+        };
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+
+        /// Retrieves the absolute axis ranges that Xbox controllers report through the Linux `xpad` driver.
+        /// Suitable for replaying streams captured on such controllers.
+        /// @return Absolute axis ranges.
+        const TAxisRanges& DefaultAxisRanges(void);
+
+        /// Parses a captured event stream.
+        /// @param [in] capturedBytes Pointer to the captured bytes, which must be raw 64-bit little-endian `struct input_event` records.
+        /// @param [in] capturedByteCount Number of captured bytes.
+        /// @param [out] events Filled with the parsed events.
+        /// @return `true` if successful, `false` if the number of bytes is not a whole number of records.
+        bool ParseCapturedEvents(const void* capturedBytes, size_t capturedByteCount, std::vector<SEvent>& events);
+
+#ifdef __linux__
+        /// Opens an evdev device node and reads events from it without blocking.
+        class DeviceEventSource : public IEventSource
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Open file descriptor for the device node.
+            const int kDeviceDescriptor;
+
+            /// Ranges of the absolute axes of the device, as reported by the device.
+            TAxisRanges axisRanges;
+
+
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor. Objects can only be constructed using #Open.
+            /// @param [in] deviceDescriptor Open file descriptor for the device node, ownership of which is transferred to this object.
+            DeviceEventSource(int deviceDescriptor);
+
+
+        public:
+            /// Copy constructor. Should never be invoked.
+            DeviceEventSource(const DeviceEventSource& other) = delete;
+
+            /// Default destructor.
+            ~DeviceEventSource(void) override;
+
+
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Lists the evdev device nodes that represent gamepads, in ascending order of their event node numbers.
+            /// @return Paths of the device nodes.
+            static std::vector<std::string> FindGamepadDevices(void);
+
+            /// Opens the specified evdev device node, which must represent a gamepad.
+            /// @param [in] devicePath Path of the device node, such as `/dev/input/event5`.
+            /// @return Device event source, or `nullptr` if the device node could not be opened or does not represent a gamepad.
+            static std::unique_ptr<DeviceEventSource> Open(const std::string& devicePath);
+
+
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+
+            const TAxisRanges& GetAxisRanges(void) const override;
+            int GetWaitDescriptor(void) const override;
+            void ReadCurrentState(std::vector<SEvent>& events) override;
+            bool ReadEvents(std::vector<SEvent>& events) override;
+        };
+#endif
+    }
+}
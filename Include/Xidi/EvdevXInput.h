@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file EvdevXInput.h
+ *   Declaration of an implementation of the XInput interface that obtains
+ *   controller states from Linux evdev input event sources.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "Evdev.h"
+#include "XInputInterface.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#ifdef __linux__
+#include <thread>
+#endif
+
+
+namespace Xidi
+{
+    /// Implementation of the XInput interface backed by evdev input event sources, one per XInput user index.
+    /// Each slot keeps its own up-to-date controller state, whose packet number advances once per evdev report that changes it.
+    /// On Linux, sources that can be waited on are read by a background thread as soon as events arrive, so retrieving state never touches the device.
+    /// Sources that cannot be waited on, such as captured event stream replays, are instead read whenever their state is retrieved.
+    /// All methods are concurrency-safe.
+    class EvdevXInput : public IXInput
+    {
+    private:
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Holds everything associated with a single XInput user index.
+        struct SSlot
+        {
+            std::mutex slotMutex;                                           ///< Serializes access to the rest of the slot.
+            std::unique_ptr<Evdev::IEventSource> source;                    ///< Event source attached to the slot, if any.
+            std::optional<Evdev::StateTracker> tracker;                     ///< Tracks the state reported by the event source. Present whenever an event source is attached.
+            std::vector<Evdev::SEvent> eventBuffer;                         ///< Reused buffer for events read from the source, to avoid allocating on every read.
+            bool sourceWatched;                                             ///< Whether or not the event thread reads the source. If not, the source is read whenever state is retrieved.
+        };
+
+
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Slots, indexed by XInput user index.
+        std::array<SSlot, XUSER_MAX_COUNT> slots;
+
+#ifdef __linux__
+        /// `epoll` instance on which the event thread waits for any attached source to become readable.
+        const int kEpollDescriptor;
+
+        /// `eventfd` object used to wake the event thread when it should exit.
+        const int kStopDescriptor;
+
+        /// Reads waitable event sources as soon as they have events available.
+        std::thread eventThread;
+#endif
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default constructor.
+        /// On Linux, also starts the thread that reads waitable event sources.
+        EvdevXInput(void);
+
+        /// Copy constructor. Should never be invoked.
+        EvdevXInput(const EvdevXInput& other) = delete;
+
+        /// Default destructor.
+        /// Stops the event thread, if it is running, and closes all attached event sources.
+        ~EvdevXInput(void);
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Stops watching the event source attached to the specified slot and destroys it.
+        /// Caller must hold the slot lock.
+        /// @param [in] slot Slot from which to detach the source.
+        void DetachSourceLocked(SSlot& slot);
+
+#ifdef __linux__
+        /// Entry point for the event thread.
+        /// Waits for attached event sources to become readable and processes their events until told to exit.
+        void EventThreadMain(void);
+#endif
+
+        /// Reads and applies all events that the event source attached to the specified slot has available.
+        /// If the source reports that it has been disconnected, it is detached.
+        /// Caller must hold the slot lock.
+        /// @param [in] slot Slot whose events are to be processed.
+        void ProcessPendingEventsLocked(SSlot& slot);
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Attaches an event source to the specified XInput user index, replacing any source already attached.
+        /// The slot's packet number restarts, as it would for a newly-connected controller.
+        /// @param [in] userIndex XInput user index.
+        /// @param [in] source Event source to attach.
+        /// @return `true` if successful, `false` if the user index is out of range.
+        bool AttachSource(DWORD userIndex, std::unique_ptr<Evdev::IEventSource>&& source);
+
+        /// Detaches and destroys the event source attached to the specified XInput user index, if any.
+        /// @param [in] userIndex XInput user index.
+        void DetachSource(DWORD userIndex);
+
+        /// Determines if an event source is attached to the specified XInput user index.
+        /// @param [in] userIndex XInput user index.
+        /// @return `true` if so, `false` if not or if the user index is out of range.
+        bool IsSourceAttached(DWORD userIndex);
+
+#ifdef __linux__
+        /// Attaches the first gamepads that evdev exposes, in event node order, to consecutive XInput user indices starting with 0.
+        /// @return Number of gamepads attached.
+        unsigned int AttachGamepadDevices(void);
+#endif
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override;
+    };
+}
@@ -12,9 +12,11 @@
 
 #pragma once
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 #include "Configuration.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -25,10 +27,22 @@ namespace Xidi
     {
         // -------- FUNCTIONS ---------------------------------------------- //
 
-        /// Retrieves the configuration object that represents the contents of a configuration file.
-        /// @return Read-only configuration object reference.
-        const Configuration::Configuration& GetConfiguration(void);
-        
+        /// Performs the run-time initialization that was deferred from library load, such as reading the configuration file, enabling the log, and starting optional features.
+        /// Must be invoked before any functionality that depends on configuration is used. Entry points that lead to controllers being used invoke it, whereas entry points that are merely forwarded to the system library do not.
+        /// Only the first invocation has any effect. Must not be invoked within a DLL entry point.
+        void EnsureInitialized(void);
+
+        /// Retrieves the most recently published configuration snapshot, which represents the contents of a configuration file.
+        /// Snapshots are immutable. Holding the returned pointer keeps a snapshot alive even after a reload publishes a newer one, and the snapshot is released once its last holder lets go.
+        /// @return Read-only configuration snapshot.
+        std::shared_ptr<const Configuration::Configuration> GetConfiguration(void);
+
+        /// Retrieves the generation number of the most recently published configuration snapshot.
+        /// The generation number is incremented every time a reload publishes a new snapshot. Reading it is a single atomic load, so it is suitable for polling on hot paths.
+        /// @return Current configuration generation number.
+        uint32_t GetConfigurationGeneration(void);
+
+#ifdef _WIN32
         /// Retrieves a pseudohandle to the current process.
         /// @return Current process pseudohandle.
         HANDLE GetCurrentProcessHandle(void);
@@ -44,9 +58,26 @@ namespace Xidi
         /// Retrieves information on the current system. This includes architecture, page size, and so on.
         /// @return Reference to a read-only structure containing system information.
         const SYSTEM_INFO& GetSystemInformation(void);
+#endif
 
-        /// Performs run-time initialization.
+        /// Re-reads the configuration file and publishes the result as a new configuration snapshot.
+        /// If the configuration file is malformed, the previous snapshot remains in effect.
+        /// @return `true` if a new snapshot was published, `false` otherwise.
+        bool ReloadConfiguration(void);
+
+        /// Starts a background thread that reloads the configuration whenever the configuration file is modified, but only if enabled in the configuration file.
+        /// The thread runs on a background worker, so it holds a reference to this library while it runs and is abandoned by #Shutdown if the process terminates.
+        /// Only the first invocation has any effect.
+        void StartConfigurationWatcherIfConfigured(void);
+
+        /// Performs the minimal run-time initialization needed when the library is loaded. Everything else is deferred until #EnsureInitialized is invoked.
+        /// Many applications load this library without ever using a controller, and those applications should not pay for configuration, logging, or mapper setup.
         /// This function only performs operations that are safe to perform within a DLL entry point.
         void Initialize(void);
+
+        /// Performs run-time teardown, such as outputting any reports that are due when the library is unloaded.
+        /// This function only performs operations that are safe to perform within a DLL entry point, so it never stops background threads. Those hold a reference to this library while they run, so the library can only be unloaded before the process terminates if they have already been stopped.
+        /// @param [in] processTerminating Whether the library is being unloaded because the process is terminating, in which case any background threads that are still running are abandoned and nothing that needs a lock is attempted, including reports.
+        void Shutdown(bool processTerminating);
     }
 }
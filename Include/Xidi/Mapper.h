@@ -12,13 +12,18 @@
 
 #pragma once
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
+#include "Configuration.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <string_view>
-#include <xinput.h>
+#include <type_traits>
 
 
 namespace Xidi
@@ -58,6 +63,37 @@ namespace Xidi
                 std::unique_ptr<const IElementMapper> buttonRS = nullptr;
             };
 
+            /// Identifies each XInput controller element. Enumerators appear in the same order as the element mappers in #SElementMap.
+            enum class EXInputElement : uint8_t
+            {
+                StickLeftX,
+                StickLeftY,
+                StickRightX,
+                StickRightY,
+                DpadUp,
+                DpadDown,
+                DpadLeft,
+                DpadRight,
+                TriggerLT,
+                TriggerRT,
+                ButtonA,
+                ButtonB,
+                ButtonX,
+                ButtonY,
+                ButtonLB,
+                ButtonRB,
+                ButtonBack,
+                ButtonStart,
+                ButtonLS,
+                ButtonRS,
+                Count                                                       ///< Sentinel value, total number of enumerators
+            };
+            static_assert((int)EXInputElement::Count == (sizeof(SElementMap) / sizeof(std::unique_ptr<const IElementMapper>)), "XInput element enumerator mismatch.");
+
+            /// Set of XInput controller elements, one bit per element, indexed by #EXInputElement.
+            typedef uint32_t TXInputElementSet;
+            static_assert((int)EXInputElement::Count <= (8 * sizeof(TXInputElementSet)), "XInput element set is too small.");
+
             /// Dual representation of a controller element map. Intended for internal use only.
             /// In one representation the elements all have names for element-specific access.
             /// In the other, all the elements are collapsed into an array for easy iteration.
@@ -84,48 +120,319 @@ namespace Xidi
                 }
             };
 
+            /// XInput controller element mappers, one per controller element, referenced but not owned.
+            /// Used for mappers defined at compile time, whose element mappers are themselves compile-time constants that outlive every mapper.
+            /// For controller elements that are not used, a value of `nullptr` may be used instead.
+            struct SStaticElementMap
+            {
+                const IElementMapper* stickLeftX = nullptr;
+                const IElementMapper* stickLeftY = nullptr;
+                const IElementMapper* stickRightX = nullptr;
+                const IElementMapper* stickRightY = nullptr;
+                const IElementMapper* dpadUp = nullptr;
+                const IElementMapper* dpadDown = nullptr;
+                const IElementMapper* dpadLeft = nullptr;
+                const IElementMapper* dpadRight = nullptr;
+                const IElementMapper* triggerLT = nullptr;
+                const IElementMapper* triggerRT = nullptr;
+                const IElementMapper* buttonA = nullptr;
+                const IElementMapper* buttonB = nullptr;
+                const IElementMapper* buttonX = nullptr;
+                const IElementMapper* buttonY = nullptr;
+                const IElementMapper* buttonLB = nullptr;
+                const IElementMapper* buttonRB = nullptr;
+                const IElementMapper* buttonBack = nullptr;
+                const IElementMapper* buttonStart = nullptr;
+                const IElementMapper* buttonLS = nullptr;
+                const IElementMapper* buttonRS = nullptr;
+            };
+            static_assert((int)EXInputElement::Count == (sizeof(SStaticElementMap) / sizeof(const IElementMapper*)), "Static element map field mismatch.");
+
+            /// All element mappers of a mapper, one per XInput controller element, indexed by #EXInputElement.
+            typedef std::array<const IElementMapper*, (int)EXInputElement::Count> TElementMappers;
+
+            /// Records, for each XInput controller element, which XInput controller elements must be mapped again when it changes.
+            /// Mapping contributions are accumulated per virtual controller element, so every XInput controller element that targets the same virtual controller element must be mapped together.
+            struct SElementDependencies
+            {
+                TXInputElementSet remapGroup[(int)EXInputElement::Count];   ///< For each XInput controller element, the set of XInput controller elements that share its target. Empty if the XInput controller element is not mapped.
+            };
+
+            /// Entry in the registry of known mappers.
+            struct SRegistryEntry
+            {
+                std::wstring_view name;                                     ///< Name of the mapper, which is used to select it in the configuration file.
+                const Mapper* mapper;                                       ///< Mapper object.
+            };
+
+            /// Raw XInput controller states for multiple slots processed together, laid out as a structure of arrays.
+            /// Each XInput controller element holds one lane per slot, so that an element mapper can process that element for all slots at once.
+            struct SXInputBatch
+            {
+                alignas(16) int16_t thumbLX[kBatchSlotCountMax];            ///< Left stick horizontal position, one per slot.
+                alignas(16) int16_t thumbLY[kBatchSlotCountMax];            ///< Left stick vertical position, one per slot.
+                alignas(16) int16_t thumbRX[kBatchSlotCountMax];            ///< Right stick horizontal position, one per slot.
+                alignas(16) int16_t thumbRY[kBatchSlotCountMax];            ///< Right stick vertical position, one per slot.
+                alignas(16) uint8_t leftTrigger[kBatchSlotCountMax];        ///< Left trigger value, one per slot.
+                alignas(16) uint8_t rightTrigger[kBatchSlotCountMax];       ///< Right trigger value, one per slot.
+                alignas(16) uint16_t buttons[kBatchSlotCountMax];           ///< Bitmask of pressed digital buttons, one per slot.
+
+                /// Extracts the XInput controller state of a single slot.
+                /// @param [in] slot Slot whose state is to be extracted.
+                /// @return XInput controller state held in the specified slot.
+                inline XINPUT_GAMEPAD GetSlot(unsigned int slot) const
+                {
+                    XINPUT_GAMEPAD xinputState = {};
+
+                    xinputState.wButtons = buttons[slot];
+                    xinputState.bLeftTrigger = leftTrigger[slot];
+                    xinputState.bRightTrigger = rightTrigger[slot];
+                    xinputState.sThumbLX = thumbLX[slot];
+                    xinputState.sThumbLY = thumbLY[slot];
+                    xinputState.sThumbRX = thumbRX[slot];
+                    xinputState.sThumbRY = thumbRY[slot];
+
+                    return xinputState;
+                }
+
+                /// Replaces the XInput controller state of a single slot.
+                /// @param [in] slot Slot whose state is to be replaced.
+                /// @param [in] xinputState XInput controller state to place into the specified slot.
+                inline void SetSlot(unsigned int slot, const XINPUT_GAMEPAD& xinputState)
+                {
+                    buttons[slot] = xinputState.wButtons;
+                    leftTrigger[slot] = xinputState.bLeftTrigger;
+                    rightTrigger[slot] = xinputState.bRightTrigger;
+                    thumbLX[slot] = xinputState.sThumbLX;
+                    thumbLY[slot] = xinputState.sThumbLY;
+                    thumbRX[slot] = xinputState.sThumbRX;
+                    thumbRY[slot] = xinputState.sThumbRY;
+                }
+            };
+
+
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Set that contains all XInput controller elements.
+            static constexpr TXInputElementSet kXInputElementSetAll = ((TXInputElementSet)1 << (int)EXInputElement::Count) - 1;
+
+            /// Registry of all known mappers, sorted by name.
+            /// Built at compile time along with the mapper definitions themselves, so that looking up a mapper requires neither initialization nor dynamic memory allocation.
+            static const std::span<const SRegistryEntry> kRegistry;
+
+            /// Default mapper, which is used if the configuration file does not specify one.
+            static const Mapper* const kDefaultMapper;
+
+
         private:
             // -------- INSTANCE VARIABLES --------------------------------- //
 
+            /// Storage for element mappers owned by this object, or `nullptr` if the element mappers are compile-time constants.
+            const UElementMap* const ownedElements;
+
             /// All controller element mappers.
-            const UElementMap elements;
+            /// Initialization of this member depends on prior initialization of #ownedElements so it must come after.
+            const TElementMappers elements;
 
             /// Capabilities of the controller described by the element mappers in aggregate.
             /// Initialization of this member depends on prior initialization of #elements so it must come after.
             const SCapabilities capabilities;
 
+            /// Dependency index used to limit incremental mapping to the XInput controller elements affected by a change.
+            /// Initialization of this member depends on prior initialization of #elements so it must come after.
+            const SElementDependencies dependencies;
+
             /// Name of this mapper.
             const std::wstring_view name;
 
 
+            // -------- INTERNAL CLASS METHODS ----------------------------- //
+
+            /// Builds the dependency index that allows a mapper to map only the XInput controller elements affected by a change.
+            /// @param [in] elements Element mappers for which dependencies are to be computed.
+            /// @return Dependency index for the element mappers.
+            static constexpr SElementDependencies BuildDependencies(const TElementMappers& elements)
+            {
+                SElementDependencies dependencies = {};
+
+                for (int i = 0; i < (int)elements.size(); ++i)
+                {
+                    if (nullptr == elements[i])
+                        continue;
+
+                    const int kGroupKey = TargetGroupKey(elements[i]->GetTargetElement());
+                    if (kGroupKey < 0)
+                    {
+                        // Element mappers whose effects are not confined to a single virtual controller element force the entire state to be mapped again.
+                        dependencies.remapGroup[i] = kXInputElementSetAll;
+                        continue;
+                    }
+
+                    for (int j = 0; j < (int)elements.size(); ++j)
+                    {
+                        if ((nullptr != elements[j]) && (kGroupKey == TargetGroupKey(elements[j]->GetTargetElement())))
+                            dependencies.remapGroup[i] |= ((TXInputElementSet)1 << j);
+                    }
+                }
+
+                return dependencies;
+            }
+
+            /// Derives the capabilities of the controller that is described by the specified element mappers in aggregate.
+            /// Number of axes is determined as the total number of unique axes on the virtual controller to which element mappers contribute.
+            /// Number of buttons is determined by looking at the highest button number to which element mappers contribute.
+            /// Presence or absence of a POV is determined by whether or not any element mappers contribute to a POV direction, even if not all POV directions have a contribution.
+            /// @param [in] elements Element mappers, one per XInput controller element.
+            /// @return Virtual controller capabilities as derived from the element mappers in aggregate.
+            static constexpr SCapabilities DeriveCapabilities(const TElementMappers& elements)
+            {
+                SCapabilities capabilities = {};
+
+                bool axesPresent[(int)EAxis::Count] = {};
+                int highestButtonSeen = -1;
+                bool povPresent = false;
+
+                for (const IElementMapper* element : elements)
+                {
+                    if (nullptr == element)
+                        continue;
+
+                    const SElementIdentifier targetElement = element->GetTargetElement();
+                    switch (targetElement.type)
+                    {
+                    case EElementType::Axis:
+                        if ((int)targetElement.axis < (int)EAxis::Count)
+                            axesPresent[(int)targetElement.axis] = true;
+                        break;
+
+                    case EElementType::Button:
+                        if ((int)targetElement.button < (int)EButton::Count)
+                        {
+                            if ((int)targetElement.button > highestButtonSeen)
+                                highestButtonSeen = (int)targetElement.button;
+                        }
+                        break;
+
+                    case EElementType::Pov:
+                        povPresent = true;
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+
+                for (unsigned int i = 0; i < _countof(axesPresent); ++i)
+                {
+                    if (true == axesPresent[i])
+                        capabilities.AppendAxis((EAxis)i);
+                }
+
+                capabilities.numButtons = highestButtonSeen + 1;
+                capabilities.hasPov = povPresent;
+
+                return capabilities;
+            }
+
+            /// Collects the element mappers referenced by a static element map.
+            /// @param [in] elements Static element map.
+            /// @return Element mappers, one per XInput controller element.
+            static constexpr TElementMappers ElementMappersFromStaticElementMap(const SStaticElementMap& elements)
+            {
+                return {elements.stickLeftX, elements.stickLeftY, elements.stickRightX, elements.stickRightY, elements.dpadUp, elements.dpadDown, elements.dpadLeft, elements.dpadRight, elements.triggerLT, elements.triggerRT, elements.buttonA, elements.buttonB, elements.buttonX, elements.buttonY, elements.buttonLB, elements.buttonRB, elements.buttonBack, elements.buttonStart, elements.buttonLS, elements.buttonRS};
+            }
+
+            /// Computes a key that identifies the virtual controller element targeted by an element mapper, for the purpose of grouping element mappers that contribute to the same target.
+            /// @param [in] targetElement Virtual controller element targeted by an element mapper.
+            /// @return Grouping key, or -1 if the target is not a single axis, button, or POV.
+            static constexpr int TargetGroupKey(SElementIdentifier targetElement)
+            {
+                switch (targetElement.type)
+                {
+                case EElementType::Axis:
+                    return (int)targetElement.axis;
+                case EElementType::Button:
+                    return (int)EAxis::Count + (int)targetElement.button;
+                case EElementType::Pov:
+                    return (int)EAxis::Count + (int)EButton::Count;
+                default:
+                    return -1;
+                }
+            }
+
+
         public:
             // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
 
             /// Initialization constructor.
             /// Requires a name and, for each controller element, a unique element mapper which becomes owned by this object.
             /// For controller elements that are not used, `nullptr` may be set instead.
+            /// Mappers created this way are not added to the registry of known mappers.
             Mapper(const std::wstring_view name, SElementMap&& elements);
 
             /// Initialization constructor.
-            /// Does not require or register a name for this mapper. This version is primarily useful for testing.
+            /// Does not require a name for this mapper. This version is primarily useful for testing.
             /// Requires that a unique mapper be specified for each controller element, which in turn becomes owned by this object.
             /// For controller elements that are not used, `nullptr` may be set instead.
             Mapper(SElementMap&& elements);
 
+            /// Initialization constructor.
+            /// Requires a name and, for each controller element, an element mapper that is a compile-time constant.
+            /// Can be evaluated entirely at compile time, so mappers created this way require no dynamic initialization and no dynamic memory allocation.
+            /// For controller elements that are not used, `nullptr` may be set instead.
+            constexpr Mapper(const std::wstring_view name, const SStaticElementMap& elements) : ownedElements(nullptr), elements(ElementMappersFromStaticElementMap(elements)), capabilities(DeriveCapabilities(this->elements)), dependencies(BuildDependencies(this->elements)), name(name)
+            {
+                // Nothing to do here.
+            }
+
+            /// Initialization constructor.
+            /// Requires a name and, for each controller element, an element mapper that is referenced but not owned and must outlive this object.
+            /// Used for mappers compiled from definitions in the configuration file, which hold their own element mappers alongside the mapper itself.
+            /// For controller elements that are not used, `nullptr` may be set instead.
+            constexpr Mapper(const std::wstring_view name, const TElementMappers& elements) : ownedElements(nullptr), elements(elements), capabilities(DeriveCapabilities(this->elements)), dependencies(BuildDependencies(this->elements)), name(name)
+            {
+                // Nothing to do here.
+            }
+
+            /// Copy constructor. Should never be invoked.
+            Mapper(const Mapper& other) = delete;
+
+            /// Default destructor.
+            /// Destroys any owned element mappers. Mappers whose element mappers are compile-time constants own nothing, so their destruction is trivial and can itself happen at compile time.
+            constexpr ~Mapper(void)
+            {
+                if (false == std::is_constant_evaluated())
+                    delete ownedElements;
+            }
+
 
             // -------- CLASS METHODS -------------------------------------- //
 
-            /// Dumps information about all registered mappers.
+            /// Dumps information about all known mappers.
             static void DumpRegisteredMappers(void);
 
+            /// Determines which XInput controller elements differ between two XInput controller states.
+            /// @param [in] previousXInputState Previous XInput controller state.
+            /// @param [in] xinputState Current XInput controller state.
+            /// @return Set of XInput controller elements whose values differ.
+            static TXInputElementSet ChangedXInputElements(const XINPUT_GAMEPAD& previousXInputState, const XINPUT_GAMEPAD& xinputState);
+
+            /// Retrieves and returns a pointer to the built-in mapper object whose type is specified.
+            /// Built-in mapper objects are compile-time constants, so this operation does not dynamically allocate or deallocate memory, nor should the caller attempt to free the returned pointer.
+            /// @param [in] mapperName Name of the desired mapper type. Supported values are defined in "MapperDefinitions.cpp" as mapper instances.
+            /// @return Pointer to the mapper of specified type, or `nullptr` if said type is not built-in.
+            static const Mapper* GetBuiltinByName(std::wstring_view mapperName);
+
             /// Retrieves and returns a pointer to the mapper object whose type is specified.
-            /// Mapper objects are created and managed internally, so this operation does not dynamically allocate or deallocate memory, nor should the caller attempt to free the returned pointer.
-            /// @param [in] mapperName Name of the desired mapper type. Supported values are defined in "Mapper.cpp" as mapper instances.
+            /// Built-in mappers are searched first, followed by custom mappers defined in the most recently loaded configuration.
+            /// Mapper objects are created and managed internally, so the caller should not attempt to free the returned pointer.
+            /// @param [in] mapperName Name of the desired mapper type.
             /// @return Pointer to the mapper of specified type, or `nullptr` if said type is unavailable.
             static const Mapper* GetByName(std::wstring_view mapperName);
 
             /// Retrieves and returns a pointer to the mapper object whose type is read from the configuration file.
             /// If no mapper specified there, then the default mapper type is used instead.
+            /// Reflects the most recently published configuration snapshot, so the result can change after the configuration is reloaded.
             static const Mapper* GetConfigured(void);
 
             /// Retrieves and returns a pointer to the default mapper object.
@@ -135,6 +442,14 @@ namespace Xidi
                 return GetByName(L"");
             }
 
+            /// Compiles all custom mappers defined in the specified configuration data and makes them available by name, replacing the custom mappers from any previously loaded configuration.
+            /// Each custom mapper is compiled into a mapper whose element mappers are stored alongside it, so custom mappers are represented the same way as built-in mappers and run just as fast.
+            /// Custom mappers whose definitions are unchanged from a previous load are reused rather than compiled again.
+            /// Compiled custom mappers are never destroyed, so pointers to them remain valid even after a later load redefines or removes them.
+            /// Definitions are expected to have been validated while the configuration file was read. Any element mapper that fails to parse is ignored.
+            /// @param [in] configData Configuration data that holds custom mapper definitions.
+            static void LoadCustomMappers(const Configuration::ConfigurationData& configData);
+
             /// Checks if a mapper of the specified name is known and registered.
             /// @param [in] mapperName Name of the mapper to check.
             /// @return `true` if it is registered, `false` otherwise.
@@ -149,14 +464,14 @@ namespace Xidi
             /// Retrieves and returns the capabilities of the virtual controller layout implemented by the mapper.
             /// Controller capabilities act as metadata that are used internally and can be presented to applications.
             /// @return Capabilities of the virtual controller.
-            inline SCapabilities GetCapabilities(void) const
+            inline constexpr SCapabilities GetCapabilities(void) const
             {
                 return capabilities;
             }
 
             /// Retrieves and returns the name of this mapper.
             /// @return Mapper name.
-            inline std::wstring_view GetName(void) const
+            inline constexpr std::wstring_view GetName(void) const
             {
                 return name;
             }
@@ -166,6 +481,22 @@ namespace Xidi
             /// @param [out] controllerState Controller state object to be filled.
             /// @param [in] xinputState XInput controller state from which to read.
             void MapXInputState(SState& controllerState, XINPUT_GAMEPAD xinputState) const;
+
+            /// Initializes and fills in the specified batch of virtual controller states using the specified batch of XInput controller states.
+            /// Each element mapper is invoked once for all slots rather than once per slot, which allows the mapping work for each XInput controller element to be done for all slots together.
+            /// Result in each slot is identical to the result of filling a single virtual controller state using #MapXInputState.
+            /// @param [out] controllerStates Controller state batch to be filled. Slots beyond the number of slots processed are left with neutral state.
+            /// @param [in] xinputStates XInput controller state batch from which to read.
+            /// @param [in] slotCount Number of slots to process, starting from the first. Must not exceed #kBatchSlotCountMax.
+            void MapXInputStateBatch(SStateBatch& controllerStates, const SXInputBatch& xinputStates, unsigned int slotCount) const;
+
+            /// Updates a virtual controller state data structure object previously filled by this mapper so that it reflects the specified XInput controller state.
+            /// Only the XInput controller elements that depend on the changed elements are mapped again, and only the virtual controller elements they target are modified.
+            /// The result is identical to filling the object from scratch using #MapXInputState.
+            /// @param [in,out] controllerState Controller state object to be updated, which must contain the result of mapping the previous XInput controller state using this mapper.
+            /// @param [in] xinputState XInput controller state from which to read.
+            /// @param [in] changedElements XInput controller elements whose values differ from the previous XInput controller state, typically obtained using #ChangedXInputElements.
+            void MapChangedXInputElements(SState& controllerState, XINPUT_GAMEPAD xinputState, TXInputElementSet changedElements) const;
         };
     }
 }
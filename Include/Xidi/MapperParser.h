@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MapperParser.h
+ *   Declaration of functionality for parsing custom mapper definitions that
+ *   appear in the configuration file.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        namespace MapperParser
+        {
+            // -------- TYPE DEFINITIONS ----------------------------------- //
+
+            /// Enumerates the types of element mappers that can appear in a custom mapper definition.
+            enum class EElementMapperType : uint8_t
+            {
+                None,                                                       ///< XInput controller element is not mapped.
+                Axis,                                                       ///< #AxisMapper
+                DigitalAxis,                                                ///< #DigitalAxisMapper
+                Button,                                                     ///< #ButtonMapper
+                Pov                                                         ///< #PovMapper
+            };
+
+            /// Compact description of a single element mapper, as parsed from a custom mapper definition.
+            /// Only the fields that are relevant to the element mapper type are meaningful, and all others are left at their default values so that descriptions can be compared directly.
+            struct SElementMapperSpec
+            {
+                EElementMapperType type = EElementMapperType::None;         ///< Type of element mapper.
+                EAxis axis = EAxis::X;                                      ///< Target axis, for axis and digital axis element mappers.
+                AxisMapper::EDirection axisDirection = AxisMapper::EDirection::Both; ///< Target axis direction, for axis and digital axis element mappers.
+                EButton button = EButton::B1;                               ///< Target button, for button element mappers.
+                EPovDirection povDirection = EPovDirection::Up;             ///< Target POV direction, for POV element mappers.
+                std::optional<EPovDirection> maybePovDirectionNegative = std::nullopt; ///< Optional second target POV direction, for POV element mappers.
+
+                /// Simple check for equality.
+                /// @param [in] other Object with which to compare.
+                /// @return `true` if this object is equal to the other object, `false` otherwise.
+                bool operator==(const SElementMapperSpec& other) const = default;
+            };
+
+            /// Complete description of a custom mapper, one element mapper description per XInput controller element, indexed by #Mapper::EXInputElement.
+            typedef std::array<SElementMapperSpec, (int)Mapper::EXInputElement::Count> TMapperSpec;
+
+
+            // -------- FUNCTIONS ------------------------------------------ //
+
+            /// Extracts the name of a custom mapper from the name of the configuration file section that defines it.
+            /// @param [in] section Configuration file section name.
+            /// @return Custom mapper name, if the section defines a custom mapper and the name is not empty.
+            std::optional<std::wstring_view> CustomMapperNameFromSection(std::wstring_view section);
+
+            /// Identifies an XInput controller element by the name used for it in custom mapper definitions.
+            /// Names match the enumerators of #Mapper::EXInputElement, for example "StickLeftX" or "ButtonA".
+            /// @param [in] name Name of the XInput controller element.
+            /// @return Identifier of the XInput controller element, if the name is recognized.
+            std::optional<Mapper::EXInputElement> FindXInputElementByName(std::wstring_view name);
+
+            /// Parses a string that describes an element mapper.
+            /// Supported forms are "Axis(axis)", "Axis(axis, direction)", "DigitalAxis(axis)", "DigitalAxis(axis, direction)", "Button(number)", "Pov(direction)", and "Pov(direction, direction)".
+            /// Axes are identified as X, Y, Z, RotX, RotY, or RotZ. Axis directions are identified as + or -. Buttons are numbered from 1. POV directions are identified as Up, Down, Left, or Right.
+            /// @param [in] elementMapperString String to parse.
+            /// @return Description of the element mapper, if the string is valid.
+            std::optional<SElementMapperSpec> ParseElementMapperString(std::wstring_view elementMapperString);
+        }
+    }
+}
@@ -11,7 +11,8 @@
 
 #pragma once
 
-#include <sal.h>
+#include "ApiPlatform.h"
+#include "MessageRateLimiter.h"
 
 
 namespace Xidi
@@ -78,6 +79,20 @@ namespace Xidi
         /// @param [in] format Message string, possibly with format specifiers.
         void OutputFormatted(const ESeverity severity, _Printf_format_string_ const wchar_t* format, ...);
 
+        /// Formats and outputs the specified message, subject to the rate limiter belonging to the call site.
+        /// Intended for messages that can repeat at frame rate. Suppressed messages are not formatted, and the next message output is annotated with the number suppressed.
+        /// @param [in] rateLimiter Rate limiter belonging to the call site.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] format Message string, possibly with format specifiers.
+        void OutputFormattedRateLimited(RateLimiter& rateLimiter, const ESeverity severity, _Printf_format_string_ const wchar_t* format, ...);
+
+        /// Outputs the specified message, subject to the rate limiter belonging to the call site.
+        /// Intended for messages that can repeat at frame rate. The next message output is annotated with the number suppressed.
+        /// @param [in] rateLimiter Rate limiter belonging to the call site.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] message Message text.
+        void OutputRateLimited(RateLimiter& rateLimiter, const ESeverity severity, const wchar_t* message);
+
         /// Sets the minimum message severity required for a message to be output.
         /// Does nothing if the requested severity level is less than the minimum value allowed to be configured.
         /// @param [in] severity New minimum severity setting.
@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MessageRateLimiter.h
+ *   Declaration of the rate limiter that keeps messages repeated at frame
+ *   rate from flooding the log.
+ *****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Message
+    {
+        /// Limits how many messages a single call site outputs, so that a condition repeating at frame rate does not flood the log.
+        /// Each call site owns one of these objects, typically as a function-local static or as a member of the object that generates the messages.
+        /// Messages pass two checks. First, a token bucket holding #kDefaultBurstSize tokens refilled at one token per refill interval bounds the rate at which messages are even formatted.
+        /// Second, a formatted message identical to the last one output is held back until the repeat interval elapses, at which point it is output again along with the number of messages suppressed in between.
+        /// The first check is the hot path and costs only an atomic load and an atomic increment whenever the bucket is empty. Concurrency-safe.
+        class RateLimiter
+        {
+        public:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Default number of messages that can be output in quick succession before the rate limit applies.
+            static constexpr unsigned int kDefaultBurstSize = 5;
+
+            /// Default time, in nanoseconds, needed to earn back the ability to output one more message.
+            static constexpr uint64_t kDefaultRefillInterval = 1000000000ull;
+
+            /// Default minimum time, in nanoseconds, between outputs of identical messages.
+            static constexpr uint64_t kDefaultRepeatInterval = 30000000000ull;
+
+
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Time needed to earn back one token, in nanoseconds.
+            const uint64_t kRefillInterval;
+
+            /// Time needed to refill an empty bucket completely, in nanoseconds.
+            const uint64_t kBurstInterval;
+
+            /// Minimum time between outputs of identical messages, in nanoseconds.
+            const uint64_t kRepeatInterval;
+
+            /// Time, in nanoseconds, at which the bucket will be full again if no more tokens are taken.
+            /// Tracking this one value instead of a token count and a refill time is what allows the bucket to be checked and updated atomically.
+            std::atomic<uint64_t> bucketFullTime;
+
+            /// Number of messages suppressed since the last message was output.
+            std::atomic<unsigned int> suppressedCount;
+
+            /// Hash of the last message output, if any message has been output yet.
+            std::optional<size_t> lastMessageHash;
+
+            /// Time at which the last message was output, in nanoseconds.
+            uint64_t lastMessageTime;
+
+            /// Serializes access to the information about the last message output.
+            std::mutex lastMessageMutex;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// @param [in] burstSize Number of messages that can be output in quick succession before the rate limit applies. Must be at least 1.
+            /// @param [in] refillInterval Time, in nanoseconds, needed to earn back the ability to output one more message.
+            /// @param [in] repeatInterval Minimum time, in nanoseconds, between outputs of identical messages.
+            RateLimiter(unsigned int burstSize = kDefaultBurstSize, uint64_t refillInterval = kDefaultRefillInterval, uint64_t repeatInterval = kDefaultRepeatInterval);
+
+            /// Copy constructor. Should never be invoked.
+            RateLimiter(const RateLimiter& other) = delete;
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Determines if a message that passed #TryAcquire should be output, based on whether it repeats the last message output.
+            /// A message that is output resets the suppressed message count.
+            /// @param [in] message Complete text of the message.
+            /// @param [in] timestamp Current time, in nanoseconds.
+            /// @return Number of messages suppressed since the last message was output if this message should be output, or nothing if it should be suppressed.
+            std::optional<unsigned int> Admit(std::wstring_view message, uint64_t timestamp);
+
+            /// Retrieves the number of messages suppressed since the last message was output.
+            /// @return Number of suppressed messages.
+            inline unsigned int GetSuppressedCount(void) const
+            {
+                return suppressedCount.load(std::memory_order_relaxed);
+            }
+
+            /// Attempts to take a token from the bucket, which is required before a message is formatted.
+            /// Failing to take a token counts as a suppressed message.
+            /// @param [in] timestamp Current time, in nanoseconds.
+            /// @return `true` if a token was taken and the message can be formatted, `false` if it should be suppressed.
+            bool TryAcquire(uint64_t timestamp);
+        };
+    }
+}
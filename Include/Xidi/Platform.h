@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Platform.h
+ *   Declaration of the thin platform abstraction layer used by the portable
+ *   controller core for operating system services such as timekeeping and
+ *   file access.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+
+namespace Xidi
+{
+    namespace Platform
+    {
+        // -------- FUNCTIONS ---------------------------------------------- //
+
+        /// Prevents the module that contains Xidi from being unloaded until a matching invocation of #ReleaseModuleReferenceAndExitThread.
+        /// Used by background threads, which must not have their code unloaded while they are running.
+        /// @return `true` if a reference was acquired and must later be released, `false` if the platform does not track module references or the reference could not be acquired.
+        bool AcquireModuleReference(void);
+
+        /// Retrieves the number of milliseconds that have elapsed since an arbitrary fixed point in time.
+        /// Intended for timestamping events. The value wraps around after about 49.7 days, just like `GetTickCount` on Windows.
+        /// @return Millisecond timestamp.
+        uint32_t GetMillisecondTimestamp(void);
+
+        /// Retrieves the number of nanoseconds that have elapsed since an arbitrary fixed point in time, using the highest-resolution monotonic counter available.
+        /// On Windows this is the performance counter, whose resolution is typically well under a microsecond, as opposed to the 10 to 16 millisecond resolution of `GetTickCount`.
+        /// @return Nanosecond timestamp.
+        uint64_t GetNanosecondTimestamp(void);
+
+        /// Determines if a debugger is attached to the current process.
+        /// @return `true` if so, `false` if not or if this cannot be determined.
+        bool IsDebuggerAttached(void);
+
+        /// Opens the specified file using the specified mode, as with `fopen`.
+        /// @param [in] fileName Name of the file to open. Must be null-terminated.
+        /// @param [in] mode File access mode string. Must be null-terminated.
+        /// @return Handle to the open file, or `nullptr` on failure. Must be closed using `fclose`.
+        FILE* OpenFile(const wchar_t* fileName, const wchar_t* mode);
+
+        /// Sends the specified text to an attached debugger, if the platform supports doing so, or to the standard error stream otherwise.
+        /// @param [in] text Text to output. Must be null-terminated.
+        void OutputDebuggerText(const wchar_t* text);
+
+        /// Releases a reference acquired using #AcquireModuleReference without exiting the calling thread.
+        /// Only for use when the background thread that would otherwise have released the reference could not be created.
+        void ReleaseModuleReference(void);
+
+        /// Releases a reference acquired using #AcquireModuleReference and exits the calling thread.
+        /// On Windows this does not return, because the module, including the code that invoked this function, may be unloaded as soon as the reference is released.
+        /// Elsewhere module references are not tracked, so this function returns immediately and the calling thread should exit normally.
+        void ReleaseModuleReferenceAndExitThread(void);
+    }
+}
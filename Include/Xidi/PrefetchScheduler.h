@@ -0,0 +1,232 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file PrefetchScheduler.h
+ *   Declaration of the scheduler that learns how often applications read
+ *   controller state and reads XInput just ahead of each predicted read.
+ *****************************************************************************/
+
+#pragma once
+
+#include "BackgroundWorker.h"
+#include "Clock.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        /// Learns the period and phase at which an application reads controller state.
+        /// Applications typically read once per frame or once per physics tick, possibly several times in quick succession within the same frame.
+        /// Reads that happen within #kSameFrameInterval of the first read of a frame are considered part of that frame, and the first read of each frame establishes the phase.
+        /// Once enough consecutive frames are spaced consistently, the next read can be predicted.
+        /// Not concurrency-safe, so some form of external concurrency control is required.
+        class CadenceTracker
+        {
+        public:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Reads that follow the first read of a frame by less than this amount of time, in nanoseconds, belong to the same frame.
+            static constexpr uint64_t kSameFrameInterval = 1000000ull;
+
+            /// Longest frame period, in nanoseconds, that is considered a cadence. A longer gap between frames means the application paused, so learning starts over.
+            static constexpr uint64_t kMaximumPeriod = 250000000ull;
+
+            /// Number of consecutive consistently-spaced frame intervals required before predictions are made.
+            static constexpr unsigned int kStableIntervalsRequired = 4;
+
+
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Time of the first read of the most recent frame, in nanoseconds, if any read has happened yet.
+            std::optional<uint64_t> lastFrameStart;
+
+            /// Current estimate of the frame period, in nanoseconds, or 0 if there is no estimate.
+            uint64_t period;
+
+            /// Number of consecutive frame intervals that agreed with the period estimate.
+            unsigned int stableIntervalCount;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor.
+            inline CadenceTracker(void) : lastFrameStart(), period(0), stableIntervalCount(0)
+            {
+                // Nothing to do here.
+            }
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Retrieves the current estimate of the frame period.
+            /// @return Frame period in nanoseconds, or 0 if there is no estimate.
+            inline uint64_t GetPeriod(void) const
+            {
+                return period;
+            }
+
+            /// Determines if state that was captured ahead of a predicted read is too old to be delivered to a read that is happening now.
+            /// This is the case once more than one period has passed since the capture, which means the application skipped the frame for which the state was captured.
+            /// Must be invoked before the read is recorded using #RecordRead.
+            /// @param [in] captureTimestamp Time at which the state was captured, in nanoseconds.
+            /// @param [in] readTimestamp Time of the read, in nanoseconds.
+            /// @return `true` if the state should be captured again, `false` if it can be delivered.
+            inline bool IsPrefetchStale(uint64_t captureTimestamp, uint64_t readTimestamp) const
+            {
+                return ((0 == period) || (readTimestamp > (captureTimestamp + period)));
+            }
+
+            /// Predicts when the application will start its next frame by reading controller state.
+            /// @return Predicted time of the next read in nanoseconds, or no value if the cadence is not yet known.
+            std::optional<uint64_t> PredictNextRead(void) const;
+
+            /// Records that the application read controller state.
+            /// @param [in] timestamp Time of the read, in nanoseconds.
+            /// @return `true` if the read started a new frame, `false` if it belongs to the same frame as the previous read.
+            bool RecordRead(uint64_t timestamp);
+        };
+
+        /// Describes what a prefetch target expects of its consumer.
+        struct SPrefetchPrediction
+        {
+            uint64_t nextRead;                                              ///< Predicted time of the consumer's next read, in nanoseconds.
+            uint64_t period;                                                ///< Learned period between the consumer's reads, in nanoseconds.
+            bool prefetchPending;                                           ///< Whether a previous prefetch has yet to be consumed.
+        };
+
+        /// Interface for objects whose state can be read from XInput ahead of time on behalf of a consumer.
+        /// Implementations learn their consumer's cadence and keep the prefetched state until the consumer reads it.
+        class IPrefetchTarget
+        {
+        public:
+            // -------- ABSTRACT INSTANCE METHODS -------------------------- //
+
+            /// Retrieves the information needed to schedule the next prefetch. Must be concurrency-safe.
+            /// @return Prediction for the consumer's next read, or no value if the consumer's cadence is not yet known.
+            virtual std::optional<SPrefetchPrediction> GetPrefetchPrediction(void) = 0;
+
+            /// Reads state from XInput and holds it for the consumer's next read. Must be concurrency-safe.
+            virtual void Prefetch(void) = 0;
+        };
+
+        /// Issues XInput reads for each registered prefetch target just before its consumer is predicted to read, so that the consumer receives state that is as fresh as possible while XInput is read only once per consumer frame.
+        /// A background thread sleeps until the earliest scheduled prefetch. Targets whose cadence is not yet known are checked again periodically.
+        /// Waits are subject to the resolution of the operating system timer, so the lead time should be longer than one timer tick.
+        /// All methods are concurrency-safe.
+        class PrefetchScheduler
+        {
+        public:
+            // -------- CONSTANTS ------------------------------------------ //
+
+            /// Default amount of time, in nanoseconds, by which a prefetch precedes the predicted read.
+            static constexpr uint64_t kDefaultLeadTime = 2000000ull;
+
+            /// Amount of time, in nanoseconds, after which a target without a known cadence is checked again.
+            static constexpr uint64_t kIdleCheckInterval = 20000000ull;
+
+
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Clock used to decide when prefetches are due.
+            const IClock& clock;
+
+            /// Amount of time, in nanoseconds, by which a prefetch precedes the predicted read.
+            uint64_t leadTime;
+
+            /// Registered prefetch targets. Not owned by this object.
+            std::vector<IPrefetchTarget*> targets;
+
+            /// Targets whose prefetches are in progress, with one entry per prefetch. Prefetches are performed without holding the scheduler lock, so unregistering a target waits until it no longer appears here.
+            std::vector<IPrefetchTarget*> prefetchingTargets;
+
+            /// Serializes access to the targets, the targets being prefetched, and the lead time.
+            std::mutex schedulerMutex;
+
+            /// Notified whenever a prefetch completes.
+            std::condition_variable prefetchCompleted;
+
+            /// Background thread that performs prefetches. Notified whenever the set of targets changes.
+            BackgroundWorker prefetchWorker;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// The background thread is not started until #Start is invoked.
+            /// @param [in] clock Clock used to decide when prefetches are due.
+            PrefetchScheduler(const IClock& clock = SystemClock::GetInstance());
+
+            /// Copy constructor. Should never be invoked.
+            PrefetchScheduler(const PrefetchScheduler& other) = delete;
+
+            /// Default destructor. Stops the background thread if it is running.
+            ~PrefetchScheduler(void);
+
+
+        private:
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Entry point for the background thread.
+            void PrefetchThreadMain(void);
+
+
+        public:
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Retrieves the scheduler with which virtual controllers presented to applications are registered.
+            /// It does not perform any prefetches until it is started, which happens only if prefetching is enabled in the configuration file.
+            /// @return Reference to the default scheduler.
+            static PrefetchScheduler& GetDefault(void);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Abandons the background thread as the process terminates, without waiting for it or acquiring any locks.
+            /// Afterwards this object no longer synchronizes with the background thread, even as it is destroyed.
+            inline void Abandon(void)
+            {
+                prefetchWorker.Abandon();
+            }
+
+            /// Registers a prefetch target. It must remain valid until it is unregistered using #RemoveTarget.
+            /// @param [in] target Target to register.
+            void AddTarget(IPrefetchTarget* target);
+
+            /// Determines if the background thread is running.
+            /// @return `true` if so, `false` otherwise.
+            bool IsRunning(void);
+
+            /// Unregisters a prefetch target. Once this method returns, the scheduler no longer accesses the target.
+            /// If a prefetch for the target is in progress, waits for it to complete.
+            /// @param [in] target Target to unregister.
+            void RemoveTarget(IPrefetchTarget* target);
+
+            /// Prefetches for every target whose prefetch is due and determines when the next prefetch will be due.
+            /// Invoked repeatedly by the background thread, and can be invoked directly when the background thread is not running.
+            /// @return Time, in nanoseconds, at which this method should next be invoked.
+            uint64_t RunDuePrefetches(void);
+
+            /// Starts the background thread. Has no effect if it is already running.
+            /// @param [in] newLeadTime Amount of time, in nanoseconds, by which each prefetch should precede the predicted read.
+            void Start(uint64_t newLeadTime = kDefaultLeadTime);
+
+            /// Stops the background thread and waits for it to exit. Has no effect if it is not running.
+            void Stop(void);
+        };
+    }
+}
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Profiler.h
+ *   Declaration of an opt-in profiler that measures how long application
+ *   calls into Xidi's DirectInput and WinMM entry points take.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace Xidi
+{
+    namespace Profiler
+    {
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Number of virtual controllers for which invocations are profiled separately.
+        inline constexpr uint32_t kControllerCount = XUSER_MAX_COUNT;
+
+        /// Slot used for invocations that are not associated with a virtual controller, such as device enumeration or calls that target a non-XInput device.
+        inline constexpr uint32_t kNoController = kControllerCount;
+
+        /// Number of controller slots per entry point, including the slot for invocations not associated with a virtual controller.
+        inline constexpr uint32_t kControllerSlotCount = kControllerCount + 1;
+
+        /// Number of latency histogram buckets.
+        /// Bucket 0 holds latencies of 0 ns, and bucket `n` holds latencies from 2^(n-1) ns up to but not including 2^n ns. The last bucket also holds all higher latencies.
+        inline constexpr uint32_t kHistogramBucketCount = 32;
+
+
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Enumerates the application-facing entry points that are profiled.
+        enum class EEntryPoint : uint32_t
+        {
+            DirectInputEnumDevices,                                         ///< `IDirectInput8::EnumDevices`
+            DirectInputEnumObjects,                                         ///< `IDirectInputDevice8::EnumObjects`
+            DirectInputGetDeviceData,                                       ///< `IDirectInputDevice8::GetDeviceData`
+            DirectInputGetDeviceState,                                      ///< `IDirectInputDevice8::GetDeviceState`
+            DirectInputGetProperty,                                         ///< `IDirectInputDevice8::GetProperty`
+            DirectInputPoll,                                                ///< `IDirectInputDevice8::Poll`
+            DirectInputSetProperty,                                         ///< `IDirectInputDevice8::SetProperty`
+            WinMMJoyConfigChanged,                                          ///< `joyConfigChanged`
+            WinMMJoyGetDevCaps,                                             ///< `joyGetDevCaps`
+            WinMMJoyGetNumDevs,                                             ///< `joyGetNumDevs`
+            WinMMJoyGetPos,                                                 ///< `joyGetPos`
+            WinMMJoyGetPosEx,                                               ///< `joyGetPosEx`
+            WinMMJoyGetThreshold,                                           ///< `joyGetThreshold`
+            WinMMJoyReleaseCapture,                                         ///< `joyReleaseCapture`
+            WinMMJoySetCapture,                                             ///< `joySetCapture`
+            WinMMJoySetThreshold,                                           ///< `joySetThreshold`
+            Count                                                           ///< Sentinel value, total number of enumerators
+        };
+
+        /// Enumerates the phases of library startup that are timed by the startup trace.
+        enum class EStartupPhase : uint32_t
+        {
+            LibraryAttach,                                                  ///< Work performed within the library entry point when the library is loaded.
+            ConfigurationRead,                                              ///< Reading and parsing the configuration file.
+            LogEnable,                                                      ///< Creating the log file, if it is enabled.
+            MapperRegistration,                                             ///< Registering custom mappers defined in the configuration file.
+            FeatureStartup,                                                 ///< Starting optional features, such as statistics, prefetching, and the control endpoint.
+            WinMMSystemDeviceInfo,                                          ///< Enumerating the devices WinMM makes available and detecting which of them support XInput.
+            WinMMJoyIndexMap,                                               ///< Building the map from application joystick index to WinMM device or virtual controller.
+            WinMMControllerNames,                                           ///< Publishing virtual controller names in the registry for WinMM applications.
+            Count                                                           ///< Sentinel value, total number of enumerators
+        };
+
+        /// Timing of a single startup phase.
+        struct SStartupPhaseRecord
+        {
+            bool recorded;                                                  ///< Whether the phase has completed. Other members are only meaningful if so.
+            uint64_t startNanoseconds;                                      ///< Time at which the phase began, in nanoseconds since the library was loaded.
+            uint64_t durationNanoseconds;                                   ///< Time taken by the phase, in nanoseconds.
+        };
+
+        /// Profiling results for a single entry point invoked on a single virtual controller.
+        struct SInvocationStatistics
+        {
+            uint64_t count;                                                 ///< Number of invocations.
+            uint64_t totalNanoseconds;                                      ///< Sum of the latencies of all invocations, in nanoseconds.
+            uint64_t maxNanoseconds;                                        ///< Highest latency of any invocation, in nanoseconds.
+            uint64_t histogram[kHistogramBucketCount];                      ///< Number of invocations whose latencies fall into each histogram bucket.
+        };
+
+        /// Profiling results for all entry points and virtual controllers, merged across all threads.
+        struct SReport
+        {
+            SInvocationStatistics entryPoint[(int)EEntryPoint::Count][kControllerSlotCount]; ///< Profiling results, indexed first by #EEntryPoint and then by controller slot.
+        };
+
+        /// Measures a single invocation of an entry point for as long as it is in scope.
+        /// Objects of this type are intended to be created at the very start of an entry point so that the entire invocation is measured, including any logging.
+        class ScopedInvocation
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Entry point being measured.
+            const EEntryPoint kEntryPoint;
+
+            /// Controller slot to which the invocation is attributed.
+            uint32_t controllerSlot;
+
+            /// Whether or not this invocation is being measured. Fixed at construction so that enabling the profiler mid-invocation has no effect.
+            const bool kIsMeasuring;
+
+            /// Time at which the invocation started. Only meaningful if the invocation is being measured.
+            const std::chrono::steady_clock::time_point kStartTime;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// Starts measuring the invocation, but only if the profiler is enabled.
+            /// @param [in] entryPoint Entry point being invoked.
+            /// @param [in] controllerId Identifier of the virtual controller on which the entry point is being invoked, or #kNoController if there is none or it is not yet known.
+            ScopedInvocation(EEntryPoint entryPoint, uint32_t controllerId = kNoController);
+
+            /// Copy constructor. Should never be invoked.
+            ScopedInvocation(const ScopedInvocation& other) = delete;
+
+            /// Default destructor.
+            /// Records the measured invocation.
+            ~ScopedInvocation(void);
+
+
+            // -------- INSTANCE METHODS ----------------------------------- //
+
+            /// Attributes this invocation to a virtual controller.
+            /// Useful for entry points that identify virtual controllers only once some of their parameters have been processed.
+            /// @param [in] controllerId Identifier of the virtual controller on which the entry point is being invoked.
+            inline void SetController(uint32_t controllerId)
+            {
+                controllerSlot = ((controllerId < kControllerCount) ? controllerId : kNoController);
+            }
+        };
+
+        /// Measures a single startup phase for as long as it is in scope.
+        /// Startup phases are always measured, whether or not the profiler is enabled, because each phase happens at most once.
+        class ScopedStartupPhase
+        {
+        private:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Startup phase being measured.
+            const EStartupPhase kPhase;
+
+            /// Time at which the phase started.
+            const std::chrono::steady_clock::time_point kStartTime;
+
+
+        public:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Initialization constructor.
+            /// Starts measuring the startup phase.
+            /// @param [in] phase Startup phase being measured.
+            inline ScopedStartupPhase(EStartupPhase phase) : kPhase(phase), kStartTime(std::chrono::steady_clock::now())
+            {
+                // Nothing to do here.
+            }
+
+            /// Copy constructor. Should never be invoked.
+            ScopedStartupPhase(const ScopedStartupPhase& other) = delete;
+
+            /// Default destructor.
+            /// Records the measured startup phase.
+            ~ScopedStartupPhase(void);
+        };
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+
+        /// Enables the profiler. Only invocations that begin after this function is called are measured.
+        /// Once enabled, the profiler cannot be disabled.
+        void Enable(void);
+
+        /// Retrieves a human-readable name for the specified entry point.
+        /// @param [in] entryPoint Entry point identifier.
+        /// @return Name of the entry point.
+        const wchar_t* EntryPointName(EEntryPoint entryPoint);
+
+        /// Retrieves the timing of the specified startup phase.
+        /// @param [in] phase Startup phase identifier.
+        /// @return Timing of the startup phase, which indicates it was not recorded if the phase has not yet completed.
+        SStartupPhaseRecord GetStartupPhaseRecord(EStartupPhase phase);
+
+        /// Determines which latency histogram bucket holds the specified latency.
+        /// @param [in] latencyNanoseconds Latency, in nanoseconds.
+        /// @return Histogram bucket index.
+        uint32_t HistogramBucketForLatency(uint64_t latencyNanoseconds);
+
+        /// Determines if the profiler is enabled.
+        /// @return `true` if so, `false` if not.
+        bool IsEnabled(void);
+
+        /// Outputs the merged profiling results as informational messages, but only if the profiler is enabled.
+        /// Entry points that were never invoked are omitted.
+        void OutputReport(void);
+
+        /// Outputs the timing of every startup phase that has completed since the last time this function was invoked, as informational messages.
+        /// Intended to be invoked once each group of startup phases completes, by which time the log has been enabled if it is configured.
+        void OutputStartupTrace(void);
+
+        /// Records a single measured invocation in the calling thread's counters.
+        /// Has no effect if the profiler is not enabled.
+        /// @param [in] entryPoint Entry point that was invoked.
+        /// @param [in] controllerSlot Controller slot to which the invocation is attributed.
+        /// @param [in] latencyNanoseconds Time taken by the invocation, in nanoseconds.
+        void RecordInvocation(EEntryPoint entryPoint, uint32_t controllerSlot, uint64_t latencyNanoseconds);
+
+        /// Records the timing of a startup phase. Only the first recording of each phase is kept.
+        /// @param [in] phase Startup phase that was measured.
+        /// @param [in] startTime Time at which the phase started.
+        /// @param [in] endTime Time at which the phase ended.
+        void RecordStartupPhase(EStartupPhase phase, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+
+        /// Retrieves a human-readable name for the specified startup phase.
+        /// @param [in] phase Startup phase identifier.
+        /// @return Name of the startup phase.
+        const wchar_t* StartupPhaseName(EStartupPhase phase);
+
+        /// Merges the counters of all threads, including threads that have exited, into a single report.
+        /// Each counter is read atomically, but the counters are not read together as a single atomic operation.
+        /// @return Merged profiling results.
+        SReport TakeReport(void);
+    }
+}
@@ -0,0 +1,199 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SequenceLock.h
+ *   Declaration and implementation of a value protected by a sequence lock,
+ *   which readers retrieve without ever taking a lock.
+ *****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+
+namespace Xidi
+{
+    /// Holds a value that a single writer publishes and any number of readers retrieve concurrently, without readers ever taking a lock or blocking the writer.
+    /// The value is stored as a sequence of 32-bit words guarded by a generation number, which is odd while a write is in progress. Readers copy the words and retry if the generation changed in the meantime.
+    /// Readers are concurrency-safe with each other and with the writer. Writes using #Write are not concurrency-safe with each other, so callers must serialize them, for example by holding an owning object's lock. Writes using #TryWrite need no such serialization.
+    /// Consists only of lock-free atomic words and all zeroes represents a value that has never been written, so an object of this type can also be placed in zero-filled memory shared between processes without being constructed.
+    /// @tparam ValueType Type of value to hold. Must be trivially copyable and have a size that is a multiple of 4 bytes.
+    template <typename ValueType> class SequenceLocked
+    {
+        static_assert(true == std::is_trivially_copyable_v<ValueType>, "Value type must be trivially copyable.");
+        static_assert(0 == (sizeof(ValueType) % sizeof(uint32_t)), "Value type size must be a multiple of 4 bytes.");
+        static_assert(true == std::atomic<uint32_t>::is_always_lock_free, "Words must be lock-free.");
+
+    public:
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Number of 32-bit words needed to hold the value.
+        static constexpr unsigned int kWordCount = (unsigned int)(sizeof(ValueType) / sizeof(uint32_t));
+
+
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Generation number. Odd while a write is in progress, and advanced by 2 with each completed write, so 0 means the value has never been written.
+        std::atomic<uint32_t> generation;
+
+        /// Value, held as 32-bit words so that a read racing with a write is well-defined and can be detected and retried.
+        std::atomic<uint32_t> data[kWordCount];
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Holding an initial value does not count as a write.
+        /// @param [in] initialValue Value to hold initially.
+        inline SequenceLocked(const ValueType& initialValue = ValueType()) : generation(0), data()
+        {
+            StoreWords(initialValue);
+        }
+
+        /// Copy constructor. Should never be invoked.
+        SequenceLocked(const SequenceLocked& other) = delete;
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Stores the words of a value, without regard for the generation number.
+        /// @param [in] newValue New value to hold.
+        inline void StoreWords(const ValueType& newValue)
+        {
+            const uint8_t* const kNewValueBytes = reinterpret_cast<const uint8_t*>(&newValue);
+
+            for (unsigned int i = 0; i < kWordCount; ++i)
+            {
+                uint32_t word;
+                std::memcpy(&word, &kNewValueBytes[i * sizeof(uint32_t)], sizeof(word));
+                data[i].store(word, std::memory_order_relaxed);
+            }
+        }
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Marks a write that was interrupted partway through as complete, so that readers stop waiting for it. Has no effect if no write is in progress.
+        /// Intended for use only when the writer is known to have exited in the middle of a write, such as a process that terminated while writing to shared memory. The value may be inconsistent until the next write.
+        inline void ClearInterruptedWrite(void)
+        {
+            uint32_t expectedGeneration = generation.load(std::memory_order_relaxed);
+            if (0 != (expectedGeneration & 1))
+                generation.compare_exchange_strong(expectedGeneration, expectedGeneration + 1, std::memory_order_relaxed);
+        }
+
+        /// Retrieves a consistent copy of the value, as of the most recently completed write.
+        /// Never blocks. If a write is in progress or completes during the read, the read is repeated.
+        /// @return Copy of the value.
+        inline ValueType Read(void) const
+        {
+            uint32_t words[kWordCount];
+
+            while (true)
+            {
+                const uint32_t kGenerationBefore = generation.load(std::memory_order_acquire);
+                if (0 != (kGenerationBefore & 1))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (unsigned int i = 0; i < kWordCount; ++i)
+                    words[i] = data[i].load(std::memory_order_relaxed);
+
+                // Orders the data before the second generation check, so an unchanged generation means none of the data came from a later write.
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (kGenerationBefore == generation.load(std::memory_order_relaxed))
+                    break;
+            }
+
+            ValueType value;
+            std::memcpy(&value, words, sizeof(value));
+            return value;
+        }
+
+        /// Attempts to retrieve a consistent copy of the value, as of the most recently completed write, without waiting indefinitely for a write in progress to complete.
+        /// Suitable for values shared with writers that might stop partway through a write, such as those in other processes.
+        /// @param [in] maxAttempts Maximum number of times to attempt the read before giving up.
+        /// @return Copy of the value, or no value if it has never been written or a consistent copy could not be retrieved within the allowed number of attempts.
+        inline std::optional<ValueType> TryRead(unsigned int maxAttempts) const
+        {
+            uint32_t words[kWordCount];
+
+            for (unsigned int attempt = 0; attempt < maxAttempts; ++attempt)
+            {
+                const uint32_t kGenerationBefore = generation.load(std::memory_order_acquire);
+                if (0 == kGenerationBefore)
+                    return std::nullopt;
+
+                if (0 != (kGenerationBefore & 1))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (unsigned int i = 0; i < kWordCount; ++i)
+                    words[i] = data[i].load(std::memory_order_relaxed);
+
+                // Orders the data before the second generation check, so an unchanged generation means none of the data came from a later write.
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (kGenerationBefore == generation.load(std::memory_order_relaxed))
+                {
+                    ValueType value;
+                    std::memcpy(&value, words, sizeof(value));
+                    return value;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        /// Attempts to replace the value, giving up instead of waiting if another write is in progress.
+        /// Concurrency-safe with other writes, because the write in progress is claimed atomically. Intended for values with more than one potential writer, of which only one is normally active.
+        /// @param [in] newValue New value to hold.
+        /// @return `true` if the value was replaced, `false` if another write was in progress.
+        inline bool TryWrite(const ValueType& newValue)
+        {
+            uint32_t expectedGeneration = generation.load(std::memory_order_relaxed);
+            if ((0 != (expectedGeneration & 1)) || (false == generation.compare_exchange_strong(expectedGeneration, expectedGeneration + 1, std::memory_order_relaxed)))
+                return false;
+
+            // Orders the odd generation before the data, so a reader that observes any of the new data also observes that a write is in progress.
+            std::atomic_thread_fence(std::memory_order_release);
+
+            StoreWords(newValue);
+            generation.store(expectedGeneration + 2, std::memory_order_release);
+            return true;
+        }
+
+        /// Replaces the value.
+        /// Not concurrency-safe with other writes.
+        /// @param [in] newValue New value to hold.
+        inline void Write(const ValueType& newValue)
+        {
+            const uint32_t kGeneration = generation.load(std::memory_order_relaxed);
+            generation.store(kGeneration + 1, std::memory_order_relaxed);
+
+            // Orders the odd generation before the data, so a reader that observes any of the new data also observes that a write is in progress.
+            std::atomic_thread_fence(std::memory_order_release);
+
+            StoreWords(newValue);
+            generation.store(kGeneration + 2, std::memory_order_release);
+        }
+    };
+}
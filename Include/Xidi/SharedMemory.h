@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SharedMemory.h
+ *   Declaration of an interface for named memory regions that are shared
+ *   between processes.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+
+namespace Xidi
+{
+    /// Shared memory interface class.
+    /// Each object that implements this interface maps at most one named memory region at a time, and keeps it mapped until the object is destroyed.
+    /// The purpose of exposing shared memory operations this way is to allow a different backing store to be substituted, for example during testing.
+    class ISharedMemory
+    {
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default destructor.
+        virtual ~ISharedMemory(void) = default;
+
+
+        // -------- ABSTRACT INSTANCE METHODS ------------------------------ //
+
+        /// Creates a named memory region of the specified size, or opens it if it already exists, and maps it for reading and writing.
+        /// @param [in] name Name of the memory region. Must be null-terminated.
+        /// @param [in] size Size of the memory region, in bytes.
+        /// @return Pointer to the start of the mapped memory region, or `nullptr` on failure.
+        virtual void* Create(std::wstring_view name, size_t size) = 0;
+
+        /// Opens an existing named memory region and maps it for reading only.
+        /// @param [in] name Name of the memory region. Must be null-terminated.
+        /// @param [in] size Number of bytes to map, which must not exceed the size of the memory region.
+        /// @return Pointer to the start of the mapped memory region, or `nullptr` on failure.
+        virtual const void* Open(std::wstring_view name, size_t size) = 0;
+    };
+
+    /// Default implementation of the shared memory interface.
+    /// Memory regions are file mappings backed by the system paging file.
+    class SharedMemory : public ISharedMemory
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Handle to the file mapping object, or `nullptr` if nothing is mapped.
+        void* mappingHandle;
+
+        /// Mapped view of the file mapping object, or `nullptr` if nothing is mapped.
+        void* view;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Default constructor.
+        inline SharedMemory(void) : mappingHandle(nullptr), view(nullptr)
+        {
+            // Nothing to do here.
+        }
+
+        /// Copy constructor. Should never be invoked.
+        SharedMemory(const SharedMemory& other) = delete;
+
+        /// Default destructor.
+        /// Unmaps any mapped memory region.
+        ~SharedMemory(void) override;
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void* Create(std::wstring_view name, size_t size) override;
+        const void* Open(std::wstring_view name, size_t size) override;
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Unmaps the currently-mapped memory region, if any.
+        void Close(void);
+    };
+}
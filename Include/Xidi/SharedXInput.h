@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SharedXInput.h
+ *   Declaration of an implementation of the XInput interface that shares a
+ *   single poller of controller states among all processes that load Xidi.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "BackgroundWorker.h"
+#include "Clock.h"
+#include "SequenceLock.h"
+#include "SharedMemory.h"
+#include "XInputInterface.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+
+
+namespace Xidi
+{
+    /// Implementation of the XInput interface that lets several processes share one poller of an underlying XInput source.
+    /// All participating processes map the same shared memory segment, which holds the raw state of every XInput user index.
+    /// The first process to map the segment becomes its owner and is the only one that reads the underlying source, which it does periodically on a background thread.
+    /// Every process, owner included, retrieves states from the segment without taking any locks, and applies its own mappers and properties to them as usual.
+    /// If the owner exits, or stops updating the segment for longer than #kOwnerTimeout, another process takes over ownership and starts polling its own underlying source.
+    /// If the segment cannot be mapped or was created by an incompatible version of Xidi, states are read directly from the underlying source instead.
+    /// All methods are concurrency-safe.
+    class SharedXInput : public IXInput
+    {
+    public:
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Signature that identifies a shared controller segment. Spells "XIDP" when viewed as bytes in memory.
+        static constexpr uint32_t kSegmentSignature = 0x50444958;
+
+        /// Version of the shared controller segment layout. Incremented whenever the layout changes in any way.
+        static constexpr uint32_t kSegmentVersion = 1;
+
+        /// Name of the shared controller segment. Created in the session-local namespace so that no special privileges are needed to create it.
+        static constexpr std::wstring_view kSegmentName = L"Local\\Xidi.SharedControllers";
+
+        /// Number of XInput user indices held in the segment.
+        static constexpr DWORD kSlotCount = XUSER_MAX_COUNT;
+
+        /// Default amount of time, in nanoseconds, between successive reads of the underlying source by the owner.
+        static constexpr uint64_t kDefaultPollInterval = 4000000ull;
+
+        /// Amount of time, in nanoseconds, for which the owner may fail to update the segment before another process takes over ownership.
+        static constexpr uint64_t kOwnerTimeout = 500000000ull;
+
+
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Type used for all words in the segment that are accessed by more than one process.
+        /// Words are accessed without locks so they must be lock-free, which also makes them safe to access from another process.
+        typedef std::atomic<uint32_t> TWord;
+        static_assert(true == TWord::is_always_lock_free, "Shared controller segment words must be lock-free.");
+
+        /// Result code and state obtained by reading a single XInput user index.
+        struct SSlotValue
+        {
+            DWORD result;                                                   ///< XInput result code.
+            XINPUT_STATE state;                                             ///< XInput state.
+        };
+
+        /// Holds the most recent state of a single XInput user index.
+        /// Written by the owner and read by all processes using a sequence lock, so readers never wait for the writer and simply retry if they observe a write in progress.
+        /// Each slot occupies its own cache line so that writing one slot does not disturb readers of another.
+        struct alignas(64) SSlot
+        {
+            SequenceLocked<SSlotValue> value;                               ///< Result code and state, along with the generation number that guards them. Generation 0 means the slot has never been written.
+        };
+        static_assert(true == std::is_standard_layout_v<SSlot>, "Shared controller segment slots must have a fixed layout.");
+        static_assert((sizeof(uint32_t) + sizeof(SSlotValue)) == sizeof(SequenceLocked<SSlotValue>), "Shared controller segment slots must consist of a generation number followed by the result code and state.");
+
+        /// Layout of the shared controller segment.
+        /// Newly-created shared memory is zero-filled, and the layout is designed so that all zeroes represents a valid segment that has no owner and no data.
+        struct SSegment
+        {
+            TWord signature;                                                ///< Must be equal to #kSegmentSignature, or 0 if not yet claimed by any process.
+            TWord version;                                                  ///< Must be equal to #kSegmentVersion, or 0 if not yet claimed by any process.
+            TWord ownerProcessId;                                           ///< PID of the process that polls the underlying source on behalf of all processes, or 0 if there is no owner.
+            std::atomic<uint64_t> heartbeat;                                ///< Advanced by the owner every time it updates the slots, so that other processes can tell it is still alive.
+            SSlot slot[kSlotCount];                                         ///< Slots, indexed by XInput user index.
+        };
+        static_assert(true == std::atomic<uint64_t>::is_always_lock_free, "Shared controller segment heartbeat must be lock-free.");
+
+
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Shared memory object that maps the segment.
+        const std::unique_ptr<ISharedMemory> sharedMemory;
+
+        /// Underlying XInput source, which is read only while this process owns the segment or if the segment is unavailable.
+        const std::unique_ptr<IXInput> source;
+
+        /// PID of the current process, which identifies it as the owner of the segment.
+        const uint32_t kProcessId;
+
+        /// Clock used to measure how long the owner has gone without updating the segment.
+        const IClock& clock;
+
+        /// Mapped segment, or `nullptr` if it is unavailable.
+        SSegment* segment;
+
+        /// Whether or not this process currently owns the segment.
+        std::atomic<bool> owner;
+
+        /// Serializes updates, which either poll the underlying source or monitor the owner.
+        std::mutex updateMutex;
+
+        /// Most recent heartbeat value observed while monitoring the owner.
+        uint64_t observedHeartbeat;
+
+        /// Time, in nanoseconds, at which the heartbeat was last observed to change.
+        uint64_t observedHeartbeatTimestamp;
+
+        /// Background thread that invokes #Update periodically.
+        BackgroundWorker pollerWorker;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Maps the segment and takes ownership of it if no other process owns it. The background thread is not started until #Start is invoked.
+        /// @param [in] sharedMemory Shared memory object used to map the segment. Ownership is transferred and the segment remains mapped for the lifetime of this object.
+        /// @param [in] source Underlying XInput source. Ownership is transferred.
+        /// @param [in] processId PID of the current process. Must not be 0.
+        /// @param [in] segmentName Name of the segment to map.
+        /// @param [in] clock Clock used to measure how long the owner has gone without updating the segment.
+        SharedXInput(std::unique_ptr<ISharedMemory>&& sharedMemory, std::unique_ptr<IXInput>&& source, uint32_t processId, std::wstring_view segmentName = kSegmentName, const IClock& clock = SystemClock::GetInstance());
+
+        /// Copy constructor. Should never be invoked.
+        SharedXInput(const SharedXInput& other) = delete;
+
+        /// Default destructor.
+        /// Stops the background thread and gives up ownership of the segment, if this process owns it.
+        ~SharedXInput(void);
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Gives up ownership of the segment, if this process owns it, so that another process can take over immediately.
+        /// Caller must hold the update lock, unless the background thread has been abandoned.
+        void GiveUpOwnership(void);
+
+        /// Reads every XInput user index from the underlying source and writes the results to the segment.
+        /// Caller must hold the update lock and this process must own the segment.
+        void PollSourceLocked(void);
+
+        /// Entry point for the background thread.
+        /// @param [in] pollInterval Amount of time, in nanoseconds, between successive updates.
+        void PollerThreadMain(uint64_t pollInterval);
+
+        /// Attempts to take ownership of the segment away from the specified owner.
+        /// Caller must hold the update lock.
+        /// @param [in] expectedOwnerProcessId PID of the process believed to own the segment, or 0 if it is believed to have no owner.
+        /// @return `true` if this process now owns the segment, `false` if another process claimed it first.
+        bool TryTakeOwnershipLocked(uint32_t expectedOwnerProcessId);
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Abandons the background thread as the process terminates, without waiting for it or acquiring any locks, and gives up ownership of the segment.
+        /// Afterwards this object no longer synchronizes with the background thread, even as it is stopped or destroyed.
+        void Abandon(void);
+
+        /// Determines if this process currently owns the segment and is therefore responsible for polling the underlying source.
+        /// @return `true` if so, `false` otherwise.
+        inline bool IsOwner(void) const
+        {
+            return owner.load(std::memory_order_relaxed);
+        }
+
+        /// Determines if the background thread is running.
+        /// @return `true` if so, `false` otherwise.
+        bool IsRunning(void);
+
+        /// Determines if states are being shared with other processes through the segment.
+        /// @return `true` if so, `false` if the segment is unavailable and states are read directly from the underlying source.
+        inline bool IsShared(void) const
+        {
+            return (nullptr != segment);
+        }
+
+        /// Starts the background thread, which invokes #Update periodically. Has no effect if it is already running.
+        /// @param [in] pollInterval Amount of time, in nanoseconds, between successive updates.
+        void Start(uint64_t pollInterval = kDefaultPollInterval);
+
+        /// Stops the background thread, waits for it to exit, and gives up ownership of the segment so that another process can take over immediately.
+        /// Has no effect on the background thread if it is not running.
+        void Stop(void);
+
+        /// Performs a single update.
+        /// If this process owns the segment, reads the underlying source and writes the results to the segment.
+        /// Otherwise, checks whether the owner is still updating the segment and takes over ownership if it has exited or stopped for longer than #kOwnerTimeout.
+        /// Invoked periodically by the background thread, and can be invoked directly when the background thread is not running.
+        void Update(void);
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override;
+    };
+}
@@ -59,10 +59,26 @@ namespace Xidi
             struct SEvent
             {
                 SEventData data;                                            ///< Event data, including virtual controller element and updated value.
-                uint32_t timestamp;                                         ///< System time in milliseconds when the event was generated.
+                uint64_t timestamp;                                         ///< Time in nanoseconds at which the controller state that produced the event was captured. See #IClock for more information.
                 uint32_t sequence;                                          ///< Chronological sequence number of this event. Supposed to be globally monotonic with respect to all other input events, but in practice it is locally monotonic with respect to all virtual controller events.
+
+                /// Retrieves the timestamp of this event in milliseconds, which is the resolution DirectInput applications expect.
+                /// Per DirectInput documentation, it is acceptable for the resulting value to overflow every ~50 days.
+                /// @return Event timestamp in milliseconds.
+                inline uint32_t GetMillisecondTimestamp(void) const
+                {
+                    return (uint32_t)(timestamp / 1000000ull);
+                }
+            };
+            static_assert(sizeof(SEvent) <= 24, L"Data structure size constraint violation.");
+
+            /// Enumerates the policies that govern how events are stored and which events are discarded when the event buffer is full.
+            enum class EOverflowPolicy : uint8_t
+            {
+                DiscardOldest,                                              ///< Every event is stored separately, and on overflow the oldest event is discarded regardless of its type. This is standard DirectInput behavior and is the default.
+                CoalesceAxes,                                               ///< Axis events are merged with any pending event for the same axis that is not followed by a button or POV event, and on overflow the oldest axis event is discarded before any button or POV event.
+                Count                                                       ///< Sentinel value, total number of enumerators.
             };
-            static_assert(sizeof(SEvent) <= 16, L"Data structure size constraint violation.");
 
 
             // -------- CONSTANTS ------------------------------------------ //
@@ -83,18 +99,51 @@ namespace Xidi
             /// Cleared whenever events are retrieved such that the event buffer goes below capacity.
             bool eventBufferOverflowed;
 
+            /// Policy for storing events and discarding them when the event buffer is full.
+            EOverflowPolicy overflowPolicy;
+
+
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Attempts to merge an axis event into a pending event for the same axis, as per the axis coalescing policy.
+            /// Only the trailing run of axis events at the end of the buffer is searched, so that the relative order of axis events with respect to button and POV events is preserved.
+            /// The matching event, if any, is moved to the end of the buffer so that sequence numbers remain in chronological order.
+            /// @param [in] eventData Event data to merge. Must refer to an axis.
+            /// @param [in] timestamp Timestamp of the event to merge.
+            /// @param [in] sequence Sequence number of the event to merge.
+            /// @return `true` if the event was merged, `false` if no suitable pending event exists and so the event still needs to be appended.
+            bool CoalesceAxisEvent(SEventData eventData, uint64_t timestamp, uint32_t sequence);
+
+            /// Discards a single event according to the overflow policy, to make room for a newer event or to fit into a smaller capacity.
+            /// Event buffer must not be empty.
+            void DiscardEventForOverflow(void);
+
+            /// Handles a possible buffer overflow condition, discarding an event according to the overflow policy.
+            /// @return `true` if an event was discarded, `false` otherwise.
+            bool HandlePossibleOverflow(void);
+
 
         public:
             // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
 
             /// Default constructor.
             /// Constructs an empty event buffer with capacity of 0, which means this event buffer is disabled until it is enabled by request.
-            inline StateChangeEventBuffer(void) : eventBuffer(), eventBufferOverflowed()
+            inline StateChangeEventBuffer(void) : eventBuffer(), eventBufferOverflowed(), overflowPolicy(EOverflowPolicy::DiscardOldest)
             {
                 // Nothing to do here.
             }
 
 
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Reserves a block of consecutive sequence numbers for events that are about to be appended, possibly to several different event buffers.
+            /// All sequence numbers come from a single counter shared by every event buffer, so reserving the whole block at once keeps the events of a single state refresh together and in order while touching the shared counter only once.
+            /// Because blocks are handed out in the order they are requested, sequence numbers remain globally monotonic with respect to all virtual controller events.
+            /// @param [in] count Number of sequence numbers to reserve.
+            /// @return First sequence number in the reserved block. The block extends through `first + count - 1`.
+            static uint32_t ReserveSequenceNumbers(uint32_t count);
+
+
             // -------- OPERATORS ------------------------------------------ //
 
             /// Allows read-only access to events by index, without performing any bounds-checking.
@@ -109,12 +158,25 @@ namespace Xidi
 
             // -------- INSTANCE METHODS ----------------------------------- //
 
-            /// Appends a single event to the event buffer, given its data.
+            /// Appends a single event to the event buffer, given its data and a sequence number previously obtained using #ReserveSequenceNumbers.
+            /// Depending on the overflow policy, the event might instead be merged with an existing event.
+            /// @param [in] eventData Event data to append.
+            /// @param [in] timestamp Timestamp, in nanoseconds, to apply to the appended event.
+            /// @param [in] sequence Sequence number to apply to the appended event.
+            /// @return `true` if an older event had to be discarded to make room for the appended event, `false` otherwise.
+            bool AppendEvent(SEventData eventData, uint64_t timestamp, uint32_t sequence);
+
+            /// Appends a single event to the event buffer, given its data, and assigns it the next available sequence number.
+            /// Convenient when appending events one at a time. When appending several events at once it is more efficient to reserve their sequence numbers together.
             /// @param [in] eventData Event data to append.
-            /// @param [in] timestamp Timestamp to apply to the appended event.
-            void AppendEvent(SEventData eventData, uint32_t timestamp);
+            /// @param [in] timestamp Timestamp, in nanoseconds, to apply to the appended event.
+            /// @return `true` if an older event had to be discarded to make room for the appended event, `false` otherwise.
+            inline bool AppendEvent(SEventData eventData, uint64_t timestamp)
+            {
+                return AppendEvent(eventData, timestamp, ReserveSequenceNumbers(1));
+            }
 
-           /// Retrieves and returns the capacity of this event buffer.
+            /// Retrieves and returns the capacity of this event buffer.
             /// @return Event buffer capacity.
             inline uint32_t GetCapacity(void) const
             {
@@ -128,6 +190,13 @@ namespace Xidi
                 return (uint32_t)eventBuffer.size();
             }
 
+            /// Retrieves and returns the policy this event buffer uses for storing events and handling overflow.
+            /// @return Current overflow policy.
+            inline EOverflowPolicy GetOverflowPolicy(void) const
+            {
+                return overflowPolicy;
+            }
+
             /// Checks if this event buffer is enabled.
             /// @return `true` if the event buffer is enabled, `false` otherwise.
             inline bool IsEnabled(void) const
@@ -150,10 +219,18 @@ namespace Xidi
             /// Sets the capacity of this event buffer.
             /// Disables this event buffer if the specified capacity is equal to 0.
             /// Sets the capacity to #kEventBufferCapacityMax if the specified capacity is greater than this value.
-            /// If the specified capacity is less than the number of events currently in the event buffer, an overflow condition is triggered and the oldest excess events are discarded.
+            /// If the specified capacity is less than the number of events currently in the event buffer, an overflow condition is triggered and excess events are discarded one at a time according to the overflow policy, just as if they had overflowed the event buffer.
             /// Buffer always maintains one free space, so the actual number of events stored is one less than capacity. This is to be consistent with documentation for IDirectInputDevice8::GetDeviceData.
             /// @param [in] capacity Desired event buffer capacity.
             void SetCapacity(uint32_t capacity);
+
+            /// Sets the policy this event buffer uses for storing events and handling overflow.
+            /// Takes effect starting with the next event appended. Events already in the buffer are not modified.
+            /// @param [in] policy Desired overflow policy.
+            inline void SetOverflowPolicy(EOverflowPolicy policy)
+            {
+                overflowPolicy = policy;
+            }
         };
     }
 }
@@ -0,0 +1,200 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Statistics.h
+ *   Declaration of live statistics that are exported to a shared memory
+ *   segment so that an external monitor can observe them.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "SharedMemory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+namespace Xidi
+{
+    namespace Statistics
+    {
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Signature that identifies a statistics segment. Spells "XIDS" when viewed as bytes in memory.
+        inline constexpr uint32_t kSegmentSignature = 0x53444958;
+
+        /// Version of the statistics segment layout. Incremented whenever the layout changes in any way.
+        inline constexpr uint32_t kSegmentVersion = 2;
+
+        /// Number of virtual controllers for which per-controller statistics are kept.
+        inline constexpr uint32_t kControllerCount = XUSER_MAX_COUNT;
+
+
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Type used for all counters in the statistics segment.
+        /// Counters are updated without locks so they must be lock-free, which also makes them safe to read from another process.
+        typedef std::atomic<uint64_t> TCounter;
+        static_assert(true == TCounter::is_always_lock_free, "Statistics counters must be lock-free.");
+
+        /// Enumerates the application-facing API functions whose invocations are counted.
+        enum class EApiCall : uint32_t
+        {
+            DirectInputGetDeviceState,                                      ///< `IDirectInputDevice8::GetDeviceState`
+            DirectInputGetDeviceData,                                       ///< `IDirectInputDevice8::GetDeviceData`
+            WinMMJoyGetPosEx,                                               ///< `joyGetPosEx`
+            Count                                                           ///< Sentinel value, total number of enumerators
+        };
+
+        /// Enumerates the ways in which an application read of virtual controller state can relate to prefetching.
+        enum class EPrefetchOutcome : uint32_t
+        {
+            NotPredicted,                                                   ///< No prefetch was expected, either because the application's cadence is not yet known or because the read was not the first of its frame.
+            Hit,                                                            ///< The read was served by a prefetch.
+            Miss                                                            ///< A prefetch was expected but had not happened, so XInput was read on demand.
+        };
+
+        /// Counters that are kept separately for each virtual controller.
+        struct SControllerCounters
+        {
+            TCounter refreshCount;                                          ///< Number of times the virtual controller state was refreshed using data read from XInput.
+            TCounter xinputReadCount;                                       ///< Number of XInput state reads whose latency was measured.
+            TCounter xinputLatencyTotalNanoseconds;                         ///< Sum of the latencies of all measured XInput state reads, in nanoseconds.
+            TCounter xinputLatencyMaxNanoseconds;                           ///< Highest latency of any measured XInput state read, in nanoseconds.
+            TCounter eventsAppended;                                        ///< Number of events appended to the event buffer.
+            TCounter eventsDropped;                                         ///< Number of older events discarded from the event buffer to make room for newer ones.
+            TCounter lockContentions;                                       ///< Number of times a thread had to wait to acquire the virtual controller lock.
+            TCounter prefetchCount;                                         ///< Number of times the virtual controller state was read from XInput ahead of a predicted application read.
+            TCounter prefetchHits;                                          ///< Number of application reads that were served by a prefetch.
+            TCounter prefetchMisses;                                        ///< Number of application reads for which a prefetch was expected but had not happened.
+            TCounter stateReadCount;                                        ///< Number of application reads of the virtual controller state.
+            TCounter stateAgeTotalNanoseconds;                              ///< Sum, over all application reads, of the time between capturing the state and the application reading it, in nanoseconds.
+        };
+
+        /// Layout of the statistics segment.
+        /// All fields have fixed sizes and the segment begins with a header that identifies it, so readers built separately from Xidi can safely interpret the segment contents.
+        /// The signature is written last, once the rest of the header is valid, so a reader that observes a valid signature also observes a valid header.
+        struct SSegment
+        {
+            std::atomic<uint32_t> signature;                                ///< Must be equal to #kSegmentSignature.
+            uint32_t version;                                               ///< Must be equal to #kSegmentVersion.
+            uint32_t size;                                                  ///< Size of this structure, in bytes.
+            uint32_t processId;                                             ///< PID of the process that publishes the statistics.
+            TCounter apiCalls[(int)EApiCall::Count];                        ///< Number of invocations of each application-facing API function, indexed by #EApiCall.
+            SControllerCounters controller[kControllerCount];               ///< Per-controller counters, indexed by controller identifier.
+        };
+        static_assert(0 == (offsetof(SSegment, apiCalls) % sizeof(TCounter)), "Statistics counters must be naturally aligned.");
+
+        /// Plain copy of a single virtual controller's counters.
+        struct SControllerSnapshot
+        {
+            uint64_t refreshCount;                                          ///< See #SControllerCounters::refreshCount.
+            uint64_t xinputReadCount;                                       ///< See #SControllerCounters::xinputReadCount.
+            uint64_t xinputLatencyTotalNanoseconds;                         ///< See #SControllerCounters::xinputLatencyTotalNanoseconds.
+            uint64_t xinputLatencyMaxNanoseconds;                           ///< See #SControllerCounters::xinputLatencyMaxNanoseconds.
+            uint64_t eventsAppended;                                        ///< See #SControllerCounters::eventsAppended.
+            uint64_t eventsDropped;                                         ///< See #SControllerCounters::eventsDropped.
+            uint64_t lockContentions;                                       ///< See #SControllerCounters::lockContentions.
+            uint64_t prefetchCount;                                         ///< See #SControllerCounters::prefetchCount.
+            uint64_t prefetchHits;                                          ///< See #SControllerCounters::prefetchHits.
+            uint64_t prefetchMisses;                                        ///< See #SControllerCounters::prefetchMisses.
+            uint64_t stateReadCount;                                        ///< See #SControllerCounters::stateReadCount.
+            uint64_t stateAgeTotalNanoseconds;                              ///< See #SControllerCounters::stateAgeTotalNanoseconds.
+        };
+
+        /// Plain copy of all counters in the statistics segment, suitable for computing differences between samples.
+        /// Each counter is read atomically, but the counters are not read together as a single atomic operation.
+        struct SSnapshot
+        {
+            uint64_t apiCalls[(int)EApiCall::Count];                        ///< See #SSegment::apiCalls.
+            SControllerSnapshot controller[kControllerCount];               ///< See #SSegment::controller.
+        };
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+
+        /// Retrieves a human-readable name for the specified API function.
+        /// @param [in] apiCall API function identifier.
+        /// @return Name of the API function.
+        const wchar_t* ApiCallName(EApiCall apiCall);
+
+        /// Retrieves the statistics segment into which this process is recording statistics.
+        /// @return Pointer to the statistics segment, or `nullptr` if statistics are not being recorded.
+        const SSegment* GetPublishedSegment(void);
+
+        /// Creates the statistics segment and begins recording statistics into it.
+        /// Has no effect if statistics are already being recorded.
+        /// @param [in] sharedMemory Shared memory object used to create the segment. Ownership is transferred and the segment remains mapped for as long as statistics are being recorded.
+        /// @param [in] processId PID of the current process, which determines the name of the segment.
+        /// @return `true` if statistics are being recorded once this function returns, `false` otherwise.
+        bool Publish(std::unique_ptr<ISharedMemory>&& sharedMemory, uint32_t processId);
+
+        /// Takes a snapshot of the counters in a statistics segment.
+        /// @param [in] segment Statistics segment from which to read.
+        /// @return Snapshot of all counters.
+        SSnapshot ReadSnapshot(const SSegment& segment);
+
+        /// Records a single invocation of an application-facing API function.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] apiCall Identifier of the API function that was invoked.
+        void RecordApiCall(EApiCall apiCall);
+
+        /// Records events appended to a virtual controller's event buffer.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        /// @param [in] numAppended Number of events appended.
+        /// @param [in] numDropped Number of older events discarded to make room for the appended events.
+        void RecordEvents(uint32_t controllerId, uint32_t numAppended, uint32_t numDropped);
+
+        /// Records that a thread had to wait to acquire a virtual controller's lock.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        void RecordLockContention(uint32_t controllerId);
+
+        /// Records that a virtual controller's state was read from XInput ahead of a predicted application read.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        void RecordPrefetch(uint32_t controllerId);
+
+        /// Records an application read of a virtual controller's state.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        /// @param [in] ageNanoseconds Time between capturing the state and the application reading it, in nanoseconds.
+        /// @param [in] outcome How the read relates to prefetching.
+        void RecordStateRead(uint32_t controllerId, uint64_t ageNanoseconds, EPrefetchOutcome outcome);
+
+        /// Records a refresh of a virtual controller's state using data read from XInput.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        void RecordRefresh(uint32_t controllerId);
+
+        /// Records the latency of reading a virtual controller's state from XInput.
+        /// Has no effect if statistics are not being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        /// @param [in] latencyNanoseconds Time taken to read the state, in nanoseconds.
+        void RecordXInputRead(uint32_t controllerId, uint64_t latencyNanoseconds);
+
+        /// Generates the name of the statistics segment published by the specified process.
+        /// @param [in] processId PID of the process that publishes the statistics.
+        /// @return Name of the statistics segment.
+        std::wstring SegmentName(uint32_t processId);
+
+        /// Stops recording statistics and unmaps the statistics segment.
+        /// Intended for tests. Must not be called while any other thread might be recording statistics.
+        void Unpublish(void);
+
+        /// Determines if the specified memory contains a statistics segment that this version of Xidi understands.
+        /// @param [in] segment Pointer to the start of the memory to check.
+        /// @param [in] size Number of bytes of memory that are accessible.
+        /// @return Pointer to the statistics segment if it is valid, `nullptr` otherwise.
+        const SSegment* ValidateSegment(const void* segment, size_t size);
+    }
+}
@@ -49,6 +49,22 @@ namespace Xidi
         /// Base name of the WinMM library to import.
         inline constexpr std::wstring_view kStrLibraryNameWinMM = L"winmm.dll";
         
+        /// Configuration file section name for settings that control how the configuration file itself is handled.
+        inline constexpr std::wstring_view kStrConfigurationSectionConfiguration = L"Configuration";
+
+        /// Configuration file setting for specifying if the configuration file should be reloaded automatically whenever it is modified.
+        inline constexpr std::wstring_view kStrConfigurationSettingConfigurationHotReload = L"HotReload";
+
+        /// Configuration file section name for settings related to the local endpoint through which external tools query and tune virtual controllers.
+        inline constexpr std::wstring_view kStrConfigurationSectionControl = L"Control";
+
+        /// Configuration file setting for specifying if the local control endpoint should be created.
+        inline constexpr std::wstring_view kStrConfigurationSettingControlEnabled = L"Enabled";
+
+        /// Configuration file section name prefix for defining custom mappers. The rest of the section name is the name of the custom mapper.
+        /// Configuration settings in these sections are named after XInput controller elements, and their values describe the element mappers to use for them.
+        inline constexpr std::wstring_view kStrConfigurationSectionCustomMapperPrefix = L"CustomMapper:";
+
         /// Configuration file section name for overriding import libraries.
         inline constexpr std::wstring_view kStrConfigurationSectionImport = L"Import";
 
@@ -76,6 +92,45 @@ namespace Xidi
         /// Configuration file setting for specifying the mapper type.
         inline constexpr std::wstring_view kStrConfigurationSettingMapperType = L"Type";
 
+        /// Configuration file section name for settings related to profiling application calls into Xidi.
+        inline constexpr std::wstring_view kStrConfigurationSectionProfiler = L"Profiler";
+
+        /// Configuration file setting for specifying if application calls into Xidi should be profiled.
+        inline constexpr std::wstring_view kStrConfigurationSettingProfilerEnabled = L"Enabled";
+
+        /// Configuration file section name for settings related to reading controllers ahead of predicted application reads.
+        inline constexpr std::wstring_view kStrConfigurationSectionPrefetch = L"Prefetch";
+
+        /// Configuration file setting for specifying if controllers should be read ahead of predicted application reads.
+        inline constexpr std::wstring_view kStrConfigurationSettingPrefetchEnabled = L"Enabled";
+
+        /// Configuration file setting for specifying how far ahead of a predicted application read, in microseconds, controllers should be read.
+        inline constexpr std::wstring_view kStrConfigurationSettingPrefetchLeadTimeMicroseconds = L"LeadTimeMicroseconds";
+
+        /// Configuration file section name for settings related to sharing a single controller poller among all processes that load Xidi.
+        inline constexpr std::wstring_view kStrConfigurationSectionSharedControllers = L"SharedControllers";
+
+        /// Configuration file setting for specifying if controller states should be polled once and shared among all processes that load Xidi.
+        inline constexpr std::wstring_view kStrConfigurationSettingSharedControllersEnabled = L"Enabled";
+
+        /// Configuration file setting for specifying how often, in microseconds, the process that polls on behalf of all others reads XInput.
+        inline constexpr std::wstring_view kStrConfigurationSettingSharedControllersPollIntervalMicroseconds = L"PollIntervalMicroseconds";
+
+        /// Configuration file section name for settings that adjust the default properties of virtual controllers.
+        inline constexpr std::wstring_view kStrConfigurationSectionProperties = L"Properties";
+
+        /// Configuration file setting for specifying if buffered axis events should be coalesced so that button and POV events survive event buffer overflow.
+        inline constexpr std::wstring_view kStrConfigurationSettingPropertiesCoalesceAxisEvents = L"CoalesceAxisEvents";
+
+        /// Configuration file setting for specifying the default hysteresis band applied to all virtual controller axes.
+        inline constexpr std::wstring_view kStrConfigurationSettingPropertiesAxisHysteresis = L"AxisHysteresis";
+
+        /// Configuration file section name for settings related to exporting live statistics.
+        inline constexpr std::wstring_view kStrConfigurationSectionStatistics = L"Statistics";
+
+        /// Configuration file setting for specifying if live statistics should be exported to shared memory for an external monitor.
+        inline constexpr std::wstring_view kStrConfigurationSettingStatisticsEnabled = L"Enabled";
+
 
         // -------- RUN-TIME CONSTANTS ------------------------------------- //
         // Not safe to access before run-time, and should not be used to perform dynamic initialization.
@@ -118,6 +173,10 @@ namespace Xidi
         /// Xidi log filename = (current user's desktop)\Xidi_(Xidi Version)_(base name of the running executable)_(process ID).log
         extern const std::wstring_view kStrLogFilename;
 
+        /// Expected filename for the cache of information about the devices WinMM makes available.
+        /// Xidi system device cache filename = (current user's temporary directory)\Xidi_SystemDevices.cache
+        extern const std::wstring_view kStrSystemDeviceCacheFilename;
+
 
         // -------- FUNCTIONS ---------------------------------------------- //
 
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SystemDeviceCache.h
+ *   Declaration of the persistent cache of information about the devices
+ *   that WinMM makes available, which avoids probing every device for XInput
+ *   support each time an application starts.
+ *****************************************************************************/
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace SystemDeviceCache
+    {
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Information about all devices WinMM makes available, indexed by WinMM device index.
+        /// String specifies the device identifier (vendor ID and product ID string), which is empty if no device is present at that index. Bool value specifies whether the device supports XInput.
+        typedef std::vector<std::pair<std::wstring, bool>> TDeviceList;
+
+
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Version of the cache file format. Cache files written using any other version are ignored.
+        inline constexpr unsigned int kFormatVersion = 1;
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+
+        /// Copies XInput support information from cached device information into information about the devices currently present.
+        /// Cached information is used only if it describes exactly the same devices at exactly the same indices, which is what identifies a change in hardware.
+        /// @param [in] cachedDevices Device information previously loaded from the cache.
+        /// @param [in,out] presentDevices Information about the devices currently present, whose XInput support information is filled in on success.
+        /// @return `true` if the cached information matches the devices currently present and was copied, `false` otherwise.
+        bool ApplyIfMatching(const TDeviceList& cachedDevices, TDeviceList& presentDevices);
+
+        /// Reads device information from a cache file.
+        /// @param [in] filename Complete path and filename of the cache file.
+        /// @return Device information, or nothing if the file does not exist, is malformed, or uses a different format version.
+        std::optional<TDeviceList> Load(std::wstring_view filename);
+
+        /// Parses the contents of a cache file.
+        /// @param [in] contents Complete contents of the cache file.
+        /// @return Device information, or nothing if the contents are malformed or use a different format version.
+        std::optional<TDeviceList> Parse(std::string_view contents);
+
+        /// Writes device information to a cache file, replacing any previous contents.
+        /// The file is written under a temporary name and then renamed, so a concurrent reader never observes a partially-written cache.
+        /// @param [in] filename Complete path and filename of the cache file.
+        /// @param [in] devices Device information to write.
+        /// @return `true` if the cache file was written, `false` otherwise.
+        bool Save(std::wstring_view filename, const TDeviceList& devices);
+
+        /// Generates the contents of a cache file.
+        /// Device identifiers must consist of printable ASCII characters other than space, which is always the case for vendor ID and product ID strings.
+        /// @param [in] devices Device information to represent.
+        /// @return Cache file contents, or nothing if any device identifier cannot be represented.
+        std::optional<std::string> Serialize(const TDeviceList& devices);
+    }
+}
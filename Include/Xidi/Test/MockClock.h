@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MockClock.h
+ *   Mock clock interface that can be used for tests.
+ *****************************************************************************/
+
+#pragma once
+
+#include "Clock.h"
+
+#include <cstdint>
+
+
+namespace XidiTest
+{
+    /// Mock version of the clock interface, used for test purposes to make timestamps fully predictable.
+    /// Time stands still unless the test explicitly moves it.
+    class MockClock : public Xidi::IClock
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Current time, in nanoseconds.
+        uint64_t timestamp;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// @param [in] timestamp Starting time, in nanoseconds.
+        inline MockClock(uint64_t timestamp = 0) : timestamp(timestamp)
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Moves the current time forward.
+        /// @param [in] nanoseconds Amount of time by which to move forward, in nanoseconds.
+        inline void Advance(uint64_t nanoseconds)
+        {
+            timestamp += nanoseconds;
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        uint64_t GetTimestamp(void) const override
+        {
+            return timestamp;
+        }
+    };
+}
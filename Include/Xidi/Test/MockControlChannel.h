@@ -0,0 +1,190 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MockControlChannel.h
+ *   Mock control connection and listener interfaces that can be used for
+ *   tests, connecting clients to the listener entirely in-process.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ControlChannel.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+
+namespace XidiTest
+{
+    /// State shared by both ends of an in-process connection, which holds the lines travelling in each direction.
+    class MockControlLoopback
+    {
+    public:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Lines written by the client and not yet read by the server.
+        std::deque<std::string> toServer;
+
+        /// Lines written by the server and not yet read by the client.
+        std::deque<std::string> toClient;
+
+        /// Whether either end has closed the connection.
+        bool closed = false;
+
+        /// Serializes access to the lines and the closed flag.
+        std::mutex loopbackMutex;
+
+        /// Wakes readers when a line arrives or the connection is closed.
+        std::condition_variable loopbackCondition;
+    };
+
+    /// Mock version of the control connection interface, used for test purposes to stand in for one end of a local connection.
+    /// Reads lines written by the other end and writes lines for the other end to read.
+    class MockControlConnection : public Xidi::IControlConnection
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// State shared by both ends of the connection.
+        const std::shared_ptr<MockControlLoopback> loopback;
+
+        /// Specifies if this is the server end of the connection, as opposed to the client end.
+        const bool kIsServer;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// @param [in] loopback State shared by both ends of the connection.
+        /// @param [in] isServer Specifies if this is the server end of the connection.
+        inline MockControlConnection(std::shared_ptr<MockControlLoopback> loopback, bool isServer) : loopback(loopback), kIsServer(isServer)
+        {
+            // Nothing to do here.
+        }
+
+        /// Default destructor. Closes the connection, just as a real connection is closed when either end goes away.
+        ~MockControlConnection(void) override
+        {
+            Close();
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void Close(void) override
+        {
+            std::scoped_lock lock(loopback->loopbackMutex);
+            loopback->closed = true;
+            loopback->loopbackCondition.notify_all();
+        }
+
+        // --------
+
+        bool ReadLine(std::string& line) override
+        {
+            std::unique_lock lock(loopback->loopbackMutex);
+            std::deque<std::string>& inbound = ((true == kIsServer) ? loopback->toServer : loopback->toClient);
+
+            loopback->loopbackCondition.wait(lock, [this, &inbound]() -> bool { return ((false == inbound.empty()) || (true == loopback->closed)); });
+            if (true == inbound.empty())
+                return false;
+
+            line = std::move(inbound.front());
+            inbound.pop_front();
+            return true;
+        }
+
+        // --------
+
+        bool WriteLine(std::string_view line) override
+        {
+            std::scoped_lock lock(loopback->loopbackMutex);
+            if (true == loopback->closed)
+                return false;
+
+            ((true == kIsServer) ? loopback->toClient : loopback->toServer).emplace_back(line);
+            loopback->loopbackCondition.notify_all();
+            return true;
+        }
+    };
+
+    /// Mock version of the control listener interface, used for test purposes to stand in for a named pipe or UNIX domain socket.
+    /// Clients connect by invoking #Connect, which makes the server end of the new connection available to #Accept.
+    class MockControlListener : public Xidi::IControlListener
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Server ends of connections that have not yet been accepted.
+        std::deque<std::unique_ptr<Xidi::IControlConnection>> pendingConnections;
+
+        /// Whether the listener has been closed.
+        bool closed = false;
+
+        /// Serializes access to the pending connections and the closed flag.
+        std::mutex listenerMutex;
+
+        /// Wakes #Accept when a client connects or the listener is closed.
+        std::condition_variable listenerCondition;
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Connects a new client.
+        /// @return Client end of the new connection, or `nullptr` if the listener has been closed.
+        std::unique_ptr<Xidi::IControlConnection> Connect(void)
+        {
+            std::scoped_lock lock(listenerMutex);
+            if (true == closed)
+                return nullptr;
+
+            std::shared_ptr<MockControlLoopback> loopback = std::make_shared<MockControlLoopback>();
+            pendingConnections.push_back(std::make_unique<MockControlConnection>(loopback, true));
+            listenerCondition.notify_all();
+
+            return std::make_unique<MockControlConnection>(loopback, false);
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void Abandon(void) override
+        {
+            // There are no platform resources to release, and tests never abandon a listener after the process has exited its other threads, so abandoning is the same as closing.
+            Close();
+        }
+
+        // --------
+
+        std::unique_ptr<Xidi::IControlConnection> Accept(void) override
+        {
+            std::unique_lock lock(listenerMutex);
+            listenerCondition.wait(lock, [this]() -> bool { return ((false == pendingConnections.empty()) || (true == closed)); });
+            if (true == closed)
+                return nullptr;
+
+            std::unique_ptr<Xidi::IControlConnection> connection = std::move(pendingConnections.front());
+            pendingConnections.pop_front();
+            return connection;
+        }
+
+        // --------
+
+        void Close(void) override
+        {
+            std::scoped_lock lock(listenerMutex);
+            closed = true;
+            listenerCondition.notify_all();
+        }
+    };
+}
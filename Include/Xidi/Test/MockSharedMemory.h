@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MockSharedMemory.h
+ *   Mock shared memory interface that can be used for tests.
+ *****************************************************************************/
+
+#pragma once
+
+#include "SharedMemory.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+
+namespace XidiTest
+{
+    /// Mock version of the shared memory interface, used for test purposes to stand in for named memory regions shared between processes.
+    /// Memory regions are ordinary heap allocations kept in a table that all mock objects share, so two mock objects that use the same name see the same memory, just as two processes would.
+    /// Memory regions are never freed, which means pointers remain valid for the rest of the test run.
+    class MockSharedMemory : public Xidi::ISharedMemory
+    {
+    private:
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Single memory region.
+        struct SRegion
+        {
+            std::unique_ptr<std::byte[]> buffer;                            ///< Contents of the memory region.
+            size_t size;                                                    ///< Size of the memory region, in bytes.
+        };
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+
+        /// Retrieves the mutex that guards the table of memory regions.
+        /// @return Mutex reference.
+        static inline std::mutex& RegionsMutex(void)
+        {
+            static std::mutex regionsMutex;
+            return regionsMutex;
+        }
+
+        /// Retrieves the table of memory regions, keyed by name.
+        /// @return Memory region table reference.
+        static inline std::map<std::wstring, SRegion, std::less<>>& Regions(void)
+        {
+            static std::map<std::wstring, SRegion, std::less<>> regions;
+            return regions;
+        }
+
+
+    public:
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void* Create(std::wstring_view name, size_t size) override
+        {
+            std::scoped_lock lock(RegionsMutex());
+
+            auto regionIter = Regions().find(name);
+            if (Regions().end() == regionIter)
+            {
+                // Like real shared memory, newly-created memory regions are zero-filled.
+                regionIter = Regions().emplace(std::wstring(name), SRegion({.buffer = std::make_unique<std::byte[]>(size), .size = size})).first;
+            }
+            else if (regionIter->second.size < size)
+            {
+                return nullptr;
+            }
+
+            return regionIter->second.buffer.get();
+        }
+
+        // --------
+
+        const void* Open(std::wstring_view name, size_t size) override
+        {
+            std::scoped_lock lock(RegionsMutex());
+
+            const auto regionIter = Regions().find(name);
+            if ((Regions().end() == regionIter) || (regionIter->second.size < size))
+                return nullptr;
+
+            return regionIter->second.buffer.get();
+        }
+    };
+}
@@ -11,7 +11,7 @@
 
 #pragma once
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
 #include "TestCase.h"
 #include "XInputInterface.h"
 
@@ -32,8 +32,8 @@ namespace XidiTest
         template <typename OutputObjectType> struct SMethodCallSpec
         {
             DWORD returnCode;                                               ///< Desired return code.
-            std::optional<OutputObjectType> maybeOutputObject;              ///< Desired output object. If absent, no object is copied to the output parameter.
-            int repeatTimes;                                                ///< Number of times the call should be repeated before it is removed. Zero means the call should happen exactly once.
+            std::optional<OutputObjectType> maybeOutputObject = std::nullopt; ///< Desired output object. If absent, no object is copied to the output parameter.
+            int repeatTimes = 0;                                            ///< Number of times the call should be repeated before it is removed. Zero means the call should happen exactly once.
         };
 
 
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MockXInputSource.h
+ *   Mock XInput interface that serves several user indices from a table of
+ *   states, which can be used for tests.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "TestCase.h"
+#include "XInputInterface.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+
+namespace XidiTest
+{
+    /// Mock version of an XInput source, used for test purposes to stand in for a source of any number of user indices.
+    /// Unlike #MockXInput, it expects no particular sequence of calls. Instead it reports whatever state the test most recently placed in the table for the requested user index, and counts how many times each user index is read.
+    /// Packet numbers identify each read. Without a tag, the packet number is the number of times the user index has been read, so every read reports a new packet and consumers never discard it as a duplicate.
+    /// With a tag, the packet number is the tag multiplied by 1000 plus the user index, so tests that combine several sources can tell exactly which source and user index served a read.
+    /// Read counts are concurrency-safe, so tests can check them while a background thread reads from the source. States should only be modified while nothing is reading them.
+    class MockXInputSource : public Xidi::IXInput
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Number of user indices this source supports.
+        const DWORD kUserIndexCount;
+
+        /// Tag that identifies this source in the packet number of every state it reports, if any.
+        const std::optional<DWORD> kTag;
+
+        /// Result to report for each user index.
+        std::unique_ptr<DWORD[]> slotResult;
+
+        /// State to report for each user index, apart from the packet number.
+        std::unique_ptr<XINPUT_STATE[]> slotState;
+
+        /// Number of times each user index has been read.
+        std::unique_ptr<std::atomic<unsigned int>[]> slotReadCount;
+
+        /// Number of times any user index has been read.
+        std::atomic<unsigned int> readCount;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Every user index initially reports success along with a neutral state.
+        /// @param [in] userIndexCount Number of user indices this source supports. Reading any other user index causes a test failure.
+        /// @param [in] tag Tag that identifies this source in the packet number of every state it reports, if any.
+        inline MockXInputSource(DWORD userIndexCount = XUSER_MAX_COUNT, std::optional<DWORD> tag = std::nullopt) : kUserIndexCount(userIndexCount), kTag(tag), slotResult(std::make_unique<DWORD[]>(userIndexCount)), slotState(std::make_unique<XINPUT_STATE[]>(userIndexCount)), slotReadCount(std::make_unique<std::atomic<unsigned int>[]>(userIndexCount)), readCount(0)
+        {
+            // Nothing to do here.
+        }
+
+        /// Copy constructor. Should never be invoked.
+        MockXInputSource(const MockXInputSource& other) = delete;
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Retrieves the number of times any user index has been read.
+        /// @return Total number of reads.
+        inline unsigned int GetReadCount(void) const
+        {
+            return readCount.load();
+        }
+
+        /// Retrieves the number of times the specified user index has been read.
+        /// @param [in] userIndex User index of interest.
+        /// @return Number of reads of that user index.
+        inline unsigned int GetReadCount(DWORD userIndex) const
+        {
+            return slotReadCount[userIndex].load();
+        }
+
+        /// Modifies the state reported for all user indices.
+        /// @param [in] state State to report. Its packet number is ignored.
+        inline void SetAllStates(const XINPUT_STATE& state)
+        {
+            for (DWORD i = 0; i < kUserIndexCount; ++i)
+                slotState[i] = state;
+        }
+
+        /// Modifies the result reported for the specified user index.
+        /// @param [in] userIndex User index whose result is to be modified.
+        /// @param [in] result Result to report, such as `ERROR_DEVICE_NOT_CONNECTED` to simulate a disconnected controller.
+        inline void SetResult(DWORD userIndex, DWORD result)
+        {
+            slotResult[userIndex] = result;
+        }
+
+        /// Modifies the state reported for the specified user index.
+        /// @param [in] userIndex User index whose state is to be modified.
+        /// @param [in] state State to report. Its packet number is ignored.
+        inline void SetState(DWORD userIndex, const XINPUT_STATE& state)
+        {
+            slotState[userIndex] = state;
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override
+        {
+            if (dwUserIndex >= kUserIndexCount)
+                TEST_FAILED_BECAUSE(L"XInputGetState: User index too large (%u versus maximum %u).", dwUserIndex, kUserIndexCount);
+
+            readCount += 1;
+            const unsigned int kSlotReadCount = ++slotReadCount[dwUserIndex];
+
+            *pState = slotState[dwUserIndex];
+            pState->dwPacketNumber = ((true == kTag.has_value()) ? ((*kTag * 1000) + dwUserIndex) : kSlotReadCount);
+            return slotResult[dwUserIndex];
+        }
+    };
+}
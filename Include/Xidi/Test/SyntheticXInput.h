@@ -0,0 +1,306 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SyntheticXInput.h
+ *   Synthetic XInput interface that generates parameterized controller load
+ *   for stress tests and benchmarks.
+ *****************************************************************************/
+
+#pragma once
+
+#include "ApiXInput.h"
+#include "XInputInterface.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+
+namespace XidiTest
+{
+    /// Synthetic version of the XInput interface, used for stress tests and benchmarks to provide a continuous stream of changing XInput data to a virtual controller.
+    /// Unlike the mock version, no expectations are set up ahead of time. Instead, a load profile describes how controller state evolves over time.
+    /// Output is fully determined by the load profile, including the seed, and by the number of packet changes generated so far.
+    /// All methods are concurrency-safe.
+    class SyntheticXInput : public Xidi::IXInput
+    {
+    public:
+        // -------- TYPE DEFINITIONS --------------------------------------- //
+
+        /// Enumerates the supported patterns for generating digital button states.
+        enum class EButtonPattern : uint8_t
+        {
+            None,                                                           ///< No buttons are ever pressed.
+            Alternating,                                                    ///< Two disjoint sets of buttons are pressed on alternating packets.
+            RandomMash,                                                     ///< Each packet presses a random subset of all buttons.
+            Chord,                                                          ///< Buttons are pressed one at a time, accumulating until all are held, and then all are released.
+        };
+
+        /// Describes the synthetic load to be generated.
+        struct SLoadProfile
+        {
+            uint16_t stickStepMax;                                          ///< Maximum displacement of each analog stick axis per generated packet. Axes follow a random walk that reflects off the edges of the range. Zero leaves the sticks centered.
+            uint8_t triggerSweepStep;                                       ///< Change in trigger value per generated packet. Triggers sweep back and forth across their range in opposite phase. Zero leaves the triggers released.
+            EButtonPattern buttonPattern;                                   ///< Pattern to use for generating button states.
+            uint32_t packetChangesPerSecond;                                ///< Target rate at which new packets are generated, measured in wall-clock time. Zero means every call produces a new packet.
+            uint32_t disconnectIntervalCalls;                               ///< Length, in number of calls, of a disconnect storm cycle. Zero disables disconnect storms.
+            uint32_t disconnectDurationCalls;                               ///< Number of calls at the start of each disconnect storm cycle during which the controller reports that it is not connected.
+            uint64_t seed;                                                  ///< Random number generator seed. Must be non-zero.
+        };
+
+        /// Counters that describe the load generated so far.
+        struct SStatistics
+        {
+            uint64_t numCalls;                                              ///< Total number of calls to #GetState.
+            uint64_t numPacketsGenerated;                                   ///< Number of distinct packets generated.
+            uint64_t numDisconnectedCalls;                                  ///< Number of calls that reported the controller as disconnected.
+            uint64_t numReconnects;                                         ///< Number of transitions from disconnected back to connected.
+        };
+
+
+        // -------- CONSTANTS ---------------------------------------------- //
+
+        /// Default load profile. Produces moderate analog and digital traffic at a rate comparable to a real controller being actively used, without any disconnects.
+        static constexpr SLoadProfile kDefaultLoadProfile = {
+            .stickStepMax = 512,
+            .triggerSweepStep = 8,
+            .buttonPattern = EButtonPattern::Alternating,
+            .packetChangesPerSecond = 1000,
+            .disconnectIntervalCalls = 0,
+            .disconnectDurationCalls = 0,
+            .seed = 0x2545f4914f6cdd1dull
+        };
+
+
+    private:
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Button mask of all buttons that physically exist on an XInput controller.
+        static constexpr WORD kAllButtons = (XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT | XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_LEFT_THUMB | XINPUT_GAMEPAD_RIGHT_THUMB | XINPUT_GAMEPAD_LEFT_SHOULDER | XINPUT_GAMEPAD_RIGHT_SHOULDER | XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B | XINPUT_GAMEPAD_X | XINPUT_GAMEPAD_Y);
+
+        /// First set of buttons used by the alternating button pattern.
+        static constexpr WORD kAlternatingButtonsFirst = (XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_X | XINPUT_GAMEPAD_LEFT_SHOULDER | XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_DPAD_UP);
+
+        /// Second set of buttons used by the alternating button pattern.
+        static constexpr WORD kAlternatingButtonsSecond = (XINPUT_GAMEPAD_B | XINPUT_GAMEPAD_Y | XINPUT_GAMEPAD_RIGHT_SHOULDER | XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_DPAD_DOWN);
+
+
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Load profile that describes the synthetic load to generate.
+        const SLoadProfile kLoadProfile;
+
+        /// Time at which this object was created, used as the time base for rate-limited packet generation.
+        const std::chrono::steady_clock::time_point kStartTime;
+
+        /// Serializes access to the generator state.
+        std::mutex generatorMutex;
+
+        /// Random number generator state, using the xorshift64 algorithm.
+        uint64_t randomState;
+
+        /// Packet generation epoch that corresponds to the current controller state. Only used when packet generation is rate-limited.
+        uint64_t currentEpoch;
+
+        /// Direction in which the triggers are currently sweeping. `true` means the left trigger is rising and the right trigger is falling.
+        bool triggerSweepRising;
+
+        /// Whether or not the last call reported the controller as disconnected.
+        bool isDisconnected;
+
+        /// Current synthetic controller state.
+        XINPUT_STATE currentState;
+
+        /// Total number of calls to #GetState.
+        std::atomic<uint64_t> numCalls;
+
+        /// Number of distinct packets generated.
+        std::atomic<uint64_t> numPacketsGenerated;
+
+        /// Number of calls that reported the controller as disconnected.
+        std::atomic<uint64_t> numDisconnectedCalls;
+
+        /// Number of transitions from disconnected back to connected.
+        std::atomic<uint64_t> numReconnects;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Optionally accepts a load profile, otherwise uses the default.
+        inline SyntheticXInput(const SLoadProfile& loadProfile = kDefaultLoadProfile) : kLoadProfile(loadProfile), kStartTime(std::chrono::steady_clock::now()), generatorMutex(), randomState((0 == loadProfile.seed) ? kDefaultLoadProfile.seed : loadProfile.seed), currentEpoch(0), triggerSweepRising(true), isDisconnected(false), currentState(), numCalls(0), numPacketsGenerated(0), numDisconnectedCalls(0), numReconnects(0)
+        {
+            // Nothing to do here.
+        }
+
+
+    private:
+        // -------- CLASS METHODS ------------------------------------------ //
+
+        /// Moves a single analog stick axis by the specified displacement, reflecting off the edges of the range.
+        /// @param [in,out] axisValue Axis value to update.
+        /// @param [in] displacement Amount by which to move the axis.
+        static inline void RandomWalkAxis(SHORT& axisValue, int32_t displacement)
+        {
+            int32_t newAxisValue = (int32_t)axisValue + displacement;
+
+            if (newAxisValue > SHRT_MAX)
+                newAxisValue = SHRT_MAX - (newAxisValue - SHRT_MAX);
+            else if (newAxisValue < SHRT_MIN)
+                newAxisValue = SHRT_MIN - (newAxisValue - SHRT_MIN);
+
+            axisValue = (SHORT)newAxisValue;
+        }
+
+
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Advances the generator state by one packet.
+        /// Caller must hold the generator lock.
+        void GenerateNextPacket(void)
+        {
+            XINPUT_GAMEPAD& gamepad = currentState.Gamepad;
+
+            if (0 != kLoadProfile.stickStepMax)
+            {
+                const int32_t kStepRange = (2 * (int32_t)kLoadProfile.stickStepMax) + 1;
+
+                RandomWalkAxis(gamepad.sThumbLX, (int32_t)(NextRandom() % kStepRange) - (int32_t)kLoadProfile.stickStepMax);
+                RandomWalkAxis(gamepad.sThumbLY, (int32_t)(NextRandom() % kStepRange) - (int32_t)kLoadProfile.stickStepMax);
+                RandomWalkAxis(gamepad.sThumbRX, (int32_t)(NextRandom() % kStepRange) - (int32_t)kLoadProfile.stickStepMax);
+                RandomWalkAxis(gamepad.sThumbRY, (int32_t)(NextRandom() % kStepRange) - (int32_t)kLoadProfile.stickStepMax);
+            }
+
+            if (0 != kLoadProfile.triggerSweepStep)
+            {
+                const int kNextLeftTrigger = (int)gamepad.bLeftTrigger + ((true == triggerSweepRising) ? (int)kLoadProfile.triggerSweepStep : -(int)kLoadProfile.triggerSweepStep);
+
+                if (kNextLeftTrigger >= UINT8_MAX)
+                {
+                    gamepad.bLeftTrigger = UINT8_MAX;
+                    triggerSweepRising = false;
+                }
+                else if (kNextLeftTrigger <= 0)
+                {
+                    gamepad.bLeftTrigger = 0;
+                    triggerSweepRising = true;
+                }
+                else
+                {
+                    gamepad.bLeftTrigger = (BYTE)kNextLeftTrigger;
+                }
+
+                gamepad.bRightTrigger = UINT8_MAX - gamepad.bLeftTrigger;
+            }
+
+            switch (kLoadProfile.buttonPattern)
+            {
+            case EButtonPattern::Alternating:
+                gamepad.wButtons = ((kAlternatingButtonsFirst == gamepad.wButtons) ? kAlternatingButtonsSecond : kAlternatingButtonsFirst);
+                break;
+
+            case EButtonPattern::RandomMash:
+                gamepad.wButtons = (WORD)(NextRandom() & kAllButtons);
+                break;
+
+            case EButtonPattern::Chord:
+                if (kAllButtons == gamepad.wButtons)
+                {
+                    gamepad.wButtons = 0;
+                }
+                else
+                {
+                    // Press the lowest-order button that is not already pressed.
+                    const WORD kNotPressed = (kAllButtons & ~gamepad.wButtons);
+                    gamepad.wButtons |= (kNotPressed & (WORD)(~kNotPressed + 1));
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            currentState.dwPacketNumber += 1;
+            numPacketsGenerated += 1;
+        }
+
+        /// Determines if a new packet should be generated on this call, based on the configured packet change rate.
+        /// Caller must hold the generator lock.
+        /// @return `true` if a new packet should be generated, `false` otherwise.
+        bool IsPacketChangeDue(void)
+        {
+            if (0 == kLoadProfile.packetChangesPerSecond)
+                return true;
+
+            const double kElapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - kStartTime).count();
+            const uint64_t kEpoch = (uint64_t)(kElapsedSeconds * (double)kLoadProfile.packetChangesPerSecond);
+
+            if (kEpoch == currentEpoch)
+                return false;
+
+            currentEpoch = kEpoch;
+            return true;
+        }
+
+        /// Generates the next pseudo-random number using the xorshift64 algorithm.
+        /// Caller must hold the generator lock.
+        /// @return Next pseudo-random number.
+        inline uint64_t NextRandom(void)
+        {
+            randomState ^= (randomState << 13);
+            randomState ^= (randomState >> 7);
+            randomState ^= (randomState << 17);
+            return randomState;
+        }
+
+
+    public:
+        // -------- INSTANCE METHODS --------------------------------------- //
+
+        /// Retrieves a snapshot of the counters that describe the load generated so far.
+        /// @return Counter snapshot.
+        inline SStatistics GetStatistics(void) const
+        {
+            return {.numCalls = numCalls, .numPacketsGenerated = numPacketsGenerated, .numDisconnectedCalls = numDisconnectedCalls, .numReconnects = numReconnects};
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override
+        {
+            if (dwUserIndex >= XUSER_MAX_COUNT)
+                return ERROR_BAD_ARGUMENTS;
+
+            std::scoped_lock lock(generatorMutex);
+            const uint64_t kCallIndex = numCalls++;
+
+            if (0 != kLoadProfile.disconnectIntervalCalls)
+            {
+                if ((kCallIndex % kLoadProfile.disconnectIntervalCalls) < kLoadProfile.disconnectDurationCalls)
+                {
+                    isDisconnected = true;
+                    numDisconnectedCalls += 1;
+                    return ERROR_DEVICE_NOT_CONNECTED;
+                }
+                else if (true == isDisconnected)
+                {
+                    isDisconnected = false;
+                    numReconnects += 1;
+                }
+            }
+
+            if (true == IsPacketChangeDue())
+                GenerateNextPacket();
+
+            *pState = currentState;
+            return ERROR_SUCCESS;
+        }
+    };
+}
@@ -78,7 +78,7 @@ namespace XidiTest
 #define TEST_FAILED_BECAUSE(reasonf, ...)   do {PrintFormatted(reasonf, ##__VA_ARGS__); TEST_FAILED;} while (0)
 
 /// Exit from a test case and indicate a failing result if the expression is false.
-#define TEST_ASSERT(expr)                   do {if (!(expr)) {PrintFormatted(L"%s:%d: Assertion failed: %s", __FILEW__, __LINE__, L#expr); TEST_FAILED;}} while (0)
+#define TEST_ASSERT(expr)                   do {if (!(expr)) {PrintFormatted(L"%ls:%d: Assertion failed: %ls", __FILEW__, __LINE__, _CRT_WIDE(#expr)); TEST_FAILED;}} while (0)
 
 /// Recommended way of creating test cases that execute conditionally.
 /// Requires a test case name and a condition, which evaluates to a value of type bool.
@@ -86,10 +86,11 @@ namespace XidiTest
 /// Automatically instantiates the proper test case object and registers it with the harness.
 /// Treat this macro as a function declaration; the test case is the function body.
 #define TEST_CASE_CONDITIONAL(name, cond) \
-    inline constexpr wchar_t kTestName__##name[] = L#name; \
+    inline constexpr wchar_t kTestName__##name[] = _CRT_WIDE(#name); \
+    template <> bool XidiTest::TestCase<kTestName__##name>::CanRun(void) const { return (cond); } \
+    template <> void XidiTest::TestCase<kTestName__##name>::Run(void) const; \
     XidiTest::TestCase<kTestName__##name>  testCaseInstance__##name; \
-    bool XidiTest::TestCase<kTestName__##name>::CanRun(void) const { return (cond); } \
-    void XidiTest::TestCase<kTestName__##name>::Run(void) const
+    template <> void XidiTest::TestCase<kTestName__##name>::Run(void) const
 
 /// Recommended way of creating test cases that execute unconditionally.
 /// Just provide the test case name.
@@ -11,13 +11,25 @@
 
 #pragma once
 
-#include <sal.h>
+#include "ApiPlatform.h"
 
 
 namespace XidiTest
 {
+    // -------- CONSTANTS -------------------------------------------------- //
+
+    /// Name of the environment variable that opts in to running benchmark test cases.
+    /// Benchmarks take much longer than other test cases and only print measurements, so they are skipped unless this variable is set to any value.
+    inline constexpr wchar_t kBenchmarkEnvironmentVariable[] = L"XIDI_TEST_BENCHMARKS";
+
+
     // -------- FUNCTIONS -------------------------------------------------- //
 
+    /// Determines if benchmark test cases should run, as requested using the environment variable #kBenchmarkEnvironmentVariable.
+    /// Intended to be used as the condition for benchmark test cases created using `TEST_CASE_CONDITIONAL`.
+    /// @return `true` if so, `false` otherwise.
+    bool AreBenchmarksEnabled(void);
+
     /// Prints the specified message and appends a newline.
     /// @param [in] str Message string.
     void Print(const wchar_t* const str);
@@ -11,17 +11,27 @@
 
 #pragma once
 
+#include "Clock.h"
+#include "Configuration.h"
+#include "ControllerSourceRegistry.h"
 #include "ControllerTypes.h"
 #include "Mapper.h"
+#include "MessageRateLimiter.h"
+#include "PrefetchScheduler.h"
+#include "SequenceLock.h"
 #include "StateChangeEventBuffer.h"
+#include "Statistics.h"
 #include "XInputInterface.h"
 
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <utility>
+#include <vector>
 
 
 namespace Xidi
@@ -32,8 +42,10 @@ namespace Xidi
         /// Obtains state input from XInput, maps XInput data to virtual controller data, and applies transforms based on application-specified properties.
         /// Supports both instantaneous state and buffered state change events.
         /// All methods are concurrency-safe unless otherwise specified.
-        /// However, bulk operations (such as reading multiple events from the event buffer) are not atomic unless the caller manually obtains a virtual controller's lock.
-        class VirtualController
+        /// However, bulk operations (such as reading multiple events from the event buffer) are not atomic unless the caller manually obtains the appropriate lock.
+        /// Refreshing state and changing properties are serialized by the controller lock, and buffered events are guarded by a separate event buffer lock. Properties and the most recently refreshed state are published for readers that never take either lock.
+        /// Learns how often the application reads its state so that a prefetch scheduler can read XInput ahead of time on the application's behalf.
+        class VirtualController : public IPrefetchTarget
         {
         public:
             // -------- CONSTANTS ------------------------------------------ //
@@ -56,6 +68,21 @@ namespace Xidi
             /// Default value for an axis saturation property. No saturation region is defined by default.
             static constexpr uint32_t kAxisSaturationDefault = kAxisSaturationMax;
 
+            /// Minimum allowed value for an axis granularity property. A granularity of 1 means every value in the axis range is reportable.
+            static constexpr uint32_t kAxisGranularityMin = 1;
+
+            /// Default value for an axis granularity property. No quantization of axis values is performed by default.
+            static constexpr uint32_t kAxisGranularityDefault = kAxisGranularityMin;
+
+            /// Minimum allowed value for an axis hysteresis property.
+            static constexpr uint32_t kAxisHysteresisMin = 0;
+
+            /// Maximum allowed value for an axis hysteresis property. Expressed in the same units as deadzone and saturation.
+            static constexpr uint32_t kAxisHysteresisMax = 10000;
+
+            /// Default value for an axis hysteresis property. No hysteresis band is defined by default.
+            static constexpr uint32_t kAxisHysteresisDefault = kAxisHysteresisMin;
+
             /// Minimum allowed value for force feedback gain, per DirectInput documentation.
             static constexpr uint32_t kFfGainMin = 0;
 
@@ -180,6 +207,11 @@ namespace Xidi
                 int32_t rangeMax;                                           ///< Maximum reportable value for the axis.
                 int32_t rangeNeutral;                                       ///< Neutral value for the axis.
 
+                uint32_t granularity;                                       ///< Granularity of the axis, expressed in the same units as the range. Reported values are quantized toward neutral to multiples of this value, except for the range extremes which are always reportable.
+
+                uint32_t hysteresis;                                        ///< Hysteresis band of the axis, expressed as a percentage of its range. Can be from 0 (no hysteresis) to 10000. Changes in reported value smaller than the band are suppressed.
+                int32_t hysteresisRangeBand;                                ///< Width of the hysteresis band expressed in the same units as the range. Changes whose magnitude is at or below this value are suppressed.
+
                 /// Sets the deadzone and ensures value consistency between fields, but otherwise performs no error checking.
                 /// @param [in] newDeadzone New deadzone value.
                 inline void SetDeadzone(uint32_t newDeadzone)
@@ -189,6 +221,22 @@ namespace Xidi
                     deadzoneRawCutoffNegative = kAnalogValueNeutral - (((kAnalogValueNeutral - kAnalogValueMin) * (int32_t)newDeadzone) / kAxisDeadzoneMax);
                 }
 
+                /// Sets the granularity, but otherwise performs no error checking.
+                /// @param [in] newGranularity New granularity value.
+                inline void SetGranularity(uint32_t newGranularity)
+                {
+                    granularity = newGranularity;
+                }
+
+                /// Sets the hysteresis and ensures value consistency between fields, but otherwise performs no error checking.
+                /// The hysteresis band depends on the range, so this must be invoked again whenever the range changes.
+                /// @param [in] newHysteresis New hysteresis value.
+                inline void SetHysteresis(uint32_t newHysteresis)
+                {
+                    hysteresis = newHysteresis;
+                    hysteresisRangeBand = (int32_t)((((int64_t)rangeMax - (int64_t)rangeMin) * (int64_t)newHysteresis) / (int64_t)kAxisHysteresisMax);
+                }
+
                 /// Sets the range and ensures value consistency between fields, but otherwise performs no error checking.
                 /// @param [in] newRangeMin New minimum range value.
                 /// @param [in] newRangeMax New maximum range value.
@@ -213,7 +261,9 @@ namespace Xidi
                 inline SAxisProperties(void)
                 {
                     SetDeadzone(kAxisDeadzoneDefault);
+                    SetGranularity(kAxisGranularityDefault);
                     SetRange(kAnalogValueMin, kAnalogValueMax);
+                    SetHysteresis(kAxisHysteresisDefault);
                     SetSaturation(kAxisSaturationDefault);
                 }
 
@@ -273,6 +323,29 @@ namespace Xidi
                 }
             };
 
+            /// Set of property changes that are validated together and later applied together, so that a refresh never observes only some of them.
+            /// Fields without a value leave the corresponding property unchanged.
+            struct SPropertyChanges
+            {
+                std::optional<EAxis> axis = std::nullopt;                   ///< Axis to which the axis property changes apply, or no value to apply them to all axes.
+                std::optional<uint32_t> deadzone = std::nullopt;            ///< New deadzone. See #SAxisProperties::deadzone.
+                std::optional<uint32_t> saturation = std::nullopt;          ///< New saturation. See #SAxisProperties::saturation.
+                std::optional<uint32_t> granularity = std::nullopt;         ///< New granularity. See #SAxisProperties::granularity.
+                std::optional<uint32_t> hysteresis = std::nullopt;          ///< New hysteresis. See #SAxisProperties::hysteresis.
+                std::optional<std::pair<int32_t, int32_t>> range = std::nullopt; ///< New range, as a pair of minimum and maximum. See #SAxisProperties::rangeMin and #SAxisProperties::rangeMax.
+                std::optional<uint32_t> ffGain = std::nullopt;              ///< New force feedback gain. See #SDeviceProperties::ffGain.
+                std::optional<uint32_t> eventBufferCapacity = std::nullopt; ///< New event buffer capacity, in number of events.
+                const Mapper* mapper = nullptr;                             ///< New mapper, which must have the same capabilities as the current mapper, or `nullptr` to keep the current mapper.
+            };
+
+            /// Counters that track how many axis value changes were suppressed by axis properties rather than being reported.
+            /// Each suppressed change would otherwise have resulted in a new controller state and, if buffering is enabled, a state change event.
+            struct SSuppressionStatistics
+            {
+                uint64_t numSuppressedByGranularity;                        ///< Number of axis value changes that were quantized away by the granularity property.
+                uint64_t numSuppressedByHysteresis;                         ///< Number of axis value changes that fell within the hysteresis band.
+            };
+
             /// Identifier for a state data packet.
             struct SStateIdentifier
             {
@@ -287,9 +360,14 @@ namespace Xidi
             /// Controller identifier to be used when communicating with the underlying real controller.
             const TControllerIdentifier kControllerIdentifier;
 
-            /// Provides concurrency control to the data structures in this virtual controller.
+            /// Provides concurrency control to the data structures in this virtual controller, other than the event buffer and event filter.
             std::recursive_mutex controllerMutex;
 
+            /// Provides concurrency control to the event buffer and event filter.
+            /// Separate from the controller lock so that reading events only waits for a refresh in progress while that refresh is submitting its events. Whenever both locks are needed, the controller lock is acquired first.
+            /// Mutable so that read-only accessors of the event buffer can acquire it.
+            mutable std::recursive_mutex eventBufferMutex;
+
             /// Buffer for holding controller state change events.
             StateChangeEventBuffer eventBuffer;
 
@@ -299,14 +377,55 @@ namespace Xidi
 
             /// Mapper to use for filling a virtual controller state object based on an XInput controller state.
             /// Not owned by, and must outlive, this object. Since in general mappers are created as constants, this constraint is reasonable.
-            const Mapper& mapper;
+            /// Only replaced while holding this controller's lock, and only by a mapper with identical capabilities, but may be read without the lock.
+            std::atomic<const Mapper*> mapper;
+
+            /// Specifies if this virtual controller follows the configuration file, picking up the configured mapper and configured property defaults whenever a new configuration snapshot is published.
+            const bool kFollowsConfiguration;
+
+            /// Generation number of the configuration snapshot most recently applied to this virtual controller.
+            /// Only meaningful if this virtual controller follows the configuration file.
+            uint32_t configurationGeneration;
+
+            /// Event buffer overflow policy most recently applied from a configuration snapshot, if any configuration snapshot has specified one.
+            /// Used to apply the configured setting only when it changes, so that reloading the configuration does not undo changes made by the application.
+            std::optional<StateChangeEventBuffer::EOverflowPolicy> configuredOverflowPolicy;
+
+            /// Axis hysteresis most recently applied from a configuration snapshot, if any configuration snapshot has specified one.
+            /// Used to apply the configured setting only when it changes, so that reloading the configuration does not undo changes made by the application.
+            std::optional<uint32_t> configuredAxisHysteresis;
 
             /// All properties associated with this virtual controller.
+            /// Only accessed while holding the controller lock. Readers that do not hold it use the published copies instead.
             SProperties properties;
 
+            /// Copies of the axis properties, one element per possible axis, published after every change for readers that do not hold the controller lock.
+            SequenceLocked<SAxisProperties> publishedAxisProperties[(int)EAxis::Count];
+
+            /// Copy of the device-wide properties, published after every change for readers that do not hold the controller lock.
+            SequenceLocked<SDeviceProperties> publishedDeviceProperties;
+
             /// State of the virtual controller as of the last refresh.
+            /// Only accessed while holding the controller lock. Readers that do not hold it use the published copy instead.
             SState state;
 
+            /// Copy of the state of the virtual controller as of the last refresh, published after every change for readers that do not hold the controller lock.
+            SequenceLocked<SState> publishedState;
+
+            /// XInput controller state from which the virtual controller state was produced during the last refresh.
+            /// Used to determine which XInput controller elements have changed, so that only the parts of the virtual controller state that depend on them need to be mapped again.
+            XINPUT_GAMEPAD mappedXInputState;
+
+            /// Virtual controller state produced by the mapper from #mappedXInputState, before any properties were applied.
+            SState mappedState;
+
+            /// Specifies if #mappedXInputState and #mappedState can be used for incremental mapping during the next refresh.
+            /// Cleared whenever the mapper or any properties change so that the next refresh maps and transforms everything from scratch.
+            bool mappedStateValid;
+
+            /// Counters for axis value changes suppressed by the granularity and hysteresis properties.
+            SSuppressionStatistics suppressionStatistics;
+
             /// Identifies the last data packet that was retrieved from a real XInput controller during a refresh operation.
             /// Used to detect if there have been any changes.
             SStateIdentifier stateIdentifier;
@@ -318,35 +437,109 @@ namespace Xidi
             /// Interface through which all XInput-related functionality is accessed.
             const std::unique_ptr<IXInput> xinput;
 
+            /// Clock used to timestamp controller states as they are captured.
+            const IClock& clock;
+
+            /// Cadence at which the application reads the state of this virtual controller.
+            CadenceTracker readCadence;
+
+            /// Time, in nanoseconds, at which the current state was captured.
+            uint64_t stateCaptureTimestamp;
+
+            /// Specifies if the current state was obtained by a prefetch that the application has not yet consumed.
+            bool statePrefetched;
+
+            /// Specifies if the most recent prefetch changed the state of this virtual controller. Reported to the application by the next poll.
+            bool prefetchedStateChanged;
+
+            /// Property changes that have been staged but not yet applied, in the order in which they were staged.
+            std::vector<SPropertyChanges> stagedPropertyChanges;
+
+            /// Guards #stagedPropertyChanges. Separate from the controller lock so that staging changes never waits for a refresh in progress.
+            std::mutex stagedPropertyChangesMutex;
+
+            /// Specifies if #stagedPropertyChanges is non-empty. Allows a refresh to check for staged changes with a single atomic load.
+            std::atomic<bool> stagedPropertyChangesAvailable;
+
+            /// Limits messages about hardware connection and error conditions, which a controller that keeps flapping between states would otherwise output at frame rate.
+            Message::RateLimiter stateMessageRateLimiter;
+
+
+            // -------- INTERNAL INSTANCE METHODS -------------------------- //
+
+            /// Checks if a new configuration snapshot has been published since the last check and, if so, picks up the configured mapper and configured property defaults.
+            /// Not concurrency-safe. The common case of no change costs a single atomic load.
+            void FollowConfigurationChanges(void);
+
+            /// Applies all staged property changes, if there are any, in the order in which they were staged, and forces the next refresh to recompute state.
+            /// Caller must hold the controller lock. The common case of nothing being staged costs a single atomic load.
+            void ApplyStagedPropertyChanges(void);
+
+            /// Modifies the contents of the specified controller state object by applying this virtual controller's properties to a subset of its axes.
+            /// Not concurrency-safe.
+            /// @param [in,out] controllerState Controller state object to transform.
+            /// @param [in] axesToTransform Axes to transform, one bit per axis, indexed by axis type. Other axes are left unmodified.
+            /// @param [in,out] suppressionStatisticsToUpdate Optional counters to be incremented for each axis value change that the properties suppress.
+            void ApplyPropertiesToAxes(SState& controllerState, uint32_t axesToTransform, SSuppressionStatistics* suppressionStatisticsToUpdate) const;
+
+            /// Publishes the current properties for readers that do not hold the controller lock.
+            /// Caller must hold the controller lock, and must invoke this method after every change to the properties.
+            void PublishProperties(void);
+
 
         public:
             // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
 
             /// Initialization constructor.
             /// Requires a complete set of metadata for describing the virtual controller to be created.
-            inline VirtualController(TControllerIdentifier controllerId, const Mapper& mapper, std::unique_ptr<IXInput>&& xinput = std::make_unique<XInput>()) : kControllerIdentifier(controllerId), controllerMutex(), eventBuffer(), eventFilter(), mapper(mapper), properties(), state(), stateIdentifier(), stateRefreshNeeded(true), xinput(std::move(xinput))
+            inline VirtualController(TControllerIdentifier controllerId, const Mapper& mapper, std::unique_ptr<IXInput>&& xinput = ControllerSourceRegistry::CreateDefaultInterface(), const IClock& clock = SystemClock::GetInstance()) : kControllerIdentifier(controllerId), controllerMutex(), eventBufferMutex(), eventBuffer(), eventFilter(), mapper(&mapper), kFollowsConfiguration(false), configurationGeneration(0), configuredOverflowPolicy(), configuredAxisHysteresis(), properties(), publishedAxisProperties(), publishedDeviceProperties(), state(), publishedState(), mappedXInputState(), mappedState(), mappedStateValid(false), suppressionStatistics(), stateIdentifier(), stateRefreshNeeded(true), xinput(std::move(xinput)), clock(clock), readCadence(), stateCaptureTimestamp(0), statePrefetched(false), prefetchedStateChanged(false), stagedPropertyChanges(), stagedPropertyChangesMutex(), stagedPropertyChangesAvailable(false), stateMessageRateLimiter()
             {
                 // Nothing to do here.
             }
 
+            /// Initialization constructor.
+            /// Uses the mapper and property defaults specified in the configuration file, and follows any changes to them that are published when the configuration file is reloaded.
+            /// Requires that a configured mapper be available, which the caller should verify using #Mapper::GetConfigured.
+            VirtualController(TControllerIdentifier controllerId, std::unique_ptr<IXInput>&& xinput = ControllerSourceRegistry::CreateDefaultInterface(), const IClock& clock = SystemClock::GetInstance());
+
+
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Transforms a raw axis value using the deadzone, saturation, and range in the supplied axis properties.
+            /// Granularity and hysteresis are not applied because they depend on previously-reported values.
+            /// @param [in] axisValueRaw Raw axis value as obtained from a mapper.
+            /// @param [in] axisProperties Axis properties to apply.
+            /// @return Axis value that results from applying the transformation.
+            static int32_t TransformAxisValue(int32_t axisValueRaw, const SAxisProperties& axisProperties);
+
 
             // -------- INSTANCE METHODS ----------------------------------- //
 
+            /// Applies virtual controller settings from the specified configuration data.
+            /// Only settings that the configuration data contains, and whose configured values differ from those applied previously, are applied. Other settings keep their current values, including any that the application has changed.
+            /// Primarily intended for internal use but exposed for testing purposes. Caller must hold the controller lock.
+            /// @param [in] configData Configuration data to apply.
+            void ApplyConfiguration(const Configuration::ConfigurationData& configData);
+
             /// Modifies the contents of the specified controller state object by applying this virtual controller's properties.
+            /// Granularity and hysteresis are applied relative to the most recently reported state, so that sub-threshold changes are removed before the new state is compared with it.
             /// Primarily intended for internal use but exposed for testing purposes. Implementation is not concurrency-safe.
             /// @param [in,out] controllerState Controller state object to transform.
-            void ApplyProperties(SState& controllerState) const;
+            /// @param [in,out] suppressionStatisticsToUpdate Optional counters to be incremented for each axis value change that the properties suppress.
+            void ApplyProperties(SState& controllerState, SSuppressionStatistics* suppressionStatisticsToUpdate = nullptr) const;
 
             /// Adds the specified virtual controller element to this virtual controller's event filter so that events are generated for it.
             /// @param [in] element Desired virtual controller element.
             inline void EventFilterAddElement(SElementIdentifier element)
             {
+                auto lock = LockEventBuffer();
                 eventFilter.Add(element);
             }
 
             /// Adds all virtual controller elements to this virtual controller's event filter filter, essentially turning the filter into a no-op and generating events for all elements.
             inline void EventFilterAddAllElements(void)
             {
+                auto lock = LockEventBuffer();
                 eventFilter.AddAll();
             }
 
@@ -354,21 +547,24 @@ namespace Xidi
             /// @param [in] element Desired virtual controller element.
             inline void EventFilterRemoveElement(SElementIdentifier element)
             {
+                auto lock = LockEventBuffer();
                 eventFilter.Remove(element);
             }
 
             /// Removes all virtual controller elements from this virtual controller's event filter, resulting in no events being generated whatsoever.
             inline void EventFilterRemoveAllElements(void)
             {
+                auto lock = LockEventBuffer();
                 eventFilter.RemoveAll();
             }
 
             /// Retrieves and returns the capabilities of this virtual controller.
             /// Controller capabilities act as metadata that are used internally and can be presented to applications.
-            /// @return Read-only capabilities data structure reference.
-            inline const SCapabilities GetCapabilities(void) const
+            /// Capabilities come from the current mapper, which can be replaced at any time, so a copy is returned rather than a reference.
+            /// @return Copy of the capabilities data structure.
+            inline SCapabilities GetCapabilities(void) const
             {
-                return mapper.GetCapabilities();
+                return mapper.load()->GetCapabilities();
             }
 
             /// Retrieves and returns the deadzone property of the specified axis.
@@ -376,7 +572,23 @@ namespace Xidi
             /// @return Deadzone value associated with the target axis.
             inline uint32_t GetAxisDeadzone(EAxis axis) const
             {
-                return properties.axis[(int)axis].deadzone;
+                return publishedAxisProperties[(int)axis].Read().deadzone;
+            }
+
+            /// Retrieves and returns the granularity property of the specified axis.
+            /// @param [in] axis Target axis.
+            /// @return Granularity value associated with the target axis.
+            inline uint32_t GetAxisGranularity(EAxis axis) const
+            {
+                return publishedAxisProperties[(int)axis].Read().granularity;
+            }
+
+            /// Retrieves and returns the hysteresis property of the specified axis.
+            /// @param [in] axis Target axis.
+            /// @return Hysteresis value associated with the target axis.
+            inline uint32_t GetAxisHysteresis(EAxis axis) const
+            {
+                return publishedAxisProperties[(int)axis].Read().hysteresis;
             }
 
             /// Retrieves and returns the range property of the specified axis.
@@ -384,7 +596,8 @@ namespace Xidi
             /// @return Pair of range values associated with the target axis. First is the minimum, and second is the maximum.
             inline std::pair<int32_t, int32_t> GetAxisRange(EAxis axis) const
             {
-                return std::make_pair(properties.axis[(int)axis].rangeMin, properties.axis[(int)axis].rangeMax);
+                const SAxisProperties kAxisProperties = publishedAxisProperties[(int)axis].Read();
+                return std::make_pair(kAxisProperties.rangeMin, kAxisProperties.rangeMax);
             }
 
             /// Retrieves and returns the saturation property of the specified axis.
@@ -392,13 +605,14 @@ namespace Xidi
             /// @return Saturation value associated with the target axis.
             inline uint32_t GetAxisSaturation(EAxis axis) const
             {
-                return properties.axis[(int)axis].saturation;
+                return publishedAxisProperties[(int)axis].Read().saturation;
             }
 
             /// Retrieves and returns the capacity of the event buffer in number of events.
             /// @return Capacity of the event buffer.
             inline uint32_t GetEventBufferCapacity(void) const
             {
+                auto lock = LockEventBuffer();
                 return eventBuffer.GetCapacity();
             }
 
@@ -406,12 +620,21 @@ namespace Xidi
             /// @return Event count of the event buffer.
             inline uint32_t GetEventBufferCount(void) const
             {
+                auto lock = LockEventBuffer();
                 return eventBuffer.GetCount();
             }
 
+            /// Retrieves and returns the policy the event buffer uses for storing events and handling overflow.
+            /// @return Event buffer overflow policy.
+            inline StateChangeEventBuffer::EOverflowPolicy GetEventBufferOverflowPolicy(void) const
+            {
+                auto lock = LockEventBuffer();
+                return eventBuffer.GetOverflowPolicy();
+            }
+
             /// Retrieves a read-only reference to a buffered event at the specified index, without performing any bounds-checking.
             /// Event with index 0 is the oldest, and higher indices indicate more recent events.
-            /// To prevent the event buffer from being modified while accessing multiple events, the caller should first obtain this virtual controller's lock.
+            /// Caller must obtain this virtual controller's event buffer lock and hold it for as long as the returned reference is used, because any event buffer modification can invalidate it.
             /// @param [in] index Index of the desired event.
             /// @return Read-only reference to the event at the desired index.
             inline const StateChangeEventBuffer::SEvent& GetEventBufferEvent(uint32_t index) const
@@ -423,7 +646,7 @@ namespace Xidi
             /// @return Force feedback gain property value.
             inline uint32_t GetForceFeedbackGain(void) const
             {
-                return properties.device.ffGain;
+                return publishedDeviceProperties.Read().ffGain;
             }
 
             /// Retrieves and returns this controller's identifier.
@@ -432,12 +655,29 @@ namespace Xidi
             {
                 return kControllerIdentifier;
             }
+
+            /// Retrieves and returns the mapper this controller currently uses.
+            /// @return Read-only reference to the mapper.
+            inline const Mapper& GetMapper(void) const
+            {
+                return *mapper.load();
+            }
+
+            /// Retrieves and returns a copy of all properties associated with this controller, without taking any locks.
+            /// Each axis and the device-wide properties are individually consistent, but a concurrent change that affects several of them at once might be only partially visible.
+            /// @return Copy of the properties.
+            SProperties GetProperties(void) const;
             
             /// Retrieves and returns the latest view of the state of this virtual controller.
             /// @return Current state of this virtual controller.
             SState GetState(void);
 
+            /// Retrieves and returns the counters of axis value changes that were suppressed by the granularity and hysteresis properties.
+            /// @return Copy of the suppression counters.
+            SSuppressionStatistics GetSuppressionStatistics(void);
+
             /// Provides a direct read-only view of the state of this virtual controller.
+            /// Counts as an application read, so it is used to learn the application's cadence and consumes any pending prefetch.
             /// Caller must obtain the controller lock and hold it for as long as the view is expected to remain valid, which is ideally a very short time.
             /// @return Read-only view of the state of this virtual controller.
             const SState& GetStateRef(void);
@@ -446,6 +686,7 @@ namespace Xidi
             /// @return `true` if event buffering is enabled, `false` otherwise.
             inline bool IsEventBufferEnabled(void) const
             {
+                auto lock = LockEventBuffer();
                 return eventBuffer.IsEnabled();
             }
 
@@ -453,32 +694,104 @@ namespace Xidi
             /// @return `true` if an overflow condition is present, `false` otherwise.
             inline bool IsEventBufferOverflowed(void) const
             {
+                auto lock = LockEventBuffer();
                 return eventBuffer.IsOverflowed();
             }
 
             /// Locks this virtual controller for ensuring proper concurrency control.
             /// The returned lock object is scoped and, as a result, will automatically unlock this virtual controller upon its destruction.
-            /// Used internally for this purpose, and can be used externally for locking ahead of bulk events or direct event buffer access.
+            /// Used internally for this purpose, and can be used externally for locking ahead of bulk operations such as direct access to the state being refreshed.
             /// @return Scoped lock object that has acquired this virtual controller's concurrency control mutex.
             inline std::unique_lock<std::recursive_mutex> Lock(void)
             {
-                return std::unique_lock(controllerMutex);
+                std::unique_lock lock(controllerMutex, std::try_to_lock);
+                if (false == lock.owns_lock())
+                {
+                    Statistics::RecordLockContention(kControllerIdentifier);
+                    lock.lock();
+                }
+
+                return lock;
+            }
+
+            /// Locks this virtual controller's event buffer and event filter for ensuring proper concurrency control.
+            /// The returned lock object is scoped and, as a result, will automatically unlock the event buffer upon its destruction.
+            /// Used internally for this purpose, including by the individual event buffer accessors, and can be used externally for locking ahead of bulk events or direct event buffer access so that several accessors observe the same buffer contents. A caller that also needs the controller lock must acquire it first.
+            /// @return Scoped lock object that has acquired this virtual controller's event buffer mutex.
+            inline std::unique_lock<std::recursive_mutex> LockEventBuffer(void) const
+            {
+                std::unique_lock lock(eventBufferMutex, std::try_to_lock);
+                if (false == lock.owns_lock())
+                {
+                    Statistics::RecordLockContention(kControllerIdentifier);
+                    lock.lock();
+                }
+
+                return lock;
             }
 
+            /// Retrieves and returns the state of this virtual controller as of the most recent refresh, without refreshing it, without counting as an application read, and without taking any locks.
+            /// @return Copy of the state of this virtual controller.
+            inline SState PeekState(void) const
+            {
+                return publishedState.Read();
+            }
+
+            /// Provides a direct read-only view of the state of this virtual controller as of the most recent refresh, without refreshing it and without counting as an application read.
+            /// Caller must obtain the controller lock and hold it for as long as the view is expected to remain valid, which is ideally a very short time. Callers that do not otherwise need the lock should use #PeekState instead.
+            /// @return Read-only view of the state of this virtual controller.
+            inline const SState& PeekStateRef(void) const
+            {
+                return state;
+            }
+
+            /// Refreshes the view of the state of this virtual controller on behalf of an application that polls it.
+            /// If a prefetch has already been performed, has not yet been consumed, and is not stale, XInput is not read again and the outcome of the prefetch is reported instead.
+            /// @return `true` if the state of the controller changed since last refresh, `false` otherwise.
+            bool PollState(void);
+
             /// Removes and discards up to the specified number of the oldest events from this virtual controller's event buffer and clears any present overflow condition.
             /// @param [in] numEventsToPop Maximum number of events to remove.
             void PopEventBufferOldestEvents(uint32_t numEventsToPop);
 
             /// Refreshes the view of the state of this virtual controller by querying the real XInput controller.
+            /// The capture time of the new state is taken from this virtual controller's clock immediately after the query completes.
             /// @return `true` if the state of the controller changed since last refresh, `false` otherwise.
             bool RefreshState(void);
 
+            /// Refreshes the view of the state of this virtual controller using XInput data that the caller has already obtained.
+            /// Allows multiple virtual controllers to be refreshed from a single batch of XInput reads.
+            /// @param [in] xinputGetStateResult Result code from the XInput call that produced the supplied state.
+            /// @param [in] xinputState XInput controller state, which is ignored unless the result code indicates success.
+            /// @param [in] captureTimestamp Time, in nanoseconds, at which the supplied state was captured. Used to timestamp any events that result from the refresh. See #IClock for more information.
+            /// @return `true` if the state of the controller changed since last refresh, `false` otherwise.
+            bool RefreshState(DWORD xinputGetStateResult, XINPUT_STATE xinputState, uint64_t captureTimestamp);
+
+            /// Stages a set of property changes to be applied together.
+            /// All changes are validated first, and nothing is staged unless all of them are valid.
+            /// Valid changes are applied right away if no other thread holds the controller lock, and otherwise by the next refresh, so staging never waits for the controller lock.
+            /// @param [in] changes Property changes to stage.
+            /// @return `true` if the changes were successfully validated and staged, `false` otherwise.
+            bool StagePropertyChanges(const SPropertyChanges& changes);
+
             /// Sets the deadzone property for a single axis.
             /// @param [in] axis Target axis.
             /// @param [in] deadzone Desired deadzone value.
             /// @return `true` if the new deadzone value was successfully validated and set, `false` otherwise.
             bool SetAxisDeadzone(EAxis axis, uint32_t deadzone);
 
+            /// Sets the granularity property for a single axis.
+            /// @param [in] axis Target axis.
+            /// @param [in] granularity Desired granularity value.
+            /// @return `true` if the new granularity value was successfully validated and set, `false` otherwise.
+            bool SetAxisGranularity(EAxis axis, uint32_t granularity);
+
+            /// Sets the hysteresis property for a single axis.
+            /// @param [in] axis Target axis.
+            /// @param [in] hysteresis Desired hysteresis value.
+            /// @return `true` if the new hysteresis value was successfully validated and set, `false` otherwise.
+            bool SetAxisHysteresis(EAxis axis, uint32_t hysteresis);
+
             /// Sets the range property for a single axis.
             /// @param [in] axis Target axis.
             /// @param [in] rangeMin Desired minimum range value.
@@ -497,6 +810,16 @@ namespace Xidi
             /// @return `true` if the new deadzone value was successfully validated and set, `false` otherwise.
             bool SetAllAxisDeadzone(uint32_t deadzone);
 
+            /// Sets the granularity property for all axes.
+            /// @param [in] granularity Desired granularity value.
+            /// @return `true` if the new granularity value was successfully validated and set, `false` otherwise.
+            bool SetAllAxisGranularity(uint32_t granularity);
+
+            /// Sets the hysteresis property for all axes.
+            /// @param [in] hysteresis Desired hysteresis value.
+            /// @return `true` if the new hysteresis value was successfully validated and set, `false` otherwise.
+            bool SetAllAxisHysteresis(uint32_t hysteresis);
+
             /// Sets the range property for all axes.
             /// @param [in] rangeMin Desired minimum range value.
             /// @param [in] rangeMax Desired maximum range value.
@@ -513,10 +836,21 @@ namespace Xidi
             /// @return `true` if the new event buffer capacity was successfully validated and set, `false` otherwise.
             bool SetEventBufferCapacity(uint32_t capacity);
 
+            /// Sets the policy the event buffer uses for storing events and handling overflow.
+            /// @param [in] policy Desired overflow policy.
+            /// @return `true` if the new overflow policy was successfully validated and set, `false` otherwise.
+            bool SetEventBufferOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy policy);
+
             /// Sets the force feedback gain property for this controller.
             /// @param [in] ffGain Desired force feedback gain value.
             /// @return `true` if the new force feedback gain value was successfully validated and set, `false` otherwise.
             bool SetForceFeedbackGain(uint32_t ffGain);
+
+
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+
+            std::optional<SPrefetchPrediction> GetPrefetchPrediction(void) override;
+            void Prefetch(void) override;
         };
     }
 }
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <vector>
 
 
 namespace Xidi
@@ -77,6 +78,65 @@ namespace Xidi
     template <ECharMode charMode> class VirtualDirectInputDevice : public DirectInputDeviceType<charMode>
     {
     private:
+        // -------- TYPE DEFINITIONS ----------------------------------------------- //
+
+        /// Holds the application-defined action value that an action map associates with each virtual controller element.
+        /// Indexed the same way as element offsets in a data format specification, so that buffered events can be tagged with their action values without any searching.
+        /// Once built, a table is immutable. It is replaced whenever the application sets a new data format or action map.
+        struct SActionTable
+        {
+            UINT_PTR axisAppData[(int)Controller::EAxis::Count];            ///< Action value for each axis, indexed by axis type enumerator.
+            UINT_PTR buttonAppData[(int)Controller::EButton::Count];        ///< Action value for each button, indexed by button number enumerator.
+            UINT_PTR povAppData;                                            ///< Action value for the POV.
+
+            /// Retrieves the action value associated with the specified element.
+            /// @param [in] element Virtual controller element for which an action value is desired.
+            /// @return Associated action value, or 0 if the element does not identify an axis, button, or POV.
+            inline UINT_PTR GetAppDataForElement(Controller::SElementIdentifier element) const
+            {
+                switch (element.type)
+                {
+                case Controller::EElementType::Axis:
+                    return axisAppData[(int)element.axis];
+                case Controller::EElementType::Button:
+                    return buttonAppData[(int)element.button];
+                case Controller::EElementType::Pov:
+                    return povAppData;
+                default:
+                    return 0;
+                }
+            }
+
+            /// Associates the specified action value with the specified element.
+            /// @param [in] element Virtual controller element with which the action value is being associated.
+            /// @param [in] appData Action value being associated with the element.
+            inline void SetAppDataForElement(Controller::SElementIdentifier element, UINT_PTR appData)
+            {
+                switch (element.type)
+                {
+                case Controller::EElementType::Axis:
+                    axisAppData[(int)element.axis] = appData;
+                    break;
+                case Controller::EElementType::Button:
+                    buttonAppData[(int)element.button] = appData;
+                    break;
+                case Controller::EElementType::Pov:
+                    povAppData = appData;
+                    break;
+                }
+            }
+        };
+
+        /// Holds fully-populated object instance information for every element of the virtual controller.
+        /// Elements appear in enumeration order: axes in capability order, then buttons, then the POV if present.
+        /// Once built, a table is immutable. It is replaced whenever the information it holds could change.
+        struct SObjectInstanceTable
+        {
+            Controller::SCapabilities capabilities;                         ///< Capabilities of the virtual controller at the time the table was built.
+            std::vector<typename DirectInputDeviceType<charMode>::DeviceObjectInstanceType> objectInstances;    ///< Object instance information, one element per virtual controller element.
+        };
+
+
         // -------- INSTANCE VARIABLES --------------------------------------------- //
 
         /// Virtual controller with which to interface.
@@ -85,6 +145,14 @@ namespace Xidi
         /// Data format specification for communicating with the DirectInput application.
         std::unique_ptr<DataFormat> dataFormat;
 
+        /// Action values associated with virtual controller elements by the most recent action map.
+        /// Not present if the application set its data format directly instead of by using an action map.
+        std::unique_ptr<const SActionTable> actionTable;
+
+        /// Cached object instance information, built on first use and discarded whenever the data format changes.
+        /// Shared so that an enumeration in progress can keep using its table even if the application changes the data format from within an enumeration callback.
+        std::shared_ptr<const SObjectInstanceTable> objectInstanceTable;
+
         /// Reference count.
         std::atomic<unsigned long> refCount;
 
@@ -99,6 +167,24 @@ namespace Xidi
         /// @param [in] controller Virtual controller object to associate with this object.
         VirtualDirectInputDevice(std::unique_ptr<Controller::VirtualController>&& controller);
 
+        /// Default destructor.
+        /// Unregisters the associated virtual controller from the prefetch scheduler before it is destroyed.
+        ~VirtualDirectInputDevice(void);
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS -------------------------------------- //
+
+        /// Replaces the data format used to communicate with the application, along with the action values associated with virtual controller elements.
+        /// Updates the virtual controller's event filter so that events for elements absent from the new data format are never buffered.
+        /// @param [in] newDataFormat Data format to use from now on.
+        /// @param [in] newActionTable Action values to use from now on, or `nullptr` if the data format did not come from an action map.
+        void ApplyDataFormat(std::unique_ptr<DataFormat>&& newDataFormat, std::unique_ptr<const SActionTable>&& newActionTable);
+
+        /// Retrieves the object instance information table, building it first if it does not exist or is out of date.
+        /// @return Object instance information table that reflects the current data format and controller capabilities.
+        std::shared_ptr<const SObjectInstanceTable> GetObjectInstanceTable(void);
+
 
     public:
         // -------- INSTANCE METHODS ----------------------------------------------- //
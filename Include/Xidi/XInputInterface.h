@@ -12,9 +12,8 @@
 
 #pragma once
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
 
-#include <xinput.h>
 
 
 namespace Xidi
@@ -41,4 +40,15 @@ namespace Xidi
 
         DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override;
     };
+
+
+    // -------- FUNCTIONS -------------------------------------------------- //
+
+    /// Abandons polling native XInput on behalf of other processes and gives up ownership of the shared controller segment, so that another process can take over immediately.
+    /// Has no effect unless native XInput is shared with other processes. Invoked as the process terminates, so it neither waits for the polling thread nor acquires any locks.
+    void AbandonNativeXInputSharing(void);
+
+    /// Registers native XInput as a controller source with the default controller source registry, contributing one slot per XInput user index.
+    /// Only the first invocation has any effect. API wrappers invoke this as they initialize, so that physical XInput controllers occupy the first virtual controller slots.
+    void RegisterNativeXInputSource(void);
 }
@@ -13,6 +13,7 @@
 
 #include "Configuration.h"
 
+#include <string>
 #include <string_view>
 
 
@@ -25,6 +26,7 @@ namespace Xidi
         // See "Configuration.h" for documentation.
 
         Configuration::ESectionAction ActionForSection(std::wstring_view section) override;
+        bool CheckConfiguration(const Configuration::ConfigurationData& configData, std::wstring& errorDescription) override;
         bool CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TIntegerValue& value) override;
         bool CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TBooleanValue& value) override;
         bool CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TStringValue& value) override;
@@ -0,0 +1,244 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BackgroundWorker.cpp
+ *   Implementation of a background thread that runs until asked to stop.
+ *****************************************************************************/
+
+#include "BackgroundWorker.h"
+#include "Platform.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include "ApiWindows.h"
+#endif
+
+
+namespace Xidi
+{
+#ifdef _WIN32
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Everything a background thread needs, allocated when it is created and freed by the thread itself before it exits.
+    struct SThreadParameters
+    {
+        std::function<void(void)> threadBody;                               ///< Function to run on the background thread.
+        bool holdsModuleReference;                                          ///< Whether the background thread holds a reference to the module that contains Xidi, which it releases as it exits.
+    };
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Entry point for a background thread.
+    /// Releasing the module reference exits the thread without returning here, so nothing on this stack frame would be destroyed automatically. Everything the thread owns is therefore destroyed in the inner scope first, after which only trivially-destructible locals remain.
+    /// @param [in] threadParameters Pointer to the thread's #SThreadParameters, which this function takes ownership of.
+    /// @return Always 0. Only actually returns if no module reference is held.
+    static DWORD WINAPI ThreadProc(LPVOID threadParameters)
+    {
+        bool holdsModuleReference = false;
+
+        {
+            std::unique_ptr<SThreadParameters> parameters(static_cast<SThreadParameters*>(threadParameters));
+            holdsModuleReference = parameters->holdsModuleReference;
+            parameters->threadBody();
+        }
+
+        if (true == holdsModuleReference)
+            Platform::ReleaseModuleReferenceAndExitThread();
+
+        return 0;
+    }
+#endif
+
+
+    // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
+    // See "BackgroundWorker.h" for documentation.
+
+    BackgroundWorker::BackgroundWorker(void) : workerMutex(), workerCondition(), stopRequested(false), notified(false), abandoned(false), workerThread()
+    {
+        // Nothing to do here.
+    }
+
+    // --------
+
+    BackgroundWorker::~BackgroundWorker(void)
+    {
+        Stop();
+    }
+
+
+    // -------- CLASS METHODS ---------------------------------------------- //
+    // See "BackgroundWorker.h" for documentation.
+
+    void BackgroundWorker::DetachThread(TThread& thread)
+    {
+#ifdef _WIN32
+        if (nullptr != thread)
+            CloseHandle(std::exchange(thread, nullptr));
+#else
+        if (true == thread.joinable())
+            thread.detach();
+#endif
+    }
+
+    // --------
+
+    bool BackgroundWorker::IsThreadJoinable(const TThread& thread)
+    {
+#ifdef _WIN32
+        return (nullptr != thread);
+#else
+        return thread.joinable();
+#endif
+    }
+
+    // --------
+
+    void BackgroundWorker::JoinThread(TThread& thread)
+    {
+#ifdef _WIN32
+        if (nullptr != thread)
+        {
+            WaitForSingleObject(thread, INFINITE);
+            CloseHandle(std::exchange(thread, nullptr));
+        }
+#else
+        if (true == thread.joinable())
+            thread.join();
+#endif
+    }
+
+    // --------
+
+    BackgroundWorker::TThread BackgroundWorker::StartThread(std::function<void(void)> threadBody)
+    {
+#ifdef _WIN32
+        const bool kHoldsModuleReference = Platform::AcquireModuleReference();
+        SThreadParameters* const threadParameters = new SThreadParameters({.threadBody = std::move(threadBody), .holdsModuleReference = kHoldsModuleReference});
+
+        HANDLE thread = CreateThread(nullptr, 0, &ThreadProc, threadParameters, 0, nullptr);
+        if (nullptr == thread)
+        {
+            delete threadParameters;
+
+            if (true == kHoldsModuleReference)
+                Platform::ReleaseModuleReference();
+        }
+
+        return thread;
+#else
+        // Module references are not tracked on other platforms, so the thread body can run directly.
+        return std::thread(std::move(threadBody));
+#endif
+    }
+
+
+    // -------- INSTANCE METHODS ------------------------------------------- //
+    // See "BackgroundWorker.h" for documentation.
+
+    void BackgroundWorker::Abandon(void)
+    {
+        abandoned.store(true, std::memory_order_relaxed);
+        DetachThread(workerThread);
+    }
+
+    // --------
+
+    bool BackgroundWorker::IsRunning(void)
+    {
+        std::scoped_lock lock(workerMutex);
+        return IsThreadJoinable(workerThread);
+    }
+
+    // --------
+
+    bool BackgroundWorker::IsStopRequested(void)
+    {
+        std::scoped_lock lock(workerMutex);
+        return stopRequested;
+    }
+
+    // --------
+
+    void BackgroundWorker::Notify(void)
+    {
+        std::scoped_lock lock(workerMutex);
+
+        notified = true;
+        workerCondition.notify_all();
+    }
+
+    // --------
+
+    void BackgroundWorker::RequestStop(void)
+    {
+        if (true == IsAbandoned())
+            return;
+
+        std::scoped_lock lock(workerMutex);
+
+        stopRequested = true;
+        workerCondition.notify_all();
+    }
+
+    // --------
+
+    bool BackgroundWorker::Start(std::function<void(void)> threadBody)
+    {
+        std::scoped_lock lock(workerMutex);
+
+        if (true == IsThreadJoinable(workerThread))
+            return false;
+
+        stopRequested = false;
+        notified = false;
+        workerThread = StartThread(std::move(threadBody));
+        return IsThreadJoinable(workerThread);
+    }
+
+    // --------
+
+    void BackgroundWorker::Stop(void)
+    {
+        if (true == IsAbandoned())
+            return;
+
+        TThread threadToJoin;
+
+        // The thread is joined without holding the lock because the thread needs the lock to notice that it should stop.
+        {
+            std::scoped_lock lock(workerMutex);
+
+            stopRequested = true;
+            threadToJoin = std::exchange(workerThread, TThread());
+            workerCondition.notify_all();
+        }
+
+        JoinThread(threadToJoin);
+    }
+
+    // --------
+
+    bool BackgroundWorker::WaitFor(uint64_t nanoseconds)
+    {
+        std::unique_lock lock(workerMutex);
+
+        workerCondition.wait_for(lock, std::chrono::nanoseconds(nanoseconds), [this]() -> bool { return (stopRequested || notified); });
+        notified = false;
+
+        return (false == stopRequested);
+    }
+}
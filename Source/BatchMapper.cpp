@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BatchMapper.cpp
+ *   Implementation of the object that maps XInput controller states for many
+ *   virtual controller slots together and applies each slot's axis
+ *   properties to the results.
+ *****************************************************************************/
+
+#include "BatchMapper.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "VirtualController.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "BatchMapper.h" for documentation.
+
+        BatchMapper::BatchMapper(const Mapper& mapper) : mapper(mapper), axisPropertiesBatch(), axisProperties()
+        {
+            const VirtualController::SProperties kDefaultProperties;
+
+            for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+                SetAxisProperties(i, kDefaultProperties);
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "BatchMapper.h" for documentation.
+
+        void BatchMapper::TransformAxisValueBatch(int32_t* axisValues, const SAxisPropertiesBatch& axisPropertiesBatch, unsigned int slotCount)
+        {
+            for (unsigned int i = 0; i < slotCount; ++i)
+            {
+                const int32_t kAxisValueRaw = axisValues[i];
+
+                // Both halves of the axis are evaluated the same way, so the properties of the half in which the raw value lies are selected up front instead of branching.
+                const bool kIsPositive = (kAxisValueRaw > kAnalogValueNeutral);
+                const int32_t kDeadzoneRawCutoff = (kIsPositive ? axisPropertiesBatch.deadzoneRawCutoffPositive[i] : axisPropertiesBatch.deadzoneRawCutoffNegative[i]);
+                const int32_t kSaturationRawCutoff = (kIsPositive ? axisPropertiesBatch.saturationRawCutoffPositive[i] : axisPropertiesBatch.saturationRawCutoffNegative[i]);
+                const int32_t kRangeExtreme = (kIsPositive ? axisPropertiesBatch.rangeMax[i] : axisPropertiesBatch.rangeMin[i]);
+                const int32_t kRangeNeutral = axisPropertiesBatch.rangeNeutral[i];
+
+                const bool kIsInDeadzone = (kIsPositive ? (kAxisValueRaw <= kDeadzoneRawCutoff) : (kAxisValueRaw >= kDeadzoneRawCutoff));
+                const bool kIsInSaturation = (kIsPositive ? (kAxisValueRaw >= kSaturationRawCutoff) : (kAxisValueRaw <= kSaturationRawCutoff));
+                const bool kIsInRange = !(kIsInDeadzone || kIsInSaturation);
+
+                // Values outside the region between deadzone and saturation use a harmless ratio, because their result is discarded but is still computed.
+                // Raw displacements are at most 16 bits and range magnitudes are at most 32 bits, so their product is exactly representable as a double.
+                // Under that condition, a correctly-rounded double quotient truncated toward zero is exactly the same as the 64-bit integer quotient the scalar path computes.
+                const double kRawDisplacement = (double)(kIsInRange ? (kAxisValueRaw - kDeadzoneRawCutoff) : 0);
+                const double kRawDisplacementMax = (double)(kIsInRange ? (kSaturationRawCutoff - kDeadzoneRawCutoff) : 1);
+                const double kRangeMagnitudeMax = (double)kRangeExtreme - (double)kRangeNeutral;
+                const int32_t kAxisValueInRange = kRangeNeutral + (int32_t)((kRawDisplacement * kRangeMagnitudeMax) / kRawDisplacementMax);
+
+                axisValues[i] = (kIsInDeadzone ? kRangeNeutral : (kIsInSaturation ? kRangeExtreme : kAxisValueInRange));
+            }
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "BatchMapper.h" for documentation.
+
+        void BatchMapper::MapXInputStates(const Mapper::SXInputBatch& xinputStates, std::span<SState> controllerStates) const
+        {
+            const unsigned int kSlotCount = (unsigned int)std::min(controllerStates.size(), (size_t)kBatchSlotCountMax);
+
+            SStateBatch controllerStateBatch;
+            mapper.MapXInputStateBatch(controllerStateBatch, xinputStates, kSlotCount);
+
+            for (int i = 0; i < (int)EAxis::Count; ++i)
+                TransformAxisValueBatch(controllerStateBatch.axis[i], axisPropertiesBatch[i], kSlotCount);
+
+            for (unsigned int i = 0; i < kSlotCount; ++i)
+                controllerStateBatch.GetSlot(i, controllerStates[i]);
+        }
+
+        // --------
+
+        void BatchMapper::MapXInputStatesReference(const Mapper::SXInputBatch& xinputStates, std::span<SState> controllerStates) const
+        {
+            const unsigned int kSlotCount = (unsigned int)std::min(controllerStates.size(), (size_t)kBatchSlotCountMax);
+
+            for (unsigned int i = 0; i < kSlotCount; ++i)
+            {
+                mapper.MapXInputState(controllerStates[i], xinputStates.GetSlot(i));
+
+                for (int j = 0; j < (int)EAxis::Count; ++j)
+                    controllerStates[i].axis[j] = VirtualController::TransformAxisValue(controllerStates[i].axis[j], axisProperties[i][j]);
+            }
+        }
+
+        // --------
+
+        void BatchMapper::SetAxisProperties(unsigned int slot, const VirtualController::SProperties& properties)
+        {
+            for (int i = 0; i < (int)EAxis::Count; ++i)
+            {
+                const VirtualController::SAxisProperties& kAxisProperties = properties.axis[i];
+
+                axisPropertiesBatch[i].deadzoneRawCutoffPositive[slot] = kAxisProperties.deadzoneRawCutoffPositive;
+                axisPropertiesBatch[i].deadzoneRawCutoffNegative[slot] = kAxisProperties.deadzoneRawCutoffNegative;
+                axisPropertiesBatch[i].saturationRawCutoffPositive[slot] = kAxisProperties.saturationRawCutoffPositive;
+                axisPropertiesBatch[i].saturationRawCutoffNegative[slot] = kAxisProperties.saturationRawCutoffNegative;
+                axisPropertiesBatch[i].rangeMin[slot] = kAxisProperties.rangeMin;
+                axisPropertiesBatch[i].rangeMax[slot] = kAxisProperties.rangeMax;
+                axisPropertiesBatch[i].rangeNeutral[slot] = kAxisProperties.rangeNeutral;
+
+                axisProperties[slot][i] = kAxisProperties;
+            }
+        }
+    }
+}
@@ -9,20 +9,28 @@
  *   Implementation of configuration file functionality.
  *****************************************************************************/
 
+#include "ApiPlatform.h"
 #include "Configuration.h"
+#include "Platform.h"
 #include "TemporaryBuffer.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cwctype>
 #include <limits>
 #include <memory>
+#include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 
 namespace Xidi
@@ -41,6 +49,15 @@ namespace Xidi
             Value,                                                          ///< Line is a value within the current section and so should be parsed.
         };
 
+        /// Holds the tokens extracted from a single configuration file line.
+        /// All tokens refer to the buffer that holds the configuration file contents.
+        struct SLineTokens
+        {
+            std::wstring_view section;                                      ///< Section name, valid if the line begins a section.
+            std::wstring_view name;                                         ///< Configuration setting name, valid if the line is a value.
+            std::wstring_view value;                                        ///< Configuration setting value, valid if the line is a value.
+        };
+
         /// Wrapper around a standard file handle.
         /// Attempts to open the specified file on construction and close it on destruction.
         struct FileHandle
@@ -52,11 +69,6 @@ namespace Xidi
                 return fileHandle;
             }
 
-            inline FILE** operator&(void)
-            {
-                return &fileHandle;
-            }
-
             inline ~FileHandle(void)
             {
                 if (nullptr != fileHandle)
@@ -65,8 +77,32 @@ namespace Xidi
         };
 
 
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Maximum number of characters, including the terminating null character, that can make up the text representation of an integer-typed value.
+        static constexpr size_t kIntegerValueMaxCount = 64;
+
+
         // -------- INTERNAL FUNCTIONS ------------------------------------- //
 
+        /// Compares two strings for equality without regard to case.
+        /// @param [in] lhs First string to compare.
+        /// @param [in] rhs Second string to compare.
+        /// @return `true` if the strings are equal when case is ignored, `false` otherwise.
+        static bool EqualsCaseInsensitive(std::wstring_view lhs, std::wstring_view rhs)
+        {
+            if (lhs.length() != rhs.length())
+                return false;
+
+            for (size_t i = 0; i < lhs.length(); ++i)
+            {
+                if (towlower(lhs[i]) != towlower(rhs[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
         /// Tests if the supplied character is allowed as a configuration setting name (the part before the '=' sign in the configuration file).
         /// @param [in] charToTest Character to test.
         /// @return `true` if so, `false` if not.
@@ -156,84 +192,87 @@ namespace Xidi
             }
         }
 
-        /// Classifies the provided configuration file line and returns a value indicating the result.
-        /// @param [in] buf Buffer containing the configuration file line.
-        /// @param [in] length Number of characters in the buffer.
+        /// Classifies the provided configuration file line, extracts its tokens, and returns a value indicating the result.
+        /// Trailing whitespace must already have been removed from the line.
+        /// @param [in] line Configuration file line.
+        /// @param [out] tokens Filled with the tokens extracted from the line, depending on its classification.
         /// @return Configuration line classification.
-        static ELineClassification ClassifyConfigurationFileLine(const wchar_t* const buf, const int length)
+        static ELineClassification ClassifyConfigurationFileLine(std::wstring_view line, SLineTokens& tokens)
         {
             // Skip over all whitespace at the start of the input line.
-            const wchar_t* realBuf = buf;
-            int realLength = length;
-            while (realLength != 0 && iswblank(realBuf[0]))
-            {
-                realLength -= 1;
-                realBuf += 1;
-            }
+            while ((false == line.empty()) && iswblank(line.front()))
+                line.remove_prefix(1);
 
             // Sanity check: zero-length and all-whitespace lines can be safely ignored.
             // Also filter out comments this way.
-            if (0 == realLength || L';' == realBuf[0] || L'#' == realBuf[0])
+            if (line.empty() || L';' == line[0] || L'#' == line[0])
                 return ELineClassification::Ignore;
 
             // Non-comments must, by definition, have at least three characters in them, excluding all whitespace.
             // For section headers, this must mean '[' + section name + ']'.
             // For values, this must mean name + '=' + value.
-            if (realLength < 3)
+            if (line.length() < 3)
                 return ELineClassification::Error;
 
-            if (L'[' == realBuf[0])
+            if (L'[' == line[0])
             {
                 // The line cannot be a section header unless the second character is a valid section name character.
-                if (!IsAllowedSectionCharacter(realBuf[1]))
+                if (!IsAllowedSectionCharacter(line[1]))
                     return ELineClassification::Error;
 
                 // Verify that the line is a valid section header by checking for valid section name characters between two square brackets.
-                int i = 2;
-                for (; i < realLength && L']' != realBuf[i]; ++i)
+                size_t i = 2;
+                for (; i < line.length() && L']' != line[i]; ++i)
                 {
-                    if (!IsAllowedSectionCharacter(realBuf[i]))
+                    if (!IsAllowedSectionCharacter(line[i]))
                         return ELineClassification::Error;
                 }
-                if (L']' != realBuf[i])
+                if (i >= line.length())
                     return ELineClassification::Error;
 
+                tokens.section = line.substr(1, i - 1);
+
                 // Verify that the remainder of the line is just whitespace.
-                for (i += 1; i < realLength; ++i)
+                for (i += 1; i < line.length(); ++i)
                 {
-                    if (!iswblank(realBuf[i]))
+                    if (!iswblank(line[i]))
                         return ELineClassification::Error;
                 }
 
                 return ELineClassification::Section;
             }
-            else if (IsAllowedNameCharacter(realBuf[0]))
+            else if (IsAllowedNameCharacter(line[0]))
             {
                 // Search for whitespace or an equals sign, with all characters in between needing to be allowed as value name characters.
-                int i = 1;
-                for (; i < realLength && L'=' != realBuf[i] && !iswblank(realBuf[i]); ++i)
+                size_t i = 1;
+                for (; i < line.length() && L'=' != line[i] && !iswblank(line[i]); ++i)
                 {
-                    if (!IsAllowedNameCharacter(realBuf[i]))
+                    if (!IsAllowedNameCharacter(line[i]))
                         return ELineClassification::Error;
                 }
 
+                tokens.name = line.substr(0, i);
+
                 // Skip over any whitespace present, then check for an equals sign.
-                for (; i < realLength && iswblank(realBuf[i]); ++i);
-                if (L'=' != realBuf[i])
+                for (; i < line.length() && iswblank(line[i]); ++i);
+                if ((i >= line.length()) || (L'=' != line[i]))
                     return ELineClassification::Error;
 
                 // Skip over any whitespace present, then verify the next character is allowed to start a value setting.
-                for (i += 1; i < realLength && iswblank(realBuf[i]); ++i);
-                if (!IsAllowedValueCharacter(realBuf[i]))
+                for (i += 1; i < line.length() && iswblank(line[i]); ++i);
+                if ((i >= line.length()) || (!IsAllowedValueCharacter(line[i])))
                     return ELineClassification::Error;
 
                 // Skip over the value setting characters that follow.
-                for (i += 1; i < realLength && IsAllowedValueCharacter(realBuf[i]); ++i);
+                const size_t kValueStart = i;
+                for (i += 1; i < line.length() && IsAllowedValueCharacter(line[i]); ++i);
+
+                tokens.value = line.substr(kValueStart, i - kValueStart);
 
                 // Verify that the remainder of the line is just whitespace.
-                for (; i < realLength; ++i)
+                for (; i < line.length(); ++i)
                 {
-                    if (!iswblank(realBuf[i]))
+                    if (!iswblank(line[i]))
                         return ELineClassification::Error;
                 }
 
@@ -253,7 +292,7 @@ namespace Xidi
             va_list args;
             va_start(args, format);
 
-            vswprintf_s(buf, buf.Count(), format, args);
+            vswprintf(buf, buf.Count(), format, args);
 
             va_end(args);
 
@@ -266,13 +305,13 @@ namespace Xidi
         /// @return `true` if the parse was successful and able to consume the whole string, `false` otherwise.
         static bool ParseBoolean(const TStringValue& source, TBooleanValue* const dest)
         {
-            static const wchar_t* const trueStrings[] = { L"t", L"true", L"on", L"y", L"yes", L"enabled", L"1" };
-            static const wchar_t* const falseStrings[] = { L"f", L"false", L"off", L"n", L"no", L"disabled", L"0" };
+            static constexpr std::wstring_view trueStrings[] = { L"t", L"true", L"on", L"y", L"yes", L"enabled", L"1" };
+            static constexpr std::wstring_view falseStrings[] = { L"f", L"false", L"off", L"n", L"no", L"disabled", L"0" };
 
             // Check if the string represents a value of TRUE.
-            for (int i = 0; i < _countof(trueStrings); ++i)
+            for (unsigned int i = 0; i < _countof(trueStrings); ++i)
             {
-                if (0 == _wcsicmp(source.c_str(), trueStrings[i]))
+                if ((source.length() == trueStrings[i].length()) && (true == EqualsCaseInsensitive(source, trueStrings[i])))
                 {
                     *dest = (TBooleanValue)true;
                     return true;
@@ -280,9 +319,9 @@ namespace Xidi
             }
 
             // Check if the string represents a value of FALSE.
-            for (int i = 0; i < _countof(falseStrings); ++i)
+            for (unsigned int i = 0; i < _countof(falseStrings); ++i)
             {
-                if (0 == _wcsicmp(source.c_str(), falseStrings[i]))
+                if ((source.length() == falseStrings[i].length()) && (true == EqualsCaseInsensitive(source, falseStrings[i])))
                 {
                     *dest = (TBooleanValue)false;
                     return true;
@@ -298,11 +337,20 @@ namespace Xidi
         /// @return `true` if the parse was successful and able to consume the whole string, `false` otherwise.
         static bool ParseInteger(const TStringValue& source, TIntegerValue* const dest)
         {
+            // Integer parsing requires a null-terminated string, and source strings refer to the middle of a configuration file.
+            // Any string too long to fit in the local buffer cannot possibly be a valid integer.
+            if (source.length() >= kIntegerValueMaxCount)
+                return false;
+
+            wchar_t sourceBuffer[kIntegerValueMaxCount];
+            source.copy(sourceBuffer, source.length());
+            sourceBuffer[source.length()] = L'\0';
+
             intmax_t value = 0ll;
             wchar_t* endptr = nullptr;
 
             // Parse out a number in any representable base.
-            value = wcstoll(source.c_str(), &endptr, 0);
+            value = wcstoll(sourceBuffer, &endptr, 0);
 
             // Verify that the number is not out of range.
             if (ERANGE == errno && (LLONG_MIN == value || LLONG_MAX == value))
@@ -318,114 +366,121 @@ namespace Xidi
             return true;
         }
 
-        /// Parses a name and a value for the specified configuration file line, which must first have been classified as containing a value.
-        /// @param [in] configFileLine Buffer containing the configuration file line.
-        /// @param [out] nameString Filled with the name of the configuration setting.
-        /// @param [out] valueString Filled with the value specified for the configuration setting.
-        static void ParseNameAndValue(const wchar_t* const configFileLine, std::wstring& nameString, TStringValue& valueString)
+        /// Reads the entire contents of the specified file into memory and converts them to wide characters.
+        /// Conversion follows the same rules that apply when reading wide-character text one line at a time.
+        /// @param [in] filehandle Handle to the file from which to read.
+        /// @param [out] contents Filled with the contents of the file.
+        /// @return `true` if the contents were read and converted successfully, `false` otherwise.
+        static bool ReadFileContents(FILE* const filehandle, std::wstring& contents)
         {
-            // Skip to the start of the name part of the line.
-            const wchar_t* name = configFileLine;
-            while (iswblank(name[0]))
-                name += 1;
-
-            // Find the length of the configuration name.
-            int nameLength = 1;
-            while (IsAllowedNameCharacter(name[nameLength]))
-                nameLength += 1;
-
-            // Advance to the value portion of the string.
-            const wchar_t* value = &name[nameLength + 1];
-
-            // Skip over whitespace and the '=' sign.
-            while ((L'=' == value[0]) || (iswblank(value[0])))
-                value += 1;
-
-            // Find the length of the configuration value.
-            int valueLength = 1;
-            while (IsAllowedValueCharacter(value[valueLength]))
-                valueLength += 1;
-
-            nameString = std::move(std::wstring(name, nameLength));
-            valueString = std::move(TStringValue(value, valueLength));
-        }
+            if (0 != fseek(filehandle, 0, SEEK_END))
+                return false;
 
-        /// Parses a section name from the specified configuration file line, which must first have been classified as containing a section name.
-        /// @param [in] configFileLine Buffer containing the configuration file line.
-        /// @param [out] sectionString Filled with the name of the configuration section.
-        static void ParseSectionName(const wchar_t* const configFileLine, std::wstring& sectionString)
-        {
-            // Skip to the '[' character and then advance once more to the section name itself.
-            const wchar_t* section = configFileLine;
-            while (L'[' != section[0])
-                section += 1;
-            section += 1;
-
-            // Find the length of the section name.
-            int sectionLength = 1;
-            while (L']' != section[sectionLength])
-                sectionLength += 1;
-
-            sectionString = std::move(std::wstring(section, sectionLength));
-        }
+            // In text mode the file size is an upper bound on the number of characters that will actually be read.
+            const long kFileSize = ftell(filehandle);
+            if (kFileSize < 0)
+                return false;
 
-        /// Reads a single line from the specified file handle, verifies that it fits within the specified buffer, and removes trailing whitespace.
-        /// @param [in] filehandle Handle to the file from which to read.
-        /// @param [out] lineBuffer Filled with text read from the specified file.
-        /// @param [in] lineBufferCount Length, in character units, of the line buffer.
-        /// @return Length of the string that was read, with -1 indicating an error condition.
-        static int ReadAndTrimLine(FILE* const filehandle, wchar_t* const lineBuffer, const int lineBufferCount)
-        {
-            // Results in a null-terminated string guaranteed, but might not be the whole line if the buffer is too small.
-            if (lineBuffer != fgetws(lineBuffer, lineBufferCount, filehandle))
-                return -1;
+            rewind(filehandle);
+
+            std::unique_ptr<char[]> narrowContents = std::make_unique<char[]>((size_t)kFileSize + 1);
+            const size_t kNarrowCount = fread(narrowContents.get(), sizeof(char), (size_t)kFileSize, filehandle);
+            if (0 != ferror(filehandle))
+                return false;
 
-            // If the line fits in the buffer, then either its detected length is small by comparison to the buffer size or, if it perfectly fits in the buffer, then the last character is a newline.
-            int lineLength = (int)wcsnlen(lineBuffer, lineBufferCount);
-            if (((lineBufferCount - 1) == lineLength) && (L'\n' != lineBuffer[lineLength - 1]))
-                return -1;
+            narrowContents[kNarrowCount] = '\0';
 
-            // Trim off any whitespace on the end of the line.
-            while (iswspace(lineBuffer[lineLength - 1]))
-                lineLength -= 1;
+            // Neither the required count nor the converted count includes the terminating null character.
+            const size_t kWideCount = mbstowcs(nullptr, narrowContents.get(), 0);
+            if ((size_t)-1 == kWideCount)
+                return false;
 
-            lineBuffer[lineLength] = L'\0';
+            contents.resize(kWideCount + 1);
+            if (kWideCount != mbstowcs(contents.data(), narrowContents.get(), contents.size()))
+                return false;
 
-            return lineLength;
+            contents.resize(kWideCount);
+            return true;
         }
 
 
-        // -------- INSTANCE METHODS --------------------------------------- //
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
         // See "Configuration.h" for documentation.
 
-        EFileReadResult ConfigurationFileReader::ReadConfigurationFile(std::wstring_view configFileName, ConfigurationData& configToFill)
+        std::wstring_view ConfigurationData::InternString(std::wstring_view str)
         {
-            FileHandle configFileHandle;
-            _wfopen_s(&configFileHandle, configFileName.data(), L"r");
+            if (str.empty())
+                return std::wstring_view();
 
-            if (nullptr == configFileHandle)
+            const auto internedStringIterator = internedStrings.find(str);
+            if (internedStrings.end() != internedStringIterator)
+                return *internedStringIterator;
+
+            wchar_t* internedStringBuffer = nullptr;
+
+            if (str.length() > kStringArenaBlockCount)
             {
-                FormatString(readErrorMessage, L"%s - Unable to open configuration file.", configFileName.data());
-                return EFileReadResult::FileNotFound;
+                // Long strings get their own blocks. These are placed at the front so that the most recent block, from which short strings are allocated, remains at the back.
+                stringArenaBlocks.emplace(stringArenaBlocks.begin(), std::make_unique<wchar_t[]>(str.length()));
+                internedStringBuffer = stringArenaBlocks.front().get();
+            }
+            else
+            {
+                if ((kStringArenaBlockCount - stringArenaBlockUsedCount) < str.length())
+                {
+                    stringArenaBlocks.emplace_back(std::make_unique<wchar_t[]>(kStringArenaBlockCount));
+                    stringArenaBlockUsedCount = 0;
+                }
+
+                internedStringBuffer = &stringArenaBlocks.back()[stringArenaBlockUsedCount];
+                stringArenaBlockUsedCount += str.length();
             }
 
+            str.copy(internedStringBuffer, str.length());
+
+            const std::wstring_view internedString(internedStringBuffer, str.length());
+            internedStrings.insert(internedString);
+            return internedString;
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "Configuration.h" for documentation.
+
+        EFileReadResult ConfigurationFileReader::ReadConfigurationBuffer(std::wstring_view configSourceName, std::wstring_view configBuffer, ConfigurationData& configToFill)
+        {
             PrepareForRead();
+            configToFill.Clear();
 
-            // Parse the configuration file, one line at a time.
-            std::unordered_set<std::wstring> seenSections;
-            std::wstring thisSection = kSectionNameGlobal;
+            // All tokens refer directly to the configuration buffer, so nothing is copied until values are actually inserted.
+            std::unordered_set<std::wstring_view> seenSections;
+            std::set<std::pair<std::wstring_view, std::wstring_view>> seenSingleValueSettings;
+            std::wstring_view thisSection = kSectionNameGlobal;
 
-            int configLineNumber = 1;
-            TemporaryBuffer<wchar_t> configLineBuffer;
-            int configLineLength = ReadAndTrimLine(configFileHandle, configLineBuffer, configLineBuffer.Count());
+            int configLineNumber = 0;
             bool skipValueLines = false;
 
-            while (configLineLength >= 0)
+            for (size_t configLineStart = 0; configLineStart < configBuffer.length(); )
             {
-                switch (ClassifyConfigurationFileLine(configLineBuffer, configLineLength))
+                configLineNumber += 1;
+
+                size_t configLineEnd = configBuffer.find(L'\n', configLineStart);
+                if (std::wstring_view::npos == configLineEnd)
+                    configLineEnd = configBuffer.length();
+
+                std::wstring_view configLine = configBuffer.substr(configLineStart, configLineEnd - configLineStart);
+                configLineStart = configLineEnd + 1;
+
+                // Trim off any whitespace on the end of the line.
+                while ((false == configLine.empty()) && iswspace(configLine.back()))
+                    configLine.remove_suffix(1);
+
+                SLineTokens configLineTokens;
+
+                switch (ClassifyConfigurationFileLine(configLine, configLineTokens))
                 {
                 case ELineClassification::Error:
-                    FormatString(readErrorMessage, L"%s:%d - Unable to parse line.", configFileName.data(), configLineNumber);
+                    FormatString(readErrorMessage, L"%s:%d - Unable to parse line.", configSourceName.data(), configLineNumber);
                     return EFileReadResult::Malformed;
 
                 case ELineClassification::Ignore:
@@ -433,12 +488,11 @@ namespace Xidi
 
                 case ELineClassification::Section:
                 {
-                    std::wstring section;
-                    ParseSectionName(configLineBuffer, section);
+                    const std::wstring_view section = configLineTokens.section;
 
                     if (0 != seenSections.count(section))
                     {
-                        FormatString(readErrorMessage, L"%s:%d - Section \"%s\" is duplicated.", configFileName.data(), configLineNumber, section.c_str());
+                        FormatString(readErrorMessage, L"%s:%d - Section \"%.*s\" is duplicated.", configSourceName.data(), configLineNumber, (int)section.length(), section.data());
                         return EFileReadResult::Malformed;
                     }
 
@@ -446,11 +500,11 @@ namespace Xidi
                     switch (sectionAction)
                     {
                     case ESectionAction::Error:
-                        FormatString(readErrorMessage, L"%s:%d - Section \"%s\" is invalid.", configFileName.data(), configLineNumber, section.c_str());
+                        FormatString(readErrorMessage, L"%s:%d - Section \"%.*s\" is invalid.", configSourceName.data(), configLineNumber, (int)section.length(), section.data());
                         return EFileReadResult::Malformed;
 
                     case ESectionAction::Read:
-                        thisSection = std::move(section);
+                        thisSection = section;
                         seenSections.insert(thisSection);
                         skipValueLines = false;
                         break;
@@ -460,7 +514,7 @@ namespace Xidi
                         break;
 
                     default:
-                        FormatString(readErrorMessage, L"%s:%d - Internal error while processing section name.", configFileName.data(), configLineNumber);
+                        FormatString(readErrorMessage, L"%s:%d - Internal error while processing section name.", configSourceName.data(), configLineNumber);
                         return EFileReadResult::Malformed;
                     }
                 }
@@ -469,9 +523,8 @@ namespace Xidi
                 case ELineClassification::Value:
                     if (false == skipValueLines)
                     {
-                        std::wstring name;
-                        TStringValue value;
-                        ParseNameAndValue(configLineBuffer, name, value);
+                        const std::wstring_view name = configLineTokens.name;
+                        const TStringValue value = configLineTokens.value;
 
                         const EValueType valueType = TypeForValue(thisSection, name);
 
@@ -481,9 +534,9 @@ namespace Xidi
                         case EValueType::Integer:
                         case EValueType::Boolean:
                         case EValueType::String:
-                            if (configToFill.SectionNamePairExists(thisSection, name))
+                            if (false == seenSingleValueSettings.emplace(thisSection, name).second)
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%s\" only supports a single value.", configFileName.data(), configLineNumber, name.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%.*s\" only supports a single value.", configSourceName.data(), configLineNumber, (int)name.length(), name.data());
                                 return EFileReadResult::Malformed;
                             }
 
@@ -495,7 +548,7 @@ namespace Xidi
                         switch (valueType)
                         {
                         case EValueType::Error:
-                            FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%s\" is invalid.", configFileName.data(), configLineNumber, name.c_str());
+                            FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%.*s\" is invalid.", configSourceName.data(), configLineNumber, (int)name.length(), name.data());
                             return EFileReadResult::Malformed;
 
                         case EValueType::Integer:
@@ -505,19 +558,19 @@ namespace Xidi
 
                             if (false == ParseInteger(value, &intValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Value \"%s\" is not a valid integer.", configFileName.data(), configLineNumber, value.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Value \"%.*s\" is not a valid integer.", configSourceName.data(), configLineNumber, (int)value.length(), value.data());
                                 return EFileReadResult::Malformed;
                             }
 
                             if (false == CheckValue(thisSection, name, intValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%s\" with value \"%s\" is invalid.", configFileName.data(), configLineNumber, name.c_str(), value.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%.*s\" with value \"%.*s\" is invalid.", configSourceName.data(), configLineNumber, (int)name.length(), name.data(), (int)value.length(), value.data());
                                 return EFileReadResult::Malformed;
                             }
 
                             if (false == configToFill.Insert(thisSection, name, intValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Value \"%s\" for configuration setting \"%s\" is duplicated.", configFileName.data(), configLineNumber, value.c_str(), name.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Value \"%.*s\" for configuration setting \"%.*s\" is duplicated.", configSourceName.data(), configLineNumber, (int)value.length(), value.data(), (int)name.length(), name.data());
                                 return EFileReadResult::Malformed;
                             }
                         }
@@ -530,19 +583,19 @@ namespace Xidi
 
                             if (false == ParseBoolean(value, &boolValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Value \"%s\" is not a valid Boolean.", configFileName.data(), configLineNumber, value.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Value \"%.*s\" is not a valid Boolean.", configSourceName.data(), configLineNumber, (int)value.length(), value.data());
                                 return EFileReadResult::Malformed;
                             }
 
                             if (false == CheckValue(thisSection, name, boolValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%s\" with value \"%s\" is invalid.", configFileName.data(), configLineNumber, name.c_str(), value.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%.*s\" with value \"%.*s\" is invalid.", configSourceName.data(), configLineNumber, (int)name.length(), name.data(), (int)value.length(), value.data());
                                 return EFileReadResult::Malformed;
                             }
 
                             if (false == configToFill.Insert(thisSection, name, boolValue))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Value \"%s\" for configuration setting \"%s\" is duplicated.", configFileName.data(), configLineNumber, value.c_str(), name.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Value \"%.*s\" for configuration setting \"%.*s\" is duplicated.", configSourceName.data(), configLineNumber, (int)value.length(), value.data(), (int)name.length(), name.data());
                                 return EFileReadResult::Malformed;
                             }
                         }
@@ -552,58 +605,173 @@ namespace Xidi
                         case EValueType::StringMultiValue:
                             if (false == CheckValue(thisSection, name, value))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%s\" with value \"%s\" is invalid.", configFileName.data(), configLineNumber, name.c_str(), value.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Configuration setting \"%.*s\" with value \"%.*s\" is invalid.", configSourceName.data(), configLineNumber, (int)name.length(), name.data(), (int)value.length(), value.data());
                                 return EFileReadResult::Malformed;
                             }
 
                             if (false == configToFill.Insert(thisSection, name, value))
                             {
-                                FormatString(readErrorMessage, L"%s:%d - Value \"%s\" for configuration setting \"%s\" is duplicated.", configFileName.data(), configLineNumber, value.c_str(), name.c_str());
+                                FormatString(readErrorMessage, L"%s:%d - Value \"%.*s\" for configuration setting \"%.*s\" is duplicated.", configSourceName.data(), configLineNumber, (int)value.length(), value.data(), (int)name.length(), name.data());
                                 return EFileReadResult::Malformed;
                             }
                             break;
 
                         default:
-                            FormatString(readErrorMessage, L"%s:%d - Internal error while processing configuration setting.", configFileName.data(), configLineNumber);
+                            FormatString(readErrorMessage, L"%s:%d - Internal error while processing configuration setting.", configSourceName.data(), configLineNumber);
                             return EFileReadResult::Malformed;
                         }
                     }
                     break;
 
                 default:
-                    FormatString(readErrorMessage, L"%s:%d - Internal error while processing line.", configFileName.data(), configLineNumber);
+                    FormatString(readErrorMessage, L"%s:%d - Internal error while processing line.", configSourceName.data(), configLineNumber);
                     return EFileReadResult::Malformed;
                 }
+            }
 
-                configLineLength = ReadAndTrimLine(configFileHandle, configLineBuffer, configLineBuffer.Count());
-                configLineNumber += 1;
+            configToFill.Build();
+
+            std::wstring errorDescription;
+            if (false == CheckConfiguration(configToFill, errorDescription))
+            {
+                FormatString(readErrorMessage, L"%s - %s", configSourceName.data(), errorDescription.c_str());
+                return EFileReadResult::Malformed;
             }
 
-            if (!feof(configFileHandle))
+            return EFileReadResult::Success;
+        }
+
+        // --------
+
+        EFileReadResult ConfigurationFileReader::ReadConfigurationFile(std::wstring_view configFileName, ConfigurationData& configToFill)
+        {
+            const FileHandle configFileHandle = {.fileHandle = Platform::OpenFile(configFileName.data(), L"r")};
+
+            if (nullptr == configFileHandle)
             {
-                // Stopped reading the configuration file early due to some condition other than end-of-file.
-                // This indicates an error.
+                FormatString(readErrorMessage, L"%s - Unable to open configuration file.", configFileName.data());
+                return EFileReadResult::FileNotFound;
+            }
 
-                if (ferror(configFileHandle))
-                {
-                    FormatString(readErrorMessage, L"%s - I/O error while reading.", configFileName.data(), configLineNumber);
-                    return EFileReadResult::Malformed;
+            // The whole file is read at once, so there is no limit on line length.
+            std::wstring configBuffer;
+            if (false == ReadFileContents(configFileHandle, configBuffer))
+            {
+                FormatString(readErrorMessage, L"%s - I/O error while reading.", configFileName.data());
+                return EFileReadResult::Malformed;
+            }
+
+            return ReadConfigurationBuffer(configFileName, configBuffer, configToFill);
+        }
+
+        // --------
+
+        void ConfigurationData::Build(void)
+        {
+            values.clear();
+            names.clear();
+            sections.clear();
+
+            // Pending values are already sorted by section, then by name, then by value.
+            // All values are laid out first so that configuration settings can refer to their final storage locations.
+            values.reserve(pendingValues.size());
+            for (const auto& pendingValue : pendingValues)
+                values.push_back(pendingValue.value);
+
+            // Each run of values that share a section and name becomes one configuration setting.
+            std::vector<std::wstring_view> nameSections;
+            size_t valueIndex = 0;
+
+            for (auto pendingValueIterator = pendingValues.cbegin(); pendingValues.cend() != pendingValueIterator; )
+            {
+                const std::wstring_view kSection = pendingValueIterator->section;
+                const std::wstring_view kName = pendingValueIterator->name;
+                const size_t kFirstValueIndex = valueIndex;
+
+                for (; (pendingValues.cend() != pendingValueIterator) && (kSection == pendingValueIterator->section) && (kName == pendingValueIterator->name); ++pendingValueIterator)
+                    valueIndex += 1;
+
+                names.emplace_back(kName, std::span<const Value>(&values[kFirstValueIndex], valueIndex - kFirstValueIndex));
+                nameSections.push_back(kSection);
+            }
+
+            // Each run of configuration settings that share a section becomes one section.
+            for (size_t nameIndex = 0; nameIndex < names.size(); )
+            {
+                const size_t kFirstNameIndex = nameIndex;
+
+                for (; (nameIndex < names.size()) && (nameSections[kFirstNameIndex] == nameSections[nameIndex]); ++nameIndex);
+
+                sections.emplace_back(nameSections[kFirstNameIndex], std::span<const Name>(&names[kFirstNameIndex], nameIndex - kFirstNameIndex));
+            }
+
+            pendingValues.clear();
+        }
+
+        // --------
+
+        void ConfigurationData::Clear(void)
+        {
+            sections.clear();
+            names.clear();
+            values.clear();
+            pendingValues.clear();
+            internedStrings.clear();
+            stringArenaBlocks.clear();
+            stringArenaBlockUsedCount = kStringArenaBlockCount;
+        }
 
+        // --------
+
+        const Section* ConfigurationData::FindSection(std::wstring_view section) const
+        {
+            const auto sectionIterator = std::lower_bound(sections.cbegin(), sections.cend(), section, [](const Section& candidate, std::wstring_view section) -> bool
+                {
+                    return (candidate.GetName() < section);
                 }
-                else if (configLineLength < 0)
+            );
+
+            if ((sections.cend() == sectionIterator) || (sectionIterator->GetName() != section))
+                return nullptr;
+
+            return &(*sectionIterator);
+        }
+
+        // --------
+
+        bool ConfigurationData::Insert(std::wstring_view section, std::wstring_view name, const Value& value)
+        {
+            const Value kInternedValue = ((EValueType::String == value.GetType()) ? Value(InternString(value.GetStringValue())) : value);
+            return pendingValues.insert({.section = InternString(section), .name = InternString(name), .value = kInternedValue}).second;
+        }
+
+        // --------
+
+        const Name* Section::FindName(std::wstring_view name) const
+        {
+            const auto nameIterator = std::lower_bound(names.begin(), names.end(), name, [](const Name& candidate, std::wstring_view name) -> bool
                 {
-                    FormatString(readErrorMessage, L"%s:%d - Line is too long.", configFileName.data(), configLineNumber);
-                    return EFileReadResult::Malformed;
+                    return (candidate.GetName() < name);
                 }
-            }
+            );
 
-            return EFileReadResult::Success;
+            if ((names.end() == nameIterator) || (nameIterator->GetName() != name))
+                return nullptr;
+
+            return &(*nameIterator);
         }
 
 
         // -------- CONCRETE INSTANCE METHODS ------------------------------ //
         // See "Configuration.h" for documentation.
 
+        bool ConfigurationFileReader::CheckConfiguration(const ConfigurationData&, std::wstring&)
+        {
+            return true;
+        }
+
+        // --------
+
         void ConfigurationFileReader::PrepareForRead(void)
         {
             // Nothing to do here.
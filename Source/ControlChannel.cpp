@@ -0,0 +1,371 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControlChannel.cpp
+ *   Implementation of local line-oriented connections through which external
+ *   tools control and query a running process. Windows builds use named
+ *   pipes, and all other builds use UNIX domain sockets.
+ *****************************************************************************/
+
+#include "ControlChannel.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include "ApiWindows.h"
+#else
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+
+namespace Xidi
+{
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Value of a platform handle that does not refer to anything.
+    static constexpr intptr_t kInvalidHandle = -1;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Creates the platform object on which a listener waits for clients.
+    /// @param [in] endpointName Name of the endpoint.
+    /// @return Platform handle, or #kInvalidHandle on failure.
+    static intptr_t CreateListenHandle(const std::string& endpointName)
+    {
+#ifdef _WIN32
+        const HANDLE kPipe = CreateNamedPipeA(endpointName.c_str(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, nullptr);
+        if (INVALID_HANDLE_VALUE == kPipe)
+            return kInvalidHandle;
+
+        return (intptr_t)kPipe;
+#else
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (endpointName.length() >= sizeof(address.sun_path))
+            return kInvalidHandle;
+
+        std::memcpy(address.sun_path, endpointName.c_str(), endpointName.length() + 1);
+
+        const int kSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (kSocket < 0)
+            return kInvalidHandle;
+
+        // A previous process with the same PID may have exited without removing its socket.
+        unlink(endpointName.c_str());
+
+        if ((0 != bind(kSocket, (const sockaddr*)&address, sizeof(address))) || (0 != chmod(endpointName.c_str(), S_IRUSR | S_IWUSR)) || (0 != listen(kSocket, 1)))
+        {
+            close(kSocket);
+            unlink(endpointName.c_str());
+            return kInvalidHandle;
+        }
+
+        return (intptr_t)kSocket;
+#endif
+    }
+
+    /// Destroys a platform handle.
+    /// @param [in] handle Platform handle to destroy.
+    static void CloseHandleIfValid(intptr_t handle)
+    {
+        if (kInvalidHandle == handle)
+            return;
+
+#ifdef _WIN32
+        CloseHandle((HANDLE)handle);
+#else
+        close((int)handle);
+#endif
+    }
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Connection to a single client of a #LocalControlListener.
+    class LocalControlConnection : public IControlConnection
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Platform handle of the connection. Owned by this object.
+        const intptr_t kHandle;
+
+        /// Bytes received from the client that are not yet part of a complete line.
+        std::string pendingData;
+
+        /// Whether the connection has been closed.
+        std::atomic<bool> closed;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// @param [in] handle Platform handle of the connection. Ownership is transferred.
+        inline LocalControlConnection(intptr_t handle) : kHandle(handle), pendingData(), closed(false)
+        {
+            // Nothing to do here.
+        }
+
+        /// Copy constructor. Should never be invoked.
+        LocalControlConnection(const LocalControlConnection& other) = delete;
+
+        /// Default destructor.
+        ~LocalControlConnection(void) override
+        {
+            Close();
+            CloseHandleIfValid(kHandle);
+        }
+
+
+    private:
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+
+        /// Reads whatever bytes are available from the client, blocking until at least one is.
+        /// @param [out] buffer Buffer to fill.
+        /// @param [in] bufferSize Size of the buffer, in bytes.
+        /// @return Number of bytes read, or 0 if the connection was closed or failed.
+        size_t ReadSome(char* buffer, size_t bufferSize)
+        {
+#ifdef _WIN32
+            DWORD numBytesRead = 0;
+            if (FALSE == ReadFile((HANDLE)kHandle, buffer, (DWORD)bufferSize, &numBytesRead, nullptr))
+                return 0;
+
+            return (size_t)numBytesRead;
+#else
+            const ssize_t kNumBytesRead = recv((int)kHandle, buffer, bufferSize, 0);
+            if (kNumBytesRead <= 0)
+                return 0;
+
+            return (size_t)kNumBytesRead;
+#endif
+        }
+
+        /// Writes all of the specified bytes to the client.
+        /// @param [in] data Bytes to write.
+        /// @return `true` if all bytes were written, `false` otherwise.
+        bool WriteAll(std::string_view data)
+        {
+            while (false == data.empty())
+            {
+#ifdef _WIN32
+                DWORD numBytesWritten = 0;
+                if ((FALSE == WriteFile((HANDLE)kHandle, data.data(), (DWORD)data.length(), &numBytesWritten, nullptr)) || (0 == numBytesWritten))
+                    return false;
+#else
+                // Writing to a client that disconnected must fail rather than raise a signal that terminates the application.
+                const ssize_t numBytesWritten = send((int)kHandle, data.data(), data.length(), MSG_NOSIGNAL);
+                if (numBytesWritten <= 0)
+                    return false;
+#endif
+
+                data.remove_prefix((size_t)numBytesWritten);
+            }
+
+            return true;
+        }
+
+
+    public:
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void Close(void) override
+        {
+            if (true == closed.exchange(true))
+                return;
+
+#ifdef _WIN32
+            // Cancels a read in progress, and disconnecting makes any subsequent read fail immediately rather than block.
+            CancelIoEx((HANDLE)kHandle, nullptr);
+            DisconnectNamedPipe((HANDLE)kHandle);
+#else
+            shutdown((int)kHandle, SHUT_RDWR);
+#endif
+        }
+
+        // --------
+
+        bool ReadLine(std::string& line) override
+        {
+            while (true)
+            {
+                const size_t kLineEnd = pendingData.find('\n');
+                if (std::string::npos != kLineEnd)
+                {
+                    if (kLineEnd > LocalControlListener::kMaxLineLength)
+                        return false;
+
+                    line.assign(pendingData, 0, kLineEnd);
+                    pendingData.erase(0, kLineEnd + 1);
+
+                    if ((false == line.empty()) && ('\r' == line.back()))
+                        line.pop_back();
+
+                    return true;
+                }
+
+                if (pendingData.length() > LocalControlListener::kMaxLineLength)
+                    return false;
+
+                char buffer[256];
+                const size_t kNumBytesRead = ReadSome(buffer, sizeof(buffer));
+                if (0 == kNumBytesRead)
+                    return false;
+
+                pendingData.append(buffer, kNumBytesRead);
+            }
+        }
+
+        // --------
+
+        bool WriteLine(std::string_view line) override
+        {
+            if (true == closed.load())
+                return false;
+
+            std::string lineWithTerminator(line);
+            lineWithTerminator.push_back('\n');
+            return WriteAll(lineWithTerminator);
+        }
+    };
+
+
+    // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
+    // See "ControlChannel.h" for documentation.
+
+    LocalControlListener::LocalControlListener(uint32_t processId) : kEndpointName(EndpointName(processId)), listenerMutex(), closed(false), abandoned(false), listenHandle(CreateListenHandle(kEndpointName))
+    {
+        // Nothing to do here.
+    }
+
+    // --------
+
+    LocalControlListener::~LocalControlListener(void)
+    {
+        if (false == abandoned)
+            Close();
+
+        CloseHandleIfValid(listenHandle);
+
+#ifndef _WIN32
+        if (kInvalidHandle != listenHandle)
+            unlink(kEndpointName.c_str());
+#endif
+    }
+
+
+    // -------- CLASS METHODS ---------------------------------------------- //
+    // See "ControlChannel.h" for documentation.
+
+    std::string LocalControlListener::EndpointName(uint32_t processId)
+    {
+#ifdef _WIN32
+        return std::string("\\\\.\\pipe\\Xidi.Control.") + std::to_string(processId);
+#else
+        // The per-user runtime directory is preferred because only its owner can reach it.
+        const char* const kRuntimeDirectory = std::getenv("XDG_RUNTIME_DIR");
+        const std::string kDirectory = (((nullptr != kRuntimeDirectory) && ('\0' != kRuntimeDirectory[0])) ? kRuntimeDirectory : "/tmp");
+        return kDirectory + "/xidi-control." + std::to_string(processId) + ".sock";
+#endif
+    }
+
+
+    // -------- CONCRETE INSTANCE METHODS ---------------------------------- //
+    // See "ControlChannel.h" for documentation.
+
+    void LocalControlListener::Abandon(void)
+    {
+        abandoned = true;
+        closed = true;
+
+        CloseHandleIfValid(listenHandle);
+
+#ifndef _WIN32
+        if (kInvalidHandle != listenHandle)
+            unlink(kEndpointName.c_str());
+#endif
+
+        listenHandle = kInvalidHandle;
+    }
+
+    // --------
+
+    std::unique_ptr<IControlConnection> LocalControlListener::Accept(void)
+    {
+        intptr_t handleToWaitOn = kInvalidHandle;
+
+        {
+            std::scoped_lock lock(listenerMutex);
+            if (true == closed)
+                return nullptr;
+
+            handleToWaitOn = listenHandle;
+        }
+
+        if (kInvalidHandle == handleToWaitOn)
+            return nullptr;
+
+#ifdef _WIN32
+        if ((FALSE == ConnectNamedPipe((HANDLE)handleToWaitOn, nullptr)) && (ERROR_PIPE_CONNECTED != GetLastError()))
+            return nullptr;
+
+        // Each pipe instance serves one client, so the connected instance is handed to the connection and a new instance takes its place.
+        std::scoped_lock lock(listenerMutex);
+
+        // Closing the listener connects to the pipe to wake this thread, in which case there is no real client.
+        if (true == closed)
+            return nullptr;
+
+        listenHandle = CreateListenHandle(kEndpointName);
+        return std::make_unique<LocalControlConnection>(handleToWaitOn);
+#else
+        const int kConnectedSocket = accept4((int)handleToWaitOn, nullptr, nullptr, SOCK_CLOEXEC);
+        if (kConnectedSocket < 0)
+            return nullptr;
+
+        return std::make_unique<LocalControlConnection>((intptr_t)kConnectedSocket);
+#endif
+    }
+
+    // --------
+
+    void LocalControlListener::Close(void)
+    {
+        std::scoped_lock lock(listenerMutex);
+
+        if (true == closed)
+            return;
+
+        closed = true;
+
+        if (kInvalidHandle == listenHandle)
+            return;
+
+#ifdef _WIN32
+        // Waiting for a client cannot be cancelled without a race, so instead the wait is satisfied by briefly connecting as a client.
+        const HANDLE kWakeClient = CreateFileA(kEndpointName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (INVALID_HANDLE_VALUE != kWakeClient)
+            CloseHandle(kWakeClient);
+#else
+        // Shutting down a listening socket makes any current or future wait for a client fail immediately.
+        shutdown((int)listenHandle, SHUT_RDWR);
+#endif
+    }
+}
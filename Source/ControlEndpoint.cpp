@@ -0,0 +1,527 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControlEndpoint.cpp
+ *   Implementation of the endpoint through which external tools query and
+ *   tune running virtual controllers.
+ *****************************************************************************/
+
+#include "ControlChannel.h"
+#include "ControlEndpoint.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "Statistics.h"
+#include "VirtualController.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Names of axes as they appear in requests and responses, indexed by #EAxis.
+        static constexpr std::string_view kAxisNames[] = {
+            "X",
+            "Y",
+            "Z",
+            "RotX",
+            "RotY",
+            "RotZ"
+        };
+        static_assert(_countof(kAxisNames) == (int)EAxis::Count, "Axis name table mismatch.");
+
+        /// Names of POV directions as they appear in responses, indexed by #EPovDirection.
+        static constexpr std::string_view kPovDirectionNames[] = {
+            "up",
+            "down",
+            "left",
+            "right"
+        };
+        static_assert(_countof(kPovDirectionNames) == (int)EPovDirection::Count, "POV direction name table mismatch.");
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Generates an error response.
+        /// @param [in] reason Human-readable reason for the error.
+        /// @return Error response line.
+        static inline std::string ErrorResponse(std::string_view reason)
+        {
+            return std::string("ERR ") + std::string(reason);
+        }
+
+        /// Parses an integer, which must make up the entire string.
+        /// @tparam IntegerType Type of integer to parse.
+        /// @param [in] integerString String to parse.
+        /// @return Parsed integer, or no value if the string is not entirely a valid integer of the requested type.
+        template <typename IntegerType> static std::optional<IntegerType> ParseInteger(std::string_view integerString)
+        {
+            IntegerType value = 0;
+
+            const std::from_chars_result kResult = std::from_chars(integerString.data(), integerString.data() + integerString.length(), value);
+            if ((std::errc() != kResult.ec) || ((integerString.data() + integerString.length()) != kResult.ptr))
+                return std::nullopt;
+
+            return value;
+        }
+
+        /// Splits a string into words separated by any number of spaces.
+        /// @param [in] line String to split.
+        /// @return Words in the string, in order.
+        static std::vector<std::string_view> SplitWords(std::string_view line)
+        {
+            std::vector<std::string_view> words;
+
+            while (false == line.empty())
+            {
+                const size_t kWordStart = line.find_first_not_of(' ');
+                if (std::string_view::npos == kWordStart)
+                    break;
+
+                line.remove_prefix(kWordStart);
+
+                const size_t kWordLength = std::min(line.find(' '), line.length());
+                words.push_back(line.substr(0, kWordLength));
+                line.remove_prefix(kWordLength);
+            }
+
+            return words;
+        }
+
+        /// Converts a mapper name to the narrow representation used in responses.
+        /// Mapper names consist of printable ASCII characters, so each character maps directly.
+        /// @param [in] mapperName Mapper name to convert.
+        /// @return Converted mapper name.
+        static std::string NarrowMapperName(std::wstring_view mapperName)
+        {
+            std::string narrowMapperName;
+            narrowMapperName.reserve(mapperName.length());
+
+            for (const wchar_t kCharacter : mapperName)
+                narrowMapperName.push_back(((kCharacter > L' ') && (kCharacter < 0x7f)) ? (char)kCharacter : '?');
+
+            return narrowMapperName;
+        }
+
+        /// Converts a mapper name received in a request to the wide representation used to look up mappers.
+        /// @param [in] mapperName Mapper name to convert.
+        /// @return Converted mapper name.
+        static std::wstring WidenMapperName(std::string_view mapperName)
+        {
+            return std::wstring(mapperName.begin(), mapperName.end());
+        }
+
+        /// Parses the property changes in a `set` request.
+        /// @param [in] assignments Words of the request that follow the controller identifier, each of the form `name=value`.
+        /// @param [out] changes Property changes, filled in as parsing proceeds.
+        /// @return Empty string on success, or a human-readable reason for failure.
+        static std::string ParsePropertyChanges(const std::vector<std::string_view>& assignments, VirtualController::SPropertyChanges& changes)
+        {
+            if (true == assignments.empty())
+                return "no properties specified";
+
+            bool hasAxisPropertyChange = false;
+
+            for (const std::string_view kAssignment : assignments)
+            {
+                const size_t kSeparator = kAssignment.find('=');
+                if ((std::string_view::npos == kSeparator) || (0 == kSeparator) || ((kAssignment.length() - 1) == kSeparator))
+                    return std::string("malformed assignment ") + std::string(kAssignment);
+
+                const std::string_view kName = kAssignment.substr(0, kSeparator);
+                const std::string_view kValue = kAssignment.substr(kSeparator + 1);
+                std::optional<uint32_t> unsignedValue = std::nullopt;
+
+                if ("axis" == kName)
+                {
+                    const auto kAxisIter = std::find(std::begin(kAxisNames), std::end(kAxisNames), kValue);
+                    if (std::end(kAxisNames) == kAxisIter)
+                        return std::string("unknown axis ") + std::string(kValue);
+
+                    changes.axis = (EAxis)(kAxisIter - std::begin(kAxisNames));
+                }
+                else if ("range" == kName)
+                {
+                    const size_t kComma = kValue.find(',');
+                    const std::optional<int32_t> kRangeMin = ((std::string_view::npos == kComma) ? std::nullopt : ParseInteger<int32_t>(kValue.substr(0, kComma)));
+                    const std::optional<int32_t> kRangeMax = ((std::string_view::npos == kComma) ? std::nullopt : ParseInteger<int32_t>(kValue.substr(kComma + 1)));
+                    if ((false == kRangeMin.has_value()) || (false == kRangeMax.has_value()))
+                        return std::string("malformed range ") + std::string(kValue);
+
+                    changes.range = std::make_pair(*kRangeMin, *kRangeMax);
+                    hasAxisPropertyChange = true;
+                }
+                else if ("mapper" == kName)
+                {
+                    changes.mapper = Mapper::GetByName(WidenMapperName(kValue));
+                    if (nullptr == changes.mapper)
+                        return std::string("unknown mapper ") + std::string(kValue);
+                }
+                else if (false == (unsignedValue = ParseInteger<uint32_t>(kValue)).has_value())
+                {
+                    return std::string("malformed value ") + std::string(kAssignment);
+                }
+                else if ("deadzone" == kName)
+                {
+                    changes.deadzone = unsignedValue;
+                    hasAxisPropertyChange = true;
+                }
+                else if ("saturation" == kName)
+                {
+                    changes.saturation = unsignedValue;
+                    hasAxisPropertyChange = true;
+                }
+                else if ("granularity" == kName)
+                {
+                    changes.granularity = unsignedValue;
+                    hasAxisPropertyChange = true;
+                }
+                else if ("hysteresis" == kName)
+                {
+                    changes.hysteresis = unsignedValue;
+                    hasAxisPropertyChange = true;
+                }
+                else if ("ffgain" == kName)
+                {
+                    changes.ffGain = unsignedValue;
+                }
+                else if ("buffer" == kName)
+                {
+                    changes.eventBufferCapacity = unsignedValue;
+                }
+                else
+                {
+                    return std::string("unknown property ") + std::string(kName);
+                }
+            }
+
+            if ((true == changes.axis.has_value()) && (false == hasAxisPropertyChange))
+                return "axis specified without any axis properties";
+
+            return std::string();
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "ControlEndpoint.h" for documentation.
+
+        ControlEndpoint::ControlEndpoint(void) : controllers(), controllersMutex(), listener(), activeConnection(nullptr), servingMutex(), servingWorker()
+        {
+            // Nothing to do here.
+        }
+
+        // --------
+
+        ControlEndpoint::~ControlEndpoint(void)
+        {
+            Stop();
+        }
+
+
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+        // See "ControlEndpoint.h" for documentation.
+
+        std::vector<VirtualController*> ControlEndpoint::FindControllersLocked(std::string_view controllerIdString) const
+        {
+            if ("all" == controllerIdString)
+                return controllers;
+
+            std::vector<VirtualController*> matchingControllers;
+
+            const std::optional<VirtualController::TControllerIdentifier> kControllerId = ParseInteger<VirtualController::TControllerIdentifier>(controllerIdString);
+            if (false == kControllerId.has_value())
+                return matchingControllers;
+
+            for (VirtualController* controller : controllers)
+            {
+                if (*kControllerId == controller->GetIdentifier())
+                    matchingControllers.push_back(controller);
+            }
+
+            return matchingControllers;
+        }
+
+        // --------
+
+        void ControlEndpoint::ServingThreadMain(void)
+        {
+            while (true)
+            {
+                std::unique_ptr<IControlConnection> connection = listener->Accept();
+                if (nullptr == connection)
+                    return;
+
+                {
+                    // A client that connected just as the endpoint was stopped must not be served, since nothing would close its connection.
+                    std::scoped_lock lock(servingMutex);
+                    if (true == servingWorker.IsStopRequested())
+                        return;
+
+                    activeConnection = connection.get();
+                }
+
+                std::string request;
+                while (true == connection->ReadLine(request))
+                {
+                    if (false == connection->WriteLine(HandleRequest(request)))
+                        break;
+                }
+
+                std::scoped_lock lock(servingMutex);
+                activeConnection = nullptr;
+            }
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "ControlEndpoint.h" for documentation.
+
+        ControlEndpoint& ControlEndpoint::GetDefault(void)
+        {
+            static ControlEndpoint defaultEndpoint;
+            return defaultEndpoint;
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "ControlEndpoint.h" for documentation.
+
+        void ControlEndpoint::Abandon(void)
+        {
+            servingWorker.Abandon();
+
+            if (nullptr != listener)
+                listener->Abandon();
+        }
+
+        // --------
+
+        void ControlEndpoint::AddController(VirtualController* controller)
+        {
+            std::scoped_lock lock(controllersMutex);
+
+            if (controllers.end() == std::find(controllers.begin(), controllers.end(), controller))
+                controllers.push_back(controller);
+        }
+
+        // --------
+
+        std::string ControlEndpoint::HandleRequest(std::string_view request)
+        {
+            const std::vector<std::string_view> kWords = SplitWords(request);
+            if (true == kWords.empty())
+                return ErrorResponse("empty request");
+
+            const std::string_view kCommand = kWords[0];
+
+            // Holding the lock while controllers are accessed is what allows controllers to be unregistered safely.
+            std::scoped_lock lock(controllersMutex);
+
+            if ("list" == kCommand)
+            {
+                std::vector<VirtualController::TControllerIdentifier> controllerIds;
+                for (const VirtualController* controller : controllers)
+                    controllerIds.push_back(controller->GetIdentifier());
+
+                std::sort(controllerIds.begin(), controllerIds.end());
+                controllerIds.erase(std::unique(controllerIds.begin(), controllerIds.end()), controllerIds.end());
+
+                std::string response = "OK";
+                for (const VirtualController::TControllerIdentifier kControllerId : controllerIds)
+                    response += " " + std::to_string(kControllerId);
+
+                return response;
+            }
+
+            if (kWords.size() < 2)
+                return ErrorResponse("missing controller identifier");
+
+            const std::vector<VirtualController*> kMatchingControllers = FindControllersLocked(kWords[1]);
+            if (true == kMatchingControllers.empty())
+                return ErrorResponse(std::string("no such controller ") + std::string(kWords[1]));
+
+            if ("set" == kCommand)
+            {
+                VirtualController::SPropertyChanges changes = {};
+
+                const std::string kParseError = ParsePropertyChanges(std::vector<std::string_view>(kWords.begin() + 2, kWords.end()), changes);
+                if (false == kParseError.empty())
+                    return ErrorResponse(kParseError);
+
+                // Checked up front for all controllers so that a mapper that suits only some of them changes none of them.
+                if (nullptr != changes.mapper)
+                {
+                    for (const VirtualController* controller : kMatchingControllers)
+                    {
+                        if (false == (changes.mapper->GetCapabilities() == controller->GetCapabilities()))
+                            return ErrorResponse("mapper capabilities differ from those of the current mapper");
+                    }
+                }
+
+                // Apart from the mapper, validation does not depend on the controller, so if any controller rejects the changes then the first one does.
+                for (VirtualController* controller : kMatchingControllers)
+                {
+                    if (false == controller->StagePropertyChanges(changes))
+                        return ErrorResponse("property value out of range");
+                }
+
+                return "OK";
+            }
+
+            // Queries that name several controllers report only the first, since controllers sharing an identifier normally differ only in what the application changed.
+            VirtualController* const kController = kMatchingControllers.front();
+
+            if ("state" == kCommand)
+            {
+                const SState kControllerState = kController->PeekState();
+
+                std::string response = "OK";
+                for (int i = 0; i < (int)EAxis::Count; ++i)
+                    response += " " + std::string(kAxisNames[i]) + "=" + std::to_string(kControllerState.axis[i]);
+
+                response += " buttons=";
+                for (int i = 0; i < (int)EButton::Count; ++i)
+                    response.push_back((true == kControllerState.button[i]) ? '1' : '0');
+
+                std::string povDirections;
+                for (int i = 0; i < (int)EPovDirection::Count; ++i)
+                {
+                    if (true == kControllerState.povDirection.components[i])
+                        povDirections += ((true == povDirections.empty()) ? "" : ",") + std::string(kPovDirectionNames[i]);
+                }
+
+                response += " pov=" + ((true == povDirections.empty()) ? std::string("none") : povDirections);
+                return response;
+            }
+
+            if ("properties" == kCommand)
+            {
+                const VirtualController::SProperties kProperties = kController->GetProperties();
+
+                std::string response = "OK mapper=" + NarrowMapperName(kController->GetMapper().GetName());
+                for (int i = 0; i < (int)EAxis::Count; ++i)
+                {
+                    const std::string kAxisPrefix = " " + std::string(kAxisNames[i]) + ".";
+
+                    response += kAxisPrefix + "deadzone=" + std::to_string(kProperties.axis[i].deadzone);
+                    response += kAxisPrefix + "saturation=" + std::to_string(kProperties.axis[i].saturation);
+                    response += kAxisPrefix + "granularity=" + std::to_string(kProperties.axis[i].granularity);
+                    response += kAxisPrefix + "hysteresis=" + std::to_string(kProperties.axis[i].hysteresis);
+                    response += kAxisPrefix + "range=" + std::to_string(kProperties.axis[i].rangeMin) + "," + std::to_string(kProperties.axis[i].rangeMax);
+                }
+
+                response += " ffgain=" + std::to_string(kProperties.device.ffGain);
+
+                {
+                    auto eventBufferLock = kController->LockEventBuffer();
+                    response += " buffer=" + std::to_string(kController->GetEventBufferCapacity());
+                }
+
+                return response;
+            }
+
+            if ("counters" == kCommand)
+            {
+                const VirtualController::SSuppressionStatistics kSuppressionStatistics = kController->GetSuppressionStatistics();
+
+                std::string response = "OK";
+
+                {
+                    auto eventBufferLock = kController->LockEventBuffer();
+                    response += " events=" + std::to_string(kController->GetEventBufferCount());
+                    response += " overflowed=" + std::to_string((true == kController->IsEventBufferOverflowed()) ? 1 : 0);
+                }
+
+                response += " suppressedByGranularity=" + std::to_string(kSuppressionStatistics.numSuppressedByGranularity);
+                response += " suppressedByHysteresis=" + std::to_string(kSuppressionStatistics.numSuppressedByHysteresis);
+
+                const Statistics::SSegment* const kStatisticsSegment = Statistics::GetPublishedSegment();
+                if ((nullptr != kStatisticsSegment) && (kController->GetIdentifier() < Statistics::kControllerCount))
+                {
+                    const Statistics::SControllerSnapshot kCounters = Statistics::ReadSnapshot(*kStatisticsSegment).controller[kController->GetIdentifier()];
+                    response += " refreshes=" + std::to_string(kCounters.refreshCount);
+                    response += " xinputReads=" + std::to_string(kCounters.xinputReadCount);
+                    response += " stateReads=" + std::to_string(kCounters.stateReadCount);
+                    response += " prefetches=" + std::to_string(kCounters.prefetchCount);
+                    response += " prefetchHits=" + std::to_string(kCounters.prefetchHits);
+                    response += " prefetchMisses=" + std::to_string(kCounters.prefetchMisses);
+                    response += " lockContentions=" + std::to_string(kCounters.lockContentions);
+                }
+
+                return response;
+            }
+
+            return ErrorResponse(std::string("unknown command ") + std::string(kCommand));
+        }
+
+        // --------
+
+        bool ControlEndpoint::IsRunning(void)
+        {
+            return servingWorker.IsRunning();
+        }
+
+        // --------
+
+        void ControlEndpoint::RemoveController(VirtualController* controller)
+        {
+            std::scoped_lock lock(controllersMutex);
+            controllers.erase(std::remove(controllers.begin(), controllers.end(), controller), controllers.end());
+        }
+
+        // --------
+
+        void ControlEndpoint::Start(std::unique_ptr<IControlListener>&& newListener)
+        {
+            std::scoped_lock lock(servingMutex);
+
+            if (true == servingWorker.IsRunning())
+                return;
+
+            listener = std::move(newListener);
+            servingWorker.Start([this]() -> void { ServingThreadMain(); });
+        }
+
+        // --------
+
+        void ControlEndpoint::Stop(void)
+        {
+            if (true == servingWorker.IsAbandoned())
+                return;
+
+            servingWorker.RequestStop();
+
+            {
+                std::scoped_lock lock(servingMutex);
+
+                if (nullptr != listener)
+                    listener->Close();
+
+                if (nullptr != activeConnection)
+                    activeConnection->Close();
+            }
+
+            servingWorker.Stop();
+
+            std::scoped_lock lock(servingMutex);
+            listener = nullptr;
+        }
+    }
+}
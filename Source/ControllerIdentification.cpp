@@ -12,6 +12,7 @@
 
 #include "ApiDirectInput.h"
 #include "ControllerIdentification.h"
+#include "ControllerSourceRegistry.h"
 #include "Globals.h"
 #include "TemporaryBuffer.h"
 
@@ -92,7 +93,9 @@ namespace Xidi
     {
         std::unique_ptr<DeviceInstanceType> instanceInfo = std::make_unique<DeviceInstanceType>();
 
-        for (DWORD idx = 0; idx < XUSER_MAX_COUNT; ++idx)
+        const DWORD kVirtualControllerCount = Controller::ControllerSourceRegistry::GetDefault().GetSlotCount();
+
+        for (DWORD idx = 0; idx < kVirtualControllerCount; ++idx)
         {
             *instanceInfo = {.dwSize = sizeof(*instanceInfo)};
             FillVirtualControllerInfo(*instanceInfo, idx);
@@ -169,7 +172,7 @@ namespace Xidi
     {
         DWORD xindex = ExtractVirtualControllerInstanceFromGuid(instanceGUID);
 
-        if (xindex < XUSER_MAX_COUNT)
+        if (xindex < Controller::ControllerSourceRegistry::GetDefault().GetSlotCount())
         {
             GUID realXInputGUID;
             MakeVirtualControllerInstanceGuid(realXInputGUID, xindex);
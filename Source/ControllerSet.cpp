@@ -0,0 +1,204 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSet.cpp
+ *   Implementation of a set of virtual controllers that are refreshed
+ *   together.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "Clock.h"
+#include "ControllerSet.h"
+#include "ControllerSourceRegistry.h"
+#include "ControllerTypes.h"
+#include "PrefetchScheduler.h"
+#include "Statistics.h"
+#include "VirtualController.h"
+#include "XInputInterface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "ControllerSet.h" for documentation.
+
+        ControllerSet::ControllerSet(std::unique_ptr<IXInput>&& xinput, VirtualController::TControllerIdentifier controllerCount, const IClock& clock) : kControllerCount(std::min(controllerCount, ControllerSourceRegistry::kMaxSlotCount)), controllers(kControllerCount), setMutex(), snapshot({.generation = 0, .state = std::vector<SState>(kControllerCount)}), stateRetrieved(kControllerCount), xinputGetStateResults(kControllerCount), xinputStates(kControllerCount), disconnectedSlotNextPoll(kControllerCount), xinput(std::move(xinput)), clock(clock), readCadence(), snapshotCaptureTimestamp(0), snapshotPrefetched(false), snapshotRead(false)
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+        // See "ControllerSet.h" for documentation.
+
+        void ControllerSet::RefreshLocked(void)
+        {
+            const uint64_t kPollTimestamp = clock.GetTimestamp();
+
+            // All slots are read back-to-back before any mapping happens so that the readings are as close together in time as possible.
+            // A disconnected slot that is not yet due to be read again keeps its previous result.
+            for (VirtualController::TControllerIdentifier i = 0; i < kControllerCount; ++i)
+            {
+                if ((nullptr == controllers[i]) || (kPollTimestamp < disconnectedSlotNextPoll[i]))
+                    continue;
+
+                const auto kReadStartTime = std::chrono::steady_clock::now();
+                xinputGetStateResults[i] = xinput->GetState(i, &xinputStates[i]);
+                Statistics::RecordXInputRead(i, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kReadStartTime).count());
+
+                disconnectedSlotNextPoll[i] = ((ERROR_DEVICE_NOT_CONNECTED == xinputGetStateResults[i]) ? (kPollTimestamp + kDisconnectedSlotPollInterval) : 0);
+            }
+
+            // Every controller state in the snapshot is considered to have been captured at the same instant.
+            const uint64_t kCaptureTimestamp = clock.GetTimestamp();
+
+            for (VirtualController::TControllerIdentifier i = 0; i < kControllerCount; ++i)
+            {
+                if (nullptr == controllers[i])
+                    continue;
+
+                auto controllerLock = controllers[i]->Lock();
+                controllers[i]->RefreshState(xinputGetStateResults[i], xinputStates[i], kCaptureTimestamp);
+                snapshot.state[i] = controllers[i]->PeekStateRef();
+                stateRetrieved[i] = false;
+            }
+
+            snapshot.generation += 1;
+            snapshotCaptureTimestamp = kCaptureTimestamp;
+            snapshotPrefetched = false;
+            snapshotRead = false;
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "ControllerSet.h" for documentation.
+
+        VirtualController* ControllerSet::AddController(std::unique_ptr<VirtualController>&& controller)
+        {
+            if (nullptr == controller)
+                return nullptr;
+
+            const VirtualController::TControllerIdentifier kControllerId = controller->GetIdentifier();
+            if (kControllerId >= kControllerCount)
+                return nullptr;
+
+            std::scoped_lock lock(setMutex);
+            if (nullptr != controllers[kControllerId])
+                return nullptr;
+
+            controllers[kControllerId] = std::move(controller);
+            return controllers[kControllerId].get();
+        }
+
+        // --------
+
+        VirtualController* ControllerSet::GetController(VirtualController::TControllerIdentifier controllerId)
+        {
+            if (controllerId >= kControllerCount)
+                return nullptr;
+
+            std::scoped_lock lock(setMutex);
+            return controllers[controllerId].get();
+        }
+
+        // --------
+
+        void ControllerSet::GetSnapshot(SSnapshot& snapshotOut)
+        {
+            std::scoped_lock lock(setMutex);
+            snapshotOut.generation = snapshot.generation;
+            snapshotOut.state.assign(snapshot.state.cbegin(), snapshot.state.cend());
+        }
+
+        // --------
+
+        SState ControllerSet::GetState(VirtualController::TControllerIdentifier controllerId)
+        {
+            if (controllerId >= kControllerCount)
+                return SState();
+
+            std::scoped_lock lock(setMutex);
+
+            const uint64_t kReadTimestamp = clock.GetTimestamp();
+            const bool kSnapshotStale = ((true == snapshotPrefetched) && (true == readCadence.IsPrefetchStale(snapshotCaptureTimestamp, kReadTimestamp)));
+            const bool kReadWasPredicted = readCadence.PredictNextRead().has_value();
+            const bool kReadStartsFrame = readCadence.RecordRead(kReadTimestamp);
+
+            Statistics::EPrefetchOutcome prefetchOutcome = Statistics::EPrefetchOutcome::NotPredicted;
+
+            if ((0 == snapshot.generation) || (0 != stateRetrieved[controllerId]) || (true == kSnapshotStale))
+            {
+                RefreshLocked();
+
+                if ((true == kReadWasPredicted) && (true == kReadStartsFrame))
+                    prefetchOutcome = Statistics::EPrefetchOutcome::Miss;
+            }
+            else if (true == snapshotPrefetched)
+            {
+                prefetchOutcome = Statistics::EPrefetchOutcome::Hit;
+            }
+
+            Statistics::RecordStateRead(controllerId, ((kReadTimestamp > snapshotCaptureTimestamp) ? (kReadTimestamp - snapshotCaptureTimestamp) : 0), prefetchOutcome);
+
+            stateRetrieved[controllerId] = true;
+            snapshotRead = true;
+            return snapshot.state[controllerId];
+        }
+
+        // --------
+
+        void ControllerSet::Refresh(SSnapshot& snapshotOut)
+        {
+            std::scoped_lock lock(setMutex);
+            RefreshLocked();
+
+            snapshotOut.generation = snapshot.generation;
+            snapshotOut.state.assign(snapshot.state.cbegin(), snapshot.state.cend());
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+        // See "PrefetchScheduler.h" for documentation.
+
+        std::optional<SPrefetchPrediction> ControllerSet::GetPrefetchPrediction(void)
+        {
+            std::scoped_lock lock(setMutex);
+
+            const std::optional<uint64_t> kNextRead = readCadence.PredictNextRead();
+            if (false == kNextRead.has_value())
+                return std::nullopt;
+
+            return SPrefetchPrediction({.nextRead = *kNextRead, .period = readCadence.GetPeriod(), .prefetchPending = ((true == snapshotPrefetched) && (false == snapshotRead))});
+        }
+
+        // --------
+
+        void ControllerSet::Prefetch(void)
+        {
+            std::scoped_lock lock(setMutex);
+
+            RefreshLocked();
+            snapshotPrefetched = true;
+
+            for (VirtualController::TControllerIdentifier i = 0; i < kControllerCount; ++i)
+            {
+                if (nullptr != controllers[i])
+                    Statistics::RecordPrefetch(i);
+            }
+        }
+    }
+}
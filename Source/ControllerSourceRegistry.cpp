@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSourceRegistry.cpp
+ *   Implementation of the registry that assigns virtual controller slots to
+ *   the XInput-style backends that supply their controller states.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "ControllerSourceRegistry.h"
+#include "XInputInterface.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        // -------- INTERNAL TYPES ----------------------------------------- //
+
+        /// XInput interface that reads slots of the default registry.
+        /// Holds no state of its own, so any number of these objects can exist at once.
+        class DefaultRegistryXInput : public IXInput
+        {
+        public:
+            // -------- CONCRETE INSTANCE METHODS -------------------------- //
+            // See "XInputInterface.h" for documentation.
+
+            DWORD GetState(DWORD dwUserIndex, XINPUT_STATE* pState) override
+            {
+                return ControllerSourceRegistry::GetDefault().GetState(dwUserIndex, pState);
+            }
+        };
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "ControllerSourceRegistry.h" for documentation.
+
+        ControllerSourceRegistry::ControllerSourceRegistry(void) : slots(), slotCount(0), sources(), registrationMutex()
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "ControllerSourceRegistry.h" for documentation.
+
+        std::unique_ptr<IXInput> ControllerSourceRegistry::CreateDefaultInterface(void)
+        {
+            return std::make_unique<DefaultRegistryXInput>();
+        }
+
+        // --------
+
+        ControllerSourceRegistry& ControllerSourceRegistry::GetDefault(void)
+        {
+            static ControllerSourceRegistry defaultRegistry;
+            return defaultRegistry;
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "ControllerSourceRegistry.h" for documentation.
+
+        std::optional<DWORD> ControllerSourceRegistry::RegisterSource(std::unique_ptr<IXInput>&& source, DWORD sourceSlotCount)
+        {
+            if ((nullptr == source) || (0 == sourceSlotCount))
+                return std::nullopt;
+
+            std::scoped_lock lock(registrationMutex);
+
+            const DWORD kFirstSlot = slotCount.load(std::memory_order_relaxed);
+            if (sourceSlotCount > (kMaxSlotCount - kFirstSlot))
+                return std::nullopt;
+
+            for (DWORD i = 0; i < sourceSlotCount; ++i)
+                slots[kFirstSlot + i] = {.source = source.get(), .sourceUserIndex = i};
+
+            sources.push_back(std::move(source));
+            slotCount.store(kFirstSlot + sourceSlotCount, std::memory_order_release);
+
+            return kFirstSlot;
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+        // See "XInputInterface.h" for documentation.
+
+        DWORD ControllerSourceRegistry::GetState(DWORD dwUserIndex, XINPUT_STATE* pState)
+        {
+            if (dwUserIndex >= GetSlotCount())
+                return ERROR_DEVICE_NOT_CONNECTED;
+
+            const SSlot& kSlot = slots[dwUserIndex];
+            return kSlot.source->GetState(kSlot.sourceUserIndex, pState);
+        }
+    }
+}
@@ -10,12 +10,13 @@
  *   controller data using the format specified by a DirectInput application.
  *****************************************************************************/
 
-#include "ApiDirectInput.h"
+#include "ApiDirectInputTypes.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
 #include "Message.h"
 #include "Strings.h"
 
+#include <cstring>
 #include <map>
 #include <memory>
 #include <optional>
@@ -141,9 +142,12 @@ namespace Xidi
                 if (true == availablePov)
                 {
                     availablePov = false;
-                    return Controller::SElementIdentifier({.type = Controller::EElementType::Pov});
+                    return Controller::SElementIdentifier({.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0});
                 }
                 break;
+
+            default:
+                break;
             }
 
             return std::nullopt;
@@ -187,6 +191,9 @@ namespace Xidi
                     return element;
                 }
                 break;
+
+            default:
+                break;
             }
 
             return std::nullopt;
@@ -239,6 +246,9 @@ namespace Xidi
             return L"RotY";
         case Controller::EAxis::RotZ:
             return L"RotZ";
+
+        default:
+            break;
         }
 
         return L"(unrecognized axis)";
@@ -361,6 +371,9 @@ namespace Xidi
             if (GUID_POV == *pguid)
                 return elementType;
             break;
+
+        default:
+            break;
         }
 
         return std::nullopt;
@@ -492,7 +505,7 @@ namespace Xidi
                         const int kRequestedInstanceIndex = DIDFT_GETINSTANCE(objectFormatSpec.dwType);
                         if (kWildcardInstanceIndex == kRequestedInstanceIndex)
                             maybeSelectedElement = buildHelper.GetNextAvailableOfType(Controller::EElementType::Axis);
-                        else if ((kRequestedInstanceIndex >= 0) && (kRequestedInstanceIndex < _countof(controllerCapabilities.axisType)))
+                        else if ((kRequestedInstanceIndex >= 0) && (kRequestedInstanceIndex < (int)_countof(controllerCapabilities.axisType)))
                             maybeSelectedElement = buildHelper.GetSpecificElement({.type = Controller::EElementType::Axis, .axis = controllerCapabilities.axisType[kRequestedInstanceIndex]});
                     }
                 } while (false);
@@ -540,7 +553,7 @@ namespace Xidi
                     if (kWildcardInstanceIndex == kRequestedInstanceIndex)
                         maybeSelectedElement = buildHelper.GetNextAvailableOfType(Controller::EElementType::Pov);
                     else if (0 == kRequestedInstanceIndex)
-                        maybeSelectedElement = buildHelper.GetSpecificElement({.type = Controller::EElementType::Pov});
+                        maybeSelectedElement = buildHelper.GetSpecificElement({.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0});
 
                     // Unselected POV offsets are tracked separately because they need to be initialized to a non-zero value when writing a data packet.
                     if (false == maybeSelectedElement.has_value())
@@ -555,6 +568,9 @@ namespace Xidi
                     Message::OutputFormatted(Message::ESeverity::Debug, L"Object at index %d: Selected POV for offset %u.", (int)i, objectFormatSpec.dwOfs);
 
                 break;
+
+            default:
+                break;
             }
 
             // Step 3
@@ -624,6 +640,9 @@ namespace Xidi
             if (kInvalidOffsetValue != dataFormatSpec.povOffset)
                 return dataFormatSpec.povOffset;
             break;
+
+        default:
+            break;
         }
         
         return std::nullopt;
@@ -641,7 +660,7 @@ namespace Xidi
 
         // Initialize the application data packet.
         // Everything not explicitly written will be 0, except for unused POVs which must be initialized to center position.
-        ZeroMemory(packetBuffer, packetBufferSizeBytes);
+        memset(packetBuffer, 0, packetBufferSizeBytes);
         for (auto povOffsetUnused : dataFormatSpec.povOffsetsUnused)
         {
             EPovValue* const valueLocation = (EPovValue*)(&packetByteBuffer[povOffsetUnused]);
@@ -649,7 +668,7 @@ namespace Xidi
         }
         
         // Axis values
-        for (int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
+        for (unsigned int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
         {
             if (kInvalidOffsetValue != dataFormatSpec.axisOffset[i])
             {
@@ -659,7 +678,7 @@ namespace Xidi
         }
 
         // Button values
-        for (int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
+        for (unsigned int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
         {
             if (kInvalidOffsetValue != dataFormatSpec.buttonOffset[i])
             {
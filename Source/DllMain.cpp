@@ -20,7 +20,7 @@
 /// Refer to Windows documentation for more information.
 /// @param [in] hModule Instance handle for this library.
 /// @param [in] ulReasonForCall Specifies the event that caused this function to be invoked.
-/// @param [in] lpReserved Reserved.
+/// @param [in] lpReserved On detach, `nullptr` if the library is being unloaded dynamically or non-`nullptr` if the process is terminating.
 /// @return `TRUE` if this function successfully initialized or uninitialized this library, `FALSE` otherwise.
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
 {
@@ -37,6 +37,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
             break;
 
         case DLL_PROCESS_DETACH:
+            Xidi::Globals::Shutdown(nullptr != lpReserved);
             break;
     }
 
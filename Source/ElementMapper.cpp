@@ -32,6 +32,15 @@ namespace Xidi
         /// Threshold positive direction value used to determine if an analog stick is considered "pressed" or not as a digital button.
         static constexpr int16_t kAnalogPressedThresholdPositive = 14750;
 
+        /// Change in axis value per unit of trigger reading when a trigger contributes to a whole axis.
+        static constexpr double kTriggerBidirectionalStepSize = (double)(kAnalogValueMax - kAnalogValueMin) / (double)(kTriggerValueMax - kTriggerValueMin);
+
+        /// Change in axis value per unit of trigger reading when a trigger contributes to the positive half of an axis.
+        static constexpr double kTriggerPositiveStepSize = (double)kAnalogValueMax / (double)(kTriggerValueMax - kTriggerValueMin);
+
+        /// Change in axis value per unit of trigger reading when a trigger contributes to the negative half of an axis.
+        static constexpr double kTriggerNegativeStepSize = (double)kAnalogValueMin / (double)(kTriggerValueMax - kTriggerValueMin);
+
 
         // -------- INTERNAL FUNCTIONS ------------------------------------- //
 
@@ -68,6 +77,47 @@ namespace Xidi
         }
 
 
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "ElementMapper.h" for documentation.
+
+        void IElementMapper::ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const
+        {
+            for (unsigned int i = 0; i < slotCount; ++i)
+            {
+                SState controllerState;
+                controllerStates.GetSlot(i, controllerState);
+                ContributeFromAnalogValue(controllerState, analogValues[i]);
+                controllerStates.SetSlot(i, controllerState);
+            }
+        }
+
+        // --------
+
+        void IElementMapper::ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const
+        {
+            for (unsigned int i = 0; i < slotCount; ++i)
+            {
+                SState controllerState;
+                controllerStates.GetSlot(i, controllerState);
+                ContributeFromButtonValue(controllerState, (0 != buttonsPressed[i]));
+                controllerStates.SetSlot(i, controllerState);
+            }
+        }
+
+        // --------
+
+        void IElementMapper::ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const
+        {
+            for (unsigned int i = 0; i < slotCount; ++i)
+            {
+                SState controllerState;
+                controllerStates.GetSlot(i, controllerState);
+                ContributeFromTriggerValue(controllerState, triggerValues[i]);
+                controllerStates.SetSlot(i, controllerState);
+            }
+        }
+
+
         // -------- CONCRETE INSTANCE METHODS -------------------------- //
         // See "ElementMapper.h" for documentation.
 
@@ -120,24 +170,20 @@ namespace Xidi
 
         void AxisMapper::ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const
         {
-            constexpr double kBidirectionalStepSize = (double)(kAnalogValueMax - kAnalogValueMin) / (double)(kTriggerValueMax - kTriggerValueMin);
-            constexpr double kPositiveStepSize = (double)kAnalogValueMax / (double)(kTriggerValueMax - kTriggerValueMin);
-            constexpr double kNegativeStepSize = (double)kAnalogValueMin / (double)(kTriggerValueMax - kTriggerValueMin);
-
             int32_t axisValueToContribute = 0;
 
             switch (direction)
             {
             case EDirection::Both:
-                axisValueToContribute = (int32_t)((double)triggerValue * kBidirectionalStepSize) + kAnalogValueMin;
+                axisValueToContribute = (int32_t)((double)triggerValue * kTriggerBidirectionalStepSize) + kAnalogValueMin;
                 break;
 
             case EDirection::Positive:
-                axisValueToContribute = (int32_t)((double)triggerValue * kPositiveStepSize) + kAnalogValueNeutral;
+                axisValueToContribute = (int32_t)((double)triggerValue * kTriggerPositiveStepSize) + kAnalogValueNeutral;
                 break;
 
             case EDirection::Negative:
-                axisValueToContribute = (int32_t)((double)triggerValue * kNegativeStepSize) - kAnalogValueNeutral;
+                axisValueToContribute = (int32_t)((double)triggerValue * kTriggerNegativeStepSize) - kAnalogValueNeutral;
                 break;
             }
 
@@ -146,11 +192,81 @@ namespace Xidi
 
         // --------
 
-        SElementIdentifier AxisMapper::GetTargetElement(void) const
+        void AxisMapper::ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const
         {
-            return {.type = EElementType::Axis, .axis = axis};
+            int32_t* const axisValues = controllerStates.axis[(int)axis];
+
+            // Direction is resolved once for the whole batch so that each loop body is branch-free and can be vectorized.
+            switch (direction)
+            {
+            case EDirection::Both:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (int32_t)analogValues[i];
+                break;
+
+            case EDirection::Positive:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += ((int32_t)analogValues[i] - kAnalogValueMin) >> 1;
+                break;
+
+            case EDirection::Negative:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += ((int32_t)analogValues[i] - kAnalogValueMax) >> 1;
+                break;
+            }
+        }
+
+        // --------
+
+        void AxisMapper::ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const
+        {
+            int32_t* const axisValues = controllerStates.axis[(int)axis];
+
+            switch (direction)
+            {
+            case EDirection::Both:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += ((0 != buttonsPressed[i]) ? kAnalogValueMax : kAnalogValueMin);
+                break;
+
+            case EDirection::Positive:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += ((0 != buttonsPressed[i]) ? kAnalogValueMax : kAnalogValueNeutral);
+                break;
+
+            case EDirection::Negative:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += ((0 != buttonsPressed[i]) ? kAnalogValueMin : kAnalogValueNeutral);
+                break;
+            }
         }
-        
+
+        // --------
+
+        void AxisMapper::ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const
+        {
+            int32_t* const axisValues = controllerStates.axis[(int)axis];
+
+            switch (direction)
+            {
+            case EDirection::Both:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (int32_t)((double)triggerValues[i] * kTriggerBidirectionalStepSize) + kAnalogValueMin;
+                break;
+
+            case EDirection::Positive:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (int32_t)((double)triggerValues[i] * kTriggerPositiveStepSize) + kAnalogValueNeutral;
+                break;
+
+            case EDirection::Negative:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (int32_t)((double)triggerValues[i] * kTriggerNegativeStepSize) - kAnalogValueNeutral;
+                break;
+            }
+        }
+
+
         // --------
 
         void ButtonMapper::ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const
@@ -174,11 +290,35 @@ namespace Xidi
 
         // --------
 
-        SElementIdentifier ButtonMapper::GetTargetElement(void) const
+        void ButtonMapper::ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const
+        {
+            uint8_t* const buttonValues = controllerStates.button[(int)button];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                buttonValues[i] |= (uint8_t)IsAnalogPressed(analogValues[i]);
+        }
+
+        // --------
+
+        void ButtonMapper::ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const
+        {
+            uint8_t* const buttonValues = controllerStates.button[(int)button];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                buttonValues[i] |= (uint8_t)(0 != buttonsPressed[i]);
+        }
+
+        // --------
+
+        void ButtonMapper::ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const
         {
-            return {.type = EElementType::Button, .button = button};
+            uint8_t* const buttonValues = controllerStates.button[(int)button];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                buttonValues[i] |= (uint8_t)IsTriggerPressed(triggerValues[i]);
         }
 
+
         // --------
 
         void DigitalAxisMapper::ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const
@@ -217,6 +357,43 @@ namespace Xidi
 
         // --------
 
+        void DigitalAxisMapper::ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const
+        {
+            int32_t* const axisValues = controllerStates.axis[(int)axis];
+
+            switch (direction)
+            {
+            case EDirection::Both:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (IsAnalogPressedNegative(analogValues[i]) ? kAnalogValueMin : (IsAnalogPressedPositive(analogValues[i]) ? kAnalogValueMax : 0));
+                break;
+
+            case EDirection::Positive:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (IsAnalogPressedPositive(analogValues[i]) ? kAnalogValueMax : 0);
+                break;
+
+            case EDirection::Negative:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] += (IsAnalogPressedNegative(analogValues[i]) ? kAnalogValueMin : 0);
+                break;
+            }
+        }
+
+        // --------
+
+        void DigitalAxisMapper::ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const
+        {
+            uint8_t triggersPressed[kBatchSlotCountMax];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                triggersPressed[i] = (uint8_t)IsTriggerPressed(triggerValues[i]);
+
+            ContributeFromButtonValues(controllerStates, triggersPressed, slotCount);
+        }
+
+        // --------
+
         void PovMapper::ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const
         {
             if (true == IsAnalogPressedPositive(analogValue))
@@ -247,9 +424,57 @@ namespace Xidi
 
         // --------
 
-        SElementIdentifier PovMapper::GetTargetElement(void) const
+        void PovMapper::ContributeFromAnalogValues(SStateBatch& controllerStates, const int16_t* analogValues, unsigned int slotCount) const
+        {
+            uint8_t* const povDirectionPositiveValues = controllerStates.povDirection[(int)povDirectionPositive];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                povDirectionPositiveValues[i] |= (uint8_t)IsAnalogPressedPositive(analogValues[i]);
+
+            // An analog value cannot be pressed in both directions at once, so the negative direction does not need to check the positive direction.
+            if (maybePovDirectionNegative.has_value())
+            {
+                uint8_t* const povDirectionNegativeValues = controllerStates.povDirection[(int)maybePovDirectionNegative.value()];
+
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    povDirectionNegativeValues[i] |= (uint8_t)IsAnalogPressedNegative(analogValues[i]);
+            }
+        }
+
+        // --------
+
+        void PovMapper::ContributeFromButtonValues(SStateBatch& controllerStates, const uint8_t* buttonsPressed, unsigned int slotCount) const
         {
-            return {.type = EElementType::Pov};
+            uint8_t* const povDirectionPositiveValues = controllerStates.povDirection[(int)povDirectionPositive];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                povDirectionPositiveValues[i] |= (uint8_t)(0 != buttonsPressed[i]);
+
+            if (maybePovDirectionNegative.has_value())
+            {
+                uint8_t* const povDirectionNegativeValues = controllerStates.povDirection[(int)maybePovDirectionNegative.value()];
+
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    povDirectionNegativeValues[i] |= (uint8_t)(0 == buttonsPressed[i]);
+            }
+        }
+
+        // --------
+
+        void PovMapper::ContributeFromTriggerValues(SStateBatch& controllerStates, const uint8_t* triggerValues, unsigned int slotCount) const
+        {
+            uint8_t* const povDirectionPositiveValues = controllerStates.povDirection[(int)povDirectionPositive];
+
+            for (unsigned int i = 0; i < slotCount; ++i)
+                povDirectionPositiveValues[i] |= (uint8_t)IsTriggerPressed(triggerValues[i]);
+
+            if (maybePovDirectionNegative.has_value())
+            {
+                uint8_t* const povDirectionNegativeValues = controllerStates.povDirection[(int)maybePovDirectionNegative.value()];
+
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    povDirectionNegativeValues[i] |= (uint8_t)(false == IsTriggerPressed(triggerValues[i]));
+            }
         }
     }
 }
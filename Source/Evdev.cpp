@@ -0,0 +1,612 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Evdev.cpp
+ *   Implementation of functionality for translating Linux evdev input event
+ *   streams into XInput controller states.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "Evdev.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+
+namespace Xidi
+{
+    namespace Evdev
+    {
+#ifdef __linux__
+        static_assert(EV_SYN == kEventTypeSyn, L"Event type constant mismatch.");
+        static_assert(EV_KEY == kEventTypeKey, L"Event type constant mismatch.");
+        static_assert(EV_ABS == kEventTypeAbs, L"Event type constant mismatch.");
+        static_assert(SYN_REPORT == kSynReport, L"Synchronization code constant mismatch.");
+        static_assert(SYN_DROPPED == kSynDropped, L"Synchronization code constant mismatch.");
+        static_assert((ABS_X == kAbsX) && (ABS_Y == kAbsY) && (ABS_Z == kAbsZ), L"Absolute axis code constant mismatch.");
+        static_assert((ABS_RX == kAbsRx) && (ABS_RY == kAbsRy) && (ABS_RZ == kAbsRz), L"Absolute axis code constant mismatch.");
+        static_assert((ABS_GAS == kAbsGas) && (ABS_BRAKE == kAbsBrake), L"Absolute axis code constant mismatch.");
+        static_assert((ABS_HAT0X == kAbsHat0X) && (ABS_HAT0Y == kAbsHat0Y), L"Absolute axis code constant mismatch.");
+        static_assert(ABS_CNT == kAbsCount, L"Absolute axis count constant mismatch.");
+        static_assert((BTN_A == kBtnA) && (BTN_B == kBtnB) && (BTN_X == kBtnX) && (BTN_Y == kBtnY), L"Button code constant mismatch.");
+        static_assert((BTN_TL == kBtnTL) && (BTN_TR == kBtnTR) && (BTN_SELECT == kBtnSelect) && (BTN_START == kBtnStart), L"Button code constant mismatch.");
+        static_assert((BTN_THUMBL == kBtnThumbL) && (BTN_THUMBR == kBtnThumbR), L"Button code constant mismatch.");
+        static_assert((BTN_DPAD_UP == kBtnDpadUp) && (BTN_DPAD_DOWN == kBtnDpadDown) && (BTN_DPAD_LEFT == kBtnDpadLeft) && (BTN_DPAD_RIGHT == kBtnDpadRight), L"Button code constant mismatch.");
+        static_assert((sizeof(void*) != 8) || (sizeof(struct input_event) == kCapturedEventRecordSize), L"Captured event record size mismatch.");
+#endif
+
+
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Byte offset of the event type within a captured event record. Everything before it is the event timestamp.
+        static constexpr size_t kCapturedEventTypeOffset = 16;
+
+        /// Byte offset of the event code within a captured event record.
+        static constexpr size_t kCapturedEventCodeOffset = 18;
+
+        /// Byte offset of the event value within a captured event record.
+        static constexpr size_t kCapturedEventValueOffset = 20;
+
+        /// Button codes that are translated to XInput buttons, along with the XInput button each one sets.
+        static constexpr struct
+        {
+            uint16_t code;
+            WORD xinputButton;
+        } kButtonTranslations[] = {
+            {kBtnA,             XINPUT_GAMEPAD_A},
+            {kBtnB,             XINPUT_GAMEPAD_B},
+            {kBtnX,             XINPUT_GAMEPAD_X},
+            {kBtnY,             XINPUT_GAMEPAD_Y},
+            {kBtnTL,            XINPUT_GAMEPAD_LEFT_SHOULDER},
+            {kBtnTR,            XINPUT_GAMEPAD_RIGHT_SHOULDER},
+            {kBtnSelect,        XINPUT_GAMEPAD_BACK},
+            {kBtnStart,         XINPUT_GAMEPAD_START},
+            {kBtnThumbL,        XINPUT_GAMEPAD_LEFT_THUMB},
+            {kBtnThumbR,        XINPUT_GAMEPAD_RIGHT_THUMB},
+            {kBtnDpadUp,        XINPUT_GAMEPAD_DPAD_UP},
+            {kBtnDpadDown,      XINPUT_GAMEPAD_DPAD_DOWN},
+            {kBtnDpadLeft,      XINPUT_GAMEPAD_DPAD_LEFT},
+            {kBtnDpadRight,     XINPUT_GAMEPAD_DPAD_RIGHT}
+        };
+
+        /// Absolute axis codes that are translated to XInput controller state.
+        static constexpr uint16_t kTranslatedAxes[] = {kAbsX, kAbsY, kAbsZ, kAbsRx, kAbsRy, kAbsRz, kAbsGas, kAbsBrake, kAbsHat0X, kAbsHat0Y};
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Reads a little-endian unsigned 16-bit integer from a byte buffer, irrespective of the byte order of the current platform.
+        /// @param [in] bytes Pointer to the first byte of the integer.
+        /// @return Integer value.
+        static inline uint16_t ReadLittleEndian16(const uint8_t* bytes)
+        {
+            return (uint16_t)((uint16_t)bytes[0] | ((uint16_t)bytes[1] << 8));
+        }
+
+        /// Reads a little-endian unsigned 32-bit integer from a byte buffer, irrespective of the byte order of the current platform.
+        /// @param [in] bytes Pointer to the first byte of the integer.
+        /// @return Integer value.
+        static inline uint32_t ReadLittleEndian32(const uint8_t* bytes)
+        {
+            return ((uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24));
+        }
+
+        /// Scales an absolute axis value to the range of an XInput thumbstick axis.
+        /// @param [in] value Raw axis value.
+        /// @param [in] range Range of the axis.
+        /// @return Scaled value, or the neutral value if the range is empty.
+        static SHORT ScaleStickValue(int32_t value, const SAxisRange& range)
+        {
+            if (range.maximum <= range.minimum)
+                return 0;
+
+            const int64_t kClampedValue = std::clamp(value, range.minimum, range.maximum);
+            return (SHORT)(((kClampedValue - (int64_t)range.minimum) * 65535ll) / ((int64_t)range.maximum - (int64_t)range.minimum) - 32768ll);
+        }
+
+        /// Scales an absolute axis value to the range of an XInput thumbstick axis whose positive direction is opposite that of evdev.
+        /// Evdev vertical axes increase downwards, whereas XInput vertical axes increase upwards.
+        /// @param [in] value Raw axis value.
+        /// @param [in] range Range of the axis.
+        /// @return Scaled and inverted value, or the neutral value if the range is empty.
+        static SHORT ScaleInvertedStickValue(int32_t value, const SAxisRange& range)
+        {
+            if (range.maximum <= range.minimum)
+                return 0;
+
+            // Mirroring around the midpoint of the XInput range maps the minimum exactly onto the maximum and vice versa.
+            return (SHORT)(-1 - (int32_t)ScaleStickValue(value, range));
+        }
+
+        /// Scales an absolute axis value to the range of an XInput trigger.
+        /// @param [in] value Raw axis value.
+        /// @param [in] range Range of the axis.
+        /// @return Scaled value, or the neutral value if the range is empty.
+        static BYTE ScaleTriggerValue(int32_t value, const SAxisRange& range)
+        {
+            if (range.maximum <= range.minimum)
+                return 0;
+
+            const int64_t kClampedValue = std::clamp(value, range.minimum, range.maximum);
+            return (BYTE)(((kClampedValue - (int64_t)range.minimum) * 255ll) / ((int64_t)range.maximum - (int64_t)range.minimum));
+        }
+
+        /// Updates a pair of opposing d-pad buttons based on the value of a hat axis.
+        /// @param [in,out] buttons XInput button state to update.
+        /// @param [in] value Raw hat axis value. Negative values press the first button and positive values press the second.
+        /// @param [in] negativeButton XInput button that corresponds to negative values.
+        /// @param [in] positiveButton XInput button that corresponds to positive values.
+        static void UpdateHatButtons(WORD& buttons, int32_t value, WORD negativeButton, WORD positiveButton)
+        {
+            buttons &= ~(negativeButton | positiveButton);
+
+            if (value < 0)
+                buttons |= negativeButton;
+            else if (value > 0)
+                buttons |= positiveButton;
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "Evdev.h" for documentation.
+
+        ReplayEventSource::ReplayEventSource(std::vector<SEvent>&& events, const TAxisRanges& axisRanges) : kAxisRanges(axisRanges), kEvents(std::move(events)), nextEventIndex(0)
+        {
+            // Nothing to do here.
+        }
+
+        // --------
+
+        StateTracker::StateTracker(const TAxisRanges& axisRanges) : kAxisRanges(axisRanges), pendingState(), reportedState(), discardingEvents(false), needsCurrentState(false)
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "Evdev.h" for documentation.
+
+        std::unique_ptr<ReplayEventSource> ReplayEventSource::LoadFromFile(const wchar_t* fileName, const TAxisRanges& axisRanges)
+        {
+            FILE* const capturedFile = Platform::OpenFile(fileName, L"rb");
+            if (nullptr == capturedFile)
+                return nullptr;
+
+            std::vector<uint8_t> capturedBytes;
+            uint8_t readBuffer[kCapturedEventRecordSize * 64];
+            size_t readByteCount = 0;
+
+            while (0 != (readByteCount = fread(readBuffer, 1, sizeof(readBuffer), capturedFile)))
+                capturedBytes.insert(capturedBytes.end(), &readBuffer[0], &readBuffer[readByteCount]);
+
+            const bool kReadFailed = (0 != ferror(capturedFile));
+            fclose(capturedFile);
+
+            std::vector<SEvent> events;
+            if ((true == kReadFailed) || (false == ParseCapturedEvents(capturedBytes.data(), capturedBytes.size(), events)))
+                return nullptr;
+
+            return std::make_unique<ReplayEventSource>(std::move(events), axisRanges);
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "Evdev.h" for documentation.
+
+        void StateTracker::ApplyEvent(const SEvent& event)
+        {
+            if (kEventTypeSyn == event.type)
+            {
+                switch (event.code)
+                {
+                case kSynDropped:
+                    discardingEvents = true;
+                    break;
+
+                case kSynReport:
+                    if (true == discardingEvents)
+                    {
+                        // The report that follows a drop is incomplete, so the accumulated state is not published.
+                        // It only becomes trustworthy again once the current state of the device has been applied.
+                        discardingEvents = false;
+                        needsCurrentState = true;
+                    }
+                    else
+                    {
+                        needsCurrentState = false;
+
+                        if (0 != memcmp(&pendingState, &reportedState.Gamepad, sizeof(pendingState)))
+                        {
+                            reportedState.Gamepad = pendingState;
+                            reportedState.dwPacketNumber += 1;
+                        }
+                    }
+                    break;
+                }
+
+                return;
+            }
+
+            if (true == discardingEvents)
+                return;
+
+            switch (event.type)
+            {
+            case kEventTypeKey:
+                for (const auto& buttonTranslation : kButtonTranslations)
+                {
+                    if (buttonTranslation.code == event.code)
+                    {
+                        // Values are 0 for released, 1 for pressed, and 2 for auto-repeat, which still means pressed.
+                        if (0 != event.value)
+                            pendingState.wButtons |= buttonTranslation.xinputButton;
+                        else
+                            pendingState.wButtons &= ~buttonTranslation.xinputButton;
+
+                        break;
+                    }
+                }
+                break;
+
+            case kEventTypeAbs:
+                if (event.code >= kAbsCount)
+                    break;
+
+                switch (event.code)
+                {
+                case kAbsX:
+                    pendingState.sThumbLX = ScaleStickValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsY:
+                    pendingState.sThumbLY = ScaleInvertedStickValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsRx:
+                    pendingState.sThumbRX = ScaleStickValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsRy:
+                    pendingState.sThumbRY = ScaleInvertedStickValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsZ:
+                case kAbsBrake:
+                    pendingState.bLeftTrigger = ScaleTriggerValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsRz:
+                case kAbsGas:
+                    pendingState.bRightTrigger = ScaleTriggerValue(event.value, kAxisRanges[event.code]);
+                    break;
+
+                case kAbsHat0X:
+                    UpdateHatButtons(pendingState.wButtons, event.value, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT);
+                    break;
+
+                case kAbsHat0Y:
+                    UpdateHatButtons(pendingState.wButtons, event.value, XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN);
+                    break;
+                }
+                break;
+            }
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+        // See "Evdev.h" for documentation.
+
+        const TAxisRanges& ReplayEventSource::GetAxisRanges(void) const
+        {
+            return kAxisRanges;
+        }
+
+        // --------
+
+        int ReplayEventSource::GetWaitDescriptor(void) const
+        {
+            return -1;
+        }
+
+        // --------
+
+        void ReplayEventSource::ReadCurrentState(std::vector<SEvent>&)
+        {
+            // A captured stream has no current state other than what it has already delivered.
+        }
+
+        // --------
+
+        bool ReplayEventSource::ReadEvents(std::vector<SEvent>& events)
+        {
+            while (nextEventIndex < kEvents.size())
+            {
+                const SEvent& kEvent = kEvents[nextEventIndex++];
+                events.push_back(kEvent);
+
+                if ((kEventTypeSyn == kEvent.type) && (kSynReport == kEvent.code))
+                    break;
+            }
+
+            return true;
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Evdev.h" for documentation.
+
+        const TAxisRanges& DefaultAxisRanges(void)
+        {
+            static const TAxisRanges kDefaultAxisRanges = []() -> TAxisRanges
+            {
+                TAxisRanges axisRanges;
+                axisRanges.fill({.minimum = -32768, .maximum = 32767});
+
+                axisRanges[kAbsZ] = {.minimum = 0, .maximum = 255};
+                axisRanges[kAbsRz] = {.minimum = 0, .maximum = 255};
+                axisRanges[kAbsGas] = {.minimum = 0, .maximum = 255};
+                axisRanges[kAbsBrake] = {.minimum = 0, .maximum = 255};
+                axisRanges[kAbsHat0X] = {.minimum = -1, .maximum = 1};
+                axisRanges[kAbsHat0Y] = {.minimum = -1, .maximum = 1};
+
+                return axisRanges;
+            }();
+
+            return kDefaultAxisRanges;
+        }
+
+        // --------
+
+        bool ParseCapturedEvents(const void* capturedBytes, size_t capturedByteCount, std::vector<SEvent>& events)
+        {
+            if (0 != (capturedByteCount % kCapturedEventRecordSize))
+                return false;
+
+            const uint8_t* const kCapturedBytes = (const uint8_t*)capturedBytes;
+
+            events.clear();
+            events.reserve(capturedByteCount / kCapturedEventRecordSize);
+
+            for (size_t recordOffset = 0; recordOffset < capturedByteCount; recordOffset += kCapturedEventRecordSize)
+            {
+                const uint8_t* const kRecord = &kCapturedBytes[recordOffset];
+
+                events.push_back({
+                    .type = ReadLittleEndian16(&kRecord[kCapturedEventTypeOffset]),
+                    .code = ReadLittleEndian16(&kRecord[kCapturedEventCodeOffset]),
+                    .value = (int32_t)ReadLittleEndian32(&kRecord[kCapturedEventValueOffset])
+                });
+            }
+
+            return true;
+        }
+
+
+#ifdef __linux__
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Determines if the specified bit is set in a bit array of the form filled by evdev capability queries.
+        /// @param [in] bits Bit array.
+        /// @param [in] bitIndex Index of the bit to check.
+        /// @return `true` if the bit is set, `false` otherwise.
+        static inline bool IsBitSet(const uint8_t* bits, unsigned int bitIndex)
+        {
+            return (0 != (bits[bitIndex / 8] & (1 << (bitIndex % 8))));
+        }
+
+        /// Determines if an open evdev device node represents a gamepad, which the input subsystem indicates by the presence of the `BTN_GAMEPAD` key.
+        /// @param [in] deviceDescriptor Open file descriptor for the device node.
+        /// @return `true` if so, `false` if not.
+        static bool IsGamepadDevice(int deviceDescriptor)
+        {
+            uint8_t keyBits[(KEY_MAX / 8) + 1] = {};
+            if (ioctl(deviceDescriptor, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0)
+                return false;
+
+            return IsBitSet(keyBits, BTN_GAMEPAD);
+        }
+
+        /// Extracts the event node number from a device node name of the form `eventN`.
+        /// @param [in] deviceName Device node name.
+        /// @return Event node number, or -1 if the name is not of the expected form.
+        static int EventNodeNumber(const char* deviceName)
+        {
+            static constexpr char kEventNodePrefix[] = "event";
+            static constexpr size_t kEventNodePrefixLength = sizeof(kEventNodePrefix) - 1;
+
+            if ((0 != strncmp(deviceName, kEventNodePrefix, kEventNodePrefixLength)) || ('\0' == deviceName[kEventNodePrefixLength]))
+                return -1;
+
+            int eventNodeNumber = 0;
+            for (const char* digit = &deviceName[kEventNodePrefixLength]; '\0' != *digit; ++digit)
+            {
+                if ((*digit < '0') || (*digit > '9'))
+                    return -1;
+
+                eventNodeNumber = (eventNodeNumber * 10) + (*digit - '0');
+            }
+
+            return eventNodeNumber;
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "Evdev.h" for documentation.
+
+        DeviceEventSource::DeviceEventSource(int deviceDescriptor) : kDeviceDescriptor(deviceDescriptor), axisRanges()
+        {
+            uint8_t absBits[(ABS_MAX / 8) + 1] = {};
+            if (ioctl(kDeviceDescriptor, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) < 0)
+                return;
+
+            for (const uint16_t kAxis : kTranslatedAxes)
+            {
+                struct input_absinfo absInfo = {};
+
+                if ((true == IsBitSet(absBits, kAxis)) && (0 == ioctl(kDeviceDescriptor, EVIOCGABS(kAxis), &absInfo)))
+                    axisRanges[kAxis] = {.minimum = absInfo.minimum, .maximum = absInfo.maximum};
+            }
+        }
+
+        // --------
+
+        DeviceEventSource::~DeviceEventSource(void)
+        {
+            close(kDeviceDescriptor);
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "Evdev.h" for documentation.
+
+        std::vector<std::string> DeviceEventSource::FindGamepadDevices(void)
+        {
+            static constexpr char kDeviceDirectory[] = "/dev/input";
+
+            std::vector<std::pair<int, std::string>> gamepadDevices;
+
+            DIR* const deviceDirectory = opendir(kDeviceDirectory);
+            if (nullptr == deviceDirectory)
+                return {};
+
+            for (const struct dirent* deviceEntry = readdir(deviceDirectory); nullptr != deviceEntry; deviceEntry = readdir(deviceDirectory))
+            {
+                const int kEventNodeNumber = EventNodeNumber(deviceEntry->d_name);
+                if (kEventNodeNumber < 0)
+                    continue;
+
+                std::string devicePath = std::string(kDeviceDirectory) + "/" + deviceEntry->d_name;
+
+                const int kDeviceDescriptor = open(devicePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+                if (kDeviceDescriptor < 0)
+                    continue;
+
+                if (true == IsGamepadDevice(kDeviceDescriptor))
+                    gamepadDevices.emplace_back(kEventNodeNumber, std::move(devicePath));
+
+                close(kDeviceDescriptor);
+            }
+
+            closedir(deviceDirectory);
+
+            std::sort(gamepadDevices.begin(), gamepadDevices.end());
+
+            std::vector<std::string> gamepadDevicePaths;
+            for (auto& gamepadDevice : gamepadDevices)
+                gamepadDevicePaths.push_back(std::move(gamepadDevice.second));
+
+            return gamepadDevicePaths;
+        }
+
+        // --------
+
+        std::unique_ptr<DeviceEventSource> DeviceEventSource::Open(const std::string& devicePath)
+        {
+            const int kDeviceDescriptor = open(devicePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (kDeviceDescriptor < 0)
+                return nullptr;
+
+            if (false == IsGamepadDevice(kDeviceDescriptor))
+            {
+                close(kDeviceDescriptor);
+                return nullptr;
+            }
+
+            return std::unique_ptr<DeviceEventSource>(new DeviceEventSource(kDeviceDescriptor));
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+        // See "Evdev.h" for documentation.
+
+        const TAxisRanges& DeviceEventSource::GetAxisRanges(void) const
+        {
+            return axisRanges;
+        }
+
+        // --------
+
+        int DeviceEventSource::GetWaitDescriptor(void) const
+        {
+            return kDeviceDescriptor;
+        }
+
+        // --------
+
+        void DeviceEventSource::ReadCurrentState(std::vector<SEvent>& events)
+        {
+            uint8_t keyBits[(KEY_MAX / 8) + 1] = {};
+            if (ioctl(kDeviceDescriptor, EVIOCGKEY(sizeof(keyBits)), keyBits) >= 0)
+            {
+                for (const auto& buttonTranslation : kButtonTranslations)
+                    events.push_back({.type = kEventTypeKey, .code = buttonTranslation.code, .value = ((true == IsBitSet(keyBits, buttonTranslation.code)) ? 1 : 0)});
+            }
+
+            for (const uint16_t kAxis : kTranslatedAxes)
+            {
+                if (axisRanges[kAxis].maximum <= axisRanges[kAxis].minimum)
+                    continue;
+
+                struct input_absinfo absInfo = {};
+                if (0 == ioctl(kDeviceDescriptor, EVIOCGABS(kAxis), &absInfo))
+                    events.push_back({.type = kEventTypeAbs, .code = kAxis, .value = absInfo.value});
+            }
+        }
+
+        // --------
+
+        bool DeviceEventSource::ReadEvents(std::vector<SEvent>& events)
+        {
+            struct input_event readBuffer[64];
+
+            while (true)
+            {
+                const ssize_t kReadByteCount = read(kDeviceDescriptor, readBuffer, sizeof(readBuffer));
+
+                if (kReadByteCount < 0)
+                {
+                    switch (errno)
+                    {
+                    case EINTR:
+                        continue;
+
+                    case EAGAIN:
+                        return true;
+
+                    default:
+                        // Most notably `ENODEV`, which means the device was unplugged.
+                        return false;
+                    }
+                }
+
+                if (0 == kReadByteCount)
+                    return false;
+
+                for (size_t i = 0; i < ((size_t)kReadByteCount / sizeof(readBuffer[0])); ++i)
+                    events.push_back({.type = readBuffer[i].type, .code = readBuffer[i].code, .value = readBuffer[i].value});
+            }
+        }
+#endif
+    }
+}
@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file EvdevXInput.cpp
+ *   Implementation of an implementation of the XInput interface that obtains
+ *   controller states from Linux evdev input event sources.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "Evdev.h"
+#include "EvdevXInput.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+
+namespace Xidi
+{
+#ifdef __linux__
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Value stored alongside the stop `eventfd` object in the `epoll` instance. All other registrations store a slot index, which is always less than this value.
+    static constexpr uint32_t kEpollStopToken = UINT32_MAX;
+
+    /// Maximum number of readiness notifications retrieved by the event thread at once.
+    static constexpr int kEpollMaxEvents = XUSER_MAX_COUNT + 1;
+#endif
+
+
+    // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
+    // See "EvdevXInput.h" for documentation.
+
+#ifdef __linux__
+    EvdevXInput::EvdevXInput(void) : slots(), kEpollDescriptor(epoll_create1(EPOLL_CLOEXEC)), kStopDescriptor(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), eventThread()
+    {
+        if ((kEpollDescriptor < 0) || (kStopDescriptor < 0))
+            return;
+
+        struct epoll_event stopRegistration = {.events = EPOLLIN, .data = {.u32 = kEpollStopToken}};
+        if (0 != epoll_ctl(kEpollDescriptor, EPOLL_CTL_ADD, kStopDescriptor, &stopRegistration))
+            return;
+
+        eventThread = std::thread(&EvdevXInput::EventThreadMain, this);
+    }
+#else
+    EvdevXInput::EvdevXInput(void) : slots()
+    {
+        // Nothing to do here.
+    }
+#endif
+
+    // --------
+
+    EvdevXInput::~EvdevXInput(void)
+    {
+#ifdef __linux__
+        if (true == eventThread.joinable())
+        {
+            const uint64_t kStopSignal = 1;
+            write(kStopDescriptor, &kStopSignal, sizeof(kStopSignal));
+            eventThread.join();
+        }
+#endif
+
+        for (auto& slot : slots)
+        {
+            std::scoped_lock lock(slot.slotMutex);
+            DetachSourceLocked(slot);
+        }
+
+#ifdef __linux__
+        if (kStopDescriptor >= 0)
+            close(kStopDescriptor);
+
+        if (kEpollDescriptor >= 0)
+            close(kEpollDescriptor);
+#endif
+    }
+
+
+    // -------- INTERNAL INSTANCE METHODS ---------------------------------- //
+    // See "EvdevXInput.h" for documentation.
+
+    void EvdevXInput::DetachSourceLocked(SSlot& slot)
+    {
+#ifdef __linux__
+        if (true == slot.sourceWatched)
+            epoll_ctl(kEpollDescriptor, EPOLL_CTL_DEL, slot.source->GetWaitDescriptor(), nullptr);
+#endif
+
+        slot.sourceWatched = false;
+        slot.tracker.reset();
+        slot.source.reset();
+    }
+
+    // --------
+
+#ifdef __linux__
+    void EvdevXInput::EventThreadMain(void)
+    {
+        struct epoll_event readyEvents[kEpollMaxEvents];
+
+        while (true)
+        {
+            const int kReadyEventCount = epoll_wait(kEpollDescriptor, readyEvents, _countof(readyEvents), -1);
+
+            if (kReadyEventCount < 0)
+            {
+                if (EINTR == errno)
+                    continue;
+
+                return;
+            }
+
+            for (int i = 0; i < kReadyEventCount; ++i)
+            {
+                const uint32_t kToken = readyEvents[i].data.u32;
+
+                if (kEpollStopToken == kToken)
+                    return;
+
+                SSlot& slot = slots[kToken];
+                std::scoped_lock lock(slot.slotMutex);
+
+                // The source may have been detached between the notification and acquiring the lock.
+                if (true == slot.sourceWatched)
+                    ProcessPendingEventsLocked(slot);
+            }
+        }
+    }
+#endif
+
+    // --------
+
+    void EvdevXInput::ProcessPendingEventsLocked(SSlot& slot)
+    {
+        if (nullptr == slot.source)
+            return;
+
+        slot.eventBuffer.clear();
+        const bool kSourceConnected = slot.source->ReadEvents(slot.eventBuffer);
+
+        for (const auto& event : slot.eventBuffer)
+            slot.tracker->ApplyEvent(event);
+
+        if (false == kSourceConnected)
+        {
+            DetachSourceLocked(slot);
+            return;
+        }
+
+        if (true == slot.tracker->NeedsCurrentState())
+        {
+            // Current state is newer than anything read so far, so it is applied last and published immediately.
+            slot.eventBuffer.clear();
+            slot.source->ReadCurrentState(slot.eventBuffer);
+            slot.eventBuffer.push_back({.type = Evdev::kEventTypeSyn, .code = Evdev::kSynReport, .value = 0});
+
+            for (const auto& event : slot.eventBuffer)
+                slot.tracker->ApplyEvent(event);
+        }
+    }
+
+
+    // -------- INSTANCE METHODS ------------------------------------------- //
+    // See "EvdevXInput.h" for documentation.
+
+    bool EvdevXInput::AttachSource(DWORD userIndex, std::unique_ptr<Evdev::IEventSource>&& source)
+    {
+        if ((userIndex >= slots.size()) || (nullptr == source))
+            return false;
+
+        SSlot& slot = slots[userIndex];
+        std::scoped_lock lock(slot.slotMutex);
+
+        DetachSourceLocked(slot);
+
+        slot.tracker.emplace(source->GetAxisRanges());
+        slot.source = std::move(source);
+
+#ifdef __linux__
+        const int kWaitDescriptor = slot.source->GetWaitDescriptor();
+        if ((true == eventThread.joinable()) && (kWaitDescriptor >= 0))
+        {
+            struct epoll_event sourceRegistration = {.events = EPOLLIN, .data = {.u32 = (uint32_t)userIndex}};
+            slot.sourceWatched = (0 == epoll_ctl(kEpollDescriptor, EPOLL_CTL_ADD, kWaitDescriptor, &sourceRegistration));
+        }
+#endif
+
+        // Establish the initial state so that controllers that are idle when attached do not appear neutral until they next report something.
+        slot.eventBuffer.clear();
+        slot.source->ReadCurrentState(slot.eventBuffer);
+        if (false == slot.eventBuffer.empty())
+        {
+            slot.eventBuffer.push_back({.type = Evdev::kEventTypeSyn, .code = Evdev::kSynReport, .value = 0});
+
+            for (const auto& event : slot.eventBuffer)
+                slot.tracker->ApplyEvent(event);
+        }
+
+        return true;
+    }
+
+    // --------
+
+    void EvdevXInput::DetachSource(DWORD userIndex)
+    {
+        if (userIndex >= slots.size())
+            return;
+
+        SSlot& slot = slots[userIndex];
+        std::scoped_lock lock(slot.slotMutex);
+
+        DetachSourceLocked(slot);
+    }
+
+    // --------
+
+    bool EvdevXInput::IsSourceAttached(DWORD userIndex)
+    {
+        if (userIndex >= slots.size())
+            return false;
+
+        SSlot& slot = slots[userIndex];
+        std::scoped_lock lock(slot.slotMutex);
+
+        return (nullptr != slot.source);
+    }
+
+    // --------
+
+#ifdef __linux__
+    unsigned int EvdevXInput::AttachGamepadDevices(void)
+    {
+        unsigned int numAttached = 0;
+
+        for (const auto& devicePath : Evdev::DeviceEventSource::FindGamepadDevices())
+        {
+            if (numAttached >= slots.size())
+                break;
+
+            std::unique_ptr<Evdev::DeviceEventSource> deviceSource = Evdev::DeviceEventSource::Open(devicePath);
+            if (nullptr == deviceSource)
+                continue;
+
+            if (true == AttachSource(numAttached, std::move(deviceSource)))
+                numAttached += 1;
+        }
+
+        return numAttached;
+    }
+#endif
+
+
+    // -------- CONCRETE INSTANCE METHODS ---------------------------------- //
+    // See "XInputInterface.h" for documentation.
+
+    DWORD EvdevXInput::GetState(DWORD dwUserIndex, XINPUT_STATE* pState)
+    {
+        if ((dwUserIndex >= slots.size()) || (nullptr == pState))
+            return ERROR_BAD_ARGUMENTS;
+
+        SSlot& slot = slots[dwUserIndex];
+        std::scoped_lock lock(slot.slotMutex);
+
+        if (false == slot.sourceWatched)
+            ProcessPendingEventsLocked(slot);
+
+        if (nullptr == slot.source)
+            return ERROR_DEVICE_NOT_CONNECTED;
+
+        *pState = slot.tracker->GetState();
+        return ERROR_SUCCESS;
+    }
+}
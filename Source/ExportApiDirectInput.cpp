@@ -12,6 +12,7 @@
 
 #include "ApiDirectInput.h"
 #include "DirectInputClassFactory.h"
+#include "Globals.h"
 #include "ImportApiDirectInput.h"
 #include "Message.h"
 #include "WrapperIDirectInput.h"
@@ -58,6 +59,8 @@ extern "C"
 #if DIRECTINPUT_VERSION >= 0x0800
     HRESULT WINAPI ExportApiDirectInputDirectInput8Create(HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
     {
+        Globals::EnsureInitialized();
+
         void* diObject = nullptr;
 
         if (dwVersion < DINPUT_VER_MIN || dwVersion > DINPUT_VER_MAX)
@@ -92,6 +95,8 @@ extern "C"
 #else
     HRESULT WINAPI ExportApiDirectInputDirectInputCreateA(HINSTANCE hinst, DWORD dwVersion, LPDIRECTINPUTA* ppDI, LPUNKNOWN punkOuter)
     {
+        Globals::EnsureInitialized();
+
         IDirectInputA* diObject = nullptr;
 
         if (dwVersion < DINPUT_VER_MIN || dwVersion > DINPUT_VER_MAX)
@@ -118,6 +123,8 @@ extern "C"
 
     HRESULT WINAPI ExportApiDirectInputDirectInputCreateW(HINSTANCE hinst, DWORD dwVersion, LPDIRECTINPUTW* ppDI, LPUNKNOWN punkOuter)
     {
+        Globals::EnsureInitialized();
+
         IDirectInput* diObject = nullptr;
 
         if (dwVersion < DINPUT_VER_MIN || dwVersion > DINPUT_VER_MAX)
@@ -144,6 +151,8 @@ extern "C"
 
     HRESULT WINAPI ExportApiDirectInputDirectInputCreateEx(HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID *ppvOut, LPUNKNOWN punkOuter)
     {
+        Globals::EnsureInitialized();
+
         void* diObject = nullptr;
 
         if (dwVersion < DINPUT_VER_MIN || dwVersion > DINPUT_VER_MAX)
@@ -215,6 +224,8 @@ extern "C"
 
     HRESULT WINAPI ExportApiDirectInputDllGetClassObject(REFCLSID rclsid, REFIID riid, LPVOID* ppv)
     {
+        Globals::EnsureInitialized();
+
         if (DirectInputClassFactory::CanCreateObjectsOfClass(rclsid))
         {
             if (IsEqualIID(IID_IClassFactory, riid))
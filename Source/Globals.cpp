@@ -11,13 +11,22 @@
  *****************************************************************************/
 
 #include "ApiWindows.h"
+#include "BackgroundWorker.h"
 #include "Configuration.h"
+#include "ControlChannel.h"
+#include "ControlEndpoint.h"
 #include "Globals.h"
 #include "Mapper.h"
 #include "Message.h"
+#include "PrefetchScheduler.h"
+#include "Profiler.h"
+#include "SharedMemory.h"
+#include "Statistics.h"
 #include "Strings.h"
+#include "XInputInterface.h"
 #include "XidiConfigReader.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -25,6 +34,17 @@
 #include <string_view>
 
 
+// -------- MACROS --------------------------------------------------------- //
+
+/// Measures a startup phase for the rest of the enclosing scope.
+/// The hook module is built without the profiler, so it does not measure startup phases.
+#ifndef XIDI_SKIP_MAPPERS
+#define PROFILE_STARTUP_PHASE(phase)                const Profiler::ScopedStartupPhase profiledStartupPhase(Profiler::EStartupPhase::phase)
+#else
+#define PROFILE_STARTUP_PHASE(phase)
+#endif
+
+
 namespace Xidi
 {
     namespace Globals
@@ -78,24 +98,138 @@ namespace Xidi
             }
         };
 
+        /// Holds the most recently published configuration snapshot along with its generation number.
+        /// Readers poll the generation number without locking and only retrieve the snapshot itself, which requires a short lock, when the generation changes.
+        /// Implemented as a singleton object.
+        class PublishedConfiguration
+        {
+        public:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Serializes retrieval and replacement of the snapshot pointer. Never held while a configuration file is being read.
+            std::mutex snapshotMutex;
+
+            /// Most recently published configuration snapshot.
+            std::shared_ptr<const Configuration::Configuration> snapshot;
+
+            /// Generation number of the most recently published configuration snapshot.
+            std::atomic<uint32_t> generation;
+
+
+        private:
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor. Objects cannot be constructed externally.
+            PublishedConfiguration(void) : snapshotMutex(), snapshot(), generation(0)
+            {
+                // Nothing to do here.
+            }
+
+            /// Copy constructor. Should never be invoked.
+            PublishedConfiguration(const PublishedConfiguration& other) = delete;
+
+
+        public:
+            // -------- CLASS METHODS -------------------------------------- //
+
+            /// Returns a reference to the singleton instance of this class.
+            /// The first invocation reads the configuration file to produce the initial snapshot.
+            /// @return Reference to the singleton instance.
+            static PublishedConfiguration& GetInstance(void);
+        };
+
+
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Time to wait after a change to the configuration file is detected before reading it.
+        /// Text editors frequently save files in multiple steps, and reading too early could observe a partially-written file.
+        static constexpr uint64_t kConfigurationReloadSettleTimeNanoseconds = 250000000ull;
+
+        /// Maximum time the configuration file watcher waits for a change notification before checking whether it has been asked to stop.
+        static constexpr DWORD kConfigurationWatcherStopCheckIntervalMilliseconds = 1000;
+
+
+        // -------- INTERNAL VARIABLES ------------------------------------- //
+
+        /// Background thread that watches the configuration file for changes, if hot reload is enabled.
+        /// Created the first time it is needed and never destroyed, so that it can still be abandoned as the process terminates.
+        static BackgroundWorker* configurationWatcher = nullptr;
+
 
         // -------- INTERNAL FUNCTIONS ------------------------------------- //
 
+        /// Reads the configuration file and produces a new configuration snapshot from its contents.
+        /// @return Newly-created configuration snapshot.
+        static std::shared_ptr<Configuration::Configuration> ReadConfigurationSnapshot(void)
+        {
+            std::shared_ptr<Configuration::Configuration> configuration = std::make_shared<Configuration::Configuration>(std::make_unique<XidiConfigReader>());
+            configuration->ReadConfigurationFile(Strings::kStrConfigurationFilename);
+            return configuration;
+        }
+
+        /// Retrieves the last modification time of the configuration file.
+        /// @return Last modification time, or all zeroes if the file does not exist or could not be queried.
+        static FILETIME GetConfigurationFileLastWriteTime(void)
+        {
+            WIN32_FILE_ATTRIBUTE_DATA fileAttributes;
+
+            if (FALSE == GetFileAttributesEx(Strings::kStrConfigurationFilename.data(), GetFileExInfoStandard, &fileAttributes))
+                return FILETIME();
+
+            return fileAttributes.ftLastWriteTime;
+        }
+
+        /// Body of the configuration file watcher thread.
+        /// Waits for changes in the directory that contains the configuration file and reloads the configuration whenever the configuration file itself is modified, until asked to stop.
+        /// @param [in] changeNotificationHandle Change notification handle for the directory that contains the configuration file. Owned by this thread.
+        static void ConfigurationWatcherThreadMain(HANDLE changeNotificationHandle)
+        {
+            FILETIME lastWriteTime = GetConfigurationFileLastWriteTime();
+
+            while (false == configurationWatcher->IsStopRequested())
+            {
+                const DWORD kWaitResult = WaitForSingleObject(changeNotificationHandle, kConfigurationWatcherStopCheckIntervalMilliseconds);
+                if (WAIT_TIMEOUT == kWaitResult)
+                    continue;
+                else if (WAIT_OBJECT_0 != kWaitResult)
+                    break;
+
+                if (false == configurationWatcher->WaitFor(kConfigurationReloadSettleTimeNanoseconds))
+                    break;
+
+                // Notifications are delivered for any file in the directory, so only reload if the configuration file itself changed.
+                const FILETIME kNewLastWriteTime = GetConfigurationFileLastWriteTime();
+                if (0 != CompareFileTime(&kNewLastWriteTime, &lastWriteTime))
+                {
+                    lastWriteTime = kNewLastWriteTime;
+                    ReloadConfiguration();
+                }
+
+                if (FALSE == FindNextChangeNotification(changeNotificationHandle))
+                    break;
+            }
+
+            if (false == configurationWatcher->IsStopRequested())
+                Message::Output(Message::ESeverity::Warning, L"Stopped watching the configuration file for changes.");
+
+            FindCloseChangeNotification(changeNotificationHandle);
+        }
+
         /// Enables the log, if it is configured in the configuration file.
         static void EnableLogIfConfigured(void)
         {
-            const Configuration::Configuration& config = GetConfiguration();
+            const std::shared_ptr<const Configuration::Configuration> config = GetConfiguration();
 
             bool logEnabled = false;
             int64_t logLevel = 0;
 
-            if (true == config.IsDataValid())
+            if (true == config->IsDataValid())
             {
-                if (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionLog, Strings::kStrConfigurationSettingLogEnabled))
-                    logEnabled = config.GetData()[Strings::kStrConfigurationSectionLog][Strings::kStrConfigurationSettingLogEnabled].FirstValue().GetBooleanValue();
+                if (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionLog, Strings::kStrConfigurationSettingLogEnabled))
+                    logEnabled = config->GetData()[Strings::kStrConfigurationSectionLog][Strings::kStrConfigurationSettingLogEnabled].FirstValue().GetBooleanValue();
 
-                if (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionLog, Strings::kStrConfigurationSettingLogLevel))
-                    logLevel = config.GetData()[Strings::kStrConfigurationSectionLog][Strings::kStrConfigurationSettingLogLevel].FirstValue().GetIntegerValue();
+                if (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionLog, Strings::kStrConfigurationSettingLogLevel))
+                    logLevel = config->GetData()[Strings::kStrConfigurationSectionLog][Strings::kStrConfigurationSettingLogLevel].FirstValue().GetIntegerValue();
             }
 
             if ((true == logEnabled) && (logLevel > 0))
@@ -109,24 +243,113 @@ namespace Xidi
         }
 
 
-        // -------- FUNCTIONS ---------------------------------------------- //
-        // See "Globals.h" for documentation.
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See above for documentation.
 
-        const Configuration::Configuration& GetConfiguration(void)
+        PublishedConfiguration& PublishedConfiguration::GetInstance(void)
         {
-            static Configuration::Configuration configuration(std::make_unique<XidiConfigReader>());
+            static PublishedConfiguration publishedConfiguration;
 
             static std::once_flag readConfigFlag;
             std::call_once(readConfigFlag, []() -> void
                 {
-                    configuration.ReadConfigurationFile(Strings::kStrConfigurationFilename);
+                    publishedConfiguration.snapshot = ReadConfigurationSnapshot();
 
-                    if (Configuration::EFileReadResult::Malformed == configuration.GetFileReadResult())
-                        Message::Output(Message::ESeverity::ForcedInteractiveError, configuration.GetReadErrorMessage().data());
+                    if (Configuration::EFileReadResult::Malformed == publishedConfiguration.snapshot->GetFileReadResult())
+                        Message::Output(Message::ESeverity::ForcedInteractiveError, publishedConfiguration.snapshot->GetReadErrorMessage().data());
                 }
             );
 
-            return configuration;
+            return publishedConfiguration;
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Globals.h" for documentation.
+
+        void EnsureInitialized(void)
+        {
+            static std::once_flag initializeFlag;
+            std::call_once(initializeFlag, []() -> void
+                {
+                    {
+                        PROFILE_STARTUP_PHASE(ConfigurationRead);
+                        GetConfiguration();
+                    }
+
+                    {
+                        PROFILE_STARTUP_PHASE(LogEnable);
+                        EnableLogIfConfigured();
+                    }
+
+#ifndef XIDI_SKIP_MAPPERS
+                    const std::shared_ptr<const Configuration::Configuration> config = GetConfiguration();
+
+                    {
+                        PROFILE_STARTUP_PHASE(MapperRegistration);
+
+                        if (true == config->IsDataValid())
+                            Controller::Mapper::LoadCustomMappers(config->GetData());
+
+                        Controller::Mapper::DumpRegisteredMappers();
+                    }
+
+                    {
+                        PROFILE_STARTUP_PHASE(FeatureStartup);
+
+                        if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionStatistics, Strings::kStrConfigurationSettingStatisticsEnabled)) && (true == config->GetData()[Strings::kStrConfigurationSectionStatistics][Strings::kStrConfigurationSettingStatisticsEnabled].FirstValue().GetBooleanValue()))
+                        {
+                            if (true == Statistics::Publish(std::make_unique<SharedMemory>(), GetCurrentProcessId()))
+                                Message::OutputFormatted(Message::ESeverity::Info, L"Exporting live statistics to shared memory segment %s.", Statistics::SegmentName(GetCurrentProcessId()).c_str());
+                            else
+                                Message::Output(Message::ESeverity::Warning, L"Failed to create the shared memory segment for exporting live statistics.");
+                        }
+
+                        if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionProfiler, Strings::kStrConfigurationSettingProfilerEnabled)) && (true == config->GetData()[Strings::kStrConfigurationSectionProfiler][Strings::kStrConfigurationSettingProfilerEnabled].FirstValue().GetBooleanValue()))
+                        {
+                            Profiler::Enable();
+                            Message::Output(Message::ESeverity::Info, L"Profiling application calls. A report will be output when the process exits.");
+                        }
+
+                        if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionPrefetch, Strings::kStrConfigurationSettingPrefetchEnabled)) && (true == config->GetData()[Strings::kStrConfigurationSectionPrefetch][Strings::kStrConfigurationSettingPrefetchEnabled].FirstValue().GetBooleanValue()))
+                        {
+                            uint64_t prefetchLeadTime = Controller::PrefetchScheduler::kDefaultLeadTime;
+
+                            if ((true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionPrefetch, Strings::kStrConfigurationSettingPrefetchLeadTimeMicroseconds)) && (config->GetData()[Strings::kStrConfigurationSectionPrefetch][Strings::kStrConfigurationSettingPrefetchLeadTimeMicroseconds].FirstValue().GetIntegerValue() > 0))
+                                prefetchLeadTime = (uint64_t)config->GetData()[Strings::kStrConfigurationSectionPrefetch][Strings::kStrConfigurationSettingPrefetchLeadTimeMicroseconds].FirstValue().GetIntegerValue() * 1000ull;
+
+                            Controller::PrefetchScheduler::GetDefault().Start(prefetchLeadTime);
+                            Message::OutputFormatted(Message::ESeverity::Info, L"Reading controllers %llu microseconds ahead of predicted application reads.", (unsigned long long)(prefetchLeadTime / 1000ull));
+                        }
+
+                        if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionControl, Strings::kStrConfigurationSettingControlEnabled)) && (true == config->GetData()[Strings::kStrConfigurationSectionControl][Strings::kStrConfigurationSettingControlEnabled].FirstValue().GetBooleanValue()))
+                        {
+                            Controller::ControlEndpoint::GetDefault().Start(std::make_unique<LocalControlListener>(GetCurrentProcessId()));
+                            Message::OutputFormatted(Message::ESeverity::Info, L"Accepting control connections on %S.", LocalControlListener::EndpointName(GetCurrentProcessId()).c_str());
+                        }
+                    }
+
+                    Profiler::OutputStartupTrace();
+#endif
+                }
+            );
+        }
+
+        // --------
+
+        std::shared_ptr<const Configuration::Configuration> GetConfiguration(void)
+        {
+            PublishedConfiguration& publishedConfiguration = PublishedConfiguration::GetInstance();
+
+            std::scoped_lock lock(publishedConfiguration.snapshotMutex);
+            return publishedConfiguration.snapshot;
+        }
+
+        // --------
+
+        uint32_t GetConfigurationGeneration(void)
+        {
+            return PublishedConfiguration::GetInstance().generation.load(std::memory_order_acquire);
         }
 
         // --------
@@ -159,12 +382,91 @@ namespace Xidi
 
         // --------
 
+        bool ReloadConfiguration(void)
+        {
+            PublishedConfiguration& publishedConfiguration = PublishedConfiguration::GetInstance();
+
+            // Parsing happens without holding any locks so that readers are never blocked by file I/O.
+            std::shared_ptr<const Configuration::Configuration> configuration = ReadConfigurationSnapshot();
+            if (Configuration::EFileReadResult::Malformed == configuration->GetFileReadResult())
+            {
+                Message::OutputFormatted(Message::ESeverity::Warning, L"Ignoring configuration file reload because the file is malformed: %s", configuration->GetReadErrorMessage().data());
+                return false;
+            }
+
+            // The previous snapshot is released outside the lock. It is destroyed once every reader that still holds it lets go.
+            uint32_t newGeneration = 0;
+
+            {
+                std::scoped_lock lock(publishedConfiguration.snapshotMutex);
+                publishedConfiguration.snapshot.swap(configuration);
+                newGeneration = 1 + publishedConfiguration.generation.fetch_add(1, std::memory_order_acq_rel);
+            }
+
+            Message::OutputFormatted(Message::ESeverity::Info, L"Reloaded the configuration file. Configuration generation is now %u.", newGeneration);
+            return true;
+        }
+
+        // --------
+
+        void StartConfigurationWatcherIfConfigured(void)
+        {
+            static std::once_flag startWatcherFlag;
+            std::call_once(startWatcherFlag, []() -> void
+                {
+                    const std::shared_ptr<const Configuration::Configuration> config = GetConfiguration();
+
+                    if ((true != config->IsDataValid()) || (true != config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionConfiguration, Strings::kStrConfigurationSettingConfigurationHotReload)))
+                        return;
+
+                    if (true != config->GetData()[Strings::kStrConfigurationSectionConfiguration][Strings::kStrConfigurationSettingConfigurationHotReload].FirstValue().GetBooleanValue())
+                        return;
+
+                    const HANDLE changeNotificationHandle = FindFirstChangeNotification(Strings::kStrExecutableDirectoryName.data(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+                    if (INVALID_HANDLE_VALUE == changeNotificationHandle)
+                    {
+                        Message::OutputFormatted(Message::ESeverity::Warning, L"Unable to watch the configuration file for changes: %s", Strings::SystemErrorCodeString(GetLastError()).c_str());
+                        return;
+                    }
+
+                    Message::OutputFormatted(Message::ESeverity::Info, L"Watching configuration file %s for changes.", Strings::kStrConfigurationFilename.data());
+                    configurationWatcher = new BackgroundWorker();
+                    configurationWatcher->Start([changeNotificationHandle]() -> void { ConfigurationWatcherThreadMain(changeNotificationHandle); });
+                }
+            );
+        }
+
+        // --------
+
         void Initialize(void)
         {
-            EnableLogIfConfigured();
+            PROFILE_STARTUP_PHASE(LibraryAttach);
+
+            // Global data consists of a few inexpensive queries to the system, so it is the only thing worth capturing right away.
+            GlobalData::GetInstance();
+        }
+
+        // --------
+
+        void Shutdown(bool processTerminating)
+        {
+            // By the time the process terminates, the operating system has already exited all other threads, possibly while they were holding locks.
+            if (true == processTerminating)
+            {
+                if (nullptr != configurationWatcher)
+                    configurationWatcher->Abandon();
+
+#ifndef XIDI_SKIP_MAPPERS
+                Controller::ControlEndpoint::GetDefault().Abandon();
+                Controller::PrefetchScheduler::GetDefault().Abandon();
+                AbandonNativeXInputSharing();
+#endif
+            }
 
 #ifndef XIDI_SKIP_MAPPERS
-            Controller::Mapper::DumpRegisteredMappers();
+            // Taking the report requires a lock that any of those threads might have been holding, so it is only output if the library is unloaded while the process keeps running.
+            if (false == processTerminating)
+                Profiler::OutputReport();
 #endif
         }
     }
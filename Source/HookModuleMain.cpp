@@ -9,6 +9,7 @@
  *   Entry point when injecting Xidi as a hook module.
  *****************************************************************************/
 
+#include "Globals.h"
 #include "Hooks.h"
 #include "Message.h"
 
@@ -35,5 +36,7 @@ namespace Xidi
 /// Hook module entry point. 
 HOOKSHOT_HOOK_MODULE_ENTRY(hookshot)
 {
+    Xidi::Globals::EnsureInitialized();
+
     Xidi::OutputSetHookResult(L"CoCreateInstance", StaticHook_CoCreateInstance::SetHook(hookshot));
 }
@@ -17,7 +17,9 @@
 #include "Message.h"
 #include "Strings.h"
 
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
 
 
@@ -54,33 +56,33 @@ namespace Xidi
 
         /// Retrieves the library path for the DirectInput library that should be used for importing functions.
         /// @return Library path.
-        static std::wstring_view GetImportLibraryPathDirectInput(void)
+        static std::wstring GetImportLibraryPathDirectInput(void)
         {
-            const Configuration::Configuration& config = Globals::GetConfiguration();
+            const std::shared_ptr<const Configuration::Configuration> config = Globals::GetConfiguration();
 
-            if ((true == config.IsDataValid()) && (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportDirectInput)))
+            if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportDirectInput)))
             {
-                return config.GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportDirectInput].FirstValue().GetStringValue();
+                return std::wstring(config->GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportDirectInput].FirstValue().GetStringValue());
             }
             else
             {
-                return Strings::kStrSystemLibraryFilenameDirectInput;
+                return std::wstring(Strings::kStrSystemLibraryFilenameDirectInput);
             }
         }
 
         /// Retrieves the library path for the DirectInput8 library that should be used for importing functions.
         /// @return Library path.
-        static std::wstring_view GetImportLibraryPathDirectInput8(void)
+        static std::wstring GetImportLibraryPathDirectInput8(void)
         {
-            const Configuration::Configuration& config = Globals::GetConfiguration();
+            const std::shared_ptr<const Configuration::Configuration> config = Globals::GetConfiguration();
 
-            if ((true == config.IsDataValid()) && (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportDirectInput8)))
+            if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportDirectInput8)))
             {
-                return config.GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportDirectInput8].FirstValue().GetStringValue();
+                return std::wstring(config->GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportDirectInput8].FirstValue().GetStringValue());
             }
             else
             {
-                return Strings::kStrSystemLibraryFilenameDirectInput8;
+                return std::wstring(Strings::kStrSystemLibraryFilenameDirectInput8);
             }
         }
 
@@ -132,9 +134,9 @@ namespace Xidi
 
                     // Obtain the full library path string.
 #if DIRECTINPUT_VERSION >= 0x0800
-                    std::wstring_view libraryPath = GetImportLibraryPathDirectInput8();
+                    const std::wstring libraryPath = GetImportLibraryPathDirectInput8();
 #else
-                    std::wstring_view libraryPath = GetImportLibraryPathDirectInput();
+                    const std::wstring libraryPath = GetImportLibraryPathDirectInput();
 #endif
 
                     // Attempt to load the library.
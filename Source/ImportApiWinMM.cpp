@@ -17,7 +17,9 @@
 #include "Message.h"
 #include "Strings.h"
 
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
 
 
@@ -227,17 +229,17 @@ namespace Xidi
 
         /// Retrieves the library path for the WinMM library that should be used for importing functions.
         /// @return Library path.
-        static std::wstring_view GetImportLibraryPathWinMM(void)
+        static std::wstring GetImportLibraryPathWinMM(void)
         {
-            const Configuration::Configuration& config = Globals::GetConfiguration();
+            const std::shared_ptr<const Configuration::Configuration> config = Globals::GetConfiguration();
 
-            if ((true == config.IsDataValid()) && (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportWinMM)))
+            if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionImport, Strings::kStrConfigurationSettingImportWinMM)))
             {
-                return config.GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportWinMM].FirstValue().GetStringValue();
+                return std::wstring(config->GetData()[Strings::kStrConfigurationSectionImport][Strings::kStrConfigurationSettingImportWinMM].FirstValue().GetStringValue());
             }
             else
             {
-                return Strings::kStrSystemLibraryFilenameWinMM;
+                return std::wstring(Strings::kStrSystemLibraryFilenameWinMM);
             }
         }
 
@@ -288,7 +290,7 @@ namespace Xidi
                     ZeroMemory(&importTable, sizeof(importTable));
 
                     // Obtain the full library path string.
-                    std::wstring_view libraryPath = GetImportLibraryPathWinMM();
+                    const std::wstring libraryPath = GetImportLibraryPathWinMM();
 
                     // Attempt to load the library.
                     LogInitializeLibraryPath(libraryPath.data());
@@ -10,20 +10,26 @@
  *   XInput controller layout to a virtual controller layout.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
 #include "Configuration.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "Globals.h"
 #include "Mapper.h"
+#include "MapperParser.h"
 #include "Message.h"
 #include "Strings.h"
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <set>
+#include <optional>
+#include <string>
 #include <string_view>
-#include <xinput.h>
+#include <variant>
+#include <vector>
 
 
 namespace Xidi
@@ -32,147 +38,123 @@ namespace Xidi
     {
         // -------- INTERNAL TYPES ----------------------------------------- //
 
-        /// Holds a mapping from strings to instances of mapper objects.
-        /// Implemented as a singleton object and intended for internal use.
-        class MapperRegistry
+        /// Mapper compiled from a custom mapper definition in the configuration file.
+        /// Element mappers are stored by value alongside the mapper that references them, so compiling a custom mapper allocates only this object and its name.
+        /// The mapper references its element mappers exactly the way built-in mappers reference their compile-time constant element mappers, so mapping works identically for both.
+        class CustomMapper
         {
-        private:
-            // -------- INSTANCE VARIABLES --------------------------------- //
-
-            /// Implements the registry of known mappers.
-            std::map<std::wstring_view, const Mapper*> knownMappers;
-
-            /// Holds the map key that corresponds to the default mapper.
-            /// The first type of mapper that is registered becomes the default.
-            std::wstring_view defaultMapper;
-
-
-            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
-
-            /// Default constructor. Objects cannot be constructed externally.
-            MapperRegistry(void) = default;
-
-
         public:
-            // -------- CLASS METHODS -------------------------------------- //
-
-            /// Returns a reference to the singleton instance of this class.
-            /// @return Reference to the singleton instance.
-            static MapperRegistry& GetInstance(void)
-            {
-                static MapperRegistry mapperRegistry;
-                return mapperRegistry;
-            }
+            // -------- TYPE DEFINITIONS ----------------------------------- //
 
+            /// Storage for a single element mapper of any type that can appear in a custom mapper definition.
+            typedef std::variant<std::monostate, AxisMapper, DigitalAxisMapper, ButtonMapper, PovMapper> TElementMapperStorage;
 
-            // -------- INSTANCE METHODS ----------------------------------- //
 
-            /// Dumps all mappers in this registry.
-            void DumpRegisteredMappers(void)
-            {
-                constexpr Message::ESeverity kDumpSeverity = Message::ESeverity::Info;
+            // -------- INSTANCE VARIABLES --------------------------------- //
 
-                if (Message::WillOutputMessageOfSeverity(kDumpSeverity))
-                {
-                    Message::Output(kDumpSeverity, L"Begin dump of all known mappers.");
+            /// Name of the custom mapper. The mapper refers to this string rather than to configuration data, which can be released when the configuration is reloaded.
+            const std::wstring name;
 
-                    Message::Output(kDumpSeverity, L"  Default:");
-                    Message::OutputFormatted(kDumpSeverity, L"    %s", defaultMapper);
+            /// Definition from which the custom mapper was compiled. Used to detect whether a reloaded definition has changed.
+            const MapperParser::TMapperSpec spec;
 
-                    Message::Output(kDumpSeverity, L"  All:");
-                    
-                    for (const auto& knownMapper : knownMappers)
-                    {
-                        const std::wstring_view kKnownMapperName = knownMapper.first;
-                        const SCapabilities kKnownMapperCapabilities = knownMapper.second->GetCapabilities();
-                        Message::OutputFormatted(kDumpSeverity, L"    %-24s { numAxes = %u, numButtons = %u, hasPov = %s }", kKnownMapperName.data(), (unsigned int)kKnownMapperCapabilities.numAxes, (unsigned int)kKnownMapperCapabilities.numButtons, ((true == kKnownMapperCapabilities.hasPov) ? L"true" : L"false"));
-                    }
+            /// Element mappers, one per XInput controller element, indexed by #Mapper::EXInputElement.
+            TElementMapperStorage elementMappers[(int)Mapper::EXInputElement::Count];
 
-                    Message::Output(kDumpSeverity, L"End dump of all known mappers.");
-                }
-            }
-            
-            /// Registers a mapper object with this registry.
-            /// @param [in] name Name to associate with the mapper.
-            /// @param [in] object Corresponding mapper object.
-            void RegisterMapper(std::wstring_view name, const Mapper* object)
-            {
-                knownMappers[name] = object;
-                
-                if (true == defaultMapper.empty())
-                    defaultMapper = name;
-            }
+            /// Compiled mapper.
+            /// Initialization of this member depends on prior initialization of #name and #elementMappers so it must come after.
+            const Mapper mapper;
 
-            /// Retrieves a pointer to the mapper object that corresponds to the specified name, if it exists.
-            /// @param [in] mapperName Desired mapper name.
-            /// @return Pointer to the corresponding mapper object, or `nullptr` if it does not exist in the registry.
-            const Mapper* GetMapper(std::wstring_view mapperName)
-            {
-                if (true == mapperName.empty())
-                    mapperName = defaultMapper;
 
-                const auto mapperRecord = knownMappers.find(mapperName);
-                if (knownMappers.cend() != mapperRecord)
-                    return mapperRecord->second;
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
 
-                return nullptr;
+            /// Initialization constructor.
+            /// Compiles a custom mapper definition.
+            /// @param [in] name Name of the custom mapper.
+            /// @param [in] spec Definition of the custom mapper.
+            inline CustomMapper(std::wstring_view name, const MapperParser::TMapperSpec& spec) : name(name), spec(spec), elementMappers(), mapper(this->name, EmplaceElementMappers(spec, elementMappers))
+            {
+                // Nothing to do here.
             }
-        };
-
 
-        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+            /// Copy constructor. Should never be invoked.
+            CustomMapper(const CustomMapper& other) = delete;
 
-        /// Derives the capabilities of the controller that is described by the specified element mappers in aggregate.
-        /// Number of axes is determined as the total number of unique axes on the virtual controller to which element mappers contribute.
-        /// Number of buttons is determined by looking at the highest button number to which element mappers contribute.
-        /// Presence or absence of a POV is determined by whether or not any element mappers contribute to a POV direction, even if not all POV directions have a contribution.
-        /// @param [in] elements Per-element controller map.
-        /// @return Virtual controller capabilities as derived from the per-element map in aggregate.
-        static SCapabilities DeriveCapabilitiesFromElementMap(const Mapper::UElementMap& elements)
-        {
-            SCapabilities capabilities;
-            ZeroMemory(&capabilities, sizeof(capabilities));
 
-            std::set<EAxis> axesPresent;
-            int highestButtonSeen = -1;
-            bool povPresent = false;
+        private:
+            // -------- INTERNAL CLASS METHODS ----------------------------- //
 
-            for (int i = 0; i < _countof(elements.all); ++i)
+            /// Creates element mappers according to a custom mapper definition.
+            /// @param [in] spec Definition of the custom mapper.
+            /// @param [out] elementMappers Storage in which to create the element mappers.
+            /// @return Element mappers, one per XInput controller element, which refer to the storage.
+            static Mapper::TElementMappers EmplaceElementMappers(const MapperParser::TMapperSpec& spec, TElementMapperStorage (&elementMappers)[(int)Mapper::EXInputElement::Count])
             {
-                if (nullptr != elements.all[i])
+                Mapper::TElementMappers elementMapperPointers = {};
+
+                for (int i = 0; i < (int)spec.size(); ++i)
                 {
-                    const SElementIdentifier targetElement = elements.all[i]->GetTargetElement();
-                    switch (targetElement.type)
+                    switch (spec[i].type)
                     {
-                    case EElementType::Axis:
-                        if ((int)targetElement.axis < (int)EAxis::Count)
-                            axesPresent.insert(targetElement.axis);
+                    case MapperParser::EElementMapperType::Axis:
+                        elementMapperPointers[i] = &elementMappers[i].emplace<AxisMapper>(spec[i].axis, spec[i].axisDirection);
+                        break;
+
+                    case MapperParser::EElementMapperType::DigitalAxis:
+                        elementMapperPointers[i] = &elementMappers[i].emplace<DigitalAxisMapper>(spec[i].axis, spec[i].axisDirection);
                         break;
 
-                    case EElementType::Button:
-                        if ((int)targetElement.button < (int)EButton::Count)
-                        {
-                            if ((int)targetElement.button > highestButtonSeen)
-                                highestButtonSeen = (int)targetElement.button;
-                        }
+                    case MapperParser::EElementMapperType::Button:
+                        elementMapperPointers[i] = &elementMappers[i].emplace<ButtonMapper>(spec[i].button);
                         break;
 
-                    case EElementType::Pov:
-                        povPresent = true;
+                    case MapperParser::EElementMapperType::Pov:
+                        if (true == spec[i].maybePovDirectionNegative.has_value())
+                            elementMapperPointers[i] = &elementMappers[i].emplace<PovMapper>(spec[i].povDirection, spec[i].maybePovDirectionNegative.value());
+                        else
+                            elementMapperPointers[i] = &elementMappers[i].emplace<PovMapper>(spec[i].povDirection);
+                        break;
+
+                    default:
                         break;
                     }
                 }
+
+                return elementMapperPointers;
             }
+        };
+
+        /// Holds all custom mappers that have been compiled.
+        struct SCustomMapperRegistry
+        {
+            std::mutex mutex;                                               ///< Serializes access to the registry.
+            std::vector<std::unique_ptr<const CustomMapper>> compiled;      ///< Every custom mapper ever compiled. Never shrinks, so that mappers remain valid for as long as virtual controllers might refer to them.
+            std::vector<const CustomMapper*> active;                        ///< Custom mappers defined by the most recently loaded configuration, sorted by name.
+        };
 
-            for (auto it = axesPresent.cbegin(); it != axesPresent.cend(); ++it)
-                capabilities.AppendAxis(*it);
 
-            capabilities.numButtons = highestButtonSeen + 1;
-            capabilities.hasPov = povPresent;
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
 
-            return capabilities;
+        /// Retrieves the registry of custom mappers.
+        /// @return Custom mapper registry.
+        static SCustomMapperRegistry& GetCustomMapperRegistry(void)
+        {
+            static SCustomMapperRegistry customMapperRegistry;
+            return customMapperRegistry;
         }
 
+        /// Collects the element mappers held in an owned element map.
+        /// @param [in] elements Owned element map.
+        /// @return Element mappers, one per XInput controller element.
+        static Mapper::TElementMappers ElementMappersFromOwnedElementMap(const Mapper::UElementMap& elements)
+        {
+            Mapper::TElementMappers elementMappers = {};
+
+            for (unsigned int i = 0; i < _countof(elements.all); ++i)
+                elementMappers[i] = elements.all[i].get();
+
+            return elementMappers;
+        }
 
         /// Filters (by saturation) analog stick values that might be slightly out of range due to differences between the implemented range and the XInput actual range.
         /// @param [in] analogValue Raw analog value.
@@ -196,14 +178,150 @@ namespace Xidi
             return -FilterAnalogStickValue(analogValue);
         }
 
+        /// Bitmask within the XInput button state that corresponds to each XInput controller element, or 0 for controller elements that are not digital buttons.
+        static constexpr WORD kXInputButtonMask[] = {
+            0,
+            0,
+            0,
+            0,
+            XINPUT_GAMEPAD_DPAD_UP,
+            XINPUT_GAMEPAD_DPAD_DOWN,
+            XINPUT_GAMEPAD_DPAD_LEFT,
+            XINPUT_GAMEPAD_DPAD_RIGHT,
+            0,
+            0,
+            XINPUT_GAMEPAD_A,
+            XINPUT_GAMEPAD_B,
+            XINPUT_GAMEPAD_X,
+            XINPUT_GAMEPAD_Y,
+            XINPUT_GAMEPAD_LEFT_SHOULDER,
+            XINPUT_GAMEPAD_RIGHT_SHOULDER,
+            XINPUT_GAMEPAD_BACK,
+            XINPUT_GAMEPAD_START,
+            XINPUT_GAMEPAD_LEFT_THUMB,
+            XINPUT_GAMEPAD_RIGHT_THUMB
+        };
+        static_assert(_countof(kXInputButtonMask) == (int)Mapper::EXInputElement::Count, "XInput button mask table mismatch.");
+
+        /// Causes a single element mapper to contribute to a virtual controller state based on the value of the XInput controller element it maps.
+        /// Left and right stick values need to be saturated at the virtual controller range due to a very slight difference between XInput range and virtual controller range.
+        /// This difference (-32768 extreme negative for XInput vs -32767 extreme negative for Xidi) does not affect functionality when filtered by saturation.
+        /// Vertical analog axes additionally need to be inverted because XInput presents up as positive and down as negative whereas Xidi needs to do the opposite.
+        /// @param [in] elementMapper Element mapper that maps the XInput controller element.
+        /// @param [in] element XInput controller element being mapped.
+        /// @param [in,out] controllerState Controller state object to which to contribute.
+        /// @param [in] xinputState XInput controller state from which to read.
+        static inline void ContributeFromXInputElement(const IElementMapper& elementMapper, Mapper::EXInputElement element, SState& controllerState, const XINPUT_GAMEPAD& xinputState)
+        {
+            switch (element)
+            {
+            case Mapper::EXInputElement::StickLeftX:
+                elementMapper.ContributeFromAnalogValue(controllerState, FilterAnalogStickValue(xinputState.sThumbLX));
+                break;
+            case Mapper::EXInputElement::StickLeftY:
+                elementMapper.ContributeFromAnalogValue(controllerState, FilterAndInvertAnalogStickValue(xinputState.sThumbLY));
+                break;
+            case Mapper::EXInputElement::StickRightX:
+                elementMapper.ContributeFromAnalogValue(controllerState, FilterAnalogStickValue(xinputState.sThumbRX));
+                break;
+            case Mapper::EXInputElement::StickRightY:
+                elementMapper.ContributeFromAnalogValue(controllerState, FilterAndInvertAnalogStickValue(xinputState.sThumbRY));
+                break;
+            case Mapper::EXInputElement::TriggerLT:
+                elementMapper.ContributeFromTriggerValue(controllerState, xinputState.bLeftTrigger);
+                break;
+            case Mapper::EXInputElement::TriggerRT:
+                elementMapper.ContributeFromTriggerValue(controllerState, xinputState.bRightTrigger);
+                break;
+            default:
+                elementMapper.ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & kXInputButtonMask[(int)element])));
+                break;
+            }
+        }
+
+        /// Causes a single element mapper to contribute to a batch of virtual controller states based on the values of the XInput controller element it maps in every slot.
+        /// Values are filtered and inverted exactly as in #ContributeFromXInputElement, for all slots at once, before the element mapper is invoked once for the whole batch.
+        /// @param [in] elementMapper Element mapper that maps the XInput controller element.
+        /// @param [in] element XInput controller element being mapped.
+        /// @param [in,out] controllerStates Controller state batch to which to contribute.
+        /// @param [in] xinputStates XInput controller state batch from which to read.
+        /// @param [in] slotCount Number of slots to process.
+        static inline void ContributeFromXInputElementBatch(const IElementMapper& elementMapper, Mapper::EXInputElement element, SStateBatch& controllerStates, const Mapper::SXInputBatch& xinputStates, unsigned int slotCount)
+        {
+            alignas(16) int16_t analogValues[kBatchSlotCountMax];
+            alignas(16) uint8_t buttonsPressed[kBatchSlotCountMax];
+
+            switch (element)
+            {
+            case Mapper::EXInputElement::StickLeftX:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    analogValues[i] = FilterAnalogStickValue(xinputStates.thumbLX[i]);
+                elementMapper.ContributeFromAnalogValues(controllerStates, analogValues, slotCount);
+                break;
+            case Mapper::EXInputElement::StickLeftY:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    analogValues[i] = FilterAndInvertAnalogStickValue(xinputStates.thumbLY[i]);
+                elementMapper.ContributeFromAnalogValues(controllerStates, analogValues, slotCount);
+                break;
+            case Mapper::EXInputElement::StickRightX:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    analogValues[i] = FilterAnalogStickValue(xinputStates.thumbRX[i]);
+                elementMapper.ContributeFromAnalogValues(controllerStates, analogValues, slotCount);
+                break;
+            case Mapper::EXInputElement::StickRightY:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    analogValues[i] = FilterAndInvertAnalogStickValue(xinputStates.thumbRY[i]);
+                elementMapper.ContributeFromAnalogValues(controllerStates, analogValues, slotCount);
+                break;
+            case Mapper::EXInputElement::TriggerLT:
+                elementMapper.ContributeFromTriggerValues(controllerStates, xinputStates.leftTrigger, slotCount);
+                break;
+            case Mapper::EXInputElement::TriggerRT:
+                elementMapper.ContributeFromTriggerValues(controllerStates, xinputStates.rightTrigger, slotCount);
+                break;
+            default:
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    buttonsPressed[i] = (uint8_t)(0 != (xinputStates.buttons[i] & kXInputButtonMask[(int)element]));
+                elementMapper.ContributeFromButtonValues(controllerStates, buttonsPressed, slotCount);
+                break;
+            }
+        }
+
+        /// Saturates all axis values at the extreme ends of the allowed range.
+        /// Doing this after all contributions have been committed means that intermediate contributions are computed with much more range than the controller is allowed to report, which can increase accuracy when there are multiple interfering mappers contributing to axes.
+        /// @param [in,out] controllerState Controller state object whose axis values are to be saturated.
+        static inline void SaturateAxisValues(SState& controllerState)
+        {
+            for (auto& axisValue : controllerState.axis)
+            {
+                if (axisValue > kAnalogValueMax)
+                    axisValue = kAnalogValueMax;
+                else if (axisValue < kAnalogValueMin)
+                    axisValue = kAnalogValueMin;
+            }
+        }
+
+        /// Saturates all axis values in a batch of virtual controller states at the extreme ends of the allowed range.
+        /// Result in each slot is identical to the result of #SaturateAxisValues.
+        /// @param [in,out] controllerStates Controller state batch whose axis values are to be saturated.
+        /// @param [in] slotCount Number of slots to process.
+        static inline void SaturateAxisValueBatch(SStateBatch& controllerStates, unsigned int slotCount)
+        {
+            for (auto& axisValues : controllerStates.axis)
+            {
+                for (unsigned int i = 0; i < slotCount; ++i)
+                    axisValues[i] = std::min(std::max(axisValues[i], kAnalogValueMin), kAnalogValueMax);
+            }
+        }
+
+
 
         // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
         // See "Mapper.h" for documentation.
 
-        Mapper::Mapper(const std::wstring_view name, SElementMap&& elements) : elements(std::move(elements)), capabilities(DeriveCapabilitiesFromElementMap(this->elements)), name(name)
+        Mapper::Mapper(const std::wstring_view name, SElementMap&& elements) : ownedElements(new UElementMap(std::move(elements))), elements(ElementMappersFromOwnedElementMap(*ownedElements)), capabilities(DeriveCapabilities(this->elements)), dependencies(BuildDependencies(this->elements)), name(name)
         {
-            if (false == name.empty())
-                MapperRegistry::GetInstance().RegisterMapper(name, this);
+            // Nothing to do here.
         }
 
         // --------
@@ -217,16 +335,109 @@ namespace Xidi
         // -------- CLASS METHODS ------------------------------------------ //
         // See "Mapper.h" for documentation.
 
+        Mapper::TXInputElementSet Mapper::ChangedXInputElements(const XINPUT_GAMEPAD& previousXInputState, const XINPUT_GAMEPAD& xinputState)
+        {
+            TXInputElementSet changedElements = 0;
+
+            if (previousXInputState.sThumbLX != xinputState.sThumbLX) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::StickLeftX);
+            if (previousXInputState.sThumbLY != xinputState.sThumbLY) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::StickLeftY);
+            if (previousXInputState.sThumbRX != xinputState.sThumbRX) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::StickRightX);
+            if (previousXInputState.sThumbRY != xinputState.sThumbRY) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::StickRightY);
+            if (previousXInputState.bLeftTrigger != xinputState.bLeftTrigger) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::TriggerLT);
+            if (previousXInputState.bRightTrigger != xinputState.bRightTrigger) changedElements |= ((TXInputElementSet)1 << (int)EXInputElement::TriggerRT);
+
+            const WORD kChangedButtons = (previousXInputState.wButtons ^ xinputState.wButtons);
+            if (0 != kChangedButtons)
+            {
+                for (unsigned int i = 0; i < _countof(kXInputButtonMask); ++i)
+                {
+                    if (0 != (kChangedButtons & kXInputButtonMask[i]))
+                        changedElements |= ((TXInputElementSet)1 << i);
+                }
+            }
+
+            return changedElements;
+        }
+
+        // --------
+
         void Mapper::DumpRegisteredMappers(void)
         {
-            MapperRegistry::GetInstance().DumpRegisteredMappers();
+            constexpr Message::ESeverity kDumpSeverity = Message::ESeverity::Info;
+
+            if (Message::WillOutputMessageOfSeverity(kDumpSeverity))
+            {
+                Message::Output(kDumpSeverity, L"Begin dump of all known mappers.");
+
+                Message::Output(kDumpSeverity, L"  Default:");
+                Message::OutputFormatted(kDumpSeverity, L"    %s", kDefaultMapper->GetName().data());
+
+                Message::Output(kDumpSeverity, L"  All:");
+
+                for (const auto& registryEntry : kRegistry)
+                {
+                    const SCapabilities kKnownMapperCapabilities = registryEntry.mapper->GetCapabilities();
+                    Message::OutputFormatted(kDumpSeverity, L"    %-24s { numAxes = %u, numButtons = %u, hasPov = %s }", registryEntry.name.data(), (unsigned int)kKnownMapperCapabilities.numAxes, (unsigned int)kKnownMapperCapabilities.numButtons, ((true == kKnownMapperCapabilities.hasPov) ? L"true" : L"false"));
+                }
+
+                SCustomMapperRegistry& customMapperRegistry = GetCustomMapperRegistry();
+                std::scoped_lock lock(customMapperRegistry.mutex);
+
+                if (false == customMapperRegistry.active.empty())
+                {
+                    Message::Output(kDumpSeverity, L"  Custom:");
+
+                    for (const CustomMapper* customMapper : customMapperRegistry.active)
+                    {
+                        const SCapabilities kCustomMapperCapabilities = customMapper->mapper.GetCapabilities();
+                        Message::OutputFormatted(kDumpSeverity, L"    %-24s { numAxes = %u, numButtons = %u, hasPov = %s }", customMapper->name.c_str(), (unsigned int)kCustomMapperCapabilities.numAxes, (unsigned int)kCustomMapperCapabilities.numButtons, ((true == kCustomMapperCapabilities.hasPov) ? L"true" : L"false"));
+                    }
+                }
+
+                Message::Output(kDumpSeverity, L"End dump of all known mappers.");
+            }
+        }
+
+        // --------
+
+        const Mapper* Mapper::GetBuiltinByName(std::wstring_view mapperName)
+        {
+            if (true == mapperName.empty())
+                return kDefaultMapper;
+
+            const auto registryEntry = std::lower_bound(kRegistry.begin(), kRegistry.end(), mapperName, [](const SRegistryEntry& entry, std::wstring_view name) -> bool
+                {
+                    return (entry.name < name);
+                }
+            );
+
+            if ((kRegistry.end() != registryEntry) && (mapperName == registryEntry->name))
+                return registryEntry->mapper;
+
+            return nullptr;
         }
 
         // --------
 
         const Mapper* Mapper::GetByName(std::wstring_view mapperName)
         {
-            return MapperRegistry::GetInstance().GetMapper(mapperName);
+            const Mapper* const kBuiltinMapper = GetBuiltinByName(mapperName);
+            if (nullptr != kBuiltinMapper)
+                return kBuiltinMapper;
+
+            SCustomMapperRegistry& customMapperRegistry = GetCustomMapperRegistry();
+            std::scoped_lock lock(customMapperRegistry.mutex);
+
+            const auto customMapper = std::lower_bound(customMapperRegistry.active.begin(), customMapperRegistry.active.end(), mapperName, [](const CustomMapper* customMapper, std::wstring_view name) -> bool
+                {
+                    return (customMapper->name < name);
+                }
+            );
+
+            if ((customMapperRegistry.active.end() != customMapper) && (mapperName == (*customMapper)->name))
+                return &(*customMapper)->mapper;
+
+            return nullptr;
         }
 
         // --------
@@ -234,85 +445,184 @@ namespace Xidi
         const Mapper* Mapper::GetConfigured(void)
         {
             static const Mapper* configuredMapper = nullptr;
-            static std::once_flag configuredMapperFlag;
+            static std::optional<uint32_t> configuredMapperGeneration;
+            static std::mutex configuredMapperMutex;
+
+            std::scoped_lock lock(configuredMapperMutex);
+
+            // The configured mapper only needs to be located again if a new configuration snapshot has been published since the last time.
+            const uint32_t kConfigurationGeneration = Globals::GetConfigurationGeneration();
+            if ((true == configuredMapperGeneration.has_value()) && (kConfigurationGeneration == configuredMapperGeneration.value()))
+                return configuredMapper;
+
+            const std::shared_ptr<const Configuration::Configuration> config = Globals::GetConfiguration();
+            configuredMapperGeneration = kConfigurationGeneration;
+            configuredMapper = nullptr;
+
+            if (true == config->IsDataValid())
+                LoadCustomMappers(config->GetData());
+
+            if ((true == config->IsDataValid()) && (true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionMapper, Strings::kStrConfigurationSettingMapperType)))
+            {
+                const std::wstring_view kConfiguredMapperName = config->GetData()[Strings::kStrConfigurationSectionMapper][Strings::kStrConfigurationSettingMapperType].FirstValue().GetStringValue();
+
+                Message::OutputFormatted(Message::ESeverity::Info, L"Attempting to locate mapper '%s' specified in the configuration file.", kConfiguredMapperName.data());
+                configuredMapper = GetByName(kConfiguredMapperName);
+            }
+
+            if (nullptr == configuredMapper)
+            {
+                Message::Output(Message::ESeverity::Info, L"Could not locate mapper specified in the configuration file, or no mapper was specified. Using default mapper instead.");
+                configuredMapper = GetDefault();
+            }
+
+            if (nullptr == configuredMapper)
+                Message::Output(Message::ESeverity::Error, L"No mappers could be located. Xidi virtual controllers are unable to function.");
+            else
+                Message::OutputFormatted(Message::ESeverity::Info, L"Using mapper '%s' as the configured mapper type.", configuredMapper->GetName().data());
+
+            return configuredMapper;
+        }
+
+        // --------
+
+        void Mapper::LoadCustomMappers(const Configuration::ConfigurationData& configData)
+        {
+            SCustomMapperRegistry& customMapperRegistry = GetCustomMapperRegistry();
+            std::vector<const CustomMapper*> activeCustomMappers;
+
+            std::scoped_lock lock(customMapperRegistry.mutex);
 
-            std::call_once(configuredMapperFlag, []() -> void
+            // Sections are sorted by name and all custom mapper sections share the same prefix, so custom mappers are encountered in order of their names.
+            for (const auto& section : configData.Sections())
+            {
+                const std::optional<std::wstring_view> kMaybeCustomMapperName = MapperParser::CustomMapperNameFromSection(section.GetName());
+                if (false == kMaybeCustomMapperName.has_value())
+                    continue;
+
+                const std::wstring_view kCustomMapperName = kMaybeCustomMapperName.value();
+                if (nullptr != GetBuiltinByName(kCustomMapperName))
                 {
-                    const Configuration::Configuration& config = Globals::GetConfiguration();
+                    Message::OutputFormatted(Message::ESeverity::Warning, L"Ignoring custom mapper '%.*s' because its name is already used by a built-in mapper.", (int)kCustomMapperName.length(), kCustomMapperName.data());
+                    continue;
+                }
 
-                    if ((true == config.IsDataValid()) && (true == config.GetData().SectionNamePairExists(Strings::kStrConfigurationSectionMapper, Strings::kStrConfigurationSettingMapperType)))
-                    {
-                        const std::wstring_view kConfiguredMapperName = config.GetData()[Strings::kStrConfigurationSectionMapper][Strings::kStrConfigurationSettingMapperType].FirstValue().GetStringValue();
+                MapperParser::TMapperSpec customMapperSpec = {};
+                for (const auto& setting : section.Names())
+                {
+                    const std::optional<EXInputElement> kMaybeXInputElement = MapperParser::FindXInputElementByName(setting.GetName());
+                    const std::optional<MapperParser::SElementMapperSpec> kMaybeElementMapperSpec = MapperParser::ParseElementMapperString(setting.FirstValue().GetStringValue());
 
-                        Message::OutputFormatted(Message::ESeverity::Info, L"Attempting to locate mapper '%s' specified in the configuration file.", kConfiguredMapperName.data());
-                        configuredMapper = GetByName(kConfiguredMapperName);
-                    }
-                
-                    if (nullptr == configuredMapper)
+                    if ((true == kMaybeXInputElement.has_value()) && (true == kMaybeElementMapperSpec.has_value()))
+                        customMapperSpec[(int)kMaybeXInputElement.value()] = kMaybeElementMapperSpec.value();
+                }
+
+                const auto existingCustomMapper = std::find_if(customMapperRegistry.compiled.begin(), customMapperRegistry.compiled.end(), [kCustomMapperName, &customMapperSpec](const std::unique_ptr<const CustomMapper>& customMapper) -> bool
                     {
-                        Message::Output(Message::ESeverity::Info, L"Could not locate mapper specified in the configuration file, or no mapper was specified. Using default mapper instead.");
-                        configuredMapper = GetDefault();
+                        return ((kCustomMapperName == customMapper->name) && (customMapperSpec == customMapper->spec));
                     }
+                );
 
-                    if (nullptr == configuredMapper)
-                        Message::Output(Message::ESeverity::Error, L"No mappers could be located. Xidi virtual controllers are unable to function.");
-                    else
-                        Message::OutputFormatted(Message::ESeverity::Info, L"Using mapper '%s' as the configured mapper type.", configuredMapper->GetName().data());
+                if (customMapperRegistry.compiled.end() != existingCustomMapper)
+                {
+                    activeCustomMappers.push_back(existingCustomMapper->get());
                 }
-            );
+                else
+                {
+                    customMapperRegistry.compiled.push_back(std::make_unique<const CustomMapper>(kCustomMapperName, customMapperSpec));
+                    activeCustomMappers.push_back(customMapperRegistry.compiled.back().get());
+                    Message::OutputFormatted(Message::ESeverity::Info, L"Compiled custom mapper '%s' from its definition in the configuration file.", customMapperRegistry.compiled.back()->name.c_str());
+                }
+            }
 
-            return configuredMapper;
+            customMapperRegistry.active = std::move(activeCustomMappers);
         }
 
 
         // -------- INSTANCE METHODS --------------------------------------- //
         // See "Mapper.h" for documentation.
 
-        void Mapper::MapXInputState(SState& controllerState, XINPUT_GAMEPAD xinputState) const
+        void Mapper::MapChangedXInputElements(SState& controllerState, XINPUT_GAMEPAD xinputState, TXInputElementSet changedElements) const
         {
-            ZeroMemory(&controllerState, sizeof(controllerState));
+            TXInputElementSet elementsToMap = 0;
+            for (unsigned int i = 0; i < _countof(dependencies.remapGroup); ++i)
+            {
+                if (0 != (changedElements & ((TXInputElementSet)1 << i)))
+                    elementsToMap |= dependencies.remapGroup[i];
+            }
 
-            // Left and right stick values need to be saturated at the virtual controller range due to a very slight difference between XInput range and virtual controller range.
-            // This difference (-32768 extreme negative for XInput vs -32767 extreme negative for Xidi) does not affect functionality when filtered by saturation.
-            // Vertical analog axes additionally need to be inverted because XInput presents up as positive and down as negative whereas Xidi needs to do the opposite.
-            
-            if (nullptr != elements.named.stickLeftX) elements.named.stickLeftX->ContributeFromAnalogValue(controllerState, FilterAnalogStickValue(xinputState.sThumbLX));
-            if (nullptr != elements.named.stickLeftY) elements.named.stickLeftY->ContributeFromAnalogValue(controllerState, FilterAndInvertAnalogStickValue(xinputState.sThumbLY));
+            if (0 == elementsToMap)
+                return;
 
-            if (nullptr != elements.named.stickRightX) elements.named.stickRightX->ContributeFromAnalogValue(controllerState, FilterAnalogStickValue(xinputState.sThumbRX));
-            if (nullptr != elements.named.stickRightY) elements.named.stickRightY->ContributeFromAnalogValue(controllerState, FilterAndInvertAnalogStickValue(xinputState.sThumbRY));
+            if (kXInputElementSetAll == (elementsToMap & kXInputElementSetAll))
+            {
+                MapXInputState(controllerState, xinputState);
+                return;
+            }
 
-            if (nullptr != elements.named.dpadUp) elements.named.dpadUp->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_DPAD_UP)));
-            if (nullptr != elements.named.dpadDown) elements.named.dpadDown->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_DPAD_DOWN)));
-            if (nullptr != elements.named.dpadLeft) elements.named.dpadLeft->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_DPAD_LEFT)));
-            if (nullptr != elements.named.dpadRight) elements.named.dpadRight->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT)));
+            // Every element mapper being run again has all other contributors to its target also being run again, so each target can be cleared and then rebuilt from scratch.
+            for (int i = 0; i < (int)elements.size(); ++i)
+            {
+                if (0 == (elementsToMap & ((TXInputElementSet)1 << i)))
+                    continue;
 
-            if (nullptr != elements.named.triggerLT) elements.named.triggerLT->ContributeFromTriggerValue(controllerState, xinputState.bLeftTrigger);
-            if (nullptr != elements.named.triggerRT) elements.named.triggerRT->ContributeFromTriggerValue(controllerState, xinputState.bRightTrigger);
+                const SElementIdentifier kTargetElement = elements[i]->GetTargetElement();
+                switch (kTargetElement.type)
+                {
+                case EElementType::Axis:
+                    controllerState.axis[(int)kTargetElement.axis] = 0;
+                    break;
 
-            if (nullptr != elements.named.buttonA) elements.named.buttonA->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_A)));
-            if (nullptr != elements.named.buttonB) elements.named.buttonB->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_B)));
-            if (nullptr != elements.named.buttonX) elements.named.buttonX->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_X)));
-            if (nullptr != elements.named.buttonY) elements.named.buttonY->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_Y)));
+                case EElementType::Button:
+                    controllerState.button[(int)kTargetElement.button] = false;
+                    break;
 
-            if (nullptr != elements.named.buttonLB) elements.named.buttonLB->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_LEFT_SHOULDER)));
-            if (nullptr != elements.named.buttonRB) elements.named.buttonRB->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_RIGHT_SHOULDER)));
+                case EElementType::Pov:
+                    controllerState.povDirection.all = 0;
+                    break;
 
-            if (nullptr != elements.named.buttonBack) elements.named.buttonBack->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_BACK)));
-            if (nullptr != elements.named.buttonStart) elements.named.buttonStart->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_START)));
+                default:
+                    break;
+                }
+            }
 
-            if (nullptr != elements.named.buttonLS) elements.named.buttonLS->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_LEFT_THUMB)));
-            if (nullptr != elements.named.buttonRS) elements.named.buttonRS->ContributeFromButtonValue(controllerState, (0 != (xinputState.wButtons & XINPUT_GAMEPAD_RIGHT_THUMB)));
+            for (int i = 0; i < (int)elements.size(); ++i)
+            {
+                if (0 != (elementsToMap & ((TXInputElementSet)1 << i)))
+                    ContributeFromXInputElement(*elements[i], (EXInputElement)i, controllerState, xinputState);
+            }
 
-            // Once all contributions have been committed, saturate all axis values at the extreme ends of the allowed range.
-            // Doing this at the end means that intermediate contributions are computed with much more range than the controller is allowed to report, which can increase accuracy when there are multiple interfering mappers contributing to axes.
-            for (auto& axisValue : controllerState.axis)
+            SaturateAxisValues(controllerState);
+        }
+
+        // --------
+
+        void Mapper::MapXInputState(SState& controllerState, XINPUT_GAMEPAD xinputState) const
+        {
+            controllerState = {};
+
+            for (int i = 0; i < (int)elements.size(); ++i)
             {
-                if (axisValue > kAnalogValueMax)
-                    axisValue = kAnalogValueMax;
-                else if (axisValue < kAnalogValueMin)
-                    axisValue = kAnalogValueMin;
+                if (nullptr != elements[i])
+                    ContributeFromXInputElement(*elements[i], (EXInputElement)i, controllerState, xinputState);
             }
+
+            SaturateAxisValues(controllerState);
+        }
+
+        // --------
+
+        void Mapper::MapXInputStateBatch(SStateBatch& controllerStates, const SXInputBatch& xinputStates, unsigned int slotCount) const
+        {
+            memset(&controllerStates, 0, sizeof(controllerStates));
+
+            for (int i = 0; i < (int)elements.size(); ++i)
+            {
+                if (nullptr != elements[i])
+                    ContributeFromXInputElementBatch(*elements[i], (EXInputElement)i, controllerStates, xinputStates, slotCount);
+            }
+
+            SaturateAxisValueBatch(controllerStates, slotCount);
         }
     }
 }
@@ -13,132 +13,214 @@
 #include "ElementMapper.h"
 #include "Mapper.h"
 
+#include <algorithm>
+#include <array>
+#include <span>
+
 
 namespace Xidi
 {
     namespace Controller
     {
+        // -------- ELEMENT MAPPER DEFINITIONS ----------------------------- //
+
+        // Element mappers are stateless, so a single constant instance of each distinct element mapper is shared by all of the mapper definitions that use it.
+
+        // Element mappers that contribute to an axis.
+        static constexpr AxisMapper kAxisX(EAxis::X);
+        static constexpr AxisMapper kAxisY(EAxis::Y);
+        static constexpr AxisMapper kAxisZ(EAxis::Z);
+        static constexpr AxisMapper kAxisRotX(EAxis::RotX);
+        static constexpr AxisMapper kAxisRotY(EAxis::RotY);
+        static constexpr AxisMapper kAxisRotZ(EAxis::RotZ);
+        static constexpr AxisMapper kAxisZPositive(EAxis::Z, AxisMapper::EDirection::Positive);
+        static constexpr AxisMapper kAxisZNegative(EAxis::Z, AxisMapper::EDirection::Negative);
+
+        // Element mappers that contribute to an axis but remove analog functionality.
+        static constexpr DigitalAxisMapper kDigitalAxisX(EAxis::X);
+        static constexpr DigitalAxisMapper kDigitalAxisY(EAxis::Y);
+        static constexpr DigitalAxisMapper kDigitalAxisZ(EAxis::Z);
+        static constexpr DigitalAxisMapper kDigitalAxisRotZ(EAxis::RotZ);
+        static constexpr DigitalAxisMapper kDigitalAxisXNegative(EAxis::X, AxisMapper::EDirection::Negative);
+        static constexpr DigitalAxisMapper kDigitalAxisXPositive(EAxis::X, AxisMapper::EDirection::Positive);
+        static constexpr DigitalAxisMapper kDigitalAxisYNegative(EAxis::Y, AxisMapper::EDirection::Negative);
+        static constexpr DigitalAxisMapper kDigitalAxisYPositive(EAxis::Y, AxisMapper::EDirection::Positive);
+
+        // Element mappers that contribute to a button.
+        static constexpr ButtonMapper kButtonB1(EButton::B1);
+        static constexpr ButtonMapper kButtonB2(EButton::B2);
+        static constexpr ButtonMapper kButtonB3(EButton::B3);
+        static constexpr ButtonMapper kButtonB4(EButton::B4);
+        static constexpr ButtonMapper kButtonB5(EButton::B5);
+        static constexpr ButtonMapper kButtonB6(EButton::B6);
+        static constexpr ButtonMapper kButtonB7(EButton::B7);
+        static constexpr ButtonMapper kButtonB8(EButton::B8);
+        static constexpr ButtonMapper kButtonB9(EButton::B9);
+        static constexpr ButtonMapper kButtonB10(EButton::B10);
+        static constexpr ButtonMapper kButtonB11(EButton::B11);
+        static constexpr ButtonMapper kButtonB12(EButton::B12);
+
+        // Element mappers that contribute to a POV direction.
+        static constexpr PovMapper kPovUp(EPovDirection::Up);
+        static constexpr PovMapper kPovDown(EPovDirection::Down);
+        static constexpr PovMapper kPovLeft(EPovDirection::Left);
+        static constexpr PovMapper kPovRight(EPovDirection::Right);
+
+
         // -------- MAPPER DEFINITIONS ------------------------------------- //
 
-        /// Defines all known mapper types, one element per type. The first element is the default mapper.
-        /// Any field that corresponds to an XInput controller element can be omitted or assigned `nullptr` and the mapper will simply ignore input from that XInput controller element.
-        static const Mapper kMappers[] = {
-
-            Mapper(L"StandardGamepad", {
-                .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-                .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-                .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
-                .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
-                .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-                .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-                .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-                .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-                .triggerLT = std::make_unique<ButtonMapper>(EButton::B7),
-                .triggerRT = std::make_unique<ButtonMapper>(EButton::B8),
-                .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-                .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-                .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-                .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-                .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-                .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-                .buttonBack = std::make_unique<ButtonMapper>(EButton::B9),
-                .buttonStart = std::make_unique<ButtonMapper>(EButton::B10),
-                .buttonLS = std::make_unique<ButtonMapper>(EButton::B11),
-                .buttonRS = std::make_unique<ButtonMapper>(EButton::B12)
-            }),
-
-            Mapper(L"DigitalGamepad", {
-                .stickLeftX = std::make_unique<DigitalAxisMapper>(EAxis::X),
-                .stickLeftY = std::make_unique<DigitalAxisMapper>(EAxis::Y),
-                .stickRightX = std::make_unique<DigitalAxisMapper>(EAxis::Z),
-                .stickRightY = std::make_unique<DigitalAxisMapper>(EAxis::RotZ),
-                .dpadUp = std::make_unique<DigitalAxisMapper>(EAxis::Y, AxisMapper::EDirection::Negative),
-                .dpadDown = std::make_unique<DigitalAxisMapper>(EAxis::Y, AxisMapper::EDirection::Positive),
-                .dpadLeft = std::make_unique<DigitalAxisMapper>(EAxis::X, AxisMapper::EDirection::Negative),
-                .dpadRight = std::make_unique<DigitalAxisMapper>(EAxis::X, AxisMapper::EDirection::Positive),
-                .triggerLT = std::make_unique<ButtonMapper>(EButton::B7),
-                .triggerRT = std::make_unique<ButtonMapper>(EButton::B8),
-                .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-                .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-                .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-                .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-                .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-                .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-                .buttonBack = std::make_unique<ButtonMapper>(EButton::B9),
-                .buttonStart = std::make_unique<ButtonMapper>(EButton::B10),
-                .buttonLS = std::make_unique<ButtonMapper>(EButton::B11),
-                .buttonRS = std::make_unique<ButtonMapper>(EButton::B12)
-            }),
-
-            Mapper(L"ExtendedGamepad", {
-                .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-                .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-                .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
-                .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
-                .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-                .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-                .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-                .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-                .triggerLT = std::make_unique<AxisMapper>(EAxis::RotX),
-                .triggerRT = std::make_unique<AxisMapper>(EAxis::RotY),
-                .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-                .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-                .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-                .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-                .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-                .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-                .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-                .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-                .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-                .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)
-            }),
-
-            Mapper(L"XInputNative", {
-                .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-                .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-                .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
-                .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
-                .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-                .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-                .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-                .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-                .triggerLT = std::make_unique<AxisMapper>(EAxis::Z),
-                .triggerRT = std::make_unique<AxisMapper>(EAxis::RotZ),
-                .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-                .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-                .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-                .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-                .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-                .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-                .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-                .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-                .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-                .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)
-            }),
-
-            Mapper(L"XInputSharedTriggers", {
-                .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-                .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-                .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
-                .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
-                .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-                .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-                .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-                .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-                .triggerLT = std::make_unique<AxisMapper>(EAxis::Z, AxisMapper::EDirection::Positive),
-                .triggerRT = std::make_unique<AxisMapper>(EAxis::Z, AxisMapper::EDirection::Negative),
-                .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-                .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-                .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-                .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-                .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-                .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-                .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-                .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-                .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-                .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)
-            })
+        // Any field that corresponds to an XInput controller element can be omitted or assigned `nullptr` and the mapper will simply ignore input from that XInput controller element.
+
+        static constexpr Mapper kStandardGamepad(L"StandardGamepad", {
+            .stickLeftX = &kAxisX,
+            .stickLeftY = &kAxisY,
+            .stickRightX = &kAxisZ,
+            .stickRightY = &kAxisRotZ,
+            .dpadUp = &kPovUp,
+            .dpadDown = &kPovDown,
+            .dpadLeft = &kPovLeft,
+            .dpadRight = &kPovRight,
+            .triggerLT = &kButtonB7,
+            .triggerRT = &kButtonB8,
+            .buttonA = &kButtonB1,
+            .buttonB = &kButtonB2,
+            .buttonX = &kButtonB3,
+            .buttonY = &kButtonB4,
+            .buttonLB = &kButtonB5,
+            .buttonRB = &kButtonB6,
+            .buttonBack = &kButtonB9,
+            .buttonStart = &kButtonB10,
+            .buttonLS = &kButtonB11,
+            .buttonRS = &kButtonB12
+        });
+
+        static constexpr Mapper kDigitalGamepad(L"DigitalGamepad", {
+            .stickLeftX = &kDigitalAxisX,
+            .stickLeftY = &kDigitalAxisY,
+            .stickRightX = &kDigitalAxisZ,
+            .stickRightY = &kDigitalAxisRotZ,
+            .dpadUp = &kDigitalAxisYNegative,
+            .dpadDown = &kDigitalAxisYPositive,
+            .dpadLeft = &kDigitalAxisXNegative,
+            .dpadRight = &kDigitalAxisXPositive,
+            .triggerLT = &kButtonB7,
+            .triggerRT = &kButtonB8,
+            .buttonA = &kButtonB1,
+            .buttonB = &kButtonB2,
+            .buttonX = &kButtonB3,
+            .buttonY = &kButtonB4,
+            .buttonLB = &kButtonB5,
+            .buttonRB = &kButtonB6,
+            .buttonBack = &kButtonB9,
+            .buttonStart = &kButtonB10,
+            .buttonLS = &kButtonB11,
+            .buttonRS = &kButtonB12
+        });
+
+        static constexpr Mapper kExtendedGamepad(L"ExtendedGamepad", {
+            .stickLeftX = &kAxisX,
+            .stickLeftY = &kAxisY,
+            .stickRightX = &kAxisZ,
+            .stickRightY = &kAxisRotZ,
+            .dpadUp = &kPovUp,
+            .dpadDown = &kPovDown,
+            .dpadLeft = &kPovLeft,
+            .dpadRight = &kPovRight,
+            .triggerLT = &kAxisRotX,
+            .triggerRT = &kAxisRotY,
+            .buttonA = &kButtonB1,
+            .buttonB = &kButtonB2,
+            .buttonX = &kButtonB3,
+            .buttonY = &kButtonB4,
+            .buttonLB = &kButtonB5,
+            .buttonRB = &kButtonB6,
+            .buttonBack = &kButtonB7,
+            .buttonStart = &kButtonB8,
+            .buttonLS = &kButtonB9,
+            .buttonRS = &kButtonB10
+        });
 
+        static constexpr Mapper kXInputNative(L"XInputNative", {
+            .stickLeftX = &kAxisX,
+            .stickLeftY = &kAxisY,
+            .stickRightX = &kAxisRotX,
+            .stickRightY = &kAxisRotY,
+            .dpadUp = &kPovUp,
+            .dpadDown = &kPovDown,
+            .dpadLeft = &kPovLeft,
+            .dpadRight = &kPovRight,
+            .triggerLT = &kAxisZ,
+            .triggerRT = &kAxisRotZ,
+            .buttonA = &kButtonB1,
+            .buttonB = &kButtonB2,
+            .buttonX = &kButtonB3,
+            .buttonY = &kButtonB4,
+            .buttonLB = &kButtonB5,
+            .buttonRB = &kButtonB6,
+            .buttonBack = &kButtonB7,
+            .buttonStart = &kButtonB8,
+            .buttonLS = &kButtonB9,
+            .buttonRS = &kButtonB10
+        });
+
+        static constexpr Mapper kXInputSharedTriggers(L"XInputSharedTriggers", {
+            .stickLeftX = &kAxisX,
+            .stickLeftY = &kAxisY,
+            .stickRightX = &kAxisRotX,
+            .stickRightY = &kAxisRotY,
+            .dpadUp = &kPovUp,
+            .dpadDown = &kPovDown,
+            .dpadLeft = &kPovLeft,
+            .dpadRight = &kPovRight,
+            .triggerLT = &kAxisZPositive,
+            .triggerRT = &kAxisZNegative,
+            .buttonA = &kButtonB1,
+            .buttonB = &kButtonB2,
+            .buttonX = &kButtonB3,
+            .buttonY = &kButtonB4,
+            .buttonLB = &kButtonB5,
+            .buttonRB = &kButtonB6,
+            .buttonBack = &kButtonB7,
+            .buttonStart = &kButtonB8,
+            .buttonLS = &kButtonB9,
+            .buttonRS = &kButtonB10
+        });
+
+        /// Defines all known mapper types, one element per type. The first element is the default mapper.
+        static constexpr const Mapper* kMappers[] = {
+            &kStandardGamepad,
+            &kDigitalGamepad,
+            &kExtendedGamepad,
+            &kXInputNative,
+            &kXInputSharedTriggers
         };
+
+
+        // -------- MAPPER REGISTRY ---------------------------------------- //
+
+        /// Registry of all known mappers, sorted by name at compile time so that lookups can use binary search.
+        static constexpr auto kMapperRegistry = []() -> std::array<Mapper::SRegistryEntry, _countof(kMappers)>
+        {
+            std::array<Mapper::SRegistryEntry, _countof(kMappers)> registry = {};
+
+            for (unsigned int i = 0; i < _countof(kMappers); ++i)
+                registry[i] = {.name = kMappers[i]->GetName(), .mapper = kMappers[i]};
+
+            std::sort(registry.begin(), registry.end(), [](const Mapper::SRegistryEntry& a, const Mapper::SRegistryEntry& b) -> bool
+                {
+                    return (a.name < b.name);
+                }
+            );
+
+            return registry;
+        }();
+
+        static_assert(kMapperRegistry.cend() == std::adjacent_find(kMapperRegistry.cbegin(), kMapperRegistry.cend(), [](const Mapper::SRegistryEntry& a, const Mapper::SRegistryEntry& b) -> bool { return (a.name == b.name); }), "Mapper names must be unique.");
+
+        // See "Mapper.h" for documentation.
+        constinit const std::span<const Mapper::SRegistryEntry> Mapper::kRegistry = kMapperRegistry;
+
+        // See "Mapper.h" for documentation.
+        constinit const Mapper* const Mapper::kDefaultMapper = kMappers[0];
     }
 }
@@ -0,0 +1,267 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MapperParser.cpp
+ *   Implementation of functionality for parsing custom mapper definitions
+ *   that appear in the configuration file.
+ *****************************************************************************/
+
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MapperParser.h"
+#include "Strings.h"
+
+#include <cwctype>
+#include <optional>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        namespace MapperParser
+        {
+            // -------- INTERNAL CONSTANTS --------------------------------- //
+
+            /// Names of XInput controller elements as they appear in custom mapper definitions, indexed by #Mapper::EXInputElement.
+            static constexpr std::wstring_view kXInputElementNames[] = {
+                L"StickLeftX",
+                L"StickLeftY",
+                L"StickRightX",
+                L"StickRightY",
+                L"DpadUp",
+                L"DpadDown",
+                L"DpadLeft",
+                L"DpadRight",
+                L"TriggerLT",
+                L"TriggerRT",
+                L"ButtonA",
+                L"ButtonB",
+                L"ButtonX",
+                L"ButtonY",
+                L"ButtonLB",
+                L"ButtonRB",
+                L"ButtonBack",
+                L"ButtonStart",
+                L"ButtonLS",
+                L"ButtonRS"
+            };
+            static_assert(_countof(kXInputElementNames) == (int)Mapper::EXInputElement::Count, "XInput element name table mismatch.");
+
+            /// Names of axes as they appear in custom mapper definitions, indexed by #EAxis.
+            static constexpr std::wstring_view kAxisNames[] = {
+                L"X",
+                L"Y",
+                L"Z",
+                L"RotX",
+                L"RotY",
+                L"RotZ"
+            };
+            static_assert(_countof(kAxisNames) == (int)EAxis::Count, "Axis name table mismatch.");
+
+            /// Names of POV directions as they appear in custom mapper definitions, indexed by #EPovDirection.
+            static constexpr std::wstring_view kPovDirectionNames[] = {
+                L"Up",
+                L"Down",
+                L"Left",
+                L"Right"
+            };
+            static_assert(_countof(kPovDirectionNames) == (int)EPovDirection::Count, "POV direction name table mismatch.");
+
+            /// Maximum number of parameters that any element mapper accepts.
+            static constexpr int kMaxElementMapperParams = 2;
+
+
+            // -------- INTERNAL FUNCTIONS --------------------------------- //
+
+            /// Removes leading and trailing whitespace from a string.
+            /// @param [in] str String to trim.
+            /// @return Trimmed string, which refers to the same memory as the input.
+            static std::wstring_view TrimWhitespace(std::wstring_view str)
+            {
+                while ((false == str.empty()) && iswspace(str.front()))
+                    str.remove_prefix(1);
+
+                while ((false == str.empty()) && iswspace(str.back()))
+                    str.remove_suffix(1);
+
+                return str;
+            }
+
+            /// Looks up a name in a table of names and returns its position.
+            /// @tparam EnumType Enumeration whose enumerators correspond to the positions in the table.
+            /// @tparam kNameCount Number of names in the table.
+            /// @param [in] names Table of names to search.
+            /// @param [in] name Name to find.
+            /// @return Enumerator at the position of the name in the table, if it was found.
+            template <typename EnumType, size_t kNameCount> static std::optional<EnumType> FindNameInTable(const std::wstring_view (&names)[kNameCount], std::wstring_view name)
+            {
+                for (size_t i = 0; i < kNameCount; ++i)
+                {
+                    if (names[i] == name)
+                        return (EnumType)i;
+                }
+
+                return std::nullopt;
+            }
+
+            /// Parses an axis direction parameter.
+            /// @param [in] directionString String to parse.
+            /// @return Axis direction, if the string is valid.
+            static std::optional<AxisMapper::EDirection> ParseAxisDirection(std::wstring_view directionString)
+            {
+                if (L"+" == directionString)
+                    return AxisMapper::EDirection::Positive;
+                else if (L"-" == directionString)
+                    return AxisMapper::EDirection::Negative;
+
+                return std::nullopt;
+            }
+
+            /// Parses a button number parameter. Buttons are numbered from 1 in custom mapper definitions.
+            /// @param [in] buttonString String to parse.
+            /// @return Button identifier, if the string is valid.
+            static std::optional<EButton> ParseButtonNumber(std::wstring_view buttonString)
+            {
+                if ((true == buttonString.empty()) || (buttonString.length() > 2))
+                    return std::nullopt;
+
+                unsigned int buttonNumber = 0;
+                for (wchar_t digit : buttonString)
+                {
+                    if ((digit < L'0') || (digit > L'9'))
+                        return std::nullopt;
+
+                    buttonNumber = (buttonNumber * 10) + (unsigned int)(digit - L'0');
+                }
+
+                if ((buttonNumber < 1) || (buttonNumber > (unsigned int)EButton::Count))
+                    return std::nullopt;
+
+                return (EButton)(buttonNumber - 1);
+            }
+
+
+            // -------- FUNCTIONS ------------------------------------------ //
+            // See "MapperParser.h" for documentation.
+
+            std::optional<std::wstring_view> CustomMapperNameFromSection(std::wstring_view section)
+            {
+                if (false == section.starts_with(Strings::kStrConfigurationSectionCustomMapperPrefix))
+                    return std::nullopt;
+
+                const std::wstring_view kCustomMapperName = section.substr(Strings::kStrConfigurationSectionCustomMapperPrefix.length());
+                if (true == kCustomMapperName.empty())
+                    return std::nullopt;
+
+                return kCustomMapperName;
+            }
+
+            // --------
+
+            std::optional<Mapper::EXInputElement> FindXInputElementByName(std::wstring_view name)
+            {
+                return FindNameInTable<Mapper::EXInputElement>(kXInputElementNames, name);
+            }
+
+            // --------
+
+            std::optional<SElementMapperSpec> ParseElementMapperString(std::wstring_view elementMapperString)
+            {
+                elementMapperString = TrimWhitespace(elementMapperString);
+
+                // Element mapper strings have the form "Type(param1, param2)" and every type requires at least one parameter.
+                const size_t kParamListStart = elementMapperString.find(L'(');
+                if ((std::wstring_view::npos == kParamListStart) || (false == elementMapperString.ends_with(L')')))
+                    return std::nullopt;
+
+                const std::wstring_view kTypeString = TrimWhitespace(elementMapperString.substr(0, kParamListStart));
+                std::wstring_view paramListString = elementMapperString.substr(kParamListStart + 1, elementMapperString.length() - kParamListStart - 2);
+
+                std::wstring_view params[kMaxElementMapperParams];
+                int numParams = 0;
+
+                while (true)
+                {
+                    if (numParams == kMaxElementMapperParams)
+                        return std::nullopt;
+
+                    const size_t kParamEnd = paramListString.find(L',');
+                    params[numParams] = TrimWhitespace(paramListString.substr(0, kParamEnd));
+                    if (true == params[numParams].empty())
+                        return std::nullopt;
+
+                    numParams += 1;
+
+                    if (std::wstring_view::npos == kParamEnd)
+                        break;
+
+                    paramListString.remove_prefix(kParamEnd + 1);
+                }
+
+                SElementMapperSpec elementMapperSpec;
+
+                if ((L"Axis" == kTypeString) || (L"DigitalAxis" == kTypeString))
+                {
+                    const std::optional<EAxis> kAxis = FindNameInTable<EAxis>(kAxisNames, params[0]);
+                    if (false == kAxis.has_value())
+                        return std::nullopt;
+
+                    elementMapperSpec.type = ((L"Axis" == kTypeString) ? EElementMapperType::Axis : EElementMapperType::DigitalAxis);
+                    elementMapperSpec.axis = kAxis.value();
+
+                    if (numParams > 1)
+                    {
+                        const std::optional<AxisMapper::EDirection> kAxisDirection = ParseAxisDirection(params[1]);
+                        if (false == kAxisDirection.has_value())
+                            return std::nullopt;
+
+                        elementMapperSpec.axisDirection = kAxisDirection.value();
+                    }
+                }
+                else if (L"Button" == kTypeString)
+                {
+                    if (numParams > 1)
+                        return std::nullopt;
+
+                    const std::optional<EButton> kButton = ParseButtonNumber(params[0]);
+                    if (false == kButton.has_value())
+                        return std::nullopt;
+
+                    elementMapperSpec.type = EElementMapperType::Button;
+                    elementMapperSpec.button = kButton.value();
+                }
+                else if (L"Pov" == kTypeString)
+                {
+                    const std::optional<EPovDirection> kPovDirection = FindNameInTable<EPovDirection>(kPovDirectionNames, params[0]);
+                    if (false == kPovDirection.has_value())
+                        return std::nullopt;
+
+                    elementMapperSpec.type = EElementMapperType::Pov;
+                    elementMapperSpec.povDirection = kPovDirection.value();
+
+                    if (numParams > 1)
+                    {
+                        const std::optional<EPovDirection> kPovDirectionNegative = FindNameInTable<EPovDirection>(kPovDirectionNames, params[1]);
+                        if (false == kPovDirectionNegative.has_value())
+                            return std::nullopt;
+
+                        elementMapperSpec.maybePovDirectionNegative = kPovDirectionNegative.value();
+                    }
+                }
+                else
+                {
+                    return std::nullopt;
+                }
+
+                return elementMapperSpec;
+            }
+        }
+    }
+}
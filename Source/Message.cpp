@@ -12,11 +12,15 @@
 #include "ApiWindows.h"
 #include "Globals.h"
 #include "Message.h"
+#include "MessageRateLimiter.h"
+#include "Platform.h"
 #include "Strings.h"
 #include "TemporaryBuffer.h"
 
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
+#include <optional>
 #include <psapi.h>
 #include <sal.h>
 #include <shlobj.h>
@@ -280,6 +284,31 @@ namespace Xidi
             OutputInternal(severity, messageBuf);
         }
 
+        /// Outputs a message that already passed the token bucket of its rate limiter, unless it repeats the last message output too soon.
+        /// If any messages were suppressed since the last one was output, then their number is appended.
+        /// @param [in] rateLimiter Rate limiter belonging to the call site.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] message Message text.
+        /// @param [in] timestamp Time at which the token was taken, in nanoseconds.
+        static void OutputRateLimitedInternal(RateLimiter& rateLimiter, const ESeverity severity, const wchar_t* message, uint64_t timestamp)
+        {
+            const std::optional<unsigned int> kNumSuppressed = rateLimiter.Admit(message, timestamp);
+            if (false == kNumSuppressed.has_value())
+                return;
+
+            if (0 == kNumSuppressed.value())
+            {
+                OutputInternal(severity, message);
+            }
+            else
+            {
+                TemporaryBuffer<wchar_t> annotatedMessageBuf;
+
+                swprintf_s(annotatedMessageBuf, annotatedMessageBuf.Count(), L"%s (%u similar message(s) suppressed since the last one was output)", message, kNumSuppressed.value());
+                OutputInternal(severity, annotatedMessageBuf);
+            }
+        }
+
 
         // -------- FUNCTIONS ---------------------------------------------- //
         // See "Message.h" for documentation.
@@ -348,6 +377,50 @@ namespace Xidi
 
         // --------
 
+        void OutputFormattedRateLimited(RateLimiter& rateLimiter, const ESeverity severity, _Printf_format_string_ const wchar_t* format, ...)
+        {
+            const DWORD lastError = GetLastError();
+
+            // The token bucket is checked before anything is formatted so that suppressed messages cost as little as possible.
+            const uint64_t kTimestamp = Platform::GetNanosecondTimestamp();
+            if ((false == WillOutputMessageOfSeverity(severity)) || (false == rateLimiter.TryAcquire(kTimestamp)))
+            {
+                SetLastError(lastError);
+                return;
+            }
+
+            TemporaryBuffer<wchar_t> messageBuf;
+
+            va_list args;
+            va_start(args, format);
+
+            vswprintf_s(messageBuf, messageBuf.Count(), format, args);
+
+            va_end(args);
+
+            OutputRateLimitedInternal(rateLimiter, severity, messageBuf, kTimestamp);
+            SetLastError(lastError);
+        }
+
+        // --------
+
+        void OutputRateLimited(RateLimiter& rateLimiter, const ESeverity severity, const wchar_t* message)
+        {
+            const DWORD lastError = GetLastError();
+
+            const uint64_t kTimestamp = Platform::GetNanosecondTimestamp();
+            if ((false == WillOutputMessageOfSeverity(severity)) || (false == rateLimiter.TryAcquire(kTimestamp)))
+            {
+                SetLastError(lastError);
+                return;
+            }
+
+            OutputRateLimitedInternal(rateLimiter, severity, message, kTimestamp);
+            SetLastError(lastError);
+        }
+
+        // --------
+
         void SetMinimumSeverityForOutput(const ESeverity severity)
         {
             if (severity > ESeverity::LowerBoundConfigurableValue)
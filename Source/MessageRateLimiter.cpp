@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MessageRateLimiter.cpp
+ *   Implementation of the rate limiter that keeps messages repeated at frame
+ *   rate from flooding the log.
+ *****************************************************************************/
+
+#include "MessageRateLimiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Message
+    {
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "MessageRateLimiter.h" for documentation.
+
+        RateLimiter::RateLimiter(unsigned int burstSize, uint64_t refillInterval, uint64_t repeatInterval) : kRefillInterval(refillInterval), kBurstInterval((uint64_t)std::max(burstSize, 1u) * refillInterval), kRepeatInterval(repeatInterval), bucketFullTime(0), suppressedCount(0), lastMessageHash(), lastMessageTime(0), lastMessageMutex()
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "MessageRateLimiter.h" for documentation.
+
+        std::optional<unsigned int> RateLimiter::Admit(std::wstring_view message, uint64_t timestamp)
+        {
+            const size_t kMessageHash = std::hash<std::wstring_view>()(message);
+
+            std::scoped_lock lock(lastMessageMutex);
+
+            if ((kMessageHash == lastMessageHash) && ((timestamp - lastMessageTime) < kRepeatInterval))
+            {
+                suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            lastMessageHash = kMessageHash;
+            lastMessageTime = timestamp;
+            return suppressedCount.exchange(0, std::memory_order_relaxed);
+        }
+
+        // --------
+
+        bool RateLimiter::TryAcquire(uint64_t timestamp)
+        {
+            uint64_t currentBucketFullTime = bucketFullTime.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                // Taking a token pushes the time at which the bucket is full again one refill interval further out.
+                // If that is further out than an empty bucket would need, then the bucket is already empty.
+                const uint64_t kNewBucketFullTime = std::max(currentBucketFullTime, timestamp) + kRefillInterval;
+                if ((kNewBucketFullTime - timestamp) > kBurstInterval)
+                {
+                    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                if (true == bucketFullTime.compare_exchange_weak(currentBucketFullTime, kNewBucketFullTime, std::memory_order_relaxed))
+                    return true;
+            }
+        }
+    }
+}
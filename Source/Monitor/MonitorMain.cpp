@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MonitorMain.cpp
+ *   Entry point for a standalone tool that periodically samples the live
+ *   statistics exported by a process into which Xidi is loaded.
+ *****************************************************************************/
+
+#include "ApiWindows.h"
+#include "SharedMemory.h"
+#include "Statistics.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+
+
+namespace XidiMonitor
+{
+    using namespace ::Xidi;
+    using namespace ::Xidi::Statistics;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Default sampling interval, in milliseconds.
+    static constexpr DWORD kDefaultIntervalMilliseconds = 1000;
+
+    /// Minimum allowed sampling interval, in milliseconds.
+    static constexpr DWORD kMinIntervalMilliseconds = 10;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Converts a count observed over a sampling interval to a rate per second.
+    /// @param [in] count Count observed over the sampling interval.
+    /// @param [in] intervalMilliseconds Duration of the sampling interval, in milliseconds.
+    /// @return Rate per second.
+    static double RatePerSecond(uint64_t count, uint64_t intervalMilliseconds)
+    {
+        if (0 == intervalMilliseconds)
+            return 0.0;
+
+        return ((double)count * 1000.0) / (double)intervalMilliseconds;
+    }
+
+    /// Prints the differences between two samples of the statistics segment.
+    /// Controllers with no activity during the sampling interval are omitted.
+    /// @param [in] previous Earlier sample.
+    /// @param [in] current Later sample.
+    /// @param [in] intervalMilliseconds Time elapsed between the two samples, in milliseconds.
+    static void PrintSampleDifference(const SSnapshot& previous, const SSnapshot& current, uint64_t intervalMilliseconds)
+    {
+        wprintf(L"\nAPI calls per second:");
+        for (int i = 0; i < (int)EApiCall::Count; ++i)
+            wprintf(L"  %s %.1f", ApiCallName((EApiCall)i), RatePerSecond(current.apiCalls[i] - previous.apiCalls[i], intervalMilliseconds));
+        wprintf(L"\n");
+
+        for (uint32_t i = 0; i < kControllerCount; ++i)
+        {
+            const SControllerSnapshot& kPrevious = previous.controller[i];
+            const SControllerSnapshot& kCurrent = current.controller[i];
+
+            const uint64_t kRefreshCount = kCurrent.refreshCount - kPrevious.refreshCount;
+            const uint64_t kXInputReadCount = kCurrent.xinputReadCount - kPrevious.xinputReadCount;
+            const uint64_t kXInputLatencyTotal = kCurrent.xinputLatencyTotalNanoseconds - kPrevious.xinputLatencyTotalNanoseconds;
+            const uint64_t kEventsAppended = kCurrent.eventsAppended - kPrevious.eventsAppended;
+            const uint64_t kEventsDropped = kCurrent.eventsDropped - kPrevious.eventsDropped;
+            const uint64_t kLockContentions = kCurrent.lockContentions - kPrevious.lockContentions;
+            const uint64_t kPrefetchHits = kCurrent.prefetchHits - kPrevious.prefetchHits;
+            const uint64_t kPrefetchMisses = kCurrent.prefetchMisses - kPrevious.prefetchMisses;
+            const uint64_t kStateReadCount = kCurrent.stateReadCount - kPrevious.stateReadCount;
+            const uint64_t kStateAgeTotal = kCurrent.stateAgeTotalNanoseconds - kPrevious.stateAgeTotalNanoseconds;
+
+            if ((0 == kRefreshCount) && (0 == kXInputReadCount) && (0 == kEventsAppended) && (0 == kLockContentions) && (0 == kStateReadCount))
+                continue;
+
+            const double kXInputLatencyAverageMicroseconds = ((0 == kXInputReadCount) ? 0.0 : ((double)kXInputLatencyTotal / (double)kXInputReadCount / 1000.0));
+            const double kXInputLatencyMaxMicroseconds = (double)kCurrent.xinputLatencyMaxNanoseconds / 1000.0;
+            const double kPrefetchHitPercent = ((0 == (kPrefetchHits + kPrefetchMisses)) ? 0.0 : ((double)kPrefetchHits * 100.0 / (double)(kPrefetchHits + kPrefetchMisses)));
+            const double kStateAgeAverageMicroseconds = ((0 == kStateReadCount) ? 0.0 : ((double)kStateAgeTotal / (double)kStateReadCount / 1000.0));
+
+            wprintf(L"Controller %u:  refresh/s %.1f  XInput avg %.1fus max %.1fus  events +%llu dropped %llu  lock waits %llu  prefetch hit %.1f%%  data age avg %.1fus\n", (unsigned int)(i + 1), RatePerSecond(kRefreshCount, intervalMilliseconds), kXInputLatencyAverageMicroseconds, kXInputLatencyMaxMicroseconds, (unsigned long long)kEventsAppended, (unsigned long long)kEventsDropped, (unsigned long long)kLockContentions, kPrefetchHitPercent, kStateAgeAverageMicroseconds);
+        }
+    }
+
+    /// Samples the statistics segment published by the specified process until that process exits.
+    /// Between samples the monitor waits on the process handle, so it consumes no processor time and notices immediately when the process exits.
+    /// @param [in] processId PID of the process to monitor.
+    /// @param [in] intervalMilliseconds Sampling interval, in milliseconds.
+    /// @return Process exit code.
+    static int Monitor(DWORD processId, DWORD intervalMilliseconds)
+    {
+        SharedMemory sharedMemory;
+        const SSegment* const kSegment = ValidateSegment(sharedMemory.Open(SegmentName(processId), sizeof(SSegment)), sizeof(SSegment));
+        if (nullptr == kSegment)
+        {
+            fwprintf(stderr, L"Unable to find Xidi statistics for process %u. Make sure the process is running and statistics are enabled in its Xidi configuration file.\n", (unsigned int)processId);
+            return 1;
+        }
+
+        const HANDLE kProcessHandle = OpenProcess(SYNCHRONIZE, FALSE, processId);
+
+        wprintf(L"Monitoring Xidi statistics for process %u every %u ms. Press Ctrl+C to stop.\n", (unsigned int)processId, (unsigned int)intervalMilliseconds);
+
+        SSnapshot previous = ReadSnapshot(*kSegment);
+        ULONGLONG previousTime = GetTickCount64();
+
+        while (true)
+        {
+            if (nullptr != kProcessHandle)
+            {
+                if (WAIT_OBJECT_0 == WaitForSingleObject(kProcessHandle, intervalMilliseconds))
+                    break;
+            }
+            else
+            {
+                Sleep(intervalMilliseconds);
+            }
+
+            const SSnapshot kCurrent = ReadSnapshot(*kSegment);
+            const ULONGLONG kCurrentTime = GetTickCount64();
+
+            PrintSampleDifference(previous, kCurrent, kCurrentTime - previousTime);
+
+            previous = kCurrent;
+            previousTime = kCurrentTime;
+        }
+
+        wprintf(L"\nProcess %u has exited.\n", (unsigned int)processId);
+        CloseHandle(kProcessHandle);
+        return 0;
+    }
+}
+
+
+// -------- ENTRY POINT ---------------------------------------------------- //
+
+/// Program entry point.
+/// Usage: XidiMonitor <pid> [interval-ms]
+/// @param [in] argc Number of command-line arguments.
+/// @param [in] argv Command-line arguments.
+/// @return Process exit code.
+int wmain(int argc, const wchar_t* argv[])
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        fwprintf(stderr, L"Usage: %s <pid> [interval-ms]\n", argv[0]);
+        return 1;
+    }
+
+    const DWORD kProcessId = (DWORD)wcstoul(argv[1], nullptr, 10);
+    if (0 == kProcessId)
+    {
+        fwprintf(stderr, L"Invalid process ID: %s\n", argv[1]);
+        return 1;
+    }
+
+    DWORD intervalMilliseconds = XidiMonitor::kDefaultIntervalMilliseconds;
+    if (3 == argc)
+    {
+        intervalMilliseconds = (DWORD)wcstoul(argv[2], nullptr, 10);
+        if (intervalMilliseconds < XidiMonitor::kMinIntervalMilliseconds)
+            intervalMilliseconds = XidiMonitor::kMinIntervalMilliseconds;
+    }
+
+    return XidiMonitor::Monitor(kProcessId, intervalMilliseconds);
+}
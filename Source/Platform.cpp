@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Platform.cpp
+ *   Implementation of the thin platform abstraction layer used by the
+ *   portable controller core. Windows builds defer to the Windows API, and
+ *   all other builds use the C++ standard library and POSIX.
+ *****************************************************************************/
+
+#include "Platform.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#include "ApiWindows.h"
+#else
+#include <chrono>
+#include <cwchar>
+#include <string>
+#endif
+
+
+namespace Xidi
+{
+    namespace Platform
+    {
+#ifdef _WIN32
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Retrieves the frequency of the performance counter, which is fixed at system boot and therefore only queried once.
+        /// @return Performance counter frequency, in counts per second.
+        static uint64_t GetPerformanceCounterFrequency(void)
+        {
+            static const uint64_t kFrequency = []() -> uint64_t
+            {
+                LARGE_INTEGER frequency;
+                QueryPerformanceFrequency(&frequency);
+                return (uint64_t)frequency.QuadPart;
+            }();
+
+            return kFrequency;
+        }
+#else
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Converts a wide-character string to a multibyte string using the current locale, which is how file names are represented outside of Windows.
+        /// @param [in] wideString String to convert. Must be null-terminated.
+        /// @return Converted string, or an empty string if the conversion failed.
+        static std::string NarrowString(const wchar_t* wideString)
+        {
+            std::mbstate_t conversionState = std::mbstate_t();
+            const wchar_t* source = wideString;
+
+            const size_t kConvertedLength = std::wcsrtombs(nullptr, &source, 0, &conversionState);
+            if ((size_t)-1 == kConvertedLength)
+                return std::string();
+
+            std::string narrowString(kConvertedLength, '\0');
+            source = wideString;
+            conversionState = std::mbstate_t();
+            std::wcsrtombs(narrowString.data(), &source, kConvertedLength, &conversionState);
+
+            return narrowString;
+        }
+#endif
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Platform.h" for documentation.
+
+        bool AcquireModuleReference(void)
+        {
+#ifdef _WIN32
+            HMODULE module = nullptr;
+            return (FALSE != GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCTSTR>(&AcquireModuleReference), &module));
+#else
+            return false;
+#endif
+        }
+
+        // --------
+
+        uint32_t GetMillisecondTimestamp(void)
+        {
+#ifdef _WIN32
+            return (uint32_t)GetTickCount();
+#else
+            return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // --------
+
+        uint64_t GetNanosecondTimestamp(void)
+        {
+#ifdef _WIN32
+            static constexpr uint64_t kNanosecondsPerSecond = 1000000000ull;
+
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+
+            // Whole seconds and the remainder are converted separately so that the intermediate product cannot overflow.
+            const uint64_t kFrequency = GetPerformanceCounterFrequency();
+            const uint64_t kCounter = (uint64_t)counter.QuadPart;
+            return ((kCounter / kFrequency) * kNanosecondsPerSecond) + (((kCounter % kFrequency) * kNanosecondsPerSecond) / kFrequency);
+#else
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // --------
+
+        bool IsDebuggerAttached(void)
+        {
+#ifdef _WIN32
+            return (FALSE != IsDebuggerPresent());
+#else
+            return false;
+#endif
+        }
+
+        // --------
+
+        FILE* OpenFile(const wchar_t* fileName, const wchar_t* mode)
+        {
+#ifdef _WIN32
+            FILE* fileHandle = nullptr;
+            if (0 != _wfopen_s(&fileHandle, fileName, mode))
+                return nullptr;
+
+            return fileHandle;
+#else
+            const std::string kNarrowFileName = NarrowString(fileName);
+            const std::string kNarrowMode = NarrowString(mode);
+            if ((true == kNarrowFileName.empty()) || (true == kNarrowMode.empty()))
+                return nullptr;
+
+            return fopen(kNarrowFileName.c_str(), kNarrowMode.c_str());
+#endif
+        }
+
+        // --------
+
+        void OutputDebuggerText(const wchar_t* text)
+        {
+#ifdef _WIN32
+            OutputDebugString(text);
+#else
+            fputws(text, stderr);
+#endif
+        }
+
+        // --------
+
+        void ReleaseModuleReference(void)
+        {
+#ifdef _WIN32
+            HMODULE module = nullptr;
+            if (FALSE != GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCTSTR>(&ReleaseModuleReference), &module))
+                FreeLibrary(module);
+#endif
+        }
+
+        // --------
+
+        void ReleaseModuleReferenceAndExitThread(void)
+        {
+#ifdef _WIN32
+            HMODULE module = nullptr;
+            if (FALSE != GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCTSTR>(&ReleaseModuleReferenceAndExitThread), &module))
+                FreeLibraryAndExitThread(module, 0);
+#endif
+        }
+    }
+}
@@ -0,0 +1,306 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file PortableRuntime.cpp
+ *   Implementation of the global data and message output functions that the
+ *   portable controller core needs when it is built without Windows.
+ *   Windows builds use the full implementations in Globals.cpp and
+ *   Message.cpp instead.
+ *****************************************************************************/
+
+#include "Configuration.h"
+#include "Globals.h"
+#include "Message.h"
+#include "MessageRateLimiter.h"
+#include "Platform.h"
+#include "TemporaryBuffer.h"
+#include "XidiConfigReader.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Globals
+    {
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Name of the environment variable that identifies the configuration file to read.
+        /// If it is not set, no configuration file is read and the defaults are used throughout.
+        static constexpr char kConfigurationFileEnvironmentVariable[] = "XIDI_CONFIGURATION_FILE";
+
+
+        // -------- INTERNAL VARIABLES ------------------------------------- //
+
+        /// Serializes replacement of the published configuration snapshot.
+        static std::mutex configurationMutex;
+
+        /// Most recently published configuration snapshot, read the first time it is requested.
+        static std::shared_ptr<const Configuration::Configuration> configuration;
+
+        /// Generation number of the most recently published configuration snapshot.
+        static std::atomic<uint32_t> configurationGeneration = 0;
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Reads the configuration file, if one is identified by the environment, into a new configuration snapshot.
+        /// @return Newly-read configuration snapshot.
+        static std::shared_ptr<Configuration::Configuration> ReadConfigurationSnapshot(void)
+        {
+            std::shared_ptr<Configuration::Configuration> snapshot = std::make_shared<Configuration::Configuration>(std::make_unique<XidiConfigReader>());
+
+            const char* const kConfigurationFileName = std::getenv(kConfigurationFileEnvironmentVariable);
+            if (nullptr != kConfigurationFileName)
+            {
+                const std::string_view kConfigurationFileNameView = kConfigurationFileName;
+                snapshot->ReadConfigurationFile(std::wstring(kConfigurationFileNameView.cbegin(), kConfigurationFileNameView.cend()));
+            }
+
+            return snapshot;
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Globals.h" for documentation.
+
+        std::shared_ptr<const Configuration::Configuration> GetConfiguration(void)
+        {
+            std::scoped_lock lock(configurationMutex);
+
+            if (nullptr == configuration)
+                configuration = ReadConfigurationSnapshot();
+
+            return configuration;
+        }
+
+        // --------
+
+        uint32_t GetConfigurationGeneration(void)
+        {
+            return configurationGeneration.load(std::memory_order_acquire);
+        }
+
+        // --------
+
+        bool ReloadConfiguration(void)
+        {
+            std::shared_ptr<const Configuration::Configuration> snapshot = ReadConfigurationSnapshot();
+            if (Configuration::EFileReadResult::Malformed == snapshot->GetFileReadResult())
+                return false;
+
+            {
+                std::scoped_lock lock(configurationMutex);
+                configuration = std::move(snapshot);
+            }
+
+            configurationGeneration.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    namespace Message
+    {
+        // -------- INTERNAL VARIABLES ------------------------------------- //
+
+        /// Specifies the minimum severity required to output a message.
+        static ESeverity minimumSeverityForOutput = kDefaultMinimumSeverityForOutput;
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Selects a character to represent each level of severity, for use when outputting messages.
+        /// @param [in] severity Message severity.
+        /// @return Character to use to represent it.
+        static wchar_t CharacterForSeverity(const ESeverity severity)
+        {
+            switch (severity)
+            {
+            case ESeverity::ForcedInteractiveError:
+            case ESeverity::Error:
+                return L'E';
+
+            case ESeverity::ForcedInteractiveWarning:
+            case ESeverity::Warning:
+                return L'W';
+
+            case ESeverity::ForcedInteractiveInfo:
+            case ESeverity::Info:
+                return L'I';
+
+            case ESeverity::Debug:
+            case ESeverity::SuperDebug:
+                return L'D';
+
+            default:
+                return L'?';
+            }
+        }
+
+        /// Converts a format string written for the Windows wide-character formatting functions into one that has the same meaning elsewhere.
+        /// Windows treats `%s` and `%c` in a wide format string as wide arguments, whereas the C standard treats them as narrow arguments unless the `l` length modifier is present.
+        /// @param [in] format Format string as written for Windows.
+        /// @return Equivalent portable format string.
+        static std::wstring PortableFormatString(std::wstring_view format)
+        {
+            std::wstring portableFormat;
+            portableFormat.reserve(format.length() + 8);
+
+            size_t i = 0;
+            while (i < format.length())
+            {
+                portableFormat += format[i];
+                if (L'%' != format[i++])
+                    continue;
+
+                bool lengthModifierPresent = false;
+                while ((i < format.length()) && (nullptr != std::wcschr(L"-+ #0123456789.*hlLjzt", format[i])))
+                {
+                    if (nullptr != std::wcschr(L"hlLjzt", format[i]))
+                        lengthModifierPresent = true;
+
+                    portableFormat += format[i++];
+                }
+
+                if ((i < format.length()) && (false == lengthModifierPresent) && ((L's' == format[i]) || (L'c' == format[i])))
+                    portableFormat += L'l';
+
+                if (i < format.length())
+                    portableFormat += format[i++];
+            }
+
+            return portableFormat;
+        }
+
+        /// Outputs a message of the given severity to the standard error stream.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] message Message text.
+        static void OutputInternal(const ESeverity severity, const wchar_t* message)
+        {
+            std::fwprintf(stderr, L"[%lc] %ls\n", CharacterForSeverity(severity), message);
+        }
+
+        /// Formats and outputs some text of the given severity.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] format Message string as written for Windows, possibly with format specifiers.
+        /// @param [in] args Variable-length list of arguments to be used for any format specifiers in the message string.
+        static void OutputFormattedInternal(const ESeverity severity, const wchar_t* format, va_list args)
+        {
+            TemporaryBuffer<wchar_t> messageBuf;
+
+            std::vswprintf(messageBuf, messageBuf.Count(), PortableFormatString(format).c_str(), args);
+            OutputInternal(severity, messageBuf);
+        }
+
+        /// Outputs a message that already passed the token bucket of its rate limiter, unless it repeats the last message output too soon.
+        /// @param [in] rateLimiter Rate limiter belonging to the call site.
+        /// @param [in] severity Severity of the message.
+        /// @param [in] message Message text.
+        /// @param [in] timestamp Time at which the token was taken, in nanoseconds.
+        static void OutputRateLimitedInternal(RateLimiter& rateLimiter, const ESeverity severity, const wchar_t* message, uint64_t timestamp)
+        {
+            const std::optional<unsigned int> kNumSuppressed = rateLimiter.Admit(message, timestamp);
+            if (false == kNumSuppressed.has_value())
+                return;
+
+            if (0 == kNumSuppressed.value())
+            {
+                OutputInternal(severity, message);
+            }
+            else
+            {
+                TemporaryBuffer<wchar_t> annotatedMessageBuf;
+
+                std::swprintf(annotatedMessageBuf, annotatedMessageBuf.Count(), L"%ls (%u similar message(s) suppressed since the last one was output)", message, kNumSuppressed.value());
+                OutputInternal(severity, annotatedMessageBuf);
+            }
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Message.h" for documentation.
+
+        void Output(const ESeverity severity, const wchar_t* message)
+        {
+            if (false == WillOutputMessageOfSeverity(severity))
+                return;
+
+            OutputInternal(severity, message);
+        }
+
+        // ---------
+
+        void OutputFormatted(const ESeverity severity, _Printf_format_string_ const wchar_t* format, ...)
+        {
+            if (false == WillOutputMessageOfSeverity(severity))
+                return;
+
+            va_list args;
+            va_start(args, format);
+
+            OutputFormattedInternal(severity, format, args);
+
+            va_end(args);
+        }
+
+        // --------
+
+        void OutputFormattedRateLimited(RateLimiter& rateLimiter, const ESeverity severity, _Printf_format_string_ const wchar_t* format, ...)
+        {
+            const uint64_t kTimestamp = Platform::GetNanosecondTimestamp();
+            if ((false == WillOutputMessageOfSeverity(severity)) || (false == rateLimiter.TryAcquire(kTimestamp)))
+                return;
+
+            TemporaryBuffer<wchar_t> messageBuf;
+
+            va_list args;
+            va_start(args, format);
+
+            std::vswprintf(messageBuf, messageBuf.Count(), PortableFormatString(format).c_str(), args);
+
+            va_end(args);
+
+            OutputRateLimitedInternal(rateLimiter, severity, messageBuf, kTimestamp);
+        }
+
+        // --------
+
+        void OutputRateLimited(RateLimiter& rateLimiter, const ESeverity severity, const wchar_t* message)
+        {
+            const uint64_t kTimestamp = Platform::GetNanosecondTimestamp();
+            if ((false == WillOutputMessageOfSeverity(severity)) || (false == rateLimiter.TryAcquire(kTimestamp)))
+                return;
+
+            OutputRateLimitedInternal(rateLimiter, severity, message, kTimestamp);
+        }
+
+        // --------
+
+        void SetMinimumSeverityForOutput(const ESeverity severity)
+        {
+            if (severity > ESeverity::LowerBoundConfigurableValue)
+                minimumSeverityForOutput = severity;
+        }
+
+        // --------
+
+        bool WillOutputMessageOfSeverity(const ESeverity severity)
+        {
+            return ((severity < ESeverity::LowerBoundConfigurableValue) || (severity <= minimumSeverityForOutput));
+        }
+    }
+}
@@ -0,0 +1,241 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file PrefetchScheduler.cpp
+ *   Implementation of the scheduler that learns how often applications read
+ *   controller state and reads XInput just ahead of each predicted read.
+ *****************************************************************************/
+
+#include "BackgroundWorker.h"
+#include "Clock.h"
+#include "PrefetchScheduler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Controller
+    {
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "PrefetchScheduler.h" for documentation.
+
+        std::optional<uint64_t> CadenceTracker::PredictNextRead(void) const
+        {
+            if ((false == lastFrameStart.has_value()) || (stableIntervalCount < kStableIntervalsRequired))
+                return std::nullopt;
+
+            return *lastFrameStart + period;
+        }
+
+        // --------
+
+        bool CadenceTracker::RecordRead(uint64_t timestamp)
+        {
+            if (false == lastFrameStart.has_value())
+            {
+                lastFrameStart = timestamp;
+                return true;
+            }
+
+            // Timestamps come from a monotonic clock, but reads on different threads may still be recorded slightly out of order.
+            const uint64_t kInterval = ((timestamp > *lastFrameStart) ? (timestamp - *lastFrameStart) : 0);
+            if (kInterval < kSameFrameInterval)
+                return false;
+
+            if (kInterval > kMaximumPeriod)
+            {
+                period = 0;
+                stableIntervalCount = 0;
+            }
+            else if (0 == period)
+            {
+                period = kInterval;
+                stableIntervalCount = 1;
+            }
+            else
+            {
+                // An interval within one eighth of the estimate refines the estimate, and anything else means the cadence changed and must be learned again.
+                const uint64_t kDeviation = ((kInterval > period) ? (kInterval - period) : (period - kInterval));
+                if (kDeviation <= (period / 8))
+                {
+                    period = ((period * 7) + kInterval) / 8;
+                    stableIntervalCount = std::min(stableIntervalCount + 1, kStableIntervalsRequired);
+                }
+                else
+                {
+                    period = kInterval;
+                    stableIntervalCount = 1;
+                }
+            }
+
+            lastFrameStart = timestamp;
+            return true;
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "PrefetchScheduler.h" for documentation.
+
+        PrefetchScheduler::PrefetchScheduler(const IClock& clock) : clock(clock), leadTime(kDefaultLeadTime), targets(), prefetchingTargets(), schedulerMutex(), prefetchCompleted(), prefetchWorker()
+        {
+            // Nothing to do here.
+        }
+
+        // --------
+
+        PrefetchScheduler::~PrefetchScheduler(void)
+        {
+            Stop();
+        }
+
+
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+        // See "PrefetchScheduler.h" for documentation.
+
+        void PrefetchScheduler::PrefetchThreadMain(void)
+        {
+            while (true)
+            {
+                const uint64_t kNextDue = RunDuePrefetches();
+                const uint64_t kNow = clock.GetTimestamp();
+
+                if (false == prefetchWorker.WaitFor((kNextDue > kNow) ? (kNextDue - kNow) : 0))
+                    return;
+            }
+        }
+
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "PrefetchScheduler.h" for documentation.
+
+        PrefetchScheduler& PrefetchScheduler::GetDefault(void)
+        {
+            static PrefetchScheduler defaultScheduler;
+            return defaultScheduler;
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "PrefetchScheduler.h" for documentation.
+
+        void PrefetchScheduler::AddTarget(IPrefetchTarget* target)
+        {
+            std::scoped_lock lock(schedulerMutex);
+
+            if (targets.end() == std::find(targets.begin(), targets.end(), target))
+                targets.push_back(target);
+
+            prefetchWorker.Notify();
+        }
+
+        // --------
+
+        bool PrefetchScheduler::IsRunning(void)
+        {
+            return prefetchWorker.IsRunning();
+        }
+
+        // --------
+
+        void PrefetchScheduler::RemoveTarget(IPrefetchTarget* target)
+        {
+            std::unique_lock lock(schedulerMutex);
+
+            targets.erase(std::remove(targets.begin(), targets.end(), target), targets.end());
+            prefetchCompleted.wait(lock, [this, target]() -> bool { return (prefetchingTargets.end() == std::find(prefetchingTargets.begin(), prefetchingTargets.end(), target)); });
+        }
+
+        // --------
+
+        uint64_t PrefetchScheduler::RunDuePrefetches(void)
+        {
+            std::vector<IPrefetchTarget*> dueTargets;
+            uint64_t nextDue = 0;
+
+            // Prefetches read XInput, which can take a while, so the targets that are due are identified while holding the lock and prefetched afterwards.
+            // Each target that is due is recorded as being prefetched before the lock is released, which keeps it from being unregistered until its prefetch completes.
+            {
+                std::scoped_lock lock(schedulerMutex);
+
+                const uint64_t kNow = clock.GetTimestamp();
+                nextDue = kNow + kIdleCheckInterval;
+
+                for (IPrefetchTarget* target : targets)
+                {
+                    const std::optional<SPrefetchPrediction> kPrediction = target->GetPrefetchPrediction();
+                    if (false == kPrediction.has_value())
+                        continue;
+
+                    // A consumer that has not read for a long time has stopped reading, at least for now, and its cadence will be learned again when it resumes.
+                    if (kNow > (kPrediction->nextRead + CadenceTracker::kMaximumPeriod))
+                        continue;
+
+                    const uint64_t kLeadTime = std::min(leadTime, kPrediction->period);
+
+                    if (true == kPrediction->prefetchPending)
+                    {
+                        // The consumer has not yet picked up the previous prefetch. By the time it is due for another one the consumer will have read, and its next read will be one period after that.
+                        nextDue = std::min(nextDue, std::max(kPrediction->nextRead, kNow) + kPrediction->period - kLeadTime);
+                        continue;
+                    }
+
+                    const uint64_t kPrefetchTime = ((kPrediction->nextRead > kLeadTime) ? (kPrediction->nextRead - kLeadTime) : 0);
+                    if (kPrefetchTime > kNow)
+                    {
+                        nextDue = std::min(nextDue, kPrefetchTime);
+                        continue;
+                    }
+
+                    // A consumer that is more than half a period late has most likely skipped a frame, so prefetching now would only deliver stale data later.
+                    if (kNow <= (kPrediction->nextRead + (kPrediction->period / 2)))
+                    {
+                        dueTargets.push_back(target);
+                        prefetchingTargets.push_back(target);
+                    }
+
+                    nextDue = std::min(nextDue, std::max(kPrediction->nextRead, kNow) + kPrediction->period - kLeadTime);
+                }
+            }
+
+            for (IPrefetchTarget* target : dueTargets)
+            {
+                target->Prefetch();
+
+                std::scoped_lock lock(schedulerMutex);
+                prefetchingTargets.erase(std::find(prefetchingTargets.begin(), prefetchingTargets.end(), target));
+                prefetchCompleted.notify_all();
+            }
+
+            return nextDue;
+        }
+
+        // --------
+
+        void PrefetchScheduler::Start(uint64_t newLeadTime)
+        {
+            {
+                std::scoped_lock lock(schedulerMutex);
+                leadTime = newLeadTime;
+            }
+
+            prefetchWorker.Start([this]() -> void { PrefetchThreadMain(); });
+        }
+
+        // --------
+
+        void PrefetchScheduler::Stop(void)
+        {
+            prefetchWorker.Stop();
+        }
+    }
+}
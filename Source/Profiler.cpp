@@ -0,0 +1,436 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Profiler.cpp
+ *   Implementation of an opt-in profiler that measures how long application
+ *   calls into Xidi's DirectInput and WinMM entry points take.
+ *****************************************************************************/
+
+#include "Message.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace Xidi
+{
+    namespace Profiler
+    {
+        // -------- INTERNAL TYPES ----------------------------------------- //
+
+        /// Counters for a single entry point invoked on a single virtual controller.
+        /// Each thread owns its own counters and is the only writer, so updates need only be atomic with respect to concurrent readers.
+        struct SInvocationCounters
+        {
+            std::atomic<uint64_t> count;                                    ///< See #SInvocationStatistics::count.
+            std::atomic<uint64_t> totalNanoseconds;                         ///< See #SInvocationStatistics::totalNanoseconds.
+            std::atomic<uint64_t> maxNanoseconds;                           ///< See #SInvocationStatistics::maxNanoseconds.
+            std::atomic<uint64_t> histogram[kHistogramBucketCount];         ///< See #SInvocationStatistics::histogram.
+        };
+
+        /// Complete set of counters belonging to a single thread.
+        struct SCounterBlock
+        {
+            SInvocationCounters entryPoint[(int)EEntryPoint::Count][kControllerSlotCount]; ///< Counters, indexed first by #EEntryPoint and then by controller slot.
+        };
+
+        /// Tracks the counters of all threads so that they can be merged on read.
+        struct SCounterRegistry
+        {
+            std::mutex registryMutex;                                       ///< Guards all other members.
+            std::vector<const SCounterBlock*> liveBlocks;                   ///< Counters of threads that are still running.
+            SCounterBlock retiredBlock;                                     ///< Sum of the counters of threads that have exited.
+        };
+
+        /// Timing of all startup phases, along with which of them have already been output.
+        struct SStartupTrace
+        {
+            std::mutex traceMutex;                                          ///< Guards all other members.
+            SStartupPhaseRecord phase[(int)EStartupPhase::Count];           ///< Timing of each startup phase, indexed by #EStartupPhase.
+            bool phaseOutput[(int)EStartupPhase::Count];                    ///< Whether the timing of each startup phase has been output, indexed by #EStartupPhase.
+        };
+
+        /// Owns the calling thread's counters and registers them for as long as the thread is running.
+        /// When the thread exits, its counters are folded into the retired counters so that nothing is lost.
+        class ThreadCounters
+        {
+        public:
+            // -------- INSTANCE VARIABLES --------------------------------- //
+
+            /// Counters that belong to the owning thread.
+            std::unique_ptr<SCounterBlock> block;
+
+
+            // -------- CONSTRUCTION AND DESTRUCTION ----------------------- //
+
+            /// Default constructor.
+            /// Creates and registers the calling thread's counters.
+            ThreadCounters(void);
+
+            /// Default destructor.
+            /// Folds the calling thread's counters into the retired counters and unregisters them.
+            ~ThreadCounters(void);
+        };
+
+
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Human-readable names of entry points, indexed by #EEntryPoint.
+        static constexpr const wchar_t* kEntryPointNames[] = {
+            L"EnumDevices",
+            L"EnumObjects",
+            L"GetDeviceData",
+            L"GetDeviceState",
+            L"GetProperty",
+            L"Poll",
+            L"SetProperty",
+            L"joyConfigChanged",
+            L"joyGetDevCaps",
+            L"joyGetNumDevs",
+            L"joyGetPos",
+            L"joyGetPosEx",
+            L"joyGetThreshold",
+            L"joyReleaseCapture",
+            L"joySetCapture",
+            L"joySetThreshold"
+        };
+        static_assert(_countof(kEntryPointNames) == (int)EEntryPoint::Count, "Entry point name table mismatch.");
+
+        /// Human-readable names of startup phases, indexed by #EStartupPhase.
+        static constexpr const wchar_t* kStartupPhaseNames[] = {
+            L"library attach",
+            L"configuration read",
+            L"log enable",
+            L"mapper registration",
+            L"feature startup",
+            L"WinMM system device enumeration",
+            L"WinMM joystick index map",
+            L"WinMM controller names"
+        };
+        static_assert(_countof(kStartupPhaseNames) == (int)EStartupPhase::Count, "Startup phase name table mismatch.");
+
+
+        // -------- INTERNAL VARIABLES ------------------------------------- //
+
+        /// Whether or not the profiler is enabled.
+        static std::atomic<bool> profilerEnabled = false;
+
+        /// Time at which the library was loaded, which is the reference point for the timing of all startup phases.
+        /// Captured during dynamic initialization, which runs just before the library entry point.
+        static const std::chrono::steady_clock::time_point kLibraryLoadTime = std::chrono::steady_clock::now();
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Retrieves the registry of all threads' counters.
+        /// @return Counter registry reference.
+        static SCounterRegistry& GetCounterRegistry(void)
+        {
+            static SCounterRegistry counterRegistry;
+            return counterRegistry;
+        }
+
+        /// Retrieves the calling thread's counters, creating them on first use.
+        /// @return Calling thread's counters.
+        static SCounterBlock& GetThreadCounterBlock(void)
+        {
+            thread_local ThreadCounters threadCounters;
+            return *threadCounters.block;
+        }
+
+        /// Retrieves the timing of all startup phases.
+        /// @return Startup trace reference.
+        static SStartupTrace& GetStartupTrace(void)
+        {
+            static SStartupTrace startupTrace;
+            return startupTrace;
+        }
+
+        /// Adds one set of counters into another. Used to accumulate counters across threads.
+        /// @param [in,out] destination Counters into which to add.
+        /// @param [in] source Counters to add.
+        static void AccumulateCounters(SInvocationStatistics& destination, const SInvocationCounters& source)
+        {
+            destination.count += source.count.load(std::memory_order_relaxed);
+            destination.totalNanoseconds += source.totalNanoseconds.load(std::memory_order_relaxed);
+            destination.maxNanoseconds = std::max(destination.maxNanoseconds, source.maxNanoseconds.load(std::memory_order_relaxed));
+
+            for (uint32_t i = 0; i < kHistogramBucketCount; ++i)
+                destination.histogram[i] += source.histogram[i].load(std::memory_order_relaxed);
+        }
+
+        /// Increments a counter owned by the calling thread.
+        /// Only the owning thread writes to its counters, so a plain load and store is sufficient and avoids a locked read-modify-write instruction.
+        /// @param [in,out] counter Counter to increment.
+        /// @param [in] amount Amount by which to increment.
+        static inline void IncrementOwnedCounter(std::atomic<uint64_t>& counter, uint64_t amount = 1)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        /// Generates a human-readable description of a controller slot.
+        /// @param [in] controllerSlot Controller slot.
+        /// @return Description of the controller slot.
+        static std::wstring ControllerSlotName(uint32_t controllerSlot)
+        {
+            if (kNoController == controllerSlot)
+                return L"no virtual controller";
+
+            return L"virtual controller " + std::to_wstring(controllerSlot + 1);
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See above for documentation.
+
+        ThreadCounters::ThreadCounters(void) : block(std::make_unique<SCounterBlock>())
+        {
+            SCounterRegistry& counterRegistry = GetCounterRegistry();
+
+            std::scoped_lock lock(counterRegistry.registryMutex);
+            counterRegistry.liveBlocks.push_back(block.get());
+        }
+
+        // --------
+
+        ThreadCounters::~ThreadCounters(void)
+        {
+            SCounterRegistry& counterRegistry = GetCounterRegistry();
+
+            std::scoped_lock lock(counterRegistry.registryMutex);
+            counterRegistry.liveBlocks.erase(std::find(counterRegistry.liveBlocks.begin(), counterRegistry.liveBlocks.end(), block.get()));
+
+            for (int i = 0; i < (int)EEntryPoint::Count; ++i)
+            {
+                for (uint32_t j = 0; j < kControllerSlotCount; ++j)
+                {
+                    SInvocationStatistics retiredStatistics = {};
+                    AccumulateCounters(retiredStatistics, counterRegistry.retiredBlock.entryPoint[i][j]);
+                    AccumulateCounters(retiredStatistics, block->entryPoint[i][j]);
+
+                    SInvocationCounters& retiredCounters = counterRegistry.retiredBlock.entryPoint[i][j];
+                    retiredCounters.count.store(retiredStatistics.count, std::memory_order_relaxed);
+                    retiredCounters.totalNanoseconds.store(retiredStatistics.totalNanoseconds, std::memory_order_relaxed);
+                    retiredCounters.maxNanoseconds.store(retiredStatistics.maxNanoseconds, std::memory_order_relaxed);
+
+                    for (uint32_t k = 0; k < kHistogramBucketCount; ++k)
+                        retiredCounters.histogram[k].store(retiredStatistics.histogram[k], std::memory_order_relaxed);
+                }
+            }
+        }
+
+
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+        // See "Profiler.h" for documentation.
+
+        ScopedInvocation::ScopedInvocation(EEntryPoint entryPoint, uint32_t controllerId) : kEntryPoint(entryPoint), controllerSlot(kNoController), kIsMeasuring(IsEnabled()), kStartTime((true == kIsMeasuring) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        {
+            SetController(controllerId);
+        }
+
+        // --------
+
+        ScopedInvocation::~ScopedInvocation(void)
+        {
+            if (true == kIsMeasuring)
+                RecordInvocation(kEntryPoint, controllerSlot, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kStartTime).count());
+        }
+
+        // --------
+
+        ScopedStartupPhase::~ScopedStartupPhase(void)
+        {
+            RecordStartupPhase(kPhase, kStartTime, std::chrono::steady_clock::now());
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Profiler.h" for documentation.
+
+        void Enable(void)
+        {
+            profilerEnabled.store(true, std::memory_order_relaxed);
+        }
+
+        // --------
+
+        const wchar_t* EntryPointName(EEntryPoint entryPoint)
+        {
+            if ((unsigned int)entryPoint >= (unsigned int)EEntryPoint::Count)
+                return L"(unknown)";
+
+            return kEntryPointNames[(unsigned int)entryPoint];
+        }
+
+        // --------
+
+        SStartupPhaseRecord GetStartupPhaseRecord(EStartupPhase phase)
+        {
+            if ((unsigned int)phase >= (unsigned int)EStartupPhase::Count)
+                return SStartupPhaseRecord();
+
+            SStartupTrace& startupTrace = GetStartupTrace();
+
+            std::scoped_lock lock(startupTrace.traceMutex);
+            return startupTrace.phase[(int)phase];
+        }
+
+        // --------
+
+        uint32_t HistogramBucketForLatency(uint64_t latencyNanoseconds)
+        {
+            return std::min((uint32_t)std::bit_width(latencyNanoseconds), kHistogramBucketCount - 1);
+        }
+
+        // --------
+
+        bool IsEnabled(void)
+        {
+            return profilerEnabled.load(std::memory_order_relaxed);
+        }
+
+        // --------
+
+        void OutputReport(void)
+        {
+            if (false == IsEnabled())
+                return;
+
+            const SReport kReport = TakeReport();
+            bool anyInvocations = false;
+
+            Message::Output(Message::ESeverity::Info, L"Profiler report follows. Average and maximum latencies are in microseconds. Histogram buckets are labelled with their latency bounds in nanoseconds.");
+
+            for (int i = 0; i < (int)EEntryPoint::Count; ++i)
+            {
+                for (uint32_t j = 0; j < kControllerSlotCount; ++j)
+                {
+                    const SInvocationStatistics& kStatistics = kReport.entryPoint[i][j];
+                    if (0 == kStatistics.count)
+                        continue;
+
+                    anyInvocations = true;
+
+                    std::wstring histogramString;
+                    for (uint32_t k = 0; k < kHistogramBucketCount; ++k)
+                    {
+                        if (0 == kStatistics.histogram[k])
+                            continue;
+
+                        if ((kHistogramBucketCount - 1) == k)
+                            histogramString += L" >=" + std::to_wstring(1ull << (k - 1));
+                        else
+                            histogramString += L" <" + std::to_wstring(1ull << k);
+
+                        histogramString += L":" + std::to_wstring(kStatistics.histogram[k]);
+                    }
+
+                    Message::OutputFormatted(Message::ESeverity::Info, L"  %s on %s: count = %llu, average = %.3f, max = %.3f, histogram =%s", EntryPointName((EEntryPoint)i), ControllerSlotName(j).c_str(), (unsigned long long)kStatistics.count, ((double)kStatistics.totalNanoseconds / (double)kStatistics.count / 1000.0), ((double)kStatistics.maxNanoseconds / 1000.0), histogramString.c_str());
+                }
+            }
+
+            if (false == anyInvocations)
+                Message::Output(Message::ESeverity::Info, L"  No entry points were invoked.");
+        }
+
+        // --------
+
+        void OutputStartupTrace(void)
+        {
+            SStartupTrace& startupTrace = GetStartupTrace();
+
+            std::scoped_lock lock(startupTrace.traceMutex);
+
+            for (int i = 0; i < (int)EStartupPhase::Count; ++i)
+            {
+                if ((false == startupTrace.phase[i].recorded) || (true == startupTrace.phaseOutput[i]))
+                    continue;
+
+                Message::OutputFormatted(Message::ESeverity::Info, L"Startup phase %s began %.3f ms after the library was loaded and took %.3f ms.", StartupPhaseName((EStartupPhase)i), ((double)startupTrace.phase[i].startNanoseconds / 1000000.0), ((double)startupTrace.phase[i].durationNanoseconds / 1000000.0));
+                startupTrace.phaseOutput[i] = true;
+            }
+        }
+
+        // --------
+
+        void RecordInvocation(EEntryPoint entryPoint, uint32_t controllerSlot, uint64_t latencyNanoseconds)
+        {
+            if ((false == IsEnabled()) || ((unsigned int)entryPoint >= (unsigned int)EEntryPoint::Count) || (controllerSlot >= kControllerSlotCount))
+                return;
+
+            SInvocationCounters& counters = GetThreadCounterBlock().entryPoint[(int)entryPoint][controllerSlot];
+
+            IncrementOwnedCounter(counters.count);
+            IncrementOwnedCounter(counters.totalNanoseconds, latencyNanoseconds);
+            IncrementOwnedCounter(counters.histogram[HistogramBucketForLatency(latencyNanoseconds)]);
+
+            if (latencyNanoseconds > counters.maxNanoseconds.load(std::memory_order_relaxed))
+                counters.maxNanoseconds.store(latencyNanoseconds, std::memory_order_relaxed);
+        }
+
+        // --------
+
+        void RecordStartupPhase(EStartupPhase phase, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+        {
+            if ((unsigned int)phase >= (unsigned int)EStartupPhase::Count)
+                return;
+
+            SStartupTrace& startupTrace = GetStartupTrace();
+
+            std::scoped_lock lock(startupTrace.traceMutex);
+
+            SStartupPhaseRecord& record = startupTrace.phase[(int)phase];
+            if (true == record.recorded)
+                return;
+
+            record.recorded = true;
+            record.startNanoseconds = ((startTime > kLibraryLoadTime) ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - kLibraryLoadTime).count() : 0);
+            record.durationNanoseconds = ((endTime > startTime) ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count() : 0);
+        }
+
+        // --------
+
+        const wchar_t* StartupPhaseName(EStartupPhase phase)
+        {
+            if ((unsigned int)phase >= (unsigned int)EStartupPhase::Count)
+                return L"(unknown)";
+
+            return kStartupPhaseNames[(unsigned int)phase];
+        }
+
+        // --------
+
+        SReport TakeReport(void)
+        {
+            SReport report = {};
+            SCounterRegistry& counterRegistry = GetCounterRegistry();
+
+            std::scoped_lock lock(counterRegistry.registryMutex);
+
+            for (int i = 0; i < (int)EEntryPoint::Count; ++i)
+            {
+                for (uint32_t j = 0; j < kControllerSlotCount; ++j)
+                {
+                    AccumulateCounters(report.entryPoint[i][j], counterRegistry.retiredBlock.entryPoint[i][j]);
+
+                    for (const SCounterBlock* liveBlock : counterRegistry.liveBlocks)
+                        AccumulateCounters(report.entryPoint[i][j], liveBlock->entryPoint[i][j]);
+                }
+            }
+
+            return report;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SharedMemory.cpp
+ *   Implementation of named memory regions that are shared between
+ *   processes.
+ *****************************************************************************/
+
+#include "ApiWindows.h"
+#include "SharedMemory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+namespace Xidi
+{
+    // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
+    // See "SharedMemory.h" for documentation.
+
+    SharedMemory::~SharedMemory(void)
+    {
+        Close();
+    }
+
+
+    // -------- INTERNAL INSTANCE METHODS ---------------------------------- //
+    // See "SharedMemory.h" for documentation.
+
+    void SharedMemory::Close(void)
+    {
+        if (nullptr != view)
+        {
+            UnmapViewOfFile(view);
+            view = nullptr;
+        }
+
+        if (nullptr != mappingHandle)
+        {
+            CloseHandle(mappingHandle);
+            mappingHandle = nullptr;
+        }
+    }
+
+
+    // -------- CONCRETE INSTANCE METHODS ---------------------------------- //
+    // See "SharedMemory.h" for documentation.
+
+    void* SharedMemory::Create(std::wstring_view name, size_t size)
+    {
+        Close();
+
+        mappingHandle = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name.data());
+        if (nullptr == mappingHandle)
+            return nullptr;
+
+        view = MapViewOfFile(mappingHandle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+        if (nullptr == view)
+            Close();
+
+        return view;
+    }
+
+    // --------
+
+    const void* SharedMemory::Open(std::wstring_view name, size_t size)
+    {
+        Close();
+
+        mappingHandle = OpenFileMapping(FILE_MAP_READ, FALSE, name.data());
+        if (nullptr == mappingHandle)
+            return nullptr;
+
+        view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, size);
+        if (nullptr == view)
+            Close();
+
+        return view;
+    }
+}
@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SharedXInput.cpp
+ *   Implementation of an implementation of the XInput interface that shares a
+ *   single poller of controller states among all processes that load Xidi.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "BackgroundWorker.h"
+#include "Clock.h"
+#include "SequenceLock.h"
+#include "SharedMemory.h"
+#include "SharedXInput.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+
+namespace Xidi
+{
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Number of times a reader retries when it observes a write in progress before giving up.
+    /// A write copies only a handful of words, so readers only ever retry more than once if the writer is preempted in the middle of a write.
+    static constexpr unsigned int kMaxReadAttempts = 64;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Claims the segment for the current version of Xidi, or verifies that it was already claimed by the same version.
+    /// @param [in] segment Segment to claim.
+    /// @return `true` if the segment can be used, `false` if it was claimed by an incompatible version.
+    static bool ClaimSegment(SharedXInput::SSegment& segment)
+    {
+        uint32_t signature = 0;
+        if ((false == segment.signature.compare_exchange_strong(signature, SharedXInput::kSegmentSignature)) && (SharedXInput::kSegmentSignature != signature))
+            return false;
+
+        uint32_t version = 0;
+        if ((false == segment.version.compare_exchange_strong(version, SharedXInput::kSegmentVersion)) && (SharedXInput::kSegmentVersion != version))
+            return false;
+
+        return true;
+    }
+
+
+    // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
+    // See "SharedXInput.h" for documentation.
+
+    SharedXInput::SharedXInput(std::unique_ptr<ISharedMemory>&& sharedMemory, std::unique_ptr<IXInput>&& source, uint32_t processId, std::wstring_view segmentName, const IClock& clock) : sharedMemory(std::move(sharedMemory)), source(std::move(source)), kProcessId(processId), clock(clock), segment(nullptr), owner(false), updateMutex(), observedHeartbeat(0), observedHeartbeatTimestamp(0), pollerWorker()
+    {
+        // Other processes may already be using the segment, so it is reinterpreted rather than constructed in place, which would reset its contents.
+        SSegment* const kSegment = reinterpret_cast<SSegment*>(this->sharedMemory->Create(segmentName, sizeof(SSegment)));
+        if ((nullptr == kSegment) || (false == ClaimSegment(*kSegment)))
+            return;
+
+        segment = kSegment;
+
+        std::scoped_lock lock(updateMutex);
+
+        observedHeartbeat = segment->heartbeat.load(std::memory_order_acquire);
+        observedHeartbeatTimestamp = clock.GetTimestamp();
+        TryTakeOwnershipLocked(0);
+    }
+
+    // --------
+
+    SharedXInput::~SharedXInput(void)
+    {
+        Stop();
+    }
+
+
+    // -------- INTERNAL INSTANCE METHODS ---------------------------------- //
+    // See "SharedXInput.h" for documentation.
+
+    void SharedXInput::GiveUpOwnership(void)
+    {
+        if (false == owner.exchange(false, std::memory_order_relaxed))
+            return;
+
+        uint32_t expectedOwnerProcessId = kProcessId;
+        segment->ownerProcessId.compare_exchange_strong(expectedOwnerProcessId, 0, std::memory_order_acq_rel);
+    }
+
+    // --------
+
+    void SharedXInput::PollSourceLocked(void)
+    {
+        for (DWORD i = 0; i < kSlotCount; ++i)
+        {
+            SSlotValue slotValue = {};
+            slotValue.result = source->GetState(i, &slotValue.state);
+
+            // A failed write means another process is writing the same slot, which can only happen briefly while ownership changes hands.
+            segment->slot[i].value.TryWrite(slotValue);
+        }
+
+        segment->heartbeat.fetch_add(1, std::memory_order_release);
+    }
+
+    // --------
+
+    void SharedXInput::PollerThreadMain(uint64_t pollInterval)
+    {
+        do
+        {
+            Update();
+        } while (true == pollerWorker.WaitFor(pollInterval));
+    }
+
+    // --------
+
+    bool SharedXInput::TryTakeOwnershipLocked(uint32_t expectedOwnerProcessId)
+    {
+        if (false == segment->ownerProcessId.compare_exchange_strong(expectedOwnerProcessId, kProcessId, std::memory_order_acq_rel))
+            return false;
+
+        // A previous owner that exited in the middle of a write would otherwise leave the slot looking permanently busy.
+        // Any data left half-written is replaced by the poll that immediately follows.
+        for (DWORD i = 0; i < kSlotCount; ++i)
+            segment->slot[i].value.ClearInterruptedWrite();
+
+        owner.store(true, std::memory_order_relaxed);
+        PollSourceLocked();
+        return true;
+    }
+
+
+    // -------- INSTANCE METHODS ------------------------------------------- //
+    // See "SharedXInput.h" for documentation.
+
+    void SharedXInput::Abandon(void)
+    {
+        pollerWorker.Abandon();
+
+        // Giving up ownership only involves the segment itself, which is never locked, so another process can still take over immediately.
+        if (nullptr != segment)
+            GiveUpOwnership();
+    }
+
+    // --------
+
+    bool SharedXInput::IsRunning(void)
+    {
+        return pollerWorker.IsRunning();
+    }
+
+    // --------
+
+    void SharedXInput::Start(uint64_t pollInterval)
+    {
+        pollerWorker.Start([this, pollInterval]() -> void { PollerThreadMain(pollInterval); });
+    }
+
+    // --------
+
+    void SharedXInput::Stop(void)
+    {
+        pollerWorker.Stop();
+
+        if ((nullptr == segment) || (true == pollerWorker.IsAbandoned()))
+            return;
+
+        std::scoped_lock lock(updateMutex);
+        GiveUpOwnership();
+    }
+
+    // --------
+
+    void SharedXInput::Update(void)
+    {
+        if (nullptr == segment)
+            return;
+
+        std::scoped_lock lock(updateMutex);
+
+        const uint32_t kOwnerProcessId = segment->ownerProcessId.load(std::memory_order_acquire);
+        const uint64_t kNow = clock.GetTimestamp();
+
+        if (true == IsOwner())
+        {
+            if (kProcessId == kOwnerProcessId)
+            {
+                PollSourceLocked();
+                return;
+            }
+
+            // Another process decided this one had stopped, most likely because it was suspended for a while, and took over.
+            owner.store(false, std::memory_order_relaxed);
+            observedHeartbeat = segment->heartbeat.load(std::memory_order_acquire);
+            observedHeartbeatTimestamp = kNow;
+            return;
+        }
+
+        if (0 == kOwnerProcessId)
+        {
+            TryTakeOwnershipLocked(0);
+            return;
+        }
+
+        const uint64_t kHeartbeat = segment->heartbeat.load(std::memory_order_acquire);
+        if (kHeartbeat != observedHeartbeat)
+        {
+            observedHeartbeat = kHeartbeat;
+            observedHeartbeatTimestamp = kNow;
+            return;
+        }
+
+        if ((kNow - observedHeartbeatTimestamp) >= kOwnerTimeout)
+        {
+            TryTakeOwnershipLocked(kOwnerProcessId);
+            observedHeartbeatTimestamp = kNow;
+        }
+    }
+
+
+    // -------- CONCRETE INSTANCE METHODS ---------------------------------- //
+    // See "XInputInterface.h" for documentation.
+
+    DWORD SharedXInput::GetState(DWORD dwUserIndex, XINPUT_STATE* pState)
+    {
+        if (nullptr == segment)
+            return source->GetState(dwUserIndex, pState);
+
+        if (dwUserIndex >= kSlotCount)
+            return ERROR_DEVICE_NOT_CONNECTED;
+
+        const std::optional<SSlotValue> kSlotValue = segment->slot[dwUserIndex].value.TryRead(kMaxReadAttempts);
+        if (false == kSlotValue.has_value())
+            return ERROR_DEVICE_NOT_CONNECTED;
+
+        *pState = kSlotValue->state;
+        return kSlotValue->result;
+    }
+}
@@ -10,35 +10,111 @@
  *   state change events.
  *****************************************************************************/
 
-#include "ApiWindows.h"
 #include "ControllerTypes.h"
 #include "StateChangeEventBuffer.h"
 
 #include <atomic>
 #include <boost/circular_buffer.hpp>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 
 
 namespace Xidi
 {
     namespace Controller
     {
-        // -------- INTERNAL FUNCTIONS --------------------------------- //
+        // -------- INTERNAL CONSTANTS --------------------------------- //
 
-        /// Computes and returns a timestamp to be used when appending an event to an event buffer.
-        /// @return Timestamp value to use.
-        static inline uint32_t GetTimestamp(void)
+        /// Assumed size of a processor cache line, in bytes.
+        static constexpr size_t kCacheLineSize = 64;
+
+
+        // -------- INTERNAL TYPES ------------------------------------- //
+
+        /// Holds the sequence number counter shared by all event buffers.
+        /// Occupies an entire cache line so that updating the counter does not also invalidate unrelated data that other processors are using.
+        struct alignas(kCacheLineSize) SSequenceCounter
         {
-            // Per DirectInput documentation, it is acceptable for the timestamp to overflow every ~50 days.
-            // See IDirectInput8::GetDeviceData documentation for more information.
+            std::atomic<uint32_t> nextSequence;                             ///< Next sequence number to be reserved.
+        };
+        static_assert(sizeof(SSequenceCounter) == kCacheLineSize, L"Data structure size constraint violation.");
+
+
+        // -------- INTERNAL VARIABLES --------------------------------- //
+
+        /// Source of sequence numbers for all event buffers.
+        static SSequenceCounter sequenceCounter = {.nextSequence = 0};
+
+
+        // -------- CLASS METHODS -------------------------------------- //
+        // See "StateChangeEventBuffer.h" for documentation.
+
+        uint32_t StateChangeEventBuffer::ReserveSequenceNumbers(uint32_t count)
+        {
+            return sequenceCounter.nextSequence.fetch_add(count, std::memory_order_relaxed);
+        }
+
+
+        // -------- INSTANCE METHODS ----------------------------------- //
+        // See "StateChangeEventBuffer.h" for documentation.
+
+        bool StateChangeEventBuffer::CoalesceAxisEvent(SEventData eventData, uint64_t timestamp, uint32_t sequence)
+        {
+            // Only the trailing run of axis events is eligible for merging. Merging across a button or POV event would change the order in which the application observes those transitions relative to axis motion.
+            // Because every axis event appended under this policy is itself merged whenever possible, the trailing run holds at most one event per axis and so this search is short.
+            for (auto eventIter = eventBuffer.rbegin(); eventIter != eventBuffer.rend(); ++eventIter)
+            {
+                if (EElementType::Axis != eventIter->data.element.type)
+                    break;
+
+                if (eventData.element.axis == eventIter->data.element.axis)
+                {
+                    // Rather than overwriting in place, the stale event is removed and the merged event is appended.
+                    // This keeps sequence numbers in chronological order, which applications are entitled to expect.
+                    eventBuffer.erase(std::next(eventIter).base());
+                    eventBuffer.push_back({
+                        .data = eventData,
+                        .timestamp = timestamp,
+                        .sequence = sequence
+                    });
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // --------
+
+        void StateChangeEventBuffer::DiscardEventForOverflow(void)
+        {
+            switch (overflowPolicy)
+            {
+            case EOverflowPolicy::CoalesceAxes:
+                // Button and POV transitions are more valuable to applications than intermediate axis positions, so the oldest axis event is sacrificed first.
+                // Only if the buffer holds no axis events at all does a button or POV event get discarded.
+                for (auto eventIter = eventBuffer.begin(); eventIter != eventBuffer.end(); ++eventIter)
+                {
+                    if (EElementType::Axis == eventIter->data.element.type)
+                    {
+                        eventBuffer.rerase(eventIter);
+                        return;
+                    }
+                }
+                break;
+
+            default:
+                break;
+            }
 
-            return GetTickCount();
+            eventBuffer.pop_front();
         }
-        
-        /// Handles a possible buffer overflow condition.
-        /// @param [in] eventBuffer Event buffer object for which to check for overflow.
-        /// @return `true` if the event buffer overflowed, `false` otherwise.
-        static inline bool HandlePossibleOverflow(boost::circular_buffer<StateChangeEventBuffer::SEvent>& eventBuffer)
+
+        // --------
+
+        bool StateChangeEventBuffer::HandlePossibleOverflow(void)
         {
             // Per DirectInput documentation, we always need one free space in the buffer.
             // This is how we ensure the number of events stored is always one less than capacity.
@@ -47,27 +123,27 @@ namespace Xidi
             const bool eventBufferWasFull = ((0 != eventBuffer.size()) && (true == eventBuffer.full()));
 
             if (true == eventBufferWasFull)
-                eventBuffer.pop_front();
+                DiscardEventForOverflow();
 
             return eventBufferWasFull;
         }
 
-        
-        // -------- INSTANCE METHODS ----------------------------------- //
-        // See "StateChangeEventBuffer.h" for documentation.
+        // --------
 
-        void StateChangeEventBuffer::AppendEvent(SEventData eventData, uint32_t timestamp)
+        bool StateChangeEventBuffer::AppendEvent(SEventData eventData, uint64_t timestamp, uint32_t sequence)
         {
-            // Sequence number is globally ordered with respect to all controller events, even those from other event buffers.
-            static std::atomic<uint32_t> nextSequence = 0;
+            // A merged event occupies no additional space, so the overflow condition is left as it was.
+            if ((EOverflowPolicy::CoalesceAxes == overflowPolicy) && (EElementType::Axis == eventData.element.type) && (true == CoalesceAxisEvent(eventData, timestamp, sequence)))
+                return false;
 
             eventBuffer.push_back({
                 .data = eventData,
                 .timestamp = timestamp,
-                .sequence = nextSequence++
+                .sequence = sequence
             });
 
-            eventBufferOverflowed = HandlePossibleOverflow(eventBuffer);
+            eventBufferOverflowed = HandlePossibleOverflow();
+            return eventBufferOverflowed;
         }
 
         // --------
@@ -92,8 +168,18 @@ namespace Xidi
             if (GetCapacity() != capacity)
             {
                 const uint32_t newCapacity = ((capacity > kEventBufferCapacityMax) ? kEventBufferCapacityMax : capacity);
-                eventBuffer.rset_capacity(newCapacity);
-                eventBufferOverflowed = HandlePossibleOverflow(eventBuffer);
+
+                // Excess events are discarded before shrinking, using the same policy as when appending to a full buffer, so that shrinking never discards an event that overflow would have kept.
+                // As always, one free space is kept, so at most one less than the new capacity's worth of events remain. Disabling the buffer discards everything without reporting an overflow.
+                bool eventsDiscarded = false;
+                while ((0 != newCapacity) && (eventBuffer.size() >= newCapacity))
+                {
+                    DiscardEventForOverflow();
+                    eventsDiscarded = true;
+                }
+
+                eventBuffer.set_capacity(newCapacity);
+                eventBufferOverflowed = eventsDiscarded;
             }
         }
     }
@@ -0,0 +1,292 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file Statistics.cpp
+ *   Implementation of live statistics that are exported to a shared memory
+ *   segment so that an external monitor can observe them.
+ *****************************************************************************/
+
+#include "SharedMemory.h"
+#include "Statistics.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+
+
+namespace Xidi
+{
+    namespace Statistics
+    {
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Prefix of the name of every statistics segment. The complete name is formed by appending the PID of the publishing process.
+        /// Segments are created in the session-local namespace so that no special privileges are needed to create them.
+        static constexpr std::wstring_view kSegmentNamePrefix = L"Local\\Xidi.Statistics.";
+
+        /// Human-readable names of application-facing API functions, indexed by #EApiCall.
+        static constexpr const wchar_t* kApiCallNames[] = {
+            L"GetDeviceState",
+            L"GetDeviceData",
+            L"joyGetPosEx"
+        };
+        static_assert(_countof(kApiCallNames) == (int)EApiCall::Count, "API call name table mismatch.");
+
+
+        // -------- INTERNAL VARIABLES ------------------------------------- //
+
+        /// Shared memory object that maps the statistics segment.
+        static std::unique_ptr<ISharedMemory> publishedSharedMemory;
+
+        /// Statistics segment into which statistics are recorded, or `nullptr` if statistics are not being recorded.
+        /// Recording functions read this pointer on every invocation, so it is atomic and the common disabled case costs a single load.
+        static std::atomic<SSegment*> publishedSegment = nullptr;
+
+        /// Serializes publishing and unpublishing the statistics segment.
+        static std::mutex publishMutex;
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Retrieves the per-controller counters for the specified virtual controller, if statistics are being recorded.
+        /// @param [in] controllerId Identifier of the virtual controller.
+        /// @return Pointer to the counters, or `nullptr` if statistics are not being recorded or the identifier is out of range.
+        static inline SControllerCounters* ControllerCounters(uint32_t controllerId)
+        {
+            SSegment* const kSegment = publishedSegment.load(std::memory_order_acquire);
+            if ((nullptr == kSegment) || (controllerId >= kControllerCount))
+                return nullptr;
+
+            return &kSegment->controller[controllerId];
+        }
+
+        /// Increments a counter. Counters are independent of one another so no ordering is required.
+        /// @param [in,out] counter Counter to increment.
+        /// @param [in] amount Amount by which to increment.
+        static inline void IncrementCounter(TCounter& counter, uint64_t amount = 1)
+        {
+            counter.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "Statistics.h" for documentation.
+
+        const wchar_t* ApiCallName(EApiCall apiCall)
+        {
+            if ((unsigned int)apiCall >= (unsigned int)EApiCall::Count)
+                return L"(unknown)";
+
+            return kApiCallNames[(unsigned int)apiCall];
+        }
+
+        // --------
+
+        const SSegment* GetPublishedSegment(void)
+        {
+            return publishedSegment.load(std::memory_order_acquire);
+        }
+
+        // --------
+
+        bool Publish(std::unique_ptr<ISharedMemory>&& sharedMemory, uint32_t processId)
+        {
+            std::scoped_lock lock(publishMutex);
+
+            if (nullptr != publishedSegment.load())
+                return true;
+
+            void* const kSegmentMemory = sharedMemory->Create(SegmentName(processId), sizeof(SSegment));
+            if (nullptr == kSegmentMemory)
+                return false;
+
+            // Newly-created shared memory is zero-filled, which is a valid initial value for every counter.
+            // Constructing the segment in place starts the lifetimes of its atomic members without changing their contents.
+            SSegment* const kSegment = new (kSegmentMemory) SSegment;
+            kSegment->version = kSegmentVersion;
+            kSegment->size = sizeof(SSegment);
+            kSegment->processId = processId;
+            kSegment->signature.store(kSegmentSignature, std::memory_order_release);
+
+            publishedSharedMemory = std::move(sharedMemory);
+            publishedSegment.store(kSegment, std::memory_order_release);
+            return true;
+        }
+
+        // --------
+
+        SSnapshot ReadSnapshot(const SSegment& segment)
+        {
+            SSnapshot snapshot = {};
+
+            for (int i = 0; i < (int)EApiCall::Count; ++i)
+                snapshot.apiCalls[i] = segment.apiCalls[i].load(std::memory_order_relaxed);
+
+            for (uint32_t i = 0; i < kControllerCount; ++i)
+            {
+                snapshot.controller[i] = {
+                    .refreshCount = segment.controller[i].refreshCount.load(std::memory_order_relaxed),
+                    .xinputReadCount = segment.controller[i].xinputReadCount.load(std::memory_order_relaxed),
+                    .xinputLatencyTotalNanoseconds = segment.controller[i].xinputLatencyTotalNanoseconds.load(std::memory_order_relaxed),
+                    .xinputLatencyMaxNanoseconds = segment.controller[i].xinputLatencyMaxNanoseconds.load(std::memory_order_relaxed),
+                    .eventsAppended = segment.controller[i].eventsAppended.load(std::memory_order_relaxed),
+                    .eventsDropped = segment.controller[i].eventsDropped.load(std::memory_order_relaxed),
+                    .lockContentions = segment.controller[i].lockContentions.load(std::memory_order_relaxed),
+                    .prefetchCount = segment.controller[i].prefetchCount.load(std::memory_order_relaxed),
+                    .prefetchHits = segment.controller[i].prefetchHits.load(std::memory_order_relaxed),
+                    .prefetchMisses = segment.controller[i].prefetchMisses.load(std::memory_order_relaxed),
+                    .stateReadCount = segment.controller[i].stateReadCount.load(std::memory_order_relaxed),
+                    .stateAgeTotalNanoseconds = segment.controller[i].stateAgeTotalNanoseconds.load(std::memory_order_relaxed)
+                };
+            }
+
+            return snapshot;
+        }
+
+        // --------
+
+        void RecordApiCall(EApiCall apiCall)
+        {
+            SSegment* const kSegment = publishedSegment.load(std::memory_order_acquire);
+            if ((nullptr == kSegment) || ((unsigned int)apiCall >= (unsigned int)EApiCall::Count))
+                return;
+
+            IncrementCounter(kSegment->apiCalls[(unsigned int)apiCall]);
+        }
+
+        // --------
+
+        void RecordEvents(uint32_t controllerId, uint32_t numAppended, uint32_t numDropped)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            if (0 != numAppended)
+                IncrementCounter(kCounters->eventsAppended, numAppended);
+
+            if (0 != numDropped)
+                IncrementCounter(kCounters->eventsDropped, numDropped);
+        }
+
+        // --------
+
+        void RecordLockContention(uint32_t controllerId)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            IncrementCounter(kCounters->lockContentions);
+        }
+
+        // --------
+
+        void RecordPrefetch(uint32_t controllerId)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            IncrementCounter(kCounters->prefetchCount);
+        }
+
+        // --------
+
+        void RecordStateRead(uint32_t controllerId, uint64_t ageNanoseconds, EPrefetchOutcome outcome)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            IncrementCounter(kCounters->stateReadCount);
+            IncrementCounter(kCounters->stateAgeTotalNanoseconds, ageNanoseconds);
+
+            switch (outcome)
+            {
+            case EPrefetchOutcome::Hit:
+                IncrementCounter(kCounters->prefetchHits);
+                break;
+
+            case EPrefetchOutcome::Miss:
+                IncrementCounter(kCounters->prefetchMisses);
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // --------
+
+        void RecordRefresh(uint32_t controllerId)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            IncrementCounter(kCounters->refreshCount);
+        }
+
+        // --------
+
+        void RecordXInputRead(uint32_t controllerId, uint64_t latencyNanoseconds)
+        {
+            SControllerCounters* const kCounters = ControllerCounters(controllerId);
+            if (nullptr == kCounters)
+                return;
+
+            IncrementCounter(kCounters->xinputReadCount);
+            IncrementCounter(kCounters->xinputLatencyTotalNanoseconds, latencyNanoseconds);
+
+            uint64_t latencyMax = kCounters->xinputLatencyMaxNanoseconds.load(std::memory_order_relaxed);
+            while ((latencyNanoseconds > latencyMax) && (false == kCounters->xinputLatencyMaxNanoseconds.compare_exchange_weak(latencyMax, latencyNanoseconds, std::memory_order_relaxed)))
+            {
+                // Nothing to do here. A failed exchange refreshes the observed maximum.
+            }
+        }
+
+        // --------
+
+        std::wstring SegmentName(uint32_t processId)
+        {
+            return std::wstring(kSegmentNamePrefix) + std::to_wstring(processId);
+        }
+
+        // --------
+
+        void Unpublish(void)
+        {
+            std::scoped_lock lock(publishMutex);
+
+            publishedSegment.store(nullptr);
+            publishedSharedMemory.reset();
+        }
+
+        // --------
+
+        const SSegment* ValidateSegment(const void* segment, size_t size)
+        {
+            if ((nullptr == segment) || (size < sizeof(SSegment)))
+                return nullptr;
+
+            const SSegment* const kSegment = (const SSegment*)segment;
+            if (kSegmentSignature != kSegment->signature.load(std::memory_order_acquire))
+                return nullptr;
+
+            if ((kSegmentVersion != kSegment->version) || (sizeof(SSegment) != kSegment->size))
+                return nullptr;
+
+            return kSegment;
+        }
+    }
+}
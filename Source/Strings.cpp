@@ -36,6 +36,9 @@ namespace Xidi
         /// File extension for a log file.
         static constexpr std::wstring_view kStrLogFileExtension = L".log";
 
+        /// Suffix, including file extension, for the system device cache file.
+        static constexpr std::wstring_view kStrSystemDeviceCacheFileSuffix = L"_SystemDevices.cache";
+
 
         // -------- INTERNAL FUNCTIONS ------------------------------------- //
 
@@ -307,6 +310,29 @@ namespace Xidi
             return initString;
         }
 
+        /// Generates the value for kStrSystemDeviceCacheFilename; see documentation of this run-time constant for more information.
+        /// @return Corresponding run-time constant value.
+        static const std::wstring& GetSystemDeviceCacheFilename(void)
+        {
+            static std::wstring initString;
+            static std::once_flag initFlag;
+
+            std::call_once(initFlag, []() -> void
+                {
+                    TemporaryBuffer<wchar_t> buf;
+                    const DWORD numChars = GetTempPath(buf.Count(), buf);
+
+                    if ((numChars > 0) && (numChars < (DWORD)buf.Count()))
+                        initString.assign(buf);
+
+                    initString.append(GetProductName());
+                    initString.append(kStrSystemDeviceCacheFileSuffix);
+                }
+            );
+
+            return initString;
+        }
+
 
         // -------- RUN-TIME CONSTANTS ------------------------------------- //
         // See "Strings.h" for documentation.
@@ -322,6 +348,7 @@ namespace Xidi
         extern const std::wstring_view kStrSystemLibraryFilenameWinMM(GetSystemLibraryFilenameWinMM());
         extern const std::wstring_view kStrConfigurationFilename(GetConfigurationFilename());
         extern const std::wstring_view kStrLogFilename(GetLogFilename());
+        extern const std::wstring_view kStrSystemDeviceCacheFilename(GetSystemDeviceCacheFilename());
 
 
         // -------- FUNCTIONS ---------------------------------------------- //
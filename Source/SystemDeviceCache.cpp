@@ -0,0 +1,262 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SystemDeviceCache.cpp
+ *   Implementation of the persistent cache of information about the devices
+ *   that WinMM makes available.
+ *****************************************************************************/
+
+#include "SystemDeviceCache.h"
+
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+
+namespace Xidi
+{
+    namespace SystemDeviceCache
+    {
+        // -------- INTERNAL CONSTANTS ------------------------------------- //
+
+        /// Text that begins every cache file, followed by a space and the format version.
+        static constexpr std::string_view kFileSignature = "XidiSystemDeviceCache";
+
+        /// Largest number of devices a cache file can describe. WinMM itself supports far fewer, so anything larger means the file is corrupt.
+        static constexpr size_t kMaxDeviceCount = 256;
+
+        /// Suffix appended to the cache filename to produce the name under which a new cache file is written before it replaces the old one.
+        static constexpr std::wstring_view kTemporaryFileSuffix = L".tmp";
+
+
+        // -------- INTERNAL FUNCTIONS ------------------------------------- //
+
+        /// Determines if a character can appear in a device identifier stored in a cache file.
+        /// @param [in] character Character to check.
+        /// @return `true` if so, `false` otherwise.
+        template <typename CharType> static inline bool IsRepresentableCharacter(CharType character)
+        {
+            return ((character > (CharType)' ') && (character <= (CharType)'~'));
+        }
+
+        /// Removes and returns the first line of the specified text, without its line terminator.
+        /// @param [in,out] text Text from which to remove the first line.
+        /// @return First line of the text.
+        static std::string_view TakeLine(std::string_view& text)
+        {
+            const size_t kLineEnd = text.find('\n');
+            std::string_view line = text.substr(0, kLineEnd);
+            text.remove_prefix((std::string_view::npos == kLineEnd) ? text.length() : (kLineEnd + 1));
+
+            if ((false == line.empty()) && ('\r' == line.back()))
+                line.remove_suffix(1);
+
+            return line;
+        }
+
+        /// Parses an unsigned decimal integer that makes up an entire string.
+        /// @param [in] text Text to parse.
+        /// @return Parsed value, or nothing if the text is not entirely an unsigned decimal integer.
+        static std::optional<size_t> ParseUnsigned(std::string_view text)
+        {
+            size_t value = 0;
+            const std::from_chars_result kResult = std::from_chars(text.data(), text.data() + text.length(), value);
+
+            if ((true == text.empty()) || (std::errc() != kResult.ec) || ((text.data() + text.length()) != kResult.ptr))
+                return std::nullopt;
+
+            return value;
+        }
+
+
+        // -------- FUNCTIONS ---------------------------------------------- //
+        // See "SystemDeviceCache.h" for documentation.
+
+        bool ApplyIfMatching(const TDeviceList& cachedDevices, TDeviceList& presentDevices)
+        {
+            if (cachedDevices.size() != presentDevices.size())
+                return false;
+
+            for (size_t i = 0; i < cachedDevices.size(); ++i)
+            {
+                if (cachedDevices[i].first != presentDevices[i].first)
+                    return false;
+            }
+
+            for (size_t i = 0; i < cachedDevices.size(); ++i)
+                presentDevices[i].second = cachedDevices[i].second;
+
+            return true;
+        }
+
+        // --------
+
+        std::optional<TDeviceList> Load(std::wstring_view filename)
+        {
+            std::ifstream cacheFile(std::filesystem::path(filename), std::ios::in | std::ios::binary);
+            if (false == cacheFile.is_open())
+                return std::nullopt;
+
+            const std::string kContents((std::istreambuf_iterator<char>(cacheFile)), std::istreambuf_iterator<char>());
+            if (true == cacheFile.bad())
+                return std::nullopt;
+
+            return Parse(kContents);
+        }
+
+        // --------
+
+        std::optional<TDeviceList> Parse(std::string_view contents)
+        {
+            std::string_view headerLine = TakeLine(contents);
+            if ((false == headerLine.starts_with(kFileSignature)) || (false == headerLine.substr(kFileSignature.length()).starts_with(' ')))
+                return std::nullopt;
+
+            headerLine.remove_prefix(kFileSignature.length() + 1);
+            if (std::optional<size_t>(kFormatVersion) != ParseUnsigned(headerLine))
+                return std::nullopt;
+
+            const std::optional<size_t> kDeviceCount = ParseUnsigned(TakeLine(contents));
+            if ((false == kDeviceCount.has_value()) || (kDeviceCount.value() > kMaxDeviceCount))
+                return std::nullopt;
+
+            TDeviceList devices;
+            devices.reserve(kDeviceCount.value());
+
+            for (size_t i = 0; i < kDeviceCount.value(); ++i)
+            {
+                if (true == contents.empty())
+                    return std::nullopt;
+
+                // Each device occupies one line consisting of its XInput support flag, a space, and its identifier, which is empty if no device is present.
+                const std::string_view kDeviceLine = TakeLine(contents);
+                if ((kDeviceLine.length() < 2) || (' ' != kDeviceLine[1]))
+                    return std::nullopt;
+
+                bool supportsXInput = false;
+                switch (kDeviceLine[0])
+                {
+                case '0':
+                    supportsXInput = false;
+                    break;
+
+                case '1':
+                    supportsXInput = true;
+                    break;
+
+                default:
+                    return std::nullopt;
+                }
+
+                const std::string_view kIdentifier = kDeviceLine.substr(2);
+                if ((true == supportsXInput) && (true == kIdentifier.empty()))
+                    return std::nullopt;
+
+                std::wstring identifier;
+                identifier.reserve(kIdentifier.length());
+
+                for (const char character : kIdentifier)
+                {
+                    if (false == IsRepresentableCharacter(character))
+                        return std::nullopt;
+
+                    identifier.push_back((wchar_t)character);
+                }
+
+                devices.emplace_back(std::move(identifier), supportsXInput);
+            }
+
+            // Nothing is allowed to follow the last device, apart from an empty line.
+            while (false == contents.empty())
+            {
+                if (false == TakeLine(contents).empty())
+                    return std::nullopt;
+            }
+
+            return devices;
+        }
+
+        // --------
+
+        bool Save(std::wstring_view filename, const TDeviceList& devices)
+        {
+            const std::optional<std::string> kContents = Serialize(devices);
+            if (false == kContents.has_value())
+                return false;
+
+            const std::filesystem::path kCachePath(filename);
+            const std::filesystem::path kTemporaryPath(std::wstring(filename) + std::wstring(kTemporaryFileSuffix));
+
+            {
+                std::ofstream cacheFile(kTemporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+                if (false == cacheFile.is_open())
+                    return false;
+
+                cacheFile.write(kContents.value().data(), (std::streamsize)kContents.value().length());
+                cacheFile.close();
+
+                if (true == cacheFile.fail())
+                {
+                    std::error_code removeError;
+                    std::filesystem::remove(kTemporaryPath, removeError);
+                    return false;
+                }
+            }
+
+            std::error_code renameError;
+            std::filesystem::rename(kTemporaryPath, kCachePath, renameError);
+            if (renameError)
+            {
+                std::error_code removeError;
+                std::filesystem::remove(kTemporaryPath, removeError);
+                return false;
+            }
+
+            return true;
+        }
+
+        // --------
+
+        std::optional<std::string> Serialize(const TDeviceList& devices)
+        {
+            if (devices.size() > kMaxDeviceCount)
+                return std::nullopt;
+
+            std::stringstream contents;
+            contents << kFileSignature << ' ' << kFormatVersion << '\n';
+            contents << devices.size() << '\n';
+
+            for (const auto& device : devices)
+            {
+                if ((true == device.second) && (true == device.first.empty()))
+                    return std::nullopt;
+
+                contents << ((true == device.second) ? '1' : '0') << ' ';
+
+                for (const wchar_t character : device.first)
+                {
+                    if (false == IsRepresentableCharacter(character))
+                        return std::nullopt;
+
+                    contents << (char)character;
+                }
+
+                contents << '\n';
+            }
+
+            return contents.str();
+        }
+    }
+}
@@ -9,6 +9,7 @@
  *   Partial implementation of temporary buffer management functionality.
  *****************************************************************************/
 
+#include "ApiPlatform.h"
 #include "TemporaryBuffer.h"
 
 #include <cstdint>
@@ -77,7 +78,7 @@ namespace Xidi
 
         if (false == data.isInitialized)
         {
-            for (int i = 0; i < _countof(data.freeBuffers); ++i)
+            for (unsigned int i = 0; i < _countof(data.freeBuffers); ++i)
                 data.freeBuffers[i] = &data.staticBuffers[TemporaryBufferBase::kBytesPerBuffer * i];
 
             data.nextFreeBuffer = _countof(data.freeBuffers) - 1;
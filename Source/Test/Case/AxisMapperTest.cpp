@@ -10,7 +10,7 @@
  *   axis.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "TestCase.h"
@@ -47,12 +47,10 @@ namespace XidiTest
         {
             constexpr AxisMapper mapper(kTargetAxis);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = analogValue;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -70,12 +68,10 @@ namespace XidiTest
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
             const double analogValueDisplacement = (double)analogValue - (double)kAnalogValueMin;
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral + (int32_t)(analogValueDisplacement * kStepSize);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -93,12 +89,10 @@ namespace XidiTest
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
             const double analogValueDisplacement = (double)analogValue - (double)kAnalogValueMin;
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueMin + (int32_t)(analogValueDisplacement * kStepSize);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int32_t)analogValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -122,12 +116,10 @@ namespace XidiTest
             AxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = (int32_t)kAnalogValue * _countof(mappers);
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValue);
 
@@ -152,12 +144,10 @@ namespace XidiTest
             AxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValue);
         for (auto& mapper : mappersNegative)
@@ -176,12 +166,10 @@ namespace XidiTest
         {
             constexpr AxisMapper mapper(kTargetAxis);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueMin);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -198,12 +186,10 @@ namespace XidiTest
         {
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueNeutral);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -220,12 +206,10 @@ namespace XidiTest
         {
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMin : kAnalogValueNeutral);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -250,12 +234,10 @@ namespace XidiTest
                 AxisMapper(kTargetAxis)
             };
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueMin) * _countof(mappers);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             for (auto& mapper : mappers)
                 mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
@@ -281,12 +263,10 @@ namespace XidiTest
             AxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromButtonValue(actualState, true);
         for (auto& mapper : mappersNotPressed)
@@ -307,12 +287,10 @@ namespace XidiTest
             constexpr AxisMapper mapper(kTargetAxis);
             const double triggerValueDisplacement = (double)triggerValue - (double)kTriggerValueMin;
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueMin + (int32_t)(triggerValueDisplacement * kStepSize);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -330,12 +308,10 @@ namespace XidiTest
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
             const double triggerValueDisplacement = (double)triggerValue - (double)kTriggerValueMin;
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral + (int32_t)(triggerValueDisplacement * kStepSize);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -353,12 +329,10 @@ namespace XidiTest
             constexpr AxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
             const double triggerValueDisplacement = (double)triggerValue - (double)kTriggerValueMin;
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral - (int32_t)(triggerValueDisplacement * kStepSize);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -380,12 +354,10 @@ namespace XidiTest
             AxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueMax * _countof(mappers);
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)kTriggerValueMax);
 
@@ -410,12 +382,10 @@ namespace XidiTest
             AxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)kTriggerValueMax);
         for (auto& mapper : mappersNegative)
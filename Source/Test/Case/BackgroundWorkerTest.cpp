@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BackgroundWorkerTest.cpp
+ *   Unit tests for background threads that run until asked to stop.
+ *****************************************************************************/
+
+#include "BackgroundWorker.h"
+#include "TestCase.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Wait interval that is far longer than any test takes, so that a wait only returns early if it is interrupted.
+    static constexpr uint64_t kTestLongWait = 3600000000000ull;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Thread body that does nothing but wait until it is asked to stop.
+    /// @param [in] worker Background worker on whose thread this function runs.
+    static void WaitUntilStopRequested(BackgroundWorker& worker)
+    {
+        while (true == worker.WaitFor(kTestLongWait))
+            continue;
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that the background thread can be started and stopped repeatedly, and that starting it while it is running has no effect.
+    TEST_CASE(BackgroundWorker_StartStop)
+    {
+        BackgroundWorker worker;
+        TEST_ASSERT(false == worker.IsRunning());
+
+        TEST_ASSERT(true == worker.Start([&worker]() -> void { WaitUntilStopRequested(worker); }));
+        TEST_ASSERT(true == worker.IsRunning());
+        TEST_ASSERT(false == worker.Start([]() -> void {}));
+
+        worker.Stop();
+        TEST_ASSERT(false == worker.IsRunning());
+        TEST_ASSERT(true == worker.IsStopRequested());
+        worker.Stop();
+
+        TEST_ASSERT(true == worker.Start([&worker]() -> void { WaitUntilStopRequested(worker); }));
+        TEST_ASSERT(false == worker.IsStopRequested());
+    }
+
+    // Verifies that a notification causes a wait to return without asking the thread to stop, and that a stop request causes all waits to return immediately.
+    TEST_CASE(BackgroundWorker_WaitInterrupted)
+    {
+        BackgroundWorker worker;
+
+        worker.Notify();
+        TEST_ASSERT(true == worker.WaitFor(kTestLongWait));
+
+        worker.RequestStop();
+        TEST_ASSERT(true == worker.IsStopRequested());
+        TEST_ASSERT(false == worker.WaitFor(kTestLongWait));
+        TEST_ASSERT(false == worker.WaitFor(kTestLongWait));
+    }
+
+    // Verifies that an abandoned background thread is forgotten without being waited for, and that stopping afterwards has no effect.
+    TEST_CASE(BackgroundWorker_Abandon)
+    {
+        std::atomic<bool> threadMayExit = false;
+        std::atomic<bool> threadExited = false;
+
+        BackgroundWorker worker;
+        worker.Start([&threadMayExit, &threadExited]() -> void
+            {
+                while (false == threadMayExit)
+                    std::this_thread::yield();
+
+                threadExited = true;
+            }
+        );
+
+        worker.Abandon();
+        TEST_ASSERT(true == worker.IsAbandoned());
+        TEST_ASSERT(false == worker.IsRunning());
+
+        worker.Stop();
+        TEST_ASSERT(false == threadExited);
+
+        threadMayExit = true;
+        while (false == threadExited)
+            std::this_thread::yield();
+    }
+}
@@ -0,0 +1,326 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file BatchMapperTest.cpp
+ *   Unit tests and benchmark for mapping XInput controller states for many
+ *   virtual controller slots together.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "BatchMapper.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Controller;
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Element mapper that forwards single-slot contributions to another element mapper but has no batch implementation of its own.
+    /// Used to verify that element mappers relying on the default batch implementation still produce correct results.
+    class SingleSlotElementMapper : public IElementMapper
+    {
+    private:
+        // -------- INSTANCE VARIABLES ------------------------------------- //
+
+        /// Element mapper to which all contributions are forwarded.
+        const IElementMapper& elementMapper;
+
+
+    public:
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
+
+        /// Initialization constructor.
+        /// Requires the element mapper to which all contributions are forwarded.
+        inline SingleSlotElementMapper(const IElementMapper& elementMapper) : elementMapper(elementMapper)
+        {
+            // Nothing to do here.
+        }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+
+        void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override
+        {
+            elementMapper.ContributeFromAnalogValue(controllerState, analogValue);
+        }
+
+        void ContributeFromButtonValue(SState& controllerState, bool buttonPressed) const override
+        {
+            elementMapper.ContributeFromButtonValue(controllerState, buttonPressed);
+        }
+
+        void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override
+        {
+            elementMapper.ContributeFromTriggerValue(controllerState, triggerValue);
+        }
+
+        SElementIdentifier GetTargetElement(void) const override
+        {
+            return elementMapper.GetTargetElement();
+        }
+    };
+
+    /// Describes a set of axis properties used for testing.
+    struct STestAxisProperties
+    {
+        uint32_t deadzone;
+        uint32_t saturation;
+        int32_t rangeMin;
+        int32_t rangeMax;
+    };
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Axis properties used for testing. Covers defaults, partial and complete deadzones and saturations, deadzones that overlap saturation, and ranges up to the full 32-bit span.
+    static constexpr STestAxisProperties kTestAxisProperties[] = {
+        {.deadzone = VirtualController::kAxisDeadzoneDefault, .saturation = VirtualController::kAxisSaturationDefault, .rangeMin = kAnalogValueMin, .rangeMax = kAnalogValueMax},
+        {.deadzone = 2500, .saturation = 8000, .rangeMin = 0, .rangeMax = 65535},
+        {.deadzone = 1234, .saturation = 9876, .rangeMin = -1000, .rangeMax = 5000},
+        {.deadzone = 5000, .saturation = 5000, .rangeMin = -100, .rangeMax = 100},
+        {.deadzone = 7000, .saturation = 3000, .rangeMin = -32768, .rangeMax = 32767},
+        {.deadzone = VirtualController::kAxisDeadzoneMax, .saturation = VirtualController::kAxisSaturationMax, .rangeMin = -50, .rangeMax = 50},
+        {.deadzone = 0, .saturation = 0, .rangeMin = -10, .rangeMax = 10},
+        {.deadzone = 3000, .saturation = 9000, .rangeMin = INT32_MIN, .rangeMax = INT32_MAX},
+    };
+
+    /// Number of randomly-generated batches of XInput controller states checked for each mapper and slot count.
+    static constexpr unsigned int kTestNumRandomBatches = 64;
+
+    /// Slot counts for which the benchmark reports results.
+    static constexpr unsigned int kBenchmarkSlotCounts[] = {1, 2, 4, 8, 16};
+
+    /// Number of batches mapped by the benchmark for each slot count and path.
+    static constexpr unsigned int kBenchmarkNumBatches = 20000;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Generates a pseudo-random number using the xorshift64 algorithm, so that test inputs are varied but reproducible.
+    /// @param [in,out] randomState Random number generator state, which must be non-zero.
+    /// @return Next pseudo-random number.
+    static uint64_t NextRandom(uint64_t& randomState)
+    {
+        randomState ^= (randomState << 13);
+        randomState ^= (randomState >> 7);
+        randomState ^= (randomState << 17);
+        return randomState;
+    }
+
+    /// Generates a batch of XInput controller states with pseudo-random contents in every slot.
+    /// @param [in,out] randomState Random number generator state, which must be non-zero.
+    /// @return Generated batch of XInput controller states.
+    static Mapper::SXInputBatch RandomXInputBatch(uint64_t& randomState)
+    {
+        Mapper::SXInputBatch xinputStates;
+
+        for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+        {
+            const uint64_t kRandomSticks = NextRandom(randomState);
+            const uint64_t kRandomOther = NextRandom(randomState);
+
+            xinputStates.SetSlot(i, {
+                .wButtons = (WORD)kRandomOther,
+                .bLeftTrigger = (BYTE)(kRandomOther >> 16),
+                .bRightTrigger = (BYTE)(kRandomOther >> 24),
+                .sThumbLX = (SHORT)kRandomSticks,
+                .sThumbLY = (SHORT)(kRandomSticks >> 16),
+                .sThumbRX = (SHORT)(kRandomSticks >> 32),
+                .sThumbRY = (SHORT)(kRandomSticks >> 48)
+            });
+        }
+
+        return xinputStates;
+    }
+
+    /// Creates a complete set of virtual controller properties in which every axis uses the specified test axis properties.
+    /// @param [in] testAxisProperties Axis properties to use.
+    /// @return Virtual controller properties.
+    static VirtualController::SProperties MakeTestProperties(const STestAxisProperties& testAxisProperties)
+    {
+        VirtualController::SProperties properties;
+
+        for (auto& axisProperties : properties.axis)
+        {
+            axisProperties.SetDeadzone(testAxisProperties.deadzone);
+            axisProperties.SetSaturation(testAxisProperties.saturation);
+            axisProperties.SetRange(testAxisProperties.rangeMin, testAxisProperties.rangeMax);
+        }
+
+        return properties;
+    }
+
+    /// Maps many pseudo-random batches of XInput controller states using both the vectorized and the scalar reference paths and checks that the results are identical.
+    /// Every slot count from 1 to the maximum is checked, and each slot uses different axis properties.
+    /// @param [in] mapper Mapper to check.
+    static void CheckBatchMatchesReference(const Mapper& mapper)
+    {
+        BatchMapper batchMapper(mapper);
+        for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+            batchMapper.SetAxisProperties(i, MakeTestProperties(kTestAxisProperties[i % _countof(kTestAxisProperties)]));
+
+        uint64_t randomState = 0x9e3779b97f4a7c15ull;
+
+        for (unsigned int slotCount = 1; slotCount <= kBatchSlotCountMax; ++slotCount)
+        {
+            for (unsigned int i = 0; i < kTestNumRandomBatches; ++i)
+            {
+                const Mapper::SXInputBatch kXInputStates = RandomXInputBatch(randomState);
+
+                SState actualStates[kBatchSlotCountMax];
+                SState expectedStates[kBatchSlotCountMax];
+                batchMapper.MapXInputStates(kXInputStates, std::span<SState>(actualStates, slotCount));
+                batchMapper.MapXInputStatesReference(kXInputStates, std::span<SState>(expectedStates, slotCount));
+
+                for (unsigned int j = 0; j < slotCount; ++j)
+                {
+                    if (actualStates[j] != expectedStates[j])
+                        TEST_FAILED_BECAUSE(L"Mapper \"%s\", %u slots: mismatch in slot %u.", mapper.GetName().data(), slotCount, j);
+                }
+            }
+        }
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that transforming a batch of axis values produces exactly the same result as the scalar transformation for every possible raw axis value and every set of test axis properties.
+    TEST_CASE(BatchMapper_TransformAxisValue)
+    {
+        for (const auto& testAxisProperties : kTestAxisProperties)
+        {
+            const VirtualController::SProperties kProperties = MakeTestProperties(testAxisProperties);
+
+            BatchMapper::SAxisPropertiesBatch axisPropertiesBatch;
+            for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+            {
+                axisPropertiesBatch.deadzoneRawCutoffPositive[i] = kProperties.axis[0].deadzoneRawCutoffPositive;
+                axisPropertiesBatch.deadzoneRawCutoffNegative[i] = kProperties.axis[0].deadzoneRawCutoffNegative;
+                axisPropertiesBatch.saturationRawCutoffPositive[i] = kProperties.axis[0].saturationRawCutoffPositive;
+                axisPropertiesBatch.saturationRawCutoffNegative[i] = kProperties.axis[0].saturationRawCutoffNegative;
+                axisPropertiesBatch.rangeMin[i] = kProperties.axis[0].rangeMin;
+                axisPropertiesBatch.rangeMax[i] = kProperties.axis[0].rangeMax;
+                axisPropertiesBatch.rangeNeutral[i] = kProperties.axis[0].rangeNeutral;
+            }
+
+            for (int32_t firstAxisValue = kAnalogValueMin; firstAxisValue <= kAnalogValueMax; firstAxisValue += kBatchSlotCountMax)
+            {
+                int32_t axisValues[kBatchSlotCountMax];
+                for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+                    axisValues[i] = std::min(firstAxisValue + (int32_t)i, kAnalogValueMax);
+
+                BatchMapper::TransformAxisValueBatch(axisValues, axisPropertiesBatch, kBatchSlotCountMax);
+
+                for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+                {
+                    const int32_t kAxisValueRaw = std::min(firstAxisValue + (int32_t)i, kAnalogValueMax);
+                    const int32_t kExpectedAxisValue = VirtualController::TransformAxisValue(kAxisValueRaw, kProperties.axis[0]);
+
+                    if (kExpectedAxisValue != axisValues[i])
+                        TEST_FAILED_BECAUSE(L"Raw axis value %d: expected %d, got %d.", kAxisValueRaw, kExpectedAxisValue, axisValues[i]);
+                }
+            }
+        }
+    }
+
+    // Verifies that the vectorized path produces exactly the same results as the scalar reference path for every known mapper and every slot count.
+    TEST_CASE(BatchMapper_MatchesReference)
+    {
+        for (const auto& registryEntry : Mapper::kRegistry)
+            CheckBatchMatchesReference(*registryEntry.mapper);
+    }
+
+    // Verifies that element mappers without their own batch implementations produce the same results as they do when mapping one slot at a time.
+    // Every element mapper type and contribution source is wrapped so that only the single-slot methods are available.
+    TEST_CASE(BatchMapper_DefaultBatchContribution)
+    {
+        const AxisMapper kAxisMapperX(EAxis::X);
+        const AxisMapper kAxisMapperY(EAxis::Y);
+        const AxisMapper kAxisMapperZPositive(EAxis::Z, AxisMapper::EDirection::Positive);
+        const AxisMapper kAxisMapperZNegative(EAxis::Z, AxisMapper::EDirection::Negative);
+        const DigitalAxisMapper kDigitalAxisMapperRotX(EAxis::RotX);
+        const DigitalAxisMapper kDigitalAxisMapperRotY(EAxis::RotY, AxisMapper::EDirection::Negative);
+        const AxisMapper kAxisMapperRotZ(EAxis::RotZ, AxisMapper::EDirection::Positive);
+        const ButtonMapper kButtonMapper1(EButton::B1);
+        const ButtonMapper kButtonMapper2(EButton::B2);
+        const PovMapper kPovMapperUpDown(EPovDirection::Up, EPovDirection::Down);
+        const PovMapper kPovMapperLeft(EPovDirection::Left);
+        const PovMapper kPovMapperRight(EPovDirection::Right);
+
+        const Mapper kMapper({
+            .stickLeftX = std::make_unique<SingleSlotElementMapper>(kAxisMapperX),
+            .stickLeftY = std::make_unique<SingleSlotElementMapper>(kAxisMapperY),
+            .stickRightX = std::make_unique<SingleSlotElementMapper>(kDigitalAxisMapperRotX),
+            .stickRightY = std::make_unique<SingleSlotElementMapper>(kPovMapperUpDown),
+            .dpadUp = std::make_unique<SingleSlotElementMapper>(kAxisMapperRotZ),
+            .dpadDown = std::make_unique<SingleSlotElementMapper>(kDigitalAxisMapperRotY),
+            .dpadLeft = std::make_unique<SingleSlotElementMapper>(kPovMapperLeft),
+            .dpadRight = std::make_unique<SingleSlotElementMapper>(kPovMapperRight),
+            .triggerLT = std::make_unique<SingleSlotElementMapper>(kAxisMapperZPositive),
+            .triggerRT = std::make_unique<SingleSlotElementMapper>(kAxisMapperZNegative),
+            .buttonA = std::make_unique<SingleSlotElementMapper>(kButtonMapper1),
+            .buttonB = std::make_unique<SingleSlotElementMapper>(kButtonMapper1),
+            .buttonX = std::make_unique<SingleSlotElementMapper>(kButtonMapper2)
+        });
+
+        CheckBatchMatchesReference(kMapper);
+    }
+
+    // Measures the time needed to map batches of pseudo-random XInput controller states using both the scalar reference path and the vectorized path, for a range of slot counts.
+    // The only correctness requirement is that both paths produce identical results, but the printed report is the main output.
+    // Takes long enough that it only runs when benchmarks are enabled.
+    TEST_CASE_CONDITIONAL(BatchMapper_Benchmark, AreBenchmarksEnabled())
+    {
+        const Mapper* const kMapper = Mapper::GetByName(L"StandardGamepad");
+        TEST_ASSERT(nullptr != kMapper);
+
+        BatchMapper batchMapper(*kMapper);
+        for (unsigned int i = 0; i < kBatchSlotCountMax; ++i)
+            batchMapper.SetAxisProperties(i, MakeTestProperties(kTestAxisProperties[i % _countof(kTestAxisProperties)]));
+
+        uint64_t randomState = 0x2545f4914f6cdd1dull;
+        const Mapper::SXInputBatch kXInputStates[] = {RandomXInputBatch(randomState), RandomXInputBatch(randomState), RandomXInputBatch(randomState), RandomXInputBatch(randomState)};
+
+        PrintFormatted(L"  Mapper \"%s\", %u batches per measurement", kMapper->GetName().data(), kBenchmarkNumBatches);
+
+        for (const unsigned int kSlotCount : kBenchmarkSlotCounts)
+        {
+            SState referenceStates[kBatchSlotCountMax];
+            SState batchStates[kBatchSlotCountMax];
+
+            const auto kReferenceStartTime = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < kBenchmarkNumBatches; ++i)
+                batchMapper.MapXInputStatesReference(kXInputStates[i % _countof(kXInputStates)], std::span<SState>(referenceStates, kSlotCount));
+            const auto kReferenceEndTime = std::chrono::steady_clock::now();
+
+            const auto kBatchStartTime = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < kBenchmarkNumBatches; ++i)
+                batchMapper.MapXInputStates(kXInputStates[i % _countof(kXInputStates)], std::span<SState>(batchStates, kSlotCount));
+            const auto kBatchEndTime = std::chrono::steady_clock::now();
+
+            const double kReferenceNanosecondsPerSlot = std::chrono::duration<double, std::nano>(kReferenceEndTime - kReferenceStartTime).count() / (double)(kBenchmarkNumBatches * kSlotCount);
+            const double kBatchNanosecondsPerSlot = std::chrono::duration<double, std::nano>(kBatchEndTime - kBatchStartTime).count() / (double)(kBenchmarkNumBatches * kSlotCount);
+            PrintFormatted(L"    %2u slots: reference %8.1f ns/slot, batch %8.1f ns/slot, speedup %5.2fx", kSlotCount, kReferenceNanosecondsPerSlot, kBatchNanosecondsPerSlot, kReferenceNanosecondsPerSlot / kBatchNanosecondsPerSlot);
+
+            for (unsigned int i = 0; i < kSlotCount; ++i)
+                TEST_ASSERT(referenceStates[i] == batchStates[i]);
+        }
+    }
+}
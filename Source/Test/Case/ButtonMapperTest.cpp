@@ -10,7 +10,7 @@
  *   button.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "TestCase.h"
@@ -53,13 +53,11 @@ namespace XidiTest
         {
             const ButtonMapper mapper(kTargetButton);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].button[(int)kTargetButton] = kExpectedButtonSequence[currentSequenceIndex];
             possibleExpectedStates[1].button[(int)kTargetButton] = kExpectedButtonSequence[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -97,12 +95,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = false;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueNeutral);
 
@@ -124,12 +120,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMax);
 
@@ -154,12 +148,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMax);
         for (auto& mapper : mappersNegative)
@@ -178,12 +170,10 @@ namespace XidiTest
         {
             constexpr ButtonMapper mapper(kTargetButton);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.button[(int)kTargetButton] = buttonIsPressed;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -207,12 +197,10 @@ namespace XidiTest
                 ButtonMapper(kTargetButton)
             };
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.button[(int)kTargetButton] = buttonIsPressed;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             for (auto& mapper : mappers)
                 mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
@@ -237,12 +225,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromButtonValue(actualState, true);
         for (auto& mapper : mappersNotPressed)
@@ -267,13 +253,11 @@ namespace XidiTest
         {
             const ButtonMapper mapper(kTargetButton);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].button[(int)kTargetButton] = kExpectedButtonSequence[currentSequenceIndex];
             possibleExpectedStates[1].button[(int)kTargetButton] = kExpectedButtonSequence[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -311,12 +295,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = false;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMin);
 
@@ -337,12 +319,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMax);
 
@@ -366,12 +346,10 @@ namespace XidiTest
             ButtonMapper(kTargetButton)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.button[(int)kTargetButton] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMax);
         for (auto& mapper : mappersNotPressed)
@@ -0,0 +1,193 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ConfigurationTest.cpp
+ *   Unit tests for configuration file parsing and configuration data objects.
+ *****************************************************************************/
+
+#include "Configuration.h"
+#include "TestCase.h"
+
+#include <string_view>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Configuration;
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Configuration file reader used for testing.
+    /// Supports a fixed layout and accepts all values that parse correctly.
+    class TestConfigReader : public ConfigurationFileReader
+    {
+    private:
+        // -------- CONCRETE INSTANCE METHODS -------------------------- //
+        // See "Configuration.h" for documentation.
+
+        ESectionAction ActionForSection(std::wstring_view section) override
+        {
+            if (L"Skipped" == section)
+                return ESectionAction::Skip;
+            else if ((L"Section1" == section) || (L"Section2" == section))
+                return ESectionAction::Read;
+
+            return ESectionAction::Error;
+        }
+
+        bool CheckValue(std::wstring_view, std::wstring_view, const TIntegerValue&) override
+        {
+            return true;
+        }
+
+        bool CheckValue(std::wstring_view, std::wstring_view, const TBooleanValue&) override
+        {
+            return true;
+        }
+
+        bool CheckValue(std::wstring_view, std::wstring_view, const TStringValue&) override
+        {
+            return true;
+        }
+
+        EValueType TypeForValue(std::wstring_view, std::wstring_view name) override
+        {
+            if (L"Integer" == name)
+                return EValueType::Integer;
+            else if (L"Boolean" == name)
+                return EValueType::Boolean;
+            else if (L"String" == name)
+                return EValueType::String;
+            else if (L"MultiInteger" == name)
+                return EValueType::IntegerMultiValue;
+            else if (L"MultiString" == name)
+                return EValueType::StringMultiValue;
+
+            return EValueType::Error;
+        }
+    };
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Parses the specified configuration buffer using a test configuration reader.
+    /// @param [in] configBuffer Configuration contents to parse.
+    /// @param [out] configToFill Configuration data object to fill.
+    /// @return Result of the parse operation.
+    static EFileReadResult ParseTestConfiguration(std::wstring_view configBuffer, ConfigurationData& configToFill)
+    {
+        TestConfigReader reader;
+        return reader.ReadConfigurationBuffer(L"Test.ini", configBuffer, configToFill);
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a well-formed configuration is parsed correctly and that all values can be retrieved by section and name.
+    TEST_CASE(Configuration_Parse_Nominal)
+    {
+        constexpr std::wstring_view kConfigBuffer =
+            L"; Comment line\n"
+            L"[Section2]\n"
+            L"  String = Hello World  \r\n"
+            L"Integer=0x10\n"
+            L"\n"
+            L"[Section1]\n"
+            L"Boolean = yes\n"
+            L"MultiInteger = 3\n"
+            L"MultiInteger = -1\n"
+            L"MultiInteger = 2";
+
+        ConfigurationData configData;
+        TEST_ASSERT(EFileReadResult::Success == ParseTestConfiguration(kConfigBuffer, configData));
+
+        TEST_ASSERT(2 == configData.SectionCount());
+        TEST_ASSERT(L"Section1" == configData.Sections()[0].GetName());
+        TEST_ASSERT(L"Section2" == configData.Sections()[1].GetName());
+
+        TEST_ASSERT(true == configData.SectionNamePairExists(L"Section2", L"String"));
+        TEST_ASSERT(L"Hello World" == configData[L"Section2"][L"String"].FirstValue().GetStringValue());
+        TEST_ASSERT(16 == configData[L"Section2"][L"Integer"].FirstValue().GetIntegerValue());
+        TEST_ASSERT(true == configData[L"Section1"][L"Boolean"].FirstValue().GetBooleanValue());
+
+        const Name& kMultiInteger = configData[L"Section1"][L"MultiInteger"];
+        TEST_ASSERT(3 == kMultiInteger.ValueCount());
+        TEST_ASSERT(-1 == kMultiInteger.Values()[0].GetIntegerValue());
+        TEST_ASSERT(2 == kMultiInteger.Values()[1].GetIntegerValue());
+        TEST_ASSERT(3 == kMultiInteger.Values()[2].GetIntegerValue());
+
+        TEST_ASSERT(false == configData.SectionExists(L"Section3"));
+        TEST_ASSERT(false == configData.SectionNamePairExists(L"Section1", L"String"));
+        TEST_ASSERT(false == configData.SectionNamePairExists(L"Section3", L"String"));
+    }
+
+    // Verifies that settings in skipped sections are not read and that identical strings are stored only once.
+    TEST_CASE(Configuration_Parse_SkippedSectionAndInterning)
+    {
+        constexpr std::wstring_view kConfigBuffer =
+            L"[Skipped]\n"
+            L"Unknown = 1\n"
+            L"[Section1]\n"
+            L"MultiString = Value\n"
+            L"MultiString = Other\n"
+            L"[Section2]\n"
+            L"String = Value\n";
+
+        ConfigurationData configData;
+        TEST_ASSERT(EFileReadResult::Success == ParseTestConfiguration(kConfigBuffer, configData));
+
+        TEST_ASSERT(false == configData.SectionExists(L"Skipped"));
+        TEST_ASSERT(2 == configData[L"Section1"][L"MultiString"].ValueCount());
+
+        const std::wstring_view kValueInSection1 = configData[L"Section1"][L"MultiString"].Values()[1].GetStringValue();
+        const std::wstring_view kValueInSection2 = configData[L"Section2"][L"String"].FirstValue().GetStringValue();
+        TEST_ASSERT(L"Value" == kValueInSection1);
+        TEST_ASSERT(kValueInSection1.data() == kValueInSection2.data());
+
+        const auto kSectionsContainingString = configData.SectionsContaining(L"String");
+        TEST_ASSERT(1 == kSectionsContainingString->size());
+        TEST_ASSERT(L"Section2" == kSectionsContainingString->front().section);
+    }
+
+    // Verifies that parsing the same configuration data object again replaces its previous contents.
+    TEST_CASE(Configuration_Parse_ReplacesPreviousContents)
+    {
+        ConfigurationData configData;
+        TEST_ASSERT(EFileReadResult::Success == ParseTestConfiguration(L"[Section1]\nInteger = 1\n", configData));
+        TEST_ASSERT(EFileReadResult::Success == ParseTestConfiguration(L"[Section2]\nInteger = 2\n", configData));
+
+        TEST_ASSERT(1 == configData.SectionCount());
+        TEST_ASSERT(false == configData.SectionExists(L"Section1"));
+        TEST_ASSERT(2 == configData[L"Section2"][L"Integer"].FirstValue().GetIntegerValue());
+    }
+
+    // Verifies that malformed configurations are rejected.
+    TEST_CASE(Configuration_Parse_Malformed)
+    {
+        constexpr std::wstring_view kMalformedConfigBuffers[] = {
+            L"[Section1\n",
+            L"[Section1] extra\n",
+            L"[Section3]\n",
+            L"[Section1]\n[Section1]\n",
+            L"[Section1]\nInteger\n",
+            L"[Section1]\nInteger =\n",
+            L"[Section1]\nInteger = 1\nInteger = 2\n",
+            L"[Section1]\nInteger = abc\n",
+            L"[Section1]\nInteger = 123456789012345678901234567890123456789012345678901234567890123456789\n",
+            L"[Section1]\nBoolean = maybe\n",
+            L"[Section1]\nMultiInteger = 1\nMultiInteger = 1\n",
+            L"[Section1]\nUnknown = 1\n",
+        };
+
+        for (const auto& malformedConfigBuffer : kMalformedConfigBuffers)
+        {
+            ConfigurationData configData;
+            TEST_ASSERT(EFileReadResult::Malformed == ParseTestConfiguration(malformedConfigBuffer, configData));
+        }
+    }
+}
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControlEndpointTest.cpp
+ *   Unit tests for the endpoint through which external tools query and tune
+ *   running virtual controllers.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "ControlChannel.h"
+#include "ControlEndpoint.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockControlChannel.h"
+#include "MockXInput.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using ::Xidi::Controller::AxisMapper;
+    using ::Xidi::Controller::ControlEndpoint;
+    using ::Xidi::Controller::EAxis;
+    using ::Xidi::Controller::Mapper;
+    using ::Xidi::Controller::VirtualController;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Test mapper that contains a single axis, whose capabilities differ from those of every known mapper.
+    static const Mapper kTestSingleAxisMapper({
+        .stickLeftX = std::make_unique<AxisMapper>(EAxis::X)
+    });
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that registered controllers are listed once per identifier and that unregistered controllers are not listed.
+    TEST_CASE(ControlEndpoint_List)
+    {
+        VirtualController controller0(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+        VirtualController controller0Again(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+        VirtualController controller2(2, kTestSingleAxisMapper, std::make_unique<MockXInput>(2));
+
+        ControlEndpoint endpoint;
+        TEST_ASSERT("OK" == endpoint.HandleRequest("list"));
+
+        endpoint.AddController(&controller2);
+        endpoint.AddController(&controller0);
+        endpoint.AddController(&controller0Again);
+        TEST_ASSERT("OK 0 2" == endpoint.HandleRequest("list"));
+
+        endpoint.RemoveController(&controller2);
+        TEST_ASSERT("OK 0" == endpoint.HandleRequest("list"));
+        TEST_ASSERT("ERR no such controller 2" == endpoint.HandleRequest("state 2"));
+    }
+
+    // Verifies that malformed and unrecognized requests are rejected.
+    TEST_CASE(ControlEndpoint_MalformedRequests)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        TEST_ASSERT(0 == endpoint.HandleRequest("").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("state").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("state zero").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("reset 0").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 deadzone").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 deadzone=lots").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 axis=W deadzone=1000").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 axis=X").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 range=100").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 color=blue").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 mapper=NoSuchMapper").find("ERR "));
+    }
+
+    // Verifies that state queries report the most recent state of the controller.
+    TEST_CASE(ControlEndpoint_QueryState)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+        controller.RefreshState(ERROR_SUCCESS, {.dwPacketNumber = 1, .Gamepad = {.sThumbLX = Controller::kAnalogValueMax}}, 0);
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        const std::string kResponse = endpoint.HandleRequest("state 0");
+        TEST_ASSERT(0 == kResponse.find("OK X=" + std::to_string(Controller::kAnalogValueMax) + " Y=0 "));
+        TEST_ASSERT(std::string::npos != kResponse.find(" pov=none"));
+    }
+
+    // Verifies that a single request changes several properties at once, on a single axis or on all axes, and that the changes are reported by property queries.
+    TEST_CASE(ControlEndpoint_SetProperties)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        TEST_ASSERT("OK" == endpoint.HandleRequest("set 0 axis=RotX deadzone=1500 saturation=8000 range=-100,100"));
+        TEST_ASSERT(1500 == controller.GetAxisDeadzone(EAxis::RotX));
+        TEST_ASSERT(8000 == controller.GetAxisSaturation(EAxis::RotX));
+        TEST_ASSERT(std::make_pair(-100, 100) == controller.GetAxisRange(EAxis::RotX));
+        TEST_ASSERT(VirtualController::kAxisDeadzoneDefault == controller.GetAxisDeadzone(EAxis::X));
+
+        TEST_ASSERT("OK" == endpoint.HandleRequest("set all granularity=4 hysteresis=250 ffgain=5000 buffer=16"));
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+        {
+            TEST_ASSERT(4 == controller.GetAxisGranularity((EAxis)i));
+            TEST_ASSERT(250 == controller.GetAxisHysteresis((EAxis)i));
+        }
+        TEST_ASSERT(5000 == controller.GetForceFeedbackGain());
+        TEST_ASSERT(16 == controller.GetEventBufferCapacity());
+
+        const std::string kResponse = endpoint.HandleRequest("properties 0");
+        TEST_ASSERT(0 == kResponse.find("OK mapper="));
+        TEST_ASSERT(std::string::npos != kResponse.find(" RotX.deadzone=1500 RotX.saturation=8000 RotX.granularity=4 RotX.hysteresis=250 RotX.range=-100,100 "));
+        TEST_ASSERT(std::string::npos != kResponse.find(" ffgain=5000 buffer=16"));
+    }
+
+    // Verifies that a request with any invalid property value changes nothing at all.
+    TEST_CASE(ControlEndpoint_SetProperties_AllOrNothing)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 deadzone=1000 saturation=10001").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 axis=X deadzone=1000 range=5,5").find("ERR "));
+        TEST_ASSERT(0 == endpoint.HandleRequest("set 0 buffer=8 mapper=StandardGamepad").find("ERR "));
+        TEST_ASSERT(VirtualController::kAxisDeadzoneDefault == controller.GetAxisDeadzone(EAxis::X));
+        TEST_ASSERT(VirtualController::kAxisSaturationDefault == controller.GetAxisSaturation(EAxis::X));
+        TEST_ASSERT(std::make_pair(Controller::kAnalogValueMin, Controller::kAnalogValueMax) == controller.GetAxisRange(EAxis::X));
+        TEST_ASSERT(&kTestSingleAxisMapper == &controller.GetMapper());
+        TEST_ASSERT(0 == controller.GetEventBufferCapacity());
+    }
+
+    // Verifies that a mapper with the same capabilities as the current mapper can be swapped in.
+    TEST_CASE(ControlEndpoint_SetMapper)
+    {
+        const Mapper* const kStandardGamepadMapper = Mapper::GetByName(L"StandardGamepad");
+        TEST_ASSERT(nullptr != kStandardGamepadMapper);
+
+        const Mapper kEquivalentMapper(L"ControlEndpointTestEquivalent", {
+            .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+            .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+            .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
+            .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
+            .dpadUp = std::make_unique<Controller::PovMapper>(Controller::EPovDirection::Up),
+            .buttonA = std::make_unique<Controller::ButtonMapper>(Controller::EButton::B12)
+        });
+        TEST_ASSERT(kEquivalentMapper.GetCapabilities() == kStandardGamepadMapper->GetCapabilities());
+
+        VirtualController controller(0, kEquivalentMapper, std::make_unique<MockXInput>(0));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        TEST_ASSERT("OK" == endpoint.HandleRequest("set 0 mapper=StandardGamepad"));
+        TEST_ASSERT(kStandardGamepadMapper == &controller.GetMapper());
+        TEST_ASSERT(0 == endpoint.HandleRequest("properties 0").find("OK mapper=StandardGamepad "));
+    }
+
+    // Verifies that changes staged while another thread holds the controller lock are applied by the next refresh rather than waiting for the lock.
+    TEST_CASE(ControlEndpoint_SetProperties_DeferredWhileLocked)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        std::mutex phaseMutex;
+        std::condition_variable phaseCondition;
+        int phase = 0;
+
+        std::thread lockHolder([&controller, &phaseMutex, &phaseCondition, &phase]() -> void
+            {
+                auto controllerLock = controller.Lock();
+
+                std::unique_lock lock(phaseMutex);
+                phase = 1;
+                phaseCondition.notify_all();
+                phaseCondition.wait(lock, [&phase]() -> bool { return (2 == phase); });
+            }
+        );
+
+        {
+            std::unique_lock lock(phaseMutex);
+            phaseCondition.wait(lock, [&phase]() -> bool { return (1 == phase); });
+        }
+
+        TEST_ASSERT("OK" == endpoint.HandleRequest("set 0 deadzone=2500"));
+        TEST_ASSERT(VirtualController::kAxisDeadzoneDefault == controller.GetAxisDeadzone(EAxis::X));
+
+        {
+            std::scoped_lock lock(phaseMutex);
+            phase = 2;
+            phaseCondition.notify_all();
+        }
+
+        lockHolder.join();
+
+        controller.RefreshState(ERROR_SUCCESS, {.dwPacketNumber = 1}, 0);
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(2500 == controller.GetAxisDeadzone((EAxis)i));
+    }
+
+    // Verifies that requests received through a connection are answered through the same connection, and that stopping the endpoint disconnects the client.
+    TEST_CASE(ControlEndpoint_Loopback)
+    {
+        VirtualController controller(3, kTestSingleAxisMapper, std::make_unique<MockXInput>(3));
+
+        ControlEndpoint endpoint;
+        endpoint.AddController(&controller);
+
+        MockControlListener* const listener = new MockControlListener();
+        endpoint.Start(std::unique_ptr<IControlListener>(listener));
+        TEST_ASSERT(true == endpoint.IsRunning());
+
+        std::unique_ptr<IControlConnection> client = listener->Connect();
+        TEST_ASSERT(nullptr != client);
+
+        std::string response;
+        TEST_ASSERT(true == client->WriteLine("list"));
+        TEST_ASSERT(true == client->ReadLine(response));
+        TEST_ASSERT("OK 3" == response);
+
+        TEST_ASSERT(true == client->WriteLine("set 3 axis=Y deadzone=3000"));
+        TEST_ASSERT(true == client->ReadLine(response));
+        TEST_ASSERT("OK" == response);
+        TEST_ASSERT(3000 == controller.GetAxisDeadzone(EAxis::Y));
+
+        endpoint.Stop();
+        TEST_ASSERT(false == endpoint.IsRunning());
+        TEST_ASSERT(false == client->ReadLine(response));
+    }
+}
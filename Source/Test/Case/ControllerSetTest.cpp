@@ -0,0 +1,283 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSetTest.cpp
+ *   Unit tests for sets of virtual controllers that are refreshed together.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "ControllerSet.h"
+#include "ControllerSourceRegistry.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockClock.h"
+#include "MockXInput.h"
+#include "MockXInputSource.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+
+#include <cstdint>
+#include <memory>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using ::Xidi::Controller::ButtonMapper;
+    using ::Xidi::Controller::ControllerSet;
+    using ::Xidi::Controller::ControllerSourceRegistry;
+    using ::Xidi::Controller::EButton;
+    using ::Xidi::Controller::Mapper;
+    using ::Xidi::Controller::VirtualController;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Test mapper that maps XInput buttons A and B to virtual buttons 1 and 2 respectively.
+    static const Mapper kTestMapper({
+        .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+        .buttonB = std::make_unique<ButtonMapper>(EButton::B2)
+    });
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Creates a controller set that contains one virtual controller per XInput user index.
+    /// Each virtual controller is given a mock XInput interface with no expected calls, so any attempt by a virtual controller to read XInput on its own causes a test failure.
+    /// @param [out] xinput Filled with a pointer to the XInput interface used by the controller set.
+    /// @return Newly-created controller set.
+    static std::unique_ptr<ControllerSet> CreateTestControllerSet(MockXInputSource*& xinput)
+    {
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        xinput = xinputSource.get();
+
+        std::unique_ptr<ControllerSet> controllerSet = std::make_unique<ControllerSet>(std::move(xinputSource));
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            TEST_ASSERT(nullptr != controllerSet->AddController(std::make_unique<VirtualController>(i, kTestMapper, std::make_unique<MockXInput>(i))));
+
+        return controllerSet;
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a single refresh reads every XInput slot exactly once and publishes all of the resulting states in one snapshot.
+    TEST_CASE(ControllerSet_Refresh_ReadsAllSlotsOnce)
+    {
+        MockXInputSource* xinput = nullptr;
+        std::unique_ptr<ControllerSet> controllerSet = CreateTestControllerSet(xinput);
+
+        xinput->SetState(1, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        xinput->SetState(3, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_B}});
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->Refresh(snapshot);
+        TEST_ASSERT(1 == snapshot.generation);
+
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            TEST_ASSERT(1 == xinput->GetReadCount(i));
+
+        TEST_ASSERT(snapshot.state[0] == Controller::SState({}));
+        TEST_ASSERT(snapshot.state[1] == Controller::SState({.button = 0b01}));
+        TEST_ASSERT(snapshot.state[2] == Controller::SState({}));
+        TEST_ASSERT(snapshot.state[3] == Controller::SState({.button = 0b10}));
+    }
+
+    // Verifies that reading each controller once observes a single snapshot and that reading any of them again triggers exactly one new refresh of the whole set.
+    TEST_CASE(ControllerSet_GetState_OneRefreshPerFrame)
+    {
+        MockXInputSource* xinput = nullptr;
+        std::unique_ptr<ControllerSet> controllerSet = CreateTestControllerSet(xinput);
+
+        xinput->SetState(0, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            controllerSet->GetState(i);
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->GetSnapshot(snapshot);
+        TEST_ASSERT(1 == snapshot.generation);
+        TEST_ASSERT(1 == xinput->GetReadCount(0));
+
+        // A change that happens in the middle of a frame must not be visible to controllers whose states are read later in the same frame.
+        xinput->SetState(0, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_B}});
+        TEST_ASSERT(controllerSet->GetState(0) == Controller::SState({.button = 0b10}));
+        xinput->SetState(1, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        TEST_ASSERT(controllerSet->GetState(1) == Controller::SState({}));
+
+        controllerSet->GetSnapshot(snapshot);
+        TEST_ASSERT(2 == snapshot.generation);
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            TEST_ASSERT(2 == xinput->GetReadCount(i));
+    }
+
+    // Verifies that out-of-range controller identifiers are rejected without affecting the set.
+    TEST_CASE(ControllerSet_InvalidIdentifier)
+    {
+        MockXInputSource* xinput = nullptr;
+        std::unique_ptr<ControllerSet> controllerSet = CreateTestControllerSet(xinput);
+
+        TEST_ASSERT(nullptr == controllerSet->GetController(controllerSet->GetControllerCount()));
+        TEST_ASSERT(controllerSet->GetState(controllerSet->GetControllerCount()) == Controller::SState({}));
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->GetSnapshot(snapshot);
+        TEST_ASSERT(0 == snapshot.generation);
+        TEST_ASSERT(0 == xinput->GetReadCount(0));
+    }
+
+    // Verifies that a missing controller is rejected, and that an occupied slot cannot be filled again so that the controller already in it remains valid.
+    TEST_CASE(ControllerSet_AddController_Rejected)
+    {
+        MockXInputSource* xinput = nullptr;
+        std::unique_ptr<ControllerSet> controllerSet = CreateTestControllerSet(xinput);
+        VirtualController* const kOriginalController = controllerSet->GetController(0);
+
+        TEST_ASSERT(nullptr == controllerSet->AddController(nullptr));
+        TEST_ASSERT(nullptr == controllerSet->AddController(std::make_unique<VirtualController>(0, kTestMapper, std::make_unique<MockXInput>(0))));
+        TEST_ASSERT(kOriginalController == controllerSet->GetController(0));
+        TEST_ASSERT(0 == kOriginalController->GetIdentifier());
+    }
+
+    // Verifies that a refresh stamps the events of every virtual controller in the set with the same capture time, read once from the set's clock.
+    // Sequence numbers should still be distinct and follow the order in which the controllers are refreshed.
+    TEST_CASE(ControllerSet_Refresh_SharedCaptureTimestamp)
+    {
+        constexpr uint64_t kCaptureTimestamp = 987654321ull;
+
+        MockClock mockClock(kCaptureTimestamp);
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+
+        // Each virtual controller gets a clock that is far off from the one the set uses, so any timestamp that comes from the wrong clock is detected.
+        MockClock unusedClock(0);
+        std::unique_ptr<ControllerSet> controllerSet = std::make_unique<ControllerSet>(std::move(xinputSource), XUSER_MAX_COUNT, mockClock);
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+        {
+            VirtualController* const controller = controllerSet->AddController(std::make_unique<VirtualController>(i, kTestMapper, std::make_unique<MockXInput>(i), unusedClock));
+            TEST_ASSERT(nullptr != controller);
+            controller->SetEventBufferCapacity(16);
+        }
+
+        xinput->SetAllStates({.Gamepad = {.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B}});
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->Refresh(snapshot);
+
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+        {
+            VirtualController* const controller = controllerSet->GetController(i);
+            TEST_ASSERT(2 == controller->GetEventBufferCount());
+            TEST_ASSERT(kCaptureTimestamp == controller->GetEventBufferEvent(0).timestamp);
+            TEST_ASSERT(kCaptureTimestamp == controller->GetEventBufferEvent(1).timestamp);
+            TEST_ASSERT((controller->GetEventBufferEvent(0).sequence + 1) == controller->GetEventBufferEvent(1).sequence);
+
+            if (i > 0)
+                TEST_ASSERT(controller->GetEventBufferEvent(0).sequence > controllerSet->GetController(i - 1)->GetEventBufferEvent(1).sequence);
+        }
+    }
+
+    // Verifies that a disconnected slot is not read during every refresh but is read again once enough time has passed, so that a newly-connected controller is still picked up.
+    // Connected slots must continue to be read during every refresh.
+    TEST_CASE(ControllerSet_Refresh_DisconnectedSlotBackoff)
+    {
+        MockClock mockClock;
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+        xinput->SetResult(2, ERROR_DEVICE_NOT_CONNECTED);
+
+        std::unique_ptr<ControllerSet> controllerSet = std::make_unique<ControllerSet>(std::move(xinputSource), XUSER_MAX_COUNT, mockClock);
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            TEST_ASSERT(nullptr != controllerSet->AddController(std::make_unique<VirtualController>(i, kTestMapper, std::make_unique<MockXInput>(i), mockClock)));
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->Refresh(snapshot);
+        mockClock.Advance(ControllerSet::kDisconnectedSlotPollInterval - 1);
+        controllerSet->Refresh(snapshot);
+
+        TEST_ASSERT(2 == xinput->GetReadCount(0));
+        TEST_ASSERT(1 == xinput->GetReadCount(2));
+
+        xinput->SetResult(2, ERROR_SUCCESS);
+        xinput->SetState(2, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        controllerSet->Refresh(snapshot);
+        TEST_ASSERT(1 == xinput->GetReadCount(2));
+        TEST_ASSERT(snapshot.state[2] == Controller::SState({}));
+
+        mockClock.Advance(1);
+        controllerSet->Refresh(snapshot);
+        TEST_ASSERT(2 == xinput->GetReadCount(2));
+        TEST_ASSERT(snapshot.state[2] == Controller::SState({.button = 0b01}));
+
+        controllerSet->Refresh(snapshot);
+        TEST_ASSERT(3 == xinput->GetReadCount(2));
+        TEST_ASSERT(5 == xinput->GetReadCount(0));
+    }
+
+    // Verifies that a set much larger than the number of XInput user indices, fed by several sources through a registry, reads every slot once per refresh and keeps slots separate.
+    TEST_CASE(ControllerSet_Refresh_ManySlotsFromRegistry)
+    {
+        constexpr unsigned int kSourceCount = 6;
+        constexpr VirtualController::TControllerIdentifier kControllerCount = kSourceCount * XUSER_MAX_COUNT;
+
+        std::unique_ptr<ControllerSourceRegistry> registry = std::make_unique<ControllerSourceRegistry>();
+        MockXInputSource* sources[kSourceCount] = {};
+
+        for (unsigned int i = 0; i < kSourceCount; ++i)
+        {
+            std::unique_ptr<MockXInputSource> source = std::make_unique<MockXInputSource>();
+            sources[i] = source.get();
+            TEST_ASSERT(registry->RegisterSource(std::move(source), XUSER_MAX_COUNT).has_value());
+        }
+
+        TEST_ASSERT(kControllerCount == registry->GetSlotCount());
+
+        std::unique_ptr<ControllerSet> controllerSet = std::make_unique<ControllerSet>(std::move(registry), kControllerCount);
+        TEST_ASSERT(kControllerCount == controllerSet->GetControllerCount());
+
+        for (VirtualController::TControllerIdentifier i = 0; i < controllerSet->GetControllerCount(); ++i)
+            TEST_ASSERT(nullptr != controllerSet->AddController(std::make_unique<VirtualController>(i, kTestMapper, std::make_unique<MockXInput>(i % XUSER_MAX_COUNT))));
+
+        sources[0]->SetState(0, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        sources[3]->SetState(2, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_B}});
+        sources[5]->SetState(3, {.Gamepad = {.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B}});
+
+        ControllerSet::SSnapshot snapshot;
+        controllerSet->Refresh(snapshot);
+        TEST_ASSERT(kControllerCount == snapshot.state.size());
+
+        for (unsigned int i = 0; i < kSourceCount; ++i)
+        {
+            for (DWORD j = 0; j < XUSER_MAX_COUNT; ++j)
+                TEST_ASSERT(1 == sources[i]->GetReadCount(j));
+        }
+
+        for (VirtualController::TControllerIdentifier i = 0; i < kControllerCount; ++i)
+        {
+            switch (i)
+            {
+            case 0:
+                TEST_ASSERT(snapshot.state[i] == Controller::SState({.button = 0b01}));
+                break;
+
+            case ((3 * XUSER_MAX_COUNT) + 2):
+                TEST_ASSERT(snapshot.state[i] == Controller::SState({.button = 0b10}));
+                break;
+
+            case (kControllerCount - 1):
+                TEST_ASSERT(snapshot.state[i] == Controller::SState({.button = 0b11}));
+                break;
+
+            default:
+                TEST_ASSERT(snapshot.state[i] == Controller::SState({}));
+                break;
+            }
+        }
+
+        TEST_ASSERT(nullptr == controllerSet->GetController(kControllerCount));
+    }
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ControllerSourceRegistryTest.cpp
+ *   Unit tests for the registry that assigns virtual controller slots to
+ *   controller sources.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "ControllerSourceRegistry.h"
+#include "MockXInputSource.h"
+#include "TestCase.h"
+
+#include <memory>
+#include <optional>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using ::Xidi::Controller::ControllerSourceRegistry;
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that sources receive contiguous ranges of slots in registration order and that reads are routed to the correct source and user index.
+    TEST_CASE(ControllerSourceRegistry_RegisterSource_ContiguousSlots)
+    {
+        ControllerSourceRegistry registry;
+        TEST_ASSERT(0 == registry.GetSlotCount());
+
+        TEST_ASSERT(std::optional<DWORD>(0) == registry.RegisterSource(std::make_unique<MockXInputSource>(4, 1), 4));
+        TEST_ASSERT(std::optional<DWORD>(4) == registry.RegisterSource(std::make_unique<MockXInputSource>(1, 2), 1));
+        TEST_ASSERT(std::optional<DWORD>(5) == registry.RegisterSource(std::make_unique<MockXInputSource>(16, 3), 16));
+        TEST_ASSERT(21 == registry.GetSlotCount());
+
+        constexpr DWORD kExpectedPacketNumbers[] = {
+            1000, 1001, 1002, 1003,
+            2000,
+            3000, 3001, 3002, 3003, 3004, 3005, 3006, 3007, 3008, 3009, 3010, 3011, 3012, 3013, 3014, 3015
+        };
+
+        for (DWORD i = 0; i < _countof(kExpectedPacketNumbers); ++i)
+        {
+            XINPUT_STATE state;
+            TEST_ASSERT(ERROR_SUCCESS == registry.GetState(i, &state));
+            TEST_ASSERT(kExpectedPacketNumbers[i] == state.dwPacketNumber);
+        }
+    }
+
+    // Verifies that registration fails without side effects when a source would not fit or supplies no slots, and that the registry can be filled exactly to capacity.
+    TEST_CASE(ControllerSourceRegistry_RegisterSource_Capacity)
+    {
+        ControllerSourceRegistry registry;
+
+        TEST_ASSERT(false == registry.RegisterSource(nullptr, 4).has_value());
+        TEST_ASSERT(false == registry.RegisterSource(std::make_unique<MockXInputSource>(4, 1), 0).has_value());
+        TEST_ASSERT(false == registry.RegisterSource(std::make_unique<MockXInputSource>(4, 1), ControllerSourceRegistry::kMaxSlotCount + 1).has_value());
+        TEST_ASSERT(0 == registry.GetSlotCount());
+
+        TEST_ASSERT(std::optional<DWORD>(0) == registry.RegisterSource(std::make_unique<MockXInputSource>(ControllerSourceRegistry::kMaxSlotCount - 1, 1), ControllerSourceRegistry::kMaxSlotCount - 1));
+        TEST_ASSERT(false == registry.RegisterSource(std::make_unique<MockXInputSource>(2, 2), 2).has_value());
+        TEST_ASSERT(std::optional<DWORD>(ControllerSourceRegistry::kMaxSlotCount - 1) == registry.RegisterSource(std::make_unique<MockXInputSource>(1, 3), 1));
+        TEST_ASSERT(ControllerSourceRegistry::kMaxSlotCount == registry.GetSlotCount());
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_SUCCESS == registry.GetState(ControllerSourceRegistry::kMaxSlotCount - 1, &state));
+        TEST_ASSERT(3000 == state.dwPacketNumber);
+    }
+
+    // Verifies that reading a slot that has not been assigned reports that no controller is connected.
+    TEST_CASE(ControllerSourceRegistry_GetState_UnassignedSlot)
+    {
+        ControllerSourceRegistry registry;
+        XINPUT_STATE state;
+
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == registry.GetState(0, &state));
+
+        registry.RegisterSource(std::make_unique<MockXInputSource>(2, 1), 2);
+        TEST_ASSERT(ERROR_SUCCESS == registry.GetState(1, &state));
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == registry.GetState(2, &state));
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == registry.GetState(ControllerSourceRegistry::kMaxSlotCount, &state));
+    }
+}
@@ -10,7 +10,7 @@
  *   applications using their own specified data formats.
  *****************************************************************************/
 
-#include "ApiDirectInput.h"
+#include "ApiDirectInputTypes.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
 #include "ElementMapper.h"
@@ -109,7 +109,7 @@ namespace XidiTest
         // Iterate through the entire expected specification object and verify that all elements are correctly mapped to and from offsets.
         // This exercises all of the element-mapping methods of the data format object in both directions: element to offset and offset to element.
         // First axes, then buttons, and finally the POV.
-        for (int i = 0; i < _countof(expectedDataFormatSpec.axisOffset); ++i)
+        for (unsigned int i = 0; i < _countof(expectedDataFormatSpec.axisOffset); ++i)
         {
             const SElementIdentifier expectedAxisIdentifier = {.type = EElementType::Axis, .axis = (EAxis)i};
             const TOffset expectedAxisOffset = expectedDataFormatSpec.axisOffset[i];
@@ -135,7 +135,7 @@ namespace XidiTest
             }
         }
 
-        for (int i = 0; i < _countof(expectedDataFormatSpec.buttonOffset); ++i)
+        for (unsigned int i = 0; i < _countof(expectedDataFormatSpec.buttonOffset); ++i)
         {
             const SElementIdentifier expectedButtonIdentifier = {.type = EElementType::Button, .button = (EButton)i};
             const TOffset expectedButtonOffset = expectedDataFormatSpec.buttonOffset[i];
@@ -162,7 +162,7 @@ namespace XidiTest
 
         do
         {
-            const SElementIdentifier expectedPovIdentifier = {.type = EElementType::Pov};
+            const SElementIdentifier expectedPovIdentifier = {.type = EElementType::Pov, .axis = (EAxis)0};
             const TOffset expectedPovOffset = expectedDataFormatSpec.povOffset;
 
             if (DataFormat::kInvalidOffsetValue == expectedPovOffset)
@@ -295,7 +295,7 @@ namespace XidiTest
         };
         
         // Single element tests, one object format specification at a time.
-        for (int i = 0; i < _countof(testObjectFormatSpec); ++i)
+        for (unsigned int i = 0; i < _countof(testObjectFormatSpec); ++i)
         {
             // Data format specification consists of exactly one controller element.
             const DIDATAFORMAT kTestFormatSpec = {
@@ -838,7 +838,7 @@ namespace XidiTest
 
         // POV should be selected for a virtual controller that has a POV.
         DataFormat::SDataFormatSpec expectedDataFormatSpecWithPov(sizeof(STestDataPacket));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(STestDataPacket, povValue));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(STestDataPacket, povValue));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -877,7 +877,7 @@ namespace XidiTest
 
         // POV should be selected for a virtual controller that has a POV.
         DataFormat::SDataFormatSpec expectedDataFormatSpecWithPov(sizeof(STestDataPacket));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(STestDataPacket, povValue));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(STestDataPacket, povValue));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -916,7 +916,7 @@ namespace XidiTest
 
         // POV should be selected for a virtual controller that has a POV.
         DataFormat::SDataFormatSpec expectedDataFormatSpecWithPov(sizeof(STestDataPacket));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(STestDataPacket, povValue));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(STestDataPacket, povValue));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -955,7 +955,7 @@ namespace XidiTest
 
         // POV should be selected for a virtual controller that has a POV.
         DataFormat::SDataFormatSpec expectedDataFormatSpecWithPov(sizeof(STestDataPacket));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(STestDataPacket, povValue));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(STestDataPacket, povValue));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -994,7 +994,7 @@ namespace XidiTest
 
         // POV should be selected for a virtual controller that has a POV.
         DataFormat::SDataFormatSpec expectedDataFormatSpecWithPov(sizeof(STestDataPacket));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(STestDataPacket, povValue));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(STestDataPacket, povValue));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -1111,11 +1111,11 @@ namespace XidiTest
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Y}, offsetof(DIJOYSTATE, lY));
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Z}, offsetof(DIJOYSTATE, lZ));
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::RotZ}, offsetof(DIJOYSTATE, lRz));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(DIJOYSTATE, rgdwPOV[0]));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(DIJOYSTATE, rgdwPOV[0]));
         for (int i = 0; i < kTestMapperWithPov.GetCapabilities().numButtons; ++i)
-            expectedDataFormatSpecWithPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, offsetof(DIJOYSTATE, rgbButtons[i]));
-        for (int i = 1; i < _countof(DIJOYSTATE::rgdwPOV); ++i)
-            expectedDataFormatSpecWithPov.SubmitUnusedPovOffset(offsetof(DIJOYSTATE, rgdwPOV[i]));
+            expectedDataFormatSpecWithPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, (offsetof(DIJOYSTATE, rgbButtons) + (i * sizeof(BYTE))));
+        for (unsigned int i = 1; i < _countof(DIJOYSTATE::rgdwPOV); ++i)
+            expectedDataFormatSpecWithPov.SubmitUnusedPovOffset((offsetof(DIJOYSTATE, rgdwPOV) + (i * sizeof(DWORD))));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -1126,9 +1126,9 @@ namespace XidiTest
         expectedDataFormatSpecWithoutPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Z}, offsetof(DIJOYSTATE, lZ));
         expectedDataFormatSpecWithoutPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::RotZ}, offsetof(DIJOYSTATE, lRz));
         for (int i = 0; i < kTestMapperWithoutPov.GetCapabilities().numButtons; ++i)
-            expectedDataFormatSpecWithoutPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, offsetof(DIJOYSTATE, rgbButtons[i]));
-        for (int i = 0; i < _countof(DIJOYSTATE::rgdwPOV); ++i)
-            expectedDataFormatSpecWithoutPov.SubmitUnusedPovOffset(offsetof(DIJOYSTATE, rgdwPOV[i]));
+            expectedDataFormatSpecWithoutPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, (offsetof(DIJOYSTATE, rgbButtons) + (i * sizeof(BYTE))));
+        for (unsigned int i = 0; i < _countof(DIJOYSTATE::rgdwPOV); ++i)
+            expectedDataFormatSpecWithoutPov.SubmitUnusedPovOffset((offsetof(DIJOYSTATE, rgdwPOV) + (i * sizeof(DWORD))));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithoutPov.GetCapabilities(), expectedDataFormatSpecWithoutPov);
     }
@@ -1319,11 +1319,11 @@ namespace XidiTest
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Y}, offsetof(DIJOYSTATE2, lY));
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Z}, offsetof(DIJOYSTATE2, lZ));
         expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::RotZ}, offsetof(DIJOYSTATE2, lRz));
-        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov}, offsetof(DIJOYSTATE2, rgdwPOV[0]));
+        expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Pov, .axis = (EAxis)0}, offsetof(DIJOYSTATE2, rgdwPOV[0]));
         for (int i = 0; i < kTestMapperWithPov.GetCapabilities().numButtons; ++i)
-            expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Button, .button = (EButton)i}, offsetof(DIJOYSTATE2, rgbButtons[i]));
-        for (int i = 1; i < _countof(DIJOYSTATE2::rgdwPOV); ++i)
-            expectedDataFormatSpecWithPov.SubmitUnusedPovOffset(offsetof(DIJOYSTATE2, rgdwPOV[i]));
+            expectedDataFormatSpecWithPov.SetOffsetForElement({.type = EElementType::Button, .button = (EButton)i}, (offsetof(DIJOYSTATE2, rgbButtons) + (i * sizeof(BYTE))));
+        for (unsigned int i = 1; i < _countof(DIJOYSTATE2::rgdwPOV); ++i)
+            expectedDataFormatSpecWithPov.SubmitUnusedPovOffset((offsetof(DIJOYSTATE2, rgdwPOV) + (i * sizeof(DWORD))));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithPov.GetCapabilities(), expectedDataFormatSpecWithPov);
 
@@ -1334,9 +1334,9 @@ namespace XidiTest
         expectedDataFormatSpecWithoutPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::Z}, offsetof(DIJOYSTATE2, lZ));
         expectedDataFormatSpecWithoutPov.SetOffsetForElement({.type = EElementType::Axis, .axis = EAxis::RotZ}, offsetof(DIJOYSTATE2, lRz));
         for (int i = 0; i < kTestMapperWithoutPov.GetCapabilities().numButtons; ++i)
-            expectedDataFormatSpecWithoutPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, offsetof(DIJOYSTATE2, rgbButtons[i]));
-        for (int i = 0; i < _countof(DIJOYSTATE2::rgdwPOV); ++i)
-            expectedDataFormatSpecWithoutPov.SubmitUnusedPovOffset(offsetof(DIJOYSTATE2, rgdwPOV[i]));
+            expectedDataFormatSpecWithoutPov.SetOffsetForElement({ .type = EElementType::Button, .button = (EButton)i }, (offsetof(DIJOYSTATE2, rgbButtons) + (i * sizeof(BYTE))));
+        for (unsigned int i = 0; i < _countof(DIJOYSTATE2::rgdwPOV); ++i)
+            expectedDataFormatSpecWithoutPov.SubmitUnusedPovOffset((offsetof(DIJOYSTATE2, rgdwPOV) + (i * sizeof(DWORD))));
 
         TestDataFormatCreateSuccess(kTestFormatSpec, kTestMapperWithoutPov.GetCapabilities(), expectedDataFormatSpecWithoutPov);
     }
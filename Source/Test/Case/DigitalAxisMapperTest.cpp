@@ -10,7 +10,7 @@
  *   axis but without any analog functionality (i.e. extreme values only).
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "TestCase.h"
@@ -54,13 +54,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
             
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -94,12 +92,10 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -114,13 +110,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -154,12 +148,10 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             TEST_ASSERT(actualState == expectedState);
@@ -174,13 +166,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -219,12 +209,10 @@ namespace XidiTest
             DigitalAxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueMin * (int32_t)_countof(mappers);
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMin);
 
@@ -248,12 +236,10 @@ namespace XidiTest
             DigitalAxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMax);
         for (auto& mapper : mappersNegative)
@@ -272,12 +258,10 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueMin);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -294,12 +278,10 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueNeutral);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -316,12 +298,10 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMin : kAnalogValueNeutral);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -346,12 +326,10 @@ namespace XidiTest
                 DigitalAxisMapper(kTargetAxis)
             };
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.axis[(int)kTargetAxis] = (true == buttonIsPressed ? kAnalogValueMax : kAnalogValueMin) * _countof(mappers);
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             for (auto& mapper : mappers)
                 mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
@@ -377,12 +355,10 @@ namespace XidiTest
             DigitalAxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromButtonValue(actualState, true);
         for (auto& mapper : mappersNotPressed)
@@ -406,13 +382,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -448,13 +422,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Positive);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -490,13 +462,11 @@ namespace XidiTest
         {
             constexpr DigitalAxisMapper mapper(kTargetAxis, AxisMapper::EDirection::Negative);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex];
             possibleExpectedStates[1].axis[(int)kTargetAxis] = kAllowedValues[currentAllowedIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -534,12 +504,10 @@ namespace XidiTest
             DigitalAxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueMax * _countof(mappers);
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)kTriggerValueMax);
 
@@ -564,12 +532,10 @@ namespace XidiTest
             DigitalAxisMapper(kTargetAxis)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)kTargetAxis] = kAnalogValueNeutral;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)kTriggerValueMax);
         for (auto& mapper : mappersNegative)
@@ -0,0 +1,442 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file EvdevTest.cpp
+ *   Unit tests for translating evdev input event streams into XInput
+ *   controller states, and for the evdev-backed XInput interface.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "Evdev.h"
+#include "EvdevXInput.h"
+#include "TestCase.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using namespace ::Xidi::Evdev;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Appends a single captured event record, laid out as a 64-bit little-endian `struct input_event`, to a byte buffer.
+    /// The timestamp is filled with a recognizable non-zero pattern to verify that it is ignored.
+    /// @param [in,out] capturedBytes Buffer to which to append the record.
+    /// @param [in] event Event to record.
+    static void AppendCapturedEvent(std::vector<uint8_t>& capturedBytes, const SEvent& event)
+    {
+        for (int i = 0; i < 16; ++i)
+            capturedBytes.push_back(0xa5);
+
+        capturedBytes.push_back((uint8_t)(event.type));
+        capturedBytes.push_back((uint8_t)(event.type >> 8));
+        capturedBytes.push_back((uint8_t)(event.code));
+        capturedBytes.push_back((uint8_t)(event.code >> 8));
+        capturedBytes.push_back((uint8_t)(event.value));
+        capturedBytes.push_back((uint8_t)(event.value >> 8));
+        capturedBytes.push_back((uint8_t)(event.value >> 16));
+        capturedBytes.push_back((uint8_t)(event.value >> 24));
+    }
+
+    /// Applies a sequence of events to a state tracker.
+    /// @param [in,out] tracker State tracker to which to apply events.
+    /// @param [in] events Events to apply.
+    static void ApplyEvents(StateTracker& tracker, const std::vector<SEvent>& events)
+    {
+        for (const auto& event : events)
+            tracker.ApplyEvent(event);
+    }
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Event that marks the end of a report.
+    static constexpr SEvent kSynReportEvent = {.type = kEventTypeSyn, .code = kSynReport, .value = 0};
+
+    /// Event that indicates the device dropped events.
+    static constexpr SEvent kSynDroppedEvent = {.type = kEventTypeSyn, .code = kSynDropped, .value = 0};
+
+
+#ifdef __linux__
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Event source backed by the read end of a pipe, which behaves like a device node for the purpose of waiting and non-blocking reads.
+    /// Events are written to the pipe as raw #SEvent objects. Closing the write end simulates unplugging the device.
+    class PipeEventSource : public IEventSource
+    {
+    private:
+        /// Read end of the pipe.
+        const int kReadDescriptor;
+
+    public:
+        PipeEventSource(int readDescriptor) : kReadDescriptor(readDescriptor)
+        {
+            fcntl(kReadDescriptor, F_SETFL, O_NONBLOCK);
+        }
+
+        ~PipeEventSource(void) override
+        {
+            close(kReadDescriptor);
+        }
+
+        const TAxisRanges& GetAxisRanges(void) const override
+        {
+            return DefaultAxisRanges();
+        }
+
+        int GetWaitDescriptor(void) const override
+        {
+            return kReadDescriptor;
+        }
+
+        void ReadCurrentState(std::vector<SEvent>&) override
+        {
+            // Nothing to do here.
+        }
+
+        bool ReadEvents(std::vector<SEvent>& events) override
+        {
+            SEvent event;
+
+            while (true)
+            {
+                const ssize_t kReadByteCount = read(kReadDescriptor, &event, sizeof(event));
+
+                if (kReadByteCount < 0)
+                    return (EAGAIN == errno);
+
+                if (0 == kReadByteCount)
+                    return false;
+
+                events.push_back(event);
+            }
+        }
+    };
+#endif
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that captured event records are parsed correctly and that their timestamps are ignored.
+    TEST_CASE(Evdev_ParseCapturedEvents_Nominal)
+    {
+        const std::vector<SEvent> kExpectedEvents = {
+            {.type = kEventTypeKey, .code = kBtnStart, .value = 1},
+            {.type = kEventTypeAbs, .code = kAbsY, .value = -32768},
+            {.type = kEventTypeAbs, .code = kAbsRx, .value = 0x12345678},
+            kSynReportEvent
+        };
+
+        std::vector<uint8_t> capturedBytes;
+        for (const auto& event : kExpectedEvents)
+            AppendCapturedEvent(capturedBytes, event);
+
+        std::vector<SEvent> actualEvents;
+        TEST_ASSERT(true == ParseCapturedEvents(capturedBytes.data(), capturedBytes.size(), actualEvents));
+        TEST_ASSERT(actualEvents.size() == kExpectedEvents.size());
+
+        for (size_t i = 0; i < kExpectedEvents.size(); ++i)
+        {
+            TEST_ASSERT(actualEvents[i].type == kExpectedEvents[i].type);
+            TEST_ASSERT(actualEvents[i].code == kExpectedEvents[i].code);
+            TEST_ASSERT(actualEvents[i].value == kExpectedEvents[i].value);
+        }
+    }
+
+    // Verifies that a captured event stream that does not consist of a whole number of records is rejected.
+    TEST_CASE(Evdev_ParseCapturedEvents_Truncated)
+    {
+        std::vector<uint8_t> capturedBytes;
+        AppendCapturedEvent(capturedBytes, kSynReportEvent);
+        capturedBytes.pop_back();
+
+        std::vector<SEvent> events;
+        TEST_ASSERT(false == ParseCapturedEvents(capturedBytes.data(), capturedBytes.size(), events));
+    }
+
+    // Verifies that buttons, including those reported by auto-repeat, are translated to the correct XInput buttons and only become visible at the end of a report.
+    TEST_CASE(Evdev_StateTracker_Buttons)
+    {
+        StateTracker tracker(DefaultAxisRanges());
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnA, .value = 1},
+            {.type = kEventTypeKey, .code = kBtnY, .value = 1},
+            {.type = kEventTypeKey, .code = kBtnTR, .value = 2},
+            {.type = kEventTypeKey, .code = kBtnDpadLeft, .value = 1}
+        });
+        TEST_ASSERT(0 == tracker.GetState().Gamepad.wButtons);
+
+        tracker.ApplyEvent(kSynReportEvent);
+        TEST_ASSERT((XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y | XINPUT_GAMEPAD_RIGHT_SHOULDER | XINPUT_GAMEPAD_DPAD_LEFT) == tracker.GetState().Gamepad.wButtons);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnY, .value = 0},
+            {.type = kEventTypeKey, .code = kBtnSelect, .value = 1},
+            kSynReportEvent
+        });
+        TEST_ASSERT((XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_RIGHT_SHOULDER | XINPUT_GAMEPAD_DPAD_LEFT) == tracker.GetState().Gamepad.wButtons);
+    }
+
+    // Verifies that stick axes are scaled to the full XInput range, with vertical axes inverted, and that triggers are scaled to the XInput trigger range.
+    TEST_CASE(Evdev_StateTracker_Axes)
+    {
+        TAxisRanges axisRanges = DefaultAxisRanges();
+        axisRanges[kAbsRx] = {.minimum = 0, .maximum = 1023};
+        axisRanges[kAbsRz] = {.minimum = 0, .maximum = 1023};
+
+        StateTracker tracker(axisRanges);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeAbs, .code = kAbsX, .value = -32768},
+            {.type = kEventTypeAbs, .code = kAbsY, .value = -32768},
+            {.type = kEventTypeAbs, .code = kAbsRx, .value = 1023},
+            {.type = kEventTypeAbs, .code = kAbsRy, .value = 32767},
+            {.type = kEventTypeAbs, .code = kAbsZ, .value = 255},
+            {.type = kEventTypeAbs, .code = kAbsRz, .value = 0},
+            kSynReportEvent
+        });
+
+        const XINPUT_GAMEPAD& kGamepad = tracker.GetState().Gamepad;
+        TEST_ASSERT(-32768 == kGamepad.sThumbLX);
+        TEST_ASSERT(32767 == kGamepad.sThumbLY);
+        TEST_ASSERT(32767 == kGamepad.sThumbRX);
+        TEST_ASSERT(-32768 == kGamepad.sThumbRY);
+        TEST_ASSERT(255 == kGamepad.bLeftTrigger);
+        TEST_ASSERT(0 == kGamepad.bRightTrigger);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeAbs, .code = kAbsX, .value = 100000},
+            {.type = kEventTypeAbs, .code = kAbsRz, .value = 1023},
+            kSynReportEvent
+        });
+
+        TEST_ASSERT(32767 == kGamepad.sThumbLX);
+        TEST_ASSERT(255 == kGamepad.bRightTrigger);
+    }
+
+    // Verifies that hat axes press and release the correct d-pad buttons.
+    TEST_CASE(Evdev_StateTracker_Hat)
+    {
+        StateTracker tracker(DefaultAxisRanges());
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeAbs, .code = kAbsHat0X, .value = 1},
+            {.type = kEventTypeAbs, .code = kAbsHat0Y, .value = -1},
+            kSynReportEvent
+        });
+        TEST_ASSERT((XINPUT_GAMEPAD_DPAD_RIGHT | XINPUT_GAMEPAD_DPAD_UP) == tracker.GetState().Gamepad.wButtons);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeAbs, .code = kAbsHat0X, .value = -1},
+            {.type = kEventTypeAbs, .code = kAbsHat0Y, .value = 0},
+            kSynReportEvent
+        });
+        TEST_ASSERT(XINPUT_GAMEPAD_DPAD_LEFT == tracker.GetState().Gamepad.wButtons);
+    }
+
+    // Verifies that the packet number advances once per report that changes the state and not at all for reports that do not.
+    TEST_CASE(Evdev_StateTracker_PacketNumber)
+    {
+        StateTracker tracker(DefaultAxisRanges());
+        TEST_ASSERT(0 == tracker.GetState().dwPacketNumber);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnB, .value = 1},
+            {.type = kEventTypeAbs, .code = kAbsX, .value = 1000},
+            kSynReportEvent
+        });
+        TEST_ASSERT(1 == tracker.GetState().dwPacketNumber);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnB, .value = 1},
+            kSynReportEvent,
+            kSynReportEvent
+        });
+        TEST_ASSERT(1 == tracker.GetState().dwPacketNumber);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnB, .value = 0},
+            kSynReportEvent,
+            {.type = kEventTypeAbs, .code = kAbsX, .value = 0},
+            kSynReportEvent
+        });
+        TEST_ASSERT(3 == tracker.GetState().dwPacketNumber);
+    }
+
+    // Verifies that events are discarded after a drop until the end of the next report, and that the tracker then asks for the current device state.
+    TEST_CASE(Evdev_StateTracker_Dropped)
+    {
+        StateTracker tracker(DefaultAxisRanges());
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnA, .value = 1},
+            kSynReportEvent
+        });
+        TEST_ASSERT(XINPUT_GAMEPAD_A == tracker.GetState().Gamepad.wButtons);
+        TEST_ASSERT(false == tracker.NeedsCurrentState());
+
+        ApplyEvents(tracker, {
+            kSynDroppedEvent,
+            {.type = kEventTypeKey, .code = kBtnB, .value = 1}
+        });
+        TEST_ASSERT(false == tracker.NeedsCurrentState());
+
+        tracker.ApplyEvent(kSynReportEvent);
+        TEST_ASSERT(true == tracker.NeedsCurrentState());
+        TEST_ASSERT(XINPUT_GAMEPAD_A == tracker.GetState().Gamepad.wButtons);
+        TEST_ASSERT(1 == tracker.GetState().dwPacketNumber);
+
+        ApplyEvents(tracker, {
+            {.type = kEventTypeKey, .code = kBtnA, .value = 0},
+            {.type = kEventTypeKey, .code = kBtnX, .value = 1},
+            kSynReportEvent
+        });
+        TEST_ASSERT(false == tracker.NeedsCurrentState());
+        TEST_ASSERT(XINPUT_GAMEPAD_X == tracker.GetState().Gamepad.wButtons);
+        TEST_ASSERT(2 == tracker.GetState().dwPacketNumber);
+    }
+
+    // Verifies that a replay source delivers exactly one report per read and nothing once exhausted.
+    TEST_CASE(Evdev_ReplayEventSource_OneReportPerRead)
+    {
+        ReplayEventSource source({
+            {.type = kEventTypeKey, .code = kBtnA, .value = 1},
+            {.type = kEventTypeAbs, .code = kAbsX, .value = 5},
+            kSynReportEvent,
+            {.type = kEventTypeKey, .code = kBtnA, .value = 0},
+            kSynReportEvent
+        }, DefaultAxisRanges());
+
+        TEST_ASSERT(-1 == source.GetWaitDescriptor());
+
+        std::vector<SEvent> events;
+        TEST_ASSERT(true == source.ReadEvents(events));
+        TEST_ASSERT(3 == events.size());
+
+        events.clear();
+        TEST_ASSERT(true == source.ReadEvents(events));
+        TEST_ASSERT(2 == events.size());
+
+        events.clear();
+        TEST_ASSERT(true == source.ReadEvents(events));
+        TEST_ASSERT(true == events.empty());
+    }
+
+    // Verifies that a captured event stream can be replayed from a file through the XInput interface, with each state retrieval advancing the replay by one report.
+    TEST_CASE(EvdevXInput_ReplayFromFile)
+    {
+        std::vector<uint8_t> capturedBytes;
+        AppendCapturedEvent(capturedBytes, {.type = kEventTypeKey, .code = kBtnStart, .value = 1});
+        AppendCapturedEvent(capturedBytes, {.type = kEventTypeAbs, .code = kAbsRz, .value = 255});
+        AppendCapturedEvent(capturedBytes, kSynReportEvent);
+        AppendCapturedEvent(capturedBytes, {.type = kEventTypeKey, .code = kBtnStart, .value = 0});
+        AppendCapturedEvent(capturedBytes, kSynReportEvent);
+
+        const std::filesystem::path kCaptureFilePath = std::filesystem::temp_directory_path() / L"XidiTest_EvdevReplay.bin";
+
+        FILE* const captureFile = fopen(kCaptureFilePath.string().c_str(), "wb");
+        TEST_ASSERT(nullptr != captureFile);
+        TEST_ASSERT(capturedBytes.size() == fwrite(capturedBytes.data(), 1, capturedBytes.size(), captureFile));
+        fclose(captureFile);
+
+        std::unique_ptr<ReplayEventSource> replaySource = ReplayEventSource::LoadFromFile(kCaptureFilePath.wstring().c_str(), DefaultAxisRanges());
+        std::filesystem::remove(kCaptureFilePath);
+        TEST_ASSERT(nullptr != replaySource);
+
+        EvdevXInput xinput;
+        TEST_ASSERT(true == xinput.AttachSource(1, std::move(replaySource)));
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(1, &state));
+        TEST_ASSERT(1 == state.dwPacketNumber);
+        TEST_ASSERT(XINPUT_GAMEPAD_START == state.Gamepad.wButtons);
+        TEST_ASSERT(255 == state.Gamepad.bRightTrigger);
+
+        TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(1, &state));
+        TEST_ASSERT(2 == state.dwPacketNumber);
+        TEST_ASSERT(0 == state.Gamepad.wButtons);
+        TEST_ASSERT(255 == state.Gamepad.bRightTrigger);
+
+        TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(1, &state));
+        TEST_ASSERT(2 == state.dwPacketNumber);
+    }
+
+    // Verifies that slots without an attached source report that no controller is connected and that out-of-range user indices are rejected.
+    TEST_CASE(EvdevXInput_NotConnected)
+    {
+        EvdevXInput xinput;
+        XINPUT_STATE state;
+
+        for (DWORD userIndex = 0; userIndex < XUSER_MAX_COUNT; ++userIndex)
+        {
+            TEST_ASSERT(false == xinput.IsSourceAttached(userIndex));
+            TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == xinput.GetState(userIndex, &state));
+        }
+
+        TEST_ASSERT(ERROR_BAD_ARGUMENTS == xinput.GetState(XUSER_MAX_COUNT, &state));
+        TEST_ASSERT(false == xinput.AttachSource(XUSER_MAX_COUNT, std::make_unique<ReplayEventSource>(std::vector<SEvent>(), DefaultAxisRanges())));
+
+        TEST_ASSERT(true == xinput.AttachSource(0, std::make_unique<ReplayEventSource>(std::vector<SEvent>(), DefaultAxisRanges())));
+        TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(0, &state));
+        TEST_ASSERT(0 == state.dwPacketNumber);
+
+        xinput.DetachSource(0);
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == xinput.GetState(0, &state));
+    }
+
+#ifdef __linux__
+    // Verifies that events from a waitable source are picked up by the event thread without any state retrieval, and that closing the source disconnects the controller.
+    TEST_CASE(EvdevXInput_WaitableSource)
+    {
+        int pipeDescriptors[2];
+        TEST_ASSERT(0 == pipe(pipeDescriptors));
+
+        EvdevXInput xinput;
+        TEST_ASSERT(true == xinput.AttachSource(2, std::make_unique<PipeEventSource>(pipeDescriptors[0])));
+
+        const SEvent kReport[] = {
+            {.type = kEventTypeKey, .code = kBtnThumbL, .value = 1},
+            kSynReportEvent
+        };
+        TEST_ASSERT(sizeof(kReport) == write(pipeDescriptors[1], kReport, sizeof(kReport)));
+
+        XINPUT_STATE state = {};
+        const auto kDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while ((0 == state.dwPacketNumber) && (std::chrono::steady_clock::now() < kDeadline))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(2, &state));
+        }
+
+        TEST_ASSERT(1 == state.dwPacketNumber);
+        TEST_ASSERT(XINPUT_GAMEPAD_LEFT_THUMB == state.Gamepad.wButtons);
+
+        close(pipeDescriptors[1]);
+        while ((true == xinput.IsSourceAttached(2)) && (std::chrono::steady_clock::now() < kDeadline))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == xinput.GetState(2, &state));
+    }
+#endif
+}
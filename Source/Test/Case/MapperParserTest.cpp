@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MapperParserTest.cpp
+ *   Unit tests for parsing and validating custom mapper definitions.
+ *****************************************************************************/
+
+#include "Configuration.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MapperParser.h"
+#include "TestCase.h"
+#include "XidiConfigReader.h"
+
+#include <optional>
+#include <string_view>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Controller;
+    using namespace ::Xidi::Controller::MapperParser;
+    using ::Xidi::XidiConfigReader;
+    using ::Xidi::Configuration::ConfigurationData;
+    using ::Xidi::Configuration::EFileReadResult;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Parses the specified configuration buffer using the same configuration reader that Xidi uses for its configuration file.
+    /// @param [in] configBuffer Configuration contents to parse.
+    /// @return Result of the parse operation.
+    static EFileReadResult ParseXidiConfiguration(std::wstring_view configBuffer)
+    {
+        XidiConfigReader reader;
+        ConfigurationData configData;
+        return reader.ReadConfigurationBuffer(L"Xidi.ini", configBuffer, configData);
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that every supported form of element mapper string is parsed into the expected description.
+    TEST_CASE(MapperParser_ParseElementMapperString_Valid)
+    {
+        constexpr struct
+        {
+            std::wstring_view elementMapperString;
+            SElementMapperSpec expectedSpec;
+        } kTestData[] = {
+            {L"Axis(X)", {.type = EElementMapperType::Axis, .axis = EAxis::X}},
+            {L"Axis(RotZ, +)", {.type = EElementMapperType::Axis, .axis = EAxis::RotZ, .axisDirection = AxisMapper::EDirection::Positive}},
+            {L"  Axis ( Z , - )  ", {.type = EElementMapperType::Axis, .axis = EAxis::Z, .axisDirection = AxisMapper::EDirection::Negative}},
+            {L"DigitalAxis(Y)", {.type = EElementMapperType::DigitalAxis, .axis = EAxis::Y}},
+            {L"DigitalAxis(X, -)", {.type = EElementMapperType::DigitalAxis, .axis = EAxis::X, .axisDirection = AxisMapper::EDirection::Negative}},
+            {L"Button(1)", {.type = EElementMapperType::Button, .button = EButton::B1}},
+            {L"Button(16)", {.type = EElementMapperType::Button, .button = EButton::B16}},
+            {L"Pov(Left)", {.type = EElementMapperType::Pov, .povDirection = EPovDirection::Left}},
+            {L"Pov(Right, Left)", {.type = EElementMapperType::Pov, .povDirection = EPovDirection::Right, .maybePovDirectionNegative = EPovDirection::Left}},
+        };
+
+        for (const auto& testData : kTestData)
+        {
+            const std::optional<SElementMapperSpec> kActualSpec = ParseElementMapperString(testData.elementMapperString);
+            TEST_ASSERT(true == kActualSpec.has_value());
+            TEST_ASSERT(kActualSpec.value() == testData.expectedSpec);
+        }
+    }
+
+    // Verifies that malformed element mapper strings are rejected.
+    TEST_CASE(MapperParser_ParseElementMapperString_Invalid)
+    {
+        constexpr std::wstring_view kInvalidElementMapperStrings[] = {
+            L"",
+            L"Axis",
+            L"Axis()",
+            L"Axis(X",
+            L"Axis(W)",
+            L"Axis(x)",
+            L"Axis(X, Up)",
+            L"Axis(X, +, -)",
+            L"Axis(X,)",
+            L"Button(0)",
+            L"Button(17)",
+            L"Button(-1)",
+            L"Button(1, 2)",
+            L"Pov(Center)",
+            L"Pov(Up, Sideways)",
+            L"Keyboard(A)",
+            L"Axis(X) extra",
+        };
+
+        for (const auto& invalidElementMapperString : kInvalidElementMapperStrings)
+            TEST_ASSERT(false == ParseElementMapperString(invalidElementMapperString).has_value());
+    }
+
+    // Verifies that XInput controller elements are identified by the names of their enumerators and that custom mapper names are extracted from section names.
+    TEST_CASE(MapperParser_Names)
+    {
+        TEST_ASSERT(Mapper::EXInputElement::StickLeftX == FindXInputElementByName(L"StickLeftX"));
+        TEST_ASSERT(Mapper::EXInputElement::TriggerRT == FindXInputElementByName(L"TriggerRT"));
+        TEST_ASSERT(Mapper::EXInputElement::ButtonRS == FindXInputElementByName(L"ButtonRS"));
+        TEST_ASSERT(false == FindXInputElementByName(L"ButtonZ").has_value());
+
+        TEST_ASSERT(L"MyMapper" == CustomMapperNameFromSection(L"CustomMapper:MyMapper"));
+        TEST_ASSERT(false == CustomMapperNameFromSection(L"CustomMapper:").has_value());
+        TEST_ASSERT(false == CustomMapperNameFromSection(L"Mapper").has_value());
+    }
+
+    // Verifies that custom mapper definitions are accepted by the configuration reader and that the mapper type can refer to a custom mapper defined anywhere in the file.
+    TEST_CASE(MapperParser_Configuration_Valid)
+    {
+        constexpr std::wstring_view kConfigBuffer =
+            L"[Mapper]\n"
+            L"Type = MyMapper\n"
+            L"[CustomMapper:MyMapper]\n"
+            L"StickLeftX = Axis(X)\n"
+            L"TriggerLT = Axis(Z, +)\n"
+            L"ButtonA = Button(1)\n"
+            L"DpadUp = Pov(Up)\n";
+
+        TEST_ASSERT(EFileReadResult::Success == ParseXidiConfiguration(kConfigBuffer));
+        TEST_ASSERT(EFileReadResult::Success == ParseXidiConfiguration(L"[Mapper]\nType = StandardGamepad\n"));
+    }
+
+    // Verifies that invalid custom mapper definitions, and references to mappers that are not defined, are rejected by the configuration reader.
+    TEST_CASE(MapperParser_Configuration_Invalid)
+    {
+        constexpr std::wstring_view kInvalidConfigBuffers[] = {
+            L"[Mapper]\nType = MyMapper\n",
+            L"[Mapper]\nType = MyMapper\n[CustomMapper:OtherMapper]\nButtonA = Button(1)\n",
+            L"[CustomMapper:MyMapper]\nButtonA = Button(17)\n",
+            L"[CustomMapper:MyMapper]\nButtonZ = Button(1)\n",
+            L"[CustomMapper:MyMapper]\nButtonA = Button(1)\nButtonA = Button(2)\n",
+            L"[CustomMapper:StandardGamepad]\nButtonA = Button(1)\n",
+            L"[CustomMapper:]\nButtonA = Button(1)\n",
+        };
+
+        for (const auto& invalidConfigBuffer : kInvalidConfigBuffers)
+            TEST_ASSERT(EFileReadResult::Malformed == ParseXidiConfiguration(invalidConfigBuffer));
+    }
+}
@@ -9,15 +9,17 @@
  *   Unit tests for entire controller layout mapper objects.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
+#include "Configuration.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "Mapper.h"
 #include "TestCase.h"
+#include "XidiConfigReader.h"
 
 #include <cstdint>
 #include <memory>
-#include <xinput.h>
+#include <string_view>
 
 
 namespace XidiTest
@@ -84,7 +86,7 @@ namespace XidiTest
 
         // -------- CONCRETE INSTANCE METHODS -------------------------- //
 
-        void ContributeFromAnalogValue(SState& controllerState, int16_t analogValue) const override
+        void ContributeFromAnalogValue(SState&, int16_t analogValue) const override
         {
             if (EExpectedSource::Analog != expectedSource)
                 TEST_FAILED_BECAUSE(L"MockElementMapper: wrong value source (expected enumerator %d, got Analog).", (int)expectedSource);
@@ -96,7 +98,7 @@ namespace XidiTest
                 *contributionCounter += 1;
         }
 
-        void ContributeFromButtonValue(SState& controllerState, bool buttonPressed) const override
+        void ContributeFromButtonValue(SState&, bool buttonPressed) const override
         {
             if (EExpectedSource::Button != expectedSource)
                 TEST_FAILED_BECAUSE(L"MockElementMapper: wrong value source (expected enumerator %d, got Button).", (int)expectedSource);
@@ -108,7 +110,7 @@ namespace XidiTest
                 *contributionCounter += 1;
         }
 
-        void ContributeFromTriggerValue(SState& controllerState, uint8_t triggerValue) const override
+        void ContributeFromTriggerValue(SState&, uint8_t triggerValue) const override
         {
             if (EExpectedSource::Trigger != expectedSource)
                 TEST_FAILED_BECAUSE(L"MockElementMapper: wrong value source (expected enumerator %d, got Trigger).", (int)expectedSource);
@@ -595,25 +597,56 @@ namespace XidiTest
     }
 
 
+    // The following sequence of tests, which together comprise the Registry suite, verify that known mappers can be located by name.
+
+    // Verifies that every registry entry can be found by its name, that its name matches the mapper's own name, and that unknown names are rejected.
+    TEST_CASE(Mapper_Registry_LookupByName)
+    {
+        TEST_ASSERT(false == Mapper::kRegistry.empty());
+
+        for (const auto& registryEntry : Mapper::kRegistry)
+        {
+            TEST_ASSERT(registryEntry.name == registryEntry.mapper->GetName());
+            TEST_ASSERT(registryEntry.mapper == Mapper::GetByName(registryEntry.name));
+        }
+
+        TEST_ASSERT(nullptr == Mapper::GetByName(L"UnknownMapper"));
+        TEST_ASSERT(nullptr == Mapper::GetByName(L"standardgamepad"));
+    }
+
+    // Verifies that the default mapper is the standard gamepad mapper and that it is selected when no name is given.
+    TEST_CASE(Mapper_Registry_Default)
+    {
+        TEST_ASSERT(Mapper::GetByName(L"StandardGamepad") == Mapper::GetDefault());
+        TEST_ASSERT(Mapper::kDefaultMapper == Mapper::GetByName(L""));
+    }
+
+
     // The following sequence of tests, which together comprise the State suite, verify that a mapper correctly handles certain corner cases when writing to controller state.
     // The formula for each test case body is create an expected controller state, obtain a mapper, ask it to write to a controller state, and finally compare expected and actual states.
     
     // An empty mapper is expected to produce all zeroes in its output controller state, irrespective of the XInput controller's state.
     TEST_CASE(Mapper_State_ZeroOnEmpty)
     {
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
 
         const Mapper mapper({
             // Empty
         });
 
-        SState actualState;
-        FillMemory(&actualState, sizeof(actualState), 0xcd);
+        // Every element starts out non-neutral so that any element the mapper fails to clear is detected.
+        SState poisonedState;
+        for (auto& axisValue : poisonedState.axis)
+            axisValue = (int32_t)0xcdcdcdcd;
+        poisonedState.button.set();
+        for (auto& povComponent : poisonedState.povDirection.components)
+            povComponent = true;
+
+        SState actualState = poisonedState;
         mapper.MapXInputState(actualState, {});
         TEST_ASSERT(actualState == expectedState);
 
-        FillMemory(&actualState, sizeof(actualState), 0xcd);
+        actualState = poisonedState;
         mapper.MapXInputState(actualState, {
             .wButtons = 32767,
             .bLeftTrigger = 128,
@@ -634,8 +667,7 @@ namespace XidiTest
         constexpr int32_t kNonInvertedInputValue = kAnalogValueMax;
         constexpr int32_t kExpectedOutputValue = kAnalogValueMax;
         
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)EAxis::X] = kExpectedOutputValue;
 
         const Mapper mapper({
@@ -663,8 +695,7 @@ namespace XidiTest
         constexpr int32_t kNonInvertedInputValue = kAnalogValueMin;
         constexpr int32_t kExpectedOutputValue = kAnalogValueMin;
         
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)EAxis::RotX] = kExpectedOutputValue;
 
         const Mapper mapper({
@@ -693,8 +724,7 @@ namespace XidiTest
         constexpr int32_t kNonInvertedExpectedOutputValue = kAnalogValueMin;
         constexpr int32_t kInvertedExpectedOutputValue = kAnalogValueMax;
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.axis[(int)EAxis::X] = kNonInvertedExpectedOutputValue;
         expectedState.axis[(int)EAxis::Y] = kInvertedExpectedOutputValue;
         expectedState.axis[(int)EAxis::RotX] = kNonInvertedExpectedOutputValue;
@@ -716,4 +746,155 @@ namespace XidiTest
         });
         TEST_ASSERT(actualState == expectedState);
     }
+
+
+    // The following sequence of tests, which together comprise the Incremental suite, verify that a mapper correctly identifies changes in XInput controller state and maps only the affected parts of the controller state.
+
+    // Verifies that each field of the XInput controller state is attributed to the correct XInput controller element.
+    TEST_CASE(Mapper_Incremental_ChangedXInputElements)
+    {
+        const XINPUT_GAMEPAD kBaseState = {.wButtons = XINPUT_GAMEPAD_A, .bLeftTrigger = 10, .sThumbRY = 100};
+
+        TEST_ASSERT(0 == Mapper::ChangedXInputElements(kBaseState, kBaseState));
+        TEST_ASSERT(((Mapper::TXInputElementSet)1 << (int)Mapper::EXInputElement::ButtonA) == Mapper::ChangedXInputElements(kBaseState, {.bLeftTrigger = 10, .sThumbRY = 100}));
+        TEST_ASSERT(((Mapper::TXInputElementSet)1 << (int)Mapper::EXInputElement::TriggerLT) == Mapper::ChangedXInputElements(kBaseState, {.wButtons = XINPUT_GAMEPAD_A, .sThumbRY = 100}));
+        TEST_ASSERT(((Mapper::TXInputElementSet)1 << (int)Mapper::EXInputElement::StickRightY) == Mapper::ChangedXInputElements(kBaseState, {.wButtons = XINPUT_GAMEPAD_A, .bLeftTrigger = 10}));
+        TEST_ASSERT((((Mapper::TXInputElementSet)1 << (int)Mapper::EXInputElement::DpadLeft) | ((Mapper::TXInputElementSet)1 << (int)Mapper::EXInputElement::ButtonRS)) == Mapper::ChangedXInputElements(kBaseState, {.wButtons = (XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_RIGHT_THUMB), .bLeftTrigger = 10, .sThumbRY = 100}));
+    }
+
+    // Verifies that incrementally updating a controller state produces exactly the same result as mapping from scratch, including when multiple XInput controller elements contribute to the same virtual controller element.
+    TEST_CASE(Mapper_Incremental_MatchesFullMapping)
+    {
+        const Mapper mapper({
+            .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+            .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+            .stickRightX = std::make_unique<AxisMapper>(EAxis::X),
+            .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
+            .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
+            .dpadLeft = std::make_unique<DigitalAxisMapper>(EAxis::RotX, AxisMapper::EDirection::Negative),
+            .dpadRight = std::make_unique<DigitalAxisMapper>(EAxis::RotX, AxisMapper::EDirection::Positive),
+            .triggerLT = std::make_unique<AxisMapper>(EAxis::Z, AxisMapper::EDirection::Positive),
+            .triggerRT = std::make_unique<AxisMapper>(EAxis::Z, AxisMapper::EDirection::Negative),
+            .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+            .buttonB = std::make_unique<ButtonMapper>(EButton::B1),
+            .buttonX = std::make_unique<ButtonMapper>(EButton::B2)
+        });
+
+        const XINPUT_GAMEPAD kXInputStates[] = {
+            {},
+            {.wButtons = XINPUT_GAMEPAD_A},
+            {.wButtons = (XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B)},
+            {.wButtons = XINPUT_GAMEPAD_B, .sThumbLX = kAnalogValueMax},
+            {.wButtons = XINPUT_GAMEPAD_B, .sThumbLX = kAnalogValueMax, .sThumbRX = 1000},
+            {.wButtons = (XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_LEFT), .sThumbRX = 1000},
+            {.wButtons = (XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT), .bLeftTrigger = 255, .sThumbRX = 1000},
+            {.wButtons = (XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_X), .bLeftTrigger = 255, .bRightTrigger = 128, .sThumbLY = -5000},
+            {.wButtons = XINPUT_GAMEPAD_START, .bRightTrigger = 128, .sThumbLY = -5000},
+            {}
+        };
+
+        SState incrementalState;
+        mapper.MapXInputState(incrementalState, kXInputStates[0]);
+
+        for (unsigned int i = 1; i < _countof(kXInputStates); ++i)
+        {
+            SState expectedState;
+            mapper.MapXInputState(expectedState, kXInputStates[i]);
+
+            mapper.MapChangedXInputElements(incrementalState, kXInputStates[i], Mapper::ChangedXInputElements(kXInputStates[i - 1], kXInputStates[i]));
+            TEST_ASSERT(incrementalState == expectedState);
+        }
+    }
+
+
+    // The following sequence of tests, which together comprise the Custom suite, verify that custom mappers defined in the configuration file are compiled correctly and can be located by name.
+
+    // Verifies that a custom mapper defined identically to a built-in mapper has the same capabilities and produces the same controller states.
+    TEST_CASE(Mapper_Custom_MatchesBuiltin)
+    {
+        constexpr std::wstring_view kConfigBuffer =
+            L"[CustomMapper:CustomStandardGamepad]\n"
+            L"StickLeftX = Axis(X)\n"
+            L"StickLeftY = Axis(Y)\n"
+            L"StickRightX = Axis(Z)\n"
+            L"StickRightY = Axis(RotZ)\n"
+            L"DpadUp = Pov(Up)\n"
+            L"DpadDown = Pov(Down)\n"
+            L"DpadLeft = Pov(Left)\n"
+            L"DpadRight = Pov(Right)\n"
+            L"TriggerLT = Button(7)\n"
+            L"TriggerRT = Button(8)\n"
+            L"ButtonA = Button(1)\n"
+            L"ButtonB = Button(2)\n"
+            L"ButtonX = Button(3)\n"
+            L"ButtonY = Button(4)\n"
+            L"ButtonLB = Button(5)\n"
+            L"ButtonRB = Button(6)\n"
+            L"ButtonBack = Button(9)\n"
+            L"ButtonStart = Button(10)\n"
+            L"ButtonLS = Button(11)\n"
+            L"ButtonRS = Button(12)\n";
+
+        ::Xidi::XidiConfigReader reader;
+        ::Xidi::Configuration::ConfigurationData configData;
+        TEST_ASSERT(::Xidi::Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", kConfigBuffer, configData));
+        Mapper::LoadCustomMappers(configData);
+
+        const Mapper* const kBuiltinMapper = Mapper::GetByName(L"StandardGamepad");
+        const Mapper* const kCustomMapper = Mapper::GetByName(L"CustomStandardGamepad");
+        TEST_ASSERT(nullptr != kCustomMapper);
+        TEST_ASSERT(nullptr == Mapper::GetBuiltinByName(L"CustomStandardGamepad"));
+        TEST_ASSERT(L"CustomStandardGamepad" == kCustomMapper->GetName());
+        TEST_ASSERT(kCustomMapper->GetCapabilities() == kBuiltinMapper->GetCapabilities());
+
+        const XINPUT_GAMEPAD kXInputStates[] = {
+            {},
+            {.wButtons = (XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_RIGHT_THUMB), .bLeftTrigger = 255, .sThumbLX = -32768, .sThumbRY = 1234},
+            {.wButtons = (XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_DPAD_LEFT), .bRightTrigger = 200, .sThumbLY = 32767, .sThumbRX = -20000},
+        };
+
+        for (const auto& xinputState : kXInputStates)
+        {
+            SState expectedState;
+            kBuiltinMapper->MapXInputState(expectedState, xinputState);
+
+            SState actualState;
+            kCustomMapper->MapXInputState(actualState, xinputState);
+            TEST_ASSERT(actualState == expectedState);
+        }
+
+        Mapper::LoadCustomMappers(::Xidi::Configuration::ConfigurationData());
+        TEST_ASSERT(nullptr == Mapper::GetByName(L"CustomStandardGamepad"));
+    }
+
+    // Verifies that loading an unchanged custom mapper definition reuses the previously-compiled mapper and that a changed definition produces a new mapper without invalidating the old one.
+    TEST_CASE(Mapper_Custom_Reload)
+    {
+        ::Xidi::XidiConfigReader reader;
+        ::Xidi::Configuration::ConfigurationData configData;
+
+        TEST_ASSERT(::Xidi::Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[CustomMapper:ReloadTest]\nButtonA = Button(1)\n", configData));
+        Mapper::LoadCustomMappers(configData);
+        const Mapper* const kOriginalMapper = Mapper::GetByName(L"ReloadTest");
+        TEST_ASSERT(nullptr != kOriginalMapper);
+
+        TEST_ASSERT(::Xidi::Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[CustomMapper:ReloadTest]\nButtonA = Button(1)\n", configData));
+        Mapper::LoadCustomMappers(configData);
+        TEST_ASSERT(kOriginalMapper == Mapper::GetByName(L"ReloadTest"));
+
+        TEST_ASSERT(::Xidi::Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[CustomMapper:ReloadTest]\nButtonA = Button(2)\n", configData));
+        Mapper::LoadCustomMappers(configData);
+        const Mapper* const kChangedMapper = Mapper::GetByName(L"ReloadTest");
+        TEST_ASSERT(nullptr != kChangedMapper);
+        TEST_ASSERT(kOriginalMapper != kChangedMapper);
+        TEST_ASSERT(2 == kChangedMapper->GetCapabilities().numButtons);
+
+        // Virtual controllers might still be using the original mapper, so it must remain usable.
+        SState originalMapperState;
+        kOriginalMapper->MapXInputState(originalMapperState, {.wButtons = XINPUT_GAMEPAD_A});
+        TEST_ASSERT(originalMapperState == SState({.button = 0b01}));
+
+        Mapper::LoadCustomMappers(::Xidi::Configuration::ConfigurationData());
+        TEST_ASSERT(nullptr == Mapper::GetByName(L"ReloadTest"));
+    }
 }
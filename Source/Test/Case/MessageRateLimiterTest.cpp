@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file MessageRateLimiterTest.cpp
+ *   Unit tests for limiting the rate at which repeated messages are output.
+ *****************************************************************************/
+
+#include "MessageRateLimiter.h"
+#include "TestCase.h"
+
+#include <cstdint>
+#include <optional>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Message;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Burst size used for all test rate limiters.
+    static constexpr unsigned int kTestBurstSize = 3;
+
+    /// Refill interval used for all test rate limiters, in nanoseconds.
+    static constexpr uint64_t kTestRefillInterval = 1000000000ull;
+
+    /// Repeat interval used for all test rate limiters, in nanoseconds.
+    static constexpr uint64_t kTestRepeatInterval = 10000000000ull;
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a burst of messages is allowed, that the bucket then empties, and that it refills at the configured rate without exceeding its capacity.
+    TEST_CASE(MessageRateLimiter_TokenBucket)
+    {
+        RateLimiter rateLimiter(kTestBurstSize, kTestRefillInterval, kTestRepeatInterval);
+        uint64_t timestamp = 5000000000ull;
+
+        for (unsigned int i = 0; i < kTestBurstSize; ++i)
+            TEST_ASSERT(true == rateLimiter.TryAcquire(timestamp));
+
+        TEST_ASSERT(false == rateLimiter.TryAcquire(timestamp));
+        TEST_ASSERT(false == rateLimiter.TryAcquire(timestamp + (kTestRefillInterval / 2)));
+        TEST_ASSERT(2 == rateLimiter.GetSuppressedCount());
+
+        timestamp += kTestRefillInterval;
+        TEST_ASSERT(true == rateLimiter.TryAcquire(timestamp));
+        TEST_ASSERT(false == rateLimiter.TryAcquire(timestamp));
+
+        // A long quiet period refills the bucket, but only up to the burst size.
+        timestamp += (100 * kTestRefillInterval);
+        for (unsigned int i = 0; i < kTestBurstSize; ++i)
+            TEST_ASSERT(true == rateLimiter.TryAcquire(timestamp));
+
+        TEST_ASSERT(false == rateLimiter.TryAcquire(timestamp));
+    }
+
+    // Verifies that identical messages are held back until the repeat interval elapses, that different messages are not, and that the suppressed count is reported with the next message output.
+    TEST_CASE(MessageRateLimiter_Deduplicate)
+    {
+        RateLimiter rateLimiter(kTestBurstSize, kTestRefillInterval, kTestRepeatInterval);
+        uint64_t timestamp = 0;
+
+        TEST_ASSERT(std::optional<unsigned int>(0) == rateLimiter.Admit(L"Message A", timestamp));
+        TEST_ASSERT(false == rateLimiter.Admit(L"Message A", timestamp + 1).has_value());
+        TEST_ASSERT(false == rateLimiter.Admit(L"Message A", timestamp + kTestRepeatInterval - 1).has_value());
+        TEST_ASSERT(2 == rateLimiter.GetSuppressedCount());
+
+        // Once the repeat interval elapses, the same message is output again along with the number suppressed in between.
+        timestamp += kTestRepeatInterval;
+        TEST_ASSERT(std::optional<unsigned int>(2) == rateLimiter.Admit(L"Message A", timestamp));
+        TEST_ASSERT(0 == rateLimiter.GetSuppressedCount());
+
+        // A different message is output immediately, carrying the count of anything suppressed, including messages that never obtained a token.
+        TEST_ASSERT(false == rateLimiter.Admit(L"Message A", timestamp + 1).has_value());
+        for (unsigned int i = 0; i < kTestBurstSize; ++i)
+            rateLimiter.TryAcquire(timestamp + 1);
+        TEST_ASSERT(false == rateLimiter.TryAcquire(timestamp + 1));
+        TEST_ASSERT(std::optional<unsigned int>(2) == rateLimiter.Admit(L"Message B", timestamp + 2));
+        TEST_ASSERT(std::optional<unsigned int>(0) == rateLimiter.Admit(L"Message A", timestamp + 3));
+    }
+}
@@ -10,7 +10,7 @@
  *   point-of-view hat.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiPlatform.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "TestCase.h"
@@ -53,13 +53,11 @@ namespace XidiTest
         {
             const PovMapper mapper(kTargetPov);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].povDirection.components[(int)kTargetPov] = kExpectedPovSequence[currentSequenceIndex];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPov] = kExpectedPovSequence[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -98,15 +96,13 @@ namespace XidiTest
         {
             const PovMapper mapper(kTargetPovPositive, kTargetPovNegative);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].povDirection.components[(int)kTargetPovPositive] = kExpectedPovSequencePositive[currentSequenceIndex];
             possibleExpectedStates[0].povDirection.components[(int)kTargetPovNegative] = kExpectedPovSequenceNegative[currentSequenceIndex];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPovPositive] = kExpectedPovSequencePositive[currentSequenceIndex + 1];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPovNegative] = kExpectedPovSequenceNegative[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -144,12 +140,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = false;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueNeutral);
 
@@ -171,12 +165,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMax);
 
@@ -201,12 +193,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPositive)
             mapper.ContributeFromAnalogValue(actualState, kAnalogValueMax);
         for (auto& mapper : mappersNegative)
@@ -225,12 +215,10 @@ namespace XidiTest
         {
             constexpr PovMapper mapper(kTargetPov);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.povDirection.components[(int)kTargetPov] = buttonIsPressed;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -248,13 +236,11 @@ namespace XidiTest
         {
             constexpr PovMapper mapper(kTargetPovPositive, kTargetPovNegative);
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.povDirection.components[(int)kTargetPovPositive] = buttonIsPressed;
             expectedState.povDirection.components[(int)kTargetPovNegative] = !buttonIsPressed;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
             TEST_ASSERT(actualState == expectedState);
@@ -278,12 +264,10 @@ namespace XidiTest
                 PovMapper(kTargetPov)
             };
 
-            SState expectedState;
-            ZeroMemory(&expectedState, sizeof(expectedState));
+            SState expectedState = {};
             expectedState.povDirection.components[(int)kTargetPov] = buttonIsPressed;
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             for (auto& mapper : mappers)
                 mapper.ContributeFromButtonValue(actualState, buttonIsPressed);
 
@@ -308,12 +292,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromButtonValue(actualState, true);
         for (auto& mapper : mappersNotPressed)
@@ -338,13 +320,11 @@ namespace XidiTest
         {
             const PovMapper mapper(kTargetPov);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].povDirection.components[(int)kTargetPov] = kExpectedPovSequence[currentSequenceIndex];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPov] = kExpectedPovSequence[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -383,15 +363,13 @@ namespace XidiTest
         {
             const PovMapper mapper(kTargetPovPositive, kTargetPovNegative);
 
-            SState possibleExpectedStates[2];
-            ZeroMemory(possibleExpectedStates, sizeof(possibleExpectedStates));
+            SState possibleExpectedStates[2] = {};
             possibleExpectedStates[0].povDirection.components[(int)kTargetPovPositive] = kExpectedPovSequencePositive[currentSequenceIndex];
             possibleExpectedStates[0].povDirection.components[(int)kTargetPovNegative] = kExpectedPovSequenceNegative[currentSequenceIndex];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPovPositive] = kExpectedPovSequencePositive[currentSequenceIndex + 1];
             possibleExpectedStates[1].povDirection.components[(int)kTargetPovNegative] = kExpectedPovSequenceNegative[currentSequenceIndex + 1];
 
-            SState actualState;
-            ZeroMemory(&actualState, sizeof(actualState));
+            SState actualState = {};
             mapper.ContributeFromTriggerValue(actualState, (uint8_t)triggerValue);
 
             if (actualState == possibleExpectedStates[0])
@@ -429,12 +407,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = false;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMin);
 
@@ -455,12 +431,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappers)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMax);
 
@@ -484,12 +458,10 @@ namespace XidiTest
             PovMapper(kTargetPov)
         };
 
-        SState expectedState;
-        ZeroMemory(&expectedState, sizeof(expectedState));
+        SState expectedState = {};
         expectedState.povDirection.components[(int)kTargetPov] = true;
 
-        SState actualState;
-        ZeroMemory(&actualState, sizeof(actualState));
+        SState actualState = {};
         for (auto& mapper : mappersPressed)
             mapper.ContributeFromTriggerValue(actualState, kTriggerValueMax);
         for (auto& mapper : mappersNotPressed)
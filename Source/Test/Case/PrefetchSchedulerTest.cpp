@@ -0,0 +1,385 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file PrefetchSchedulerTest.cpp
+ *   Unit tests for learning application read cadence and for prefetching
+ *   controller state ahead of predicted reads.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "ControllerSet.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockClock.h"
+#include "MockSharedMemory.h"
+#include "MockXInputSource.h"
+#include "PrefetchScheduler.h"
+#include "Statistics.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using ::Xidi::Controller::ButtonMapper;
+    using ::Xidi::Controller::CadenceTracker;
+    using ::Xidi::Controller::ControllerSet;
+    using ::Xidi::Controller::EButton;
+    using ::Xidi::Controller::Mapper;
+    using ::Xidi::Controller::PrefetchScheduler;
+    using ::Xidi::Controller::VirtualController;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Frame period used to simulate an application, in nanoseconds.
+    static constexpr uint64_t kTestPeriod = 10000000ull;
+
+    /// Lead time used for all test schedulers, in nanoseconds.
+    static constexpr uint64_t kTestLeadTime = 2000000ull;
+
+    /// Number of frames an application needs to read before its cadence is known, including the first frame which has no interval.
+    static constexpr unsigned int kLearningFrameCount = CadenceTracker::kStableIntervalsRequired + 1;
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Prefetch target whose prefetch is always due, and which registers and unregisters another target with the scheduler while it is being prefetched.
+    class ReentrantPrefetchTarget : public Controller::IPrefetchTarget
+    {
+    public:
+        /// Scheduler with which this target is registered.
+        PrefetchScheduler& scheduler;
+
+        /// Clock used by the scheduler, which determines the predicted time of the next read.
+        const MockClock& clock;
+
+        /// Target to register and unregister while being prefetched.
+        Controller::IPrefetchTarget* const otherTarget;
+
+        /// Number of times #Prefetch has been invoked.
+        unsigned int prefetchCount;
+
+        ReentrantPrefetchTarget(PrefetchScheduler& scheduler, const MockClock& clock, Controller::IPrefetchTarget* otherTarget) : scheduler(scheduler), clock(clock), otherTarget(otherTarget), prefetchCount(0)
+        {
+            // Nothing to do here.
+        }
+
+        std::optional<Controller::SPrefetchPrediction> GetPrefetchPrediction(void) override
+        {
+            return Controller::SPrefetchPrediction({.nextRead = clock.GetTimestamp() + kTestLeadTime, .period = kTestPeriod, .prefetchPending = false});
+        }
+
+        void Prefetch(void) override
+        {
+            prefetchCount += 1;
+
+            scheduler.AddTarget(otherTarget);
+            scheduler.RemoveTarget(otherTarget);
+        }
+    };
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Simulates an application that reads the state of a virtual controller once per frame for as long as it takes the controller to learn the cadence.
+    /// Upon return, the clock is at the time of the last learning read.
+    /// @param [in] clock Clock used by the virtual controller, which is advanced by one frame period before every read except the first.
+    /// @param [in] controller Virtual controller to read.
+    static void LearnCadence(MockClock& clock, VirtualController& controller)
+    {
+        for (unsigned int i = 0; i < kLearningFrameCount; ++i)
+        {
+            if (0 != i)
+                clock.Advance(kTestPeriod);
+
+            controller.GetState();
+        }
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a steady cadence is learned only after enough consistent frames and that additional reads within the same frame do not disturb it.
+    TEST_CASE(PrefetchScheduler_CadenceTracker_LearnsPeriod)
+    {
+        CadenceTracker tracker;
+        uint64_t timestamp = 1000000000ull;
+
+        TEST_ASSERT(true == tracker.RecordRead(timestamp));
+        TEST_ASSERT(false == tracker.PredictNextRead().has_value());
+
+        for (unsigned int i = 0; i < CadenceTracker::kStableIntervalsRequired; ++i)
+        {
+            TEST_ASSERT(false == tracker.PredictNextRead().has_value());
+
+            timestamp += kTestPeriod;
+            TEST_ASSERT(true == tracker.RecordRead(timestamp));
+            TEST_ASSERT(false == tracker.RecordRead(timestamp + (CadenceTracker::kSameFrameInterval / 2)));
+        }
+
+        TEST_ASSERT(kTestPeriod == tracker.GetPeriod());
+        TEST_ASSERT(std::optional<uint64_t>(timestamp + kTestPeriod) == tracker.PredictNextRead());
+    }
+
+    // Verifies that a change of cadence or a long pause causes the cadence to be learned again.
+    TEST_CASE(PrefetchScheduler_CadenceTracker_Relearn)
+    {
+        CadenceTracker tracker;
+        uint64_t timestamp = 0;
+
+        for (unsigned int i = 0; i < kLearningFrameCount; ++i)
+        {
+            tracker.RecordRead(timestamp);
+            timestamp += kTestPeriod;
+        }
+
+        TEST_ASSERT(true == tracker.PredictNextRead().has_value());
+
+        // A frame that takes twice as long as expected does not match the estimate.
+        timestamp += kTestPeriod;
+        tracker.RecordRead(timestamp);
+        TEST_ASSERT(false == tracker.PredictNextRead().has_value());
+        TEST_ASSERT((2 * kTestPeriod) == tracker.GetPeriod());
+
+        for (unsigned int i = 0; i < CadenceTracker::kStableIntervalsRequired; ++i)
+        {
+            timestamp += (2 * kTestPeriod);
+            tracker.RecordRead(timestamp);
+        }
+
+        TEST_ASSERT(std::optional<uint64_t>(timestamp + (2 * kTestPeriod)) == tracker.PredictNextRead());
+
+        // A pause longer than any plausible frame discards the estimate entirely.
+        timestamp += (CadenceTracker::kMaximumPeriod + 1);
+        TEST_ASSERT(true == tracker.RecordRead(timestamp));
+        TEST_ASSERT(false == tracker.PredictNextRead().has_value());
+        TEST_ASSERT(0 == tracker.GetPeriod());
+    }
+
+    // Verifies that prefetched state is considered stale once more than one period has passed since it was captured.
+    TEST_CASE(PrefetchScheduler_CadenceTracker_IsPrefetchStale)
+    {
+        CadenceTracker tracker;
+        TEST_ASSERT(true == tracker.IsPrefetchStale(0, 0));
+
+        for (unsigned int i = 0; i < kLearningFrameCount; ++i)
+            tracker.RecordRead(i * kTestPeriod);
+
+        TEST_ASSERT(false == tracker.IsPrefetchStale(1000, 1000 + kTestLeadTime));
+        TEST_ASSERT(false == tracker.IsPrefetchStale(1000, 1000 + kTestPeriod));
+        TEST_ASSERT(true == tracker.IsPrefetchStale(1000, 1000 + kTestPeriod + 1));
+    }
+
+    // Verifies that once the cadence is known, XInput is read once per frame by the scheduler rather than by the application, and that the application's reads are counted as prefetch hits.
+    TEST_CASE(PrefetchScheduler_VirtualController_OneReadPerFrame)
+    {
+        constexpr uint32_t kProcessId = 1004;
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+        constexpr unsigned int kPrefetchedFrameCount = 8;
+
+        const Mapper kTestMapper({.buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+        MockClock mockClock(1000000000ull);
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+
+        TEST_ASSERT(true == Statistics::Publish(std::make_unique<MockSharedMemory>(), kProcessId));
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(xinputSource), mockClock);
+        PrefetchScheduler scheduler(mockClock);
+        scheduler.AddTarget(&controller);
+
+        // Until the cadence is known, nothing is prefetched and every application read goes to XInput.
+        for (unsigned int i = 0; i < kLearningFrameCount; ++i)
+        {
+            if (0 != i)
+                mockClock.Advance(kTestPeriod);
+
+            scheduler.RunDuePrefetches();
+            controller.GetState();
+        }
+
+        TEST_ASSERT(kLearningFrameCount == xinput->GetReadCount());
+
+        for (unsigned int i = 0; i < kPrefetchedFrameCount; ++i)
+        {
+            mockClock.Advance(kTestPeriod - kTestLeadTime);
+            TEST_ASSERT((mockClock.GetTimestamp() + kTestPeriod) == scheduler.RunDuePrefetches());
+
+            // Running the scheduler again before the application reads does not issue a second prefetch.
+            scheduler.RunDuePrefetches();
+            TEST_ASSERT((kLearningFrameCount + i + 1) == xinput->GetReadCount());
+
+            mockClock.Advance(kTestLeadTime);
+            controller.GetState();
+            TEST_ASSERT((kLearningFrameCount + i + 1) == xinput->GetReadCount());
+        }
+
+        // Skipping the scheduler for one frame causes the application to read XInput itself, which counts as a miss.
+        mockClock.Advance(kTestPeriod);
+        controller.GetState();
+        TEST_ASSERT((kLearningFrameCount + kPrefetchedFrameCount + 1) == xinput->GetReadCount());
+
+        MockSharedMemory readerSharedMemory;
+        const Statistics::SSegment* const kSegment = Statistics::ValidateSegment(readerSharedMemory.Open(Statistics::SegmentName(kProcessId), sizeof(Statistics::SSegment)), sizeof(Statistics::SSegment));
+        TEST_ASSERT(nullptr != kSegment);
+
+        const Statistics::SSnapshot kSnapshot = Statistics::ReadSnapshot(*kSegment);
+        TEST_ASSERT(kPrefetchedFrameCount == kSnapshot.controller[kControllerIndex].prefetchCount);
+        TEST_ASSERT(kPrefetchedFrameCount == kSnapshot.controller[kControllerIndex].prefetchHits);
+        TEST_ASSERT(1 == kSnapshot.controller[kControllerIndex].prefetchMisses);
+        TEST_ASSERT((kLearningFrameCount + kPrefetchedFrameCount + 1) == kSnapshot.controller[kControllerIndex].stateReadCount);
+        TEST_ASSERT((kPrefetchedFrameCount * kTestLeadTime) == kSnapshot.controller[kControllerIndex].stateAgeTotalNanoseconds);
+
+        Statistics::Unpublish();
+        scheduler.RemoveTarget(&controller);
+    }
+
+    // Verifies that polling consumes a pending prefetch, reporting a state change exactly once, without reading XInput again.
+    TEST_CASE(PrefetchScheduler_VirtualController_PollConsumesPrefetch)
+    {
+        const Mapper kTestMapper({.buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+        MockClock mockClock;
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+
+        VirtualController controller(0, kTestMapper, std::move(xinputSource), mockClock);
+        LearnCadence(mockClock, controller);
+
+        PrefetchScheduler scheduler(mockClock);
+        scheduler.AddTarget(&controller);
+
+        xinput->SetAllStates({.Gamepad = {.wButtons = XINPUT_GAMEPAD_A}});
+        mockClock.Advance(kTestPeriod - kTestLeadTime);
+        scheduler.RunDuePrefetches();
+        TEST_ASSERT((kLearningFrameCount + 1) == xinput->GetReadCount());
+
+        mockClock.Advance(kTestLeadTime);
+        TEST_ASSERT(true == controller.PollState());
+        TEST_ASSERT(false == controller.PollState());
+        TEST_ASSERT(true == controller.GetState().button[(int)EButton::B1]);
+        TEST_ASSERT((kLearningFrameCount + 1) == xinput->GetReadCount());
+
+        // Once the prefetch has been consumed, polling reads XInput again.
+        mockClock.Advance(kTestPeriod);
+        TEST_ASSERT(false == controller.PollState());
+        TEST_ASSERT((kLearningFrameCount + 2) == xinput->GetReadCount());
+
+        scheduler.RemoveTarget(&controller);
+    }
+
+    // Verifies that a prefetch that the application does not pick up within one period is discarded rather than delivered.
+    TEST_CASE(PrefetchScheduler_VirtualController_StalePrefetch)
+    {
+        const Mapper kTestMapper({.buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+        MockClock mockClock;
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+
+        VirtualController controller(0, kTestMapper, std::move(xinputSource), mockClock);
+        LearnCadence(mockClock, controller);
+
+        PrefetchScheduler scheduler(mockClock);
+        scheduler.AddTarget(&controller);
+
+        mockClock.Advance(kTestPeriod - kTestLeadTime);
+        scheduler.RunDuePrefetches();
+        TEST_ASSERT((kLearningFrameCount + 1) == xinput->GetReadCount());
+
+        mockClock.Advance(kTestPeriod + kTestLeadTime + 1);
+        controller.GetState();
+        TEST_ASSERT((kLearningFrameCount + 2) == xinput->GetReadCount());
+
+        scheduler.RemoveTarget(&controller);
+    }
+
+    // Verifies that a controller set is refreshed as a whole ahead of the application's reads and that reading every controller in the set consumes the prefetched snapshot.
+    TEST_CASE(PrefetchScheduler_ControllerSet_PrefetchSnapshot)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerCount = 4;
+
+        const Mapper kTestMapper({.buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+        MockClock mockClock;
+        std::unique_ptr<MockXInputSource> xinputSource = std::make_unique<MockXInputSource>();
+        MockXInputSource* const xinput = xinputSource.get();
+
+        ControllerSet controllerSet(std::move(xinputSource), kControllerCount, mockClock);
+        for (VirtualController::TControllerIdentifier i = 0; i < kControllerCount; ++i)
+            TEST_ASSERT(nullptr != controllerSet.AddController(std::make_unique<VirtualController>(i, kTestMapper, std::make_unique<MockXInputSource>(), mockClock)));
+
+        PrefetchScheduler scheduler(mockClock);
+        scheduler.AddTarget(&controllerSet);
+
+        for (unsigned int i = 0; i < kLearningFrameCount; ++i)
+        {
+            if (0 != i)
+                mockClock.Advance(kTestPeriod);
+
+            for (VirtualController::TControllerIdentifier j = 0; j < kControllerCount; ++j)
+                controllerSet.GetState(j);
+        }
+
+        TEST_ASSERT((kLearningFrameCount * kControllerCount) == xinput->GetReadCount());
+
+        mockClock.Advance(kTestPeriod - kTestLeadTime);
+        scheduler.RunDuePrefetches();
+        TEST_ASSERT(((kLearningFrameCount + 1) * kControllerCount) == xinput->GetReadCount());
+
+        mockClock.Advance(kTestLeadTime);
+        for (VirtualController::TControllerIdentifier j = 0; j < kControllerCount; ++j)
+            controllerSet.GetState(j);
+
+        TEST_ASSERT(((kLearningFrameCount + 1) * kControllerCount) == xinput->GetReadCount());
+
+        scheduler.RemoveTarget(&controllerSet);
+    }
+
+    // Verifies that targets are prefetched without holding the scheduler lock, so that the set of targets can change while a prefetch is in progress.
+    TEST_CASE(PrefetchScheduler_PrefetchWithoutSchedulerLock)
+    {
+        MockClock mockClock(1000000000ull);
+        PrefetchScheduler scheduler(mockClock);
+        ReentrantPrefetchTarget otherTarget(scheduler, mockClock, nullptr);
+        ReentrantPrefetchTarget target(scheduler, mockClock, &otherTarget);
+
+        scheduler.AddTarget(&target);
+        scheduler.RunDuePrefetches();
+        TEST_ASSERT(1 == target.prefetchCount);
+        TEST_ASSERT(0 == otherTarget.prefetchCount);
+
+        scheduler.RemoveTarget(&target);
+    }
+
+    // Verifies that the background thread can be started and stopped repeatedly.
+    TEST_CASE(PrefetchScheduler_StartStop)
+    {
+        PrefetchScheduler scheduler;
+        TEST_ASSERT(false == scheduler.IsRunning());
+
+        scheduler.Start(kTestLeadTime);
+        TEST_ASSERT(true == scheduler.IsRunning());
+        scheduler.Start(kTestLeadTime);
+        TEST_ASSERT(true == scheduler.IsRunning());
+
+        scheduler.Stop();
+        TEST_ASSERT(false == scheduler.IsRunning());
+        scheduler.Stop();
+
+        scheduler.Start();
+        TEST_ASSERT(true == scheduler.IsRunning());
+    }
+}
@@ -0,0 +1,170 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file ProfilerTest.cpp
+ *   Unit tests for the per-entry-point API call profiler.
+ *****************************************************************************/
+
+#include "Profiler.h"
+#include "TestCase.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Profiler;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Computes the difference between two profiling results for the same entry point and controller slot.
+    /// Other tests may also exercise profiled entry points, so tests compare reports taken before and after instead of absolute values.
+    /// @param [in] before Profiling results taken earlier.
+    /// @param [in] after Profiling results taken later.
+    /// @param [in] entryPoint Entry point of interest.
+    /// @param [in] controllerSlot Controller slot of interest.
+    /// @return Difference in invocation counts, latency totals, and histograms. Maximum latency is taken from the later report.
+    static SInvocationStatistics StatisticsDifference(const SReport& before, const SReport& after, EEntryPoint entryPoint, uint32_t controllerSlot)
+    {
+        const SInvocationStatistics& kBefore = before.entryPoint[(int)entryPoint][controllerSlot];
+        const SInvocationStatistics& kAfter = after.entryPoint[(int)entryPoint][controllerSlot];
+
+        SInvocationStatistics difference = {
+            .count = kAfter.count - kBefore.count,
+            .totalNanoseconds = kAfter.totalNanoseconds - kBefore.totalNanoseconds,
+            .maxNanoseconds = kAfter.maxNanoseconds,
+            .histogram = {}
+        };
+
+        for (uint32_t i = 0; i < kHistogramBucketCount; ++i)
+            difference.histogram[i] = kAfter.histogram[i] - kBefore.histogram[i];
+
+        return difference;
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that latencies are assigned to power-of-two histogram buckets and that very high latencies fall into the last bucket.
+    TEST_CASE(Profiler_HistogramBucketForLatency)
+    {
+        TEST_ASSERT(0 == HistogramBucketForLatency(0));
+        TEST_ASSERT(1 == HistogramBucketForLatency(1));
+        TEST_ASSERT(2 == HistogramBucketForLatency(2));
+        TEST_ASSERT(2 == HistogramBucketForLatency(3));
+        TEST_ASSERT(3 == HistogramBucketForLatency(4));
+        TEST_ASSERT(10 == HistogramBucketForLatency(1023));
+        TEST_ASSERT(11 == HistogramBucketForLatency(1024));
+        TEST_ASSERT((kHistogramBucketCount - 1) == HistogramBucketForLatency(UINT64_MAX));
+    }
+
+    // Verifies that recorded invocations update the count, total, maximum, and histogram for the correct entry point and controller slot only.
+    TEST_CASE(Profiler_RecordInvocation_Counters)
+    {
+        Enable();
+        TEST_ASSERT(true == IsEnabled());
+
+        const SReport kBefore = TakeReport();
+
+        RecordInvocation(EEntryPoint::DirectInputGetDeviceState, 2, 100);
+        RecordInvocation(EEntryPoint::DirectInputGetDeviceState, 2, 5000000);
+        RecordInvocation(EEntryPoint::DirectInputGetDeviceState, 2, 300);
+
+        const SReport kAfter = TakeReport();
+
+        const SInvocationStatistics kDifference = StatisticsDifference(kBefore, kAfter, EEntryPoint::DirectInputGetDeviceState, 2);
+        TEST_ASSERT(3 == kDifference.count);
+        TEST_ASSERT(5000400 == kDifference.totalNanoseconds);
+        TEST_ASSERT(kDifference.maxNanoseconds >= 5000000);
+        TEST_ASSERT(1 == kDifference.histogram[HistogramBucketForLatency(100)]);
+        TEST_ASSERT(1 == kDifference.histogram[HistogramBucketForLatency(300)]);
+        TEST_ASSERT(1 == kDifference.histogram[HistogramBucketForLatency(5000000)]);
+
+        const SInvocationStatistics kOtherSlotDifference = StatisticsDifference(kBefore, kAfter, EEntryPoint::DirectInputGetDeviceState, 1);
+        TEST_ASSERT(0 == kOtherSlotDifference.count);
+    }
+
+    // Verifies that counters recorded by a thread are still reported after that thread exits and are merged with counters recorded by the current thread.
+    TEST_CASE(Profiler_TakeReport_MergeThreads)
+    {
+        Enable();
+
+        const SReport kBefore = TakeReport();
+
+        std::thread recordingThread([]() -> void
+            {
+                RecordInvocation(EEntryPoint::WinMMJoyGetPosEx, 0, 1000);
+                RecordInvocation(EEntryPoint::WinMMJoyGetPosEx, 0, 2000);
+            }
+        );
+        recordingThread.join();
+
+        RecordInvocation(EEntryPoint::WinMMJoyGetPosEx, 0, 4000);
+
+        const SReport kAfter = TakeReport();
+
+        const SInvocationStatistics kDifference = StatisticsDifference(kBefore, kAfter, EEntryPoint::WinMMJoyGetPosEx, 0);
+        TEST_ASSERT(3 == kDifference.count);
+        TEST_ASSERT(7000 == kDifference.totalNanoseconds);
+        TEST_ASSERT(kDifference.maxNanoseconds >= 4000);
+    }
+
+    // Verifies that a scoped invocation is recorded when it goes out of scope and is attributed to the controller most recently set, or to no controller if the identifier is out of range.
+    TEST_CASE(Profiler_ScopedInvocation_SetController)
+    {
+        Enable();
+
+        const SReport kBefore = TakeReport();
+
+        {
+            ScopedInvocation invocation(EEntryPoint::WinMMJoySetThreshold);
+            invocation.SetController(3);
+        }
+
+        {
+            ScopedInvocation invocation(EEntryPoint::WinMMJoySetThreshold, 1);
+            invocation.SetController(kControllerCount + 10);
+        }
+
+        const SReport kAfter = TakeReport();
+
+        TEST_ASSERT(1 == StatisticsDifference(kBefore, kAfter, EEntryPoint::WinMMJoySetThreshold, 3).count);
+        TEST_ASSERT(0 == StatisticsDifference(kBefore, kAfter, EEntryPoint::WinMMJoySetThreshold, 1).count);
+        TEST_ASSERT(1 == StatisticsDifference(kBefore, kAfter, EEntryPoint::WinMMJoySetThreshold, kNoController).count);
+    }
+
+    // Verifies that a startup phase is recorded when its scope ends, that only the first recording of a phase is kept, and that out-of-range phases are ignored.
+    TEST_CASE(Profiler_StartupPhase_Record)
+    {
+        static constexpr EStartupPhase kTestPhase = EStartupPhase::WinMMControllerNames;
+        static constexpr std::chrono::milliseconds kTestDuration = std::chrono::milliseconds(2);
+
+        TEST_ASSERT(false == GetStartupPhaseRecord(kTestPhase).recorded);
+
+        {
+            ScopedStartupPhase startupPhase(kTestPhase);
+            std::this_thread::sleep_for(kTestDuration);
+        }
+
+        const SStartupPhaseRecord kRecord = GetStartupPhaseRecord(kTestPhase);
+        TEST_ASSERT(true == kRecord.recorded);
+        TEST_ASSERT(kRecord.durationNanoseconds >= (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(kTestDuration).count());
+
+        const std::chrono::steady_clock::time_point kNow = std::chrono::steady_clock::now();
+        RecordStartupPhase(kTestPhase, kNow, kNow + std::chrono::seconds(10));
+
+        const SStartupPhaseRecord kRecordAfterRepeat = GetStartupPhaseRecord(kTestPhase);
+        TEST_ASSERT(kRecord.startNanoseconds == kRecordAfterRepeat.startNanoseconds);
+        TEST_ASSERT(kRecord.durationNanoseconds == kRecordAfterRepeat.durationNanoseconds);
+
+        RecordStartupPhase(EStartupPhase::Count, kNow, kNow);
+        TEST_ASSERT(false == GetStartupPhaseRecord(EStartupPhase::Count).recorded);
+    }
+}
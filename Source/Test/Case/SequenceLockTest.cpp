@@ -0,0 +1,231 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SequenceLockTest.cpp
+ *   Unit tests for values protected by a sequence lock.
+ *****************************************************************************/
+
+#include "SequenceLock.h"
+#include "TestCase.h"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Test value made up of many words, all of which a writer sets to the same number, so that a reader can detect a torn read.
+    struct STestValue
+    {
+        uint32_t word[32];
+    };
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Number of reader threads used for the concurrency test.
+    static constexpr unsigned int kTestNumReaders = 4;
+
+    /// Number of writes performed by the writer thread during the concurrency test.
+    static constexpr uint32_t kTestNumWrites = 100000;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Creates a test value whose words are all set to the specified number.
+    /// @param [in] number Number to place in every word.
+    /// @return Test value.
+    static STestValue MakeTestValue(uint32_t number)
+    {
+        STestValue value;
+
+        for (auto& word : value.word)
+            word = number;
+
+        return value;
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a value holds its initial value until it is written, and that each write replaces the value in its entirety.
+    TEST_CASE(SequenceLock_ReadAfterWrite)
+    {
+        SequenceLocked<STestValue> value(MakeTestValue(1));
+
+        for (uint32_t word : value.Read().word)
+            TEST_ASSERT(1 == word);
+
+        for (uint32_t i = 2; i < 10; ++i)
+        {
+            value.Write(MakeTestValue(i));
+
+            for (uint32_t word : value.Read().word)
+                TEST_ASSERT(i == word);
+        }
+    }
+
+    // Verifies that a default-initialized value holds the default value of its type.
+    TEST_CASE(SequenceLock_DefaultInitialValue)
+    {
+        const SequenceLocked<uint64_t> kValue;
+        TEST_ASSERT(0 == kValue.Read());
+    }
+
+    // Verifies that attempting to read a value that has only been initialized reports that it has never been written, and that written values are read in their entirety.
+    TEST_CASE(SequenceLock_TryRead)
+    {
+        SequenceLocked<STestValue> value(MakeTestValue(1));
+        TEST_ASSERT(false == value.TryRead(1).has_value());
+
+        for (uint32_t i = 2; i < 10; ++i)
+        {
+            TEST_ASSERT(true == value.TryWrite(MakeTestValue(i)));
+
+            const std::optional<STestValue> kValue = value.TryRead(1);
+            TEST_ASSERT(true == kValue.has_value());
+            for (uint32_t word : kValue->word)
+                TEST_ASSERT(i == word);
+        }
+    }
+
+    // Verifies that a value placed in zero-filled memory without being constructed has never been written, and that a write interrupted partway through blocks readers and other writers until it is cleared.
+    // This is how values are used in memory shared between processes, any of which could exit in the middle of a write.
+    TEST_CASE(SequenceLock_InterruptedWrite)
+    {
+        alignas(SequenceLocked<STestValue>) uint32_t storage[sizeof(SequenceLocked<STestValue>) / sizeof(uint32_t)] = {};
+        SequenceLocked<STestValue>& value = *reinterpret_cast<SequenceLocked<STestValue>*>(storage);
+        TEST_ASSERT(false == value.TryRead(1).has_value());
+
+        TEST_ASSERT(true == value.TryWrite(MakeTestValue(1)));
+        TEST_ASSERT(true == value.TryRead(1).has_value());
+
+        // The generation number is the first word, and an odd value means that a write is in progress.
+        storage[0] += 1;
+        TEST_ASSERT(false == value.TryRead(4).has_value());
+        TEST_ASSERT(false == value.TryWrite(MakeTestValue(2)));
+
+        value.ClearInterruptedWrite();
+        TEST_ASSERT(true == value.TryWrite(MakeTestValue(3)));
+
+        const std::optional<STestValue> kValue = value.TryRead(1);
+        TEST_ASSERT(true == kValue.has_value());
+        TEST_ASSERT(3 == kValue->word[0]);
+    }
+
+    // Writes a long sequence of values on one thread while other threads read concurrently.
+    // Every value read must be one that was written in its entirety, and values must never appear to go backwards from the point of view of any reader.
+    TEST_CASE(SequenceLock_ConcurrentReadersNeverObserveTornValues)
+    {
+        SequenceLocked<STestValue> value(MakeTestValue(0));
+
+        std::atomic<bool> writerFinished = false;
+        std::atomic<uint64_t> numTornReads = 0;
+        std::atomic<uint64_t> numBackwardReads = 0;
+        std::vector<std::thread> readers;
+
+        for (unsigned int i = 0; i < kTestNumReaders; ++i)
+        {
+            readers.emplace_back([&value, &writerFinished, &numTornReads, &numBackwardReads]() -> void
+            {
+                uint32_t lastNumber = 0;
+
+                while (false == writerFinished)
+                {
+                    const STestValue kValue = value.Read();
+
+                    for (uint32_t word : kValue.word)
+                    {
+                        if (word != kValue.word[0])
+                        {
+                            numTornReads += 1;
+                            break;
+                        }
+                    }
+
+                    if (kValue.word[0] < lastNumber)
+                        numBackwardReads += 1;
+
+                    lastNumber = kValue.word[0];
+                }
+            });
+        }
+
+        for (uint32_t i = 1; i <= kTestNumWrites; ++i)
+            value.Write(MakeTestValue(i));
+
+        writerFinished = true;
+
+        for (auto& reader : readers)
+            reader.join();
+
+        TEST_ASSERT(0 == numTornReads);
+        TEST_ASSERT(0 == numBackwardReads);
+        TEST_ASSERT(kTestNumWrites == value.Read().word[0]);
+    }
+
+    // Attempts writes from several threads at once while other threads read concurrently.
+    // Writes that overlap must give up rather than interleave, so every value read must be one that was written in its entirety.
+    TEST_CASE(SequenceLock_ConcurrentTryWritersNeverTearValues)
+    {
+        SequenceLocked<STestValue> value;
+
+        std::atomic<bool> writersFinished = false;
+        std::atomic<uint64_t> numTornReads = 0;
+        std::vector<std::thread> readers;
+        std::vector<std::thread> writers;
+
+        for (unsigned int i = 0; i < kTestNumReaders; ++i)
+        {
+            readers.emplace_back([&value, &writersFinished, &numTornReads]() -> void
+            {
+                while (false == writersFinished)
+                {
+                    const std::optional<STestValue> kValue = value.TryRead(1);
+                    if (false == kValue.has_value())
+                        continue;
+
+                    for (uint32_t word : kValue->word)
+                    {
+                        if (word != kValue->word[0])
+                        {
+                            numTornReads += 1;
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        for (unsigned int i = 0; i < kTestNumReaders; ++i)
+        {
+            writers.emplace_back([&value, i]() -> void
+            {
+                for (uint32_t j = 0; j < (kTestNumWrites / kTestNumReaders); ++j)
+                    value.TryWrite(MakeTestValue((j * kTestNumReaders) + i));
+            });
+        }
+
+        for (auto& writer : writers)
+            writer.join();
+
+        writersFinished = true;
+
+        for (auto& reader : readers)
+            reader.join();
+
+        TEST_ASSERT(0 == numTornReads);
+    }
+}
@@ -0,0 +1,242 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SharedXInputTest.cpp
+ *   Unit tests for sharing a single poller of controller states among
+ *   several processes.
+ *****************************************************************************/
+
+#include "ApiPlatform.h"
+#include "ApiXInput.h"
+#include "MockClock.h"
+#include "MockSharedMemory.h"
+#include "MockXInputSource.h"
+#include "SharedXInput.h"
+#include "TestCase.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Creates an XInput source that identifies itself and the requested user index in every state it reports.
+    /// The packet number is the tag multiplied by 1000 plus the user index, and the button state is the tag, so tests can tell exactly which process's source served a read.
+    /// @param [in] tag Tag that identifies the source.
+    /// @return Newly-created XInput source.
+    static std::unique_ptr<MockXInputSource> CreateTaggedSource(DWORD tag)
+    {
+        std::unique_ptr<MockXInputSource> source = std::make_unique<MockXInputSource>(XUSER_MAX_COUNT, tag);
+        source->SetAllStates({.Gamepad = {.wButtons = (WORD)tag}});
+        return source;
+    }
+
+    /// Creates an XInput source that identifies itself and the requested user index in every state it reports, and keeps a pointer to it so that tests can check how many times it is read.
+    /// @param [in] tag Tag that identifies the source.
+    /// @param [out] source Filled with a pointer to the newly-created XInput source.
+    /// @return Newly-created XInput source.
+    static std::unique_ptr<MockXInputSource> CreateTaggedSource(DWORD tag, MockXInputSource*& source)
+    {
+        std::unique_ptr<MockXInputSource> newSource = CreateTaggedSource(tag);
+        source = newSource.get();
+        return newSource;
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that the first process to map the segment becomes its owner and that other processes read states polled by the owner without reading their own sources.
+    TEST_CASE(SharedXInput_FirstProcessOwns)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_FirstProcessOwns";
+
+        MockXInputSource* sourceA = nullptr;
+        MockXInputSource* sourceB = nullptr;
+
+        SharedXInput processA(std::make_unique<MockSharedMemory>(), CreateTaggedSource(1, sourceA), 100, kTestSegmentName);
+        SharedXInput processB(std::make_unique<MockSharedMemory>(), CreateTaggedSource(2, sourceB), 200, kTestSegmentName);
+
+        TEST_ASSERT(true == processA.IsShared());
+        TEST_ASSERT(true == processB.IsShared());
+        TEST_ASSERT(true == processA.IsOwner());
+        TEST_ASSERT(false == processB.IsOwner());
+
+        // Taking ownership includes an initial poll, so states are available right away.
+        TEST_ASSERT(SharedXInput::kSlotCount == sourceA->GetReadCount());
+
+        processA.Update();
+        processB.Update();
+        TEST_ASSERT((2 * SharedXInput::kSlotCount) == sourceA->GetReadCount());
+        TEST_ASSERT(0 == sourceB->GetReadCount());
+
+        for (DWORD i = 0; i < SharedXInput::kSlotCount; ++i)
+        {
+            XINPUT_STATE stateA;
+            XINPUT_STATE stateB;
+
+            TEST_ASSERT(ERROR_SUCCESS == processA.GetState(i, &stateA));
+            TEST_ASSERT(ERROR_SUCCESS == processB.GetState(i, &stateB));
+            TEST_ASSERT((1000 + i) == stateA.dwPacketNumber);
+            TEST_ASSERT((1000 + i) == stateB.dwPacketNumber);
+            TEST_ASSERT(1 == stateB.Gamepad.wButtons);
+        }
+
+        TEST_ASSERT((2 * SharedXInput::kSlotCount) == sourceA->GetReadCount());
+        TEST_ASSERT(0 == sourceB->GetReadCount());
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == processB.GetState(SharedXInput::kSlotCount, &state));
+    }
+
+    // Verifies that a process takes over ownership immediately when the owner exits cleanly.
+    TEST_CASE(SharedXInput_Failover_OwnerExits)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_Failover_OwnerExits";
+
+        MockXInputSource* sourceB = nullptr;
+
+        std::unique_ptr<SharedXInput> processA = std::make_unique<SharedXInput>(std::make_unique<MockSharedMemory>(), CreateTaggedSource(1), 100, kTestSegmentName);
+        SharedXInput processB(std::make_unique<MockSharedMemory>(), CreateTaggedSource(2, sourceB), 200, kTestSegmentName);
+        TEST_ASSERT(true == processA->IsOwner());
+
+        processA = nullptr;
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_SUCCESS == processB.GetState(0, &state));
+        TEST_ASSERT(1000 == state.dwPacketNumber);
+
+        processB.Update();
+        TEST_ASSERT(true == processB.IsOwner());
+        TEST_ASSERT(SharedXInput::kSlotCount == sourceB->GetReadCount());
+
+        TEST_ASSERT(ERROR_SUCCESS == processB.GetState(0, &state));
+        TEST_ASSERT(2000 == state.dwPacketNumber);
+    }
+
+    // Verifies that a process takes over ownership immediately when the owner abandons sharing as its process terminates.
+    TEST_CASE(SharedXInput_Failover_OwnerAbandons)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_Failover_OwnerAbandons";
+
+        MockXInputSource* sourceB = nullptr;
+
+        SharedXInput processA(std::make_unique<MockSharedMemory>(), CreateTaggedSource(1), 100, kTestSegmentName);
+        SharedXInput processB(std::make_unique<MockSharedMemory>(), CreateTaggedSource(2, sourceB), 200, kTestSegmentName);
+        TEST_ASSERT(true == processA.IsOwner());
+
+        processA.Abandon();
+        TEST_ASSERT(false == processA.IsOwner());
+        TEST_ASSERT(false == processA.IsRunning());
+
+        processB.Update();
+        TEST_ASSERT(true == processB.IsOwner());
+        TEST_ASSERT(SharedXInput::kSlotCount == sourceB->GetReadCount());
+    }
+
+    // Verifies that a process takes over ownership when the owner stops updating the segment for too long, and that the former owner then stops polling.
+    TEST_CASE(SharedXInput_Failover_OwnerStops)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_Failover_OwnerStops";
+
+        MockXInputSource* sourceA = nullptr;
+        MockXInputSource* sourceB = nullptr;
+
+        MockClock mockClock;
+        SharedXInput processA(std::make_unique<MockSharedMemory>(), CreateTaggedSource(1, sourceA), 100, kTestSegmentName, mockClock);
+        SharedXInput processB(std::make_unique<MockSharedMemory>(), CreateTaggedSource(2, sourceB), 200, kTestSegmentName, mockClock);
+
+        // An owner that keeps updating is never replaced, no matter how much time passes overall.
+        for (int i = 0; i < 4; ++i)
+        {
+            mockClock.Advance(SharedXInput::kOwnerTimeout / 2);
+            processA.Update();
+            processB.Update();
+            TEST_ASSERT(false == processB.IsOwner());
+        }
+
+        mockClock.Advance(SharedXInput::kOwnerTimeout - 1);
+        processB.Update();
+        TEST_ASSERT(false == processB.IsOwner());
+
+        mockClock.Advance(1);
+        processB.Update();
+        TEST_ASSERT(true == processB.IsOwner());
+        TEST_ASSERT(SharedXInput::kSlotCount == sourceB->GetReadCount());
+
+        const unsigned int kReadCountA = sourceA->GetReadCount();
+        processA.Update();
+        TEST_ASSERT(false == processA.IsOwner());
+        TEST_ASSERT(kReadCountA == sourceA->GetReadCount());
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_SUCCESS == processA.GetState(3, &state));
+        TEST_ASSERT(2003 == state.dwPacketNumber);
+    }
+
+    // Verifies that a segment claimed by an incompatible version is not used and that states are instead read directly from the underlying source.
+    TEST_CASE(SharedXInput_IncompatibleSegment)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_IncompatibleSegment";
+
+        MockSharedMemory otherVersionSharedMemory;
+        SharedXInput::SSegment* const kOtherVersionSegment = reinterpret_cast<SharedXInput::SSegment*>(otherVersionSharedMemory.Create(kTestSegmentName, sizeof(SharedXInput::SSegment)));
+        TEST_ASSERT(nullptr != kOtherVersionSegment);
+        kOtherVersionSegment->signature = SharedXInput::kSegmentSignature;
+        kOtherVersionSegment->version = SharedXInput::kSegmentVersion + 1;
+
+        MockXInputSource* source = nullptr;
+        SharedXInput process(std::make_unique<MockSharedMemory>(), CreateTaggedSource(1, source), 100, kTestSegmentName);
+        TEST_ASSERT(false == process.IsShared());
+        TEST_ASSERT(false == process.IsOwner());
+
+        process.Update();
+        TEST_ASSERT(0 == source->GetReadCount());
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_SUCCESS == process.GetState(2, &state));
+        TEST_ASSERT(1002 == state.dwPacketNumber);
+        TEST_ASSERT(1 == source->GetReadCount());
+        TEST_ASSERT(0 == kOtherVersionSegment->ownerProcessId);
+    }
+
+    // Verifies that a new owner recovers slots left in the middle of a write by a previous owner that exited abruptly.
+    TEST_CASE(SharedXInput_Failover_InterruptedWrite)
+    {
+        constexpr std::wstring_view kTestSegmentName = L"SharedXInput_Failover_InterruptedWrite";
+
+        MockSharedMemory crashedOwnerSharedMemory;
+        SharedXInput::SSegment* const kSegment = reinterpret_cast<SharedXInput::SSegment*>(crashedOwnerSharedMemory.Create(kTestSegmentName, sizeof(SharedXInput::SSegment)));
+        TEST_ASSERT(nullptr != kSegment);
+        kSegment->signature = SharedXInput::kSegmentSignature;
+        kSegment->version = SharedXInput::kSegmentVersion;
+        kSegment->ownerProcessId = 100;
+
+        // The generation number is the first word of each slot, and an odd value means that a write is in progress.
+        reinterpret_cast<std::atomic<uint32_t>*>(&kSegment->slot[1])->store(7);
+
+        MockClock mockClock;
+        SharedXInput process(std::make_unique<MockSharedMemory>(), CreateTaggedSource(2), 200, kTestSegmentName, mockClock);
+        TEST_ASSERT(false == process.IsOwner());
+
+        XINPUT_STATE state;
+        TEST_ASSERT(ERROR_DEVICE_NOT_CONNECTED == process.GetState(1, &state));
+
+        mockClock.Advance(SharedXInput::kOwnerTimeout);
+        process.Update();
+        TEST_ASSERT(true == process.IsOwner());
+
+        TEST_ASSERT(ERROR_SUCCESS == process.GetState(1, &state));
+        TEST_ASSERT(2001 == state.dwPacketNumber);
+        TEST_ASSERT(true == kSegment->slot[1].value.TryRead(1).has_value());
+    }
+}
@@ -29,18 +29,18 @@ namespace XidiTest
         {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 1122}},
         {.element = {.type = EElementType::Button, .button = EButton::B2}, .value = {.button = true}},
         {.element = {.type = EElementType::Axis,   .axis = EAxis::Y},      .value = {.axis = 3344}},
-        {.element = {.type = EElementType::Pov},                           .value = {.povDirection = {false, true, false, false}}},
+        {.element = {.type = EElementType::Pov,    .axis = (EAxis)0},      .value = {.povDirection = {false, true, false, false}}},
         {.element = {.type = EElementType::Button, .button = EButton::B7}, .value = {.button = true}},
         {.element = {.type = EElementType::Button, .button = EButton::B2}, .value = {.button = false}},
-        {.element = {.type = EElementType::Pov},                           .value = {.povDirection = {false, false, false, false}}},
+        {.element = {.type = EElementType::Pov,    .axis = (EAxis)0},      .value = {.povDirection = {false, false, false, false}}},
         {.element = {.type = EElementType::Axis,   .axis = EAxis::Z},      .value = {.axis = 5555}},
-        {.element = {.type = EElementType::Pov},                           .value = {.povDirection = {false, false, false, true}}},
+        {.element = {.type = EElementType::Pov,    .axis = (EAxis)0},      .value = {.povDirection = {false, false, false, true}}},
         {.element = {.type = EElementType::Button, .button = EButton::B1}, .value = {.button = true}},
         {.element = {.type = EElementType::Button, .button = EButton::B1}, .value = {.button = false}},
         {.element = {.type = EElementType::Axis,   .axis = EAxis::RotZ},   .value = {.axis = 6677}},
         {.element = {.type = EElementType::Axis,   .axis = EAxis::RotY},   .value = {.axis = 8888}},
         {.element = {.type = EElementType::Axis,   .axis = EAxis::RotX},   .value = {.axis = 9990}},
-        {.element = {.type = EElementType::Pov},                           .value = {.povDirection = {false, false, false, false}}},
+        {.element = {.type = EElementType::Pov,    .axis = (EAxis)0},      .value = {.povDirection = {false, false, false, false}}},
         {.element = {.type = EElementType::Button, .button = EButton::B7}, .value = {.button = false}},
     };
 
@@ -66,10 +66,10 @@ namespace XidiTest
         TEST_ASSERT(0 == testEventBuffer.GetCount());
 
         int64_t lastSequenceSeen = INT64_MIN;
-        for (int i = 0; i < kTestRepeatTimes; ++i)
+        for (unsigned int i = 0; i < kTestRepeatTimes; ++i)
         {
             // First add events, one after another, ensuring that the count increments each time.
-            for (int j = 0; j < _countof(kTestEventData); ++j)
+            for (unsigned int j = 0; j < _countof(kTestEventData); ++j)
             {
                 testEventBuffer.AppendEvent(kTestEventData[j], kTimestamp);
                 TEST_ASSERT((j + 1) == testEventBuffer.GetCount());
@@ -77,7 +77,7 @@ namespace XidiTest
             }
 
             // Next examine events without removing them.
-            for (int j = 0; j < _countof(kTestEventData); ++j)
+            for (unsigned int j = 0; j < _countof(kTestEventData); ++j)
             {
                 TEST_ASSERT(kTestEventData[j] == testEventBuffer[j].data);
                 TEST_ASSERT(kTimestamp == testEventBuffer[j].timestamp);
@@ -87,7 +87,7 @@ namespace XidiTest
 
             // Finally remove events one at a time, ensuring the count decrements each time and that the event removed is actually the oldest one.
             testEventBuffer.PopOldestEvents(1);
-            for (int j = 1; j < _countof(kTestEventData); ++j)
+            for (unsigned int j = 1; j < _countof(kTestEventData); ++j)
             {
                 TEST_ASSERT((_countof(kTestEventData) - j) == testEventBuffer.GetCount());
                 TEST_ASSERT(kTestEventData[j] == testEventBuffer[0].data);
@@ -120,7 +120,7 @@ namespace XidiTest
         TEST_ASSERT(_countof(kTestEventData) == testEventBuffer.GetCount());
         TEST_ASSERT(false == testEventBuffer.IsOverflowed());
 
-        for (int i = 0; i < _countof(kTestEventData); ++i)
+        for (unsigned int i = 0; i < _countof(kTestEventData); ++i)
             TEST_ASSERT(kTestEventData[i] == testEventBuffer[i].data);
     }
 
@@ -142,7 +142,7 @@ namespace XidiTest
         TEST_ASSERT(_countof(kTestEventData) == testEventBuffer.GetCount());
         TEST_ASSERT(false == testEventBuffer.IsOverflowed());
 
-        for (int i = 0; i < _countof(kTestEventData); ++i)
+        for (unsigned int i = 0; i < _countof(kTestEventData); ++i)
             TEST_ASSERT(kTestEventData[i] == testEventBuffer[i].data);
     }
 
@@ -165,7 +165,7 @@ namespace XidiTest
         TEST_ASSERT(kActualEventCount == kExpectedEventCount);
 
         // Check the events themselves. The contents of the buffer should be the most-recently-appended events.
-        for (int i = 0; i < kExpectedEventCount; ++i)
+        for (unsigned int i = 0; i < kExpectedEventCount; ++i)
         {
             const int kEventIndex = (_countof(kTestEventData) - kExpectedEventCount) + i;
             TEST_ASSERT(testEventBuffer[i].data == kTestEventData[kEventIndex]);
@@ -193,7 +193,7 @@ namespace XidiTest
         const uint32_t kActualEventCount = testEventBuffer.GetCount();
         TEST_ASSERT(kActualEventCount == kExpectedEventCount);
 
-        for (int i = 0; i < kExpectedEventCount; ++i)
+        for (unsigned int i = 0; i < kExpectedEventCount; ++i)
         {
             const int kEventIndex = (_countof(kTestEventData) - kExpectedEventCount) + i;
             TEST_ASSERT(testEventBuffer[i].data == kTestEventData[kEventIndex]);
@@ -283,4 +283,190 @@ namespace XidiTest
         testEventBuffer.SetCapacity(0);
         TEST_ASSERT(false == testEventBuffer.IsEnabled());
     }
+
+    // Verifies that, under the axis coalescing policy, axis events are merged with pending events for the same axis at the end of the buffer.
+    // The merged event should carry the newest value and sequence number and should move to the end of the buffer so that sequence numbers remain in order.
+    TEST_CASE(StateChangeEventBuffer_CoalesceAxes_MergeTrailing)
+    {
+        constexpr StateChangeEventBuffer::SEventData kEventAxisX1 = {.element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = 100}};
+        constexpr StateChangeEventBuffer::SEventData kEventAxisY = {.element = {.type = EElementType::Axis, .axis = EAxis::Y}, .value = {.axis = 200}};
+        constexpr StateChangeEventBuffer::SEventData kEventAxisX2 = {.element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = 300}};
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(16);
+        testEventBuffer.SetOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes);
+
+        testEventBuffer.AppendEvent(kEventAxisX1, kTimestamp);
+        testEventBuffer.AppendEvent(kEventAxisY, kTimestamp);
+        const uint32_t kSequenceAxisY = testEventBuffer[1].sequence;
+        testEventBuffer.AppendEvent(kEventAxisX2, kTimestamp + 1);
+
+        TEST_ASSERT(2 == testEventBuffer.GetCount());
+        TEST_ASSERT(false == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(kEventAxisY == testEventBuffer[0].data);
+        TEST_ASSERT(kEventAxisX2 == testEventBuffer[1].data);
+        TEST_ASSERT((kTimestamp + 1) == testEventBuffer[1].timestamp);
+        TEST_ASSERT(testEventBuffer[1].sequence > kSequenceAxisY);
+    }
+
+    // Verifies that, under the axis coalescing policy, axis events are not merged across an intervening button or POV event.
+    // Doing so would change the order in which the application observes the button or POV transition relative to the axis motion.
+    TEST_CASE(StateChangeEventBuffer_CoalesceAxes_NoMergeAcrossButton)
+    {
+        constexpr StateChangeEventBuffer::SEventData kTestEvents[] = {
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 100}},
+            {.element = {.type = EElementType::Button, .button = EButton::B1}, .value = {.button = true}},
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 200}},
+            {.element = {.type = EElementType::Pov,    .axis = (EAxis)0},      .value = {.povDirection = {true, false, false, false}}},
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 300}},
+        };
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(16);
+        testEventBuffer.SetOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes);
+
+        for (const auto& testEvent : kTestEvents)
+            testEventBuffer.AppendEvent(testEvent, kTimestamp);
+
+        TEST_ASSERT(_countof(kTestEvents) == testEventBuffer.GetCount());
+        for (unsigned int i = 0; i < _countof(kTestEvents); ++i)
+            TEST_ASSERT(kTestEvents[i] == testEventBuffer[i].data);
+    }
+
+    // Verifies that, under the axis coalescing policy, overflow discards the oldest axis event rather than the oldest event overall.
+    // Button and POV events are discarded only if the buffer contains no axis events at all.
+    TEST_CASE(StateChangeEventBuffer_CoalesceAxes_OverflowPreservesButtons)
+    {
+        constexpr StateChangeEventBuffer::SEventData kTestEvents[] = {
+            {.element = {.type = EElementType::Button, .button = EButton::B1}, .value = {.button = true}},
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 100}},
+            {.element = {.type = EElementType::Button, .button = EButton::B2}, .value = {.button = true}},
+            {.element = {.type = EElementType::Button, .button = EButton::B3}, .value = {.button = true}},
+            {.element = {.type = EElementType::Button, .button = EButton::B4}, .value = {.button = true}},
+        };
+
+        // Capacity of 4 means 3 events can be stored.
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(4);
+        testEventBuffer.SetOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes);
+
+        for (int i = 0; i < 4; ++i)
+            testEventBuffer.AppendEvent(kTestEvents[i], kTimestamp);
+
+        // Axis event should have been discarded to make room for the fourth event.
+        TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(3 == testEventBuffer.GetCount());
+        TEST_ASSERT(kTestEvents[0] == testEventBuffer[0].data);
+        TEST_ASSERT(kTestEvents[2] == testEventBuffer[1].data);
+        TEST_ASSERT(kTestEvents[3] == testEventBuffer[2].data);
+
+        // No axis events remain, so the oldest button event is discarded next.
+        testEventBuffer.AppendEvent(kTestEvents[4], kTimestamp);
+        TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(3 == testEventBuffer.GetCount());
+        TEST_ASSERT(kTestEvents[2] == testEventBuffer[0].data);
+        TEST_ASSERT(kTestEvents[3] == testEventBuffer[1].data);
+        TEST_ASSERT(kTestEvents[4] == testEventBuffer[2].data);
+    }
+
+    // Verifies that, under the axis coalescing policy, shrinking the buffer discards axis events before any button or POV event, just like overflow does.
+    TEST_CASE(StateChangeEventBuffer_CoalesceAxes_ShrinkPreservesButtons)
+    {
+        constexpr StateChangeEventBuffer::SEventData kTestEvents[] = {
+            {.element = {.type = EElementType::Button, .button = EButton::B1}, .value = {.button = true}},
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::X},      .value = {.axis = 100}},
+            {.element = {.type = EElementType::Button, .button = EButton::B2}, .value = {.button = true}},
+            {.element = {.type = EElementType::Axis,   .axis = EAxis::Y},      .value = {.axis = 200}},
+            {.element = {.type = EElementType::Button, .button = EButton::B3}, .value = {.button = true}},
+        };
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(16);
+        testEventBuffer.SetOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes);
+
+        for (const auto& testEvent : kTestEvents)
+            testEventBuffer.AppendEvent(testEvent, kTimestamp);
+
+        TEST_ASSERT(false == testEventBuffer.IsOverflowed());
+
+        // Capacity of 4 means 3 events can be stored, so both axis events are discarded and all button events remain.
+        testEventBuffer.SetCapacity(4);
+        TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(4 == testEventBuffer.GetCapacity());
+        TEST_ASSERT(3 == testEventBuffer.GetCount());
+        TEST_ASSERT(kTestEvents[0] == testEventBuffer[0].data);
+        TEST_ASSERT(kTestEvents[2] == testEventBuffer[1].data);
+        TEST_ASSERT(kTestEvents[4] == testEventBuffer[2].data);
+
+        // No axis events remain, so the oldest button event is discarded next.
+        testEventBuffer.SetCapacity(3);
+        TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(2 == testEventBuffer.GetCount());
+        TEST_ASSERT(kTestEvents[2] == testEventBuffer[0].data);
+        TEST_ASSERT(kTestEvents[4] == testEventBuffer[1].data);
+    }
+
+    // Verifies that, under the axis coalescing policy, a continuous stream of axis events for a few axes never overflows the buffer and never displaces button events.
+    TEST_CASE(StateChangeEventBuffer_CoalesceAxes_HeavyAnalogTraffic)
+    {
+        constexpr StateChangeEventBuffer::SEventData kButtonEvent = {.element = {.type = EElementType::Button, .button = EButton::B5}, .value = {.button = true}};
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(8);
+        testEventBuffer.SetOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes);
+        testEventBuffer.AppendEvent(kButtonEvent, kTimestamp);
+
+        for (int32_t i = 0; i < 1000; ++i)
+        {
+            testEventBuffer.AppendEvent({.element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = i}}, kTimestamp);
+            testEventBuffer.AppendEvent({.element = {.type = EElementType::Axis, .axis = EAxis::Y}, .value = {.axis = -i}}, kTimestamp);
+        }
+
+        TEST_ASSERT(false == testEventBuffer.IsOverflowed());
+        TEST_ASSERT(3 == testEventBuffer.GetCount());
+        TEST_ASSERT(kButtonEvent == testEventBuffer[0].data);
+        TEST_ASSERT(999 == testEventBuffer[1].data.value.axis);
+        TEST_ASSERT(-999 == testEventBuffer[2].data.value.axis);
+        TEST_ASSERT(testEventBuffer[1].sequence < testEventBuffer[2].sequence);
+    }
+
+    // Verifies that sequence numbers reserved as a block are contiguous, that consecutive reservations follow each other, and that appended events carry the sequence numbers they are given.
+    TEST_CASE(StateChangeEventBuffer_ReserveSequenceNumbers)
+    {
+        const uint32_t kFirstBlock = StateChangeEventBuffer::ReserveSequenceNumbers(5);
+        const uint32_t kSecondBlock = StateChangeEventBuffer::ReserveSequenceNumbers(3);
+        TEST_ASSERT((kFirstBlock + 5) == kSecondBlock);
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(16);
+
+        for (uint32_t i = 0; i < 3; ++i)
+            testEventBuffer.AppendEvent(kTestEventData[i], kTimestamp, kSecondBlock + i);
+
+        testEventBuffer.AppendEvent(kTestEventData[3], kTimestamp);
+
+        for (uint32_t i = 0; i < 3; ++i)
+            TEST_ASSERT((kSecondBlock + i) == testEventBuffer[i].sequence);
+
+        TEST_ASSERT((kSecondBlock + 3) == testEventBuffer[3].sequence);
+    }
+
+    // Verifies that nanosecond event timestamps are converted to the millisecond timestamps that DirectInput applications expect, including wrapping around after ~50 days.
+    TEST_CASE(StateChangeEventBuffer_MillisecondTimestamp)
+    {
+        constexpr uint64_t kNanosecondsPerMillisecond = 1000000ull;
+        constexpr uint64_t kTestTimestamps[] = {0, 999999, 1000000, 2500000123, ((uint64_t)UINT32_MAX + 1 + 42) * kNanosecondsPerMillisecond};
+        constexpr uint32_t kExpectedMilliseconds[] = {0, 0, 1, 2500, 42};
+        static_assert(_countof(kTestTimestamps) == _countof(kExpectedMilliseconds), L"Mismatch between number of timestamps and number of expected millisecond values.");
+
+        StateChangeEventBuffer testEventBuffer;
+        testEventBuffer.SetCapacity(16);
+
+        for (unsigned int i = 0; i < _countof(kTestTimestamps); ++i)
+        {
+            testEventBuffer.AppendEvent(kTestEventData[i], kTestTimestamps[i]);
+            TEST_ASSERT(kTestTimestamps[i] == testEventBuffer[i].timestamp);
+            TEST_ASSERT(kExpectedMilliseconds[i] == testEventBuffer[i].GetMillisecondTimestamp());
+        }
+    }
 }
@@ -0,0 +1,177 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file StatisticsTest.cpp
+ *   Unit tests for live statistics exported to shared memory.
+ *****************************************************************************/
+
+#include "ApiXInput.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockSharedMemory.h"
+#include "MockXInput.h"
+#include "Statistics.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+
+#include <cstdint>
+#include <memory>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::Statistics;
+    using ::Xidi::Controller::ButtonMapper;
+    using ::Xidi::Controller::EButton;
+    using ::Xidi::Controller::Mapper;
+    using ::Xidi::Controller::VirtualController;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Opens the statistics segment published under the specified PID using a separate mock shared memory object, as an external monitor would.
+    /// @param [in] readerSharedMemory Mock shared memory object to use for opening the segment.
+    /// @param [in] processId PID under which the segment was published.
+    /// @return Validated statistics segment, or `nullptr` if it could not be opened or is not valid.
+    static const SSegment* OpenPublishedSegment(MockSharedMemory& readerSharedMemory, uint32_t processId)
+    {
+        return ValidateSegment(readerSharedMemory.Open(SegmentName(processId), sizeof(SSegment)), sizeof(SSegment));
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that a published segment is visible through a second view of the same memory and carries a valid header.
+    TEST_CASE(Statistics_Publish_Header)
+    {
+        constexpr uint32_t kProcessId = 1001;
+
+        MockSharedMemory readerSharedMemory;
+        TEST_ASSERT(nullptr == OpenPublishedSegment(readerSharedMemory, kProcessId));
+
+        TEST_ASSERT(true == Publish(std::make_unique<MockSharedMemory>(), kProcessId));
+
+        const SSegment* const kSegment = OpenPublishedSegment(readerSharedMemory, kProcessId);
+        TEST_ASSERT(nullptr != kSegment);
+        TEST_ASSERT(kSegmentVersion == kSegment->version);
+        TEST_ASSERT(sizeof(SSegment) == kSegment->size);
+        TEST_ASSERT(kProcessId == kSegment->processId);
+
+        Unpublish();
+    }
+
+    // Verifies that memory which does not hold a statistics segment of the expected layout is rejected.
+    TEST_CASE(Statistics_ValidateSegment_Invalid)
+    {
+        SSegment segment = {};
+        TEST_ASSERT(nullptr == ValidateSegment(&segment, sizeof(segment)));
+
+        segment.signature = kSegmentSignature;
+        segment.version = kSegmentVersion;
+        segment.size = sizeof(segment);
+        TEST_ASSERT(&segment == ValidateSegment(&segment, sizeof(segment)));
+        TEST_ASSERT(nullptr == ValidateSegment(&segment, sizeof(segment) - 1));
+        TEST_ASSERT(nullptr == ValidateSegment(nullptr, sizeof(segment)));
+
+        segment.version = kSegmentVersion + 1;
+        TEST_ASSERT(nullptr == ValidateSegment(&segment, sizeof(segment)));
+
+        segment.version = kSegmentVersion;
+        segment.size = sizeof(segment) - 8;
+        TEST_ASSERT(nullptr == ValidateSegment(&segment, sizeof(segment)));
+    }
+
+    // Verifies that each recording function updates the expected counters and that recording is ignored while no segment is published.
+    TEST_CASE(Statistics_Record_Counters)
+    {
+        constexpr uint32_t kProcessId = 1002;
+
+        RecordApiCall(EApiCall::WinMMJoyGetPosEx);
+        RecordRefresh(0);
+
+        TEST_ASSERT(true == Publish(std::make_unique<MockSharedMemory>(), kProcessId));
+
+        RecordApiCall(EApiCall::DirectInputGetDeviceState);
+        RecordApiCall(EApiCall::DirectInputGetDeviceState);
+        RecordApiCall(EApiCall::DirectInputGetDeviceData);
+        RecordXInputRead(0, 100);
+        RecordXInputRead(0, 300);
+        RecordXInputRead(0, 200);
+        RecordEvents(1, 5, 2);
+        RecordLockContention(2);
+        RecordRefresh(3);
+        RecordRefresh(3);
+        RecordRefresh(kControllerCount);
+        RecordPrefetch(0);
+        RecordStateRead(0, 1000, EPrefetchOutcome::Hit);
+        RecordStateRead(0, 500, EPrefetchOutcome::Miss);
+        RecordStateRead(0, 0, EPrefetchOutcome::NotPredicted);
+
+        MockSharedMemory readerSharedMemory;
+        const SSegment* const kSegment = OpenPublishedSegment(readerSharedMemory, kProcessId);
+        TEST_ASSERT(nullptr != kSegment);
+
+        const SSnapshot kSnapshot = ReadSnapshot(*kSegment);
+        TEST_ASSERT(2 == kSnapshot.apiCalls[(int)EApiCall::DirectInputGetDeviceState]);
+        TEST_ASSERT(1 == kSnapshot.apiCalls[(int)EApiCall::DirectInputGetDeviceData]);
+        TEST_ASSERT(0 == kSnapshot.apiCalls[(int)EApiCall::WinMMJoyGetPosEx]);
+        TEST_ASSERT(3 == kSnapshot.controller[0].xinputReadCount);
+        TEST_ASSERT(600 == kSnapshot.controller[0].xinputLatencyTotalNanoseconds);
+        TEST_ASSERT(300 == kSnapshot.controller[0].xinputLatencyMaxNanoseconds);
+        TEST_ASSERT(0 == kSnapshot.controller[0].refreshCount);
+        TEST_ASSERT(5 == kSnapshot.controller[1].eventsAppended);
+        TEST_ASSERT(2 == kSnapshot.controller[1].eventsDropped);
+        TEST_ASSERT(1 == kSnapshot.controller[2].lockContentions);
+        TEST_ASSERT(2 == kSnapshot.controller[3].refreshCount);
+        TEST_ASSERT(1 == kSnapshot.controller[0].prefetchCount);
+        TEST_ASSERT(1 == kSnapshot.controller[0].prefetchHits);
+        TEST_ASSERT(1 == kSnapshot.controller[0].prefetchMisses);
+        TEST_ASSERT(3 == kSnapshot.controller[0].stateReadCount);
+        TEST_ASSERT(1500 == kSnapshot.controller[0].stateAgeTotalNanoseconds);
+
+        Unpublish();
+    }
+
+    // Verifies that a virtual controller records its refreshes, XInput reads, and buffered events, including events discarded because the event buffer overflowed.
+    TEST_CASE(Statistics_VirtualController_Events)
+    {
+        constexpr uint32_t kProcessId = 1003;
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 1;
+
+        const Mapper kTestMapper({.buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 2, .Gamepad = {.wButtons = 0}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 3, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 4, .Gamepad = {.wButtons = 0}})}
+        });
+
+        TEST_ASSERT(true == Publish(std::make_unique<MockSharedMemory>(), kProcessId));
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
+        TEST_ASSERT(true == controller.SetEventBufferCapacity(3));
+
+        for (int i = 0; i < 4; ++i)
+            TEST_ASSERT(true == controller.RefreshState());
+
+        MockSharedMemory readerSharedMemory;
+        const SSegment* const kSegment = OpenPublishedSegment(readerSharedMemory, kProcessId);
+        TEST_ASSERT(nullptr != kSegment);
+
+        const SSnapshot kSnapshot = ReadSnapshot(*kSegment);
+        TEST_ASSERT(4 == kSnapshot.controller[kControllerIndex].refreshCount);
+        TEST_ASSERT(4 == kSnapshot.controller[kControllerIndex].xinputReadCount);
+        TEST_ASSERT(4 == kSnapshot.controller[kControllerIndex].eventsAppended);
+        TEST_ASSERT(2 == kSnapshot.controller[kControllerIndex].eventsDropped);
+        TEST_ASSERT(controller.GetEventBufferCount() == (kSnapshot.controller[kControllerIndex].eventsAppended - kSnapshot.controller[kControllerIndex].eventsDropped));
+
+        Unpublish();
+    }
+}
@@ -0,0 +1,396 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SyntheticXInputTest.cpp
+ *   Tests for the synthetic XInput load generator, along with a multi-threaded
+ *   stress driver that uses it to exercise virtual controllers.
+ *****************************************************************************/
+
+#include "ApiDirectInput.h"
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "DataFormat.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "SyntheticXInput.h"
+#include "TestCase.h"
+#include "VirtualController.h"
+#include "VirtualDirectInputDevice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <xinput.h>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi;
+    using ::Xidi::Controller::AxisMapper;
+    using ::Xidi::Controller::ButtonMapper;
+    using ::Xidi::Controller::EAxis;
+    using ::Xidi::Controller::EButton;
+    using ::Xidi::Controller::EPovDirection;
+    using ::Xidi::Controller::Mapper;
+    using ::Xidi::Controller::PovMapper;
+    using ::Xidi::Controller::SState;
+    using ::Xidi::Controller::VirtualController;
+
+
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Data packet structure definition used by the stress driver.
+    struct SStressDataPacket
+    {
+        TAxisValue axis[4];
+        EPovValue pov;
+        TButtonValue button[12];
+    };
+    static_assert(0 == (sizeof(SStressDataPacket) % 4), L"Test data packet size must be divisible by 4.");
+
+    /// Holds the results of running one type of operation under the stress driver.
+    struct SStressResult
+    {
+        const wchar_t* operationName;                                       ///< Name of the operation, used for reporting.
+        uint64_t numCalls;                                                  ///< Total number of calls made across all threads.
+        uint64_t numFailures;                                               ///< Number of calls that returned an unexpected result.
+        uint64_t numOverflows;                                              ///< Number of calls that reported an event buffer overflow.
+        std::vector<uint32_t> latencyNanoseconds;                           ///< Latency samples from all threads, one per call.
+    };
+
+    /// Possible outcomes of a single stress driver operation.
+    enum class EStressOutcome : uint8_t
+    {
+        Success,
+        Overflow,
+        Failure
+    };
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Test value of controller identifier used throughout these test cases.
+    static constexpr VirtualController::TControllerIdentifier kTestControllerIdentifier = 0;
+
+    /// Number of calls to make for the deterministic test cases.
+    static constexpr unsigned int kTestNumCalls = 1000;
+
+    /// Amount of time for which the stress driver runs each load profile.
+    static constexpr std::chrono::milliseconds kStressDuration = std::chrono::milliseconds(250);
+
+    /// Number of threads the stress driver uses for each type of operation.
+    static constexpr unsigned int kStressThreadsPerOperation = 2;
+
+    /// Event buffer capacity used by the stress driver. Deliberately small so that overflows are likely under heavy load.
+    static constexpr DWORD kStressEventBufferCapacity = 64;
+
+    /// Number of events retrieved per call to GetDeviceData by the stress driver.
+    static constexpr DWORD kStressEventsPerRead = 16;
+
+    /// Test mapper used by the stress driver. Contains 4 axes, a POV, and 12 buttons, and matches the layout of #SStressDataPacket.
+    static const Mapper kTestMapper({
+        .stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+        .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+        .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
+        .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
+        .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
+        .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
+        .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
+        .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
+        .triggerLT = std::make_unique<ButtonMapper>(EButton::B7),
+        .triggerRT = std::make_unique<ButtonMapper>(EButton::B8),
+        .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+        .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
+        .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
+        .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
+        .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
+        .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
+        .buttonBack = std::make_unique<ButtonMapper>(EButton::B9),
+        .buttonStart = std::make_unique<ButtonMapper>(EButton::B10),
+        .buttonLS = std::make_unique<ButtonMapper>(EButton::B11),
+        .buttonRS = std::make_unique<ButtonMapper>(EButton::B12)
+    });
+
+    /// Object format specification for #SStressDataPacket.
+    static DIOBJECTDATAFORMAT stressObjectFormatSpec[] = {
+        {.pguid = &GUID_XAxis,  .dwOfs = offsetof(SStressDataPacket, axis[0]),    .dwType = DIDFT_AXIS   | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_YAxis,  .dwOfs = offsetof(SStressDataPacket, axis[1]),    .dwType = DIDFT_AXIS   | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_ZAxis,  .dwOfs = offsetof(SStressDataPacket, axis[2]),    .dwType = DIDFT_AXIS   | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_RzAxis, .dwOfs = offsetof(SStressDataPacket, axis[3]),    .dwType = DIDFT_AXIS   | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_POV,    .dwOfs = offsetof(SStressDataPacket, pov),        .dwType = DIDFT_POV    | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[0]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[1]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[2]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[3]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[4]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[5]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[6]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[7]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[8]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[9]),  .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[10]), .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0},
+        {.pguid = &GUID_Button, .dwOfs = offsetof(SStressDataPacket, button[11]), .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE, .dwFlags = 0}
+    };
+
+    /// Complete application data format specification for #SStressDataPacket.
+    static constexpr DIDATAFORMAT kStressFormatSpec = {
+        .dwSize = sizeof(DIDATAFORMAT),
+        .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+        .dwFlags = DIDF_ABSAXIS,
+        .dwDataSize = sizeof(SStressDataPacket),
+        .dwNumObjs = _countof(stressObjectFormatSpec),
+        .rgodf = stressObjectFormatSpec
+    };
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Runs a single operation repeatedly on multiple threads for the stress duration and collects the results.
+    /// All threads are released at the same time so that they contend with each other for as much of the run as possible.
+    /// @param [in] operationName Name of the operation, used for reporting.
+    /// @param [in] operation Operation to run. Must be concurrency-safe.
+    /// @param [in,out] startFlag Flag that all threads wait on before starting. Set by the caller once all operations have been launched.
+    /// @param [out] threads Threads that are created are appended to this vector.
+    /// @param [out] result Result object to be filled once all threads have finished. Must outlive the threads.
+    static void LaunchStressOperation(const wchar_t* operationName, std::function<EStressOutcome(void)> operation, const std::atomic<bool>& startFlag, std::vector<std::thread>& threads, SStressResult& result)
+    {
+        static std::mutex resultMutex;
+
+        result = {.operationName = operationName, .numCalls = 0, .numFailures = 0, .numOverflows = 0, .latencyNanoseconds = {}};
+
+        for (unsigned int i = 0; i < kStressThreadsPerOperation; ++i)
+        {
+            threads.emplace_back([operation, &startFlag, &result]() -> void
+            {
+                std::vector<uint32_t> latencyNanoseconds;
+                uint64_t numFailures = 0;
+                uint64_t numOverflows = 0;
+
+                latencyNanoseconds.reserve(1 << 20);
+
+                while (false == startFlag)
+                    std::this_thread::yield();
+
+                const auto kStopTime = std::chrono::steady_clock::now() + kStressDuration;
+                auto callStartTime = std::chrono::steady_clock::now();
+
+                while (callStartTime < kStopTime)
+                {
+                    const EStressOutcome kOutcome = operation();
+                    const auto kCallEndTime = std::chrono::steady_clock::now();
+
+                    switch (kOutcome)
+                    {
+                    case EStressOutcome::Overflow:
+                        numOverflows += 1;
+                        break;
+
+                    case EStressOutcome::Failure:
+                        numFailures += 1;
+                        break;
+
+                    default:
+                        break;
+                    }
+
+                    latencyNanoseconds.push_back((uint32_t)std::min<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(kCallEndTime - callStartTime).count(), UINT32_MAX));
+                    callStartTime = kCallEndTime;
+                }
+
+                std::scoped_lock lock(resultMutex);
+                result.numCalls += latencyNanoseconds.size();
+                result.numFailures += numFailures;
+                result.numOverflows += numOverflows;
+                result.latencyNanoseconds.insert(result.latencyNanoseconds.end(), latencyNanoseconds.begin(), latencyNanoseconds.end());
+            });
+        }
+    }
+
+    /// Prints a summary of the results of a stress driver operation, including throughput and tail latency.
+    /// Sorts the latency samples in the process.
+    /// @param [in,out] result Result object to summarize.
+    static void PrintStressResult(SStressResult& result)
+    {
+        if (true == result.latencyNanoseconds.empty())
+        {
+            PrintFormatted(L"    %-16s no calls completed", result.operationName);
+            return;
+        }
+
+        std::sort(result.latencyNanoseconds.begin(), result.latencyNanoseconds.end());
+
+        const auto kPercentile = [&result](double percentile) -> uint32_t
+        {
+            return result.latencyNanoseconds[(size_t)((double)(result.latencyNanoseconds.size() - 1) * percentile)];
+        };
+
+        const double kCallsPerSecond = (double)result.numCalls / std::chrono::duration<double>(kStressDuration).count();
+        PrintFormatted(L"    %-16s %10.0f calls/sec, latency ns p50=%u p99=%u p99.9=%u max=%u, overflows=%llu, failures=%llu", result.operationName, kCallsPerSecond, kPercentile(0.50), kPercentile(0.99), kPercentile(0.999), result.latencyNanoseconds.back(), (unsigned long long)result.numOverflows, (unsigned long long)result.numFailures);
+    }
+
+    /// Runs the stress driver against a single synthetic load profile.
+    /// Concurrently exercises the DirectInput GetDeviceState and GetDeviceData paths on one virtual controller and the WinMM JoyGetPosEx path on another, each backed by its own synthetic XInput instance with the same profile.
+    /// The WinMM wrapper owns its controllers internally, so the JoyGetPosEx path is represented by the virtual controller state read that it performs.
+    /// @param [in] profileName Name of the load profile, used for reporting.
+    /// @param [in] loadProfile Synthetic load profile to use.
+    static void RunStressDriver(const wchar_t* profileName, const SyntheticXInput::SLoadProfile& loadProfile)
+    {
+        constexpr DIPROPDWORD kBufferSizeProperty = {.diph = {.dwSize = sizeof(DIPROPDWORD), .dwHeaderSize = sizeof(DIPROPHEADER), .dwObj = 0, .dwHow = DIPH_DEVICE}, .dwData = kStressEventBufferCapacity};
+
+        std::unique_ptr<SyntheticXInput> xinputDirectInput = std::make_unique<SyntheticXInput>(loadProfile);
+        std::unique_ptr<SyntheticXInput> xinputWinMM = std::make_unique<SyntheticXInput>(loadProfile);
+        const SyntheticXInput& kXInputDirectInput = *xinputDirectInput;
+        const SyntheticXInput& kXInputWinMM = *xinputWinMM;
+
+        VirtualDirectInputDevice<ECharMode::W> diController(std::make_unique<VirtualController>(kTestControllerIdentifier, kTestMapper, std::move(xinputDirectInput)));
+        TEST_ASSERT(DI_OK == diController.SetDataFormat(&kStressFormatSpec));
+        TEST_ASSERT(DI_OK == diController.SetProperty(DIPROP_BUFFERSIZE, (LPCDIPROPHEADER)&kBufferSizeProperty));
+
+        VirtualController joyController(kTestControllerIdentifier, kTestMapper, std::move(xinputWinMM));
+
+        std::atomic<bool> startFlag = false;
+        std::vector<std::thread> threads;
+        SStressResult results[3];
+
+        LaunchStressOperation(L"GetDeviceState", [&diController]() -> EStressOutcome
+        {
+            SStressDataPacket dataPacket;
+            return ((DI_OK == diController.GetDeviceState(sizeof(dataPacket), &dataPacket)) ? EStressOutcome::Success : EStressOutcome::Failure);
+        }, startFlag, threads, results[0]);
+
+        LaunchStressOperation(L"GetDeviceData", [&diController]() -> EStressOutcome
+        {
+            DIDEVICEOBJECTDATA objectData[kStressEventsPerRead];
+            DWORD numObjectDataElements = _countof(objectData);
+
+            diController.Poll();
+
+            switch (diController.GetDeviceData(sizeof(DIDEVICEOBJECTDATA), objectData, &numObjectDataElements, 0))
+            {
+            case DI_OK:
+                return EStressOutcome::Success;
+            case DI_BUFFEROVERFLOW:
+                return EStressOutcome::Overflow;
+            default:
+                return EStressOutcome::Failure;
+            }
+        }, startFlag, threads, results[1]);
+
+        LaunchStressOperation(L"JoyGetPosEx", [&joyController]() -> EStressOutcome
+        {
+            const SState kJoyState = joyController.GetState();
+            return ((kJoyState.axis[(int)EAxis::X] >= Controller::kAnalogValueMin) && (kJoyState.axis[(int)EAxis::X] <= Controller::kAnalogValueMax) ? EStressOutcome::Success : EStressOutcome::Failure);
+        }, startFlag, threads, results[2]);
+
+        startFlag = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        const SyntheticXInput::SStatistics kStatsDirectInput = kXInputDirectInput.GetStatistics();
+        const SyntheticXInput::SStatistics kStatsWinMM = kXInputWinMM.GetStatistics();
+
+        PrintFormatted(L"  Load profile \"%s\": %u threads per operation, %lld ms", profileName, kStressThreadsPerOperation, (long long)kStressDuration.count());
+        for (auto& result : results)
+            PrintStressResult(result);
+        PrintFormatted(L"    %-16s DirectInput: %llu reads, %llu packets, %llu disconnected, %llu reconnects", L"XInput", (unsigned long long)kStatsDirectInput.numCalls, (unsigned long long)kStatsDirectInput.numPacketsGenerated, (unsigned long long)kStatsDirectInput.numDisconnectedCalls, (unsigned long long)kStatsDirectInput.numReconnects);
+        PrintFormatted(L"    %-16s WinMM: %llu reads, %llu packets, %llu disconnected, %llu reconnects", L"", (unsigned long long)kStatsWinMM.numCalls, (unsigned long long)kStatsWinMM.numPacketsGenerated, (unsigned long long)kStatsWinMM.numDisconnectedCalls, (unsigned long long)kStatsWinMM.numReconnects);
+
+        for (auto& result : results)
+        {
+            TEST_ASSERT(result.numCalls > 0);
+            TEST_ASSERT(0 == result.numFailures);
+        }
+    }
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Two generators with the same load profile must produce identical sequences of controller states.
+    // Packet generation is not rate-limited so that output depends only on the number of calls.
+    TEST_CASE(SyntheticXInput_Deterministic)
+    {
+        constexpr SyntheticXInput::SLoadProfile kLoadProfile = {.stickStepMax = 4096, .triggerSweepStep = 17, .buttonPattern = SyntheticXInput::EButtonPattern::RandomMash, .packetChangesPerSecond = 0, .disconnectIntervalCalls = 0, .disconnectDurationCalls = 0, .seed = 12345};
+
+        SyntheticXInput xinputA(kLoadProfile);
+        SyntheticXInput xinputB(kLoadProfile);
+
+        for (unsigned int i = 0; i < kTestNumCalls; ++i)
+        {
+            XINPUT_STATE stateA;
+            XINPUT_STATE stateB;
+
+            TEST_ASSERT(ERROR_SUCCESS == xinputA.GetState(kTestControllerIdentifier, &stateA));
+            TEST_ASSERT(ERROR_SUCCESS == xinputB.GetState(kTestControllerIdentifier, &stateB));
+            TEST_ASSERT(0 == memcmp(&stateA, &stateB, sizeof(stateA)));
+        }
+    }
+
+    // Without rate limiting, every call must produce a new packet, and the generated values must stay within their physical ranges.
+    TEST_CASE(SyntheticXInput_PacketChangeEveryCall)
+    {
+        constexpr SyntheticXInput::SLoadProfile kLoadProfile = {.stickStepMax = 32767, .triggerSweepStep = 100, .buttonPattern = SyntheticXInput::EButtonPattern::Chord, .packetChangesPerSecond = 0, .disconnectIntervalCalls = 0, .disconnectDurationCalls = 0, .seed = 1};
+
+        SyntheticXInput xinput(kLoadProfile);
+        DWORD lastPacketNumber = 0;
+
+        for (unsigned int i = 0; i < kTestNumCalls; ++i)
+        {
+            XINPUT_STATE state;
+
+            TEST_ASSERT(ERROR_SUCCESS == xinput.GetState(kTestControllerIdentifier, &state));
+            TEST_ASSERT(state.dwPacketNumber == (lastPacketNumber + 1));
+            TEST_ASSERT(UINT8_MAX == ((unsigned int)state.Gamepad.bLeftTrigger + (unsigned int)state.Gamepad.bRightTrigger));
+            TEST_ASSERT(0 == (state.Gamepad.wButtons & 0x0c00));
+
+            lastPacketNumber = state.dwPacketNumber;
+        }
+
+        TEST_ASSERT(kTestNumCalls == xinput.GetStatistics().numPacketsGenerated);
+    }
+
+    // Disconnect storms must follow the configured cycle exactly and be counted correctly.
+    TEST_CASE(SyntheticXInput_DisconnectStorm)
+    {
+        constexpr unsigned int kDisconnectInterval = 10;
+        constexpr unsigned int kDisconnectDuration = 3;
+        constexpr SyntheticXInput::SLoadProfile kLoadProfile = {.stickStepMax = 100, .triggerSweepStep = 0, .buttonPattern = SyntheticXInput::EButtonPattern::None, .packetChangesPerSecond = 0, .disconnectIntervalCalls = kDisconnectInterval, .disconnectDurationCalls = kDisconnectDuration, .seed = 1};
+
+        SyntheticXInput xinput(kLoadProfile);
+
+        for (unsigned int i = 0; i < kTestNumCalls; ++i)
+        {
+            XINPUT_STATE state;
+            const DWORD kExpectedResult = (((i % kDisconnectInterval) < kDisconnectDuration) ? ERROR_DEVICE_NOT_CONNECTED : ERROR_SUCCESS);
+            TEST_ASSERT(kExpectedResult == xinput.GetState(kTestControllerIdentifier, &state));
+        }
+
+        const SyntheticXInput::SStatistics kStatistics = xinput.GetStatistics();
+        TEST_ASSERT(kTestNumCalls == kStatistics.numCalls);
+        TEST_ASSERT((kTestNumCalls / kDisconnectInterval) * kDisconnectDuration == kStatistics.numDisconnectedCalls);
+        TEST_ASSERT((kTestNumCalls / kDisconnectInterval) == kStatistics.numReconnects);
+        TEST_ASSERT(kStatistics.numCalls - kStatistics.numDisconnectedCalls == kStatistics.numPacketsGenerated);
+    }
+
+    // Runs the stress driver with a range of load profiles and reports the results.
+    // The only correctness requirement is that no operation returns an unexpected result, but the printed report is the main output.
+    // Takes long enough that it only runs when benchmarks are enabled.
+    TEST_CASE_CONDITIONAL(SyntheticXInput_StressDriver, AreBenchmarksEnabled())
+    {
+        RunStressDriver(L"Idle", {.stickStepMax = 0, .triggerSweepStep = 0, .buttonPattern = SyntheticXInput::EButtonPattern::None, .packetChangesPerSecond = 1, .disconnectIntervalCalls = 0, .disconnectDurationCalls = 0, .seed = 1});
+        RunStressDriver(L"Typical", SyntheticXInput::kDefaultLoadProfile);
+        RunStressDriver(L"AnalogFlood", {.stickStepMax = 2048, .triggerSweepStep = 3, .buttonPattern = SyntheticXInput::EButtonPattern::None, .packetChangesPerSecond = 0, .disconnectIntervalCalls = 0, .disconnectDurationCalls = 0, .seed = 2});
+        RunStressDriver(L"ButtonMash", {.stickStepMax = 0, .triggerSweepStep = 0, .buttonPattern = SyntheticXInput::EButtonPattern::RandomMash, .packetChangesPerSecond = 1000000, .disconnectIntervalCalls = 0, .disconnectDurationCalls = 0, .seed = 3});
+        RunStressDriver(L"DisconnectStorm", {.stickStepMax = 512, .triggerSweepStep = 8, .buttonPattern = SyntheticXInput::EButtonPattern::Alternating, .packetChangesPerSecond = 0, .disconnectIntervalCalls = 64, .disconnectDurationCalls = 16, .seed = 4});
+    }
+}
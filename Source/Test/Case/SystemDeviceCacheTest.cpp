@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ *****************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2021
+ *************************************************************************//**
+ * @file SystemDeviceCacheTest.cpp
+ *   Unit tests for the persistent cache of information about the devices
+ *   that WinMM makes available.
+ *****************************************************************************/
+
+#include "SystemDeviceCache.h"
+#include "TestCase.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+
+namespace XidiTest
+{
+    using namespace ::Xidi::SystemDeviceCache;
+
+
+    // -------- INTERNAL CONSTANTS ----------------------------------------- //
+
+    /// Device information used throughout these tests, which includes absent devices, XInput devices, and other devices.
+    static const TDeviceList kTestDevices = {
+        {L"VID_045E&PID_028E", true},
+        {L"", false},
+        {L"VID_046D&PID_C21D", false},
+        {L"VID_045E&PID_0B12", true}
+    };
+
+
+    // -------- TEST CASES ------------------------------------------------- //
+
+    // Verifies that device information survives being serialized and parsed, and that an empty device list does too.
+    TEST_CASE(SystemDeviceCache_SerializeParse_RoundTrip)
+    {
+        const std::optional<std::string> kContents = Serialize(kTestDevices);
+        TEST_ASSERT(true == kContents.has_value());
+        TEST_ASSERT(std::optional<TDeviceList>(kTestDevices) == Parse(kContents.value()));
+
+        const std::optional<std::string> kEmptyContents = Serialize(TDeviceList());
+        TEST_ASSERT(true == kEmptyContents.has_value());
+        TEST_ASSERT(std::optional<TDeviceList>(TDeviceList()) == Parse(kEmptyContents.value()));
+    }
+
+    // Verifies that device identifiers which cannot be represented in a cache file prevent the cache from being written.
+    TEST_CASE(SystemDeviceCache_Serialize_Unrepresentable)
+    {
+        TEST_ASSERT(false == Serialize({{L"VID_045E PID_028E", false}}).has_value());
+        TEST_ASSERT(false == Serialize({{L"VID_045E\nPID_028E", false}}).has_value());
+        TEST_ASSERT(false == Serialize({{L"VID_045E&PID_028E\u00e9", false}}).has_value());
+        TEST_ASSERT(false == Serialize({{L"", true}}).has_value());
+    }
+
+    // Verifies that cache contents that are malformed, truncated, or written using a different format version are rejected.
+    TEST_CASE(SystemDeviceCache_Parse_Invalid)
+    {
+        constexpr std::string_view kInvalidContents[] = {
+            "",
+            "XidiSystemDeviceCache\n0\n",
+            "XidiSystemDeviceCache 999\n0\n",
+            "SomethingElse 1\n0\n",
+            "XidiSystemDeviceCache 1\n",
+            "XidiSystemDeviceCache 1\nabc\n",
+            "XidiSystemDeviceCache 1\n2\n1 VID_045E&PID_028E\n",
+            "XidiSystemDeviceCache 1\n1\n2 VID_045E&PID_028E\n",
+            "XidiSystemDeviceCache 1\n1\n1VID_045E&PID_028E\n",
+            "XidiSystemDeviceCache 1\n1\n1 \n",
+            "XidiSystemDeviceCache 1\n1\n0 VID_045E&PID_028E\n0 VID_046D&PID_C21D\n",
+            "XidiSystemDeviceCache 1\n100000\n"
+        };
+
+        for (const std::string_view invalidContents : kInvalidContents)
+            TEST_ASSERT(false == Parse(invalidContents).has_value());
+
+        // Line terminators written on Windows are accepted.
+        TEST_ASSERT(std::optional<TDeviceList>({{L"VID_045E&PID_028E", true}, {L"", false}}) == Parse("XidiSystemDeviceCache 1\r\n2\r\n1 VID_045E&PID_028E\r\n0 \r\n"));
+    }
+
+    // Verifies that cached XInput support information is applied only if exactly the same devices are present at exactly the same indices.
+    TEST_CASE(SystemDeviceCache_ApplyIfMatching)
+    {
+        TDeviceList presentDevices = kTestDevices;
+        for (auto& presentDevice : presentDevices)
+            presentDevice.second = false;
+
+        TEST_ASSERT(true == ApplyIfMatching(kTestDevices, presentDevices));
+        TEST_ASSERT(kTestDevices == presentDevices);
+
+        TDeviceList reorderedDevices = {kTestDevices[2], kTestDevices[1], kTestDevices[0], kTestDevices[3]};
+        const TDeviceList kReorderedDevicesBefore = reorderedDevices;
+        TEST_ASSERT(false == ApplyIfMatching(kTestDevices, reorderedDevices));
+        TEST_ASSERT(kReorderedDevicesBefore == reorderedDevices);
+
+        TDeviceList additionalDevices = kTestDevices;
+        additionalDevices.push_back({L"VID_054C&PID_05C4", false});
+        TEST_ASSERT(false == ApplyIfMatching(kTestDevices, additionalDevices));
+    }
+
+    // Verifies that device information written to a cache file can be read back, and that a missing cache file is reported as such.
+    TEST_CASE(SystemDeviceCache_SaveLoad)
+    {
+        const std::filesystem::path kCachePath = std::filesystem::temp_directory_path() / L"XidiTest_SystemDeviceCache.cache";
+        std::error_code removeError;
+        std::filesystem::remove(kCachePath, removeError);
+
+        TEST_ASSERT(false == Load(kCachePath.wstring()).has_value());
+        TEST_ASSERT(true == Save(kCachePath.wstring(), kTestDevices));
+        TEST_ASSERT(std::optional<TDeviceList>(kTestDevices) == Load(kCachePath.wstring()));
+
+        // Saving again replaces the previous contents entirely.
+        const TDeviceList kReplacementDevices = {{L"VID_054C&PID_05C4", false}};
+        TEST_ASSERT(true == Save(kCachePath.wstring(), kReplacementDevices));
+        TEST_ASSERT(std::optional<TDeviceList>(kReplacementDevices) == Load(kCachePath.wstring()));
+
+        std::filesystem::remove(kCachePath, removeError);
+    }
+}
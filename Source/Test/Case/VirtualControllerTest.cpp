@@ -9,22 +9,31 @@
  *   Unit tests for virtual controller objects.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
+#include "Globals.h"
+#include "MockClock.h"
 #include "MockXInput.h"
 #include "StateChangeEventBuffer.h"
+#include "SyntheticXInput.h"
 #include "TestCase.h"
 #include "VirtualController.h"
 #include "XInputInterface.h"
+#include "XidiConfigReader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <deque>
 #include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <xinput.h>
+#include <thread>
+#include <vector>
 
 
 namespace XidiTest
@@ -42,6 +51,20 @@ namespace XidiTest
     using ::Xidi::Controller::VirtualController;
 
 
+    // -------- INTERNAL TYPES --------------------------------------------- //
+
+    /// Enumerates the operations that the contention benchmark issues against a shared virtual controller.
+    enum class EContentionOperation : uint8_t
+    {
+        PeekState,                                                          ///< Reads the most recent state without refreshing it, as done by controller set snapshots and the control endpoint.
+        GetState,                                                           ///< Reads and refreshes the state, as done by DirectInput GetDeviceState and WinMM JoyGetPosEx.
+        GetProperty,                                                        ///< Reads axis properties, as done by DirectInput GetProperty.
+        ReadEvents,                                                         ///< Reads and removes buffered events, as done by DirectInput GetDeviceData.
+        SetProperty,                                                        ///< Changes an axis property, as done by DirectInput SetProperty.
+        Count
+    };
+
+
     // -------- INTERNAL CONSTANTS ----------------------------------------- //
 
     /// Axis to use when testing with a single axis.
@@ -70,6 +93,35 @@ namespace XidiTest
         .buttonY = std::make_unique<ButtonMapper>(EButton::B4)
     });
 
+    /// Numbers of threads with which the contention benchmark exercises a single virtual controller.
+    static constexpr unsigned int kContentionThreadCounts[] = {1, 2, 4, 8, 16};
+
+    /// Amount of time for which the contention benchmark runs each number of threads.
+    static constexpr std::chrono::milliseconds kContentionDuration = std::chrono::milliseconds(200);
+
+    /// Event buffer capacity used by the contention benchmark.
+    static constexpr uint32_t kContentionEventBufferCapacity = 64;
+
+    /// Maximum number of events read by each event-reading operation in the contention benchmark.
+    static constexpr uint32_t kContentionEventsPerRead = 16;
+
+    /// Sequence of operations that each contention benchmark thread issues repeatedly.
+    /// Proportions approximate an application that reads state every frame from more than one thread, occasionally queries properties and drains buffered events, and rarely changes properties.
+    static constexpr EContentionOperation kContentionOperationMix[] = {
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::GetProperty,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::ReadEvents,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::GetProperty,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::GetProperty,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::ReadEvents,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::GetProperty,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::PeekState, EContentionOperation::GetProperty,
+        EContentionOperation::PeekState, EContentionOperation::GetState, EContentionOperation::GetProperty, EContentionOperation::SetProperty
+    };
+
+    /// Names of the operations issued by the contention benchmark, used for reporting.
+    static constexpr const wchar_t* kContentionOperationNames[] = {L"PeekState", L"GetState", L"GetProperty", L"ReadEvents", L"SetProperty"};
+    static_assert(_countof(kContentionOperationNames) == (int)EContentionOperation::Count, "Mismatch between operation enumeration and operation names.");
+
 
     // -------- INTERNAL FUNCTIONS ----------------------------------------- //
 
@@ -91,6 +143,9 @@ namespace XidiTest
         case EElementType::Pov:
             controllerState.povDirection = eventData.value.povDirection;
             break;
+
+        default:
+            break;
         }
     }
     
@@ -116,8 +171,7 @@ namespace XidiTest
     /// @return Result obtained from the virtual controller transforming the input axis values using the properties with which it was previously configured.
     static int32_t GetAxisPropertiesApplyResult(const VirtualController& controller, int32_t inputAxisValue)
     {
-        Controller::SState controllerState;
-        ZeroMemory(&controllerState, sizeof(controllerState));
+        Controller::SState controllerState = {};
         controllerState.axis[(int)EAxis::X] = inputAxisValue;
 
         controller.ApplyProperties(controllerState);
@@ -214,6 +268,118 @@ namespace XidiTest
     }
 
 
+    /// Issues the contention benchmark operation mix against a single virtual controller from the specified number of threads for the benchmark duration, and reports the resulting throughput.
+    /// All threads are released at the same time so that they contend with each other for as much of the run as possible.
+    /// @param [in] numThreads Number of threads to use.
+    /// @return Total number of operations completed per second across all threads.
+    static double RunContentionBenchmark(unsigned int numThreads)
+    {
+        VirtualController controller(0, kTestMapper, std::make_unique<SyntheticXInput>());
+        TEST_ASSERT(true == controller.SetEventBufferCapacity(kContentionEventBufferCapacity));
+
+        std::atomic<bool> startFlag = false;
+        std::mutex resultMutex;
+        uint64_t numCalls[(int)EContentionOperation::Count] = {};
+        uint64_t numFailures = 0;
+        std::vector<std::thread> threads;
+
+        for (unsigned int i = 0; i < numThreads; ++i)
+        {
+            threads.emplace_back([&controller, &startFlag, &resultMutex, &numCalls, &numFailures, i]() -> void
+            {
+                uint64_t threadNumCalls[(int)EContentionOperation::Count] = {};
+                uint64_t threadNumFailures = 0;
+
+                // Threads start at different points in the operation mix so that they do not all issue the same operation at the same time.
+                const unsigned int kMixOffset = (i * 5) % _countof(kContentionOperationMix);
+
+                while (false == startFlag)
+                    std::this_thread::yield();
+
+                const auto kStopTime = std::chrono::steady_clock::now() + kContentionDuration;
+
+                // The clock is only checked once per pass through the operation mix so that reading it does not dominate the cheapest operations.
+                while (std::chrono::steady_clock::now() < kStopTime)
+                {
+                    for (unsigned int j = 0; j < _countof(kContentionOperationMix); ++j)
+                    {
+                        const EContentionOperation kOperation = kContentionOperationMix[(kMixOffset + j) % _countof(kContentionOperationMix)];
+
+                        switch (kOperation)
+                        {
+                        case EContentionOperation::PeekState:
+                            if (controller.PeekState().axis[(int)EAxis::X] < Controller::kAnalogValueMin)
+                                threadNumFailures += 1;
+                            break;
+
+                        case EContentionOperation::GetState:
+                            if (controller.GetState().axis[(int)EAxis::X] < Controller::kAnalogValueMin)
+                                threadNumFailures += 1;
+                            break;
+
+                        case EContentionOperation::GetProperty:
+                            if ((controller.GetAxisDeadzone(EAxis::X) > VirtualController::kAxisDeadzoneMax) || (controller.GetAxisRange(EAxis::Y).first >= controller.GetAxisRange(EAxis::Y).second))
+                                threadNumFailures += 1;
+                            break;
+
+                        case EContentionOperation::ReadEvents:
+                            {
+                                auto lock = controller.LockEventBuffer();
+                                const uint32_t kNumEvents = std::min(kContentionEventsPerRead, controller.GetEventBufferCount());
+
+                                for (uint32_t k = 1; k < kNumEvents; ++k)
+                                {
+                                    if (controller.GetEventBufferEvent(k).sequence <= controller.GetEventBufferEvent(k - 1).sequence)
+                                        threadNumFailures += 1;
+                                }
+
+                                controller.PopEventBufferOldestEvents(kNumEvents);
+                            }
+                            break;
+
+                        case EContentionOperation::SetProperty:
+                            if (false == controller.SetAxisDeadzone(EAxis::X, ((0 == (threadNumCalls[(int)kOperation] % 2)) ? DeadzoneValueByPercentage(5) : VirtualController::kAxisDeadzoneDefault)))
+                                threadNumFailures += 1;
+                            break;
+
+                        default:
+                            break;
+                        }
+
+                        threadNumCalls[(int)kOperation] += 1;
+                    }
+                }
+
+                std::scoped_lock lock(resultMutex);
+                for (int k = 0; k < (int)EContentionOperation::Count; ++k)
+                    numCalls[k] += threadNumCalls[k];
+                numFailures += threadNumFailures;
+            });
+        }
+
+        startFlag = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        const double kDurationSeconds = std::chrono::duration<double>(kContentionDuration).count();
+        uint64_t numCallsTotal = 0;
+        for (int i = 0; i < (int)EContentionOperation::Count; ++i)
+            numCallsTotal += numCalls[i];
+
+        PrintFormatted(L"    %2u threads %11.0f calls/sec: %ls=%.0f %ls=%.0f %ls=%.0f %ls=%.0f %ls=%.0f", numThreads, (double)numCallsTotal / kDurationSeconds,
+            kContentionOperationNames[0], (double)numCalls[0] / kDurationSeconds,
+            kContentionOperationNames[1], (double)numCalls[1] / kDurationSeconds,
+            kContentionOperationNames[2], (double)numCalls[2] / kDurationSeconds,
+            kContentionOperationNames[3], (double)numCalls[3] / kDurationSeconds,
+            kContentionOperationNames[4], (double)numCalls[4] / kDurationSeconds);
+
+        TEST_ASSERT(numCallsTotal > 0);
+        TEST_ASSERT(0 == numFailures);
+        return (double)numCallsTotal / kDurationSeconds;
+    }
+
+
     // -------- TEST CASES ------------------------------------------------- //
 
     // Verifies that virtual controllers correctly retrieve and return their associated capabilities.
@@ -285,6 +451,41 @@ namespace XidiTest
         }
     }
 
+    // Verifies that virtual controllers ignore new XInput data packets whose changes do not affect any mapped controller element.
+    // Also verifies that a property change is fully applied on the next refresh, even if the XInput controller elements that changed are unrelated to it.
+    TEST_CASE(VirtualController_RefreshState_IncrementalMapping)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+
+        // Triggers and the back button are not mapped by the mapper defined at the top of this file.
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 2, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_BACK, .bLeftTrigger = 200}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 3, .Gamepad = {.wButtons = XINPUT_GAMEPAD_B | XINPUT_GAMEPAD_BACK, .bLeftTrigger = 200}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 4, .Gamepad = {.wButtons = XINPUT_GAMEPAD_B}})}
+        });
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
+
+        TEST_ASSERT(true == controller.RefreshState());
+        TEST_ASSERT(controller.GetStateRef() == Controller::SState({.button = 0b0001}));
+
+        TEST_ASSERT(false == controller.RefreshState());
+        TEST_ASSERT(controller.GetStateRef() == Controller::SState({.button = 0b0001}));
+
+        TEST_ASSERT(true == controller.RefreshState());
+        TEST_ASSERT(controller.GetStateRef() == Controller::SState({.button = 0b0010}));
+
+        constexpr int32_t kTestRangeMin = 1000;
+        constexpr int32_t kTestRangeMax = 3000;
+        constexpr int32_t kTestRangeNeutral = (kTestRangeMin + kTestRangeMax) / 2;
+        TEST_ASSERT(true == controller.SetAxisRange(EAxis::X, kTestRangeMin, kTestRangeMax));
+
+        TEST_ASSERT(true == controller.RefreshState());
+        TEST_ASSERT(controller.GetStateRef() == Controller::SState({.axis = {kTestRangeNeutral}, .button = 0b0010}));
+    }
+
     // Verifies that virtual controllers are correctly reported as being completely neutral when an XInput error occurs.
     TEST_CASE(VirtualController_GetState_XInputErrorMeansNeutral)
     {
@@ -327,6 +528,89 @@ namespace XidiTest
         }
     }
 
+    // Verifies that small analog stick movements are quantized away by the granularity property and counted as suppressed.
+    // Suppressed changes must not generate buffered events.
+    TEST_CASE(VirtualController_GetState_GranularitySuppressesJitter)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.sThumbLX = 10000}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 2, .Gamepad = {.sThumbLX = 10050}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 3, .Gamepad = {.sThumbLX = 10999}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 4, .Gamepad = {.sThumbLX = 11000}})}
+        });
+
+        // Axis assignments are based on the mapper defined at the top of this file.
+        constexpr Controller::SState kExpectedStates[] = {
+            {.axis = {10000}},
+            {.axis = {10000}},
+            {.axis = {10000}},
+            {.axis = {11000}}
+        };
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
+        TEST_ASSERT(true == controller.SetAxisGranularity(EAxis::X, 1000));
+        TEST_ASSERT(true == controller.SetEventBufferCapacity(16));
+
+        for (const auto& expectedState : kExpectedStates)
+        {
+            const Controller::SState actualState = controller.GetState();
+            TEST_ASSERT(actualState == expectedState);
+        }
+
+        const VirtualController::SSuppressionStatistics kSuppressionStatistics = controller.GetSuppressionStatistics();
+        TEST_ASSERT(2 == kSuppressionStatistics.numSuppressedByGranularity);
+        TEST_ASSERT(0 == kSuppressionStatistics.numSuppressedByHysteresis);
+        TEST_ASSERT(2 == controller.GetEventBufferCount());
+    }
+
+    // Verifies that analog stick movements within the hysteresis band are suppressed and counted, and that movements to neutral are always reported.
+    // Suppressed changes must not generate buffered events.
+    TEST_CASE(VirtualController_GetState_HysteresisSuppressesJitter)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.sThumbLX = 10000}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 2, .Gamepad = {.sThumbLX = 10050}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 3, .Gamepad = {.sThumbLX = 9980}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 4, .Gamepad = {.sThumbLX = 10500}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 5, .Gamepad = {.sThumbLX = 20000}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 6, .Gamepad = {.sThumbLX = 200}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 7, .Gamepad = {.sThumbLX = 0}})}
+        });
+
+        // Axis assignments are based on the mapper defined at the top of this file.
+        // Hysteresis of 1% of the full axis range is a band of 655 units.
+        constexpr Controller::SState kExpectedStates[] = {
+            {.axis = {10000}},
+            {.axis = {10000}},
+            {.axis = {10000}},
+            {.axis = {10000}},
+            {.axis = {20000}},
+            {.axis = {200}},
+            {.axis = {0}}
+        };
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
+        TEST_ASSERT(true == controller.SetAxisHysteresis(EAxis::X, VirtualController::kAxisHysteresisMax / 100));
+        TEST_ASSERT(true == controller.SetEventBufferCapacity(16));
+
+        for (const auto& expectedState : kExpectedStates)
+        {
+            const Controller::SState actualState = controller.GetState();
+            TEST_ASSERT(actualState == expectedState);
+        }
+
+        const VirtualController::SSuppressionStatistics kSuppressionStatistics = controller.GetSuppressionStatistics();
+        TEST_ASSERT(0 == kSuppressionStatistics.numSuppressedByGranularity);
+        TEST_ASSERT(3 == kSuppressionStatistics.numSuppressedByHysteresis);
+        TEST_ASSERT(4 == controller.GetEventBufferCount());
+    }
+
     // Verifies that attempting to obtain a controller lock results in an object that does, in fact, own the mutex with which it is associated.
     TEST_CASE(VirtualController_Lock)
     {
@@ -335,6 +619,83 @@ namespace XidiTest
         TEST_ASSERT(true == lock.owns_lock());
     }
 
+    // Verifies that attempting to obtain an event buffer lock results in an object that owns its mutex, and that holding it does not prevent the controller lock from being obtained.
+    TEST_CASE(VirtualController_LockEventBuffer)
+    {
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+        auto eventBufferLock = controller.LockEventBuffer();
+        TEST_ASSERT(true == eventBufferLock.owns_lock());
+
+        std::thread otherThread([&controller]() -> void
+            {
+                auto lock = controller.Lock();
+                TEST_ASSERT(true == lock.owns_lock());
+            }
+        );
+
+        otherThread.join();
+    }
+
+    // Verifies that the state published for readers that do not take any locks matches the state produced by each refresh, and that reading it is possible while another thread holds the controller lock.
+    TEST_CASE(VirtualController_PeekState)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A, .sThumbLX = 1234}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 2, .Gamepad = {.wButtons = XINPUT_GAMEPAD_DPAD_UP, .sThumbRY = -5678}})}
+        });
+
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
+        TEST_ASSERT(Controller::SState() == controller.PeekState());
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const Controller::SState kState = controller.GetState();
+            TEST_ASSERT(kState == controller.PeekState());
+
+            auto lock = controller.Lock();
+            std::thread otherThread([&controller, &kState]() -> void
+                {
+                    TEST_ASSERT(kState == controller.PeekState());
+                }
+            );
+
+            otherThread.join();
+        }
+    }
+
+    // Verifies that the properties published for readers that do not take any locks reflect every kind of property change.
+    TEST_CASE(VirtualController_GetProperties)
+    {
+        VirtualController controller(0, kTestMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(VirtualController::SProperties() == controller.GetProperties());
+
+        TEST_ASSERT(true == controller.SetAxisDeadzone(EAxis::X, 1000));
+        TEST_ASSERT(true == controller.SetAllAxisSaturation(9000));
+        TEST_ASSERT(true == controller.SetAxisRange(EAxis::Y, -100, 100));
+        TEST_ASSERT(true == controller.SetForceFeedbackGain(5000));
+        TEST_ASSERT(true == controller.StagePropertyChanges({.axis = EAxis::RotX, .granularity = 10}));
+
+        VirtualController::SProperties expectedProperties;
+        expectedProperties.axis[(int)EAxis::X].SetDeadzone(1000);
+        for (auto& axisProperties : expectedProperties.axis)
+            axisProperties.SetSaturation(9000);
+        expectedProperties.axis[(int)EAxis::Y].SetRange(-100, 100);
+        expectedProperties.axis[(int)EAxis::Y].SetHysteresis(expectedProperties.axis[(int)EAxis::Y].hysteresis);
+        expectedProperties.axis[(int)EAxis::RotX].SetGranularity(10);
+        expectedProperties.device.SetFfGain(5000);
+
+        const VirtualController::SProperties kActualProperties = controller.GetProperties();
+        TEST_ASSERT(kActualProperties == expectedProperties);
+        TEST_ASSERT(1000 == controller.GetAxisDeadzone(EAxis::X));
+        TEST_ASSERT(9000 == controller.GetAxisSaturation(EAxis::Z));
+        TEST_ASSERT(std::make_pair(-100, 100) == controller.GetAxisRange(EAxis::Y));
+        TEST_ASSERT(10 == controller.GetAxisGranularity(EAxis::RotX));
+        TEST_ASSERT(5000 == controller.GetForceFeedbackGain());
+    }
+
 
     // The following sequence of tests, which together comprise the ApplyAxisProperties suite, verify that properties can be correctly applied to an axis value.
     // Each test case follows the basic steps of declaring test data, sweeping through raw axis values, and verifying that the output curve matches expectation.
@@ -411,6 +772,32 @@ namespace XidiTest
         TestVirtualControllerApplyAxisProperties(-10000000, 0, DeadzoneValueByPercentage(25), SaturationValueByPercentage(75));
     }
 
+    // Granularity is set so that only multiples of a fixed step are reportable, other than the range extremes.
+    // Sweeps through all raw axis values and verifies that every output is either quantized or extreme and that output remains monotonic.
+    TEST_CASE(VirtualController_ApplyAxisProperties_Granularity)
+    {
+        constexpr int32_t kTestRangeMin = -10000;
+        constexpr int32_t kTestRangeMax = 10000;
+        constexpr uint32_t kTestGranularity = 1000;
+
+        VirtualController controller(0, kTestSingleAxisMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(true == controller.SetAxisRange(kTestSingleAxis, kTestRangeMin, kTestRangeMax));
+        TEST_ASSERT(true == controller.SetAxisGranularity(kTestSingleAxis, kTestGranularity));
+        TEST_ASSERT(kTestGranularity == controller.GetAxisGranularity(kTestSingleAxis));
+
+        int32_t lastOutputAxisValue = kTestRangeMin;
+
+        for (int32_t inputAxisValue = Controller::kAnalogValueMin; inputAxisValue <= Controller::kAnalogValueMax; ++inputAxisValue)
+        {
+            const int32_t actualOutputAxisValue = GetAxisPropertiesApplyResult(controller, inputAxisValue);
+            TEST_ASSERT((0 == (actualOutputAxisValue % (int32_t)kTestGranularity)) || (kTestRangeMin == actualOutputAxisValue) || (kTestRangeMax == actualOutputAxisValue));
+            TEST_ASSERT(actualOutputAxisValue >= lastOutputAxisValue);
+            lastOutputAxisValue = actualOutputAxisValue;
+        }
+
+        TEST_ASSERT(kTestRangeMax == lastOutputAxisValue);
+    }
+
 
     // The following sequence of tests, which together comprise the SetProperty suite, verify that properties are correctly set if valid and rejected if invalid.
     // Each test case follows the basic steps of declaring test data, attempting to set properties, and verifying that the outcome matches expectation.
@@ -554,6 +941,88 @@ namespace XidiTest
             TEST_ASSERT(VirtualController::kAxisSaturationDefault == controller.GetAxisSaturation((EAxis)i));
     }
 
+    // Valid granularity value set on a single axis and then on all axes.
+    TEST_CASE(VirtualController_SetProperty_GranularityValid)
+    {
+        constexpr uint32_t kTestGranularityValue = 64;
+        constexpr EAxis kTestGranularityAxis = EAxis::Y;
+
+        VirtualController controller(0, kTestMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(true == controller.SetAxisGranularity(kTestGranularityAxis, kTestGranularityValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+        {
+            if ((int)kTestGranularityAxis == i)
+                TEST_ASSERT(kTestGranularityValue == controller.GetAxisGranularity((EAxis)i));
+            else
+                TEST_ASSERT(VirtualController::kAxisGranularityDefault == controller.GetAxisGranularity((EAxis)i));
+        }
+
+        TEST_ASSERT(true == controller.SetAllAxisGranularity(kTestGranularityValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kTestGranularityValue == controller.GetAxisGranularity((EAxis)i));
+    }
+
+    // Invalid granularity value set on a single axis and then on all axes.
+    TEST_CASE(VirtualController_SetProperty_GranularityInvalid)
+    {
+        constexpr uint32_t kTestGranularityValue = VirtualController::kAxisGranularityMin - 1;
+        constexpr EAxis kTestGranularityAxis = EAxis::Y;
+
+        VirtualController controller(0, kTestMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(false == controller.SetAxisGranularity(kTestGranularityAxis, kTestGranularityValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(VirtualController::kAxisGranularityDefault == controller.GetAxisGranularity((EAxis)i));
+
+        TEST_ASSERT(false == controller.SetAllAxisGranularity(kTestGranularityValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(VirtualController::kAxisGranularityDefault == controller.GetAxisGranularity((EAxis)i));
+    }
+
+    // Valid hysteresis value set on a single axis and then on all axes.
+    TEST_CASE(VirtualController_SetProperty_HysteresisValid)
+    {
+        constexpr uint32_t kTestHysteresisValue = VirtualController::kAxisHysteresisMax / 100;
+        constexpr EAxis kTestHysteresisAxis = EAxis::X;
+
+        VirtualController controller(0, kTestMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(true == controller.SetAxisHysteresis(kTestHysteresisAxis, kTestHysteresisValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+        {
+            if ((int)kTestHysteresisAxis == i)
+                TEST_ASSERT(kTestHysteresisValue == controller.GetAxisHysteresis((EAxis)i));
+            else
+                TEST_ASSERT(VirtualController::kAxisHysteresisDefault == controller.GetAxisHysteresis((EAxis)i));
+        }
+
+        TEST_ASSERT(true == controller.SetAllAxisHysteresis(kTestHysteresisValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kTestHysteresisValue == controller.GetAxisHysteresis((EAxis)i));
+    }
+
+    // Invalid hysteresis value set on a single axis and then on all axes.
+    TEST_CASE(VirtualController_SetProperty_HysteresisInvalid)
+    {
+        constexpr uint32_t kTestHysteresisValue = VirtualController::kAxisHysteresisMax + 1;
+        constexpr EAxis kTestHysteresisAxis = EAxis::X;
+
+        VirtualController controller(0, kTestMapper, std::make_unique<MockXInput>(0));
+        TEST_ASSERT(false == controller.SetAxisHysteresis(kTestHysteresisAxis, kTestHysteresisValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(VirtualController::kAxisHysteresisDefault == controller.GetAxisHysteresis((EAxis)i));
+
+        TEST_ASSERT(false == controller.SetAllAxisHysteresis(kTestHysteresisValue));
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(VirtualController::kAxisHysteresisDefault == controller.GetAxisHysteresis((EAxis)i));
+    }
+
 
     // The following sequence of tests, which together comprise the EventBuffer suite, verify that buffered events function correctly.
     // Each test case follows the basic steps of declaring test data, providing a controller with one or more updated controller state snapshots, and verifying that the resulting controller state is consistent with the input updates.
@@ -594,7 +1063,7 @@ namespace XidiTest
         VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput));
         controller.SetEventBufferCapacity(kEventBufferCapacity);
 
-        for (int i = 0; i < _countof(kXInputStates); ++i)
+        for (unsigned int i = 0; i < _countof(kXInputStates); ++i)
             controller.RefreshState();
 
         TEST_ASSERT(0 == controller.GetEventBufferCount());
@@ -647,8 +1116,7 @@ namespace XidiTest
             }
 
             Controller::SState actualStateFromSnapshot = controller.GetState();
-            Controller::SState actualStateFromBufferedEvents;
-            ZeroMemory(&actualStateFromBufferedEvents, sizeof(actualStateFromBufferedEvents));
+            Controller::SState actualStateFromBufferedEvents = {};
 
             for (unsigned int j = 0; j < controller.GetEventBufferCount(); ++j)
                 ApplyUpdateToControllerState(controller.GetEventBufferEvent(j).data, actualStateFromBufferedEvents);
@@ -706,8 +1174,7 @@ namespace XidiTest
                 lastEventCount = controller.GetEventBufferCount();
             }
 
-            Controller::SState actualStateFromBufferedEvents;
-            ZeroMemory(&actualStateFromBufferedEvents, sizeof(actualStateFromBufferedEvents));
+            Controller::SState actualStateFromBufferedEvents = {};
 
             for (unsigned int j = 0; j < controller.GetEventBufferCount(); ++j)
                 ApplyUpdateToControllerState(controller.GetEventBufferEvent(j).data, actualStateFromBufferedEvents);
@@ -715,4 +1182,154 @@ namespace XidiTest
             TEST_ASSERT(actualStateFromBufferedEvents == kExpectedControllerStates[i - 1]);
         }
     }
+
+    // Applies state updates to a virtual controller that uses a mock clock and verifies that events are stamped with the capture time of the refresh that produced them.
+    // Events produced by the same refresh should also carry consecutive sequence numbers, and those of later refreshes should be higher.
+    TEST_CASE(VirtualController_EventBuffer_CaptureTimestampAndSequence)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 0;
+        constexpr uint32_t kEventBufferCapacity = 64;
+        constexpr uint64_t kStartTimestamp = 123456789012ull;
+        constexpr uint64_t kTimestampIncrement = 250000ull;
+
+        // First update changes 2 axes, 2 buttons, and the POV. Second update changes only 1 axis.
+        constexpr XINPUT_STATE kXInputStates[] = {
+            {.dwPacketNumber = 1, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y | XINPUT_GAMEPAD_DPAD_UP, .sThumbLX = 1111, .sThumbRX = 2222}},
+            {.dwPacketNumber = 2, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y | XINPUT_GAMEPAD_DPAD_UP, .sThumbLX = 3333, .sThumbRX = 2222}}
+        };
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        for (const auto& kXInputState : kXInputStates)
+            mockXInput->ExpectCallGetState({.returnCode = ERROR_SUCCESS, .maybeOutputObject = kXInputState});
+
+        MockClock mockClock(kStartTimestamp);
+        VirtualController controller(kControllerIndex, kTestMapper, std::move(mockXInput), mockClock);
+        controller.SetEventBufferCapacity(kEventBufferCapacity);
+
+        TEST_ASSERT(true == controller.RefreshState());
+        TEST_ASSERT(5 == controller.GetEventBufferCount());
+
+        const uint32_t kFirstSequence = controller.GetEventBufferEvent(0).sequence;
+        for (uint32_t i = 0; i < controller.GetEventBufferCount(); ++i)
+        {
+            TEST_ASSERT(kStartTimestamp == controller.GetEventBufferEvent(i).timestamp);
+            TEST_ASSERT((kFirstSequence + i) == controller.GetEventBufferEvent(i).sequence);
+        }
+
+        mockClock.Advance(kTimestampIncrement);
+        TEST_ASSERT(true == controller.RefreshState());
+        TEST_ASSERT(6 == controller.GetEventBufferCount());
+        TEST_ASSERT((kStartTimestamp + kTimestampIncrement) == controller.GetEventBufferEvent(5).timestamp);
+        TEST_ASSERT(controller.GetEventBufferEvent(5).sequence > controller.GetEventBufferEvent(4).sequence);
+    }
+
+    // Verifies that reloading the configuration publishes a new snapshot and advances the generation number, and that snapshots already held by readers remain valid.
+    TEST_CASE(VirtualController_ConfigurationReload_PublishesNewSnapshot)
+    {
+        const std::shared_ptr<const Configuration::Configuration> kOldSnapshot = Globals::GetConfiguration();
+        const uint32_t kOldGeneration = Globals::GetConfigurationGeneration();
+
+        TEST_ASSERT(true == Globals::ReloadConfiguration());
+
+        const std::shared_ptr<const Configuration::Configuration> kNewSnapshot = Globals::GetConfiguration();
+        TEST_ASSERT(kNewSnapshot != kOldSnapshot);
+        TEST_ASSERT(Globals::GetConfigurationGeneration() == (kOldGeneration + 1));
+        TEST_ASSERT(kOldSnapshot->GetFileReadResult() == kNewSnapshot->GetFileReadResult());
+    }
+
+    // Verifies that applying configuration data changes only the settings it specifies, and only when their configured values differ from those applied previously.
+    // Settings the application changes in between must survive configuration data that leaves them unchanged or unspecified.
+    TEST_CASE(VirtualController_ApplyConfiguration_ChangedSettingsOnly)
+    {
+        constexpr uint32_t kConfiguredHysteresis = 500;
+        constexpr uint32_t kChangedConfiguredHysteresis = 1000;
+        constexpr uint32_t kApplicationHysteresis = 250;
+
+        XidiConfigReader reader;
+        Configuration::ConfigurationData configData;
+        VirtualController controller(0, kTestMapper, std::make_unique<SyntheticXInput>());
+        auto lock = controller.Lock();
+
+        TEST_ASSERT(Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[Properties]\nAxisHysteresis = 500\nCoalesceAxisEvents = yes\n", configData));
+        controller.ApplyConfiguration(configData);
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kConfiguredHysteresis == controller.GetAxisHysteresis((EAxis)i));
+        TEST_ASSERT(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes == controller.GetEventBufferOverflowPolicy());
+
+        // Unchanged configured values must not overwrite values the application has since set.
+        TEST_ASSERT(true == controller.SetAllAxisHysteresis(kApplicationHysteresis));
+        TEST_ASSERT(true == controller.SetEventBufferOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::DiscardOldest));
+        controller.ApplyConfiguration(configData);
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kApplicationHysteresis == controller.GetAxisHysteresis((EAxis)i));
+        TEST_ASSERT(StateChangeEventBuffer::EOverflowPolicy::DiscardOldest == controller.GetEventBufferOverflowPolicy());
+
+        // A changed configured value is applied, but a setting the configuration no longer specifies is left alone.
+        TEST_ASSERT(Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[Properties]\nAxisHysteresis = 1000\n", configData));
+        controller.ApplyConfiguration(configData);
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kChangedConfiguredHysteresis == controller.GetAxisHysteresis((EAxis)i));
+        TEST_ASSERT(StateChangeEventBuffer::EOverflowPolicy::DiscardOldest == controller.GetEventBufferOverflowPolicy());
+
+        // A configured value that reappears after having been removed counts as a change.
+        TEST_ASSERT(Configuration::EFileReadResult::Success == reader.ReadConfigurationBuffer(L"Xidi.ini", L"[Properties]\nAxisHysteresis = 1000\nCoalesceAxisEvents = yes\n", configData));
+        controller.ApplyConfiguration(configData);
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kChangedConfiguredHysteresis == controller.GetAxisHysteresis((EAxis)i));
+        TEST_ASSERT(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes == controller.GetEventBufferOverflowPolicy());
+    }
+
+    // Verifies that a virtual controller that follows the configuration continues to report correct state across a configuration reload, and that the reload does not undo property changes made by the application.
+    // The configuration file itself does not change between reads, so the test holds regardless of its contents.
+    TEST_CASE(VirtualController_ConfigurationReload_ControllerFollowsConfiguration)
+    {
+        constexpr VirtualController::TControllerIdentifier kControllerIndex = 1;
+        constexpr uint32_t kApplicationHysteresis = 1234;
+
+        const Mapper* const kConfiguredMapper = Mapper::GetConfigured();
+        TEST_ASSERT(nullptr != kConfiguredMapper);
+
+        std::unique_ptr<MockXInput> mockXInput = std::make_unique<MockXInput>(kControllerIndex);
+        mockXInput->ExpectCallGetState({
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.sThumbLX = 1000}})},
+            {.returnCode = ERROR_SUCCESS, .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.sThumbLX = 1000}})}
+        });
+
+        VirtualController controller(kControllerIndex, std::move(mockXInput));
+        const Controller::SState kStateBeforeReload = controller.GetState();
+
+        TEST_ASSERT(true == controller.SetAllAxisHysteresis(kApplicationHysteresis));
+        TEST_ASSERT(true == controller.SetEventBufferOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes));
+
+        TEST_ASSERT(true == Globals::ReloadConfiguration());
+
+        // Same data packet as before, but the reload must force the state to be recomputed rather than suppressed as a duplicate.
+        const Controller::SState kStateAfterReload = controller.GetState();
+        TEST_ASSERT(kStateAfterReload == kStateBeforeReload);
+        TEST_ASSERT(controller.GetCapabilities() == kConfiguredMapper->GetCapabilities());
+
+        for (int i = 0; i < (int)EAxis::Count; ++i)
+            TEST_ASSERT(kApplicationHysteresis == controller.GetAxisHysteresis((EAxis)i));
+        TEST_ASSERT(StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes == controller.GetEventBufferOverflowPolicy());
+    }
+
+    // Issues a realistic mix of state reads, property reads, event reads, and occasional property writes against a single virtual controller from increasing numbers of threads and reports the throughput for each.
+    // The only correctness requirement is that no operation returns an inconsistent result, but the printed report is the main output.
+    // Takes long enough that it only runs when benchmarks are enabled.
+    TEST_CASE_CONDITIONAL(VirtualController_ContentionBenchmark, AreBenchmarksEnabled())
+    {
+        double callsPerSecondSingleThread = 0.0;
+
+        PrintFormatted(L"  Operation mix of %u calls per pass, %lld ms per measurement, %u hardware threads", (unsigned int)_countof(kContentionOperationMix), (long long)kContentionDuration.count(), std::thread::hardware_concurrency());
+
+        for (const unsigned int kNumThreads : kContentionThreadCounts)
+        {
+            const double kCallsPerSecond = RunContentionBenchmark(kNumThreads);
+
+            if (1 == kNumThreads)
+                callsPerSecondSingleThread = kCallsPerSecond;
+            else
+                PrintFormatted(L"    %2u threads scale by %.2fx relative to 1 thread", kNumThreads, kCallsPerSecond / callsPerSecondSingleThread);
+        }
+    }
 }
@@ -849,6 +849,25 @@ namespace XidiTest
         TEST_ASSERT(DIERR_INVALIDPARAM == diController.GetObjectInfo(&objectInstance, 0, DIPH_DEVICE));
     }
 
+    // Verifies that object information reflects the application's data format even after object information was already retrieved using the native data format.
+    // Object instance information is cached, so this exercises invalidation of the cache when the data format is set.
+    TEST_CASE(VirtualDirectInputDevice_GetObjectInfo_DataFormatChange)
+    {
+        VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController());
+        const DWORD kButtonType = DIDFT_MAKEINSTANCE(1) | DIDFT_PSHBUTTON;
+        DIDEVICEOBJECTINSTANCE objectInstance = {.dwSize = sizeof(DIDEVICEOBJECTINSTANCE)};
+
+        TEST_ASSERT(DI_OK == diController.GetObjectInfo(&objectInstance, kButtonType, DIPH_BYID));
+        TEST_ASSERT(offsetof(Controller::SState, button) + 1 == objectInstance.dwOfs);
+
+        TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+
+        objectInstance = {.dwSize = sizeof(DIDEVICEOBJECTINSTANCE)};
+        TEST_ASSERT(DI_OK == diController.GetObjectInfo(&objectInstance, kButtonType, DIPH_BYID));
+        TEST_ASSERT(offsetof(STestDataPacket, button[1]) == objectInstance.dwOfs);
+        TEST_ASSERT(kButtonType == objectInstance.dwType);
+    }
+
 
     // The following sequence of tests, which together comprise the Properties suite, exercise the DirectInputDevice interface methods GetProperty and SetProperty.
     // Scopes vary, so more details are provided with each test case.
@@ -1118,4 +1137,226 @@ namespace XidiTest
         // Physical Range (read-only)
         TEST_ASSERT(FAILED(diController.GetProperty(DIPROP_PHYSICALRANGE, nullptr)));
     }
+
+
+    // The following sequence of tests, which together comprise the ActionMap suite, exercise the DirectInput 8 action mapping methods BuildActionMap and SetActionMap.
+    // Scopes vary, so more details are provided with each test case.
+
+    // Nominal situation in which an application builds an action map, sets it, and then retrieves buffered events tagged with action values.
+    // Actions are assigned elements of the appropriate type in order, keyboard actions are left unassigned, and only assigned elements generate events.
+    TEST_CASE(VirtualDirectInputDevice_ActionMap_Nominal)
+    {
+        constexpr DWORD kBufferSize = 16;
+
+        constexpr UINT_PTR kAppDataSteer = 1001;
+        constexpr UINT_PTR kAppDataKeyboard = 1002;
+        constexpr UINT_PTR kAppDataFire = 1003;
+        constexpr UINT_PTR kAppDataJump = 1004;
+
+        DIACTIONW actions[] = {
+            {.uAppData = kAppDataSteer, .dwSemantic = DIAXIS_ANY_1},
+            {.uAppData = kAppDataKeyboard, .dwSemantic = DIKEYBOARD_SPACE},
+            {.uAppData = kAppDataFire, .dwSemantic = DIBUTTON_ANY(0)},
+            {.uAppData = kAppDataJump, .dwSemantic = DIBUTTON_ANY(1)}
+        };
+
+        DIACTIONFORMATW actionFormat;
+        ZeroMemory(&actionFormat, sizeof(actionFormat));
+        actionFormat.dwSize = sizeof(actionFormat);
+        actionFormat.dwActionSize = sizeof(actions[0]);
+        actionFormat.dwDataSize = _countof(actions) * sizeof(DWORD);
+        actionFormat.dwNumActions = _countof(actions);
+        actionFormat.rgoAction = actions;
+        actionFormat.dwBufferSize = kBufferSize;
+        actionFormat.lAxisMin = Controller::kAnalogValueMin;
+        actionFormat.lAxisMax = Controller::kAnalogValueMax;
+
+        std::unique_ptr<MockXInput> xinput = std::make_unique<MockXInput>(kTestControllerIdentifier);
+        xinput->ExpectCallGetState({
+            .returnCode = ERROR_SUCCESS,
+            .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.wButtons = XINPUT_GAMEPAD_A, .sThumbLX = -1234, .sThumbRX = 5678}})
+        });
+
+        VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController(std::move(xinput)));
+        GUID expectedInstanceGuid;
+        MakeVirtualControllerInstanceGuid(expectedInstanceGuid, kTestControllerIdentifier);
+
+        // Based on the mapper defined at the top of this file, the first axis is the X axis and the first two buttons are buttons 1 and 2.
+        TEST_ASSERT(DI_OK == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+        TEST_ASSERT(DIAH_DEFAULT == actions[0].dwHow);
+        TEST_ASSERT(expectedInstanceGuid == actions[0].guidInstance);
+        TEST_ASSERT((DWORD)(DIDFT_ABSAXIS | DIDFT_MAKEINSTANCE(0)) == actions[0].dwObjID);
+        TEST_ASSERT(DIAH_UNMAPPED == actions[1].dwHow);
+        TEST_ASSERT(DIAH_DEFAULT == actions[2].dwHow);
+        TEST_ASSERT((DWORD)(DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE(0)) == actions[2].dwObjID);
+        TEST_ASSERT(DIAH_DEFAULT == actions[3].dwHow);
+        TEST_ASSERT((DWORD)(DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE(1)) == actions[3].dwObjID);
+
+        // Setting the action map also enables event buffering, so no separate buffer size property is needed.
+        TEST_ASSERT(DI_OK == diController.SetActionMap(&actionFormat, nullptr, DIDSAM_DEFAULT));
+
+        // The right thumbstick is not assigned to any action, and button 2 is not pressed, so only two events are expected.
+        DIDEVICEOBJECTDATA objectData[kBufferSize];
+        DWORD numObjectDataElements = _countof(objectData);
+
+        TEST_ASSERT(DI_OK == diController.Poll());
+        TEST_ASSERT(DI_OK == diController.GetDeviceData(sizeof(DIDEVICEOBJECTDATA), objectData, &numObjectDataElements, 0));
+        TEST_ASSERT(2 == numObjectDataElements);
+
+        for (DWORD i = 0; i < numObjectDataElements; ++i)
+        {
+            switch (objectData[i].dwOfs)
+            {
+            case (0 * sizeof(DWORD)):
+                TEST_ASSERT(kAppDataSteer == objectData[i].uAppData);
+                TEST_ASSERT(-1234 == (TAxisValue)objectData[i].dwData);
+                break;
+
+            case (2 * sizeof(DWORD)):
+                TEST_ASSERT(kAppDataFire == objectData[i].uAppData);
+                TEST_ASSERT(DataFormat::kButtonValuePressed == objectData[i].dwData);
+                break;
+
+            default:
+                TEST_FAILED_BECAUSE(L"Unexpected event offset %u.", objectData[i].dwOfs);
+            }
+        }
+    }
+
+    // Setting an action map sets the event buffer size and the range of every axis action, except for axis actions that opt out of the range.
+    // Buffered events for axes are reported within the range set by the action map.
+    TEST_CASE(VirtualDirectInputDevice_ActionMap_BufferSizeAndAxisRange)
+    {
+        constexpr DWORD kBufferSize = 8;
+        constexpr LONG kRangeMin = -100;
+        constexpr LONG kRangeMax = 100;
+
+        constexpr UINT_PTR kAppDataSteer = 2001;
+        constexpr UINT_PTR kAppDataThrottle = 2002;
+
+        DIACTIONW actions[] = {
+            {.uAppData = kAppDataSteer, .dwSemantic = DIAXIS_ANY_1},
+            {.uAppData = kAppDataThrottle, .dwSemantic = DIAXIS_ANY_2, .dwFlags = DIA_NORANGE}
+        };
+
+        DIACTIONFORMATW actionFormat;
+        ZeroMemory(&actionFormat, sizeof(actionFormat));
+        actionFormat.dwSize = sizeof(actionFormat);
+        actionFormat.dwActionSize = sizeof(actions[0]);
+        actionFormat.dwDataSize = _countof(actions) * sizeof(DWORD);
+        actionFormat.dwNumActions = _countof(actions);
+        actionFormat.rgoAction = actions;
+        actionFormat.dwBufferSize = kBufferSize;
+        actionFormat.lAxisMin = kRangeMin;
+        actionFormat.lAxisMax = kRangeMax;
+
+        std::unique_ptr<MockXInput> xinput = std::make_unique<MockXInput>(kTestControllerIdentifier);
+        xinput->ExpectCallGetState({
+            .returnCode = ERROR_SUCCESS,
+            .maybeOutputObject = XINPUT_STATE({.dwPacketNumber = 1, .Gamepad = {.sThumbLX = 32767}})
+        });
+
+        VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController(std::move(xinput)));
+
+        // Based on the mapper defined at the top of this file, the first axis is the X axis and the second axis is the Y axis.
+        TEST_ASSERT(DI_OK == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+        TEST_ASSERT((DWORD)(DIDFT_ABSAXIS | DIDFT_MAKEINSTANCE(0)) == actions[0].dwObjID);
+        TEST_ASSERT((DWORD)(DIDFT_ABSAXIS | DIDFT_MAKEINSTANCE(1)) == actions[1].dwObjID);
+        TEST_ASSERT(DI_OK == diController.SetActionMap(&actionFormat, nullptr, DIDSAM_DEFAULT));
+
+        DIPROPDWORD actualBufferSize = {.diph = {.dwSize = sizeof(DIPROPDWORD), .dwHeaderSize = sizeof(DIPROPHEADER), .dwObj = 0, .dwHow = DIPH_DEVICE}, .dwData = (DWORD)-1};
+        TEST_ASSERT(DI_OK == diController.GetProperty(DIPROP_BUFFERSIZE, (LPDIPROPHEADER)&actualBufferSize));
+        TEST_ASSERT(kBufferSize == actualBufferSize.dwData);
+
+        DIPROPRANGE actualRange = {.diph = {.dwSize = sizeof(DIPROPRANGE), .dwHeaderSize = sizeof(DIPROPHEADER), .dwObj = actions[0].dwObjID, .dwHow = DIPH_BYID}, .lMin = -1, .lMax = -1};
+        TEST_ASSERT(DI_OK == diController.GetProperty(DIPROP_RANGE, (LPDIPROPHEADER)&actualRange));
+        TEST_ASSERT(kRangeMin == actualRange.lMin);
+        TEST_ASSERT(kRangeMax == actualRange.lMax);
+
+        actualRange = {.diph = {.dwSize = sizeof(DIPROPRANGE), .dwHeaderSize = sizeof(DIPROPHEADER), .dwObj = actions[1].dwObjID, .dwHow = DIPH_BYID}, .lMin = -1, .lMax = -1};
+        TEST_ASSERT(DI_OK == diController.GetProperty(DIPROP_RANGE, (LPDIPROPHEADER)&actualRange));
+        TEST_ASSERT(Controller::kAnalogValueMin == actualRange.lMin);
+        TEST_ASSERT(Controller::kAnalogValueMax == actualRange.lMax);
+
+        // Only the X axis moves, all the way to its maximum, which the action map's range turns into the range maximum.
+        DIDEVICEOBJECTDATA objectData[kBufferSize];
+        DWORD numObjectDataElements = _countof(objectData);
+
+        TEST_ASSERT(DI_OK == diController.Poll());
+        TEST_ASSERT(DI_OK == diController.GetDeviceData(sizeof(DIDEVICEOBJECTDATA), objectData, &numObjectDataElements, 0));
+        TEST_ASSERT(1 == numObjectDataElements);
+        TEST_ASSERT((0 * sizeof(DWORD)) == objectData[0].dwOfs);
+        TEST_ASSERT(kAppDataSteer == objectData[0].uAppData);
+        TEST_ASSERT(kRangeMax == (TAxisValue)objectData[0].dwData);
+    }
+
+    // Application requests a specific element for one action and then asks for the remaining actions to be assigned.
+    // The requested element should be kept and not assigned to any other action.
+    TEST_CASE(VirtualDirectInputDevice_ActionMap_AppMapped)
+    {
+        DIACTIONW actions[] = {
+            {.uAppData = 1, .dwSemantic = DIBUTTON_ANY(0)},
+            {.uAppData = 2, .dwSemantic = DIBUTTON_ANY(1), .dwFlags = DIA_APPMAPPED}
+        };
+
+        VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController());
+        MakeVirtualControllerInstanceGuid(actions[1].guidInstance, kTestControllerIdentifier);
+        actions[1].dwObjID = (DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE(0));
+
+        DIACTIONFORMATW actionFormat;
+        ZeroMemory(&actionFormat, sizeof(actionFormat));
+        actionFormat.dwSize = sizeof(actionFormat);
+        actionFormat.dwActionSize = sizeof(actions[0]);
+        actionFormat.dwDataSize = _countof(actions) * sizeof(DWORD);
+        actionFormat.dwNumActions = _countof(actions);
+        actionFormat.rgoAction = actions;
+
+        TEST_ASSERT(DI_OK == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+        TEST_ASSERT(DIAH_APPREQUESTED == actions[1].dwHow);
+        TEST_ASSERT((DWORD)(DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE(0)) == actions[1].dwObjID);
+        TEST_ASSERT(DIAH_DEFAULT == actions[0].dwHow);
+        TEST_ASSERT((DWORD)(DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE(1)) == actions[0].dwObjID);
+        TEST_ASSERT(DI_OK == diController.SetActionMap(&actionFormat, nullptr, DIDSAM_DEFAULT));
+    }
+
+    // Invalid action formats are rejected and leave the data format unaltered.
+    TEST_CASE(VirtualDirectInputDevice_ActionMap_Invalid)
+    {
+        DIACTIONW actions[] = {
+            {.uAppData = 1, .dwSemantic = DIBUTTON_ANY(0)}
+        };
+
+        DIACTIONFORMATW actionFormat;
+        ZeroMemory(&actionFormat, sizeof(actionFormat));
+        actionFormat.dwSize = sizeof(actionFormat);
+        actionFormat.dwActionSize = sizeof(actions[0]);
+        actionFormat.dwDataSize = _countof(actions) * sizeof(DWORD);
+        actionFormat.dwNumActions = _countof(actions);
+        actionFormat.rgoAction = actions;
+
+        VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController());
+        TEST_ASSERT(DIERR_INVALIDPARAM == diController.BuildActionMap(nullptr, nullptr, DIDBAM_DEFAULT));
+        TEST_ASSERT(DIERR_INVALIDPARAM == diController.SetActionMap(nullptr, nullptr, DIDSAM_DEFAULT));
+
+        actionFormat.dwActionSize = sizeof(actions[0]) + 1;
+        TEST_ASSERT(DIERR_INVALIDPARAM == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+        actionFormat.dwActionSize = sizeof(actions[0]);
+
+        TEST_ASSERT(DI_OK == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+
+        // Data packet must have room for every action.
+        actionFormat.dwDataSize = 0;
+        TEST_ASSERT(DIERR_INVALIDPARAM == diController.SetActionMap(&actionFormat, nullptr, DIDSAM_DEFAULT));
+        TEST_ASSERT(false == diController.IsApplicationDataFormatSet());
+        actionFormat.dwDataSize = _countof(actions) * sizeof(DWORD);
+
+        // Axis actions need a valid range.
+        actions[0].dwSemantic = DIAXIS_ANY_1;
+        actions[0].dwHow = DIAH_UNMAPPED;
+        TEST_ASSERT(DI_OK == diController.BuildActionMap(&actionFormat, nullptr, DIDBAM_DEFAULT));
+        actionFormat.lAxisMin = 100;
+        actionFormat.lAxisMax = 100;
+        TEST_ASSERT(DIERR_INVALIDPARAM == diController.SetActionMap(&actionFormat, nullptr, DIDSAM_DEFAULT));
+        TEST_ASSERT(false == diController.IsApplicationDataFormatSet());
+    }
 }
@@ -70,7 +70,7 @@ namespace XidiTest
 
             if (testCase->CanRun())
             {
-                PrintFormatted(L"[ %-9s ] %s", L"RUN", name.c_str());
+                PrintFormatted(L"[ %-9ls ] %ls", L"RUN", name.c_str());
 
                 bool testCasePassed = false;
                 try
@@ -86,11 +86,11 @@ namespace XidiTest
                 if (true != testCasePassed)
                     failingTests.insert(name.c_str());
 
-                PrintFormatted(L"[ %9s ] %s%s", (true == testCasePassed ? L"PASS" : L"FAIL"), name.c_str(), (lastTestCase ? L"" : L"\n"));
+                PrintFormatted(L"[ %9ls ] %ls%ls", (true == testCasePassed ? L"PASS" : L"FAIL"), name.c_str(), (lastTestCase ? L"" : L"\n"));
             }
             else
             {
-                PrintFormatted(L"[  %-8s ] %s%s", L"SKIPPED", name.c_str(), (lastTestCase ? L"" : L"\n"));
+                PrintFormatted(L"[  %-8ls ] %ls%ls", L"SKIPPED", name.c_str(), (lastTestCase ? L"" : L"\n"));
                 numSkippedTests += 1;
             }
         }
@@ -99,7 +99,7 @@ namespace XidiTest
 
         const int numFailingTests = (int)failingTests.size();
 
-        if (testCases.size() == numSkippedTests)
+        if ((int)testCases.size() == numSkippedTests)
         {
             Print(L"All tests skipped.\n");
         }
@@ -133,7 +133,7 @@ namespace XidiTest
         if (numFailingTests > 0)
         {
             for (const wchar_t* failingTestName : failingTests)
-                PrintFormatted(L"    %s", failingTestName);
+                PrintFormatted(L"    %ls", failingTestName);
 
             Print(L"\n");
         }
@@ -147,7 +147,7 @@ namespace XidiTest
 
 /// Runs all tests cases.
 /// @return Number of failing tests (0 means all tests passed).
-int main(int argc, const char* argv[])
+int main(void)
 {
     return XidiTest::Harness::RunAllTests();
 }
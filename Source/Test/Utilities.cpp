@@ -9,26 +9,44 @@
  *   Implementation of test utility functions.
  *****************************************************************************/
 
+#include "ApiPlatform.h"
+#include "Platform.h"
+#include "Utilities.h"
+
 #include <cstdarg>
 #include <cstdio>
-#include <sal.h>
-#include <windows.h>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+#include <string_view>
 
 namespace XidiTest
 {
     // -------- FUNCTIONS -------------------------------------------------- //
     // See "Harness.h" for documentation.
 
+    bool AreBenchmarksEnabled(void)
+    {
+#ifdef _WIN32
+        return (0 != GetEnvironmentVariable(kBenchmarkEnvironmentVariable, nullptr, 0));
+#else
+        const std::wstring_view kVariableName = kBenchmarkEnvironmentVariable;
+        return (nullptr != std::getenv(std::string(kVariableName.cbegin(), kVariableName.cend()).c_str()));
+#endif
+    }
+
+    // --------
+
     void Print(const wchar_t* const str)
     {
-        if (IsDebuggerPresent())
+        if (Xidi::Platform::IsDebuggerAttached())
         {
-            OutputDebugString(str);
-            OutputDebugString(L"\n");
+            Xidi::Platform::OutputDebuggerText(str);
+            Xidi::Platform::OutputDebuggerText(L"\n");
         }
         else
         {
-            _putws(str);
+            wprintf(L"%ls\n", str);
         }
     }
 
@@ -40,7 +58,7 @@ namespace XidiTest
 
         va_list args;
         va_start(args, format);
-        vswprintf_s(formattedStringBuffer, _countof(formattedStringBuffer), format, args);
+        vswprintf(formattedStringBuffer, _countof(formattedStringBuffer), format, args);
         va_end(args);
 
         Print(formattedStringBuffer);
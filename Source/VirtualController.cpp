@@ -9,15 +9,28 @@
  *   Implementation of a complete virtual controller.
  *****************************************************************************/
 
-#include "ApiWindows.h"
+#include "ApiXInput.h"
+#include "Clock.h"
+#include "Configuration.h"
 #include "ControllerTypes.h"
+#include "Globals.h"
 #include "Mapper.h"
 #include "Message.h"
+#include "MessageRateLimiter.h"
+#include "PrefetchScheduler.h"
+#include "SequenceLock.h"
+#include "Statistics.h"
+#include "Strings.h"
 #include "VirtualController.h"
 #include "XInputInterface.h"
 
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 
 namespace Xidi
@@ -44,18 +57,36 @@ namespace Xidi
             return newRangeOrigin + (int32_t)((oldRangeValueDisp * newRangeMagnitudeMax) / oldRangeMagnitudeMax);
         }
 
+        /// Quantizes an axis value to the granularity specified in the supplied axis properties.
+        /// Values are quantized toward neutral, and the range extremes are always reportable regardless of granularity.
+        /// @param [in] axisValue Axis value that has already been transformed into the axis range.
+        /// @param [in] axisProperties Axis properties to apply.
+        /// @return Quantized axis value.
+        static inline int32_t QuantizeAxisValue(int32_t axisValue, const VirtualController::SAxisProperties& axisProperties)
+        {
+            if ((axisProperties.granularity <= VirtualController::kAxisGranularityMin) || (axisValue == axisProperties.rangeMin) || (axisValue == axisProperties.rangeMax))
+                return axisValue;
+
+            const int64_t kDisplacement = (int64_t)axisValue - (int64_t)axisProperties.rangeNeutral;
+            return axisProperties.rangeNeutral + (int32_t)((kDisplacement / (int64_t)axisProperties.granularity) * (int64_t)axisProperties.granularity);
+        }
+
         /// Looks for differences between two virtual controller state objects and submits them as events to the specified event buffer.
         /// Events are only submitted if the associated virtual controller element is included in the event filter.
+        /// All events submitted together share the same timestamp and receive one contiguous block of sequence numbers.
+        /// @param [in] controllerId Identifier of the virtual controller that owns the event buffer, used for recording statistics.
         /// @param [in] oldState Old controller state, the baseline.
         /// @param [in] newState New controller state, which is compared with the old controller state. If different, controller element values submitted to the event buffer come from this object.
+        /// @param [in] captureTimestamp Time, in nanoseconds, at which the new controller state was captured.
         /// @param [in] eventFilter Filter which specifies which virtual controller elements are allowed to generate events.
         /// @param [in,out] eventBuffer Event buffer object to which events are submitted.
-        static inline void SubmitStateChangeEvents(const SState& oldState, const SState& newState, const VirtualController::EventFilter& eventFilter, StateChangeEventBuffer& eventBuffer)
+        static inline void SubmitStateChangeEvents(VirtualController::TControllerIdentifier controllerId, const SState& oldState, const SState& newState, uint64_t captureTimestamp, const VirtualController::EventFilter& eventFilter, StateChangeEventBuffer& eventBuffer)
         {
             if (true == eventBuffer.IsEnabled())
             {
-                // DirectInput event buffer timestamps are allowed to overflow every ~50 days.
-                const uint32_t kTimestamp = GetTickCount();
+                // Events are gathered first so that their sequence numbers can be reserved all at once.
+                StateChangeEventBuffer::SEventData pendingEvents[(int)EAxis::Count + (int)EButton::Count + 1];
+                uint32_t numPendingEvents = 0;
 
                 for (unsigned int i = 0; i < _countof(oldState.axis); ++i)
                 {
@@ -64,7 +95,7 @@ namespace Xidi
                         const SElementIdentifier kAxisElement = {.type = EElementType::Axis, .axis = (EAxis)i};
 
                         if (eventFilter.Contains(kAxisElement))
-                            eventBuffer.AppendEvent({.element = kAxisElement, .value = {.axis = newState.axis[i]}}, kTimestamp);
+                            pendingEvents[numPendingEvents++] = {.element = kAxisElement, .value = {.axis = newState.axis[i]}};
                     }
                 }
 
@@ -75,25 +106,39 @@ namespace Xidi
                         const SElementIdentifier kButtonElement = {.type = EElementType::Button, .button = (EButton)i};
 
                         if (eventFilter.Contains(kButtonElement))
-                            eventBuffer.AppendEvent({.element = kButtonElement, .value = {.button = newState.button[i]}}, kTimestamp);
+                            pendingEvents[numPendingEvents++] = {.element = kButtonElement, .value = {.button = newState.button[i]}};
                     }
                 }
 
                 if (oldState.povDirection.all != newState.povDirection.all)
                 {
-                    const SElementIdentifier kPovElement = {.type = EElementType::Pov};
+                    const SElementIdentifier kPovElement = {.type = EElementType::Pov, .axis = (EAxis)0};
 
                     if (eventFilter.Contains(kPovElement))
-                        eventBuffer.AppendEvent({.element = kPovElement, .value = {.povDirection = {.all = newState.povDirection.all}}}, kTimestamp);
+                        pendingEvents[numPendingEvents++] = {.element = kPovElement, .value = {.povDirection = {.all = newState.povDirection.all}}};
+                }
+
+                if (0 == numPendingEvents)
+                    return;
+
+                const uint32_t kFirstSequence = StateChangeEventBuffer::ReserveSequenceNumbers(numPendingEvents);
+                uint32_t numEventsDropped = 0;
+
+                for (uint32_t i = 0; i < numPendingEvents; ++i)
+                {
+                    if (true == eventBuffer.AppendEvent(pendingEvents[i], captureTimestamp, kFirstSequence + i))
+                        numEventsDropped += 1;
                 }
+
+                Statistics::RecordEvents(controllerId, numPendingEvents, numEventsDropped);
             }
         }
 
-        /// Transforms a raw axis value using the supplied axis properties.
-        /// @param [in] axisValueRaw Raw axis value as obtained from a mapper.
-        /// @param [in] axisProperties Axis properties to apply.
-        /// @return Axis value that results from applying the transformation.
-        static int32_t TransformAxisValue(int32_t axisValueRaw, const VirtualController::SAxisProperties& axisProperties)
+
+        // -------- CLASS METHODS ------------------------------------------ //
+        // See "VirtualController.h" for documentation.
+
+        int32_t VirtualController::TransformAxisValue(int32_t axisValueRaw, const SAxisProperties& axisProperties)
         {
             if (axisValueRaw > kAnalogValueNeutral)
             {
@@ -116,22 +161,227 @@ namespace Xidi
         }
 
 
-        // -------- INSTANCE METHODS --------------------------------------- //
+        // -------- CONSTRUCTION AND DESTRUCTION --------------------------- //
         // See "VirtualController.h" for documentation.
 
-        void VirtualController::ApplyProperties(SState& controllerState) const
+        VirtualController::VirtualController(TControllerIdentifier controllerId, std::unique_ptr<IXInput>&& xinput, const IClock& clock) : kControllerIdentifier(controllerId), controllerMutex(), eventBufferMutex(), eventBuffer(), eventFilter(), mapper(Mapper::GetConfigured()), kFollowsConfiguration(true), configurationGeneration(Globals::GetConfigurationGeneration()), configuredOverflowPolicy(), configuredAxisHysteresis(), properties(), publishedAxisProperties(), publishedDeviceProperties(), state(), publishedState(), mappedXInputState(), mappedState(), mappedStateValid(false), suppressionStatistics(), stateIdentifier(), stateRefreshNeeded(true), xinput(std::move(xinput)), clock(clock), readCadence(), stateCaptureTimestamp(0), statePrefetched(false), prefetchedStateChanged(false), stagedPropertyChanges(), stagedPropertyChangesMutex(), stagedPropertyChangesAvailable(false), stateMessageRateLimiter()
         {
-            const SCapabilities controllerCapabilities = mapper.GetCapabilities();
+            const std::shared_ptr<const Configuration::Configuration> kConfiguration = Globals::GetConfiguration();
+            if (true == kConfiguration->IsDataValid())
+                ApplyConfiguration(kConfiguration->GetData());
+        }
+
+
+        // -------- INTERNAL INSTANCE METHODS ------------------------------ //
+        // See "VirtualController.h" for documentation.
+
+        void VirtualController::FollowConfigurationChanges(void)
+        {
+            const uint32_t kConfigurationGeneration = Globals::GetConfigurationGeneration();
+            if (kConfigurationGeneration == configurationGeneration)
+                return;
+
+            configurationGeneration = kConfigurationGeneration;
+
+            // Applications size their view of a controller based on its capabilities, so a mapper that changes the capabilities cannot be swapped in underneath them.
+            const Mapper* const kCurrentMapper = mapper.load();
+            const Mapper* const kConfiguredMapper = Mapper::GetConfigured();
+            if ((nullptr != kConfiguredMapper) && (kConfiguredMapper != kCurrentMapper))
+            {
+                if (kConfiguredMapper->GetCapabilities() == kCurrentMapper->GetCapabilities())
+                {
+                    Message::OutputFormatted(Message::ESeverity::Info, L"Virtual controller %u: Switched to mapper '%s' following a configuration reload.", (1 + kControllerIdentifier), kConfiguredMapper->GetName().data());
+                    mapper.store(kConfiguredMapper);
+                }
+                else
+                {
+                    Message::OutputFormatted(Message::ESeverity::Warning, L"Virtual controller %u: Not switching to mapper '%s' following a configuration reload because its capabilities differ from those of mapper '%s'. The new mapper takes effect when the application next creates a virtual controller.", (1 + kControllerIdentifier), kConfiguredMapper->GetName().data(), kCurrentMapper->GetName().data());
+                }
+            }
+
+            const std::shared_ptr<const Configuration::Configuration> kConfiguration = Globals::GetConfiguration();
+            if (true == kConfiguration->IsDataValid())
+                ApplyConfiguration(kConfiguration->GetData());
+
+            // Force the next refresh to recompute state even if XInput reports the same packet, so that changes to the mapper and properties become visible right away.
+            stateIdentifier.packetNumber = 0;
+            mappedStateValid = false;
+        }
+
+        // --------
+
+        void VirtualController::ApplyStagedPropertyChanges(void)
+        {
+            if (false == stagedPropertyChangesAvailable.load(std::memory_order_acquire))
+                return;
+
+            std::vector<SPropertyChanges> changesToApply;
+
+            {
+                std::scoped_lock lock(stagedPropertyChangesMutex);
+                changesToApply.swap(stagedPropertyChanges);
+                stagedPropertyChangesAvailable.store(false, std::memory_order_relaxed);
+            }
+
+            for (const SPropertyChanges& changes : changesToApply)
+            {
+                const int kFirstAxis = ((true == changes.axis.has_value()) ? (int)*changes.axis : 0);
+                const int kLastAxis = ((true == changes.axis.has_value()) ? (int)*changes.axis : ((int)EAxis::Count - 1));
+
+                for (int i = kFirstAxis; i <= kLastAxis; ++i)
+                {
+                    if (true == changes.deadzone.has_value())
+                        properties.axis[i].SetDeadzone(*changes.deadzone);
+
+                    if (true == changes.saturation.has_value())
+                        properties.axis[i].SetSaturation(*changes.saturation);
+
+                    if (true == changes.granularity.has_value())
+                        properties.axis[i].SetGranularity(*changes.granularity);
+
+                    if (true == changes.range.has_value())
+                        properties.axis[i].SetRange(changes.range->first, changes.range->second);
+
+                    // The hysteresis band depends on the range, so it is recomputed whenever either of them changes.
+                    if ((true == changes.hysteresis.has_value()) || (true == changes.range.has_value()))
+                        properties.axis[i].SetHysteresis(changes.hysteresis.value_or(properties.axis[i].hysteresis));
+                }
+
+                if (true == changes.ffGain.has_value())
+                    properties.device.SetFfGain(*changes.ffGain);
+
+                if (true == changes.eventBufferCapacity.has_value())
+                {
+                    auto eventBufferLock = LockEventBuffer();
+                    if (*changes.eventBufferCapacity != eventBuffer.GetCapacity())
+                        eventBuffer.SetCapacity(*changes.eventBufferCapacity);
+                }
+
+                // Capabilities were checked when the changes were staged, but a configuration change may have swapped the mapper since then.
+                if ((nullptr != changes.mapper) && (changes.mapper->GetCapabilities() == mapper.load()->GetCapabilities()))
+                    mapper.store(changes.mapper);
+            }
+
+            PublishProperties();
+            stateIdentifier.packetNumber = 0;
+            mappedStateValid = false;
+        }
+
+        // --------
+
+        void VirtualController::ApplyPropertiesToAxes(SState& controllerState, uint32_t axesToTransform, SSuppressionStatistics* suppressionStatisticsToUpdate) const
+        {
+            const SCapabilities controllerCapabilities = mapper.load()->GetCapabilities();
 
             for (int i = 0; i < controllerCapabilities.numAxes; ++i)
             {
                 const EAxis axis = controllerCapabilities.axisType[i];
-                controllerState.axis[(int)axis] = TransformAxisValue(controllerState.axis[(int)axis], properties.axis[(int)axis]);
+                if (0 == (axesToTransform & (1u << (int)axis)))
+                    continue;
+
+                const SAxisProperties& axisProperties = properties.axis[(int)axis];
+                const int32_t kPreviousAxisValue = state.axis[(int)axis];
+
+                const int32_t kTransformedAxisValue = TransformAxisValue(controllerState.axis[(int)axis], axisProperties);
+                int32_t axisValue = QuantizeAxisValue(kTransformedAxisValue, axisProperties);
+
+                if ((kTransformedAxisValue != kPreviousAxisValue) && (axisValue == kPreviousAxisValue))
+                {
+                    if (nullptr != suppressionStatisticsToUpdate)
+                        suppressionStatisticsToUpdate->numSuppressedByGranularity += 1;
+                }
+                else if ((axisValue != kPreviousAxisValue) && (axisProperties.hysteresisRangeBand > 0))
+                {
+                    // Neutral and the range extremes are always allowed through so that an axis can settle exactly where the user left it.
+                    const bool kIsAnchorValue = ((axisValue == axisProperties.rangeNeutral) || (axisValue == axisProperties.rangeMin) || (axisValue == axisProperties.rangeMax));
+                    const int64_t kChangeMagnitude = std::abs((int64_t)axisValue - (int64_t)kPreviousAxisValue);
+
+                    if ((false == kIsAnchorValue) && (kChangeMagnitude <= (int64_t)axisProperties.hysteresisRangeBand))
+                    {
+                        axisValue = kPreviousAxisValue;
+
+                        if (nullptr != suppressionStatisticsToUpdate)
+                            suppressionStatisticsToUpdate->numSuppressedByHysteresis += 1;
+                    }
+                }
+
+                controllerState.axis[(int)axis] = axisValue;
             }
         }
 
         // --------
 
+        void VirtualController::PublishProperties(void)
+        {
+            for (unsigned int i = 0; i < _countof(properties.axis); ++i)
+                publishedAxisProperties[i].Write(properties.axis[i]);
+
+            publishedDeviceProperties.Write(properties.device);
+        }
+
+
+        // -------- INSTANCE METHODS --------------------------------------- //
+        // See "VirtualController.h" for documentation.
+
+        void VirtualController::ApplyConfiguration(const Configuration::ConfigurationData& configData)
+        {
+            std::optional<StateChangeEventBuffer::EOverflowPolicy> overflowPolicy;
+            std::optional<uint32_t> axisHysteresis;
+
+            if (true == configData.SectionNamePairExists(Strings::kStrConfigurationSectionProperties, Strings::kStrConfigurationSettingPropertiesCoalesceAxisEvents))
+                overflowPolicy = ((true == configData[Strings::kStrConfigurationSectionProperties][Strings::kStrConfigurationSettingPropertiesCoalesceAxisEvents].FirstValue().GetBooleanValue()) ? StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes : StateChangeEventBuffer::EOverflowPolicy::DiscardOldest);
+
+            if (true == configData.SectionNamePairExists(Strings::kStrConfigurationSectionProperties, Strings::kStrConfigurationSettingPropertiesAxisHysteresis))
+                axisHysteresis = (uint32_t)configData[Strings::kStrConfigurationSectionProperties][Strings::kStrConfigurationSettingPropertiesAxisHysteresis].FirstValue().GetIntegerValue();
+
+            // A setting that the configuration does not specify, or that it specifies with the same value as last time, is left alone so that it keeps any value the application has since set.
+            if ((true == overflowPolicy.has_value()) && (overflowPolicy != configuredOverflowPolicy))
+            {
+                {
+                    auto eventBufferLock = LockEventBuffer();
+                    eventBuffer.SetOverflowPolicy(*overflowPolicy);
+                }
+
+                Message::OutputFormatted(Message::ESeverity::Info, L"Virtual controller %u: Applied configured event buffer overflow policy (coalesce axis events = %s).", (1 + kControllerIdentifier), ((StateChangeEventBuffer::EOverflowPolicy::CoalesceAxes == *overflowPolicy) ? L"yes" : L"no"));
+            }
+
+            if ((true == axisHysteresis.has_value()) && (axisHysteresis != configuredAxisHysteresis))
+            {
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
+                    properties.axis[i].SetHysteresis(*axisHysteresis);
+
+                PublishProperties();
+                mappedStateValid = false;
+
+                Message::OutputFormatted(Message::ESeverity::Info, L"Virtual controller %u: Applied configured axis hysteresis (%u).", (1 + kControllerIdentifier), *axisHysteresis);
+            }
+
+            configuredOverflowPolicy = overflowPolicy;
+            configuredAxisHysteresis = axisHysteresis;
+        }
+
+        // --------
+
+        void VirtualController::ApplyProperties(SState& controllerState, SSuppressionStatistics* suppressionStatisticsToUpdate) const
+        {
+            ApplyPropertiesToAxes(controllerState, UINT32_MAX, suppressionStatisticsToUpdate);
+        }
+
+        // --------
+
+        VirtualController::SProperties VirtualController::GetProperties(void) const
+        {
+            SProperties currentProperties;
+
+            for (unsigned int i = 0; i < _countof(currentProperties.axis); ++i)
+                currentProperties.axis[i] = publishedAxisProperties[i].Read();
+
+            currentProperties.device = publishedDeviceProperties.Read();
+            return currentProperties;
+        }
+
+        // --------
+
         SState VirtualController::GetState(void)
         {
             auto lock = Lock();
@@ -140,20 +390,70 @@ namespace Xidi
 
         // --------
 
+        VirtualController::SSuppressionStatistics VirtualController::GetSuppressionStatistics(void)
+        {
+            auto lock = Lock();
+            return suppressionStatistics;
+        }
+
+        // --------
+
         const SState& VirtualController::GetStateRef(void)
         {
+            const uint64_t kReadTimestamp = clock.GetTimestamp();
+
+            if ((true == statePrefetched) && (true == readCadence.IsPrefetchStale(stateCaptureTimestamp, kReadTimestamp)))
+            {
+                statePrefetched = false;
+                stateRefreshNeeded = true;
+            }
+
+            const bool kReadWasPredicted = readCadence.PredictNextRead().has_value();
+            const bool kReadStartsFrame = readCadence.RecordRead(kReadTimestamp);
+
+            Statistics::EPrefetchOutcome prefetchOutcome = Statistics::EPrefetchOutcome::NotPredicted;
+
             if (true == stateRefreshNeeded)
+            {
                 RefreshState();
 
+                if ((true == kReadWasPredicted) && (true == kReadStartsFrame))
+                    prefetchOutcome = Statistics::EPrefetchOutcome::Miss;
+            }
+            else if (true == statePrefetched)
+            {
+                prefetchOutcome = Statistics::EPrefetchOutcome::Hit;
+            }
+
+            // A refresh that happens as part of this read captures the state after the read began, which counts as no age at all.
+            Statistics::RecordStateRead(kControllerIdentifier, ((kReadTimestamp > stateCaptureTimestamp) ? (kReadTimestamp - stateCaptureTimestamp) : 0), prefetchOutcome);
+
+            statePrefetched = false;
             stateRefreshNeeded = true;
             return state;
         }
 
         // --------
 
-        void VirtualController::PopEventBufferOldestEvents(uint32_t numEventsToPop)
+        bool VirtualController::PollState(void)
         {
             auto lock = Lock();
+
+            if ((true == statePrefetched) && (false == readCadence.IsPrefetchStale(stateCaptureTimestamp, clock.GetTimestamp())))
+            {
+                const bool kStateChanged = prefetchedStateChanged;
+                prefetchedStateChanged = false;
+                return kStateChanged;
+            }
+
+            return RefreshState();
+        }
+
+        // --------
+
+        void VirtualController::PopEventBufferOldestEvents(uint32_t numEventsToPop)
+        {
+            auto lock = LockEventBuffer();
             eventBuffer.PopOldestEvents(numEventsToPop);
         }
 
@@ -162,10 +462,30 @@ namespace Xidi
         bool VirtualController::RefreshState(void)
         {
             XINPUT_STATE xinputState;
-            SStateIdentifier newStateIdentifier = {.packetNumber = 0, .errorCode = xinput->GetState(kControllerIdentifier, &xinputState)};
+
+            const auto kReadStartTime = std::chrono::steady_clock::now();
+            const DWORD kXInputGetStateResult = xinput->GetState(kControllerIdentifier, &xinputState);
+            Statistics::RecordXInputRead(kControllerIdentifier, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kReadStartTime).count());
+
+            return RefreshState(kXInputGetStateResult, xinputState, clock.GetTimestamp());
+        }
+
+        // --------
+
+        bool VirtualController::RefreshState(DWORD xinputGetStateResult, XINPUT_STATE xinputState, uint64_t captureTimestamp)
+        {
+            SStateIdentifier newStateIdentifier = {.packetNumber = 0, .errorCode = xinputGetStateResult};
 
             auto lock = Lock();
             stateRefreshNeeded = false;
+            stateCaptureTimestamp = captureTimestamp;
+            statePrefetched = false;
+            Statistics::RecordRefresh(kControllerIdentifier);
+
+            if (true == kFollowsConfiguration)
+                FollowConfigurationChanges();
+
+            ApplyStagedPropertyChanges();
 
             // Most of the logic in this block is for debugging by outputting messages. The actual functionality is very simple.
             // On success, the packet number is updated to the value received from XInput, otherwise it is left at 0.
@@ -180,25 +500,25 @@ namespace Xidi
                     break;
 
                 case ERROR_DEVICE_NOT_CONNECTED:
-                    Message::OutputFormatted(Message::ESeverity::Info, L"Virtual controller %u: Hardware connected.", kControllerIdentifier);
+                    Message::OutputFormattedRateLimited(stateMessageRateLimiter, Message::ESeverity::Info, L"Virtual controller %u: Hardware connected.", kControllerIdentifier);
                     break;
 
                 default:
-                    Message::OutputFormatted(Message::ESeverity::Warning, L"Virtual controller %u: Cleared previous error condition with code 0x%08x.", kControllerIdentifier, stateIdentifier.errorCode);
+                    Message::OutputFormattedRateLimited(stateMessageRateLimiter, Message::ESeverity::Warning, L"Virtual controller %u: Cleared previous error condition with code 0x%08x.", kControllerIdentifier, stateIdentifier.errorCode);
                     break;
                 }
                 break;
 
             case ERROR_DEVICE_NOT_CONNECTED:
-                ZeroMemory(&xinputState, sizeof(xinputState));
+                xinputState = XINPUT_STATE();
                 if (newStateIdentifier.errorCode != stateIdentifier.errorCode)
-                    Message::OutputFormatted(Message::ESeverity::Info, L"Virtual controller %u: Hardware disconnected.", kControllerIdentifier);
+                    Message::OutputFormattedRateLimited(stateMessageRateLimiter, Message::ESeverity::Info, L"Virtual controller %u: Hardware disconnected.", kControllerIdentifier);
                 break;
 
             default:
-                ZeroMemory(&xinputState, sizeof(xinputState));
+                xinputState = XINPUT_STATE();
                 if (newStateIdentifier.errorCode != stateIdentifier.errorCode)
-                    Message::OutputFormatted(Message::ESeverity::Warning, L"Virtual controller %u: Encountered error condition with code 0x%08x.", kControllerIdentifier, newStateIdentifier.errorCode);
+                    Message::OutputFormattedRateLimited(stateMessageRateLimiter, Message::ESeverity::Warning, L"Virtual controller %u: Encountered error condition with code 0x%08x.", kControllerIdentifier, newStateIdentifier.errorCode);
                 break;
             }
 
@@ -212,17 +532,100 @@ namespace Xidi
 
             stateIdentifier = newStateIdentifier;
 
-            SState newState;
-            mapper.MapXInputState(newState, xinputState.Gamepad);
-            ApplyProperties(newState);
+            // XInput reports a new packet whenever anything changes, including parts of the controller state that do not influence the virtual controller.
+            // Only the XInput controller elements that actually changed, and the virtual controller elements that depend on them, need to be processed again.
+            const Mapper* const kMapper = mapper.load();
+            SState newMappedState = mappedState;
+            uint32_t axesToTransform = UINT32_MAX;
+
+            if (true == mappedStateValid)
+            {
+                const Mapper::TXInputElementSet kChangedElements = Mapper::ChangedXInputElements(mappedXInputState, xinputState.Gamepad);
+                if (0 == kChangedElements)
+                    return false;
+
+                kMapper->MapChangedXInputElements(newMappedState, xinputState.Gamepad, kChangedElements);
+
+                axesToTransform = 0;
+                for (unsigned int i = 0; i < _countof(newMappedState.axis); ++i)
+                {
+                    if (newMappedState.axis[i] != mappedState.axis[i])
+                        axesToTransform |= (1u << i);
+                }
+            }
+            else
+            {
+                kMapper->MapXInputState(newMappedState, xinputState.Gamepad);
+            }
+
+            mappedXInputState = xinputState.Gamepad;
+            mappedState = newMappedState;
+            mappedStateValid = true;
+
+            // Axes whose mapped values did not change keep their previously-reported values, which already reflect all properties.
+            SState newState = newMappedState;
+            for (unsigned int i = 0; i < _countof(newState.axis); ++i)
+            {
+                if (0 == (axesToTransform & (1u << i)))
+                    newState.axis[i] = state.axis[i];
+            }
+
+            ApplyPropertiesToAxes(newState, axesToTransform, &suppressionStatistics);
 
             // Based on the mapper and the applied properties, a change in XInput controller state might not necessarily mean a change in virtual controller state.
-            // For example, deadzone might result in filtering out changes in analog stick position, or if a particular XInput controller element is ignored by the mapper then a change in that element does not influence the virtual controller state.
+            // For example, deadzone, granularity, or hysteresis might result in filtering out changes in analog stick position, or if a particular XInput controller element is ignored by the mapper then a change in that element does not influence the virtual controller state.
             if (newState == state)
                 return false;
 
-            SubmitStateChangeEvents(state, newState, eventFilter, eventBuffer);
+            {
+                auto eventBufferLock = LockEventBuffer();
+                SubmitStateChangeEvents(kControllerIdentifier, state, newState, captureTimestamp, eventFilter, eventBuffer);
+            }
+
             state = newState;
+            publishedState.Write(newState);
+            return true;
+        }
+
+        // --------
+
+        bool VirtualController::StagePropertyChanges(const SPropertyChanges& changes)
+        {
+            if ((true == changes.axis.has_value()) && ((int)*changes.axis >= (int)EAxis::Count))
+                return false;
+
+            if ((true == changes.deadzone.has_value()) && ((*changes.deadzone < kAxisDeadzoneMin) || (*changes.deadzone > kAxisDeadzoneMax)))
+                return false;
+
+            if ((true == changes.saturation.has_value()) && ((*changes.saturation < kAxisSaturationMin) || (*changes.saturation > kAxisSaturationMax)))
+                return false;
+
+            if ((true == changes.granularity.has_value()) && (*changes.granularity < kAxisGranularityMin))
+                return false;
+
+            if ((true == changes.hysteresis.has_value()) && ((*changes.hysteresis < kAxisHysteresisMin) || (*changes.hysteresis > kAxisHysteresisMax)))
+                return false;
+
+            if ((true == changes.range.has_value()) && (changes.range->second <= changes.range->first))
+                return false;
+
+            if ((true == changes.ffGain.has_value()) && ((*changes.ffGain < kFfGainMin) || (*changes.ffGain > kFfGainMax)))
+                return false;
+
+            // Same restriction as when following a configuration change: the application has already seen the current capabilities.
+            if ((nullptr != changes.mapper) && (changes.mapper->GetCapabilities() != mapper.load()->GetCapabilities()))
+                return false;
+
+            {
+                std::scoped_lock lock(stagedPropertyChangesMutex);
+                stagedPropertyChanges.push_back(changes);
+                stagedPropertyChangesAvailable.store(true, std::memory_order_release);
+            }
+
+            std::unique_lock lock(controllerMutex, std::try_to_lock);
+            if (true == lock.owns_lock())
+                ApplyStagedPropertyChanges();
+
             return true;
         }
 
@@ -234,6 +637,40 @@ namespace Xidi
             {
                 auto lock = Lock();
                 properties.axis[(int)axis].SetDeadzone(deadzone);
+                PublishProperties();
+                mappedStateValid = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        // --------
+
+        bool VirtualController::SetAxisGranularity(EAxis axis, uint32_t granularity)
+        {
+            if (granularity >= kAxisGranularityMin)
+            {
+                auto lock = Lock();
+                properties.axis[(int)axis].SetGranularity(granularity);
+                PublishProperties();
+                mappedStateValid = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        // --------
+
+        bool VirtualController::SetAxisHysteresis(EAxis axis, uint32_t hysteresis)
+        {
+            if ((hysteresis >= kAxisHysteresisMin) && (hysteresis <= kAxisHysteresisMax))
+            {
+                auto lock = Lock();
+                properties.axis[(int)axis].SetHysteresis(hysteresis);
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -248,6 +685,9 @@ namespace Xidi
             {
                 auto lock = Lock();
                 properties.axis[(int)axis].SetRange(rangeMin, rangeMax);
+                properties.axis[(int)axis].SetHysteresis(properties.axis[(int)axis].hysteresis);
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -262,6 +702,8 @@ namespace Xidi
             {
                 auto lock = Lock();
                 properties.axis[(int)axis].SetSaturation(saturation);
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -275,8 +717,47 @@ namespace Xidi
             if ((deadzone >= kAxisDeadzoneMin) && (deadzone <= kAxisDeadzoneMax))
             {
                 auto lock = Lock();
-                for (int i = 0; i < _countof(properties.axis); ++i)
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
                     properties.axis[(int)i].SetDeadzone(deadzone);
+
+                PublishProperties();
+                mappedStateValid = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        // --------
+
+        bool VirtualController::SetAllAxisGranularity(uint32_t granularity)
+        {
+            if (granularity >= kAxisGranularityMin)
+            {
+                auto lock = Lock();
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
+                    properties.axis[(int)i].SetGranularity(granularity);
+
+                PublishProperties();
+                mappedStateValid = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        // --------
+
+        bool VirtualController::SetAllAxisHysteresis(uint32_t hysteresis)
+        {
+            if ((hysteresis >= kAxisHysteresisMin) && (hysteresis <= kAxisHysteresisMax))
+            {
+                auto lock = Lock();
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
+                    properties.axis[(int)i].SetHysteresis(hysteresis);
+
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -290,8 +771,14 @@ namespace Xidi
             if (rangeMax > rangeMin)
             {
                 auto lock = Lock();
-                for (int i = 0; i < _countof(properties.axis); ++i)
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
+                {
                     properties.axis[(int)i].SetRange(rangeMin, rangeMax);
+                    properties.axis[(int)i].SetHysteresis(properties.axis[(int)i].hysteresis);
+                }
+
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -305,8 +792,11 @@ namespace Xidi
             if ((saturation >= kAxisSaturationMin) && (saturation <= kAxisSaturationMax))
             {
                 auto lock = Lock();
-                for (int i = 0; i < _countof(properties.axis); ++i)
+                for (unsigned int i = 0; i < _countof(properties.axis); ++i)
                     properties.axis[(int)i].SetSaturation(saturation);
+
+                PublishProperties();
+                mappedStateValid = false;
                 return true;
             }
 
@@ -317,27 +807,67 @@ namespace Xidi
 
         bool VirtualController::SetEventBufferCapacity(uint32_t capacity)
         {
+            auto lock = LockEventBuffer();
             if (capacity != eventBuffer.GetCapacity())
-            {
-                auto lock = Lock();
                 eventBuffer.SetCapacity(capacity);
-            }
 
             return true;
         }
 
         // --------
 
+        bool VirtualController::SetEventBufferOverflowPolicy(StateChangeEventBuffer::EOverflowPolicy policy)
+        {
+            if ((int)policy < (int)StateChangeEventBuffer::EOverflowPolicy::Count)
+            {
+                auto lock = LockEventBuffer();
+                eventBuffer.SetOverflowPolicy(policy);
+                return true;
+            }
+
+            return false;
+        }
+
+        // --------
+
         bool VirtualController::SetForceFeedbackGain(uint32_t ffGain)
         {
             if ((ffGain >= kFfGainMin) && (ffGain <= kFfGainMax))
             {
                 auto lock = Lock();
                 properties.device.SetFfGain(ffGain);
+                PublishProperties();
                 return true;
             }
 
             return false;
         }
+
+
+        // -------- CONCRETE INSTANCE METHODS ------------------------------ //
+        // See "PrefetchScheduler.h" for documentation.
+
+        std::optional<SPrefetchPrediction> VirtualController::GetPrefetchPrediction(void)
+        {
+            auto lock = Lock();
+
+            const std::optional<uint64_t> kNextRead = readCadence.PredictNextRead();
+            if (false == kNextRead.has_value())
+                return std::nullopt;
+
+            return SPrefetchPrediction({.nextRead = *kNextRead, .period = readCadence.GetPeriod(), .prefetchPending = statePrefetched});
+        }
+
+        // --------
+
+        void VirtualController::Prefetch(void)
+        {
+            auto lock = Lock();
+
+            const bool kStateChanged = RefreshState();
+            statePrefetched = true;
+            prefetchedStateChanged = kStateChanged;
+            Statistics::RecordPrefetch(kControllerIdentifier);
+        }
     }
 }
@@ -12,23 +12,35 @@
 
 #include "ApiDirectInput.h"
 #include "ApiGUID.h"
+#include "ControlEndpoint.h"
 #include "ControllerIdentification.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
 #include "Message.h"
+#include "MessageRateLimiter.h"
+#include "PrefetchScheduler.h"
+#include "Profiler.h"
+#include "Statistics.h"
 #include "Strings.h"
 #include "VirtualController.h"
 #include "VirtualDirectInputDevice.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <memory>
 #include <optional>
+#include <vector>
 
 
 // -------- MACROS --------------------------------------------------------- //
 
+/// Begins profiling a DirectInput interface method invocation, which is measured until the method returns.
+/// Intended to be placed at the start of the method so that the measurement covers everything up to and including the logging macros below.
+#define PROFILE_INVOCATION(entryPoint) \
+    const Profiler::ScopedInvocation profiledInvocation(Profiler::EEntryPoint::entryPoint, controller->GetIdentifier())
+
 /// Logs a DirectInput interface method invocation and returns.
 #define LOG_INVOCATION_AND_RETURN(result, severity) \
     do \
@@ -38,6 +50,17 @@
         return kResult; \
     } while (false)
 
+/// Logs a DirectInput interface method invocation and returns, subject to a rate limiter belonging to the call site.
+/// Intended for failures that applications can repeat every frame.
+#define LOG_INVOCATION_RATE_LIMITED_AND_RETURN(result, severity) \
+    do \
+    { \
+        static Message::RateLimiter rateLimiter; \
+        const HRESULT kResult = (result); \
+        Message::OutputFormattedRateLimited(rateLimiter, severity, L"Invoked %s on Xidi virtual controller %u, result = 0x%08x.", __FUNCTIONW__ L"()", (1 + controller->GetIdentifier()), kResult); \
+        return kResult; \
+    } while (false)
+
 /// Logs a DirectInput property-related method invocation and returns.
 #define LOG_PROPERTY_INVOCATION_AND_RETURN(result, severity, rguidprop, propvalfmt, ...) \
     do \
@@ -181,19 +204,22 @@ namespace Xidi
     /// @return `true` if the header is valid, `false` otherwise.
     static bool IsPropertyHeaderValid(REFGUID rguidProp, LPCDIPROPHEADER pdiph)
     {
+        // Applications that keep supplying the same invalid header tend to do so every frame.
+        static Message::RateLimiter rateLimiter;
+
         if (nullptr == pdiph)
         {
-            Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected null property header for %s.", PropertyGuidString(rguidProp));
+            Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected null property header for %s.", PropertyGuidString(rguidProp));
             return false;
         }
         else if ((sizeof(DIPROPHEADER) != pdiph->dwHeaderSize))
         {
-            Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPHEADER (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPHEADER), (unsigned int)pdiph->dwHeaderSize);
+            Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPHEADER (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPHEADER), (unsigned int)pdiph->dwHeaderSize);
             return false;
         }
         else if ((DIPH_DEVICE == pdiph->dwHow) && (0 != pdiph->dwObj))
         {
-            Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect object identification value used with DIPH_DEVICE (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)0, (unsigned int)pdiph->dwObj);
+            Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect object identification value used with DIPH_DEVICE (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)0, (unsigned int)pdiph->dwObj);
             return false;
         }
 
@@ -207,7 +233,7 @@ namespace Xidi
             // Axis mode, deadzone, granularity, and saturation all use DIPROPDWORD.
             if (sizeof(DIPROPDWORD) != pdiph->dwSize)
             {
-                Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPDWORD (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPDWORD), (unsigned int)pdiph->dwSize);
+                Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPDWORD (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPDWORD), (unsigned int)pdiph->dwSize);
                 return false;
             }
             break;
@@ -218,12 +244,12 @@ namespace Xidi
             // Buffer size, force feedback gain, and joystick ID all use DIPROPDWORD and are exclusively device-wide properties.
             if (DIPH_DEVICE != pdiph->dwHow)
             {
-                Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect object identification method for this property (expected %s, got %s).", PropertyGuidString(rguidProp), IdentificationMethodString(DIPH_DEVICE), IdentificationMethodString(pdiph->dwHow));
+                Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect object identification method for this property (expected %s, got %s).", PropertyGuidString(rguidProp), IdentificationMethodString(DIPH_DEVICE), IdentificationMethodString(pdiph->dwHow));
                 return false;
             }
             else if (sizeof(DIPROPDWORD) != pdiph->dwSize)
             {
-                Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPDWORD (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPDWORD), (unsigned int)pdiph->dwSize);
+                Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPDWORD (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPDWORD), (unsigned int)pdiph->dwSize);
                 return false;
             }
             break;
@@ -234,7 +260,7 @@ namespace Xidi
             // Range-related properties use DIPROPRANGE.
             if (sizeof(DIPROPRANGE) != pdiph->dwSize)
             {
-                Message::OutputFormatted(Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPRANGE (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPRANGE), (unsigned int)pdiph->dwSize);
+                Message::OutputFormattedRateLimited(rateLimiter, Message::ESeverity::Warning, L"Rejected invalid property header for %s: Incorrect size for DIPROPRANGE (expected %u, got %u).", PropertyGuidString(rguidProp), (unsigned int)sizeof(DIPROPRANGE), (unsigned int)pdiph->dwSize);
                 return false;
             }
             break;
@@ -414,6 +440,29 @@ namespace Xidi
         }
     }
 
+    /// Computes the DirectInput object identifier that applications use to refer to the specified controller element.
+    /// Object identifiers consist of an object type and an instance number, the latter of which is based on the reported capabilities of the virtual controller.
+    /// @param [in] controllerCapabilities Capabilities that describe the layout of the virtual controller.
+    /// @param [in] controllerElement Virtual controller element for which an object identifier is desired.
+    /// @return Object identifier for providing to applications.
+    static DWORD ObjectIdentifierForElement(const Controller::SCapabilities controllerCapabilities, Controller::SElementIdentifier controllerElement)
+    {
+        switch (controllerElement.type)
+        {
+        case Controller::EElementType::Axis:
+            return (DIDFT_ABSAXIS | DIDFT_MAKEINSTANCE((int)controllerCapabilities.FindAxis(controllerElement.axis)));
+
+        case Controller::EElementType::Button:
+            return (DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE((int)controllerElement.button));
+
+        case Controller::EElementType::Pov:
+            return (DIDFT_POV | DIDFT_MAKEINSTANCE(0));
+
+        default:                                                                                    // This should never happen.
+            return 0;
+        }
+    }
+
     /// Fills the specified object instance information structure with information about the specified controller element.
     /// Size member must already be initialized because multiple versions of the structure exist, so it is used to determine which members to fill in.
     /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types and interfaces.
@@ -430,19 +479,19 @@ namespace Xidi
         {
         case Controller::EElementType::Axis:
             objectInfo->guidType = AxisTypeGuid(controllerElement.axis);
-            objectInfo->dwType = DIDFT_ABSAXIS | DIDFT_MAKEINSTANCE((int)controllerCapabilities.FindAxis(controllerElement.axis));
+            objectInfo->dwType = ObjectIdentifierForElement(controllerCapabilities, controllerElement);
             objectInfo->dwFlags = DIDOI_POLLED | DIDOI_ASPECTPOSITION;
             break;
 
         case Controller::EElementType::Button:
             objectInfo->guidType = GUID_Button;
-            objectInfo->dwType = DIDFT_PSHBUTTON | DIDFT_MAKEINSTANCE((int)controllerElement.button);
+            objectInfo->dwType = ObjectIdentifierForElement(controllerCapabilities, controllerElement);
             objectInfo->dwFlags = DIDOI_POLLED;
             break;
 
         case Controller::EElementType::Pov:
             objectInfo->guidType = GUID_POV;
-            objectInfo->dwType = DIDFT_POV | DIDFT_MAKEINSTANCE(0);
+            objectInfo->dwType = ObjectIdentifierForElement(controllerCapabilities, controllerElement);
             objectInfo->dwFlags = DIDOI_POLLED;
             break;
         }
@@ -463,6 +512,66 @@ namespace Xidi
         }
     }
 
+#if DIRECTINPUT_VERSION >= 0x0800
+    /// Determines the priority of an action, based on the action's semantic.
+    /// Applications use priority 1 for actions that are essential and priority 2 for all others.
+    /// @param [in] semantic Semantic value from an action.
+    /// @return Priority of the action, either 1 or 2.
+    static inline unsigned int ActionSemanticPriority(DWORD semantic)
+    {
+        static constexpr DWORD kPriorityMask = 0x00004000;
+        return ((0 == (semantic & kPriorityMask)) ? 1 : 2);
+    }
+
+    /// Determines the type of virtual controller element that can be assigned to an action, based on the action's semantic.
+    /// Semantics identify their genre in the most significant byte and the type of control they require in bits 9 and 10.
+    /// Genres with the high bit set, other than the genre that matches any device, are reserved for keyboards, mice, and voice devices.
+    /// @param [in] semantic Semantic value from an action.
+    /// @return Type of element that can be assigned to the action, or nothing if no virtual controller element is suitable.
+    static std::optional<Controller::EElementType> ActionSemanticElementType(DWORD semantic)
+    {
+        static constexpr DWORD kGenreAny = 0xff;
+        static constexpr DWORD kGenrePhysicalDeviceMask = 0x80;
+
+        const DWORD kGenre = (semantic >> 24);
+        if ((kGenreAny != kGenre) && (0 != (kGenre & kGenrePhysicalDeviceMask)))
+            return std::nullopt;
+
+        switch ((semantic >> 9) & 0x3)
+        {
+        case 1:
+            return Controller::EElementType::Axis;
+
+        case 2:
+            return Controller::EElementType::Button;
+
+        case 3:
+            return Controller::EElementType::Pov;
+
+        default:
+            return std::nullopt;
+        }
+    }
+
+    /// Determines if the specified action format is valid for building or setting an action map.
+    /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types and interfaces.
+    /// @param [in] actionFormat Application-provided action format to check.
+    /// @return `true` if the action format is valid, `false` otherwise.
+    template <ECharMode charMode> static bool IsActionFormatValid(const typename DirectInputDeviceType<charMode>::ActionFormatType* actionFormat)
+    {
+        if (nullptr == actionFormat)
+            return false;
+
+        if ((sizeof(*actionFormat) != actionFormat->dwSize) || (sizeof(actionFormat->rgoAction[0]) != actionFormat->dwActionSize))
+            return false;
+
+        if ((0 != actionFormat->dwNumActions) && (nullptr == actionFormat->rgoAction))
+            return false;
+
+        return true;
+    }
+#endif
+
     /// Signals the specified event if its handle is valid.
     /// @param [in] eventHandle Handle that can be used to identify the desired event object.
     static inline void SignalEventIfEnabled(HANDLE eventHandle)
@@ -475,9 +584,90 @@ namespace Xidi
     // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
     // See "VirtualDirectInputDevice.h" for documentation.
 
-    template <ECharMode charMode> VirtualDirectInputDevice<charMode>::VirtualDirectInputDevice(std::unique_ptr<Controller::VirtualController>&& controller) : controller(std::move(controller)), dataFormat(), refCount(1), stateChangeEventHandle(NULL)
+    template <ECharMode charMode> VirtualDirectInputDevice<charMode>::VirtualDirectInputDevice(std::unique_ptr<Controller::VirtualController>&& controller) : controller(std::move(controller)), dataFormat(), actionTable(), objectInstanceTable(), refCount(1), stateChangeEventHandle(NULL)
     {
-        // Nothing to do here.
+        Controller::PrefetchScheduler::GetDefault().AddTarget(this->controller.get());
+        Controller::ControlEndpoint::GetDefault().AddController(this->controller.get());
+    }
+
+    // ---------
+
+    template <ECharMode charMode> VirtualDirectInputDevice<charMode>::~VirtualDirectInputDevice(void)
+    {
+        Controller::ControlEndpoint::GetDefault().RemoveController(controller.get());
+        Controller::PrefetchScheduler::GetDefault().RemoveTarget(controller.get());
+    }
+
+
+    // -------- INTERNAL INSTANCE METHODS ---------------------------------- //
+    // See "VirtualDirectInputDevice.h" for documentation.
+
+    template <ECharMode charMode> void VirtualDirectInputDevice<charMode>::ApplyDataFormat(std::unique_ptr<DataFormat>&& newDataFormat, std::unique_ptr<const SActionTable>&& newActionTable)
+    {
+        // Use the event filter to prevent the controller from buffering any events that correspond to elements with no offsets.
+        // Both locks are held so that neither state reads nor event reads can observe the data format while it is being replaced.
+        auto lock = controller->Lock();
+        auto eventBufferLock = controller->LockEventBuffer();
+        controller->EventFilterAddAllElements();
+        
+        for (int i = 0; i < (int)Controller::EAxis::Count; ++i)
+        {
+            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Axis, .axis = (Controller::EAxis)i};
+            if (false == newDataFormat->HasElement(kElement))
+                controller->EventFilterRemoveElement(kElement);
+        }
+
+        for (int i = 0; i < (int)Controller::EButton::Count; ++i)
+        {
+            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Button, .button = (Controller::EButton)i};
+            if (false == newDataFormat->HasElement(kElement))
+                controller->EventFilterRemoveElement(kElement);
+        }
+
+        {
+            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0};
+            if (false == newDataFormat->HasElement(kElement))
+                controller->EventFilterRemoveElement(kElement);
+        }
+
+        dataFormat = std::move(newDataFormat);
+        actionTable = std::move(newActionTable);
+        objectInstanceTable = nullptr;
+    }
+
+    // ---------
+
+    template <ECharMode charMode> std::shared_ptr<const typename VirtualDirectInputDevice<charMode>::SObjectInstanceTable> VirtualDirectInputDevice<charMode>::GetObjectInstanceTable(void)
+    {
+        auto lock = controller->Lock();
+        const Controller::SCapabilities controllerCapabilities = controller->GetCapabilities();
+
+        if ((nullptr != objectInstanceTable) && (objectInstanceTable->capabilities == controllerCapabilities))
+            return objectInstanceTable;
+
+        std::shared_ptr<SObjectInstanceTable> newObjectInstanceTable = std::make_shared<SObjectInstanceTable>();
+        newObjectInstanceTable->capabilities = controllerCapabilities;
+        newObjectInstanceTable->objectInstances.reserve((size_t)controllerCapabilities.numAxes + (size_t)controllerCapabilities.numButtons + ((true == controllerCapabilities.hasPov) ? 1 : 0));
+
+        auto appendObjectInstance = [this, &controllerCapabilities, &newObjectInstanceTable](Controller::SElementIdentifier element) -> void
+        {
+            const TOffset kOffset = ((true == IsApplicationDataFormatSet()) ? dataFormat->GetOffsetForElement(element).value_or(DataFormat::kInvalidOffsetValue) : NativeOffsetForElement(element));
+
+            newObjectInstanceTable->objectInstances.push_back({.dwSize = sizeof(typename DirectInputDeviceType<charMode>::DeviceObjectInstanceType)});
+            FillObjectInstanceInfo<charMode>(controllerCapabilities, element, kOffset, &newObjectInstanceTable->objectInstances.back());
+        };
+
+        for (int i = 0; i < controllerCapabilities.numAxes; ++i)
+            appendObjectInstance({.type = Controller::EElementType::Axis, .axis = controllerCapabilities.axisType[i]});
+
+        for (int i = 0; i < controllerCapabilities.numButtons; ++i)
+            appendObjectInstance({.type = Controller::EElementType::Button, .button = (Controller::EButton)i});
+
+        if (true == controllerCapabilities.hasPov)
+            appendObjectInstance({.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0});
+
+        objectInstanceTable = std::move(newObjectInstanceTable);
+        return objectInstanceTable;
     }
 
 
@@ -524,7 +714,7 @@ namespace Xidi
 
                 case DIDFT_POV:
                     if (kIndex == 0)
-                        return Controller::SElementIdentifier({.type = Controller::EElementType::Pov});
+                        return Controller::SElementIdentifier({.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0});
                     break;
                 }
             }
@@ -647,6 +837,8 @@ namespace Xidi
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::Info;
 
+        PROFILE_INVOCATION(DirectInputEnumObjects);
+
         const bool willEnumerateAxes = ((DIDFT_ALL == dwFlags) || (0 != (dwFlags & DIDFT_ABSAXIS)));
         const bool willEnumerateButtons = ((DIDFT_ALL == dwFlags) || (0 != (dwFlags & DIDFT_PSHBUTTON)));
         const bool willEnumeratePov = ((DIDFT_ALL == dwFlags) || (0 != (dwFlags & DIDFT_POV)));
@@ -656,71 +848,38 @@ namespace Xidi
 
         if ((true == willEnumerateAxes) || (true == willEnumerateButtons) || (true == willEnumeratePov))
         {
-            std::unique_ptr<DirectInputDeviceType<charMode>::DeviceObjectInstanceType> objectDescriptor = std::make_unique<DirectInputDeviceType<charMode>::DeviceObjectInstanceType>();
-            const Controller::SCapabilities controllerCapabilities = controller->GetCapabilities();
+            // Table entries are already fully populated, so enumeration just filters by type and hands each entry to the application.
+            // Holding a reference to the table keeps it valid even if the application changes the data format from within the callback.
+            const std::shared_ptr<const SObjectInstanceTable> kObjectInstanceTable = GetObjectInstanceTable();
 
-            if (true == willEnumerateAxes)
+            for (const auto& objectInstance : kObjectInstanceTable->objectInstances)
             {
-                for (int i = 0; i < controllerCapabilities.numAxes; ++i)
+                switch (DIDFT_GETTYPE(objectInstance.dwType))
                 {
-                    const Controller::EAxis kAxis = controllerCapabilities.axisType[i];
-                    const Controller::SElementIdentifier kAxisIdentifier = {.type = Controller::EElementType::Axis, .axis = kAxis};
-                    const TOffset kAxisOffset = ((true == IsApplicationDataFormatSet()) ? dataFormat->GetOffsetForElement(kAxisIdentifier).value_or(DataFormat::kInvalidOffsetValue) : NativeOffsetForElement(kAxisIdentifier));
-
-                    *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-                    FillObjectInstanceInfo<charMode>(controllerCapabilities, kAxisIdentifier, kAxisOffset, objectDescriptor.get());
-                    switch (lpCallback(objectDescriptor.get(), pvRef))
-                    {
-                    case DIENUM_CONTINUE:
-                        break;
-                    case DIENUM_STOP:
-                        LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-                    default:
-                        LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-                    }
-                }
-            }
+                case DIDFT_ABSAXIS:
+                    if (false == willEnumerateAxes)
+                        continue;
+                    break;
 
-            if (true == willEnumerateButtons)
-            {
-                for (int i = 0; i < controllerCapabilities.numButtons; ++i)
-                {
-                    const Controller::EButton kButton = (Controller::EButton)i;
-                    const Controller::SElementIdentifier kButtonIdentifier = {.type = Controller::EElementType::Button, .button = kButton};
-                    const TOffset kButtonOffset = ((true == IsApplicationDataFormatSet()) ? dataFormat->GetOffsetForElement(kButtonIdentifier).value_or(DataFormat::kInvalidOffsetValue) : NativeOffsetForElement(kButtonIdentifier));
-
-                    *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-                    FillObjectInstanceInfo<charMode>(controllerCapabilities, kButtonIdentifier, kButtonOffset, objectDescriptor.get());
-                    switch (lpCallback(objectDescriptor.get(), pvRef))
-                    {
-                    case DIENUM_CONTINUE:
-                        break;
-                    case DIENUM_STOP:
-                        LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-                    default:
-                        LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-                    }
+                case DIDFT_PSHBUTTON:
+                    if (false == willEnumerateButtons)
+                        continue;
+                    break;
+
+                case DIDFT_POV:
+                    if (false == willEnumeratePov)
+                        continue;
+                    break;
                 }
-            }
 
-            if (true == willEnumeratePov)
-            {
-                if (true == controllerCapabilities.hasPov)
+                switch (lpCallback(&objectInstance, pvRef))
                 {
-                    const Controller::SElementIdentifier kPovIdentifier = {.type = Controller::EElementType::Pov};
-                    const TOffset kPovOffset = ((true == IsApplicationDataFormatSet()) ? dataFormat->GetOffsetForElement(kPovIdentifier).value_or(DataFormat::kInvalidOffsetValue) : NativeOffsetForElement(kPovIdentifier));
-                    
-                    *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-                    FillObjectInstanceInfo<charMode>(controllerCapabilities, kPovIdentifier, kPovOffset, objectDescriptor.get());
-                    switch (lpCallback(objectDescriptor.get(), pvRef))
-                    {
-                    case DIENUM_CONTINUE:
-                        break;
-                    case DIENUM_STOP:
-                        LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-                    default:
-                        LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-                    }
+                case DIENUM_CONTINUE:
+                    break;
+                case DIENUM_STOP:
+                    LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+                default:
+                    LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
                 }
             }
         }
@@ -780,11 +939,15 @@ namespace Xidi
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::SuperDebug;
         static constexpr Message::ESeverity kMethodSeverityForError = Message::ESeverity::Info;
 
+        PROFILE_INVOCATION(DirectInputGetDeviceData);
+
+        Statistics::RecordApiCall(Statistics::EApiCall::DirectInputGetDeviceData);
+
         // DIDEVICEOBJECTDATA and DIDEVICEOBJECTDATA_DX3 are defined identically for all DirectInput versions below 8.
         // There is therefore no need to differentiate, as the distinction between "dinput" and "dinput8" takes care of it.
 
         if ((false == IsApplicationDataFormatSet()) || (nullptr == pdwInOut) || (sizeof(DIDEVICEOBJECTDATA) != cbObjectData))
-            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
+            LOG_INVOCATION_RATE_LIMITED_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
 
         switch (dwFlags)
         {
@@ -793,13 +956,13 @@ namespace Xidi
             break;
 
         default:
-            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
+            LOG_INVOCATION_RATE_LIMITED_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
         }
 
         if (false == controller->IsEventBufferEnabled())
             LOG_INVOCATION_AND_RETURN(DIERR_NOTBUFFERED, kMethodSeverityForError);
 
-        auto lock = controller->Lock();
+        auto lock = controller->LockEventBuffer();
         const DWORD kNumEventsAffected = std::min(*pdwInOut, (DWORD)controller->GetEventBufferCount());
         const bool kEventBufferOverflowed = controller->IsEventBufferOverflowed();
         const bool kShouldPopEvents = (0 == (dwFlags & DIGDD_PEEK));
@@ -811,8 +974,12 @@ namespace Xidi
                 const Controller::StateChangeEventBuffer::SEvent& event = controller->GetEventBufferEvent(i);
                 ZeroMemory(&rgdod[i], sizeof(rgdod[i]));
                 rgdod[i].dwOfs = dataFormat->GetOffsetForElement(event.data.element).value();       // A value should always be present.
-                rgdod[i].dwTimeStamp = event.timestamp;
+                rgdod[i].dwTimeStamp = event.GetMillisecondTimestamp();
                 rgdod[i].dwSequence = event.sequence;
+#if DIRECTINPUT_VERSION >= 0x0800
+                if (nullptr != actionTable)
+                    rgdod[i].uAppData = actionTable->GetAppDataForElement(event.data.element);
+#endif
 
                 switch (event.data.element.type)
                 {
@@ -872,15 +1039,18 @@ namespace Xidi
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::SuperDebug;
         static constexpr Message::ESeverity kMethodSeverityForError = Message::ESeverity::Info;
 
+        PROFILE_INVOCATION(DirectInputGetDeviceState);
+
+        Statistics::RecordApiCall(Statistics::EApiCall::DirectInputGetDeviceState);
+
         if ((nullptr == lpvData) || (false == IsApplicationDataFormatSet()) || (cbData < dataFormat->GetPacketSizeBytes()))
-            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
+            LOG_INVOCATION_RATE_LIMITED_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
 
         bool writeDataPacketResult = false;
-        do
         {
             auto lock = controller->Lock();
             writeDataPacketResult = dataFormat->WriteDataPacket(lpvData, cbData, controller->GetStateRef());
-        } while (false);
+        }
         LOG_INVOCATION_AND_RETURN(((true == writeDataPacketResult) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity);
     }
 
@@ -927,7 +1097,35 @@ namespace Xidi
         if (Controller::EElementType::WholeController == element.type)
             LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
-        FillObjectInstanceInfo<charMode>(controller->GetCapabilities(), element, ((true == IsApplicationDataFormatSet()) ? dataFormat->GetOffsetForElement(element).value_or(DataFormat::kInvalidOffsetValue) : NativeOffsetForElement(element)), pdidoi);
+        const std::shared_ptr<const SObjectInstanceTable> kObjectInstanceTable = GetObjectInstanceTable();
+        const Controller::SCapabilities& kTableCapabilities = kObjectInstanceTable->capabilities;
+        int objectInstanceIndex = -1;
+
+        switch (element.type)
+        {
+        case Controller::EElementType::Axis:
+            objectInstanceIndex = kTableCapabilities.FindAxis(element.axis);
+            break;
+
+        case Controller::EElementType::Button:
+            if (true == kTableCapabilities.HasButton(element.button))
+                objectInstanceIndex = (int)kTableCapabilities.numAxes + (int)element.button;
+            break;
+
+        case Controller::EElementType::Pov:
+            if (true == kTableCapabilities.hasPov)
+                objectInstanceIndex = (int)kTableCapabilities.numAxes + (int)kTableCapabilities.numButtons;
+            break;
+        }
+
+        if (objectInstanceIndex < 0)
+            LOG_INVOCATION_AND_RETURN(DIERR_OBJECTNOTFOUND, kMethodSeverity);
+
+        // Legacy versions of the structure are a prefix of the current version, so only as many bytes as the application indicates are copied.
+        const DWORD kObjectInstanceSize = pdidoi->dwSize;
+        CopyMemory(pdidoi, &kObjectInstanceTable->objectInstances[objectInstanceIndex], kObjectInstanceSize);
+        pdidoi->dwSize = kObjectInstanceSize;
+
         LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
     }
 
@@ -937,6 +1135,8 @@ namespace Xidi
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::Info;
 
+        PROFILE_INVOCATION(DirectInputGetProperty);
+
         DumpPropertyRequest(rguidProp, pdiph, false);
 
         if (false == IsPropertyHeaderValid(rguidProp, pdiph))
@@ -980,7 +1180,19 @@ namespace Xidi
             default:
                 LOG_PROPERTY_INVOCATION_NO_VALUE_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity, rguidProp);
             }
-            ((LPDIPROPDWORD)pdiph)->dwData = 1;
+            if (Controller::EElementType::Axis == element.type)
+            {
+                ((LPDIPROPDWORD)pdiph)->dwData = controller->GetAxisGranularity(element.axis);
+            }
+            else
+            {
+                // For the whole controller, report the finest granularity of any axis, which is what an application can rely upon across the device.
+                const Controller::SCapabilities kCapabilities = controller->GetCapabilities();
+                DWORD granularity = ((0 == kCapabilities.numAxes) ? Controller::VirtualController::kAxisGranularityDefault : ULONG_MAX);
+                for (int i = 0; i < kCapabilities.numAxes; ++i)
+                    granularity = std::min(granularity, (DWORD)controller->GetAxisGranularity(kCapabilities.axisType[i]));
+                ((LPDIPROPDWORD)pdiph)->dwData = granularity;
+            }
             LOG_PROPERTY_INVOCATION_DIPROPDWORD_AND_RETURN(DI_OK, kMethodSeverity, rguidProp, pdiph);
 
         case ((size_t)&DIPROP_JOYSTICKID):
@@ -1042,11 +1254,13 @@ namespace Xidi
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::SuperDebug;
 
+        PROFILE_INVOCATION(DirectInputPoll);
+
         // DirectInput documentation requires that the application data format already be set before a device can be polled.
         if (false == IsApplicationDataFormatSet())
             LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
-        if (true == controller->RefreshState())
+        if (true == controller->PollState())
             SignalEventIfEnabled(stateChangeEventHandle);
 
         LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
@@ -1099,32 +1313,8 @@ namespace Xidi
         if (nullptr == newDataFormat)
             LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
-        // Use the event filter to prevent the controller from buffering any events that correspond to elements with no offsets.
-        auto lock = controller->Lock();
-        controller->EventFilterAddAllElements();
-        
-        for (int i = 0; i < (int)Controller::EAxis::Count; ++i)
-        {
-            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Axis, .axis = (Controller::EAxis)i};
-            if (false == newDataFormat->HasElement(kElement))
-                controller->EventFilterRemoveElement(kElement);
-        }
-
-        for (int i = 0; i < (int)Controller::EButton::Count; ++i)
-        {
-            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Button, .button = (Controller::EButton)i};
-            if (false == newDataFormat->HasElement(kElement))
-                controller->EventFilterRemoveElement(kElement);
-        }
-
-        do
-        {
-            const Controller::SElementIdentifier kElement = {.type = Controller::EElementType::Pov};
-            if (false == newDataFormat->HasElement(kElement))
-                controller->EventFilterRemoveElement(kElement);
-        } while (false);
-
-        dataFormat = std::move(newDataFormat);
+        // A data format set directly replaces any action map, so buffered events no longer carry action values.
+        ApplyDataFormat(std::move(newDataFormat), nullptr);
         LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
     }
 
@@ -1144,6 +1334,8 @@ namespace Xidi
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::Info;
 
+        PROFILE_INVOCATION(DirectInputSetProperty);
+
         DumpPropertyRequest(rguidProp, pdiph, true);
         
         if (false == IsPropertyHeaderValid(rguidProp, pdiph))
@@ -1180,6 +1372,17 @@ namespace Xidi
         case ((size_t)&DIPROP_FFGAIN):
             LOG_PROPERTY_INVOCATION_DIPROPDWORD_AND_RETURN(((true == controller->SetForceFeedbackGain(((LPDIPROPDWORD)pdiph)->dwData)) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity, rguidProp, pdiph);
 
+        case ((size_t)&DIPROP_GRANULARITY):
+            switch (element.type)
+            {
+            case Controller::EElementType::Axis:
+                LOG_PROPERTY_INVOCATION_DIPROPDWORD_AND_RETURN(((true == controller->SetAxisGranularity(element.axis, ((LPDIPROPDWORD)pdiph)->dwData)) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity, rguidProp, pdiph);
+            case Controller::EElementType::WholeController:
+                LOG_PROPERTY_INVOCATION_DIPROPDWORD_AND_RETURN(((true == controller->SetAllAxisGranularity(((LPDIPROPDWORD)pdiph)->dwData)) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity, rguidProp, pdiph);
+            default:
+                LOG_PROPERTY_INVOCATION_DIPROPDWORD_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity, rguidProp, pdiph);
+            }
+
         case ((size_t)&DIPROP_RANGE):
             switch (element.type)
             {
@@ -1232,7 +1435,119 @@ namespace Xidi
     template <ECharMode charMode> HRESULT VirtualDirectInputDevice<charMode>::BuildActionMap(DirectInputDeviceType<charMode>::ActionFormatType* lpdiaf, DirectInputDeviceType<charMode>::ConstStringType lpszUserName, DWORD dwFlags)
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::Info;
-        LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
+
+        if (false == IsActionFormatValid<charMode>(lpdiaf))
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        // Virtual controllers have no stored user configurations and no hardware defaults other than the assignments made here.
+        // Therefore the user name is ignored, and the only difference between the flags is which existing assignments are kept.
+        bool preserveAppMapped = true;
+        bool preserveOtherMapped = true;
+
+        switch (dwFlags)
+        {
+        case DIDBAM_DEFAULT:
+        case DIDBAM_PRESERVE:
+            break;
+
+        case DIDBAM_INITIALIZE:
+            preserveOtherMapped = false;
+            break;
+
+        case DIDBAM_HWDEFAULTS:
+            preserveAppMapped = false;
+            preserveOtherMapped = false;
+            break;
+
+        default:
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+        }
+
+        GUID instanceGuid;
+        MakeVirtualControllerInstanceGuid(instanceGuid, controller->GetIdentifier());
+
+        const Controller::SCapabilities kControllerCapabilities = controller->GetCapabilities();
+        std::vector<Controller::SElementIdentifier> availableElements;
+        availableElements.reserve((size_t)kControllerCapabilities.numAxes + (size_t)kControllerCapabilities.numButtons + ((true == kControllerCapabilities.hasPov) ? 1 : 0));
+
+        for (int i = 0; i < kControllerCapabilities.numAxes; ++i)
+            availableElements.push_back({.type = Controller::EElementType::Axis, .axis = kControllerCapabilities.axisType[i]});
+
+        for (int i = 0; i < kControllerCapabilities.numButtons; ++i)
+            availableElements.push_back({.type = Controller::EElementType::Button, .button = (Controller::EButton)i});
+
+        if (true == kControllerCapabilities.hasPov)
+            availableElements.push_back({.type = Controller::EElementType::Pov, .axis = (Controller::EAxis)0});
+
+        // First pass keeps existing assignments to this device, so that the elements involved are not assigned again.
+        // Applications request specific elements by marking actions as application-mapped.
+        for (DWORD i = 0; i < lpdiaf->dwNumActions; ++i)
+        {
+            auto& action = lpdiaf->rgoAction[i];
+            if (instanceGuid != action.guidInstance)
+                continue;
+
+            const bool kIsAppMapped = (0 != (action.dwFlags & DIA_APPMAPPED));
+            if ((true == kIsAppMapped) ? (false == preserveAppMapped) : (false == preserveOtherMapped))
+            {
+                action.dwHow = DIAH_UNMAPPED;
+                continue;
+            }
+
+            if ((true == kIsAppMapped) && (DIAH_UNMAPPED == action.dwHow))
+                action.dwHow = DIAH_APPREQUESTED;
+            else if ((DIAH_UNMAPPED == action.dwHow) || (0 != (action.dwHow & DIAH_ERROR)))
+                continue;
+
+            const std::optional<Controller::SElementIdentifier> kMaybeElement = IdentifyElement(action.dwObjID, DIPH_BYID);
+            const auto kAvailableElement = ((true == kMaybeElement.has_value()) ? std::find(availableElements.begin(), availableElements.end(), kMaybeElement.value()) : availableElements.end());
+
+            if (availableElements.end() == kAvailableElement)
+            {
+                Message::OutputFormatted(Message::ESeverity::Warning, L"Action %u on Xidi virtual controller %u cannot be assigned to object 0x%08x because that object does not exist or is already assigned.", (unsigned int)i, (1 + controller->GetIdentifier()), action.dwObjID);
+                action.dwHow = DIAH_ERROR;
+                continue;
+            }
+
+            availableElements.erase(kAvailableElement);
+        }
+
+        // Second pass assigns the remaining elements to unassigned actions by type, first to actions the application marked as most important and then to all others.
+        // Semantics are otherwise not interpreted, because virtual controllers do not represent any particular physical device.
+        // Application-mapped actions are only reassigned if the application asked for its own assignments to this device to be overwritten.
+        for (const unsigned int kPriority : {1, 2})
+        {
+            for (DWORD i = 0; i < lpdiaf->dwNumActions; ++i)
+            {
+                auto& action = lpdiaf->rgoAction[i];
+                if ((DIAH_UNMAPPED != action.dwHow) || (0 != (action.dwFlags & DIA_APPNOMAP)) || (kPriority != ActionSemanticPriority(action.dwSemantic)))
+                    continue;
+
+                if ((0 != (action.dwFlags & DIA_APPMAPPED)) && ((true == preserveAppMapped) || (instanceGuid != action.guidInstance)))
+                    continue;
+
+                const std::optional<Controller::EElementType> kMaybeElementType = ActionSemanticElementType(action.dwSemantic);
+                if (false == kMaybeElementType.has_value())
+                    continue;
+
+                const auto kAvailableElement = std::find_if(availableElements.begin(), availableElements.end(), [&kMaybeElementType](Controller::SElementIdentifier element) -> bool { return (kMaybeElementType.value() == element.type); });
+                if (availableElements.end() == kAvailableElement)
+                    continue;
+
+                action.guidInstance = instanceGuid;
+                action.dwObjID = ObjectIdentifierForElement(kControllerCapabilities, *kAvailableElement);
+                action.dwHow = DIAH_DEFAULT;
+                availableElements.erase(kAvailableElement);
+            }
+        }
+
+        for (DWORD i = 0; i < lpdiaf->dwNumActions; ++i)
+        {
+            if ((instanceGuid == lpdiaf->rgoAction[i].guidInstance) && (DIAH_UNMAPPED != lpdiaf->rgoAction[i].dwHow) && (0 == (lpdiaf->rgoAction[i].dwHow & DIAH_ERROR)))
+                LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+        }
+
+        LOG_INVOCATION_AND_RETURN(DI_NOEFFECT, kMethodSeverity);
     }
 
     // ---------
@@ -1248,7 +1563,86 @@ namespace Xidi
     template <ECharMode charMode> HRESULT VirtualDirectInputDevice<charMode>::SetActionMap(DirectInputDeviceType<charMode>::ActionFormatType* lpdiActionFormat, DirectInputDeviceType<charMode>::ConstStringType lptszUserName, DWORD dwFlags)
     {
         static constexpr Message::ESeverity kMethodSeverity = Message::ESeverity::Info;
-        LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
+
+        if (false == IsActionFormatValid<charMode>(lpdiActionFormat))
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        // Per DirectInput documentation, each action occupies 4 bytes of the data packet, in the order in which actions appear in the action format.
+        if ((lpdiActionFormat->dwNumActions > (DataFormat::kMaxDataPacketSizeBytes / sizeof(DWORD))) || (lpdiActionFormat->dwDataSize < (lpdiActionFormat->dwNumActions * sizeof(DWORD))))
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        // Virtual controllers have no stored user configurations, so there is nothing to save and the user name is ignored.
+        if (0 != (dwFlags & ~((DWORD)(DIDSAM_FORCESAVE | DIDSAM_NOUSER))))
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        GUID instanceGuid;
+        MakeVirtualControllerInstanceGuid(instanceGuid, controller->GetIdentifier());
+
+        // The action map is compiled into an ordinary data format, one object per action assigned to this device, plus a table of action values indexed by controller element.
+        // Thereafter, state and buffered events are delivered exactly as for any other data format, and action values are attached to buffered events by direct lookup.
+        const Controller::SCapabilities kControllerCapabilities = controller->GetCapabilities();
+        std::vector<DIOBJECTDATAFORMAT> objectFormatSpecs;
+        std::vector<Controller::SElementIdentifier> assignedElements;
+        std::vector<Controller::EAxis> rangedAxes;
+        std::unique_ptr<SActionTable> newActionTable = std::make_unique<SActionTable>();
+
+        for (DWORD i = 0; i < lpdiActionFormat->dwNumActions; ++i)
+        {
+            const auto& action = lpdiActionFormat->rgoAction[i];
+            if ((instanceGuid != action.guidInstance) || (DIAH_UNMAPPED == action.dwHow) || (0 != (action.dwHow & DIAH_ERROR)))
+                continue;
+
+            const std::optional<Controller::SElementIdentifier> kMaybeElement = IdentifyElement(action.dwObjID, DIPH_BYID);
+            if (false == kMaybeElement.has_value())
+            {
+                Message::OutputFormatted(Message::ESeverity::Warning, L"Skipping action %u on Xidi virtual controller %u because object 0x%08x does not exist.", (unsigned int)i, (1 + controller->GetIdentifier()), action.dwObjID);
+                continue;
+            }
+
+            if (assignedElements.end() != std::find(assignedElements.begin(), assignedElements.end(), kMaybeElement.value()))
+            {
+                Message::OutputFormatted(Message::ESeverity::Warning, L"Skipping action %u on Xidi virtual controller %u because object 0x%08x is already assigned to another action.", (unsigned int)i, (1 + controller->GetIdentifier()), action.dwObjID);
+                continue;
+            }
+
+            objectFormatSpecs.push_back({.pguid = nullptr, .dwOfs = (DWORD)(i * sizeof(DWORD)), .dwType = ObjectIdentifierForElement(kControllerCapabilities, kMaybeElement.value()), .dwFlags = 0});
+            assignedElements.push_back(kMaybeElement.value());
+            newActionTable->SetAppDataForElement(kMaybeElement.value(), action.uAppData);
+
+            // Per DirectInput documentation, the action format's range applies to every axis action unless the action opts out.
+            if ((Controller::EElementType::Axis == kMaybeElement.value().type) && (0 == (action.dwFlags & DIA_NORANGE)))
+                rangedAxes.push_back(kMaybeElement.value().axis);
+        }
+
+        // If nothing is assigned to this device then the current data format and action map remain unaltered.
+        if (true == objectFormatSpecs.empty())
+            LOG_INVOCATION_AND_RETURN(DI_NOEFFECT, kMethodSeverity);
+
+        if ((false == rangedAxes.empty()) && (lpdiActionFormat->lAxisMax <= lpdiActionFormat->lAxisMin))
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        const DIDATAFORMAT kActionDataFormatSpec = {
+            .dwSize = sizeof(DIDATAFORMAT),
+            .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+            .dwFlags = DIDF_ABSAXIS,
+            .dwDataSize = lpdiActionFormat->dwDataSize,
+            .dwNumObjs = (DWORD)objectFormatSpecs.size(),
+            .rgodf = objectFormatSpecs.data()
+        };
+
+        std::unique_ptr<DataFormat> newDataFormat = DataFormat::CreateFromApplicationFormatSpec(kActionDataFormatSpec, kControllerCapabilities);
+        if (nullptr == newDataFormat)
+            LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+
+        ApplyDataFormat(std::move(newDataFormat), std::move(newActionTable));
+
+        // Setting an action map also sets the properties an application would otherwise set individually, namely the event buffer size and the range of each axis.
+        controller->SetEventBufferCapacity(lpdiActionFormat->dwBufferSize);
+
+        for (const Controller::EAxis kAxis : rangedAxes)
+            controller->SetAxisRange(kAxis, lpdiActionFormat->lAxisMin, lpdiActionFormat->lAxisMax);
+
+        LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
     }
 #endif
 
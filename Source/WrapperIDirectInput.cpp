@@ -13,11 +13,14 @@
 #include "ApiDirectInput.h"
 #include "ApiGUID.h"
 #include "ControllerIdentification.h"
+#include "Globals.h"
 #include "Mapper.h"
 #include "Message.h"
+#include "Profiler.h"
 #include "VirtualController.h"
 #include "VirtualDirectInputDevice.h"
 #include "WrapperIDirectInput.h"
+#include "XInputInterface.h"
 
 #include <cstdlib>
 #include <optional>
@@ -66,7 +69,10 @@ namespace Xidi
     // -------- CONSTRUCTION AND DESTRUCTION ------------------------------- //
     // See "WrapperIDirectInput.h" for documentation.
 
-    template <ECharMode charMode> WrapperIDirectInput<charMode>::WrapperIDirectInput(DirectInputType<charMode>::LatestIDirectInputType* underlyingDIObject) : underlyingDIObject(underlyingDIObject) {}
+    template <ECharMode charMode> WrapperIDirectInput<charMode>::WrapperIDirectInput(DirectInputType<charMode>::LatestIDirectInputType* underlyingDIObject) : underlyingDIObject(underlyingDIObject)
+    {
+        RegisterNativeXInputSource();
+    }
 
 
     // -------- METHODS: IUnknown ------------------------------------------ //
@@ -165,7 +171,9 @@ namespace Xidi
                 return DIERR_NOINTERFACE;
             }
             
-            *lplpDirectInputDevice = new VirtualDirectInputDevice<charMode>(std::make_unique<Controller::VirtualController>(kVirtualControllerId, *mapper));
+            Globals::StartConfigurationWatcherIfConfigured();
+
+            *lplpDirectInputDevice = new VirtualDirectInputDevice<charMode>(std::make_unique<Controller::VirtualController>(kVirtualControllerId));
             return DI_OK;
         }
     }
@@ -174,6 +182,8 @@ namespace Xidi
 
     template <ECharMode charMode> HRESULT STDMETHODCALLTYPE WrapperIDirectInput<charMode>::EnumDevices(DWORD dwDevType, DirectInputType<charMode>::EnumDevicesCallbackType lpCallback, LPVOID pvRef, DWORD dwFlags)
     {
+        const Profiler::ScopedInvocation profiledInvocation(Profiler::EEntryPoint::DirectInputEnumDevices);
+
 #if DIRECTINPUT_VERSION >= 0x0800
         const BOOL gameControllersRequested = (DI8DEVCLASS_ALL == dwDevType || DI8DEVCLASS_GAMECTRL == dwDevType);
         const DWORD gameControllerDevClass = DI8DEVCLASS_GAMECTRL;
@@ -11,19 +11,31 @@
 
 #include "ApiWindows.h"
 #include "ApiDirectInput.h"
+#include "BackgroundWorker.h"
+#include "ControlEndpoint.h"
 #include "ControllerIdentification.h"
+#include "ControllerSet.h"
+#include "ControllerSourceRegistry.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
 #include "Globals.h"
 #include "ImportApiDirectInput.h"
 #include "ImportApiWinMM.h"
 #include "Message.h"
+#include "PrefetchScheduler.h"
+#include "Profiler.h"
+#include "Statistics.h"
+#include "Strings.h"
+#include "SystemDeviceCache.h"
 #include "VirtualController.h"
 #include "WrapperJoyWinMM.h"
+#include "XInputInterface.h"
 
 #include <climits>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <regstr.h>
 #include <string>
 #include <utility>
@@ -33,6 +45,13 @@
 
 // -------- MACROS --------------------------------------------------------- //
 
+/// Begins profiling a WinMM function invocation, which is measured until the function returns.
+/// Intended to be placed at the start of the function so that the measurement covers everything up to and including the logging macros below.
+#define PROFILE_INVOCATION(entryPoint)              Profiler::ScopedInvocation profiledInvocation(Profiler::EEntryPoint::entryPoint)
+
+/// Attributes the invocation being profiled to a virtual controller, but only if the specified translated joystick index identifies one.
+#define PROFILE_INVOCATION_JOY_INDEX(realJoyID)     do { if (realJoyID < 0) profiledInvocation.SetController((uint32_t)((-realJoyID) - 1)); } while (false)
+
 /// Logs a WinMM device-specific function invocation.
 #define LOG_INVOCATION(severity, joyID, result)     Message::OutputFormatted(severity, L"Invoked %s on device %d, result = %u.", __FUNCTIONW__ L"()", joyID, result);
 
@@ -65,21 +84,29 @@ namespace Xidi
         /// WinMM has no way for applications to set saturation, so use a small part of the axis just to enable some minor filtering but to avoid interfering with any applications that do their own filtering.
         static constexpr int32_t kAxisSaturation = 9250;
 
+        /// Maximum amount of time the system device cache refresher waits for a refresh to be requested before checking again, in nanoseconds.
+        /// Requests wake it immediately, so this only bounds how long it sleeps when idle.
+        static constexpr uint64_t kSystemDeviceCacheRefresherIdleTimeNanoseconds = 60000000000ull;
+
 
         // -------- INTERNAL TYPES ----------------------------------------- //
 
         // Used to provide all information needed to get a list of XInput devices exposed by WinMM.
         struct SWinMMEnumCallbackInfo
         {
-            std::vector<std::pair<std::wstring, bool>>* systemDeviceInfo;
+            SystemDeviceCache::TDeviceList* systemDeviceInfo;
             IDirectInput8* directInputInterface;
         };
 
 
         // -------- INTERNAL VARIABLES ------------------------------------- //
 
-        /// Fixed set of virtual controllers.
-        static Controller::VirtualController* controllers[XUSER_MAX_COUNT];
+        /// Fixed set of virtual controllers, refreshed together so that all joysticks read during the same frame are mutually consistent.
+        static Controller::ControllerSet* controllerSet;
+
+        /// Virtual controllers owned by the controller set, indexed by controller identifier, for quick access.
+        /// Sized once during initialization to the number of virtual controller slots registered at that time.
+        static std::vector<Controller::VirtualController*> controllers;
 
         /// Maps from application-specified joystick index to the actual indices to present to WinMM or use internally.
         /// Negative values indicate XInput controllers, others indicate values to be passed to WinMM as is.
@@ -87,7 +114,21 @@ namespace Xidi
 
         /// Holds information about all devices WinMM makes available.
         /// String specifies the device identifier (vendor ID and product ID string), bool value specifies whether the device supports XInput.
-        static std::vector<std::pair<std::wstring, bool>> joySystemDeviceInfo;
+        static SystemDeviceCache::TDeviceList joySystemDeviceInfo;
+
+        /// Refreshes the system device cache in the background after cached information was used.
+        /// Created the first time it is needed and never destroyed or stopped, so it is never stopped from within the DLL entry point. Its thread holds a reference to this module, so once a refresh has been requested the module stays loaded until the process terminates.
+        static BackgroundWorker* systemDeviceCacheRefresher;
+
+        /// Serializes writes to the system device cache and guards the refresh request state below.
+        /// Held only while writing the cache or exchanging a request, never while detecting devices, so that no caller waits for another's enumeration to finish.
+        static std::mutex systemDeviceCacheMutex;
+
+        /// Incremented each time system device information is created. A background refresh whose generation no longer matches has been superseded and discards its result.
+        static uint64_t systemDeviceInfoGeneration;
+
+        /// System device information that was filled from the cache and is waiting for the background refresher to pick it up, if any.
+        static std::optional<SystemDeviceCache::TDeviceList> maybePendingSystemDeviceCacheRefresh;
 
 
         // -------- INTERNAL FUNCTIONS ------------------------------------- //
@@ -127,7 +168,7 @@ namespace Xidi
         static void CreateJoyIndexMap(void)
         {
             const size_t numDevicesFromSystem = joySystemDeviceInfo.size();
-            const size_t numXInputVirtualDevices = _countof(controllers);
+            const size_t numXInputVirtualDevices = controllers.size();
             const size_t numDevicesTotal = numDevicesFromSystem + numXInputVirtualDevices;
 
             // Initialize the joystick index map with conservative defaults.
@@ -221,15 +262,18 @@ namespace Xidi
             return DIENUM_CONTINUE;
         }
         
-        /// Fills in the system device info data structure with information from the registry and from DirectInput.
-        static void CreateSystemDeviceInfo(void)
+        /// Identifies the devices WinMM makes available using information from the registry.
+        /// XInput support is not detected, so all devices are marked as not supporting XInput.
+        /// @param [out] systemDeviceInfo System device information data structure to fill.
+        /// @return `true` if devices were enumerated, `false` if the registry could not be read.
+        static bool EnumerateSystemDevices(SystemDeviceCache::TDeviceList& systemDeviceInfo)
         {
             const size_t numDevicesFromSystem = (size_t)ImportApiWinMM::joyGetNumDevs();
             Message::OutputFormatted(Message::ESeverity::Debug, L"System provides %u WinMM devices.", (unsigned int)numDevicesFromSystem);
 
             // Initialize the system device information data structure.
-            joySystemDeviceInfo.clear();
-            joySystemDeviceInfo.reserve(numDevicesFromSystem);
+            systemDeviceInfo.clear();
+            systemDeviceInfo.reserve(numDevicesFromSystem);
 
             // Figure out the registry key that needs to be opened and open it.
             JOYCAPS joyCaps;
@@ -237,7 +281,7 @@ namespace Xidi
             if (JOYERR_NOERROR != ImportApiWinMM::joyGetDevCaps((UINT_PTR)-1, &joyCaps, sizeof(joyCaps)))
             {
                 Message::Output(Message::ESeverity::Warning, L"Unable to enumerate system WinMM devices because the correct registry key could not be identified by the system.");
-                return;
+                return false;
             }
 
             wchar_t registryPath[1024];
@@ -245,7 +289,7 @@ namespace Xidi
             if (ERROR_SUCCESS != RegCreateKeyEx(HKEY_CURRENT_USER, registryPath, 0, nullptr, REG_OPTION_VOLATILE, KEY_QUERY_VALUE, nullptr, &registryKey, nullptr))
             {
                 Message::OutputFormatted(Message::ESeverity::Warning, L"Unable to enumerate system WinMM devices because the registry key \"%s\" could not be opened.", registryPath);
-                return;
+                return false;
             }
 
             // For each joystick device available in the system, see if it is present and, if so, get its device identifier (vendor ID and product ID string).
@@ -256,7 +300,7 @@ namespace Xidi
                 // Get the device capabilities. If this fails, the device is not present and can be skipped.
                 if (JOYERR_NOERROR != ImportApiWinMM::joyGetDevCaps((UINT_PTR)i, &joyCaps, sizeof(joyCaps)))
                 {
-                    joySystemDeviceInfo.push_back({ L"", false });
+                    systemDeviceInfo.push_back({ L"", false });
                     Message::OutputFormatted(Message::ESeverity::Debug, L"    [%u]: (not present - failed to get capabilities)", (unsigned int)i);
                     continue;
                 }
@@ -270,19 +314,26 @@ namespace Xidi
                 if (ERROR_SUCCESS != RegGetValue(registryKey, nullptr, registryValueName, RRF_RT_REG_SZ, nullptr, registryValueData, &registryValueSize))
                 {
                     // If the registry value does not exist, this is past the end of the number of devices WinMM sees.
-                    joySystemDeviceInfo.push_back({ L"", false });
+                    systemDeviceInfo.push_back({ L"", false });
                     Message::OutputFormatted(Message::ESeverity::Debug, L"    [%u]: (not present - failed to get vendor and product ID strings)", (unsigned int)i);
                     continue;
                 }
 
                 // Add the vendor ID and product ID string to the list.
-                joySystemDeviceInfo.push_back({ registryValueData, false });
+                systemDeviceInfo.push_back({ registryValueData, false });
                 Message::OutputFormatted(Message::ESeverity::Debug, L"    [%u]: %s", (unsigned int)i, registryValueData);
             }
 
             Message::Output(Message::ESeverity::Debug, L"Done enumerating system WinMM devices.");
             RegCloseKey(registryKey);
+            return true;
+        }
 
+        /// Uses DirectInput to detect which of the devices WinMM makes available support XInput.
+        /// This involves probing every game controller present in the system, which is slow, so results are cached across runs.
+        /// @param [in,out] systemDeviceInfo System device information data structure, already filled by #EnumerateSystemDevices, in which XInput support is to be marked.
+        static void DetectXInputSystemDevices(SystemDeviceCache::TDeviceList& systemDeviceInfo)
+        {
             // Enumerate all devices using DirectInput8 to find any XInput devices with matching vendor and product identifiers.
             // This will provide information on whether each WinMM device supports XInput.
             Message::Output(Message::ESeverity::Debug, L"Using DirectInput to detect XInput devices...");
@@ -294,9 +345,12 @@ namespace Xidi
             }
 
             SWinMMEnumCallbackInfo callbackInfo;
-            callbackInfo.systemDeviceInfo = &joySystemDeviceInfo;
+            callbackInfo.systemDeviceInfo = &systemDeviceInfo;
             callbackInfo.directInputInterface = directInputInterface;
-            if (S_OK != directInputInterface->EnumDevices(DI8DEVCLASS_GAMECTRL, CreateSystemDeviceInfoEnumCallback, (LPVOID)&callbackInfo, 0))
+            const HRESULT kEnumResult = directInputInterface->EnumDevices(DI8DEVCLASS_GAMECTRL, CreateSystemDeviceInfoEnumCallback, (LPVOID)&callbackInfo, 0);
+            directInputInterface->Release();
+
+            if (S_OK != kEnumResult)
             {
                 Message::Output(Message::ESeverity::Debug, L"Unable to detect XInput devices because enumeration of DirectInput devices failed.");
                 return;
@@ -305,6 +359,111 @@ namespace Xidi
             Message::Output(Message::ESeverity::Debug, L"Done detecting XInput devices.");
         }
 
+        /// Refreshes the system device cache after cached information was used. Runs on a background thread.
+        /// Detects XInput support from scratch and rewrites the cache. Any difference only takes effect the next time an application starts, because changing the joystick index map of a running application would renumber its joysticks.
+        /// If system device information is created again while detection is in progress, the newer information replaces this result and the cache is left alone.
+        /// @param [in] systemDeviceInfo System device information data structure that was filled from the cache and is in use.
+        /// @param [in] generation Value of the system device information generation counter at the time the refresh was requested.
+        static void RefreshSystemDeviceCache(SystemDeviceCache::TDeviceList systemDeviceInfo, uint64_t generation)
+        {
+            const SystemDeviceCache::TDeviceList kSystemDeviceInfoInUse = systemDeviceInfo;
+
+            for (auto& systemDevice : systemDeviceInfo)
+                systemDevice.second = false;
+
+            DetectXInputSystemDevices(systemDeviceInfo);
+
+            if (kSystemDeviceInfoInUse == systemDeviceInfo)
+            {
+                Message::Output(Message::ESeverity::Debug, L"Confirmed that cached WinMM system device information is up to date.");
+                return;
+            }
+
+            std::scoped_lock lock(systemDeviceCacheMutex);
+
+            if (generation != systemDeviceInfoGeneration)
+            {
+                Message::Output(Message::ESeverity::Debug, L"Discarding refreshed WinMM system device information because it was superseded while being detected.");
+                return;
+            }
+
+            if (true == SystemDeviceCache::Save(Strings::kStrSystemDeviceCacheFilename, systemDeviceInfo))
+                Message::Output(Message::ESeverity::Warning, L"Cached WinMM system device information was out of date and has been refreshed. The change will take effect the next time the application starts.");
+            else
+                Message::OutputFormatted(Message::ESeverity::Warning, L"Cached WinMM system device information was out of date but could not be refreshed in %s.", Strings::kStrSystemDeviceCacheFilename.data());
+        }
+
+        /// Entry point for the background thread that refreshes the system device cache.
+        /// Waits for refresh requests and handles them one at a time, always using the most recent request.
+        static void SystemDeviceCacheRefresherThreadMain(void)
+        {
+            do
+            {
+                std::optional<SystemDeviceCache::TDeviceList> maybeSystemDeviceInfo;
+                uint64_t generation = 0;
+
+                {
+                    std::scoped_lock lock(systemDeviceCacheMutex);
+                    maybeSystemDeviceInfo.swap(maybePendingSystemDeviceCacheRefresh);
+                    generation = systemDeviceInfoGeneration;
+                }
+
+                if (true == maybeSystemDeviceInfo.has_value())
+                    RefreshSystemDeviceCache(std::move(maybeSystemDeviceInfo.value()), generation);
+            } while (true == systemDeviceCacheRefresher->WaitFor(kSystemDeviceCacheRefresherIdleTimeNanoseconds));
+        }
+
+        /// Fills in the system device info data structure with information from the registry and either from the system device cache or from DirectInput.
+        /// Cached information is used if it describes exactly the devices currently present, in which case the cache is refreshed in the background. Otherwise DirectInput is used to probe every device and the cache is rewritten.
+        /// @param [in] allowCache Whether cached information is allowed to be used. Should be `false` if the system has indicated that its devices have changed.
+        static void CreateSystemDeviceInfo(bool allowCache)
+        {
+            // Any refresh still in progress is superseded by this function, so it discards its result instead of racing to rewrite the cache.
+            // Waiting for it to finish instead would block the caller until its enumeration completes.
+            {
+                std::scoped_lock lock(systemDeviceCacheMutex);
+                systemDeviceInfoGeneration += 1;
+                maybePendingSystemDeviceCacheRefresh.reset();
+            }
+
+            if (false == EnumerateSystemDevices(joySystemDeviceInfo))
+                return;
+
+            if (true == allowCache)
+            {
+                const std::optional<SystemDeviceCache::TDeviceList> kCachedSystemDeviceInfo = SystemDeviceCache::Load(Strings::kStrSystemDeviceCacheFilename);
+                if ((true == kCachedSystemDeviceInfo.has_value()) && (true == SystemDeviceCache::ApplyIfMatching(kCachedSystemDeviceInfo.value(), joySystemDeviceInfo)))
+                {
+                    Message::OutputFormatted(Message::ESeverity::Info, L"Using cached WinMM system device information from %s.", Strings::kStrSystemDeviceCacheFilename.data());
+                    for (size_t i = 0; i < joySystemDeviceInfo.size(); ++i)
+                    {
+                        if (true == joySystemDeviceInfo[i].second)
+                            Message::OutputFormatted(Message::ESeverity::Debug, L"    [%u]: XInput device", (unsigned int)i);
+                    }
+
+                    {
+                        std::scoped_lock lock(systemDeviceCacheMutex);
+                        maybePendingSystemDeviceCacheRefresh = joySystemDeviceInfo;
+                    }
+
+                    if (nullptr == systemDeviceCacheRefresher)
+                        systemDeviceCacheRefresher = new BackgroundWorker();
+
+                    // Starting has no effect if the refresher is already running, in which case notifying it is what gets it to pick up the request.
+                    systemDeviceCacheRefresher->Start(SystemDeviceCacheRefresherThreadMain);
+                    systemDeviceCacheRefresher->Notify();
+                    return;
+                }
+            }
+
+            DetectXInputSystemDevices(joySystemDeviceInfo);
+
+            std::scoped_lock lock(systemDeviceCacheMutex);
+
+            if (false == SystemDeviceCache::Save(Strings::kStrSystemDeviceCacheFilename, joySystemDeviceInfo))
+                Message::OutputFormatted(Message::ESeverity::Debug, L"Unable to cache WinMM system device information in %s.", Strings::kStrSystemDeviceCacheFilename.data());
+        }
+
         /// Fills in the specified buffer with the name of the registry key to use for referencing controller names.
         /// @tparam StringType Either LPSTR or LPWSTR depending on whether ASCII or Unicode is desired.
         /// @param [out] buf Buffer to be filled.
@@ -328,7 +487,7 @@ namespace Xidi
 
             // Place the names into the correct spots for the application to read.
             // These will be in HKCU\System\CurrentControlSet\Control\MediaProperties\PrivateProperties\Joystick\OEM\Xidi# and contain the name of the controller.
-            for (DWORD i = 0; i < _countof(controllers); ++i)
+            for (DWORD i = 0; i < (DWORD)controllers.size(); ++i)
             {
                 wchar_t valueData[64];
                 const int valueDataCount = FillVirtualControllerName(valueData, _countof(valueData), i);
@@ -399,6 +558,8 @@ namespace Xidi
             static std::once_flag initializationFlag;
             std::call_once(initializationFlag, []() -> void
                 {
+                    Globals::EnsureInitialized();
+
                     const Controller::Mapper* mapper = Controller::Mapper::GetConfigured();
                     if (nullptr == mapper)
                     {
@@ -406,26 +567,61 @@ namespace Xidi
                     }
                     else
                     {
-                        for (int i = 0; i < _countof(controllers); ++i)
+                        RegisterNativeXInputSource();
+
+                        const DWORD kVirtualControllerCount = Controller::ControllerSourceRegistry::GetDefault().GetSlotCount();
+                        controllerSet = new Controller::ControllerSet(Controller::ControllerSourceRegistry::CreateDefaultInterface(), kVirtualControllerCount);
+                        controllers.assign(controllerSet->GetControllerCount(), nullptr);
+
+                        for (DWORD i = 0; i < (DWORD)controllers.size(); ++i)
                         {
-                            controllers[i] = new Controller::VirtualController(i, *mapper);
-                            controllers[i]->SetAllAxisDeadzone(kAxisDeadzone);
-                            controllers[i]->SetAllAxisSaturation(kAxisSaturation);
-                            controllers[i]->SetAllAxisRange(kAxisRangeMin, kAxisRangeMax);
+                            std::unique_ptr<Controller::VirtualController> controller = std::make_unique<Controller::VirtualController>(i);
+                            controller->SetAllAxisDeadzone(kAxisDeadzone);
+                            controller->SetAllAxisSaturation(kAxisSaturation);
+                            controller->SetAllAxisRange(kAxisRangeMin, kAxisRangeMax);
+                            controllers[i] = controllerSet->AddController(std::move(controller));
+                            Controller::ControlEndpoint::GetDefault().AddController(controllers[i]);
                         }
+
+                        // The controller set is never destroyed, so neither it nor its controllers ever need to be unregistered.
+                        Controller::PrefetchScheduler::GetDefault().AddTarget(controllerSet);
+
+                        Globals::StartConfigurationWatcherIfConfigured();
                     }
 
                     // Enumerate all devices exposed by WinMM.
-                    CreateSystemDeviceInfo();
+                    {
+                        const Profiler::ScopedStartupPhase startupPhase(Profiler::EStartupPhase::WinMMSystemDeviceInfo);
+                        CreateSystemDeviceInfo(true);
+                    }
 
                     // Initialize the joystick index map.
-                    CreateJoyIndexMap();
-
-                    // Ensure all controllers have their names published in the system registry.
-                    SetControllerNameRegistryInfo();
+                    {
+                        const Profiler::ScopedStartupPhase startupPhase(Profiler::EStartupPhase::WinMMJoyIndexMap);
+                        CreateJoyIndexMap();
+                    }
 
                     // Initialization complete.
                     Message::Output(Message::ESeverity::Info, L"Completed initialization of WinMM joystick wrapper.");
+                    Profiler::OutputStartupTrace();
+                }
+            );
+        }
+
+        /// Ensures all controllers have their names published in the system registry.
+        /// Applications find these names using the registry key name that `joyGetDevCaps` reports, so publishing them is deferred until the first time that function is invoked.
+        /// Requires that WinMM functionality already be initialized.
+        static void PublishControllerNamesOnce(void)
+        {
+            static std::once_flag publishFlag;
+            std::call_once(publishFlag, []() -> void
+                {
+                    {
+                        const Profiler::ScopedStartupPhase startupPhase(Profiler::EStartupPhase::WinMMControllerNames);
+                        SetControllerNameRegistryInfo();
+                    }
+
+                    Profiler::OutputStartupTrace();
                 }
             );
         }
@@ -436,14 +632,15 @@ namespace Xidi
 
         MMRESULT WrapperJoyWinMM::JoyConfigChanged(DWORD dwFlags)
         {
+            PROFILE_INVOCATION(WinMMJoyConfigChanged);
             Message::Output(Message::ESeverity::Info, L"Refreshing joystick state due to a configuration change.");
             Initialize();
 
             // Redirect to the imported API so that its view of the registry can be updated.
             HRESULT result = ImportApiWinMM::joyConfigChanged(dwFlags);
 
-            // Update Xidi's view of devices.
-            CreateSystemDeviceInfo();
+            // Update Xidi's view of devices. The system just indicated that devices changed, so cached information cannot be trusted.
+            CreateSystemDeviceInfo(false);
             CreateJoyIndexMap();
             SetControllerNameRegistryInfo();
 
@@ -454,6 +651,10 @@ namespace Xidi
 
         template <typename JoyCapsType> MMRESULT JoyGetDevCaps(UINT_PTR uJoyID, JoyCapsType* pjc, UINT cbjc)
         {
+            PROFILE_INVOCATION(WinMMJoyGetDevCaps);
+            Initialize();
+            PublishControllerNamesOnce();
+
             // Special case: index is specified as -1, which the API says just means fill in the registry key.
             if ((UINT_PTR)-1 == uJoyID)
             {
@@ -464,8 +665,8 @@ namespace Xidi
                 return result;
             }
 
-            Initialize();
             const int realJoyID = TranslateApplicationJoyIndex((UINT)uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
@@ -543,9 +744,10 @@ namespace Xidi
 
         UINT JoyGetNumDevs(void)
         {
+            PROFILE_INVOCATION(WinMMJoyGetNumDevs);
             Initialize();
 
-            // Number of controllers = number of XInput controllers + number of driver-reported controllers.
+            // Number of controllers = number of Xidi virtual controllers + number of driver-reported controllers.
             UINT result = (UINT)joyIndexMap.size();
             Message::OutputFormatted(Message::ESeverity::Debug, L"Invoked %s, result = %u.", __FUNCTIONW__ L"()", result);
             return result;
@@ -555,15 +757,17 @@ namespace Xidi
 
         MMRESULT JoyGetPos(UINT uJoyID, LPJOYINFO pji)
         {
+            PROFILE_INVOCATION(WinMMJoyGetPos);
             Initialize();
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
                 // Querying an XInput controller.
                 const DWORD xJoyID = (DWORD)((-realJoyID) - 1);
 
-                const Controller::SState kJoyStateData = controllers[xJoyID]->GetState();
+                const Controller::SState kJoyStateData = controllerSet->GetState(xJoyID);
 
                 pji->wXpos = (WORD)kJoyStateData.axis[(int)Controller::EAxis::X];
                 pji->wYpos = (WORD)kJoyStateData.axis[(int)Controller::EAxis::Y];
@@ -595,8 +799,11 @@ namespace Xidi
 
         MMRESULT JoyGetPosEx(UINT uJoyID, LPJOYINFOEX pji)
         {
+            PROFILE_INVOCATION(WinMMJoyGetPosEx);
             Initialize();
+            Statistics::RecordApiCall(Statistics::EApiCall::WinMMJoyGetPosEx);
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
@@ -611,7 +818,7 @@ namespace Xidi
                     return result;
                 }
 
-                const Controller::SState kJoyStateData = controllers[xJoyID]->GetState();
+                const Controller::SState kJoyStateData = controllerSet->GetState(xJoyID);
                 const EPovValue kJoyStateDataPovValue = DataFormat::DirectInputPovValue(kJoyStateData.povDirection);
 
                 // Fill in the provided structure.
@@ -647,8 +854,10 @@ namespace Xidi
 
         MMRESULT JoyGetThreshold(UINT uJoyID, LPUINT puThreshold)
         {
+            PROFILE_INVOCATION(WinMMJoyGetThreshold);
             Initialize();
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
@@ -673,8 +882,10 @@ namespace Xidi
 
         MMRESULT JoyReleaseCapture(UINT uJoyID)
         {
+            PROFILE_INVOCATION(WinMMJoyReleaseCapture);
             Initialize();
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
@@ -699,8 +910,10 @@ namespace Xidi
 
         MMRESULT JoySetCapture(HWND hwnd, UINT uJoyID, UINT uPeriod, BOOL fChanged)
         {
+            PROFILE_INVOCATION(WinMMJoySetCapture);
             Initialize();
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
@@ -725,8 +938,10 @@ namespace Xidi
 
         MMRESULT JoySetThreshold(UINT uJoyID, UINT uThreshold)
         {
+            PROFILE_INVOCATION(WinMMJoySetThreshold);
             Initialize();
             const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
+            PROFILE_INVOCATION_JOY_INDEX(realJoyID);
 
             if (realJoyID < 0)
             {
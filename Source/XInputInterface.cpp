@@ -11,13 +11,61 @@
  *****************************************************************************/
 
 #include "ApiWindows.h"
+#include "ControllerSourceRegistry.h"
+#include "Globals.h"
+#include "Message.h"
+#include "SharedMemory.h"
+#include "SharedXInput.h"
+#include "Strings.h"
 #include "XInputInterface.h"
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <xinput.h>
 
 
 namespace Xidi
 {
+    // -------- INTERNAL VARIABLES ----------------------------------------- //
+
+    /// Native XInput source that is shared with other processes, if sharing is enabled. Owned by the default controller source registry.
+    static SharedXInput* sharedNativeXInput = nullptr;
+
+
+    // -------- INTERNAL FUNCTIONS ----------------------------------------- //
+
+    /// Creates the controller source for native XInput, which is shared with other processes if the configuration file enables it.
+    /// @return Newly-created controller source.
+    static std::unique_ptr<IXInput> CreateNativeXInputSource(void)
+    {
+        const std::shared_ptr<const Configuration::Configuration> config = Globals::GetConfiguration();
+
+        if ((false == config->IsDataValid()) || (false == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionSharedControllers, Strings::kStrConfigurationSettingSharedControllersEnabled)) || (false == config->GetData()[Strings::kStrConfigurationSectionSharedControllers][Strings::kStrConfigurationSettingSharedControllersEnabled].FirstValue().GetBooleanValue()))
+            return std::make_unique<XInput>();
+
+        uint64_t pollInterval = SharedXInput::kDefaultPollInterval;
+        if ((true == config->GetData().SectionNamePairExists(Strings::kStrConfigurationSectionSharedControllers, Strings::kStrConfigurationSettingSharedControllersPollIntervalMicroseconds)) && (config->GetData()[Strings::kStrConfigurationSectionSharedControllers][Strings::kStrConfigurationSettingSharedControllersPollIntervalMicroseconds].FirstValue().GetIntegerValue() > 0))
+            pollInterval = (uint64_t)config->GetData()[Strings::kStrConfigurationSectionSharedControllers][Strings::kStrConfigurationSettingSharedControllersPollIntervalMicroseconds].FirstValue().GetIntegerValue() * 1000ull;
+
+        std::unique_ptr<SharedXInput> sharedXInput = std::make_unique<SharedXInput>(std::make_unique<SharedMemory>(), std::make_unique<XInput>(), Globals::GetCurrentProcessId());
+        if (false == sharedXInput->IsShared())
+        {
+            Message::Output(Message::ESeverity::Warning, L"Failed to map the shared controller segment, possibly because another process is using an incompatible version of Xidi. Controllers will be polled by this process alone.");
+            return sharedXInput;
+        }
+
+        if (true == sharedXInput->IsOwner())
+            Message::OutputFormatted(Message::ESeverity::Info, L"Polling controllers every %llu microseconds on behalf of all processes that share them.", (unsigned long long)(pollInterval / 1000ull));
+        else
+            Message::Output(Message::ESeverity::Info, L"Reading controllers polled by another process.");
+
+        sharedXInput->Start(pollInterval);
+        sharedNativeXInput = sharedXInput.get();
+        return sharedXInput;
+    }
+
+
     // -------- CONCRETE INSTANCE METHODS ---------------------------------- //
     // See "XInputInterface.h" for documentation.
 
@@ -25,4 +73,27 @@ namespace Xidi
     {
         return XInputGetState(dwUserIndex, pState);
     }
+
+
+    // -------- FUNCTIONS -------------------------------------------------- //
+    // See "XInputInterface.h" for documentation.
+
+    void AbandonNativeXInputSharing(void)
+    {
+        if (nullptr != sharedNativeXInput)
+            sharedNativeXInput->Abandon();
+    }
+
+    // --------
+
+    void RegisterNativeXInputSource(void)
+    {
+        static std::once_flag registrationFlag;
+        std::call_once(registrationFlag, []() -> void
+            {
+                if (false == Controller::ControllerSourceRegistry::GetDefault().RegisterSource(CreateNativeXInputSource(), XUSER_MAX_COUNT).has_value())
+                    Message::Output(Message::ESeverity::Error, L"Failed to register native XInput as a controller source. Physical XInput controllers will not be available.");
+            }
+        );
+    }
 }
@@ -9,13 +9,15 @@
  *   Implementation of Xidi-specific configuration reading functionality.
  *****************************************************************************/
 
-#include "ApiWindows.h"
 #include "Configuration.h"
 #include "Mapper.h"
+#include "MapperParser.h"
 #include "Strings.h"
 #include "TemporaryBuffer.h"
+#include "VirtualController.h"
 #include "XidiConfigReader.h"
 
+#include <optional>
 #include <unordered_map>
 #include <string>
 #include <string_view>
@@ -27,6 +29,12 @@ namespace Xidi
 
     /// Holds the layout of the Xidi configuration file that is known statically.
     static Configuration::TConfigurationFileLayout configurationFileLayout = {
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionConfiguration, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingConfigurationHotReload, Configuration::EValueType::Boolean),
+        }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionControl, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingControlEnabled, Configuration::EValueType::Boolean),
+        }),
         ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionImport, {
             ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingImportDirectInput, Configuration::EValueType::String),
             ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingImportDirectInput8, Configuration::EValueType::String),
@@ -39,6 +47,24 @@ namespace Xidi
         ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionMapper, {
             ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingMapperType, Configuration::EValueType::String),
         }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionProfiler, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingProfilerEnabled, Configuration::EValueType::Boolean),
+        }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionPrefetch, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingPrefetchEnabled, Configuration::EValueType::Boolean),
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingPrefetchLeadTimeMicroseconds, Configuration::EValueType::Integer),
+        }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionProperties, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingPropertiesAxisHysteresis, Configuration::EValueType::Integer),
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingPropertiesCoalesceAxisEvents, Configuration::EValueType::Boolean),
+        }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionSharedControllers, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingSharedControllersEnabled, Configuration::EValueType::Boolean),
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingSharedControllersPollIntervalMicroseconds, Configuration::EValueType::Integer),
+        }),
+        ConfigurationFileLayoutSection(Strings::kStrConfigurationSectionStatistics, {
+            ConfigurationFileLayoutNameAndValueType(Strings::kStrConfigurationSettingStatisticsEnabled, Configuration::EValueType::Boolean),
+        }),
     };
 
 
@@ -50,30 +76,74 @@ namespace Xidi
         if (0 != configurationFileLayout.count(section))
             return Configuration::ESectionAction::Read;
 
+        if (true == section.starts_with(Strings::kStrConfigurationSectionCustomMapperPrefix))
+        {
+#ifdef XIDI_SKIP_MAPPERS
+            return Configuration::ESectionAction::Skip;
+#else
+            // Custom mappers cannot be unnamed and cannot replace built-in mappers.
+            const std::optional<std::wstring_view> kMaybeCustomMapperName = Controller::MapperParser::CustomMapperNameFromSection(section);
+            if ((true == kMaybeCustomMapperName.has_value()) && (nullptr == Controller::Mapper::GetBuiltinByName(kMaybeCustomMapperName.value())))
+                return Configuration::ESectionAction::Read;
+#endif
+        }
+
         return Configuration::ESectionAction::Error;
     }
 
     // --------
 
+    bool XidiConfigReader::CheckConfiguration(const Configuration::ConfigurationData& configData, std::wstring& errorDescription)
+    {
+#ifndef XIDI_SKIP_MAPPERS
+        if (true == configData.SectionNamePairExists(Strings::kStrConfigurationSectionMapper, Strings::kStrConfigurationSettingMapperType))
+        {
+            const std::wstring_view kMapperType = configData[Strings::kStrConfigurationSectionMapper][Strings::kStrConfigurationSettingMapperType].FirstValue().GetStringValue();
+
+            if (nullptr == Controller::Mapper::GetBuiltinByName(kMapperType))
+            {
+                std::wstring customMapperSection(Strings::kStrConfigurationSectionCustomMapperPrefix);
+                customMapperSection.append(kMapperType);
+
+                if (false == configData.SectionExists(customMapperSection))
+                {
+                    errorDescription = L"Mapper type \"";
+                    errorDescription.append(kMapperType);
+                    errorDescription.append(L"\" is neither a built-in mapper nor defined in a custom mapper section.");
+                    return false;
+                }
+            }
+        }
+#endif
+
+        return true;
+    }
+
+    // --------
+
     bool XidiConfigReader::CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TIntegerValue& value)
     {
+        if ((Strings::kStrConfigurationSectionProperties == section) && (Strings::kStrConfigurationSettingPropertiesAxisHysteresis == name))
+            return ((value >= (Configuration::TIntegerValue)Controller::VirtualController::kAxisHysteresisMin) && (value <= (Configuration::TIntegerValue)Controller::VirtualController::kAxisHysteresisMax));
+
         return (value >= 0);
     }
 
     // --------
 
-    bool XidiConfigReader::CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TBooleanValue& value)
+    bool XidiConfigReader::CheckValue(std::wstring_view, std::wstring_view, const Configuration::TBooleanValue&)
     {
         return true;
     }
 
     // --------
 
-    bool XidiConfigReader::CheckValue(std::wstring_view section, std::wstring_view name, const Configuration::TStringValue& value)
+    bool XidiConfigReader::CheckValue(std::wstring_view section, std::wstring_view, const Configuration::TStringValue& value)
     {
 #ifndef XIDI_SKIP_MAPPERS
-        if ((Strings::kStrConfigurationSectionMapper == section) && (Strings::kStrConfigurationSettingMapperType == name))
-            return (Controller::Mapper::IsMapperNameKnown(value));
+        // Whether or not the mapper type refers to a known mapper is checked once the whole file has been read, because it can refer to a custom mapper that is defined later in the file.
+        if (true == section.starts_with(Strings::kStrConfigurationSectionCustomMapperPrefix))
+            return (Controller::MapperParser::ParseElementMapperString(value).has_value());
 #endif
 
         return true;
@@ -83,6 +153,11 @@ namespace Xidi
 
     Configuration::EValueType XidiConfigReader::TypeForValue(std::wstring_view section, std::wstring_view name)
     {
+#ifndef XIDI_SKIP_MAPPERS
+        if (true == section.starts_with(Strings::kStrConfigurationSectionCustomMapperPrefix))
+            return ((true == Controller::MapperParser::FindXInputElementByName(name).has_value()) ? Configuration::EValueType::String : Configuration::EValueType::Error);
+#endif
+
         auto sectionLayout = configurationFileLayout.find(section);
         if (configurationFileLayout.end() == sectionLayout)
             return Configuration::EValueType::Error;